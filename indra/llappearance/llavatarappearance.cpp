@@ -37,6 +37,7 @@
 #include "llavatarjointmesh.h"
 #include "llstl.h"
 #include "lldir.h"
+#include "llfasttimer.h"
 #include "llpolymorph.h"
 #include "llpolymesh.h"
 #include "llpolyskeletaldistortion.h"
@@ -62,6 +63,8 @@ using namespace LLAvatarAppearanceDefines;
 const std::string AVATAR_DEFAULT_CHAR = "avatar";
 const LLColor4 DUMMY_COLOR = LLColor4(0.5,0.5,0.5,1.0);
 
+static LLTrace::BlockTimerStatHandle FTM_SHARE_MORPHS("Share Morphs");
+
 /*********************************************************************************
  **                                                                             **
  ** Begin private LLAvatarAppearance Support classes
@@ -1137,6 +1140,7 @@ BOOL LLAvatarAppearance::loadMeshNodes()
 			}
 			else
 			{
+				poly_mesh->addMorphTarget(param);
 				if (info_pair->second)
 				{
 					addSharedVisualParam(param);
@@ -1154,6 +1158,38 @@ BOOL LLAvatarAppearance::loadMeshNodes()
 	return TRUE;
 }
 
+//-----------------------------------------------------------------------------
+// adoptSharedMorphs()
+//-----------------------------------------------------------------------------
+void LLAvatarAppearance::adoptSharedMorphs()
+{
+	if (!LLPolyMesh::sShareMorphs)
+	{
+		return;
+	}
+	LL_RECORD_BLOCK_TIME(FTM_SHARE_MORPHS);
+	for (polymesh_map_t::iterator iter = mPolyMeshes.begin(); iter != mPolyMeshes.end(); ++iter)
+	{
+		iter->second->adoptSharedMorphs(getSex());
+	}
+}
+
+//-----------------------------------------------------------------------------
+// shareMorphs()
+//-----------------------------------------------------------------------------
+void LLAvatarAppearance::shareMorphs()
+{
+	if (!LLPolyMesh::sShareMorphs)
+	{
+		return;
+	}
+	LL_RECORD_BLOCK_TIME(FTM_SHARE_MORPHS);
+	for (polymesh_map_t::iterator iter = mPolyMeshes.begin(); iter != mPolyMeshes.end(); ++iter)
+	{
+		iter->second->shareMorphs();
+	}
+}
+
 //-----------------------------------------------------------------------------
 // loadLayerSets()
 //-----------------------------------------------------------------------------
@@ -239,6 +239,10 @@ public:
 public:
 	virtual void	updateMeshTextures() = 0;
 	virtual void	dirtyMesh() = 0; // Dirty the avatar mesh
+	// Called around applying the visual params to morph the meshes by
+	// sharing the vertices of avatars with the same shape, see LLPolyMesh
+	void			adoptSharedMorphs();
+	void			shareMorphs();
 protected:
 	virtual void	dirtyMesh(S32 priority) = 0; // Dirty the avatar mesh, with priority
 
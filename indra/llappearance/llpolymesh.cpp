@@ -59,6 +59,11 @@ LLPolyMorphData *clone_morph_param_cleavage(const LLPolyMorphData *src_data,
 // Global table of loaded LLPolyMeshes
 //-----------------------------------------------------------------------------
 LLPolyMesh::LLPolyMeshSharedDataTable LLPolyMesh::sGlobalSharedMeshList;
+BOOL LLPolyMesh::sShareMorphs = TRUE;
+
+// morphed vertex data kept for meshes to come, beyond it only that in use is
+const U32 MAX_SHARED_MORPHS = 64;
+LLPolyMeshMorphCache LLPolyMesh::sSharedMorphs(MAX_SHARED_MORPHS);
 
 //-----------------------------------------------------------------------------
 // LLPolyMeshSharedData()
@@ -754,7 +759,6 @@ LLPolyMesh::LLPolyMesh(LLPolyMeshSharedData *shared_data, LLPolyMesh *reference_
 	mSharedData = shared_data;
 	mReferenceMesh = reference_mesh;
 	mAvatarp = NULL;
-	mVertexData = NULL;
 
 	mCurVertexCount = 0;
 	mFaceIndexCount = 0;
@@ -762,42 +766,18 @@ LLPolyMesh::LLPolyMesh(LLPolyMeshSharedData *shared_data, LLPolyMesh *reference_
 	mFaceVertexCount = 0;
 	mFaceVertexOffset = 0;
 
+	mMorphHash = 0;
+	mMorphShareable = FALSE;
+	mMorphAdopted = FALSE;
+
 	if (shared_data->isLOD() && reference_mesh)
 	{
-		mCoords = reference_mesh->mCoords;
-		mNormals = reference_mesh->mNormals;
-		mScaledNormals = reference_mesh->mScaledNormals;
-		mBinormals = reference_mesh->mBinormals;
-		mScaledBinormals = reference_mesh->mScaledBinormals;
-		mTexCoords = reference_mesh->mTexCoords;
-		mClothingWeights = reference_mesh->mClothingWeights;
+		mVertexMesh = reference_mesh->mVertexMesh;
 	}
 	else
 	{
-		// Allocate memory without initializing every vector
-		// NOTE: This makes asusmptions about the size of LLVector[234]
-		S32 nverts = mSharedData->mNumVertices;
-		//make sure it's an even number of verts for alignment
-		nverts += nverts%2;
-		S32 nfloats = nverts * (
-					4 + //coords
-					4 + //normals
-					4 + //weights
-					2 + //coords
-					4 + //scaled normals
-					4 + //binormals
-					4); //scaled binormals
-
-		//use 16 byte aligned vertex data to make LLPolyMesh SSE friendly
-		mVertexData = (F32*) ll_aligned_malloc_16(nfloats*4);
-		S32 offset = 0;
-		mCoords				= 	(LLVector4a*)(mVertexData + offset); offset += 4*nverts;
-		mNormals			=	(LLVector4a*)(mVertexData + offset); offset += 4*nverts;
-		mClothingWeights	= 	(LLVector4a*)(mVertexData + offset); offset += 4*nverts;
-		mTexCoords			= 	(LLVector2*)(mVertexData + offset);  offset += 2*nverts;
-		mScaledNormals		=   (LLVector4a*)(mVertexData + offset); offset += 4*nverts;
-		mBinormals			=   (LLVector4a*)(mVertexData + offset); offset += 4*nverts;
-		mScaledBinormals	=   (LLVector4a*)(mVertexData + offset); offset += 4*nverts; 
+		mVertexMesh = this;
+		mVertexData = new LLPolyMeshVertexData(mSharedData->mNumVertices);
 		initializeForMorph();
 	}
 }
@@ -809,7 +789,6 @@ LLPolyMesh::LLPolyMesh(LLPolyMeshSharedData *shared_data, LLPolyMesh *reference_
 LLPolyMesh::~LLPolyMesh()
 {
 	delete_and_clear(mJointRenderData);
-	ll_aligned_free_16(mVertexData);
 }
 
 
@@ -860,6 +839,7 @@ LLPolyMesh *LLPolyMesh::getMesh(const std::string &name, LLPolyMesh* reference_m
 void LLPolyMesh::freeAllMeshes()
 {
         // delete each item in the global lists
+        clearSharedMorphs();
         for_each(sGlobalSharedMeshList.begin(), sGlobalSharedMeshList.end(), DeletePairedPointer());
         sGlobalSharedMeshList.clear();
 }
@@ -917,7 +897,7 @@ void LLPolyMesh::dumpDiagInfo()
 //-----------------------------------------------------------------------------
 LLVector4a *LLPolyMesh::getWritableCoords()
 {
-        return mCoords;
+        return getUniqueVertexData()->mCoords;
 }
 
 //-----------------------------------------------------------------------------
@@ -925,7 +905,7 @@ LLVector4a *LLPolyMesh::getWritableCoords()
 //-----------------------------------------------------------------------------
 LLVector4a *LLPolyMesh::getWritableNormals()
 {
-        return mNormals;
+        return getUniqueVertexData()->mNormals;
 }
 
 //-----------------------------------------------------------------------------
@@ -933,7 +913,7 @@ LLVector4a *LLPolyMesh::getWritableNormals()
 //-----------------------------------------------------------------------------
 LLVector4a *LLPolyMesh::getWritableBinormals()
 {
-        return mBinormals;
+        return getUniqueVertexData()->mBinormals;
 }
 
 
@@ -942,7 +922,7 @@ LLVector4a *LLPolyMesh::getWritableBinormals()
 //-----------------------------------------------------------------------------
 LLVector4a       *LLPolyMesh::getWritableClothingWeights()
 {
-        return mClothingWeights;
+        return getUniqueVertexData()->mClothingWeights;
 }
 
 //-----------------------------------------------------------------------------
@@ -950,7 +930,7 @@ LLVector4a       *LLPolyMesh::getWritableClothingWeights()
 //-----------------------------------------------------------------------------
 LLVector2       *LLPolyMesh::getWritableTexCoords()
 {
-        return mTexCoords;
+        return getUniqueVertexData()->mTexCoords;
 }
 
 //-----------------------------------------------------------------------------
@@ -958,7 +938,7 @@ LLVector2       *LLPolyMesh::getWritableTexCoords()
 //-----------------------------------------------------------------------------
 LLVector4a *LLPolyMesh::getScaledNormals()
 {
-        return mScaledNormals;
+        return getUniqueVertexData()->mScaledNormals;
 }
 
 //-----------------------------------------------------------------------------
@@ -966,7 +946,7 @@ LLVector4a *LLPolyMesh::getScaledNormals()
 //-----------------------------------------------------------------------------
 LLVector4a *LLPolyMesh::getScaledBinormals()
 {
-        return mScaledBinormals;
+        return getUniqueVertexData()->mScaledBinormals;
 }
 
 
@@ -975,19 +955,98 @@ LLVector4a *LLPolyMesh::getScaledBinormals()
 //-----------------------------------------------------------------------------
 void LLPolyMesh::initializeForMorph()
 {
-    LLVector4a::memcpyNonAliased16((F32*) mCoords, (F32*) mSharedData->mBaseCoords, sizeof(LLVector4a) * mSharedData->mNumVertices);
-	LLVector4a::memcpyNonAliased16((F32*) mNormals, (F32*) mSharedData->mBaseNormals, sizeof(LLVector4a) * mSharedData->mNumVertices);
-	LLVector4a::memcpyNonAliased16((F32*) mScaledNormals, (F32*) mSharedData->mBaseNormals, sizeof(LLVector4a) * mSharedData->mNumVertices);
-	LLVector4a::memcpyNonAliased16((F32*) mBinormals, (F32*) mSharedData->mBaseNormals, sizeof(LLVector4a) * mSharedData->mNumVertices);
-	LLVector4a::memcpyNonAliased16((F32*) mScaledBinormals, (F32*) mSharedData->mBaseNormals, sizeof(LLVector4a) * mSharedData->mNumVertices);
-	LLVector4a::memcpyNonAliased16((F32*) mTexCoords, (F32*) mSharedData->mTexCoords, sizeof(LLVector2) * (mSharedData->mNumVertices + mSharedData->mNumVertices%2));
+	LLPolyMeshVertexData* data = mVertexData;
+    LLVector4a::memcpyNonAliased16((F32*) data->mCoords, (F32*) mSharedData->mBaseCoords, sizeof(LLVector4a) * mSharedData->mNumVertices);
+	LLVector4a::memcpyNonAliased16((F32*) data->mNormals, (F32*) mSharedData->mBaseNormals, sizeof(LLVector4a) * mSharedData->mNumVertices);
+	LLVector4a::memcpyNonAliased16((F32*) data->mScaledNormals, (F32*) mSharedData->mBaseNormals, sizeof(LLVector4a) * mSharedData->mNumVertices);
+	LLVector4a::memcpyNonAliased16((F32*) data->mBinormals, (F32*) mSharedData->mBaseNormals, sizeof(LLVector4a) * mSharedData->mNumVertices);
+	LLVector4a::memcpyNonAliased16((F32*) data->mScaledBinormals, (F32*) mSharedData->mBaseNormals, sizeof(LLVector4a) * mSharedData->mNumVertices);
+	LLVector4a::memcpyNonAliased16((F32*) data->mTexCoords, (F32*) mSharedData->mTexCoords, sizeof(LLVector2) * (mSharedData->mNumVertices + mSharedData->mNumVertices%2));
 
 	for (U32 i = 0; i < mSharedData->mNumVertices; ++i)
 	{
-		mClothingWeights[i].clear();
+		data->mClothingWeights[i].clear();
 	}
 }
 
+//-----------------------------------------------------------------------------
+// getUniqueVertexData()
+//-----------------------------------------------------------------------------
+LLPolyMeshVertexData* LLPolyMesh::getUniqueVertexData()
+{
+	if (mVertexMesh != this)
+	{
+		return mVertexMesh->getUniqueVertexData();
+	}
+	return LLPolyMeshVertexData::makeUnique(mVertexData);
+}
+
+//-----------------------------------------------------------------------------
+// addMorphTarget()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::addMorphTarget(LLPolyMorphTarget* target)
+{
+	if (mVertexMesh == this)
+	{
+		mMorphTargets.push_back(target);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// adoptSharedMorphs()
+//-----------------------------------------------------------------------------
+BOOL LLPolyMesh::adoptSharedMorphs(ESex sex)
+{
+	mMorphShareable = FALSE;
+	mMorphAdopted = FALSE;
+	if (!sShareMorphs || mVertexMesh != this || mMorphTargets.empty())
+	{
+		return FALSE;
+	}
+
+	mMorphWeights.resize(mMorphTargets.size());
+	for (U32 i = 0; i < mMorphTargets.size(); ++i)
+	{
+		if (!mMorphTargets[i]->getSharedWeight(sex, mMorphWeights[i]))
+		{
+			return FALSE;
+		}
+	}
+	mMorphHash = LLPolyMeshMorphCache::hashWeights(mSharedData, mMorphWeights);
+	mMorphShareable = TRUE;
+
+	// already morphed, possibly by this very mesh
+	LLPolyMeshVertexData* shared = sSharedMorphs.find(mMorphHash, mSharedData, mMorphWeights);
+	if (shared)
+	{
+		mVertexData = shared;
+		mMorphAdopted = TRUE;
+	}
+	return mMorphAdopted;
+}
+
+//-----------------------------------------------------------------------------
+// shareMorphs()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::shareMorphs()
+{
+	if (mMorphShareable && !mMorphAdopted)
+	{
+		sSharedMorphs.add(mMorphHash, mSharedData, mMorphWeights, mVertexData);
+	}
+	mMorphShareable = FALSE;
+	mMorphAdopted = FALSE;
+}
+
+//-----------------------------------------------------------------------------
+// clearSharedMorphs()
+//-----------------------------------------------------------------------------
+//static
+void LLPolyMesh::clearSharedMorphs()
+{
+	sSharedMorphs.clear();
+}
+
 //-----------------------------------------------------------------------------
 // getMorphData()
 //-----------------------------------------------------------------------------
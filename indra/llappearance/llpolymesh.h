@@ -34,6 +34,8 @@
 #include "v3math.h"
 #include "v2math.h"
 #include "llquaternion.h"
+#include "llpointer.h"
+#include "llpolymeshvertexdata.h"
 #include "llpolymorph.h"
 #include "lljoint.h"
 
@@ -217,7 +219,7 @@ public:
 
 	// Get coords
 	const LLVector4a	*getCoords() const{
-		return mCoords;
+		return mVertexMesh->mVertexData->mCoords;
 	}
 
 	// non const version
@@ -225,12 +227,12 @@ public:
 
 	// Get normals
 	const LLVector4a	*getNormals() const{ 
-		return mNormals; 
+		return mVertexMesh->mVertexData->mNormals; 
 	}
 
 	// Get normals
 	const LLVector4a	*getBinormals() const{ 
-		return mBinormals; 
+		return mVertexMesh->mVertexData->mBinormals; 
 	}
 
 	// Get base mesh normals
@@ -254,7 +256,7 @@ public:
 
 	// Get texCoords
 	const LLVector2	*getTexCoords() const { 
-		return mTexCoords; 
+		return mVertexMesh->mVertexData->mTexCoords; 
 	}
 
 	// non const version
@@ -278,7 +280,7 @@ public:
 
 	const LLVector4a		*getClothingWeights()
 	{
-		return mClothingWeights;	
+		return mVertexMesh->mVertexData->mClothingWeights;	
 	}
 
 	//--------------------------------------------------------------------
@@ -321,6 +323,25 @@ public:
 	void setAvatar(LLAvatarAppearance* avatarp) { mAvatarp = avatarp; }
 	LLAvatarAppearance* getAvatar() { return mAvatarp; }
 
+	//--------------------------------------------------------------------
+	// Morph sharing
+	// Avatars with the same shape end up with the same morphed vertices.
+	// Before an avatar's visual params are applied, adoptSharedMorphs()
+	// looks for vertex data already morphed to the weights this mesh's
+	// targets are about to reach and takes it, the targets then only move
+	// their collision volumes.  shareMorphs() afterwards offers the result
+	// to the next avatar.  Targets animating towards a weight or masked by
+	// this avatar's textures keep the mesh to itself.
+	//--------------------------------------------------------------------
+	void	addMorphTarget(LLPolyMorphTarget* target);
+	BOOL	adoptSharedMorphs(ESex sex);
+	BOOL	isMorphAdopted() const { return mMorphAdopted; }
+	void	shareMorphs();
+
+	static void clearSharedMorphs();
+
+	static BOOL sShareMorphs;
+
 	std::vector<LLJointRenderData*>	mJointRenderData;
 
 	U32				mFaceVertexOffset;
@@ -331,31 +352,33 @@ public:
 private:
 	void initializeForMorph();
 
+	// this mesh's vertex data, copied first if another mesh shares it
+	LLPolyMeshVertexData* getUniqueVertexData();
+
 	// Dumps diagnostic information about the global mesh table
 	static void dumpDiagInfo();
 
 protected:
 	// mesh data shared across all instances of a given mesh
 	LLPolyMeshSharedData	*mSharedData;
-	// Single array of floats for allocation / deletion
-	F32						*mVertexData;
-	// deformed vertices (resulting from application of morph targets)
-	LLVector4a				*mCoords;
-	// deformed normals (resulting from application of morph targets)
-	LLVector4a				*mScaledNormals;
-	// output normals (after normalization)
-	LLVector4a				*mNormals;
-	// deformed binormals (resulting from application of morph targets)
-	LLVector4a				*mScaledBinormals;
-	// output binormals (after normalization)
-	LLVector4a				*mBinormals;
-	// weight values that mark verts as clothing/skin
-	LLVector4a				*mClothingWeights;
-	// output texture coordinates
-	LLVector2				*mTexCoords;
+	// morphed vertices, NULL for LODs which use their reference mesh's
+	LLPointer<LLPolyMeshVertexData> mVertexData;
+	// the mesh whose vertex data this one uses, itself unless it is a LOD
+	LLPolyMesh				*mVertexMesh;
 	
 	LLPolyMesh				*mReferenceMesh;
 
+	// morph targets applied to this mesh
+	std::vector<LLPolyMorphTarget*> mMorphTargets;
+	// weights of mMorphTargets after this update, and their hash
+	std::vector<F32>		mMorphWeights;
+	size_t					mMorphHash;
+	BOOL					mMorphShareable;
+	BOOL					mMorphAdopted;
+
+	// vertex data morphed for meshes to come
+	static LLPolyMeshMorphCache sSharedMorphs;
+
 	// global mesh list
 	typedef std::map<std::string, LLPolyMeshSharedData*> LLPolyMeshSharedDataTable; 
 	static LLPolyMeshSharedDataTable sGlobalSharedMeshList;
@@ -0,0 +1,174 @@
+/**
+ * @file llpolymeshvertexdata.cpp
+ * @brief Morphed vertex data of avatar meshes and the cache sharing it.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llpolymeshvertexdata.h"
+
+#include <boost/functional/hash.hpp>
+
+#include "llmemory.h"
+
+//-----------------------------------------------------------------------------
+// LLPolyMeshVertexData()
+//-----------------------------------------------------------------------------
+LLPolyMeshVertexData::LLPolyMeshVertexData(S32 num_vertices)
+:	mNumVertices(num_vertices)
+{
+	// Allocate memory without initializing every vector
+	// NOTE: This makes asusmptions about the size of LLVector[234]
+	S32 nverts = num_vertices;
+	//make sure it's an even number of verts for alignment
+	nverts += nverts%2;
+	S32 nfloats = nverts * (
+				4 + //coords
+				4 + //normals
+				4 + //weights
+				2 + //coords
+				4 + //scaled normals
+				4 + //binormals
+				4); //scaled binormals
+	mSize = nfloats*4;
+
+	//use 16 byte aligned vertex data to make LLPolyMesh SSE friendly
+	mData = (F32*) ll_aligned_malloc_16(mSize);
+	setArrays();
+}
+
+LLPolyMeshVertexData::LLPolyMeshVertexData(const LLPolyMeshVertexData& other)
+:	LLRefCount(),
+	mNumVertices(other.mNumVertices),
+	mSize(other.mSize)
+{
+	mData = (F32*) ll_aligned_malloc_16(mSize);
+	LLVector4a::memcpyNonAliased16(mData, other.mData, mSize);
+	setArrays();
+}
+
+//-----------------------------------------------------------------------------
+// ~LLPolyMeshVertexData()
+//-----------------------------------------------------------------------------
+LLPolyMeshVertexData::~LLPolyMeshVertexData()
+{
+	ll_aligned_free_16(mData);
+}
+
+//-----------------------------------------------------------------------------
+// makeUnique()
+//-----------------------------------------------------------------------------
+//static
+LLPolyMeshVertexData* LLPolyMeshVertexData::makeUnique(LLPointer<LLPolyMeshVertexData>& data)
+{
+	if (data->getNumRefs() > 1)
+	{
+		data = new LLPolyMeshVertexData(*data);
+	}
+	return data;
+}
+
+void LLPolyMeshVertexData::setArrays()
+{
+	S32 nverts = mNumVertices + mNumVertices%2;
+	S32 offset = 0;
+	mCoords				= 	(LLVector4a*)(mData + offset); offset += 4*nverts;
+	mNormals			=	(LLVector4a*)(mData + offset); offset += 4*nverts;
+	mClothingWeights	= 	(LLVector4a*)(mData + offset); offset += 4*nverts;
+	mTexCoords			= 	(LLVector2*)(mData + offset);  offset += 2*nverts;
+	mScaledNormals		=   (LLVector4a*)(mData + offset); offset += 4*nverts;
+	mBinormals			=   (LLVector4a*)(mData + offset); offset += 4*nverts;
+	mScaledBinormals	=   (LLVector4a*)(mData + offset); offset += 4*nverts; 
+}
+
+//-----------------------------------------------------------------------------
+// LLPolyMeshMorphCache()
+//-----------------------------------------------------------------------------
+LLPolyMeshMorphCache::LLPolyMeshMorphCache(U32 max_entries)
+:	mMaxEntries(max_entries)
+{
+}
+
+//-----------------------------------------------------------------------------
+// hashWeights()
+//-----------------------------------------------------------------------------
+//static
+size_t LLPolyMeshMorphCache::hashWeights(const LLPolyMeshSharedData* mesh, const std::vector<F32>& weights)
+{
+	size_t hash = 0;
+	boost::hash_combine(hash, mesh);
+	for (U32 i = 0; i < weights.size(); ++i)
+	{
+		boost::hash_combine(hash, weights[i]);
+	}
+	return hash;
+}
+
+//-----------------------------------------------------------------------------
+// find()
+//-----------------------------------------------------------------------------
+LLPolyMeshVertexData* LLPolyMeshMorphCache::find(size_t hash, const LLPolyMeshSharedData* mesh, const std::vector<F32>& weights) const
+{
+	std::pair<entry_map_t::const_iterator, entry_map_t::const_iterator> range = mEntries.equal_range(hash);
+	for (entry_map_t::const_iterator iter = range.first; iter != range.second; ++iter)
+	{
+		const Entry& entry = iter->second;
+		if (entry.mMesh == mesh && entry.mWeights == weights)
+		{
+			return entry.mVertexData;
+		}
+	}
+	return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// add()
+//-----------------------------------------------------------------------------
+void LLPolyMeshMorphCache::add(size_t hash, const LLPolyMeshSharedData* mesh, const std::vector<F32>& weights, LLPolyMeshVertexData* data)
+{
+	Entry& entry = mEntries.insert(std::make_pair(hash, Entry()))->second;
+	entry.mMesh = mesh;
+	entry.mWeights = weights;
+	entry.mVertexData = data;
+
+	if (mEntries.size() > mMaxEntries)
+	{
+		prune();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// prune()
+//-----------------------------------------------------------------------------
+void LLPolyMeshMorphCache::prune()
+{
+	for (entry_map_t::iterator iter = mEntries.begin(); iter != mEntries.end(); )
+	{
+		entry_map_t::iterator cur = iter++;
+		if (cur->second.mVertexData->getNumRefs() == 1)
+		{
+			mEntries.erase(cur);
+		}
+	}
+}
@@ -0,0 +1,123 @@
+/**
+ * @file llpolymeshvertexdata.h
+ * @brief Morphed vertex data of avatar meshes and the cache sharing it.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPOLYMESHVERTEXDATA_H
+#define LL_LLPOLYMESHVERTEXDATA_H
+
+#include <map>
+#include <vector>
+
+#include "llmath.h"
+#include "llpointer.h"
+#include "llrefcount.h"
+#include "llvector4a.h"
+#include "v2math.h"
+
+class LLPolyMeshSharedData;
+
+//-----------------------------------------------------------------------------
+// LLPolyMeshVertexData
+// The morphed vertex arrays of an LLPolyMesh.  Meshes whose morph targets sit
+// at the same weights can share one, the mesh copies it before writing.
+//-----------------------------------------------------------------------------
+class LLPolyMeshVertexData : public LLRefCount
+{
+public:
+	LLPolyMeshVertexData(S32 num_vertices);
+	LLPolyMeshVertexData(const LLPolyMeshVertexData& other);
+
+	// data itself if nothing else holds it, otherwise data is replaced by
+	// a copy of its own first
+	static LLPolyMeshVertexData* makeUnique(LLPointer<LLPolyMeshVertexData>& data);
+
+protected:
+	~LLPolyMeshVertexData();
+
+private:
+	LLPolyMeshVertexData& operator=(const LLPolyMeshVertexData&);
+	void setArrays();
+
+public:
+	// deformed vertices (resulting from application of morph targets)
+	LLVector4a				*mCoords;
+	// deformed normals (resulting from application of morph targets)
+	LLVector4a				*mScaledNormals;
+	// output normals (after normalization)
+	LLVector4a				*mNormals;
+	// deformed binormals (resulting from application of morph targets)
+	LLVector4a				*mScaledBinormals;
+	// output binormals (after normalization)
+	LLVector4a				*mBinormals;
+	// weight values that mark verts as clothing/skin
+	LLVector4a				*mClothingWeights;
+	// output texture coordinates
+	LLVector2				*mTexCoords;
+
+private:
+	// Single array of floats for allocation / deletion
+	F32						*mData;
+	S32						mNumVertices;
+	U32						mSize;
+};
+
+
+//-----------------------------------------------------------------------------
+// LLPolyMeshMorphCache
+// Vertex data already morphed, by the mesh it belongs to and the weights of
+// that mesh's morph targets.  Entries are looked up by the hash of both and
+// then compared in full.  Once there are more than max_entries the entries
+// no mesh is using any more are dropped, those in use stay however many.
+//-----------------------------------------------------------------------------
+class LLPolyMeshMorphCache
+{
+public:
+	LLPolyMeshMorphCache(U32 max_entries);
+
+	static size_t hashWeights(const LLPolyMeshSharedData* mesh, const std::vector<F32>& weights);
+
+	// NULL if there's no such entry
+	LLPolyMeshVertexData* find(size_t hash, const LLPolyMeshSharedData* mesh, const std::vector<F32>& weights) const;
+	void add(size_t hash, const LLPolyMeshSharedData* mesh, const std::vector<F32>& weights, LLPolyMeshVertexData* data);
+	void clear()					{ mEntries.clear(); }
+	U32 size() const				{ return mEntries.size(); }
+
+private:
+	// drops the entries only the cache holds
+	void prune();
+
+	struct Entry
+	{
+		const LLPolyMeshSharedData*		mMesh;
+		std::vector<F32>				mWeights;
+		LLPointer<LLPolyMeshVertexData>	mVertexData;
+	};
+	typedef std::multimap<size_t, Entry> entry_map_t;
+
+	entry_map_t mEntries;
+	const U32 mMaxEntries;
+};
+
+#endif // LL_LLPOLYMESHVERTEXDATA_H
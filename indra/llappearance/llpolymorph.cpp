@@ -196,6 +196,13 @@ BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 			return FALSE;
 		}
 
+		// guard against degenerate input data here rather than every time
+		// the morph is applied
+		if (!mBinormals[v].isFinite3() || (mBinormals[v].dot3(mBinormals[v]).getF32() <= F_APPROXIMATELY_ZERO))
+		{
+			mBinormals[v].set(1,0,0,1);
+		}
+
 
 		numRead = fread(&mTexCoords[v].mV, sizeof(F32), 2, fp);
 		llendianswizzle(&mTexCoords[v].mV, sizeof(F32), 2);
@@ -535,6 +542,107 @@ F32	LLPolyMorphTarget::getMaxDistortion()
 	}
 }
 
+//-----------------------------------------------------------------------------
+// getSharedWeight()
+//-----------------------------------------------------------------------------
+BOOL LLPolyMorphTarget::getSharedWeight(ESex avatar_sex, F32& weight) const
+{
+	if (!mMorphData || mNumMorphMasksPending > 0)
+	{
+		// apply() leaves the mesh alone until the masks arrive
+		weight = 0.f;
+		return TRUE;
+	}
+	if (mIsAnimating || mVertMask)
+	{
+		return FALSE;
+	}
+
+	F32 cur_weight = (mCurWeight == mCurWeight) ? mCurWeight : 0.f;
+	weight = ( getSex() & avatar_sex ) ? cur_weight : getDefaultWeight();
+	return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+// accumulateMorph()
+//-----------------------------------------------------------------------------
+void LLPolyMorphTarget::accumulateMorph(F32 delta_weight)
+{
+	LLVector4a *coords = mMesh->getWritableCoords();
+
+	LLVector4a *scaled_normals = mMesh->getScaledNormals();
+	LLVector4a *normals = mMesh->getWritableNormals();
+
+	LLVector4a *scaled_binormals = mMesh->getScaledBinormals();
+	LLVector4a *binormals = mMesh->getWritableBinormals();
+
+	LLVector4a *clothing_weights = getInfo()->mIsClothingMorph ? mMesh->getWritableClothingWeights() : NULL;
+	LLVector2 *tex_coords = mMesh->getWritableTexCoords();
+
+	F32 *maskWeightArray = (mVertMask) ? mVertMask->getMorphMaskWeights() : NULL;
+
+	const U32* __restrict vertex_indices = mMorphData->mVertexIndices;
+	const LLVector4a* __restrict morph_coords = mMorphData->mCoords;
+	const LLVector4a* __restrict morph_normals = mMorphData->mNormals;
+	const LLVector4a* __restrict morph_binormals = mMorphData->mBinormals;
+	const LLVector2* __restrict morph_tex_coords = mMorphData->mTexCoords;
+
+	// unmasked morphs scale every vertex the same
+	LLVector4a weight;
+	weight.splat(delta_weight);
+	LLVector4a normal_weight;
+	normal_weight.splat(delta_weight*NORMAL_SOFTEN_FACTOR);
+
+	for(U32 vert_index_morph = 0; vert_index_morph < mMorphData->mNumIndices; vert_index_morph++)
+	{
+		S32 vert_index_mesh = vertex_indices[vert_index_morph];
+
+		F32 maskWeight = 1.f;
+		if (maskWeightArray)
+		{
+			maskWeight = maskWeightArray[vert_index_morph];
+			weight.splat(delta_weight*maskWeight);
+			normal_weight.splat(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
+		}
+
+		LLVector4a pos;
+		pos.setMul(morph_coords[vert_index_morph], weight);
+		coords[vert_index_mesh].add(pos);
+
+		if (clothing_weights)
+		{
+			LLVector4a* clothing_weight = &clothing_weights[vert_index_mesh];
+			clothing_weight->add(pos);
+			clothing_weight->getF32ptr()[VW] = maskWeight;
+		}
+
+		// calculate new normals based on half angles
+		LLVector4a norm;
+		norm.setMul(morph_normals[vert_index_morph], normal_weight);
+		scaled_normals[vert_index_mesh].add(norm);
+		norm = scaled_normals[vert_index_mesh];
+
+		// guard against degenerate input data before we create NaNs below!
+		//
+		norm.normalize3fast();
+		normals[vert_index_mesh] = norm;
+
+		// calculate new binormals, degenerate ones were replaced when the
+		// morph was loaded
+		LLVector4a binorm;
+		binorm.setMul(morph_binormals[vert_index_morph], normal_weight);
+		scaled_binormals[vert_index_mesh].add(binorm);
+		LLVector4a tangent;
+		tangent.setCross3(scaled_binormals[vert_index_mesh], norm);
+		LLVector4a& normalized_binormal = binormals[vert_index_mesh];
+
+		normalized_binormal.setCross3(norm, tangent); 
+		normalized_binormal.normalize3fast();
+		
+		tex_coords[vert_index_mesh] += morph_tex_coords[vert_index_morph] * delta_weight * maskWeight;
+	}
+}
+
 //-----------------------------------------------------------------------------
 // apply()
 //-----------------------------------------------------------------------------
@@ -569,74 +677,10 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
 	if (delta_weight != 0.f)
 	{
 		llassert(!mMesh->isLOD());
-		LLVector4a *coords = mMesh->getWritableCoords();
-
-		LLVector4a *scaled_normals = mMesh->getScaledNormals();
-		LLVector4a *normals = mMesh->getWritableNormals();
-
-		LLVector4a *scaled_binormals = mMesh->getScaledBinormals();
-		LLVector4a *binormals = mMesh->getWritableBinormals();
-
-		LLVector4a *clothing_weights = mMesh->getWritableClothingWeights();
-		LLVector2 *tex_coords = mMesh->getWritableTexCoords();
-
-		F32 *maskWeightArray = (mVertMask) ? mVertMask->getMorphMaskWeights() : NULL;
-
-		for(U32 vert_index_morph = 0; vert_index_morph < mMorphData->mNumIndices; vert_index_morph++)
+		// an adopted mesh is already morphed to this weight
+		if (!mMesh->isMorphAdopted())
 		{
-			S32 vert_index_mesh = mMorphData->mVertexIndices[vert_index_morph];
-
-			F32 maskWeight = 1.f;
-			if (maskWeightArray)
-			{
-				maskWeight = maskWeightArray[vert_index_morph];
-			}
-
-
-			LLVector4a pos = mMorphData->mCoords[vert_index_morph];
-			pos.mul(delta_weight*maskWeight);
-			coords[vert_index_mesh].add(pos);
-
-			if (getInfo()->mIsClothingMorph && clothing_weights)
-			{
-				LLVector4a clothing_offset = mMorphData->mCoords[vert_index_morph];
-				clothing_offset.mul(delta_weight * maskWeight);
-				LLVector4a* clothing_weight = &clothing_weights[vert_index_mesh];
-				clothing_weight->add(clothing_offset);
-				clothing_weight->getF32ptr()[VW] = maskWeight;
-			}
-
-			// calculate new normals based on half angles
-			LLVector4a norm = mMorphData->mNormals[vert_index_morph];
-			norm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
-			scaled_normals[vert_index_mesh].add(norm);
-			norm = scaled_normals[vert_index_mesh];
-
-			// guard against degenerate input data before we create NaNs below!
-			//
-			norm.normalize3fast();
-			normals[vert_index_mesh] = norm;
-
-			// calculate new binormals
-			LLVector4a binorm = mMorphData->mBinormals[vert_index_morph];
-
-			// guard against degenerate input data before we create NaNs below!
-			//
-			if (!binorm.isFinite3() || (binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO))
-			{
-				binorm.set(1,0,0,1);
-			}
-
-			binorm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
-			scaled_binormals[vert_index_mesh].add(binorm);
-			LLVector4a tangent;
-			tangent.setCross3(scaled_binormals[vert_index_mesh], norm);
-			LLVector4a& normalized_binormal = binormals[vert_index_mesh];
-
-			normalized_binormal.setCross3(norm, tangent); 
-			normalized_binormal.normalize3fast();
-			
-			tex_coords[vert_index_mesh] += mMorphData->mTexCoords[vert_index_morph] * delta_weight * maskWeight;
+			accumulateMorph(delta_weight);
 		}
 
 		// now apply volume changes
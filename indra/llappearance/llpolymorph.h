@@ -182,6 +182,11 @@ public:
 	void	applyMask(U8 *maskData, S32 width, S32 height, S32 num_components, BOOL invert);
 	void	addPendingMorphMask() { mNumMorphMasksPending++; }
 
+	// The weight apply() is about to leave this morph at in the mesh, FALSE
+	// if the result depends on more than the weight (an animating weight or
+	// a vertex mask from this avatar's textures).
+	BOOL	getSharedWeight(ESex avatar_sex, F32& weight) const;
+
 	void* operator new(size_t size)
 	{
 		return ll_aligned_malloc_16(size);
@@ -195,6 +200,9 @@ public:
 protected:
 	LLPolyMorphTarget(const LLPolyMorphTarget& pOther);
 
+	// adds delta_weight of the morph to the mesh's vertices
+	void	accumulateMorph(F32 delta_weight);
+
 	LLPolyMorphData*				mMorphData;
 	LLPolyMesh*						mMesh;
 	LLPolyVertexMask *				mVertMask;
@@ -0,0 +1,324 @@
+/**
+ * @file   llpolymeshvertexdata_test.cpp
+ * @brief  Test and shared morph benchmark for llpolymeshvertexdata.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <vector>
+
+#include "../test/lltut.h"
+#include "../llpolymeshvertexdata.h"
+
+#include "llmemory.h"
+#include "llrand.h"
+#include "lltimer.h"
+
+namespace
+{
+	// the cache only compares mesh pointers, these stand in for meshes
+	char sMeshes[4];
+	const LLPolyMeshSharedData* mesh(U32 index)
+	{
+		return reinterpret_cast<const LLPolyMeshSharedData*>(&sMeshes[index]);
+	}
+
+	typedef LLPointer<LLPolyMeshVertexData> vertex_data_ptr_t;
+
+	// about the size of the avatar's upper body and its shape morphs
+	const S32 NUM_VERTICES = 3000;
+	const U32 NUM_TARGETS = 60;
+	const U32 TARGET_VERTICES = 400;
+
+	// one morph target, the offsets it moves its vertices by at weight 1
+	struct Target
+	{
+		Target()
+		:	mCoordDeltas((LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a) * TARGET_VERTICES)),
+			mNormalDeltas((LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a) * TARGET_VERTICES))
+		{
+			for (U32 i = 0; i < TARGET_VERTICES; ++i)
+			{
+				mVertices.push_back(ll_rand(NUM_VERTICES));
+				mCoordDeltas[i].set(ll_frand(0.02f) - 0.01f, ll_frand(0.02f) - 0.01f, ll_frand(0.02f) - 0.01f);
+				mNormalDeltas[i].set(ll_frand(0.2f) - 0.1f, ll_frand(0.2f) - 0.1f, ll_frand(0.2f) - 0.1f);
+			}
+		}
+
+		~Target()
+		{
+			ll_aligned_free_16(mCoordDeltas);
+			ll_aligned_free_16(mNormalDeltas);
+		}
+
+		std::vector<S32> mVertices;
+		LLVector4a* mCoordDeltas;
+		LLVector4a* mNormalDeltas;
+	};
+
+	void fill(LLPolyMeshVertexData* data, F32 value)
+	{
+		for (S32 i = 0; i < NUM_VERTICES; ++i)
+		{
+			data->mCoords[i].splat(value);
+		}
+	}
+}
+
+namespace tut
+{
+	struct llpolymeshvertexdata_data
+	{
+		llpolymeshvertexdata_data()
+		:	mBase(new LLPolyMeshVertexData(NUM_VERTICES))
+		{
+			for (S32 i = 0; i < NUM_VERTICES; ++i)
+			{
+				mBase->mCoords[i].set(ll_frand(), ll_frand(), ll_frand());
+				mBase->mScaledNormals[i].set(ll_frand() - 0.5f, ll_frand() - 0.5f, 1.f);
+				mBase->mNormals[i] = mBase->mScaledNormals[i];
+			}
+			for (U32 i = 0; i < NUM_TARGETS; ++i)
+			{
+				mTargets.push_back(new Target);
+			}
+		}
+
+		~llpolymeshvertexdata_data()
+		{
+			for (U32 i = 0; i < mTargets.size(); ++i)
+			{
+				delete mTargets[i];
+			}
+		}
+
+		// what LLPolyMesh::initializeForMorph() and the targets' apply() do
+		// to a mesh whose targets are at weights
+		LLPolyMeshVertexData* morph(const std::vector<F32>& weights)
+		{
+			LLPolyMeshVertexData* data = new LLPolyMeshVertexData(*mBase);
+			for (U32 t = 0; t < mTargets.size(); ++t)
+			{
+				const Target& target = *mTargets[t];
+				LLVector4a weight;
+				weight.splat(weights[t]);
+				for (U32 i = 0; i < target.mVertices.size(); ++i)
+				{
+					const S32 vert = target.mVertices[i];
+					LLVector4a delta;
+					delta.setMul(target.mCoordDeltas[i], weight);
+					data->mCoords[vert].add(delta);
+					delta.setMul(target.mNormalDeltas[i], weight);
+					data->mScaledNormals[vert].add(delta);
+				}
+			}
+			for (S32 i = 0; i < NUM_VERTICES; ++i)
+			{
+				data->mNormals[i] = data->mScaledNormals[i];
+				data->mNormals[i].normalize3fast();
+			}
+			return data;
+		}
+
+		// what LLPolyMesh::adoptSharedMorphs() and shareMorphs() do, counting
+		// the meshes that had to be morphed
+		LLPolyMeshVertexData* morphShared(LLPolyMeshMorphCache& cache, const std::vector<F32>& weights, U32& morphed)
+		{
+			const size_t hash = LLPolyMeshMorphCache::hashWeights(mesh(0), weights);
+			LLPolyMeshVertexData* data = cache.find(hash, mesh(0), weights);
+			if (!data)
+			{
+				data = morph(weights);
+				cache.add(hash, mesh(0), weights, data);
+				++morphed;
+			}
+			return data;
+		}
+
+		vertex_data_ptr_t mBase;
+		std::vector<Target*> mTargets;
+	};
+	typedef test_group<llpolymeshvertexdata_data> llpolymeshvertexdata_test;
+	typedef llpolymeshvertexdata_test::object llpolymeshvertexdata_object;
+	tut::llpolymeshvertexdata_test tllpolymeshvertexdata("LLPolyMeshVertexData");
+
+	template<> template<>
+	void llpolymeshvertexdata_object::test<1>()
+	{
+		// entries are found by mesh and weights, not just by hash
+		std::vector<F32> weights(3, 0.5f);
+		std::vector<F32> other_weights(weights);
+		other_weights[2] = 0.25f;
+
+		ensure_equals("same weights hash the same",
+					  LLPolyMeshMorphCache::hashWeights(mesh(0), weights),
+					  LLPolyMeshMorphCache::hashWeights(mesh(0), std::vector<F32>(3, 0.5f)));
+		ensure("other weights hash apart",
+			   LLPolyMeshMorphCache::hashWeights(mesh(0), weights) != LLPolyMeshMorphCache::hashWeights(mesh(0), other_weights));
+		ensure("other meshes hash apart",
+			   LLPolyMeshMorphCache::hashWeights(mesh(0), weights) != LLPolyMeshMorphCache::hashWeights(mesh(1), weights));
+
+		// three entries colliding on one hash
+		LLPolyMeshMorphCache cache(64);
+		vertex_data_ptr_t first = new LLPolyMeshVertexData(4);
+		vertex_data_ptr_t second = new LLPolyMeshVertexData(4);
+		vertex_data_ptr_t third = new LLPolyMeshVertexData(4);
+		cache.add(7, mesh(0), weights, first);
+		cache.add(7, mesh(1), weights, second);
+		cache.add(7, mesh(0), other_weights, third);
+		ensure_equals("entries", cache.size(), 3U);
+
+		ensure("first", cache.find(7, mesh(0), weights) == first.get());
+		ensure("other mesh", cache.find(7, mesh(1), weights) == second.get());
+		ensure("other weights", cache.find(7, mesh(0), other_weights) == third.get());
+		ensure("no such mesh", cache.find(7, mesh(2), weights) == NULL);
+		ensure("other hash", cache.find(8, mesh(0), weights) == NULL);
+		ensure("fewer weights", cache.find(7, mesh(0), std::vector<F32>(2, 0.5f)) == NULL);
+
+		cache.clear();
+		ensure_equals("cleared", cache.size(), 0U);
+		ensure("none after clear", cache.find(7, mesh(0), weights) == NULL);
+	}
+
+	template<> template<>
+	void llpolymeshvertexdata_object::test<2>()
+	{
+		// data is copied on the first write by a mesh sharing it, and only then
+		LLPolyMeshMorphCache cache(64);
+		std::vector<F32> weights(NUM_TARGETS, 0.5f);
+		vertex_data_ptr_t first = morph(weights);
+		cache.add(1, mesh(0), weights, first);
+
+		vertex_data_ptr_t second = cache.find(1, mesh(0), weights);
+		ensure("adopted", second == first);
+		ensure_equals("holders", first->getNumRefs(), 3);
+
+		LLPolyMeshVertexData* cached = first;
+		LLPolyMeshVertexData* written = LLPolyMeshVertexData::makeUnique(second);
+		ensure("copied", written != cached);
+		ensure("holder updated", second.get() == written);
+		ensure_equals("left to the others", cached->getNumRefs(), 2);
+		ensure_memory_matches("copy of the morph", written->mCoords, sizeof(LLVector4a) * NUM_VERTICES,
+							  cached->mCoords, sizeof(LLVector4a) * NUM_VERTICES);
+		ensure_memory_matches("copy of the normals", written->mNormals, sizeof(LLVector4a) * NUM_VERTICES,
+							  cached->mNormals, sizeof(LLVector4a) * NUM_VERTICES);
+
+		fill(written, 2.f);
+		ensure_equals("written", written->mCoords[NUM_VERTICES - 1][0], 2.f);
+		ensure("shared left alone", cached->mCoords[NUM_VERTICES - 1][0] != 2.f);
+		ensure("cache left alone", cache.find(1, mesh(0), weights) == cached);
+
+		ensure("not copied again", LLPolyMeshVertexData::makeUnique(second) == written);
+
+		// once the cache lets go the last mesh writes in place
+		cache.clear();
+		ensure("sole holder", LLPolyMeshVertexData::makeUnique(first) == cached);
+	}
+
+	template<> template<>
+	void llpolymeshvertexdata_object::test<3>()
+	{
+		// past max_entries the cache drops what no mesh is using
+		const U32 MAX_ENTRIES = 4;
+		LLPolyMeshMorphCache cache(MAX_ENTRIES);
+		std::vector<vertex_data_ptr_t> in_use;
+		for (U32 i = 0; i < MAX_ENTRIES; ++i)
+		{
+			cache.add(i, mesh(0), std::vector<F32>(1, (F32) i), new LLPolyMeshVertexData(4));
+		}
+		ensure_equals("unused kept up to the limit", cache.size(), MAX_ENTRIES);
+		ensure("unused found", cache.find(0, mesh(0), std::vector<F32>(1, 0.f)) != NULL);
+
+		in_use.push_back(new LLPolyMeshVertexData(4));
+		cache.add(MAX_ENTRIES, mesh(0), std::vector<F32>(1, (F32) MAX_ENTRIES), in_use.back());
+		ensure_equals("unused dropped past the limit", cache.size(), 1U);
+		ensure("unused gone", cache.find(0, mesh(0), std::vector<F32>(1, 0.f)) == NULL);
+		ensure("in use kept", cache.find(MAX_ENTRIES, mesh(0), std::vector<F32>(1, (F32) MAX_ENTRIES)) == in_use.back());
+
+		// entries in use stay however many there are
+		for (U32 i = 0; i < MAX_ENTRIES * 2; ++i)
+		{
+			in_use.push_back(new LLPolyMeshVertexData(4));
+			cache.add(100 + i, mesh(1), std::vector<F32>(1, (F32) i), in_use.back());
+		}
+		ensure_equals("all in use", cache.size(), (U32) in_use.size());
+		for (U32 i = 0; i < MAX_ENTRIES * 2; ++i)
+		{
+			ensure("in use found", cache.find(100 + i, mesh(1), std::vector<F32>(1, (F32) i)) == in_use[i + 1]);
+		}
+
+		// those let go go at the next add past the limit
+		in_use.resize(2);
+		cache.add(200, mesh(2), std::vector<F32>(1, 0.f), new LLPolyMeshVertexData(4));
+		ensure_equals("let go dropped", cache.size(), 2U);
+	}
+
+	template<> template<>
+	void llpolymeshvertexdata_object::test<4>()
+	{
+		// Time to morph one mesh of 200 avatars wearing 25 shapes between
+		// them, each morphing its own and sharing through the cache
+		const U32 AVATARS = 200;
+		const U32 SHAPES = 25;
+		std::vector<std::vector<F32> > shapes(SHAPES);
+		for (U32 i = 0; i < SHAPES; ++i)
+		{
+			for (U32 t = 0; t < NUM_TARGETS; ++t)
+			{
+				shapes[i].push_back(ll_frand());
+			}
+		}
+
+		std::vector<vertex_data_ptr_t> own(AVATARS);
+		LLTimer timer;
+		for (U32 i = 0; i < AVATARS; ++i)
+		{
+			own[i] = morph(shapes[i % SHAPES]);
+		}
+		const F64 own_time = timer.getElapsedTimeF64();
+
+		LLPolyMeshMorphCache cache(64);
+		std::vector<vertex_data_ptr_t> shared(AVATARS);
+		U32 morphed = 0;
+		timer.reset();
+		for (U32 i = 0; i < AVATARS; ++i)
+		{
+			shared[i] = morphShared(cache, shapes[i % SHAPES], morphed);
+		}
+		const F64 shared_time = timer.getElapsedTimeF64();
+
+		ensure_equals("one morph per shape", morphed, SHAPES);
+		for (U32 i = 0; i < AVATARS; ++i)
+		{
+			ensure_memory_matches("shared morph", shared[i]->mCoords, sizeof(LLVector4a) * NUM_VERTICES,
+								  own[i]->mCoords, sizeof(LLVector4a) * NUM_VERTICES);
+			ensure_memory_matches("shared normals", shared[i]->mNormals, sizeof(LLVector4a) * NUM_VERTICES,
+								  own[i]->mNormals, sizeof(LLVector4a) * NUM_VERTICES);
+		}
+
+		LL_INFOS() << AVATARS << " avatars, " << SHAPES << " shapes: "
+				   << own_time * 1000.0 << "ms morphing each, "
+				   << shared_time * 1000.0 << "ms sharing" << LL_ENDL;
+	}
+}
@@ -2121,13 +2121,16 @@ std::string zip_llsd(LLSD& data)
 	return result;
 }
 
-//decompress a block of LLSD from provided istream
-// not very efficient -- creats a copy of decompressed LLSD block in memory
-// and deserializes from that copy using LLSDSerialize
-bool unzip_llsd(LLSD& data, std::istream& is, S32 size)
+//decompress a block of LLSD from provided istream into the binary
+// serialization it was zipped from, dropping the deprecated header if present
+bool unzip_llsd_raw(std::vector<U8>& data, std::istream& is, S32 size)
 {
-	U8* result = NULL;
-	U32 cur_size = 0;
+	data.clear();
+	if (size <= 0)
+	{
+		return false;
+	}
+
 	z_stream strm;
 		
 	const U32 CHUNK = 65536;
@@ -2144,6 +2147,9 @@ bool unzip_llsd(LLSD& data, std::istream& is, S32 size)
 	strm.next_in = in;
 
 	S32 ret = inflateInit(&strm);
+
+	// mesh and material blocks usually inflate to a few times their size
+	data.reserve(size * 4);
 	
 	do
 	{
@@ -2153,8 +2159,8 @@ bool unzip_llsd(LLSD& data, std::istream& is, S32 size)
 		if (ret == Z_STREAM_ERROR)
 		{
 			inflateEnd(&strm);
-			free(result);
 			delete [] in;
+			data.clear();
 			return false;
 		}
 		
@@ -2165,17 +2171,14 @@ bool unzip_llsd(LLSD& data, std::istream& is, S32 size)
 		case Z_DATA_ERROR:
 		case Z_MEM_ERROR:
 			inflateEnd(&strm);
-			free(result);
 			delete [] in;
+			data.clear();
 			return false;
 			break;
 		}
 
 		U32 have = CHUNK-strm.avail_out;
-
-		result = (U8*) realloc(result, cur_size + have);
-		memcpy(result+cur_size, out, have);
-		cur_size += have;
+		data.insert(data.end(), out, out + have);
 
 	} while (ret == Z_OK);
 
@@ -2184,33 +2187,46 @@ bool unzip_llsd(LLSD& data, std::istream& is, S32 size)
 
 	if (ret != Z_STREAM_END)
 	{
-		free(result);
+		data.clear();
 		return false;
 	}
 
-	//result now points to the decompressed LLSD block
+	static const std::string deprecated_header("<? LLSD/Binary ?>");
+
+	if (data.size() >= deprecated_header.size() &&
+		memcmp(&data[0], deprecated_header.data(), deprecated_header.size()) == 0)
 	{
-		std::string res_str((char*) result, cur_size);
+		data.erase(data.begin(), data.begin() + llmin(data.size(), deprecated_header.size()+1));
+	}
 
-		std::string deprecated_header("<? LLSD/Binary ?>");
+	return true;
+}
 
-		if (res_str.substr(0, deprecated_header.size()) == deprecated_header)
-		{
-			res_str = res_str.substr(deprecated_header.size()+1, cur_size);
-		}
-		cur_size = res_str.size();
+//decompress a block of LLSD from provided istream
+// not very efficient -- creats a copy of decompressed LLSD block in memory
+// and deserializes from that copy using LLSDSerialize
+bool unzip_llsd(LLSD& data, std::istream& is, S32 size)
+{
+	std::vector<U8> result;
+	if (!unzip_llsd_raw(result, is, size))
+	{
+		return false;
+	}
+
+	//result now holds the decompressed LLSD block
+	{
+		std::string res_str(result.empty() ? "" : (char*) &result[0], result.size());
+		S32 cur_size = res_str.size();
 
 		std::istringstream istr(res_str);
 		
 		if (!LLSDSerialize::fromBinary(data, istr, cur_size))
 		{
 			LL_WARNS() << "Failed to unzip LLSD block" << LL_ENDL;
-			free(result);
 			return false;
 		}		
 	}
 
-	free(result);
 	return true;
 }
 //This unzip function will only work with a gzip header and trailer - while the contents
@@ -817,5 +817,7 @@ public:
 //dirty little zip functions -- yell at davep
 LL_COMMON_API std::string zip_llsd(LLSD& data);
 LL_COMMON_API bool unzip_llsd(LLSD& data, std::istream& is, S32 size);
+// inflates without parsing, for readers that walk the binary serialization themselves
+LL_COMMON_API bool unzip_llsd_raw(std::vector<U8>& data, std::istream& is, S32 size);
 LL_COMMON_API U8* unzip_llsdNavMesh( bool& valid, unsigned int& outsize,std::istream& is, S32 size);
 #endif // LL_LLSDSERIALIZE_H
@@ -0,0 +1,279 @@
+/**
+ * @file llstartuptaskgraph.cpp
+ * @brief Runs initialization steps in dependency order, leaving those not
+ * needed yet for later, and reports how long each took.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llstartuptaskgraph.h"
+
+#include <sstream>
+
+#include "llstring.h"
+
+LLStartupTaskGraph::LLStartupTaskGraph()
+:	mTimerStarted(false),
+	mRunTime(0.0)
+{
+}
+
+void LLStartupTaskGraph::add(const std::string& name, const task_t& task, U32 flags, const name_list_t& after)
+{
+	if (mDependencies.get(name))
+	{
+		LL_ERRS() << "Startup task '" << name << "' added twice" << LL_ENDL;
+	}
+
+	Task entry;
+	entry.mName = name;
+	entry.mTask = task;
+	entry.mFlags = flags;
+	entry.mAfterNames = after;
+	entry.mState = Task::PENDING;
+	entry.mDeferredRun = false;
+	entry.mStart = 0.0;
+	entry.mDuration = 0.0;
+	mDependencies.add(name, (S32) mTasks.size(), after);
+	mTasks.push_back(entry);
+}
+
+bool LLStartupTaskGraph::sortTasks()
+{
+	mOrder.clear();
+	try
+	{
+		LLDependencies<std::string, S32>::sorted_range sorted = mDependencies.sort();
+		for (LLDependencies<std::string, S32>::sorted_iterator it = sorted.begin(); it != sorted.end(); ++it)
+		{
+			mOrder.push_back(it->second);
+		}
+	}
+	catch (const LLDependenciesBase::Cycle& e)
+	{
+		LL_WARNS() << "Startup tasks depend on each other: " << e.what() << LL_ENDL;
+		return false;
+	}
+
+	for (U32 i = 0; i < mTasks.size(); ++i)
+	{
+		Task& task = mTasks[i];
+		task.mAfter.clear();
+		for (name_list_t::const_iterator it = task.mAfterNames.begin(); it != task.mAfterNames.end(); ++it)
+		{
+			const S32* index = mDependencies.get(*it);
+			if (index)
+			{
+				task.mAfter.push_back(*index);
+			}
+			else
+			{
+				LL_WARNS() << "Startup task '" << task.mName << "' follows unknown task '" << *it << "'" << LL_ENDL;
+			}
+		}
+	}
+	return true;
+}
+
+bool LLStartupTaskGraph::isReady(const Task& task) const
+{
+	for (std::vector<S32>::const_iterator it = task.mAfter.begin(); it != task.mAfter.end(); ++it)
+	{
+		if (mTasks[*it].mState != Task::DONE)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool LLStartupTaskGraph::execute(S32 index)
+{
+	Task& task = mTasks[index];
+	task.mStart = mTimer.getElapsedTimeF64();
+	const bool success = task.mTask();
+	task.mDuration = mTimer.getElapsedTimeF64() - task.mStart;
+	task.mState = success ? Task::DONE : Task::FAILED;
+	if (!success)
+	{
+		LL_WARNS() << "Startup task '" << task.mName << "' failed" << LL_ENDL;
+	}
+	return success;
+}
+
+bool LLStartupTaskGraph::run()
+{
+	if (!sortTasks())
+	{
+		return false;
+	}
+	if (!mTimerStarted)
+	{
+		mTimer.reset();
+		mTimerStarted = true;
+	}
+	const F64 run_start = mTimer.getElapsedTimeF64();
+
+	// Queue the tasks to run, walking back from the last so that a
+	// deferred task is pulled in by anything that follows it.
+	std::vector<bool> needed(mTasks.size(), false);
+	for (std::vector<S32>::reverse_iterator it = mOrder.rbegin(); it != mOrder.rend(); ++it)
+	{
+		Task& task = mTasks[*it];
+		if (task.mState != Task::PENDING || ((task.mFlags & DEFERRED) && !needed[*it]))
+		{
+			continue;
+		}
+		task.mState = Task::QUEUED;
+		for (std::vector<S32>::const_iterator after = task.mAfter.begin(); after != task.mAfter.end(); ++after)
+		{
+			needed[*after] = true;
+		}
+	}
+
+	bool success = true;
+	for (std::vector<S32>::const_iterator it = mOrder.begin(); it != mOrder.end(); ++it)
+	{
+		Task& task = mTasks[*it];
+		if (task.mState != Task::QUEUED)
+		{
+			continue;
+		}
+		if (!success)
+		{
+			// anything left after a failure runs next time, if at all
+			task.mState = Task::PENDING;
+		}
+		else if (!isReady(task))
+		{
+			LL_WARNS() << "Startup task '" << task.mName << "' follows a task that failed" << LL_ENDL;
+			task.mState = Task::PENDING;
+			success = false;
+		}
+		else
+		{
+			success = execute(*it);
+		}
+	}
+
+	mRunTime += mTimer.getElapsedTimeF64() - run_start;
+	return success;
+}
+
+bool LLStartupTaskGraph::runDeferred(F32 budget_seconds)
+{
+	if (!sortTasks())
+	{
+		return true;
+	}
+	if (!mTimerStarted)
+	{
+		mTimer.reset();
+		mTimerStarted = true;
+	}
+
+	LLTimer budget;
+	bool ran = false;
+	for (std::vector<S32>::const_iterator it = mOrder.begin(); it != mOrder.end(); ++it)
+	{
+		Task& task = mTasks[*it];
+		if (task.mState != Task::PENDING || !(task.mFlags & DEFERRED))
+		{
+			continue;
+		}
+		if (ran && budget_seconds > 0.f && budget.getElapsedTimeF32() >= budget_seconds)
+		{
+			return false;
+		}
+		if (!isReady(task))
+		{
+			// follows a task that failed, or one that was never run
+			LL_WARNS() << "Skipping startup task '" << task.mName << "'" << LL_ENDL;
+			task.mState = Task::FAILED;
+			continue;
+		}
+		task.mDeferredRun = true;
+		execute(*it);
+		ran = true;
+	}
+	return true;
+}
+
+std::string LLStartupTaskGraph::getReport() const
+{
+	std::ostringstream out;
+	out << llformat("%-32s %-7s %9s %9s", "Task", "When", "Start", "Seconds") << "\n";
+
+	// Longest chain of run() tasks by duration, following each task back
+	// through its longest predecessor.  Tasks off the chain could overlap
+	// it, so it is as short as run() could get.
+	std::vector<F64> finish(mTasks.size(), 0.0);
+	std::vector<S32> previous(mTasks.size(), -1);
+	S32 last = -1;
+	for (std::vector<S32>::const_iterator it = mOrder.begin(); it != mOrder.end(); ++it)
+	{
+		const Task& task = mTasks[*it];
+		if (task.mState == Task::PENDING)
+		{
+			continue;
+		}
+		out << llformat("%-32s %-7s %9.3f %9.3f", task.mName.c_str(),
+						task.mDeferredRun ? "later" : "startup",
+						task.mStart, task.mDuration);
+		if (task.mState == Task::FAILED)
+		{
+			out << " failed";
+		}
+		out << "\n";
+
+		if (task.mDeferredRun)
+		{
+			continue;
+		}
+		for (std::vector<S32>::const_iterator after = task.mAfter.begin(); after != task.mAfter.end(); ++after)
+		{
+			if (!mTasks[*after].mDeferredRun && finish[*after] > finish[*it])
+			{
+				finish[*it] = finish[*after];
+				previous[*it] = *after;
+			}
+		}
+		finish[*it] += task.mDuration;
+		if (last < 0 || finish[*it] > finish[last])
+		{
+			last = *it;
+		}
+	}
+
+	if (last >= 0)
+	{
+		std::string path;
+		for (S32 index = last; index >= 0; index = previous[index])
+		{
+			path = mTasks[index].mName + (path.empty() ? "" : " > ") + path;
+		}
+		out << llformat("Longest chain %.3fs of %.3fs: ", finish[last], mRunTime) << path;
+	}
+	return out.str();
+}
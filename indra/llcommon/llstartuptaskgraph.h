@@ -0,0 +1,114 @@
+/**
+ * @file llstartuptaskgraph.h
+ * @brief Runs initialization steps in dependency order, leaving those not
+ * needed yet for later, and reports how long each took.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSTARTUPTASKGRAPH_H
+#define LL_LLSTARTUPTASKGRAPH_H
+
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+
+#include "lldependencies.h"
+#include "lltimer.h"
+
+//
+// LLStartupTaskGraph
+//
+// Each task names the tasks it must follow.  run() executes them in an
+// order LLDependencies finds for those constraints.  Tasks flagged
+// DEFERRED are left for runDeferred(), which the caller spreads over
+// frames once the application is responsive, unless a task run() needs
+// follows them.  Everything runs on the calling thread.
+//
+class LL_COMMON_API LLStartupTaskGraph
+{
+	LOG_CLASS(LLStartupTaskGraph);
+public:
+	// return false to stop the run, e.g. when the user chose to quit
+	typedef boost::function<bool()> task_t;
+	typedef std::vector<std::string> name_list_t;
+
+	enum ETaskFlags
+	{
+		AT_STARTUP	= 0,		// needed before startup carries on
+		DEFERRED	= 1 << 0	// not needed until after startup
+	};
+
+	LLStartupTaskGraph();
+
+	void add(const std::string& name, const task_t& task, U32 flags = AT_STARTUP,
+			 const name_list_t& after = name_list_t());
+
+	// Runs every task added so far that is not DEFERRED, along with any
+	// deferred task those follow.  Returns false if a task failed, in
+	// which case no further tasks are started.
+	bool run();
+
+	// Runs deferred tasks until budget_seconds have gone by, at least one
+	// task per call; 0 runs them all.  Returns true once none are left.
+	bool runDeferred(F32 budget_seconds = 0.f);
+
+	// Each task's start and duration, and the longest chain of run() tasks
+	// that had to follow each other, the least run() could take.
+	std::string getReport() const;
+
+private:
+	struct Task
+	{
+		enum EState
+		{
+			PENDING,
+			QUEUED,		// needed by the current run()
+			DONE,
+			FAILED
+		};
+
+		std::string mName;
+		task_t mTask;
+		U32 mFlags;
+		name_list_t mAfterNames;
+		std::vector<S32> mAfter;
+		EState mState;
+		bool mDeferredRun;
+		F64 mStart;
+		F64 mDuration;
+	};
+
+	bool sortTasks();
+	bool isReady(const Task& task) const;
+	bool execute(S32 index);
+
+	std::vector<Task> mTasks;
+	LLDependencies<std::string, S32> mDependencies;
+	std::vector<S32> mOrder;	// tasks in dependency order
+
+	LLTimer mTimer;
+	bool mTimerStarted;
+	F64 mRunTime;
+};
+
+#endif // LL_LLSTARTUPTASKGRAPH_H
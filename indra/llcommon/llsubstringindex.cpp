@@ -0,0 +1,305 @@
+/**
+ * @file llsubstringindex.cpp
+ * @brief Trigram index for substring searches over many short strings.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "llsubstringindex.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+
+#include "llworkpool.h"
+
+// candidates checked per pool job
+static const U32 CANDIDATES_PER_JOB = 4096;
+static const U32 NOT_FOUND = U32_MAX;
+
+// the distinct trigrams of text, each packed into the low three bytes
+static void get_trigrams(const std::string& text, std::vector<U32>& trigrams)
+{
+	trigrams.clear();
+	if (text.size() < 3)
+	{
+		return;
+	}
+
+	trigrams.reserve(text.size() - 2);
+	for (U32 i = 0; i + 2 < text.size(); ++i)
+	{
+		trigrams.push_back((U8)text[i] | ((U8)text[i + 1] << 8) | ((U8)text[i + 2] << 16));
+	}
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+//-----------------------------------------------------------------------------
+// LLSubstringIndex::Matches
+//-----------------------------------------------------------------------------
+LLSubstringIndex::Matches::Matches()
+:	mStamp(0)
+{
+}
+
+void LLSubstringIndex::Matches::clear()
+{
+	mText.clear();
+	mStamp = 0;
+	mSlots.clear();
+	mOffsets.clear();
+}
+
+bool LLSubstringIndex::Matches::isCurrent(const LLSubstringIndex& index, S32 slot) const
+{
+	return slot >= 0 && slot < (S32)mOffsets.size() && index.getSlotStamp(slot) <= mStamp;
+}
+
+std::string::size_type LLSubstringIndex::Matches::getOffset(S32 slot) const
+{
+	if (slot < 0 || slot >= (S32)mOffsets.size() || mOffsets[slot] == NOT_FOUND)
+	{
+		return std::string::npos;
+	}
+	return mOffsets[slot];
+}
+
+//-----------------------------------------------------------------------------
+// LLSubstringIndex
+//-----------------------------------------------------------------------------
+LLSubstringIndex::LLSubstringIndex()
+:	mPostingCount(0),
+	mStalePostings(0),
+	mStamp(0)
+{
+}
+
+void LLSubstringIndex::clear()
+{
+	mSlots.clear();
+	mFreeSlots.clear();
+	mPostings.clear();
+	mPostingCount = 0;
+	mStalePostings = 0;
+	// stamps keep counting so old matches never look current
+	++mStamp;
+}
+
+S32 LLSubstringIndex::add(const std::string& text)
+{
+	S32 slot;
+	if (mFreeSlots.empty())
+	{
+		slot = mSlots.size();
+		mSlots.push_back(Slot());
+	}
+	else
+	{
+		slot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+
+	Slot& entry = mSlots[slot];
+	entry.mText = text;
+	entry.mStamp = ++mStamp;
+	entry.mUsed = true;
+	indexSlot(slot);
+	return slot;
+}
+
+void LLSubstringIndex::update(S32 slot, const std::string& text)
+{
+	Slot& entry = mSlots[slot];
+	llassert(entry.mUsed);
+	if (entry.mText == text)
+	{
+		return;
+	}
+
+	unindexSlot(slot);
+	entry.mText = text;
+	entry.mStamp = ++mStamp;
+	indexSlot(slot);
+
+	if (mStalePostings > mPostingCount / 2)
+	{
+		rebuild();
+	}
+}
+
+void LLSubstringIndex::remove(S32 slot)
+{
+	Slot& entry = mSlots[slot];
+	llassert(entry.mUsed);
+
+	unindexSlot(slot);
+	entry.mText.clear();
+	entry.mStamp = ++mStamp;
+	entry.mUsed = false;
+	mFreeSlots.push_back(slot);
+
+	if (mStalePostings > mPostingCount / 2)
+	{
+		rebuild();
+	}
+}
+
+void LLSubstringIndex::indexSlot(S32 slot)
+{
+	std::vector<U32> trigrams;
+	get_trigrams(mSlots[slot].mText, trigrams);
+	for (std::vector<U32>::iterator iter = trigrams.begin(); iter != trigrams.end(); ++iter)
+	{
+		mPostings[*iter].push_back(slot);
+	}
+	mPostingCount += trigrams.size();
+}
+
+void LLSubstringIndex::unindexSlot(S32 slot)
+{
+	// the entries stay until the next rebuild, they are only counted
+	std::vector<U32> trigrams;
+	get_trigrams(mSlots[slot].mText, trigrams);
+	mStalePostings += trigrams.size();
+}
+
+void LLSubstringIndex::rebuild()
+{
+	mPostings.clear();
+	mPostingCount = 0;
+	mStalePostings = 0;
+	for (S32 slot = 0; slot < (S32)mSlots.size(); ++slot)
+	{
+		if (mSlots[slot].mUsed)
+		{
+			indexSlot(slot);
+		}
+	}
+}
+
+void LLSubstringIndex::find(const std::string& text, Matches& matches, LLWorkPool* pool) const
+{
+	std::vector<S32> candidates;
+
+	// the rarest trigram narrows it down the most
+	const posting_list_t* postings = NULL;
+	bool have_postings = false;
+	if (text.size() >= 3)
+	{
+		std::vector<U32> trigrams;
+		get_trigrams(text, trigrams);
+		for (std::vector<U32>::iterator iter = trigrams.begin(); iter != trigrams.end(); ++iter)
+		{
+			posting_map_t::const_iterator found = mPostings.find(*iter);
+			if (found == mPostings.end())
+			{
+				// nothing holds this trigram, so nothing matches
+				postings = NULL;
+				have_postings = true;
+				break;
+			}
+			if (!postings || found->second.size() < postings->size())
+			{
+				postings = &found->second;
+			}
+		}
+		have_postings = true;
+	}
+
+	// a refinement can only match what the last search did, or what changed since
+	const bool refine = !matches.mText.empty() && text.find(matches.mText) != std::string::npos;
+	if (refine && (!have_postings || (postings && matches.mSlots.size() < postings->size())))
+	{
+		candidates = matches.mSlots;
+		for (S32 slot = 0; slot < (S32)mSlots.size(); ++slot)
+		{
+			if (mSlots[slot].mStamp > matches.mStamp)
+			{
+				candidates.push_back(slot);
+			}
+		}
+	}
+	else if (have_postings)
+	{
+		if (postings)
+		{
+			candidates = *postings;
+		}
+	}
+	else
+	{
+		candidates.reserve(mSlots.size());
+		for (S32 slot = 0; slot < (S32)mSlots.size(); ++slot)
+		{
+			candidates.push_back(slot);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+	std::vector<U32> offsets(candidates.size(), NOT_FOUND);
+	const U32 jobs = (candidates.size() + CANDIDATES_PER_JOB - 1) / CANDIDATES_PER_JOB;
+	if (pool && jobs > 1)
+	{
+		pool->run(jobs, boost::bind(&LLSubstringIndex::checkCandidates, this, _1, &text, &candidates, &offsets));
+	}
+	else
+	{
+		for (U32 job = 0; job < jobs; ++job)
+		{
+			checkCandidates(job, &text, &candidates, &offsets);
+		}
+	}
+
+	matches.mText = text;
+	matches.mStamp = mStamp;
+	matches.mSlots.clear();
+	matches.mOffsets.assign(mSlots.size(), NOT_FOUND);
+	for (U32 i = 0; i < candidates.size(); ++i)
+	{
+		if (offsets[i] != NOT_FOUND)
+		{
+			matches.mSlots.push_back(candidates[i]);
+			matches.mOffsets[candidates[i]] = offsets[i];
+		}
+	}
+}
+
+void LLSubstringIndex::checkCandidates(U32 index, const std::string* text, const std::vector<S32>* candidates, std::vector<U32>* offsets) const
+{
+	const U32 end = llmin((U32)candidates->size(), (index + 1) * CANDIDATES_PER_JOB);
+	for (U32 i = index * CANDIDATES_PER_JOB; i < end; ++i)
+	{
+		const Slot& entry = mSlots[(*candidates)[i]];
+		if (entry.mUsed)
+		{
+			std::string::size_type offset = entry.mText.find(*text);
+			if (offset != std::string::npos)
+			{
+				(*offsets)[i] = offset;
+			}
+		}
+	}
+}
@@ -0,0 +1,140 @@
+/**
+ * @file llsubstringindex.h
+ * @brief Trigram index for substring searches over many short strings.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLSUBSTRINGINDEX_H
+#define LL_LLSUBSTRINGINDEX_H
+
+#include <string>
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+class LLWorkPool;
+
+//
+// LLSubstringIndex
+//
+// Finds which of a large set of short strings, such as inventory names,
+// contain a given substring without searching every one of them.  Every
+// three character sequence of every string is indexed, so a search only
+// looks at the strings sharing the rarest trigram of what is searched for.
+// Searches shorter than a trigram look at every string.
+//
+// Strings live in slots handed out by add().  Every change bumps a stamp,
+// so a search result knows which slots changed after it was made; see
+// Matches::isCurrent().  A search that refines the last one (its text
+// contains the last text) only looks at the last matches and the slots
+// changed since.
+//
+// Strings are compared as given, fold case before adding and searching.
+// Only find() may run on other threads, and only while nothing changes
+// the index.
+//
+class LL_COMMON_API LLSubstringIndex
+{
+public:
+	static const S32 NO_SLOT = -1;
+
+	// The result of find()
+	class LL_COMMON_API Matches
+	{
+	public:
+		Matches();
+
+		void clear();
+
+		// what was searched for
+		const std::string& getText() const		{ return mText; }
+		// slots that matched, in increasing order
+		const std::vector<S32>& getSlots() const	{ return mSlots; }
+
+		// false if the slot changed since the search, then its offset is
+		// not known
+		bool isCurrent(const LLSubstringIndex& index, S32 slot) const;
+
+		// where the text was found in the slot's string, npos if it wasn't
+		std::string::size_type getOffset(S32 slot) const;
+
+	private:
+		friend class LLSubstringIndex;
+
+		std::string mText;
+		U32 mStamp;
+		std::vector<S32> mSlots;
+		// by slot, NOT_FOUND for no match
+		std::vector<U32> mOffsets;
+	};
+
+	LLSubstringIndex();
+
+	void clear();
+
+	// returns the slot the string is kept in
+	S32 add(const std::string& text);
+	void update(S32 slot, const std::string& text);
+	void remove(S32 slot);
+
+	const std::string& get(S32 slot) const	{ return mSlots[slot].mText; }
+	U32 getSlotStamp(S32 slot) const		{ return mSlots[slot].mStamp; }
+	U32 getStamp() const					{ return mStamp; }
+	// number of strings held
+	U32 size() const						{ return mSlots.size() - mFreeSlots.size(); }
+
+	// Finds every string containing text.  When matches holds an earlier
+	// search that this one refines, it is reused.  The candidates are
+	// checked over the pool when there is one.
+	void find(const std::string& text, Matches& matches, LLWorkPool* pool = NULL) const;
+
+private:
+	typedef std::vector<S32> posting_list_t;
+	typedef boost::unordered_map<U32, posting_list_t> posting_map_t;
+
+	struct Slot
+	{
+		Slot() : mStamp(0), mUsed(false) {}
+
+		std::string mText;
+		U32 mStamp;
+		bool mUsed;
+	};
+
+	void indexSlot(S32 slot);
+	void unindexSlot(S32 slot);
+	void rebuild();
+	void checkCandidates(U32 index, const std::string* text, const std::vector<S32>* candidates, std::vector<U32>* offsets) const;
+
+	std::vector<Slot> mSlots;
+	std::vector<S32> mFreeSlots;
+	// slots of the strings holding each trigram, may also hold slots that
+	// changed since and list a slot twice, candidates are always checked
+	posting_map_t mPostings;
+	U32 mPostingCount;
+	// entries left behind by changed slots, rebuilt once they are half
+	U32 mStalePostings;
+	U32 mStamp;
+};
+
+#endif // LL_LLSUBSTRINGINDEX_H
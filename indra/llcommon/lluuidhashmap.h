@@ -0,0 +1,295 @@
+/**
+ * @file lluuidhashmap.h
+ * @brief Open addressing hash map keyed by LLUUID.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLUUIDHASHMAP_H
+#define LL_LLUUIDHASHMAP_H
+
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "lluuid.h"
+
+//
+// LLUUIDHashMap
+//
+// Drop in replacement for the parts of std::map<LLUUID, DATA> that lookup
+// heavy code uses.  Entries live in one flat array probed linearly from the
+// slot the id hashes to, so a lookup usually touches a single cache line
+// instead of walking a tree.  Removal shifts the following entries back, so
+// there are no tombstones to slow later lookups.
+//
+// Unlike std::map, iteration order is arbitrary, and any insertion or
+// removal invalidates iterators and references to values.  Store pointers
+// as values where the data itself has to stay put.
+//
+template <class DATA>
+class LLUUIDHashMap
+{
+public:
+	typedef LLUUID key_type;
+	typedef DATA mapped_type;
+	typedef std::pair<LLUUID, DATA> value_type;
+	typedef size_t size_type;
+
+	class const_iterator;
+
+	class iterator : public std::iterator<std::forward_iterator_tag, value_type>
+	{
+	public:
+		iterator() : mMap(NULL), mIndex(0) {}
+
+		value_type& operator*() const		{ return mMap->mSlots[mIndex]; }
+		value_type* operator->() const		{ return &mMap->mSlots[mIndex]; }
+		iterator& operator++()				{ mIndex = mMap->nextUsed(mIndex + 1); return *this; }
+		iterator operator++(int)			{ iterator tmp(*this); ++*this; return tmp; }
+		bool operator==(const iterator& rhs) const	{ return mIndex == rhs.mIndex; }
+		bool operator!=(const iterator& rhs) const	{ return mIndex != rhs.mIndex; }
+
+	private:
+		friend class LLUUIDHashMap;
+		friend class const_iterator;
+		iterator(LLUUIDHashMap* map, U32 index) : mMap(map), mIndex(index) {}
+
+		LLUUIDHashMap* mMap;
+		U32 mIndex;
+	};
+
+	class const_iterator : public std::iterator<std::forward_iterator_tag, const value_type>
+	{
+	public:
+		const_iterator() : mMap(NULL), mIndex(0) {}
+		const_iterator(const iterator& other) : mMap(other.mMap), mIndex(other.mIndex) {}
+
+		const value_type& operator*() const	{ return mMap->mSlots[mIndex]; }
+		const value_type* operator->() const	{ return &mMap->mSlots[mIndex]; }
+		const_iterator& operator++()		{ mIndex = mMap->nextUsed(mIndex + 1); return *this; }
+		const_iterator operator++(int)		{ const_iterator tmp(*this); ++*this; return tmp; }
+		bool operator==(const const_iterator& rhs) const	{ return mIndex == rhs.mIndex; }
+		bool operator!=(const const_iterator& rhs) const	{ return mIndex != rhs.mIndex; }
+
+	private:
+		friend class LLUUIDHashMap;
+		const_iterator(const LLUUIDHashMap* map, U32 index) : mMap(map), mIndex(index) {}
+
+		const LLUUIDHashMap* mMap;
+		U32 mIndex;
+	};
+
+	LLUUIDHashMap() : mSize(0) {}
+
+	iterator begin()						{ return iterator(this, nextUsed(0)); }
+	iterator end()							{ return iterator(this, mSlots.size()); }
+	const_iterator begin() const			{ return const_iterator(this, nextUsed(0)); }
+	const_iterator end() const				{ return const_iterator(this, mSlots.size()); }
+
+	size_type size() const					{ return mSize; }
+	bool empty() const						{ return mSize == 0; }
+
+	iterator find(const LLUUID& key)		{ return iterator(this, findIndex(key)); }
+	const_iterator find(const LLUUID& key) const	{ return const_iterator(this, findIndex(key)); }
+	size_type count(const LLUUID& key) const		{ return findIndex(key) != mSlots.size() ? 1 : 0; }
+
+	DATA& operator[](const LLUUID& key)
+	{
+		U32 index = findIndex(key);
+		if (index == mSlots.size())
+		{
+			index = insertNew(key);
+		}
+		return mSlots[index].second;
+	}
+
+	size_type erase(const LLUUID& key)
+	{
+		U32 index = findIndex(key);
+		if (index == mSlots.size())
+		{
+			return 0;
+		}
+		eraseIndex(index);
+		return 1;
+	}
+
+	void erase(iterator it)
+	{
+		eraseIndex(it.mIndex);
+	}
+
+	void clear()
+	{
+		std::vector<value_type>().swap(mSlots);
+		std::vector<U8>().swap(mUsed);
+		mSize = 0;
+	}
+
+	// Make room for count entries without growing again
+	void reserve(size_type count)
+	{
+		U32 capacity = MIN_CAPACITY;
+		while (capacity * MAX_LOAD_DEN < count * MAX_LOAD_NUM)
+		{
+			capacity *= 2;
+		}
+		if (capacity > mSlots.size())
+		{
+			rehash(capacity);
+		}
+	}
+
+	// Ids are mostly random already, this only has to fold in every byte
+	// so that the handful of well known ids that differ in one byte spread.
+	static U32 hash(const LLUUID& key)
+	{
+		U32 words[4];
+		memcpy(words, key.mData, sizeof(words));
+		U32 h = words[0] ^ (words[1] * 0x9e3779b1) ^ (words[2] * 0x85ebca6b) ^ (words[3] * 0xc2b2ae35);
+		h ^= h >> 16;
+		h *= 0x7feb352d;
+		h ^= h >> 15;
+		return h;
+	}
+
+private:
+	enum
+	{
+		MIN_CAPACITY = 16,
+		// grow past 3/4 full
+		MAX_LOAD_NUM = 4,
+		MAX_LOAD_DEN = 3
+	};
+
+	U32 mask() const						{ return mSlots.size() - 1; }
+
+	U32 nextUsed(U32 index) const
+	{
+		while (index < mUsed.size() && !mUsed[index])
+		{
+			++index;
+		}
+		return index;
+	}
+
+	U32 findIndex(const LLUUID& key) const
+	{
+		if (mSlots.empty())
+		{
+			return 0;
+		}
+		for (U32 index = hash(key) & mask(); mUsed[index]; index = (index + 1) & mask())
+		{
+			if (mSlots[index].first == key)
+			{
+				return index;
+			}
+		}
+		return mSlots.size();
+	}
+
+	U32 insertNew(const LLUUID& key)
+	{
+		if ((mSize + 1) * MAX_LOAD_NUM > mSlots.size() * MAX_LOAD_DEN)
+		{
+			rehash(mSlots.empty() ? (U32) MIN_CAPACITY : mSlots.size() * 2);
+		}
+		U32 index = hash(key) & mask();
+		while (mUsed[index])
+		{
+			index = (index + 1) & mask();
+		}
+		mUsed[index] = 1;
+		mSlots[index].first = key;
+		++mSize;
+		return index;
+	}
+
+	void eraseIndex(U32 hole)
+	{
+		// pull back any entry in the run that would still be found from the hole
+		U32 next = (hole + 1) & mask();
+		while (mUsed[next])
+		{
+			U32 home = hash(mSlots[next].first) & mask();
+			if (((next - home) & mask()) >= ((next - hole) & mask()))
+			{
+				mSlots[hole] = mSlots[next];
+				hole = next;
+			}
+			next = (next + 1) & mask();
+		}
+		mUsed[hole] = 0;
+		mSlots[hole] = value_type();
+		--mSize;
+	}
+
+	void rehash(U32 capacity)
+	{
+		std::vector<value_type> slots(capacity);
+		std::vector<U8> used(capacity, 0);
+		slots.swap(mSlots);
+		used.swap(mUsed);
+		for (U32 i = 0; i < used.size(); ++i)
+		{
+			if (used[i])
+			{
+				U32 index = hash(slots[i].first) & mask();
+				while (mUsed[index])
+				{
+					index = (index + 1) & mask();
+				}
+				mUsed[index] = 1;
+				mSlots[index] = slots[i];
+			}
+		}
+	}
+
+	std::vector<value_type> mSlots;
+	std::vector<U8> mUsed;
+	U32 mSize;
+};
+
+// Counterparts of the std::map helpers in llstl.h
+template <typename T>
+inline T* get_ptr_in_map(const LLUUIDHashMap<T*>& inmap, const LLUUID& key)
+{
+	typename LLUUIDHashMap<T*>::const_iterator iter = inmap.find(key);
+	return iter == inmap.end() ? NULL : iter->second;
+}
+
+template <typename T>
+inline bool is_in_map(const LLUUIDHashMap<T>& inmap, const LLUUID& key)
+{
+	return inmap.find(key) != inmap.end();
+}
+
+template <typename T>
+inline T get_if_there(const LLUUIDHashMap<T>& inmap, const LLUUID& key, T default_value)
+{
+	typename LLUUIDHashMap<T>::const_iterator iter = inmap.find(key);
+	return iter == inmap.end() ? default_value : iter->second;
+}
+
+#endif // LL_LLUUIDHASHMAP_H
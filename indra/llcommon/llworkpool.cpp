@@ -0,0 +1,142 @@
+/**
+ * @file llworkpool.cpp
+ * @brief Spreads a batch of independent jobs over a set of threads.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llworkpool.h"
+
+#include "llmutex.h"
+#include "llstring.h"
+#include "llthread.h"
+#include "lltimer.h"
+
+class LLWorkPool::Worker : public LLThread
+{
+public:
+	Worker(LLWorkPool* pool, const std::string& name)
+	:	LLThread(name),
+		mPool(pool)
+	{}
+
+protected:
+	/*virtual*/ void run()
+	{
+		mPool->workerLoop();
+	}
+
+private:
+	LLWorkPool* mPool;
+};
+
+LLWorkPool::LLWorkPool(const std::string& name, U32 threads)
+:	mCondition(new LLCondition(NULL)),
+	mJob(NULL),
+	mCount(0),
+	mNext(0),
+	mDone(0),
+	mQuitting(false)
+{
+	for (U32 i = 0; i < threads; ++i)
+	{
+		mThreads.push_back(new Worker(this, llformat("%s %d", name.c_str(), i)));
+		mThreads.back()->start();
+	}
+}
+
+LLWorkPool::~LLWorkPool()
+{
+	mCondition->lock();
+	mQuitting = true;
+	mCondition->broadcast();
+	mCondition->unlock();
+
+	for (std::vector<Worker*>::iterator it = mThreads.begin(); it != mThreads.end(); ++it)
+	{
+		// LLThread::shutdown() polls every 100ms, these exit right away
+		while (!(*it)->isStopped())
+		{
+			ms_sleep(1);
+		}
+		delete *it;
+	}
+	delete mCondition;
+}
+
+void LLWorkPool::run(U32 count, const job_t& job)
+{
+	if (mThreads.empty() || count < 2)
+	{
+		for (U32 i = 0; i < count; ++i)
+		{
+			job(i);
+		}
+		return;
+	}
+
+	mCondition->lock();
+	mJob = &job;
+	mCount = count;
+	mNext = 0;
+	mDone = 0;
+	mCondition->broadcast();
+	while (mNext < mCount)
+	{
+		U32 index = mNext++;
+		mCondition->unlock();
+		job(index);
+		mCondition->lock();
+		++mDone;
+	}
+	while (mDone < mCount)
+	{
+		mCondition->wait();
+	}
+	mJob = NULL;
+	mCondition->unlock();
+}
+
+void LLWorkPool::workerLoop()
+{
+	mCondition->lock();
+	while (!mQuitting)
+	{
+		if (!mJob || mNext >= mCount)
+		{
+			mCondition->wait();
+			continue;
+		}
+		U32 index = mNext++;
+		const job_t* job = mJob;
+		mCondition->unlock();
+		(*job)(index);
+		mCondition->lock();
+		if (++mDone == mCount)
+		{
+			mCondition->broadcast();
+		}
+	}
+	mCondition->unlock();
+}
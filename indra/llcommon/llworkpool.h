@@ -0,0 +1,80 @@
+/**
+ * @file llworkpool.h
+ * @brief Spreads a batch of independent jobs over a set of threads.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLWORKPOOL_H
+#define LL_LLWORKPOOL_H
+
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+
+class LLCondition;
+
+//
+// LLWorkPool
+//
+// Threads that stay around between batches of short jobs, for work done
+// every frame where starting threads or queueing LLWorkerThread requests
+// would cost more than the jobs themselves.  run() hands out job indices
+// one at a time, so jobs of uneven size still balance, and the calling
+// thread takes jobs too rather than sit waiting.
+//
+class LL_COMMON_API LLWorkPool
+{
+	LOG_CLASS(LLWorkPool);
+public:
+	// called once with each index of the batch
+	typedef boost::function<void (U32 index)> job_t;
+
+	// threads may be 0, in which case run() does everything itself
+	LLWorkPool(const std::string& name, U32 threads);
+	~LLWorkPool();
+
+	U32 getThreadCount() const { return mThreads.size(); }
+
+	// Calls job for every index in [0, count) and returns once all calls
+	// have.  Jobs run in no particular order and must not call run() on
+	// the same pool.
+	void run(U32 count, const job_t& job);
+
+private:
+	class Worker;
+	friend class Worker;
+
+	void workerLoop();
+
+	std::vector<Worker*> mThreads;
+
+	// guards everything below
+	LLCondition* mCondition;
+	const job_t* mJob;
+	U32 mCount;
+	U32 mNext;
+	U32 mDone;
+	bool mQuitting;
+};
+
+#endif // LL_LLWORKPOOL_H
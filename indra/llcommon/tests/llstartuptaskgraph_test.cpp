@@ -0,0 +1,148 @@
+/**
+ * @file   llstartuptaskgraph_test.cpp
+ * @brief  Test for llstartuptaskgraph.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
+
+#include "../llstartuptaskgraph.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+using boost::assign::list_of;
+
+namespace
+{
+	bool append_name(std::string* log, const std::string& name)
+	{
+		*log += name + " ";
+		return true;
+	}
+
+	bool fail_task()
+	{
+		return false;
+	}
+
+	bool sleep_and_log(std::string* log, const std::string& name, U32 ms)
+	{
+		ms_sleep(ms);
+		return append_name(log, name);
+	}
+}
+
+namespace tut
+{
+	struct llstartuptaskgraph_data
+	{
+		LLStartupTaskGraph::task_t logger(const std::string& name)
+		{
+			return boost::bind(append_name, &mLog, name);
+		}
+
+		std::string mLog;
+	};
+	typedef test_group<llstartuptaskgraph_data> llstartuptaskgraph_test;
+	typedef llstartuptaskgraph_test::object llstartuptaskgraph_object;
+	tut::llstartuptaskgraph_test tllstartuptaskgraph("LLStartupTaskGraph");
+
+	template<> template<>
+	void llstartuptaskgraph_object::test<1>()
+	{
+		// dependencies are honoured, deferred tasks wait unless needed
+		LLStartupTaskGraph graph;
+		graph.add("window", logger("window"), LLStartupTaskGraph::AT_STARTUP, list_of("settings")("fonts"));
+		graph.add("fonts", logger("fonts"), LLStartupTaskGraph::AT_STARTUP, list_of("settings"));
+		graph.add("settings", logger("settings"));
+		graph.add("spelling", logger("spelling"), LLStartupTaskGraph::DEFERRED, list_of("settings"));
+		graph.add("colors", logger("colors"), LLStartupTaskGraph::DEFERRED);
+		graph.add("login", logger("login"), LLStartupTaskGraph::AT_STARTUP, list_of("colors")("window"));
+
+		ensure("run", graph.run());
+		ensure("colors pulled in before login", mLog.find("colors") < mLog.find("login"));
+		ensure("settings before fonts", mLog.find("settings") < mLog.find("fonts"));
+		ensure("fonts before window", mLog.find("fonts") < mLog.find("window"));
+		ensure("window before login", mLog.find("window") < mLog.find("login"));
+		ensure("spelling deferred", mLog.find("spelling") == std::string::npos);
+
+		ensure("deferred done", graph.runDeferred());
+		ensure("spelling ran later", mLog.find("spelling") > mLog.find("login"));
+		ensure_equals("each ran once", mLog.size(), std::string("settings fonts window colors login spelling ").size());
+
+		std::string report = graph.getReport();
+		ensure("report lists tasks", report.find("spelling") != std::string::npos);
+		ensure("report has longest chain", report.find("Longest chain") != std::string::npos);
+		ensure("deferred task not on the chain", report.find("> spelling") == std::string::npos);
+	}
+
+	template<> template<>
+	void llstartuptaskgraph_object::test<2>()
+	{
+		// a failed task stops the run before anything that follows it
+		LLStartupTaskGraph graph;
+		graph.add("settings", logger("settings"));
+		graph.add("hardware", fail_task, LLStartupTaskGraph::AT_STARTUP, list_of("settings"));
+		graph.add("window", logger("window"), LLStartupTaskGraph::AT_STARTUP, list_of("hardware"));
+		ensure("run failed", !graph.run());
+		ensure("window not built", mLog.find("window") == std::string::npos);
+		ensure("report marks failure", graph.getReport().find("failed") != std::string::npos);
+
+		// a cycle is reported rather than run
+		LLStartupTaskGraph cycle;
+		cycle.add("a", logger("a"), LLStartupTaskGraph::AT_STARTUP, list_of("b"));
+		cycle.add("b", logger("b"), LLStartupTaskGraph::AT_STARTUP, list_of("a"));
+		ensure("cycle not run", !cycle.run());
+	}
+
+	template<> template<>
+	void llstartuptaskgraph_object::test<3>()
+	{
+		// the report's chain is the longest run of tasks that follow each
+		// other, not everything run
+		LLStartupTaskGraph graph;
+		graph.add("settings", boost::bind(sleep_and_log, &mLog, "settings", 10));
+		graph.add("serial", boost::bind(sleep_and_log, &mLog, "serial", 20));
+		graph.add("fonts", boost::bind(sleep_and_log, &mLog, "fonts", 50), LLStartupTaskGraph::AT_STARTUP, list_of("settings"));
+		graph.add("window", boost::bind(sleep_and_log, &mLog, "window", 10), LLStartupTaskGraph::AT_STARTUP, list_of("settings"));
+		graph.add("login", logger("login"), LLStartupTaskGraph::AT_STARTUP, list_of("fonts")("window"));
+		ensure("run", graph.run());
+		const std::string report = graph.getReport();
+		ensure("longest chain", report.find("settings > fonts > login") != std::string::npos);
+		ensure("serial off the chain", report.find("> serial") == std::string::npos && report.find("serial >") == std::string::npos);
+
+		// deferred tasks spread over calls, at least one a call
+		graph.add("colors", logger("colors"), LLStartupTaskGraph::DEFERRED);
+		graph.add("spelling", logger("spelling"), LLStartupTaskGraph::DEFERRED, list_of("colors"));
+		ensure("one left", !graph.runDeferred(0.000001f));
+		ensure("colors ran", mLog.find("colors") != std::string::npos);
+		ensure("spelling waits", mLog.find("spelling") == std::string::npos);
+		ensure("none left", graph.runDeferred(0.000001f));
+		ensure("spelling after colors", mLog.find("spelling") > mLog.find("colors"));
+		LL_INFOS() << "Startup task report:\n" << graph.getReport() << LL_ENDL;
+	}
+}
@@ -0,0 +1,206 @@
+/**
+ * @file   llsubstringindex_test.cpp
+ * @brief  Test for llsubstringindex.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "../llsubstringindex.h"
+#include "../llworkpool.h"
+#include "llstring.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// the slots holding text, found the slow way
+	std::vector<S32> scan(const std::vector<std::string>& names, const std::string& text)
+	{
+		std::vector<S32> slots;
+		for (S32 slot = 0; slot < (S32)names.size(); ++slot)
+		{
+			if (names[slot].find(text) != std::string::npos)
+			{
+				slots.push_back(slot);
+			}
+		}
+		return slots;
+	}
+
+	// inventory like names, upper cased as the inventory filter folds them
+	std::string make_name(U32 i)
+	{
+		static const char* const words[] = { "SHIRT", "PANTS", "HAIR", "SKIN", "SHAPE", "TEXTURE", "SCRIPT", "NOTECARD", "LANDMARK", "GESTURE", "SOUND", "OBJECT" };
+		const U32 num_words = LL_ARRAY_SIZE(words);
+		return llformat("%s %s %u (%u)", words[i % num_words], words[(i / num_words) % num_words], i, (i * 7919) % 1000);
+	}
+}
+
+namespace tut
+{
+	struct llsubstringindex_data
+	{
+	};
+	typedef test_group<llsubstringindex_data> llsubstringindex_test;
+	typedef llsubstringindex_test::object llsubstringindex_object;
+	tut::llsubstringindex_test tllsubstringindex("LLSubstringIndex");
+
+	template<> template<>
+	void llsubstringindex_object::test<1>()
+	{
+		// searches shorter than, as long as and longer than a trigram
+		LLSubstringIndex index;
+		S32 shirt = index.add("BLUE SHIRT");
+		S32 pants = index.add("BLUE PANTS");
+		S32 hat = index.add("HAT");
+
+		LLSubstringIndex::Matches matches;
+		index.find("BLUE", matches);
+		ensure_equals("two blue", (U32)matches.getSlots().size(), 2U);
+		ensure_equals("shirt offset", (U32)matches.getOffset(shirt), 0U);
+		ensure_equals("pants offset", (U32)matches.getOffset(pants), 0U);
+		ensure("no blue hat", matches.getOffset(hat) == std::string::npos);
+
+		index.find("T", matches);
+		ensure_equals("three t", (U32)matches.getSlots().size(), 3U);
+		ensure_equals("t in hat", (U32)matches.getOffset(hat), 2U);
+
+		index.find("SHIRTS", matches);
+		ensure("no shirts", matches.getSlots().empty());
+		index.find("XYZ", matches);
+		ensure("unknown trigram", matches.getSlots().empty());
+	}
+
+	template<> template<>
+	void llsubstringindex_object::test<2>()
+	{
+		// renamed and removed slots are not current in older matches
+		LLSubstringIndex index;
+		S32 shirt = index.add("BLUE SHIRT");
+		S32 pants = index.add("RED PANTS");
+
+		LLSubstringIndex::Matches matches;
+		index.find("SHIRT", matches);
+		ensure("current", matches.isCurrent(index, shirt));
+		ensure_equals("offset", (U32)matches.getOffset(shirt), 5U);
+
+		index.update(shirt, "SHIRT");
+		ensure("renamed", !matches.isCurrent(index, shirt));
+		ensure("untouched", matches.isCurrent(index, pants));
+
+		// refining picks up the rename
+		index.find("SHIRT", matches);
+		ensure_equals("new offset", (U32)matches.getOffset(shirt), 0U);
+
+		index.remove(pants);
+		ensure("removed", !matches.isCurrent(index, pants));
+		S32 hat = index.add("RED HAT");
+		ensure_equals("slot reused", hat, pants);
+		index.find("PANTS", matches);
+		ensure("no removed pants", matches.getSlots().empty());
+		ensure_equals("size", index.size(), 2U);
+	}
+
+	template<> template<>
+	void llsubstringindex_object::test<3>()
+	{
+		// typing one letter at a time refines, deleting does not, with and
+		// without a pool and with names changing in between
+		std::vector<std::string> names;
+		LLSubstringIndex index;
+		for (U32 i = 0; i < 20000; ++i)
+		{
+			names.push_back(make_name(i));
+			index.add(names.back());
+		}
+
+		LLWorkPool pool("Test pool", 3);
+		const char* const typed[] = { "S", "SH", "SHI", "SHIRT", "SHIRT P", "SHIRT PANTS 1", "SHIRT PANTS", "PANTS", "AN", "3 (" };
+		for (U32 with_pool = 0; with_pool < 2; ++with_pool)
+		{
+			LLSubstringIndex::Matches matches;
+			for (U32 i = 0; i < LL_ARRAY_SIZE(typed); ++i)
+			{
+				index.find(typed[i], matches, with_pool ? &pool : NULL);
+				ensure("same as scan", matches.getSlots() == scan(names, typed[i]));
+
+				// rename a few between keystrokes
+				for (U32 j = i; j < names.size(); j += 997)
+				{
+					names[j] = make_name(j * 31 + i);
+					index.update(j, names[j]);
+				}
+			}
+		}
+	}
+
+	template<> template<>
+	void llsubstringindex_object::test<4>()
+	{
+		// 200k item inventory, typing a search one letter at a time
+		const U32 NUM_NAMES = 200000;
+		std::vector<std::string> names;
+		names.reserve(NUM_NAMES);
+		LLSubstringIndex index;
+		for (U32 i = 0; i < NUM_NAMES; ++i)
+		{
+			names.push_back(make_name(i));
+			index.add(names.back());
+		}
+
+		LLWorkPool pool("Test pool", 3);
+		const char* const typed[] = { "L", "LA", "LAN", "LAND", "LANDM", "LANDMARK", "LANDMARK S", "LANDMARK SO", "LANDMARK SOUND 1" };
+
+		LLTimer timer;
+		for (U32 i = 0; i < LL_ARRAY_SIZE(typed); ++i)
+		{
+			scan(names, typed[i]);
+		}
+		F64 scan_time = timer.getElapsedTimeF64();
+
+		LLSubstringIndex::Matches matches;
+		timer.reset();
+		for (U32 i = 0; i < LL_ARRAY_SIZE(typed); ++i)
+		{
+			index.find(typed[i], matches);
+		}
+		F64 index_time = timer.getElapsedTimeF64();
+
+		matches.clear();
+		timer.reset();
+		for (U32 i = 0; i < LL_ARRAY_SIZE(typed); ++i)
+		{
+			index.find(typed[i], matches, &pool);
+		}
+		F64 pool_time = timer.getElapsedTimeF64();
+
+		ensure("same as scan", matches.getSlots() == scan(names, typed[LL_ARRAY_SIZE(typed) - 1]));
+
+		LL_INFOS() << NUM_NAMES << " names, " << LL_ARRAY_SIZE(typed) << " keystrokes: scan " << scan_time * 1000.0
+			<< "ms, index " << index_time * 1000.0 << "ms, index over " << pool.getThreadCount() + 1
+			<< " threads " << pool_time * 1000.0 << "ms" << LL_ENDL;
+	}
+}
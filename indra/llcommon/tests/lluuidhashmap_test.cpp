@@ -0,0 +1,254 @@
+/**
+ * @file   lluuidhashmap_test.cpp
+ * @brief  Test for lluuidhashmap.h.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <map>
+
+#include "lluuidhashmap.h"
+#include "llstl.h"
+#include "lltimer.h"
+#include "../test/lltut.h"
+
+namespace
+{
+	// Stand in for the inventory model: objects by id, and the children of
+	// each folder by parent id, with MAP picking the container.
+	struct TreeNode
+	{
+		LLUUID mID;
+		LLUUID mParentID;
+		bool mIsFolder;
+	};
+	typedef std::vector<const TreeNode*> node_array_t;
+
+	template <template <class> class MAP>
+	struct InventoryTree
+	{
+		typedef typename MAP<const TreeNode*>::type object_map_t;
+		typedef typename MAP<node_array_t*>::type parent_map_t;
+
+		~InventoryTree()
+		{
+			std::for_each(mFolderChildren.begin(), mFolderChildren.end(), DeletePairedPointer());
+			std::for_each(mItemChildren.begin(), mItemChildren.end(), DeletePairedPointer());
+		}
+
+		// same passes as LLInventoryModel::buildParentChildMap()
+		void build(const std::vector<TreeNode>& nodes)
+		{
+			for (U32 i = 0; i < nodes.size(); ++i)
+			{
+				mObjects[nodes[i].mID] = &nodes[i];
+				if (nodes[i].mIsFolder)
+				{
+					mFolderChildren[nodes[i].mID] = new node_array_t;
+					mItemChildren[nodes[i].mID] = new node_array_t;
+				}
+			}
+			mFolderChildren[LLUUID::null] = new node_array_t;
+			for (typename object_map_t::const_iterator it = mObjects.begin(); it != mObjects.end(); ++it)
+			{
+				const TreeNode* node = it->second;
+				node_array_t* children = get_ptr_in_map(node->mIsFolder ? mFolderChildren : mItemChildren, node->mParentID);
+				if (children)
+				{
+					children->push_back(node);
+				}
+			}
+		}
+
+		// same walk as LLInventoryModel::collectDescendentsIf()
+		void collect(const LLUUID& id, node_array_t& folders, node_array_t& items) const
+		{
+			node_array_t* children = get_ptr_in_map(mFolderChildren, id);
+			if (children)
+			{
+				for (U32 i = 0; i < children->size(); ++i)
+				{
+					folders.push_back((*children)[i]);
+					collect((*children)[i]->mID, folders, items);
+				}
+			}
+			children = get_ptr_in_map(mItemChildren, id);
+			if (children)
+			{
+				items.insert(items.end(), children->begin(), children->end());
+			}
+		}
+
+		object_map_t mObjects;
+		parent_map_t mFolderChildren;
+		parent_map_t mItemChildren;
+	};
+
+	template <class T> struct StdMap { typedef std::map<LLUUID, T> type; };
+	template <class T> struct HashMap { typedef LLUUIDHashMap<T> type; };
+
+	struct BenchmarkResult
+	{
+		F64 mBuild;
+		F64 mLookup;
+		F64 mCollect;
+		U32 mFound;
+		U32 mCollected;
+	};
+
+	template <template <class> class MAP>
+	BenchmarkResult run_benchmark(const std::vector<TreeNode>& nodes, const std::vector<LLUUID>& lookups)
+	{
+		BenchmarkResult result;
+		LLTimer timer;
+		InventoryTree<MAP> tree;
+		tree.build(nodes);
+		result.mBuild = timer.getElapsedTimeF64();
+
+		timer.reset();
+		result.mFound = 0;
+		for (U32 i = 0; i < lookups.size(); ++i)
+		{
+			result.mFound += tree.mObjects.count(lookups[i]);
+		}
+		result.mLookup = timer.getElapsedTimeF64();
+
+		timer.reset();
+		node_array_t folders;
+		node_array_t items;
+		tree.collect(LLUUID::null, folders, items);
+		result.mCollect = timer.getElapsedTimeF64();
+		result.mCollected = folders.size() + items.size();
+		return result;
+	}
+}
+
+namespace tut
+{
+	struct lluuidhashmap_data
+	{
+		LLUUID makeID(U32 n)
+		{
+			// the last byte only, like the well known ids
+			LLUUID id;
+			memcpy(id.mData + UUID_BYTES - sizeof(n), &n, sizeof(n));
+			return id;
+		}
+	};
+	typedef test_group<lluuidhashmap_data> lluuidhashmap_test;
+	typedef lluuidhashmap_test::object lluuidhashmap_object;
+	tut::lluuidhashmap_test tlluuidhashmap("LLUUIDHashMap");
+
+	template<> template<>
+	void lluuidhashmap_object::test<1>()
+	{
+		// basic map behaviour, including the null id as a key
+		LLUUIDHashMap<S32> map;
+		ensure("starts empty", map.empty());
+		ensure("missing key", map.find(LLUUID::null) == map.end());
+		map[LLUUID::null] = 7;
+		ensure_equals("null key", map[LLUUID::null], 7);
+		ensure_equals("size", map.size(), (size_t) 1);
+		ensure_equals("erase missing", map.erase(makeID(1)), (size_t) 0);
+		ensure_equals("erase", map.erase(LLUUID::null), (size_t) 1);
+		ensure("empty again", map.empty());
+		ensure("no entries left", map.begin() == map.end());
+	}
+
+	template<> template<>
+	void lluuidhashmap_object::test<2>()
+	{
+		// stays in step with std::map through growth and removal, including
+		// ids that only differ in one byte and so share probe runs
+		LLUUIDHashMap<U32> map;
+		std::map<LLUUID, U32> expected;
+		for (U32 i = 0; i < 5000; ++i)
+		{
+			LLUUID id = (i % 2) ? makeID(i) : LLUUID::generateNewID();
+			map[id] = i;
+			expected[id] = i;
+			if (i % 3 == 0)
+			{
+				// drop an earlier entry
+				std::map<LLUUID, U32>::iterator victim = expected.begin();
+				std::advance(victim, i % expected.size());
+				ensure_equals("erased", map.erase(victim->first), (size_t) 1);
+				expected.erase(victim);
+			}
+		}
+
+		ensure_equals("size", map.size(), expected.size());
+		for (std::map<LLUUID, U32>::const_iterator it = expected.begin(); it != expected.end(); ++it)
+		{
+			LLUUIDHashMap<U32>::const_iterator found = map.find(it->first);
+			ensure("found", found != map.end());
+			ensure_equals("value", found->second, it->second);
+		}
+		size_t visited = 0;
+		for (LLUUIDHashMap<U32>::const_iterator it = map.begin(); it != map.end(); ++it)
+		{
+			ensure_equals("iterated entry", expected[it->first], it->second);
+			++visited;
+		}
+		ensure_equals("iterated all", visited, expected.size());
+
+		map.clear();
+		ensure("cleared", map.empty() && map.find(expected.begin()->first) == map.end());
+	}
+
+	template<> template<>
+	void lluuidhashmap_object::test<3>()
+	{
+		// Time the inventory model's hot paths against std::map on a
+		// synthetic inventory.  Set INVENTORY_MAP_BENCHMARK for 200k items.
+		U32 item_count = getenv("INVENTORY_MAP_BENCHMARK") ? 200000 : 20000;
+		U32 folder_count = item_count / 20;
+		std::vector<TreeNode> nodes(folder_count + item_count);
+		for (U32 i = 0; i < nodes.size(); ++i)
+		{
+			TreeNode& node = nodes[i];
+			node.mID.generate();
+			node.mIsFolder = i < folder_count;
+			// folders nest under earlier folders, the first is the root
+			node.mParentID = (i == 0) ? LLUUID::null : nodes[i < folder_count ? (i - 1) / 4 : i % folder_count].mID;
+		}
+		std::vector<LLUUID> lookups;
+		for (U32 i = 0; i < item_count; ++i)
+		{
+			lookups.push_back(nodes[(i * 7919) % nodes.size()].mID);
+			lookups.push_back(LLUUID::generateNewID());
+		}
+
+		BenchmarkResult tree_map = run_benchmark<StdMap>(nodes, lookups);
+		BenchmarkResult hash_map = run_benchmark<HashMap>(nodes, lookups);
+		ensure_equals("same lookups", hash_map.mFound, tree_map.mFound);
+		ensure_equals("every lookup of a real id found", hash_map.mFound, item_count);
+		ensure_equals("whole tree collected", hash_map.mCollected, (U32) nodes.size());
+		ensure_equals("same tree", hash_map.mCollected, tree_map.mCollected);
+
+		LL_INFOS() << item_count << " items, std::map build " << tree_map.mBuild << "s lookup " << tree_map.mLookup
+				   << "s collect " << tree_map.mCollect << "s; hash map build " << hash_map.mBuild
+				   << "s lookup " << hash_map.mLookup << "s collect " << hash_map.mCollect << "s" << LL_ENDL;
+	}
+}
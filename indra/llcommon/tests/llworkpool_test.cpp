@@ -0,0 +1,116 @@
+/**
+ * @file   llworkpool_test.cpp
+ * @brief  Test for llworkpool.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <boost/bind.hpp>
+
+#include <set>
+
+#include "../llworkpool.h"
+#include "llapr.h"
+#include "llmutex.h"
+#include "llthread.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	void square(std::vector<U32>* results, U32 index)
+	{
+		(*results)[index] += index * index;
+	}
+
+	// Jobs that wait, for a while, until enough others have started, then
+	// note the thread they ran on.  A thread only runs one job at a time,
+	// so the first to start can only all get going on different threads.
+	struct Meeting
+	{
+		Meeting(S32 parties) : mParties(parties), mArrived(0) {}
+
+		const S32 mParties;
+		LLAtomicS32 mArrived;
+		LLMutex mMutex;
+		std::set<U32> mThreads;
+	};
+
+	void meet(Meeting* meeting, U32 index)
+	{
+		++meeting->mArrived;
+		LLTimer timer;
+		while (meeting->mArrived.CurrentValue() < meeting->mParties
+			   && timer.getElapsedTimeF32() < 10.f)
+		{
+			ms_sleep(1);
+		}
+		LLMutexLock lock(&meeting->mMutex);
+		meeting->mThreads.insert(LLThread::currentID());
+	}
+}
+
+namespace tut
+{
+	struct llworkpool_data
+	{
+	};
+	typedef test_group<llworkpool_data> llworkpool_test;
+	typedef llworkpool_test::object llworkpool_object;
+	tut::llworkpool_test tllworkpool("LLWorkPool");
+
+	template<> template<>
+	void llworkpool_object::test<1>()
+	{
+		// every index runs exactly once, with or without threads, batch after batch
+		for (U32 threads = 0; threads < 4; ++threads)
+		{
+			LLWorkPool pool("Test pool", threads);
+			ensure_equals("threads", pool.getThreadCount(), threads);
+			for (U32 batch = 0; batch < 20; ++batch)
+			{
+				std::vector<U32> results(1000, 0);
+				pool.run(results.size(), boost::bind(square, &results, _1));
+				for (U32 i = 0; i < results.size(); ++i)
+				{
+					ensure_equals("result", results[i], i * i);
+				}
+			}
+			pool.run(0, boost::bind(square, (std::vector<U32>*) NULL, _1));
+		}
+	}
+
+	template<> template<>
+	void llworkpool_object::test<2>()
+	{
+		// the calling thread and the workers share the batch
+		LLWorkPool pool("Test pool", 3);
+		Meeting meeting(4);
+		pool.run(8, boost::bind(meet, &meeting, _1));
+		ensure_equals("all started", meeting.mArrived.CurrentValue(), 8);
+		ensure_equals("every thread took a job", meeting.mThreads.size(), (size_t) 4);
+		ensure("caller took a job", meeting.mThreads.count(LLThread::currentID()) == 1);
+	}
+}
@@ -30,8 +30,10 @@
 #include "bufferarray.h"
 #include "_httpoprequest.h"
 #include "_httppolicy.h"
+#include "_httppolicyglobal.h"
 
 #include "llhttpconstants.h"
+#include "lltimer.h"
 
 namespace
 {
@@ -76,6 +78,7 @@ void HttpLibcurl::shutdown()
 
 		cancelRequest(op);
 	}
+	mReplay.stop();
 
 	if (mMultiHandles)
 	{
@@ -123,6 +126,16 @@ void HttpLibcurl::start(int policy_count)
 		mDirtyPolicy[policy_class] = false;
 		policyUpdated(policy_class);
 	}
+
+	const HttpPolicyGlobal & options(mService->getPolicy().getGlobalOptions());
+	if (! options.mPlaybackFile.empty())
+	{
+		mReplay.startPlayback(options.mPlaybackFile);
+	}
+	else if (! options.mRecordFile.empty())
+	{
+		mReplay.startRecording(options.mRecordFile);
+	}
 }
 
 
@@ -136,6 +149,11 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 {
 	HttpService::ELoopSpeed	ret(HttpService::REQUEST_SLEEP);
 
+	if (completeReplays())
+	{
+		ret = HttpService::NORMAL;
+	}
+
 	// Give libcurl some cycles to do I/O & callbacks
 	for (int policy_class(0); policy_class < mPolicyCount; ++policy_class)
 	{
@@ -207,6 +225,18 @@ void HttpLibcurl::addOp(const HttpOpRequest::ptr_t &op)
 {
 	llassert_always(op->mReqPolicy < mPolicyCount);
 	llassert_always(mMultiHandles[op->mReqPolicy] != NULL);
+
+	if (mReplay.isPlayingBack())
+	{
+		// Answer from the recording once its latency has passed
+		op->mStatus = HttpStatus();
+		op->scrubReply();
+		const HttpTime due(totalTime() + mReplay.playback(*op));
+		mReplayOps.insert(replay_map_t::value_type(due, op));
+		mActiveOps.insert(op);
+		++mActiveHandles[op->mReqPolicy];
+		return;
+	}
 	
 	// Create standard handle
 	if (! op->prepareRequest(mService))
@@ -226,6 +256,7 @@ void HttpLibcurl::addOp(const HttpOpRequest::ptr_t &op)
 		return;
 	}
 	op->mCurlActive = true;
+	op->mActiveTime = totalTime();
 	mActiveOps.insert(op);
 	++mActiveHandles[op->mReqPolicy];
 	
@@ -273,13 +304,28 @@ bool HttpLibcurl::cancel(HttpHandle handle)
 // op to the reply queue with refcount intact.
 void HttpLibcurl::cancelRequest(const HttpOpRequest::ptr_t &op)
 {
-	// Deactivate request
-	op->mCurlActive = false;
+	if (op->mCurlHandle)
+	{
+		// Deactivate request
+		op->mCurlActive = false;
 
-	// Detach from multi and recycle handle
-	curl_multi_remove_handle(mMultiHandles[op->mReqPolicy], op->mCurlHandle);
-	mHandleCache.freeHandle(op->mCurlHandle);
-	op->mCurlHandle = NULL;
+		// Detach from multi and recycle handle
+		curl_multi_remove_handle(mMultiHandles[op->mReqPolicy], op->mCurlHandle);
+		mHandleCache.freeHandle(op->mCurlHandle);
+		op->mCurlHandle = NULL;
+	}
+	else
+	{
+		// Played back, drop it from the waiting replies
+		for (replay_map_t::iterator it(mReplayOps.begin()); mReplayOps.end() != it; ++it)
+		{
+			if (it->second == op)
+			{
+				mReplayOps.erase(it);
+				break;
+			}
+		}
+	}
 
 	// Tracing
 	if (op->mTracing > HTTP_TRACE_OFF)
@@ -412,6 +458,8 @@ bool HttpLibcurl::completeRequest(CURLM * multi_handle, CURL * handle, CURLcode
 						    << LL_ENDL;
 	}
 
+	mReplay.record(*op, totalTime() - op->mActiveTime);
+
 	// Dispatch to next stage
 	HttpPolicy & policy(mService->getPolicy());
 	bool still_active(policy.stageAfterCompletion(op));
@@ -420,6 +468,33 @@ bool HttpLibcurl::completeRequest(CURLM * multi_handle, CURL * handle, CURLcode
 }
 
 
+bool HttpLibcurl::completeReplays()
+{
+	bool completed(false);
+	const HttpTime now(totalTime());
+	while (! mReplayOps.empty() && mReplayOps.begin()->first <= now)
+	{
+		HttpOpRequest::ptr_t op(mReplayOps.begin()->second);
+		mReplayOps.erase(mReplayOps.begin());
+
+		mActiveOps.erase(op);
+		--mActiveHandles[op->mReqPolicy];
+
+		if (op->mTracing > HTTP_TRACE_OFF)
+		{
+			LL_INFOS(LOG_CORE) << "TRACE, RequestPlayedBack, Handle:  "
+							   << op->getHandle()
+							   << ", Status:  " << op->mStatus.toTerseString()
+							   << LL_ENDL;
+		}
+
+		mService->getPolicy().stageAfterCompletion(op);
+		completed = true;
+	}
+	return completed;
+}
+
+
 int HttpLibcurl::getActiveCount() const
 {
 	return mActiveOps.size();
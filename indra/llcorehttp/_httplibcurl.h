@@ -32,11 +32,13 @@
 #include <curl/curl.h>
 #include <curl/multi.h>
 
+#include <map>
 #include <set>
 
 #include "httprequest.h"
 #include "_httpservice.h"
 #include "_httpinternal.h"
+#include "_httpreplay.h"
 
 
 namespace LLCore
@@ -50,6 +52,12 @@ class HttpHeaders;
 
 /// Implements libcurl-based transport for an HttpService instance.
 ///
+/// When the PO_PLAYBACK_FILE option is set, requests never reach
+/// libcurl.  They are answered from the recording instead, after
+/// the recorded latency, while still counting against their policy
+/// class's connection limit.  PO_RECORD_FILE records every reply
+/// libcurl completes.
+///
 /// Threading:  Single-threaded.  Other than for construction/destruction,
 /// all methods are expected to be invoked in a single thread, typically
 /// a worker thread of some sort.
@@ -151,9 +159,14 @@ protected:
 	/// Invoked to cancel an active request, mainly during shutdown
 	/// and destroy.
     void cancelRequest(const opReqPtr_t &op);
+
+	/// Hands over played-back requests whose recorded latency has
+	/// passed.  Returns true if any were completed.
+	bool completeReplays();
 	
 protected:
     typedef std::set<opReqPtr_t> active_set_t;
+    typedef std::multimap<HttpTime, opReqPtr_t> replay_map_t;
 
 	/// Simple request handle cache for libcurl.
 	///
@@ -215,6 +228,8 @@ protected:
 	CURLM **			mMultiHandles;		// One handle per policy class
 	int *				mActiveHandles;		// Active count per policy class
 	bool *				mDirtyPolicy;		// Dirty policy update waiting for stall (per pc)
+	HttpReplay			mReplay;			// Recording or playback of replies
+	replay_map_t		mReplayOps;			// Played-back requests by due time
 	
 }; // end class HttpLibcurl
 
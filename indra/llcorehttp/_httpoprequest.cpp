@@ -131,6 +131,7 @@ HttpOpRequest::HttpOpRequest()
 	  mCurlBodyPos(0),
 	  mCurlTemp(NULL),
 	  mCurlTempLen(0),
+	  mActiveTime(HttpTime(0)),
 	  mReplyBody(NULL),
 	  mReplyOffset(0),
 	  mReplyLength(0),
@@ -445,6 +446,21 @@ void HttpOpRequest::setupCommon(HttpRequest::policy_t policy_id,
 // needs to be cleaned out.
 //
 // *TODO:  Move this to _httplibcurl where it belongs.
+void HttpOpRequest::scrubReply()
+{
+	if (mReplyBody)
+	{
+		mReplyBody->release();
+		mReplyBody = NULL;
+	}
+	mReplyOffset = 0;
+	mReplyLength = 0;
+	mReplyFullLength = 0;
+    mReplyHeaders.reset();
+	mReplyConType.clear();
+}
+
+
 HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
 {
 	CURLcode code;
@@ -460,16 +476,7 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
 	}
 	mCurlBodyPos = 0;
 
-	if (mReplyBody)
-	{
-		mReplyBody->release();
-		mReplyBody = NULL;
-	}
-	mReplyOffset = 0;
-	mReplyLength = 0;
-	mReplyFullLength = 0;
-    mReplyHeaders.reset();
-	mReplyConType.clear();
+	scrubReply();
 	
 	// *FIXME:  better error handling later
 	HttpStatus status;
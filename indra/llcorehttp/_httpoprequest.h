@@ -65,6 +65,8 @@ class BufferArray;
 ///
 class HttpOpRequest : public HttpOperation
 {
+	friend class HttpReplay;
+
 public:
     typedef boost::shared_ptr<HttpOpRequest> ptr_t;
 
@@ -162,6 +164,13 @@ public:
 	// Threading:  called by worker thread
 	//
 	HttpStatus prepareRequest(HttpService * service);
+
+	// Clears out the results of any earlier try ahead of
+	// another one, whether over libcurl or from a recording.
+	//
+	// Threading:  called by worker thread
+	//
+	void scrubReply();
 	
 	virtual HttpStatus cancel();
 
@@ -216,6 +225,7 @@ public:
 	size_t				mCurlBodyPos;
 	char *				mCurlTemp;				// Scratch buffer for header processing
 	size_t				mCurlTempLen;
+	HttpTime			mActiveTime;			// When the transport took the request
 	
 	// Result data
 	HttpStatus			mStatus;
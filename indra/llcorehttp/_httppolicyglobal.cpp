@@ -52,6 +52,8 @@ HttpPolicyGlobal & HttpPolicyGlobal::operator=(const HttpPolicyGlobal & other)
 		mCAPath = other.mCAPath;
 		mCAFile = other.mCAFile;
 		mHttpProxy = other.mHttpProxy;
+		mRecordFile = other.mRecordFile;
+		mPlaybackFile = other.mPlaybackFile;
 		mTrace = other.mTrace;
 		mUseLLProxy = other.mUseLLProxy;
 	}
@@ -99,6 +101,14 @@ HttpStatus HttpPolicyGlobal::set(HttpRequest::EPolicyOption opt, const std::stri
 		mCAFile = value;
 		break;
 
+	case HttpRequest::PO_RECORD_FILE:
+		mRecordFile = value;
+		break;
+
+	case HttpRequest::PO_PLAYBACK_FILE:
+		mPlaybackFile = value;
+		break;
+
 	default:
 		return HttpStatus(HttpStatus::LLCORE, HE_INVALID_ARG);
 	}
@@ -161,6 +171,14 @@ HttpStatus HttpPolicyGlobal::get(HttpRequest::EPolicyOption opt, std::string * v
 		*value = mHttpProxy;
 		break;
 
+	case HttpRequest::PO_RECORD_FILE:
+		*value = mRecordFile;
+		break;
+
+	case HttpRequest::PO_PLAYBACK_FILE:
+		*value = mPlaybackFile;
+		break;
+
 	default:
 		return HttpStatus(HttpStatus::LLCORE, HE_INVALID_ARG);
 	}
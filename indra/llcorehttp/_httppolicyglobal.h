@@ -70,6 +70,8 @@ public:
 	std::string			mCAPath;
 	std::string			mCAFile;
 	std::string			mHttpProxy;
+	std::string			mRecordFile;
+	std::string			mPlaybackFile;
 	long				mTrace;
 	long				mUseLLProxy;
 	HttpRequest::policyCallback_t	mSslCtxCallback;
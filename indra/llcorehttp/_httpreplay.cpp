@@ -0,0 +1,229 @@
+/**
+ * @file _httpreplay.cpp
+ * @brief Internal definitions for recording and replaying HTTP replies.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "_httpreplay.h"
+
+#include <sstream>
+
+#include "bufferarray.h"
+#include "httpheaders.h"
+#include "_httpoprequest.h"
+
+#include "llsdserialize.h"
+
+
+namespace
+{
+
+static const char * const LOG_CORE("CoreHttp");
+
+} // end anonymous namespace
+
+
+namespace LLCore
+{
+
+
+HttpReplay::HttpReplay()
+	: mRecordFile(NULL),
+	  mPlayingBack(false)
+{}
+
+
+HttpReplay::~HttpReplay()
+{
+	stop();
+}
+
+
+bool HttpReplay::startRecording(const std::string & filename)
+{
+	stop();
+
+	mRecordFile = new llofstream(filename.c_str(), std::ios::out | std::ios::binary);
+	if (! mRecordFile->is_open())
+	{
+		LL_WARNS(LOG_CORE) << "Unable to open HTTP recording " << filename << LL_ENDL;
+		stop();
+		return false;
+	}
+
+	LL_INFOS(LOG_CORE) << "Recording HTTP replies to " << filename << LL_ENDL;
+	return true;
+}
+
+
+bool HttpReplay::startPlayback(const std::string & filename)
+{
+	stop();
+
+	llifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+	if (! file.is_open())
+	{
+		LL_WARNS(LOG_CORE) << "Unable to open HTTP recording " << filename << LL_ENDL;
+		return false;
+	}
+
+	// Replies are queued per request in the order they were recorded
+	U32 count(0);
+	LLSD reply;
+	while (file.peek() != EOF
+		   && LLSDSerialize::fromBinary(reply, file, LLSDSerialize::SIZE_UNLIMITED) > 0
+		   && reply.isMap())
+	{
+		mReplies[reply["key"].asString()].push_back(reply);
+		++count;
+	}
+	if (! file.eof())
+	{
+		LL_WARNS(LOG_CORE) << "HTTP recording " << filename << " is damaged after "
+						   << count << " replies" << LL_ENDL;
+	}
+
+	mPlayingBack = true;
+	LL_INFOS(LOG_CORE) << "Playing back " << count << " HTTP replies to "
+					   << mReplies.size() << " requests from " << filename << LL_ENDL;
+	return true;
+}
+
+
+void HttpReplay::stop()
+{
+	if (mRecordFile)
+	{
+		mRecordFile->close();
+		delete mRecordFile;
+		mRecordFile = NULL;
+	}
+	mPlayingBack = false;
+	mReplies.clear();
+}
+
+
+void HttpReplay::record(const HttpOpRequest & op, HttpTime latency)
+{
+	if (! mRecordFile)
+	{
+		return;
+	}
+
+	LLSD reply;
+	reply["key"] = makeKey(op);
+	reply["latency"] = LLSD::Integer(latency / HttpTime(1000));			// mS
+	reply["type"] = LLSD::Integer(op.mStatus.getType());
+	reply["status"] = LLSD::Integer(op.mStatus.getStatus());
+	reply["content_type"] = op.mReplyConType;
+	reply["offset"] = LLSD::Integer(op.mReplyOffset);
+	reply["length"] = LLSD::Integer(op.mReplyLength);
+	reply["full_length"] = LLSD::Integer(op.mReplyFullLength);
+	reply["retry_after"] = LLSD::Integer(op.mReplyRetryAfter);
+
+	if (op.mReplyHeaders)
+	{
+		LLSD & headers(reply["headers"] = LLSD::emptyArray());
+		for (HttpHeaders::const_iterator it(op.mReplyHeaders->begin());
+			 op.mReplyHeaders->end() != it;
+			 ++it)
+		{
+			LLSD header;
+			header.append(it->first);
+			header.append(it->second);
+			headers.append(header);
+		}
+	}
+
+	if (op.mReplyBody && op.mReplyBody->size())
+	{
+		LLSD::Binary body(op.mReplyBody->size());
+		op.mReplyBody->read(0, &body[0], body.size());
+		reply["body"] = body;
+	}
+
+	LLSDSerialize::toBinary(reply, *mRecordFile);
+	if (! mRecordFile->good())
+	{
+		LL_WARNS(LOG_CORE) << "HTTP recording write failed, recording stopped" << LL_ENDL;
+		stop();
+	}
+}
+
+
+HttpTime HttpReplay::playback(HttpOpRequest & op)
+{
+	reply_map_t::iterator it(mReplies.find(makeKey(op)));
+	if (mReplies.end() == it || it->second.empty())
+	{
+		LL_DEBUGS(LOG_CORE) << "No recorded reply for " << op.mReqURL << LL_ENDL;
+		op.mStatus = HttpStatus(HttpStatus::LLCORE, HE_NOT_RECORDED);
+		return HttpTime(0);
+	}
+
+	const LLSD reply(it->second.front());
+	it->second.pop_front();
+
+	op.mStatus = HttpStatus(HttpStatus::type_enum_t(reply["type"].asInteger()),
+							short(reply["status"].asInteger()));
+	op.mReplyConType = reply["content_type"].asString();
+	op.mReplyOffset = reply["offset"].asInteger();
+	op.mReplyLength = reply["length"].asInteger();
+	op.mReplyFullLength = reply["full_length"].asInteger();
+	op.mReplyRetryAfter = reply["retry_after"].asInteger();
+
+	if (reply.has("headers") && (op.mProcFlags & HttpOpRequest::PF_SAVE_HEADERS))
+	{
+		op.mReplyHeaders = HttpHeaders::ptr_t(new HttpHeaders);
+		for (LLSD::array_const_iterator header(reply["headers"].beginArray());
+			 reply["headers"].endArray() != header;
+			 ++header)
+		{
+			op.mReplyHeaders->append((*header)[0].asString(), (*header)[1].asString());
+		}
+	}
+
+	const LLSD::Binary & body(reply["body"].asBinary());
+	if (! body.empty())
+	{
+		op.mReplyBody = new BufferArray();
+		op.mReplyBody->append(&body[0], body.size());
+	}
+
+	return HttpTime(reply["latency"].asInteger()) * HttpTime(1000);
+}
+
+
+std::string HttpReplay::makeKey(const HttpOpRequest & op)
+{
+	std::ostringstream key;
+	key << op.mReqMethod << ' ' << op.mReqURL;
+	if (op.mReqOffset || op.mReqLength)
+	{
+		key << ' ' << op.mReqOffset << '-' << op.mReqLength;
+	}
+	return key.str();
+}
+
+
+}   // end namespace LLCore
@@ -0,0 +1,107 @@
+/**
+ * @file _httpreplay.h
+ * @brief Internal declarations for recording and replaying HTTP replies.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef	_LLCORE_HTTP_REPLAY_H_
+#define	_LLCORE_HTTP_REPLAY_H_
+
+
+#include "linden_common.h"
+
+#include <deque>
+#include <map>
+
+#include "llfile.h"
+#include "llsd.h"
+#include "httpcommon.h"
+
+
+namespace LLCore
+{
+
+
+class HttpOpRequest;
+
+
+/// Capture of HTTP traffic for reproducible benchmarks.
+///
+/// While recording, the reply to every request the transport
+/// completes is appended to a file along with how long it took.
+/// During playback the network isn't used at all:  each request
+/// is answered with the next recorded reply for the same method,
+/// URL and byte range, after the recorded latency.  Request bodies
+/// aren't compared, login and other posts carry time-dependent
+/// fields, so repeated posts to one URL are answered in order.
+/// A request with no recorded reply left fails with HE_NOT_RECORDED.
+///
+/// Threading:  Single-threaded.  Started by the init thread before
+/// the worker starts, used by the worker thread after.
+class HttpReplay
+{
+public:
+	HttpReplay();
+	~HttpReplay();
+
+private:
+	HttpReplay(const HttpReplay &);				// Not defined
+	void operator=(const HttpReplay &);			// Not defined
+
+public:
+	bool startRecording(const std::string & filename);
+	bool startPlayback(const std::string & filename);
+	void stop();
+
+	bool isRecording() const
+		{
+			return NULL != mRecordFile;
+		}
+
+	bool isPlayingBack() const
+		{
+			return mPlayingBack;
+		}
+
+	/// Append the reply of a completed request that took 'latency'
+	/// microseconds on the wire.
+	void record(const HttpOpRequest & op, HttpTime latency);
+
+	/// Fill in the reply of a request from the recording and
+	/// return the recorded latency in microseconds.
+	HttpTime playback(HttpOpRequest & op);
+
+protected:
+	static std::string makeKey(const HttpOpRequest & op);
+
+protected:
+	typedef std::map<std::string, std::deque<LLSD> > reply_map_t;
+
+	llofstream *		mRecordFile;
+	bool				mPlayingBack;
+	reply_map_t			mReplies;
+};  // end class HttpReplay
+
+}   // end namespace LLCore
+
+#endif	// _LLCORE_HTTP_REPLAY_H_
@@ -253,7 +253,10 @@ enum HttpError
 	HE_INVALID_HTTP_STATUS = 9,
 	
 	// Couldn't allocate resource, typically libcurl handle
-	HE_BAD_ALLOC = 10
+	HE_BAD_ALLOC = 10,
+
+	// No recorded reply left for the request during HTTP playback
+	HE_NOT_RECORDED = 11
 	
 }; // end enum HttpError
 
@@ -233,6 +233,19 @@ public:
 		/// Global only
 		PO_SSL_VERIFY_CALLBACK,
 
+		/// String giving a full path to a file the reply to every
+		/// request is recorded to, for later playback.
+		///
+		/// Global only
+		PO_RECORD_FILE,
+
+		/// String giving a full path to a file recorded with
+		/// PO_RECORD_FILE.  When set, requests are answered from
+		/// the recording and the network isn't used.
+		///
+		/// Global only
+		PO_PLAYBACK_FILE,
+
 		PO_LAST  // Always at end
 	};
 
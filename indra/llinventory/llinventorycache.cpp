@@ -0,0 +1,720 @@
+/**
+ * @file llinventorycache.cpp
+ * @brief Binary inventory cache file reader and writer.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llinventorycache.h"
+
+#include <algorithm>
+
+#include "llinventory.h"
+#include "llxorcipher.h"
+
+#if LL_WINDOWS
+#include "llwin32headerslean.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// same key the text format uses to obscure asset ids
+static const LLUUID SHADOW_KEY("3c115e51-04f4-523c-9fa6-98aff1034730");
+
+static const char CACHE_MAGIC[4] = { 'L', 'L', 'I', 'C' };
+static const U32 BYTE_ORDER_MARK = 0x01020304;
+
+// type, then the size of the strings after the record
+static const U32 JOURNAL_ENTRY_HEADER_SIZE = 2 * sizeof(U32);
+
+static U32 base_size(const LLInventoryCache::Header& header)
+{
+	return sizeof(LLInventoryCache::Header)
+		+ header.mCategoryCount * sizeof(LLInventoryCache::CategoryRecord)
+		+ header.mItemCount * sizeof(LLInventoryCache::ItemRecord)
+		+ header.mStringBytes;
+}
+
+static U32 journal_record_size(U32 type)
+{
+	switch (type)
+	{
+		case LLInventoryCache::JOURNAL_CATEGORY: return sizeof(LLInventoryCache::CategoryRecord);
+		case LLInventoryCache::JOURNAL_ITEM: return sizeof(LLInventoryCache::ItemRecord);
+		case LLInventoryCache::JOURNAL_REMOVE: return sizeof(LLUUID);
+	}
+	return 0;
+}
+
+///----------------------------------------------------------------------------
+/// Class LLInventoryCache
+///----------------------------------------------------------------------------
+
+//static
+void LLInventoryCache::initHeader(Header& header)
+{
+	memset(&header, 0, sizeof(Header));
+	memcpy(header.mMagic, CACHE_MAGIC, sizeof(header.mMagic));
+	header.mByteOrder = BYTE_ORDER_MARK;
+	header.mVersion = FORMAT_VERSION;
+}
+
+//static
+bool LLInventoryCache::isHeaderValid(const Header& header)
+{
+	return memcmp(header.mMagic, CACHE_MAGIC, sizeof(header.mMagic)) == 0
+		&& header.mByteOrder == BYTE_ORDER_MARK
+		&& header.mVersion == FORMAT_VERSION;
+}
+
+///----------------------------------------------------------------------------
+/// Class LLInventoryCacheReader
+///----------------------------------------------------------------------------
+
+LLInventoryCacheReader::LLInventoryCacheReader()
+:	mData(NULL),
+	mSize(0),
+#if LL_WINDOWS
+	mFile(INVALID_HANDLE_VALUE),
+	mMapping(NULL),
+#else
+	mFile(-1),
+#endif
+	mJournalEntries(0)
+{
+}
+
+LLInventoryCacheReader::~LLInventoryCacheReader()
+{
+	close();
+}
+
+bool LLInventoryCacheReader::open(const std::string& filename)
+{
+	close();
+
+	if (!map(filename))
+	{
+		return false;
+	}
+
+	if (mSize < sizeof(LLInventoryCache::Header))
+	{
+		LL_WARNS("Inventory") << "Inventory cache " << filename << " is truncated" << LL_ENDL;
+		close();
+		return false;
+	}
+
+	LLInventoryCache::Header header;
+	memcpy(&header, mData, sizeof(header));
+	if (!LLInventoryCache::isHeaderValid(header))
+	{
+		LL_INFOS("Inventory") << "Inventory cache " << filename << " is from another version" << LL_ENDL;
+		close();
+		return false;
+	}
+
+	U32 journal_start = base_size(header);
+	if (journal_start > mSize || header.mJournalBytes > mSize - journal_start)
+	{
+		LL_WARNS("Inventory") << "Inventory cache " << filename << " is truncated" << LL_ENDL;
+		close();
+		return false;
+	}
+
+	const U8* records = mData + sizeof(LLInventoryCache::Header);
+	mCategories.resize(header.mCategoryCount);
+	for (U32 i = 0; i < header.mCategoryCount; ++i)
+	{
+		mCategories[i] = (const LLInventoryCache::CategoryRecord*) records;
+		records += sizeof(LLInventoryCache::CategoryRecord);
+	}
+	mItems.resize(header.mItemCount);
+	for (U32 i = 0; i < header.mItemCount; ++i)
+	{
+		mItems[i] = (const LLInventoryCache::ItemRecord*) records;
+		records += sizeof(LLInventoryCache::ItemRecord);
+	}
+
+	mJournalEntries = header.mJournalEntries;
+	if (!applyJournal(journal_start, header.mJournalBytes))
+	{
+		LL_WARNS("Inventory") << "Inventory cache " << filename << " has a corrupt journal" << LL_ENDL;
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void LLInventoryCacheReader::close()
+{
+	mCategories.clear();
+	mItems.clear();
+	mJournalEntries = 0;
+	unmap();
+}
+
+namespace
+{
+	typedef std::pair<LLUUID, U32> id_index_t;
+
+	bool id_index_less(const id_index_t& lhs, const id_index_t& rhs)
+	{
+		return lhs.first < rhs.first;
+	}
+
+	template<typename RECORD>
+	void build_index(const std::vector<const RECORD*>& records, std::vector<id_index_t>& index)
+	{
+		index.resize(records.size());
+		for (U32 i = 0; i < records.size(); ++i)
+		{
+			index[i] = id_index_t(records[i]->mID, i);
+		}
+		std::sort(index.begin(), index.end(), id_index_less);
+	}
+
+	// index of the record with this id, or -1.  Records added by the journal
+	// are not in the sorted index and are looked up in added.
+	S32 find_index(const std::vector<id_index_t>& index, const std::map<LLUUID, U32>& added, const LLUUID& id)
+	{
+		std::vector<id_index_t>::const_iterator iter =
+			std::lower_bound(index.begin(), index.end(), id_index_t(id, 0), id_index_less);
+		if (iter != index.end() && iter->first == id)
+		{
+			return iter->second;
+		}
+		std::map<LLUUID, U32>::const_iterator added_iter = added.find(id);
+		return added_iter != added.end() ? (S32) added_iter->second : -1;
+	}
+
+	template<typename RECORD>
+	void set_record(std::vector<const RECORD*>& records, std::vector<id_index_t>& index,
+					std::map<LLUUID, U32>& added, const LLUUID& id, const RECORD* record)
+	{
+		S32 i = find_index(index, added, id);
+		if (i >= 0)
+		{
+			records[i] = record;
+		}
+		else if (record)
+		{
+			added[id] = records.size();
+			records.push_back(record);
+		}
+	}
+
+	template<typename RECORD>
+	void remove_null(std::vector<const RECORD*>& records)
+	{
+		records.erase(std::remove(records.begin(), records.end(), (const RECORD*) NULL), records.end());
+	}
+}
+
+bool LLInventoryCacheReader::applyJournal(U32 offset, U32 bytes)
+{
+	if (bytes == 0)
+	{
+		return true;
+	}
+
+	std::vector<id_index_t> category_index;
+	std::vector<id_index_t> item_index;
+	build_index(mCategories, category_index);
+	build_index(mItems, item_index);
+	std::map<LLUUID, U32> added_categories;
+	std::map<LLUUID, U32> added_items;
+
+	U32 end = offset + bytes;
+	while (offset < end)
+	{
+		if (end - offset < JOURNAL_ENTRY_HEADER_SIZE)
+		{
+			return false;
+		}
+		U32 entry[2];
+		memcpy(entry, mData + offset, sizeof(entry));
+		offset += JOURNAL_ENTRY_HEADER_SIZE;
+
+		U32 record_size = journal_record_size(entry[0]);
+		if (record_size == 0 || end - offset < record_size || end - offset - record_size < entry[1])
+		{
+			return false;
+		}
+
+		const U8* record = mData + offset;
+		switch (entry[0])
+		{
+			case LLInventoryCache::JOURNAL_CATEGORY:
+			{
+				const LLInventoryCache::CategoryRecord* category = (const LLInventoryCache::CategoryRecord*) record;
+				set_record(mCategories, category_index, added_categories, category->mID, category);
+				break;
+			}
+			case LLInventoryCache::JOURNAL_ITEM:
+			{
+				const LLInventoryCache::ItemRecord* item = (const LLInventoryCache::ItemRecord*) record;
+				set_record(mItems, item_index, added_items, item->mID, item);
+				break;
+			}
+			case LLInventoryCache::JOURNAL_REMOVE:
+			{
+				LLUUID id;
+				memcpy(id.mData, record, UUID_BYTES);
+				set_record(mCategories, category_index, added_categories, id, (const LLInventoryCache::CategoryRecord*) NULL);
+				set_record(mItems, item_index, added_items, id, (const LLInventoryCache::ItemRecord*) NULL);
+				break;
+			}
+		}
+		offset += record_size + entry[1];
+	}
+
+	remove_null(mCategories);
+	remove_null(mItems);
+	return true;
+}
+
+void LLInventoryCacheReader::readCategory(const LLInventoryCache::CategoryRecord& record, LLInventoryCategory& category) const
+{
+	category.setUUID(record.mID);
+	category.setParent(record.mParentID);
+	category.setType((LLAssetType::EType) record.mType);
+	category.setPreferredType((LLFolderType::EType) record.mPreferredType);
+	category.rename(getString(record.mName));
+}
+
+void LLInventoryCacheReader::readItem(const LLInventoryCache::ItemRecord& record, LLInventoryItem& item) const
+{
+	LLPermissions perm;
+	perm.init(record.mCreatorID, record.mOwnerID, record.mLastOwnerID, record.mGroupID);
+	perm.yesReallySetOwner(record.mOwnerID, (record.mCacheFlags & LLInventoryCache::ITEM_GROUP_OWNED) != 0);
+	perm.initMasks(record.mMaskBase, record.mMaskOwner, record.mMaskEveryone, record.mMaskGroup, record.mMaskNextOwner);
+
+	LLUUID asset_id(record.mAssetID);
+	if (record.mCacheFlags & LLInventoryCache::ITEM_SHADOW_ASSET)
+	{
+		LLXORCipher cipher(SHADOW_KEY.mData, UUID_BYTES);
+		cipher.decrypt(asset_id.mData, UUID_BYTES);
+	}
+
+	LLInventoryType::EType inv_type = (LLInventoryType::EType) record.mInventoryType;
+	perm.initMasks(inv_type);
+
+	item.setUUID(record.mID);
+	item.setParent(record.mParentID);
+	item.setPermissions(perm);
+	item.setAssetUUID(asset_id);
+	item.setType((LLAssetType::EType) record.mType);
+	item.setInventoryType(inv_type);
+	item.setFlags(record.mFlags);
+	item.setSaleInfo(LLSaleInfo((LLSaleInfo::EForSale) record.mSaleType, record.mSalePrice));
+	item.rename(getString(record.mName));
+	item.setDescription(getString(record.mDescription));
+	item.setCreationDate(record.mCreationDate);
+}
+
+std::string LLInventoryCacheReader::getString(U32 offset) const
+{
+	if (offset >= mSize)
+	{
+		return LLStringUtil::null;
+	}
+	const char* str = (const char*) mData + offset;
+	const char* terminator = (const char*) memchr(str, 0, mSize - offset);
+	return terminator ? std::string(str, terminator) : LLStringUtil::null;
+}
+
+bool LLInventoryCacheReader::map(const std::string& filename)
+{
+#if LL_WINDOWS
+	llutf16string utf16filename = utf8str_to_utf16str(filename);
+	mFile = CreateFileW((LPCWSTR) utf16filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+						OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (mFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0 || size.HighPart != 0)
+	{
+		unmap();
+		return false;
+	}
+	mMapping = CreateFileMapping(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mMapping)
+	{
+		unmap();
+		return false;
+	}
+	mData = (const U8*) MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+	mSize = size.LowPart;
+#else
+	mFile = ::open(filename.c_str(), O_RDONLY);
+	if (mFile < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	if (fstat(mFile, &info) != 0 || info.st_size == 0 || (U64) info.st_size > U32_MAX)
+	{
+		unmap();
+		return false;
+	}
+	void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, mFile, 0);
+	mData = (data == MAP_FAILED) ? NULL : (const U8*) data;
+	mSize = info.st_size;
+#endif
+	if (!mData)
+	{
+		LL_WARNS("Inventory") << "Unable to map inventory cache " << filename << LL_ENDL;
+		unmap();
+		return false;
+	}
+	return true;
+}
+
+void LLInventoryCacheReader::unmap()
+{
+#if LL_WINDOWS
+	if (mData)
+	{
+		UnmapViewOfFile(mData);
+	}
+	if (mMapping)
+	{
+		CloseHandle(mMapping);
+		mMapping = NULL;
+	}
+	if (mFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(mFile);
+		mFile = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (mData)
+	{
+		munmap((void*) mData, mSize);
+	}
+	if (mFile >= 0)
+	{
+		::close(mFile);
+		mFile = -1;
+	}
+#endif
+	mData = NULL;
+	mSize = 0;
+}
+
+///----------------------------------------------------------------------------
+/// Class LLInventoryCacheWriter
+///----------------------------------------------------------------------------
+
+LLInventoryCacheWriter::LLInventoryCacheWriter()
+:	mAppend(false),
+	mEntryStringBase(0),
+	mJournalStart(0),
+	mNumEntries(0)
+{
+	LLInventoryCache::initHeader(mHeader);
+}
+
+void LLInventoryCacheWriter::create(const std::string& filename)
+{
+	mFilename = filename;
+	mAppend = false;
+	LLInventoryCache::initHeader(mHeader);
+	mCategories.clear();
+	mItems.clear();
+	mStrings.clear();
+	mStringOffsets.clear();
+	mJournal.clear();
+	mNumEntries = 0;
+
+	// offset 0 is the empty string
+	mStrings.push_back('\0');
+	mStringOffsets[LLStringUtil::null] = 0;
+}
+
+bool LLInventoryCacheWriter::append(const std::string& filename)
+{
+	create(filename);
+
+	LLFILE* fp = LLFile::fopen(filename, "rb");
+	if (!fp)
+	{
+		return false;
+	}
+	LLInventoryCache::Header header;
+	bool valid = fread(&header, sizeof(header), 1, fp) == 1 && LLInventoryCache::isHeaderValid(header);
+	S32 size = 0;
+	if (valid && fseek(fp, 0, SEEK_END) == 0)
+	{
+		size = ftell(fp);
+	}
+	fclose(fp);
+
+	if (!valid || size < 0 || base_size(header) + header.mJournalBytes > (U32) size)
+	{
+		return false;
+	}
+
+	mHeader = header;
+	mAppend = true;
+	// anything past the committed journal is left over from an interrupted append
+	mJournalStart = base_size(header) + header.mJournalBytes;
+	return true;
+}
+
+U32 LLInventoryCacheWriter::addString(const std::string& str)
+{
+	if (mAppend)
+	{
+		// journal entries carry their own strings
+		U32 offset = mEntryStringBase + mEntryStrings.size();
+		mEntryStrings.insert(mEntryStrings.end(), str.begin(), str.end());
+		mEntryStrings.push_back('\0');
+		return offset;
+	}
+
+	std::map<std::string, U32>::iterator iter = mStringOffsets.find(str);
+	if (iter != mStringOffsets.end())
+	{
+		return iter->second;
+	}
+	U32 offset = mStrings.size();
+	mStrings.insert(mStrings.end(), str.begin(), str.end());
+	mStrings.push_back('\0');
+	mStringOffsets[str] = offset;
+	return offset;
+}
+
+void LLInventoryCacheWriter::addJournalEntry(U32 type, const void* record, U32 record_size)
+{
+	// keep records 4 byte aligned
+	while (mEntryStrings.size() % 4)
+	{
+		mEntryStrings.push_back('\0');
+	}
+
+	U32 entry[2] = { type, (U32) mEntryStrings.size() };
+	const U8* entry_bytes = (const U8*) entry;
+	mJournal.insert(mJournal.end(), entry_bytes, entry_bytes + sizeof(entry));
+	mJournal.insert(mJournal.end(), (const U8*) record, (const U8*) record + record_size);
+	mJournal.insert(mJournal.end(), mEntryStrings.begin(), mEntryStrings.end());
+	mEntryStrings.clear();
+	mNumEntries++;
+}
+
+void LLInventoryCacheWriter::addCategory(const LLInventoryCategory& category, const LLUUID& owner_id, S32 version)
+{
+	mEntryStringBase = mJournalStart + mJournal.size() + JOURNAL_ENTRY_HEADER_SIZE + sizeof(LLInventoryCache::CategoryRecord);
+
+	LLInventoryCache::CategoryRecord record;
+	memset(&record, 0, sizeof(record));
+	record.mID = category.getUUID();
+	record.mParentID = category.getParentUUID();
+	record.mOwnerID = owner_id;
+	record.mVersion = version;
+	record.mName = addString(category.getName());
+	record.mType = category.getType();
+	record.mPreferredType = category.getPreferredType();
+
+	if (mAppend)
+	{
+		addJournalEntry(LLInventoryCache::JOURNAL_CATEGORY, &record, sizeof(record));
+	}
+	else
+	{
+		mCategories.push_back(record);
+	}
+}
+
+void LLInventoryCacheWriter::addItem(const LLInventoryItem& item, S32 parent_version)
+{
+	mEntryStringBase = mJournalStart + mJournal.size() + JOURNAL_ENTRY_HEADER_SIZE + sizeof(LLInventoryCache::ItemRecord);
+
+	const LLPermissions& perm = item.getPermissions();
+	LLInventoryCache::ItemRecord record;
+	memset(&record, 0, sizeof(record));
+	record.mID = item.getUUID();
+	record.mParentID = item.getParentUUID();
+	record.mAssetID = item.getAssetUUID();
+	record.mCreatorID = perm.getCreator();
+	record.mOwnerID = perm.getOwner();
+	record.mLastOwnerID = perm.getLastOwner();
+	record.mGroupID = perm.getGroup();
+	record.mMaskBase = perm.getMaskBase();
+	record.mMaskOwner = perm.getMaskOwner();
+	record.mMaskGroup = perm.getMaskGroup();
+	record.mMaskEveryone = perm.getMaskEveryone();
+	record.mMaskNextOwner = perm.getMaskNextOwner();
+	record.mFlags = item.getFlags();
+	record.mCreationDate = (S32) item.getCreationDate();
+	record.mSalePrice = item.getSaleInfo().getSalePrice();
+	record.mParentVersion = parent_version;
+	record.mName = addString(item.getName());
+	record.mDescription = addString(item.getDescription());
+	record.mType = item.getType();
+	record.mInventoryType = item.getInventoryType();
+	record.mSaleType = item.getSaleInfo().getSaleType();
+	if (perm.isGroupOwned())
+	{
+		record.mCacheFlags |= LLInventoryCache::ITEM_GROUP_OWNED;
+	}
+
+	// same rule as LLInventoryItem::exportFile()
+	if ((perm.getMaskBase() & PERM_ITEM_UNRESTRICTED) != PERM_ITEM_UNRESTRICTED
+		&& record.mAssetID.notNull())
+	{
+		LLXORCipher cipher(SHADOW_KEY.mData, UUID_BYTES);
+		cipher.encrypt(record.mAssetID.mData, UUID_BYTES);
+		record.mCacheFlags |= LLInventoryCache::ITEM_SHADOW_ASSET;
+	}
+
+	if (mAppend)
+	{
+		addJournalEntry(LLInventoryCache::JOURNAL_ITEM, &record, sizeof(record));
+	}
+	else
+	{
+		mItems.push_back(record);
+	}
+}
+
+void LLInventoryCacheWriter::removeObject(const LLUUID& id)
+{
+	if (mAppend)
+	{
+		addJournalEntry(LLInventoryCache::JOURNAL_REMOVE, id.mData, UUID_BYTES);
+	}
+}
+
+bool LLInventoryCacheWriter::commit()
+{
+	if (mFilename.empty())
+	{
+		return false;
+	}
+
+	if (mAppend)
+	{
+		if (mJournal.empty())
+		{
+			return true;
+		}
+
+		LLFILE* fp = LLFile::fopen(mFilename, "r+b");
+		if (!fp)
+		{
+			LL_WARNS("Inventory") << "Unable to append to inventory cache " << mFilename << LL_ENDL;
+			return false;
+		}
+		bool written = fseek(fp, mJournalStart, SEEK_SET) == 0
+			&& fwrite(&mJournal[0], mJournal.size(), 1, fp) == 1
+			&& fflush(fp) == 0;
+		if (written)
+		{
+			// the entries only count once the header says so
+			mHeader.mJournalEntries += mNumEntries;
+			mHeader.mJournalBytes += mJournal.size();
+			written = fseek(fp, 0, SEEK_SET) == 0
+				&& fwrite(&mHeader, sizeof(mHeader), 1, fp) == 1;
+		}
+		fclose(fp);
+
+		if (!written)
+		{
+			LL_WARNS("Inventory") << "Unable to append to inventory cache " << mFilename << LL_ENDL;
+			return false;
+		}
+		mJournalStart += mJournal.size();
+		mJournal.clear();
+		mNumEntries = 0;
+		return true;
+	}
+
+	// keep the journal that follows the strings 4 byte aligned
+	while (mStrings.size() % 4)
+	{
+		mStrings.push_back('\0');
+	}
+
+	// string offsets become file offsets
+	mHeader.mCategoryCount = mCategories.size();
+	mHeader.mItemCount = mItems.size();
+	mHeader.mStringBytes = mStrings.size();
+	mHeader.mJournalEntries = 0;
+	mHeader.mJournalBytes = 0;
+	U32 string_base = base_size(mHeader) - mHeader.mStringBytes;
+	for (U32 i = 0; i < mCategories.size(); ++i)
+	{
+		mCategories[i].mName += string_base;
+	}
+	for (U32 i = 0; i < mItems.size(); ++i)
+	{
+		mItems[i].mName += string_base;
+		mItems[i].mDescription += string_base;
+	}
+
+	std::string temp_filename = mFilename + ".tmp";
+	LLFILE* fp = LLFile::fopen(temp_filename, "wb");
+	if (!fp)
+	{
+		LL_WARNS("Inventory") << "Unable to write inventory cache " << temp_filename << LL_ENDL;
+		return false;
+	}
+	bool written = fwrite(&mHeader, sizeof(mHeader), 1, fp) == 1
+		&& (mCategories.empty() || fwrite(&mCategories[0], sizeof(LLInventoryCache::CategoryRecord), mCategories.size(), fp) == mCategories.size())
+		&& (mItems.empty() || fwrite(&mItems[0], sizeof(LLInventoryCache::ItemRecord), mItems.size(), fp) == mItems.size())
+		&& fwrite(&mStrings[0], mStrings.size(), 1, fp) == 1;
+	written = (fclose(fp) == 0) && written;
+
+	mCategories.clear();
+	mItems.clear();
+	mStrings.clear();
+	mStringOffsets.clear();
+
+	if (!written)
+	{
+		LL_WARNS("Inventory") << "Unable to write inventory cache " << temp_filename << LL_ENDL;
+		LLFile::remove(temp_filename);
+		return false;
+	}
+
+	LLFile::remove(mFilename);
+	if (LLFile::rename(temp_filename, mFilename) != 0)
+	{
+		LL_WARNS("Inventory") << "Unable to replace inventory cache " << mFilename << LL_ENDL;
+		return false;
+	}
+
+	// later changes go in the journal
+	mAppend = true;
+	mJournalStart = base_size(mHeader);
+	return true;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file llinventorycache.h
+ * @brief Binary inventory cache file reader and writer.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYCACHE_H
+#define LL_LLINVENTORYCACHE_H
+
+#include <map>
+#include <vector>
+
+#include "lluuid.h"
+
+class LLInventoryCategory;
+class LLInventoryItem;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventoryCache
+//
+//   Layout of the binary inventory cache.  The file is a header, fixed size
+//   category and item records, a table of the names and descriptions they
+//   refer to by file offset, then a journal of records appended by later
+//   sessions.  Journal entries replace or remove the record with the same id.
+//   Records are written in native byte order and read in place from a
+//   memory mapping.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLInventoryCache
+{
+public:
+	enum { FORMAT_VERSION = 1 };
+
+	struct Header
+	{
+		char mMagic[4];
+		U32 mByteOrder;
+		U32 mVersion;
+		U32 mCategoryCount;
+		U32 mItemCount;
+		U32 mStringBytes;
+		U32 mJournalEntries;
+		U32 mJournalBytes;
+	};
+
+	struct CategoryRecord
+	{
+		LLUUID mID;
+		LLUUID mParentID;
+		LLUUID mOwnerID;
+		S32 mVersion;
+		U32 mName;				// file offset of the name
+		S8 mType;
+		S8 mPreferredType;
+		U8 mPad[2];
+	};
+
+	enum
+	{
+		ITEM_GROUP_OWNED = 1 << 0,
+		ITEM_SHADOW_ASSET = 1 << 1		// asset id is stored obscured, as in the text format
+	};
+
+	struct ItemRecord
+	{
+		LLUUID mID;
+		LLUUID mParentID;
+		LLUUID mAssetID;
+		LLUUID mCreatorID;
+		LLUUID mOwnerID;
+		LLUUID mLastOwnerID;
+		LLUUID mGroupID;
+		U32 mMaskBase;
+		U32 mMaskOwner;
+		U32 mMaskGroup;
+		U32 mMaskEveryone;
+		U32 mMaskNextOwner;
+		U32 mFlags;
+		S32 mCreationDate;
+		S32 mSalePrice;
+		S32 mParentVersion;		// version of the parent category when written
+		U32 mName;				// file offsets of the name and description
+		U32 mDescription;
+		S8 mType;
+		S8 mInventoryType;
+		S8 mSaleType;
+		U8 mCacheFlags;
+	};
+
+	enum EJournalEntry
+	{
+		JOURNAL_CATEGORY,
+		JOURNAL_ITEM,
+		JOURNAL_REMOVE
+	};
+
+	static void initHeader(Header& header);
+	static bool isHeaderValid(const Header& header);
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventoryCacheReader
+//
+//   Maps a cache file and presents the current records, with the journal
+//   applied.  Records and strings are only decoded when asked for, so objects
+//   can be built lazily or from several threads once open() has returned.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLInventoryCacheReader
+{
+public:
+	LLInventoryCacheReader();
+	~LLInventoryCacheReader();
+
+	bool open(const std::string& filename);
+	void close();
+
+	U32 getNumCategories() const							{ return mCategories.size(); }
+	const LLInventoryCache::CategoryRecord& getCategory(U32 index) const	{ return *mCategories[index]; }
+	U32 getNumItems() const									{ return mItems.size(); }
+	const LLInventoryCache::ItemRecord& getItem(U32 index) const	{ return *mItems[index]; }
+
+	// Fill in everything the record holds
+	void readCategory(const LLInventoryCache::CategoryRecord& record, LLInventoryCategory& category) const;
+	void readItem(const LLInventoryCache::ItemRecord& record, LLInventoryItem& item) const;
+
+	std::string getString(U32 offset) const;
+
+	U32 getJournalEntries() const							{ return mJournalEntries; }
+
+private:
+	bool map(const std::string& filename);
+	void unmap();
+	bool applyJournal(U32 offset, U32 bytes);
+
+	const U8* mData;
+	U32 mSize;
+#if LL_WINDOWS
+	void* mFile;
+	void* mMapping;
+#else
+	int mFile;
+#endif
+	U32 mJournalEntries;
+	std::vector<const LLInventoryCache::CategoryRecord*> mCategories;
+	std::vector<const LLInventoryCache::ItemRecord*> mItems;
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventoryCacheWriter
+//
+//   Writes a complete cache with create(), or appends changed and removed
+//   objects to an existing one with append().  Nothing reaches the file until
+//   commit().  A complete cache is written to a temporary file and renamed
+//   into place, an append only updates the header once the entries are out.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLInventoryCacheWriter
+{
+public:
+	LLInventoryCacheWriter();
+
+	void create(const std::string& filename);
+	// Returns false if there is no cache to append to
+	bool append(const std::string& filename);
+
+	void addCategory(const LLInventoryCategory& category, const LLUUID& owner_id, S32 version);
+	void addItem(const LLInventoryItem& item, S32 parent_version);
+	// Only meaningful when appending
+	void removeObject(const LLUUID& id);
+
+	bool commit();
+
+	// Records in the cache once committed, before the journal is applied
+	U32 getBaseRecords() const								{ return mHeader.mCategoryCount + mHeader.mItemCount; }
+	U32 getJournalEntries() const							{ return mHeader.mJournalEntries + mNumEntries; }
+
+private:
+	U32 addString(const std::string& str);
+	void addJournalEntry(U32 type, const void* record, U32 record_size);
+
+	std::string mFilename;
+	bool mAppend;
+	LLInventoryCache::Header mHeader;
+
+	std::vector<LLInventoryCache::CategoryRecord> mCategories;
+	std::vector<LLInventoryCache::ItemRecord> mItems;
+	// string table for create(), offsets are relative until commit()
+	std::vector<char> mStrings;
+	std::map<std::string, U32> mStringOffsets;
+
+	// journal entries for append()
+	std::vector<U8> mJournal;
+	std::vector<char> mEntryStrings;
+	U32 mEntryStringBase;
+	U32 mJournalStart;
+	U32 mNumEntries;
+};
+
+#endif // LL_LLINVENTORYCACHE_H
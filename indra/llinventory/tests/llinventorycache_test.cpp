@@ -0,0 +1,331 @@
+/**
+ * @file   llinventorycache_test.cpp
+ * @brief  Test for llinventorycache.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <vector>
+
+#include "../llinventory.h"
+#include "../llinventorycache.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+	struct LLInventoryCacheData
+	{
+		typedef std::vector<LLPointer<LLInventoryCategory> > cat_array_t;
+		typedef std::vector<LLPointer<LLInventoryItem> > item_array_t;
+
+		LLInventoryCacheData()
+		:	mFilename("linden_inventory_cache.dat")
+		{
+			LLFile::remove(mFilename);
+		}
+
+		~LLInventoryCacheData()
+		{
+			LLFile::remove(mFilename);
+		}
+
+		// a folder tree with item_count items spread over cat_count folders,
+		// with the repeated names a real inventory has
+		void makeInventory(S32 cat_count, S32 item_count)
+		{
+			LLUUID root_id;
+			root_id.generate();
+			for (S32 i = 0; i < cat_count; ++i)
+			{
+				LLUUID cat_id;
+				cat_id.generate();
+				mCategories.push_back(new LLInventoryCategory(cat_id, root_id, LLFolderType::FT_NONE,
+															  llformat("Folder %d", i)));
+			}
+
+			LLUUID owner_id;
+			owner_id.generate();
+			for (S32 i = 0; i < item_count; ++i)
+			{
+				LLUUID item_id;
+				item_id.generate();
+				LLUUID creator_id;
+				creator_id.generate();
+				LLUUID asset_id;
+				asset_id.generate();
+				LLPermissions perm;
+				perm.init(creator_id, owner_id, LLUUID::null, LLUUID::null);
+				if (i % 2)
+				{
+					perm.initMasks(PERM_ALL, PERM_ALL, PERM_NONE, PERM_NONE, PERM_ALL);
+				}
+				else
+				{
+					perm.initMasks(PERM_ALL, PERM_ALL, PERM_COPY, PERM_COPY, PERM_MODIFY | PERM_COPY);
+				}
+				std::string name = (i % 3) ? std::string("Object") : llformat("Shirt %d", i);
+				std::string desc = (i % 4) ? std::string() : std::string("(No Description)");
+				mItems.push_back(new LLInventoryItem(item_id, mCategories[i % cat_count]->getUUID(), perm, asset_id,
+													 LLAssetType::AT_OBJECT, LLInventoryType::IT_OBJECT,
+													 name, desc, LLSaleInfo(LLSaleInfo::FS_COPY, i % 100),
+													 i, 1400000000 + i));
+			}
+		}
+
+		bool writeCache()
+		{
+			LLInventoryCacheWriter writer;
+			writer.create(mFilename);
+			for (U32 i = 0; i < mCategories.size(); ++i)
+			{
+				writer.addCategory(*mCategories[i], LLUUID::null, i + 1);
+			}
+			for (U32 i = 0; i < mItems.size(); ++i)
+			{
+				writer.addItem(*mItems[i], (i % mCategories.size()) + 1);
+			}
+			return writer.commit();
+		}
+
+		const LLInventoryCache::ItemRecord* findItem(const LLInventoryCacheReader& reader, const LLUUID& id)
+		{
+			for (U32 i = 0; i < reader.getNumItems(); ++i)
+			{
+				if (reader.getItem(i).mID == id)
+				{
+					return &reader.getItem(i);
+				}
+			}
+			return NULL;
+		}
+
+		void ensureSameItem(const std::string& msg, const LLInventoryItem& expected, const LLInventoryItem& actual)
+		{
+			ensure_equals(msg + " id", actual.getUUID(), expected.getUUID());
+			ensure_equals(msg + " parent", actual.getParentUUID(), expected.getParentUUID());
+			ensure_equals(msg + " permissions", actual.getPermissions(), expected.getPermissions());
+			ensure_equals(msg + " asset", actual.getAssetUUID(), expected.getAssetUUID());
+			ensure_equals(msg + " type", actual.getType(), expected.getType());
+			ensure_equals(msg + " inventory type", actual.getInventoryType(), expected.getInventoryType());
+			ensure_equals(msg + " name", actual.getName(), expected.getName());
+			ensure_equals(msg + " description", actual.getDescription(), expected.getDescription());
+			ensure_equals(msg + " sale price", actual.getSaleInfo().getSalePrice(), expected.getSaleInfo().getSalePrice());
+			ensure_equals(msg + " flags", actual.getFlags(), expected.getFlags());
+			ensure_equals(msg + " creation date", actual.getCreationDate(), expected.getCreationDate());
+		}
+
+		std::string mFilename;
+		cat_array_t mCategories;
+		item_array_t mItems;
+	};
+
+	typedef test_group<LLInventoryCacheData> factory;
+	typedef factory::object object;
+}
+
+namespace
+{
+	tut::factory llinventorycache_test_factory("LLInventoryCache");
+}
+
+namespace tut
+{
+	template<> template<>
+	void object::test<1>()
+	{
+		// everything the text cache keeps survives a round trip
+		makeInventory(10, 500);
+		ensure("written", writeCache());
+
+		LLInventoryCacheReader reader;
+		ensure("opened", reader.open(mFilename));
+		ensure_equals("categories", reader.getNumCategories(), (U32) mCategories.size());
+		ensure_equals("items", reader.getNumItems(), (U32) mItems.size());
+		ensure_equals("no journal", reader.getJournalEntries(), (U32) 0);
+
+		for (U32 i = 0; i < mCategories.size(); ++i)
+		{
+			const LLInventoryCache::CategoryRecord& record = reader.getCategory(i);
+			LLPointer<LLInventoryCategory> cat = new LLInventoryCategory();
+			reader.readCategory(record, *cat);
+			ensure_equals("category id", cat->getUUID(), mCategories[i]->getUUID());
+			ensure_equals("category parent", cat->getParentUUID(), mCategories[i]->getParentUUID());
+			ensure_equals("category name", cat->getName(), mCategories[i]->getName());
+			ensure_equals("category version", record.mVersion, (S32) i + 1);
+		}
+		for (U32 i = 0; i < mItems.size(); ++i)
+		{
+			const LLInventoryCache::ItemRecord& record = reader.getItem(i);
+			LLPointer<LLInventoryItem> item = new LLInventoryItem();
+			reader.readItem(record, *item);
+			ensureSameItem("item", *mItems[i], *item);
+			ensure_equals("parent version", record.mParentVersion, (S32) (i % mCategories.size()) + 1);
+		}
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		// later sessions append changes instead of rewriting the file
+		makeInventory(4, 40);
+		ensure("written", writeCache());
+
+		LLInventoryCacheWriter writer;
+		ensure("appending", writer.append(mFilename));
+		mItems[5]->rename("Renamed");
+		writer.addItem(*mItems[5], 7);
+		writer.removeObject(mItems[6]->getUUID());
+		writer.removeObject(mCategories[3]->getUUID());
+		mCategories[2]->rename("Moved");
+		writer.addCategory(*mCategories[2], LLUUID::null, 9);
+		ensure("committed", writer.commit());
+
+		LLUUID new_id;
+		new_id.generate();
+		LLPointer<LLInventoryItem> new_item = new LLInventoryItem(mItems[0]);
+		new_item->setUUID(new_id);
+		new_item->rename("Added later");
+		ensure("appending again", writer.append(mFilename));
+		writer.addItem(*new_item, 3);
+		ensure("committed again", writer.commit());
+		ensure_equals("journal entries", writer.getJournalEntries(), (U32) 5);
+		ensure_equals("base records", writer.getBaseRecords(), (U32) 44);
+
+		LLInventoryCacheReader reader;
+		ensure("opened", reader.open(mFilename));
+		ensure_equals("category removed", reader.getNumCategories(), (U32) 3);
+		ensure_equals("one item removed, one added", reader.getNumItems(), (U32) 40);
+		ensure("removed item gone", findItem(reader, mItems[6]->getUUID()) == NULL);
+
+		const LLInventoryCache::ItemRecord* record = findItem(reader, mItems[5]->getUUID());
+		ensure("replaced item", record != NULL);
+		ensure_equals("replaced parent version", record->mParentVersion, 7);
+		LLPointer<LLInventoryItem> item = new LLInventoryItem();
+		reader.readItem(*record, *item);
+		ensureSameItem("replaced", *mItems[5], *item);
+
+		record = findItem(reader, new_id);
+		ensure("added item", record != NULL);
+		reader.readItem(*record, *item);
+		ensureSameItem("added", *new_item, *item);
+
+		const LLInventoryCache::CategoryRecord& cat_record = reader.getCategory(2);
+		ensure_equals("replaced category version", cat_record.mVersion, 9);
+		ensure_equals("replaced category name", reader.getString(cat_record.mName), std::string("Moved"));
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		// an interrupted append leaves the committed cache readable
+		makeInventory(2, 10);
+		ensure("written", writeCache());
+		LLFILE* fp = LLFile::fopen(mFilename, "ab");
+		ensure("file open", fp != NULL);
+		fwrite("partial entry", 13, 1, fp);
+		fclose(fp);
+
+		LLInventoryCacheReader reader;
+		ensure("opened", reader.open(mFilename));
+		ensure_equals("items", reader.getNumItems(), (U32) 10);
+		reader.close();
+
+		LLInventoryCacheWriter writer;
+		ensure("appending", writer.append(mFilename));
+		writer.removeObject(mItems[0]->getUUID());
+		ensure("committed", writer.commit());
+		ensure("reopened", reader.open(mFilename));
+		ensure_equals("entry written over the partial one", reader.getNumItems(), (U32) 9);
+		reader.close();
+
+		// a file from another format version is not read
+		LLInventoryCache::Header header;
+		fp = LLFile::fopen(mFilename, "r+b");
+		ensure("file open", fp != NULL);
+		fread(&header, sizeof(header), 1, fp);
+		header.mVersion = LLInventoryCache::FORMAT_VERSION + 1;
+		fseek(fp, 0, SEEK_SET);
+		fwrite(&header, sizeof(header), 1, fp);
+		fclose(fp);
+		ensure("other version rejected", !reader.open(mFilename));
+		ensure("cannot append", !writer.append(mFilename));
+	}
+
+	template<> template<>
+	void object::test<4>()
+	{
+		// compare against the text format the viewer used to cache with.  Set
+		// INVENTORY_CACHE_BENCHMARK for the full size inventory.
+		S32 item_count = getenv("INVENTORY_CACHE_BENCHMARK") ? 200000 : 5000;
+		makeInventory(item_count / 100, item_count);
+
+		LLTimer timer;
+		LLFILE* fp = LLFile::fopen(mFilename, "wb");
+		ensure("file open", fp != NULL);
+		for (U32 i = 0; i < mItems.size(); ++i)
+		{
+			mItems[i]->exportFile(fp);
+		}
+		fclose(fp);
+		F64 text_save = timer.getElapsedTimeF64();
+
+		timer.reset();
+		fp = LLFile::fopen(mFilename, "rb");
+		ensure("file open", fp != NULL);
+		item_array_t text_items;
+		for (U32 i = 0; i < mItems.size(); ++i)
+		{
+			LLPointer<LLInventoryItem> item = new LLInventoryItem();
+			item->importFile(fp);
+			text_items.push_back(item);
+		}
+		fclose(fp);
+		F64 text_load = timer.getElapsedTimeF64();
+		ensureSameItem("text", *mItems.back(), *text_items.back());
+		LLFile::remove(mFilename);
+
+		timer.reset();
+		ensure("written", writeCache());
+		F64 binary_save = timer.getElapsedTimeF64();
+
+		timer.reset();
+		LLInventoryCacheReader reader;
+		ensure("opened", reader.open(mFilename));
+		item_array_t binary_items;
+		for (U32 i = 0; i < reader.getNumItems(); ++i)
+		{
+			LLPointer<LLInventoryItem> item = new LLInventoryItem();
+			reader.readItem(reader.getItem(i), *item);
+			binary_items.push_back(item);
+		}
+		F64 binary_load = timer.getElapsedTimeF64();
+		ensure_equals("all items", binary_items.size(), mItems.size());
+		ensureSameItem("binary", *mItems.back(), *binary_items.back());
+
+		LL_INFOS() << item_count << " items, text save " << text_save << "s load " << text_load
+				   << "s, binary save " << binary_save << "s load " << binary_load << "s" << LL_ENDL;
+	}
+}
@@ -73,6 +73,55 @@ public:
 	virtual void traverse(const LLOctreeNode<T>* node);
 };
 
+// A culling walk split in two so that its frustum tests can run off the
+// main thread.  record() walks the tree the way LLViewerOctreeCull's
+// traverse() does, but only makes the frustum tests, and notes every node
+// the walk reaches.  replay() then visits the noted groups in walk order.
+//
+// A group that fails early leaves the frustum state as it found it for its
+// next sibling, which record() cannot know about, so each step notes the
+// state it was recorded with.  replay() walks any node reached with some
+// other state the single walk way.
+//
+// CULLER stands in for the culler of both halves and provides, for the
+// listener type GROUP each node carries first:
+//	S32 frustumCheck(const GROUP*)		0 outside, 1 partly, 2 fully inside
+//	bool skipFrustumCheck(const GROUP*)	partly inside parent is enough
+//	bool checkObjects(const LLOctreeNode<T>*, const GROUP*)
+//	bool earlyFail(GROUP*)				skips the group and its subtree
+//	void preprocess(GROUP*)
+//	void processGroup(GROUP*)			only if checkObjects() passed
+//	void traverse(const LLOctreeNode<T>*)	the single walk
+template <class T, class GROUP>
+class LLOctreeCullRecord
+{
+public:
+	struct Step
+	{
+		const LLOctreeNode<T>* mNode;
+		GROUP* mGroup;
+		U32 mNext;			// index of the step after this group's subtree
+		S32 mResIn;			// frustum state the walk reached the node with
+		S32 mRes;			// and the one its subtree was walked with
+		bool mTested;		// mRes is this group's own frustum test
+		bool mHasObjects;	// checkObjects() passed
+	};
+	typedef std::vector<Step> steps_t;
+
+	// res is the culler's frustum state, which checkObjects() and
+	// traverse() read
+	template <class CULLER>
+	static void record(CULLER& culler, S32& res, const LLOctreeNode<T>* node, steps_t& steps);
+
+	template <class CULLER>
+	static void replay(CULLER& culler, S32& res, const steps_t& steps);
+
+private:
+	// replays the step at index and its subtree, returns the index after
+	template <class CULLER>
+	static U32 replayStep(CULLER& culler, S32& res, const steps_t& steps, U32 index);
+};
+
 template <class T>
 class LLOctreeNode : public LLTreeNode<T>
 {
@@ -848,4 +897,97 @@ void LLOctreeTravelerDepthFirst<T>::traverse(const LLOctreeNode<T>* node)
 	node->accept(this);
 }
 
+//========================
+//		LLOctreeCullRecord
+//========================
+template <class T, class GROUP>
+template <class CULLER>
+void LLOctreeCullRecord<T, GROUP>::record(CULLER& culler, S32& res, const LLOctreeNode<T>* node, steps_t& steps)
+{
+	GROUP* group = (GROUP*) node->getListener(0);
+	U32 index = steps.size();
+	Step step;
+	step.mNode = node;
+	step.mGroup = group;
+	step.mNext = index + 1;
+	step.mResIn = res;
+	step.mTested = false;
+	step.mHasObjects = false;
+
+	// a group tested here leaves res at 0 for its next sibling
+	if (!(res == 2 || (res && culler.skipFrustumCheck(group))))
+	{
+		res = culler.frustumCheck(group);
+		step.mTested = true;
+	}
+	step.mRes = res;
+	steps.push_back(step);
+
+	if (res)
+	{
+		steps[index].mHasObjects = culler.checkObjects(node, group);
+		for (U32 i = 0; i < node->getChildCount(); i++)
+		{
+			record(culler, res, node->getChild(i), steps);
+		}
+	}
+
+	if (step.mTested)
+	{
+		res = 0;
+	}
+	steps[index].mNext = steps.size();
+}
+
+template <class T, class GROUP>
+template <class CULLER>
+void LLOctreeCullRecord<T, GROUP>::replay(CULLER& culler, S32& res, const steps_t& steps)
+{
+	U32 i = 0;
+	while (i < steps.size())
+	{
+		i = replayStep(culler, res, steps, i);
+	}
+}
+
+template <class T, class GROUP>
+template <class CULLER>
+U32 LLOctreeCullRecord<T, GROUP>::replayStep(CULLER& culler, S32& res, const steps_t& steps, U32 index)
+{
+	const Step& step = steps[index];
+	if (res != step.mResIn)
+	{
+		// an earlier sibling failed early and left res as it found it
+		culler.traverse(step.mNode);
+		return step.mNext;
+	}
+
+	if (culler.earlyFail(step.mGroup))
+	{
+		return step.mNext;
+	}
+
+	res = step.mRes;
+	if (res)
+	{
+		culler.preprocess(step.mGroup);
+		if (step.mHasObjects)
+		{
+			culler.processGroup(step.mGroup);
+		}
+
+		U32 i = index + 1;
+		while (i < step.mNext)
+		{
+			i = replayStep(culler, res, steps, i);
+		}
+	}
+
+	if (step.mTested)
+	{
+		res = 0;
+	}
+	return step.mNext;
+}
+
 #endif
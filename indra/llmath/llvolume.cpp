@@ -51,6 +51,7 @@
 #include "llvector4a.h"
 #include "llmatrix4a.h"
 #include "lltimer.h"
+#include "llapr.h"
 
 #define DEBUG_SILHOUETTE_BINORMALS 0
 #define DEBUG_SILHOUETTE_NORMALS 0 // TomY: Use this to display normals using the silhouette
@@ -2044,6 +2045,15 @@ LLProfile::~LLProfile()
 
 S32 LLVolume::sNumMeshPoints = 0;
 
+// LOD blocks unpackVolumeFaces() had to parse through LLSD, from any thread
+static LLAtomicS32 sNumMeshLODsFromLLSD;
+
+//static
+S32 LLVolume::getNumMeshLODsFromLLSD()
+{
+	return sNumMeshLODsFromLLSD.CurrentValue();
+}
+
 LLVolume::LLVolume(const LLVolumeParams &params, const F32 detail, const BOOL generate_single_face, const BOOL is_unique)
 	: mParams(params)
 {
@@ -2366,315 +2376,732 @@ bool LLVolumeFace::VertexData::compareNormal(const LLVolumeFace::VertexData& rhs
 	return retval;
 }
 
-bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
+namespace
 {
-	//input stream is now pointing at a zlib compressed block of LLSD
-	//decompress block
-	LLSD mdl;
-	if (!unzip_llsd(mdl, is, size))
-	{
-		LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD, will probably fetch from sim again." << LL_ENDL;
-		return false;
-	}
-	
+	// What unpack_volume_face() needs from one submesh of a mesh LOD block,
+	// pointing into either the inflated block or the LLSD it was parsed into.
+	struct MeshSubmesh
 	{
-		U32 face_count = mdl.size();
-
-		if (face_count == 0)
-		{ //no faces unpacked, treat as failed decode
-			LL_WARNS() << "found no faces!" << LL_ENDL;
-			return false;
+		MeshSubmesh()
+		{
+			memset(this, 0, sizeof(MeshSubmesh));
 		}
 
-		mVolumeFaces.resize(face_count);
+		bool mNoGeometry;
+		bool mHasWeights;
+		const U8* mPosition;
+		U32 mPositionSize;
+		const U8* mNormal;
+		U32 mNormalSize;
+		const U8* mTexCoord;
+		U32 mTexCoordSize;
+		const U8* mTriangleList;
+		U32 mTriangleListSize;
+		const U8* mWeights;
+		U32 mWeightsSize;
+		F32 mPositionMin[3];
+		F32 mPositionMax[3];
+		F32 mTexCoordMin[2];
+		F32 mTexCoordMax[2];
+	};
 
-		for (U32 i = 0; i < face_count; ++i)
+	//
+	// Walks the binary LLSD of an inflated mesh LOD block in place, picking
+	// the streams and domains of each submesh out of the array of maps that
+	// LLModel::writeModel() produces without building any LLSD on the way.
+	// Anything it does not expect makes read() fail, and the caller parses
+	// the block the general way instead.
+	//
+	class MeshLODReader
+	{
+	public:
+		MeshLODReader(const U8* data, U32 size)
+		:	mCur(data),
+			mEnd(data + size)
+		{
+		}
+
+		bool read(std::vector<MeshSubmesh>& submeshes)
 		{
-			LLVolumeFace& face = mVolumeFaces[i];
-
-			if (mdl[i].has("NoGeometry"))
-			{ //face has no geometry, continue
-				face.resizeIndices(3);
-				face.resizeVertices(1);
-				memset(face.mPositions, 0, sizeof(LLVector4a));
-				memset(face.mNormals, 0, sizeof(LLVector4a));
-				memset(face.mTexCoords, 0, sizeof(LLVector2));
-				memset(face.mIndices, 0, sizeof(U16)*3);
-				continue;
+			U32 count = 0;
+			// every submesh takes at least a byte, so a bad count can not
+			// run away with the allocation below
+			if (!readTag('[') || !readU32(count) || count > U32(mEnd - mCur))
+			{
+				return false;
 			}
 
-			LLSD::Binary pos = mdl[i]["Position"];
-			LLSD::Binary norm = mdl[i]["Normal"];
-			LLSD::Binary tc = mdl[i]["TexCoord0"];
-			LLSD::Binary idx = mdl[i]["TriangleList"];
+			submeshes.resize(count);
+			for (U32 i = 0; i < count; ++i)
+			{
+				if (!readSubmesh(submeshes[i]))
+				{
+					return false;
+				}
+			}
+			return readTag(']');
+		}
 
-			
+	private:
+		bool has(U32 bytes) const
+		{
+			return U32(mEnd - mCur) >= bytes;
+		}
 
-			//copy out indices
-			face.resizeIndices(idx.size()/2);
-			
-			if (idx.empty() || face.mNumIndices < 3)
-			{ //why is there an empty index list?
-				LL_WARNS() <<"Empty face present!" << LL_ENDL;
-				continue;
+		bool readTag(char tag)
+		{
+			if (!has(1) || *mCur != (U8) tag)
+			{
+				return false;
 			}
+			++mCur;
+			return true;
+		}
 
-			U16* indices = (U16*) &(idx[0]);
-			U32 count = idx.size()/2;
-			for (U32 j = 0; j < count; ++j)
+		// sizes and integers are in network byte order
+		bool readU32(U32& value)
+		{
+			if (!has(4))
 			{
-				face.mIndices[j] = indices[j];
+				return false;
 			}
+			value = (U32(mCur[0]) << 24) | (U32(mCur[1]) << 16) | (U32(mCur[2]) << 8) | U32(mCur[3]);
+			mCur += 4;
+			return true;
+		}
 
-			//copy out vertices
-			U32 num_verts = pos.size()/(3*2);
-			face.resizeVertices(num_verts);
-
-			LLVector3 minp;
-			LLVector3 maxp;
-			LLVector2 min_tc; 
-			LLVector2 max_tc; 
-		
-			minp.setValue(mdl[i]["PositionDomain"]["Min"]);
-			maxp.setValue(mdl[i]["PositionDomain"]["Max"]);
-			LLVector4a min_pos, max_pos;
-			min_pos.load3(minp.mV);
-			max_pos.load3(maxp.mV);
+		bool readBytes(const U8*& data, U32& size)
+		{
+			if (!readU32(size) || !has(size))
+			{
+				return false;
+			}
+			data = mCur;
+			mCur += size;
+			return true;
+		}
 
-			min_tc.setValue(mdl[i]["TexCoord0Domain"]["Min"]);
-			max_tc.setValue(mdl[i]["TexCoord0Domain"]["Max"]);
+		bool readKey(const U8*& key, U32& length)
+		{
+			// notation style quoted keys are left to the full parser
+			return readTag('k') && readBytes(key, length);
+		}
 
-			LLVector4a pos_range;
-			pos_range.setSub(max_pos, min_pos);
-			LLVector2 tc_range2 = max_tc - min_tc;
+		static bool isKey(const U8* key, U32 length, const char* name)
+		{
+			return length == strlen(name) && memcmp(key, name, length) == 0;
+		}
 
-			LLVector4a tc_range;
-			tc_range.set(tc_range2[0], tc_range2[1], tc_range2[0], tc_range2[1]);
-			LLVector4a min_tc4(min_tc[0], min_tc[1], min_tc[0], min_tc[1]);
+		bool readBinary(const U8*& data, U32& size)
+		{
+			return readTag('b') && readBytes(data, size);
+		}
 
-			LLVector4a* pos_out = face.mPositions;
-			LLVector4a* norm_out = face.mNormals;
-			LLVector4a* tc_out = (LLVector4a*) face.mTexCoords;
+		bool readReal(F32& value)
+		{
+			if (!has(1))
+			{
+				return false;
+			}
 
+			const U8 tag = *mCur++;
+			if (tag == 'r')
 			{
-				U16* v = (U16*) &(pos[0]);
-				for (U32 j = 0; j < num_verts; ++j)
+				if (!has(8))
+				{
+					return false;
+				}
+				U64 bits = 0;
+				for (U32 i = 0; i < 8; ++i)
 				{
-					pos_out->set((F32) v[0], (F32) v[1], (F32) v[2]);
-					pos_out->div(65535.f);
-					pos_out->mul(pos_range);
-					pos_out->add(min_pos);
-					pos_out++;
-					v += 3;
+					bits = (bits << 8) | mCur[i];
 				}
+				mCur += 8;
+				F64 real;
+				memcpy(&real, &bits, sizeof(real));
+				value = (F32) real;
+				return true;
+			}
+			if (tag == 'i')
+			{
+				U32 integer = 0;
+				if (!readU32(integer))
+				{
+					return false;
+				}
+				value = (F32) (S32) integer;
+				return true;
+			}
+			return false;
+		}
 
+		// an array of up to components numbers, the rest of values stays 0
+		bool readVector(F32* values, U32 components)
+		{
+			U32 count = 0;
+			if (!readTag('[') || !readU32(count))
+			{
+				return false;
 			}
+			for (U32 i = 0; i < count; ++i)
+			{
+				F32 value = 0.f;
+				if (!readReal(value))
+				{
+					return false;
+				}
+				if (i < components)
+				{
+					values[i] = value;
+				}
+			}
+			return readTag(']');
+		}
 
+		bool readDomain(F32* min, F32* max, U32 components)
+		{
+			U32 count = 0;
+			if (!readTag('{') || !readU32(count))
+			{
+				return false;
+			}
+			for (U32 i = 0; i < count; ++i)
 			{
-				if (!norm.empty())
+				const U8* key = NULL;
+				U32 length = 0;
+				if (!readKey(key, length))
 				{
-					U16* n = (U16*) &(norm[0]);
-					for (U32 j = 0; j < num_verts; ++j)
-					{
-						norm_out->set((F32) n[0], (F32) n[1], (F32) n[2]);
-						norm_out->div(65535.f);
-						norm_out->mul(2.f);
-						norm_out->sub(1.f);
-						norm_out++;
-						n += 3;
-					}
+					return false;
+				}
+
+				bool ok;
+				if (isKey(key, length, "Min"))
+				{
+					ok = readVector(min, components);
+				}
+				else if (isKey(key, length, "Max"))
+				{
+					ok = readVector(max, components);
 				}
 				else
 				{
-					memset(norm_out, 0, sizeof(LLVector4a)*num_verts);
+					ok = skipValue(0);
+				}
+				if (!ok)
+				{
+					return false;
 				}
 			}
+			return readTag('}');
+		}
 
+		bool readSubmesh(MeshSubmesh& submesh)
+		{
+			U32 count = 0;
+			if (!readTag('{') || !readU32(count))
+			{
+				return false;
+			}
+			for (U32 i = 0; i < count; ++i)
 			{
-				if (!tc.empty())
+				const U8* key = NULL;
+				U32 length = 0;
+				if (!readKey(key, length))
 				{
-					U16* t = (U16*) &(tc[0]);
-					for (U32 j = 0; j < num_verts; j+=2)
-					{
-						if (j < num_verts-1)
-						{
-							tc_out->set((F32) t[0], (F32) t[1], (F32) t[2], (F32) t[3]);
-						}
-						else
-						{
-							tc_out->set((F32) t[0], (F32) t[1], 0.f, 0.f);
-						}
+					return false;
+				}
 
-						t += 4;
+				bool ok;
+				if (isKey(key, length, "Position"))
+				{
+					ok = readBinary(submesh.mPosition, submesh.mPositionSize);
+				}
+				else if (isKey(key, length, "Normal"))
+				{
+					ok = readBinary(submesh.mNormal, submesh.mNormalSize);
+				}
+				else if (isKey(key, length, "TexCoord0"))
+				{
+					ok = readBinary(submesh.mTexCoord, submesh.mTexCoordSize);
+				}
+				else if (isKey(key, length, "TriangleList"))
+				{
+					ok = readBinary(submesh.mTriangleList, submesh.mTriangleListSize);
+				}
+				else if (isKey(key, length, "Weights"))
+				{
+					submesh.mHasWeights = true;
+					ok = readBinary(submesh.mWeights, submesh.mWeightsSize);
+				}
+				else if (isKey(key, length, "PositionDomain"))
+				{
+					ok = readDomain(submesh.mPositionMin, submesh.mPositionMax, 3);
+				}
+				else if (isKey(key, length, "TexCoord0Domain"))
+				{
+					ok = readDomain(submesh.mTexCoordMin, submesh.mTexCoordMax, 2);
+				}
+				else
+				{
+					if (isKey(key, length, "NoGeometry"))
+					{
+						submesh.mNoGeometry = true;
+					}
+					ok = skipValue(0);
+				}
+				if (!ok)
+				{
+					return false;
+				}
+			}
+			return readTag('}');
+		}
 
-						tc_out->div(65535.f);
-						tc_out->mul(tc_range);
-						tc_out->add(min_tc4);
+		bool skipValue(U32 depth)
+		{
+			if (!has(1) || depth > 16)
+			{
+				return false;
+			}
 
-						tc_out++;
+			U32 size = 0;
+			const U8* data = NULL;
+			switch (*mCur++)
+			{
+			case '!':
+			case '0':
+			case '1':
+				return true;
+			case 'i':
+				return readU32(size);
+			case 'r':
+			case 'd':
+				if (!has(8))
+				{
+					return false;
+				}
+				mCur += 8;
+				return true;
+			case 'u':
+				if (!has(UUID_BYTES))
+				{
+					return false;
+				}
+				mCur += UUID_BYTES;
+				return true;
+			case 's':
+			case 'l':
+			case 'b':
+				return readBytes(data, size);
+			case '[':
+				if (!readU32(size))
+				{
+					return false;
+				}
+				for (U32 i = 0; i < size; ++i)
+				{
+					if (!skipValue(depth + 1))
+					{
+						return false;
 					}
 				}
-				else
+				return readTag(']');
+			case '{':
+				if (!readU32(size))
 				{
-					memset(tc_out, 0, sizeof(LLVector2)*num_verts);
+					return false;
 				}
+				for (U32 i = 0; i < size; ++i)
+				{
+					const U8* key = NULL;
+					U32 length = 0;
+					if (!readKey(key, length) || !skipValue(depth + 1))
+					{
+						return false;
+					}
+				}
+				return readTag('}');
+			default:
+				return false;
+			}
+		}
+
+		const U8* mCur;
+		const U8* mEnd;
+	};
+
+	void get_binary(const LLSD& sd, const U8*& data, U32& size)
+	{
+		const LLSD::Binary& binary = sd.asBinary();
+		data = binary.empty() ? NULL : &binary[0];
+		size = binary.size();
+	}
+
+	// points submesh at the streams of an already parsed LOD block, which
+	// has to outlive it
+	void get_submesh(const LLSD& sd, MeshSubmesh& submesh)
+	{
+		submesh.mNoGeometry = sd.has("NoGeometry");
+		get_binary(sd["Position"], submesh.mPosition, submesh.mPositionSize);
+		get_binary(sd["Normal"], submesh.mNormal, submesh.mNormalSize);
+		get_binary(sd["TexCoord0"], submesh.mTexCoord, submesh.mTexCoordSize);
+		get_binary(sd["TriangleList"], submesh.mTriangleList, submesh.mTriangleListSize);
+		submesh.mHasWeights = sd.has("Weights");
+		get_binary(sd["Weights"], submesh.mWeights, submesh.mWeightsSize);
+
+		const LLSD& pos_domain = sd["PositionDomain"];
+		const LLSD& tc_domain = sd["TexCoord0Domain"];
+		for (S32 i = 0; i < 3; ++i)
+		{
+			submesh.mPositionMin[i] = (F32) pos_domain["Min"][i].asReal();
+			submesh.mPositionMax[i] = (F32) pos_domain["Max"][i].asReal();
+		}
+		for (S32 i = 0; i < 2; ++i)
+		{
+			submesh.mTexCoordMin[i] = (F32) tc_domain["Min"][i].asReal();
+			submesh.mTexCoordMax[i] = (F32) tc_domain["Max"][i].asReal();
+		}
+	}
+
+	// four little endian U16s from src as floats, src must have 8 bytes to read
+	inline LLVector4a load_u16x4(const U8* src)
+	{
+		__m128i raw = _mm_loadl_epi64((const __m128i*) src);
+		return LLVector4a(_mm_cvtepi32_ps(_mm_unpacklo_epi16(raw, _mm_setzero_si128())));
+	}
+
+	// Dequantizes count xyz triples of U16s into out as src * scale + bias,
+	// reading each vertex together with the first component of the next
+	// one, so the last vertex is done on its own.
+	void dequantize_xyz(LLVector4a* out, const U8* src, U32 count, const LLVector4a& scale, const LLVector4a& bias)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		for (U32 i = 0; i < count - 1; ++i)
+		{
+			out[i].setMul(load_u16x4(src), scale);
+			out[i].add(bias);
+			src += 6;
+		}
+
+		const U16* v = (const U16*) src;
+		out[count - 1].set((F32) v[0], (F32) v[1], (F32) v[2]);
+		out[count - 1].mul(scale);
+		out[count - 1].add(bias);
+	}
+
+	void unpack_volume_face(LLVolumeFace& face, const MeshSubmesh& submesh, U8 sculpt_type)
+	{
+		if (submesh.mNoGeometry)
+		{ //face has no geometry, continue
+			face.resizeIndices(3);
+			face.resizeVertices(1);
+			memset(face.mPositions, 0, sizeof(LLVector4a));
+			memset(face.mNormals, 0, sizeof(LLVector4a));
+			memset(face.mTexCoords, 0, sizeof(LLVector2));
+			memset(face.mIndices, 0, sizeof(U16)*3);
+			return;
+		}
+
+		//copy out indices
+		face.resizeIndices(submesh.mTriangleListSize/2);
+		
+		if (submesh.mTriangleListSize == 0 || face.mNumIndices < 3)
+		{ //why is there an empty index list?
+			LL_WARNS() <<"Empty face present!" << LL_ENDL;
+			return;
+		}
+
+		memcpy(face.mIndices, submesh.mTriangleList, face.mNumIndices * sizeof(U16));
+
+		//copy out vertices
+		U32 num_verts = submesh.mPositionSize/(3*2);
+		face.resizeVertices(num_verts);
+
+		LLVector4a min_pos, max_pos;
+		min_pos.load3(submesh.mPositionMin);
+		max_pos.load3(submesh.mPositionMax);
+
+		// value / 65535 * range + min, folded into one multiply and add
+		LLVector4a pos_scale;
+		pos_scale.setSub(max_pos, min_pos);
+		pos_scale.mul(1.f / 65535.f);
+		dequantize_xyz(face.mPositions, submesh.mPosition, num_verts, pos_scale, min_pos);
+
+		if (submesh.mNormalSize >= num_verts * 3 * 2)
+		{
+			const F32 norm_step = 2.f / 65535.f;
+			LLVector4a norm_scale(norm_step, norm_step, norm_step, 0.f);
+			LLVector4a norm_bias;
+			norm_bias.splat(-1.f);
+			dequantize_xyz(face.mNormals, submesh.mNormal, num_verts, norm_scale, norm_bias);
+		}
+		else
+		{
+			memset(face.mNormals, 0, sizeof(LLVector4a)*num_verts);
+		}
+
+		if (submesh.mTexCoordSize >= num_verts * 2 * 2)
+		{
+			// two texture coordinates per LLVector4a
+			const F32* tc_min = submesh.mTexCoordMin;
+			const F32 s_step = (submesh.mTexCoordMax[0] - tc_min[0]) / 65535.f;
+			const F32 t_step = (submesh.mTexCoordMax[1] - tc_min[1]) / 65535.f;
+			LLVector4a tc_scale(s_step, t_step, s_step, t_step);
+			LLVector4a tc_bias(tc_min[0], tc_min[1], tc_min[0], tc_min[1]);
+
+			LLVector4a* tc_out = (LLVector4a*) face.mTexCoords;
+			const U8* t = submesh.mTexCoord;
+			for (U32 j = 0; j + 1 < num_verts; j += 2)
+			{
+				tc_out->setMul(load_u16x4(t), tc_scale);
+				tc_out->add(tc_bias);
+				tc_out++;
+				t += 8;
 			}
 
-			if (mdl[i].has("Weights"))
+			if (num_verts & 1)
 			{
-				face.allocateWeights(num_verts);
+				const U16* last = (const U16*) t;
+				face.mTexCoords[num_verts - 1].set(last[0] * s_step + tc_min[0], last[1] * t_step + tc_min[1]);
+			}
+		}
+		else
+		{
+			memset(face.mTexCoords, 0, sizeof(LLVector2)*num_verts);
+		}
 
-				LLSD::Binary weights = mdl[i]["Weights"];
+		if (submesh.mHasWeights)
+		{
+			face.allocateWeights(num_verts);
 
-				U32 idx = 0;
+			const U8* weights = submesh.mWeights;
+			const U32 size = submesh.mWeightsSize;
 
-				U32 cur_vertex = 0;
-				while (idx < weights.size() && cur_vertex < num_verts)
-				{
-					const U8 END_INFLUENCES = 0xFF;
-					U8 joint = weights[idx++];
+			U32 idx = 0;
 
-					U32 cur_influence = 0;
-					LLVector4 wght(0,0,0,0);
-                    U32 joints[4] = {0,0,0,0};
-					LLVector4 joints_with_weights(0,0,0,0);
+			U32 cur_vertex = 0;
+			while (idx < size && cur_vertex < num_verts)
+			{
+				const U8 END_INFLUENCES = 0xFF;
+				U8 joint = weights[idx++];
 
-					while (joint != END_INFLUENCES && idx < weights.size())
-					{
-						U16 influence = weights[idx++];
-						influence |= ((U16) weights[idx++] << 8);
+				U32 cur_influence = 0;
+				LLVector4 wght(0,0,0,0);
+				U32 joints[4] = {0,0,0,0};
+				LLVector4 joints_with_weights(0,0,0,0);
 
-						F32 w = llclamp((F32) influence / 65535.f, 0.f, 0.99999f);
-						wght.mV[cur_influence] = w;
-						joints[cur_influence] = joint;
-						cur_influence++;
+				while (joint != END_INFLUENCES && idx + 1 < size)
+				{
+					U16 influence = weights[idx++];
+					influence |= ((U16) weights[idx++] << 8);
 
-						if (cur_influence >= 4)
-						{
-							joint = END_INFLUENCES;
-						}
-						else
-						{
-							joint = weights[idx++];
-						}
+					F32 w = llclamp((F32) influence / 65535.f, 0.f, 0.99999f);
+					wght.mV[cur_influence] = w;
+					joints[cur_influence] = joint;
+					cur_influence++;
+
+					if (cur_influence >= 4 || idx >= size)
+					{
+						joint = END_INFLUENCES;
+					}
+					else
+					{
+						joint = weights[idx++];
 					}
-                    F32 wsum = wght.mV[VX] + wght.mV[VY] + wght.mV[VZ] + wght.mV[VW];
-                    if (wsum <= 0.f)
-                    {
-                        wght = LLVector4(0.99999f,0.f,0.f,0.f);
-                    }
-                    for (U32 k=0; k<4; k++)
-                    {
-                        joints_with_weights[k] = (F32) joints[k] + wght[k];
-                    }
-					face.mWeights[cur_vertex].loadua(joints_with_weights.mV);
-
-					cur_vertex++;
 				}
-
-				if (cur_vertex != num_verts || idx != weights.size())
+				F32 wsum = wght.mV[VX] + wght.mV[VY] + wght.mV[VZ] + wght.mV[VW];
+				if (wsum <= 0.f)
 				{
-					LL_WARNS() << "Vertex weight count does not match vertex count!" << LL_ENDL;
+					wght = LLVector4(0.99999f,0.f,0.f,0.f);
 				}
-					
+				for (U32 k=0; k<4; k++)
+				{
+					joints_with_weights[k] = (F32) joints[k] + wght[k];
+				}
+				face.mWeights[cur_vertex].loadua(joints_with_weights.mV);
+
+				cur_vertex++;
 			}
 
-			// modifier flags?
-			bool do_mirror = (mParams.getSculptType() & LL_SCULPT_FLAG_MIRROR);
-			bool do_invert = (mParams.getSculptType() &LL_SCULPT_FLAG_INVERT);
-			
-			
-			// translate to actions:
-			bool do_reflect_x = false;
-			bool do_reverse_triangles = false;
-			bool do_invert_normals = false;
-			
-			if (do_mirror)
+			if (cur_vertex != num_verts || idx != size)
 			{
-				do_reflect_x = true;
-				do_reverse_triangles = !do_reverse_triangles;
+				LL_WARNS() << "Vertex weight count does not match vertex count!" << LL_ENDL;
 			}
+		}
+
+		// modifier flags?
+		bool do_mirror = (sculpt_type & LL_SCULPT_FLAG_MIRROR);
+		bool do_invert = (sculpt_type & LL_SCULPT_FLAG_INVERT);
+		
+		
+		// translate to actions:
+		bool do_reflect_x = false;
+		bool do_reverse_triangles = false;
+		bool do_invert_normals = false;
+		
+		if (do_mirror)
+		{
+			do_reflect_x = true;
+			do_reverse_triangles = !do_reverse_triangles;
+		}
+		
+		if (do_invert)
+		{
+			do_invert_normals = true;
+			do_reverse_triangles = !do_reverse_triangles;
+		}
+		
+		// now do the work
+
+		if (do_reflect_x)
+		{
+			LLVector4a* p = (LLVector4a*) face.mPositions;
+			LLVector4a* n = (LLVector4a*) face.mNormals;
 			
-			if (do_invert)
+			for (S32 i = 0; i < face.mNumVertices; i++)
 			{
-				do_invert_normals = true;
-				do_reverse_triangles = !do_reverse_triangles;
+				p[i].mul(-1.0f);
+				n[i].mul(-1.0f);
 			}
-			
-			// now do the work
+		}
 
-			if (do_reflect_x)
+		if (do_invert_normals)
+		{
+			LLVector4a* n = (LLVector4a*) face.mNormals;
+			
+			for (S32 i = 0; i < face.mNumVertices; i++)
 			{
-				LLVector4a* p = (LLVector4a*) face.mPositions;
-				LLVector4a* n = (LLVector4a*) face.mNormals;
-				
-				for (S32 i = 0; i < face.mNumVertices; i++)
-				{
-					p[i].mul(-1.0f);
-					n[i].mul(-1.0f);
-				}
+				n[i].mul(-1.0f);
 			}
+		}
 
-			if (do_invert_normals)
+		if (do_reverse_triangles)
+		{
+			for (U32 j = 0; j < face.mNumIndices; j += 3)
 			{
-				LLVector4a* n = (LLVector4a*) face.mNormals;
-				
-				for (S32 i = 0; i < face.mNumVertices; i++)
-				{
-					n[i].mul(-1.0f);
-				}
+				// swap the 2nd and 3rd index
+				S32 swap = face.mIndices[j+1];
+				face.mIndices[j+1] = face.mIndices[j+2];
+				face.mIndices[j+2] = swap;
 			}
+		}
+
+		//calculate bounding box
+		LLVector4a& min = face.mExtents[0];
+		LLVector4a& max = face.mExtents[1];
 
-			if (do_reverse_triangles)
+		if (face.mNumVertices < 3)
+		{ //empty face, use a dummy 1cm (at 1m scale) bounding box
+			min.splat(-0.005f);
+			max.splat(0.005f);
+		}
+		else
+		{
+			min = max = face.mPositions[0];
+
+			for (S32 i = 1; i < face.mNumVertices; ++i)
 			{
-				for (U32 j = 0; j < face.mNumIndices; j += 3)
-				{
-					// swap the 2nd and 3rd index
-					S32 swap = face.mIndices[j+1];
-					face.mIndices[j+1] = face.mIndices[j+2];
-					face.mIndices[j+2] = swap;
-				}
+				min.setMin(min, face.mPositions[i]);
+				max.setMax(max, face.mPositions[i]);
 			}
 
-			//calculate bounding box
-			LLVector4a& min = face.mExtents[0];
-			LLVector4a& max = face.mExtents[1];
+			if (face.mTexCoords)
+			{
+				LLVector2& min_tc = face.mTexCoordExtents[0];
+				LLVector2& max_tc = face.mTexCoordExtents[1];
+
+				min_tc = face.mTexCoords[0];
+				max_tc = face.mTexCoords[0];
 
-			if (face.mNumVertices < 3)
-			{ //empty face, use a dummy 1cm (at 1m scale) bounding box
-				min.splat(-0.005f);
-				max.splat(0.005f);
+				for (U32 j = 1; j < face.mNumVertices; ++j)
+				{
+					update_min_max(min_tc, max_tc, face.mTexCoords[j]);
+				}
 			}
 			else
 			{
-				min = max = face.mPositions[0];
+				face.mTexCoordExtents[0].set(0,0);
+				face.mTexCoordExtents[1].set(1,1);
+			}
+		}
+	}
 
-				for (S32 i = 1; i < face.mNumVertices; ++i)
-				{
-					min.setMin(min, face.mPositions[i]);
-					max.setMax(max, face.mPositions[i]);
-				}
+	bool unpack_volume_faces(LLVolume::face_list_t& faces, const std::vector<MeshSubmesh>& submeshes, U8 sculpt_type)
+	{
+		U32 face_count = submeshes.size();
 
-				if (face.mTexCoords)
-				{
-					LLVector2& min_tc = face.mTexCoordExtents[0];
-					LLVector2& max_tc = face.mTexCoordExtents[1];
+		if (face_count == 0)
+		{ //no faces unpacked, treat as failed decode
+			LL_WARNS() << "found no faces!" << LL_ENDL;
+			return false;
+		}
 
-					min_tc = face.mTexCoords[0];
-					max_tc = face.mTexCoords[0];
+		faces.resize(face_count);
 
-					for (U32 j = 1; j < face.mNumVertices; ++j)
-					{
-						update_min_max(min_tc, max_tc, face.mTexCoords[j]);
-					}
-				}
-				else
-				{
-					face.mTexCoordExtents[0].set(0,0);
-					face.mTexCoordExtents[1].set(1,1);
-				}
-			}
+		for (U32 i = 0; i < face_count; ++i)
+		{
+			unpack_volume_face(faces[i], submeshes[i], sculpt_type);
 		}
+		return true;
+	}
+}
+
+bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
+{
+	//input stream is now pointing at a zlib compressed block of LLSD
+	//decompress block
+	std::vector<U8> block;
+	if (!unzip_llsd_raw(block, is, size))
+	{
+		LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD, will probably fetch from sim again." << LL_ENDL;
+		return false;
+	}
+
+	std::vector<MeshSubmesh> submeshes;
+	MeshLODReader reader(block.empty() ? NULL : &block[0], block.size());
+	if (reader.read(submeshes))
+	{
+		if (!unpack_volume_faces(mVolumeFaces, submeshes, mParams.getSculptType()))
+		{
+			return false;
+		}
+
+		mSculptLevel = 0;  // success!
+
+		cacheOptimize();
+
+		return true;
+	}
+
+	// not laid out the way uploads write it, go through LLSD
+	sNumMeshLODsFromLLSD++;
+	LLSD mdl;
+	std::string block_str(block.empty() ? "" : (char*) &block[0], block.size());
+	std::istringstream istr(block_str);
+	if (!LLSDSerialize::fromBinary(mdl, istr, block.size()))
+	{
+		LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD, will probably fetch from sim again." << LL_ENDL;
+		return false;
+	}
+
+	return unpackVolumeFaces(mdl);
+}
+
+bool LLVolume::unpackVolumeFaces(const LLSD& mdl)
+{
+	std::vector<MeshSubmesh> submeshes(mdl.size());
+	for (U32 i = 0; i < submeshes.size(); ++i)
+	{
+		get_submesh(mdl[i], submeshes[i]);
+	}
+
+	if (!unpack_volume_faces(mVolumeFaces, submeshes, mParams.getSculptType()))
+	{
+		return false;
 	}
 	
 	mSculptLevel = 0;  // success!
@@ -4013,16 +4440,76 @@ S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& en
 			}
 			else
 			{
-				if (!face.mOctree)
+				if (face.mBVH.isNull())
 				{
-					face.createOctree();
+					face.createBVH();
 				}
-			
-				LLOctreeTriangleRayIntersect intersect(start, dir, &face, &closest_t, intersection, tex_coord, normal, tangent_out);
-				intersect.traverse(face.mOctree);
-				if (intersect.mHitFace)
+
+				F32 a, b;
+				S32 offset = face.mBVH->intersect(start, dir, closest_t, a, b);
+				if (offset >= 0)
 				{
 					hit_face = i;
+
+					U16 idx0 = face.mIndices[offset+0];
+					U16 idx1 = face.mIndices[offset+1];
+					U16 idx2 = face.mIndices[offset+2];
+
+					if (intersection != NULL)
+					{
+						LLVector4a intersect = dir;
+						intersect.mul(closest_t);
+						intersect.add(start);
+						*intersection = intersect;
+					}
+
+					if (tex_coord != NULL)
+					{
+						LLVector2* tc = (LLVector2*) face.mTexCoords;
+						*tex_coord = ((1.f - a - b)  * tc[idx0] +
+							a              * tc[idx1] +
+							b              * tc[idx2]);
+					}
+
+					if (normal != NULL)
+					{
+						LLVector4a* norm = face.mNormals;
+
+						LLVector4a n1,n2,n3;
+						n1 = norm[idx0];
+						n1.mul(1.f-a-b);
+
+						n2 = norm[idx1];
+						n2.mul(a);
+
+						n3 = norm[idx2];
+						n3.mul(b);
+
+						n1.add(n2);
+						n1.add(n3);
+
+						*normal		= n1;
+					}
+
+					if (tangent_out != NULL)
+					{
+						LLVector4a* tangents = face.mTangents;
+
+						LLVector4a t1,t2,t3;
+						t1 = tangents[idx0];
+						t1.mul(1.f-a-b);
+
+						t2 = tangents[idx1];
+						t2.mul(a);
+
+						t3 = tangents[idx2];
+						t3.mul(b);
+
+						t1.add(t2);
+						t1.add(t3);
+
+						*tangent_out = t1;
+					}
 				}
 			}
 		}		
@@ -4675,6 +5162,9 @@ LLVolumeFace& LLVolumeFace::operator=(const LLVolumeFace& src)
 	
 	mOptimized = src.mOptimized;
 
+	//the tree keeps its own copy of what it needs, so it holds for the copy too
+	mBVH = src.mBVH;
+
 	//delete 
 	return *this;
 }
@@ -4705,6 +5195,7 @@ void LLVolumeFace::freeData()
 
 	delete mOctree;
 	mOctree = NULL;
+	mBVH = NULL;
 }
 
 BOOL LLVolumeFace::create(LLVolume* volume, BOOL partial_build)
@@ -4712,6 +5203,7 @@ BOOL LLVolumeFace::create(LLVolume* volume, BOOL partial_build)
 	//tree for this face is no longer valid
 	delete mOctree;
 	mOctree = NULL;
+	mBVH = NULL;
 
 	LL_CHECK_MEMORY
 	BOOL ret = FALSE ;
@@ -5141,6 +5633,9 @@ void LLVolumeFace::cacheOptimize()
 	llassert(!mOptimized);
 	mOptimized = TRUE;
 
+	//triangles are about to be reordered
+	mBVH = NULL;
+
 	LLVCacheLRU cache;
 	
 	if (mNumVertices < 3)
@@ -5399,6 +5894,15 @@ void LLVolumeFace::createOctree(F32 scaler, const LLVector4a& center, const LLVe
 	}
 }
 
+void LLVolumeFace::createBVH()
+{
+	if (mBVH.notNull())
+	{
+		return;
+	}
+
+	mBVH = new LLVolumeBVH(mPositions, mIndices, mNumIndices);
+}
 
 void LLVolumeFace::swapData(LLVolumeFace& rhs)
 {
@@ -5409,6 +5913,7 @@ void LLVolumeFace::swapData(LLVolumeFace& rhs)
 	llswap(rhs.mIndices,mIndices);
 	llswap(rhs.mNumVertices, mNumVertices);
 	llswap(rhs.mNumIndices, mNumIndices);
+	llswap(rhs.mBVH, mBVH);
 }
 
 void	LerpPlanarVertex(LLVolumeFace::VertexData& v0,
@@ -57,6 +57,7 @@ class LLVolumeTriangle;
 #include "llpointer.h"
 #include "llfile.h"
 #include "llalignedarray.h"
+#include "llvolumebvh.h"
 
 //============================================================================
 
@@ -903,6 +904,10 @@ public:
 
 	void createOctree(F32 scaler = 0.25f, const LLVector4a& center = LLVector4a(0,0,0), const LLVector4a& size = LLVector4a(0.5f,0.5f,0.5f));
 
+	// builds mBVH from the current positions and indices if there isn't one,
+	// safe to call off the main thread while nothing else uses the face
+	void createBVH();
+
 	enum
 	{
 		SINGLE_MASK =	0x0001,
@@ -955,6 +960,10 @@ public:
 
 	LLOctreeNode<LLVolumeTriangle>* mOctree;
 
+	//picking structure used by LLVolume::lineSegmentIntersect, dropped
+	//whenever the positions or indices it was built from change
+	LLPointer<LLVolumeBVH> mBVH;
+
 	//whether or not face has been cache optimized
 	BOOL mOptimized;
 
@@ -1040,6 +1049,8 @@ public:
 
 	BOOL isFaceMaskValid(LLFaceID face_mask);
 	static S32 sNumMeshPoints;
+	// LOD blocks that could not be read in place so far
+	static S32 getNumMeshLODsFromLLSD();
 
 	friend std::ostream& operator<<(std::ostream &s, const LLVolume &volume);
 	friend std::ostream& operator<<(std::ostream &s, const LLVolume *volumep);		// HACK to bypass Windoze confusion over 
@@ -1070,7 +1081,12 @@ protected:
 	BOOL generate();
 	void createVolumeFaces();
 public:
+	// Decodes a zipped mesh LOD block.  Blocks laid out the way uploads
+	// write them are decoded straight out of the inflated bytes, anything
+	// else is parsed into LLSD first.
 	virtual bool unpackVolumeFaces(std::istream& is, S32 size);
+	// Decodes the faces of a mesh LOD block already parsed into LLSD
+	bool unpackVolumeFaces(const LLSD& mdl);
 
 	virtual void setMeshAssetLoaded(BOOL loaded);
 	virtual BOOL isMeshAssetLoaded();
@@ -0,0 +1,528 @@
+/**
+ * @file llvolumebvh.cpp
+ * @brief Flattened bounding volume hierarchy over the triangles of a volume face.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llvolumebvh.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "llmemory.h"
+
+namespace
+{
+	// Below this depth splits halve the triangles by count instead, so a
+	// badly shaped mesh cannot outgrow the traversal stack.
+	const U32 MAX_SAH_DEPTH = 32;
+	const U32 MAX_STACK_DEPTH = 64;
+
+	F32 half_area(const LLVector4a& min, const LLVector4a& max)
+	{
+		LLVector4a size;
+		size.setSub(max, min);
+		return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+	}
+
+	// node as laid out while building, before it is padded and packed
+	struct BuildNode
+	{
+		F32 mMin[4];
+		F32 mMax[4];
+		U32 mFirst;
+		U32 mCount;
+	};
+
+	// which of the bins along an axis a triangle's centroid falls in
+	struct BinOf
+	{
+		const LLVector4a* mBounds;
+		S32 mAxis;
+		F32 mMin;
+		F32 mScale;
+
+		S32 operator()(U32 tri) const
+		{
+			S32 bin = (S32) ((mBounds[tri * 3 + 2][mAxis] - mMin) * mScale);
+			return llclamp(bin, 0, (S32) LLVolumeBVH::NUM_BINS - 1);
+		}
+	};
+
+	struct BelowSplit
+	{
+		BinOf mBinOf;
+		S32 mSplit;
+
+		bool operator()(U32 tri) const
+		{
+			return mBinOf(tri) < mSplit;
+		}
+	};
+
+	struct CentroidLess
+	{
+		const LLVector4a* mBounds;
+		S32 mAxis;
+
+		bool operator()(U32 lhs, U32 rhs) const
+		{
+			return mBounds[lhs * 3 + 2][mAxis] < mBounds[rhs * 3 + 2][mAxis];
+		}
+	};
+
+	class BVHBuilder
+	{
+	public:
+		BVHBuilder(const LLVector4a* positions, const U16* indices, U32 count)
+		:	mOrder(count)
+		{
+			// min, max and centroid of every triangle
+			mBounds = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a) * 3 * count);
+			for (U32 i = 0; i < count; ++i)
+			{
+				const LLVector4a& v0 = positions[indices[i * 3 + 0]];
+				const LLVector4a& v1 = positions[indices[i * 3 + 1]];
+				const LLVector4a& v2 = positions[indices[i * 3 + 2]];
+
+				LLVector4a* bounds = mBounds + i * 3;
+				bounds[0].setMin(v0, v1);
+				bounds[0].setMin(bounds[0], v2);
+				bounds[1].setMax(v0, v1);
+				bounds[1].setMax(bounds[1], v2);
+				bounds[2].setAdd(bounds[0], bounds[1]);
+				bounds[2].mul(0.5f);
+
+				mOrder[i] = i;
+			}
+			mNodes.reserve(count / 2 + 1);
+		}
+
+		~BVHBuilder()
+		{
+			ll_aligned_free_16(mBounds);
+		}
+
+		// Appends the node for mOrder[begin, end) and everything below it.
+		void build(U32 begin, U32 end, U32 depth)
+		{
+			const U32 index = mNodes.size();
+			mNodes.push_back(BuildNode());
+
+			LLVector4a min = mBounds[mOrder[begin] * 3 + 0];
+			LLVector4a max = mBounds[mOrder[begin] * 3 + 1];
+			LLVector4a centroid_min = mBounds[mOrder[begin] * 3 + 2];
+			LLVector4a centroid_max = centroid_min;
+			for (U32 i = begin + 1; i < end; ++i)
+			{
+				const LLVector4a* bounds = mBounds + mOrder[i] * 3;
+				min.setMin(min, bounds[0]);
+				max.setMax(max, bounds[1]);
+				centroid_min.setMin(centroid_min, bounds[2]);
+				centroid_max.setMax(centroid_max, bounds[2]);
+			}
+			for (U32 i = 0; i < 3; ++i)
+			{
+				mNodes[index].mMin[i] = min[i];
+				mNodes[index].mMax[i] = max[i];
+			}
+			mNodes[index].mMin[3] = mNodes[index].mMax[3] = 0.f;
+
+			const U32 count = end - begin;
+			if (count <= LLVolumeBVH::MAX_LEAF_TRIANGLES)
+			{
+				mNodes[index].mFirst = begin;
+				mNodes[index].mCount = count;
+				return;
+			}
+
+			LLVector4a extent;
+			extent.setSub(centroid_max, centroid_min);
+			S32 axis = extent[0] > extent[1] ? 0 : 1;
+			if (extent[2] > extent[axis])
+			{
+				axis = 2;
+			}
+
+			U32 mid = begin;
+			if (extent[axis] > 0.f && depth < MAX_SAH_DEPTH)
+			{
+				BelowSplit below;
+				below.mBinOf.mBounds = mBounds;
+				below.mBinOf.mAxis = axis;
+				below.mBinOf.mMin = centroid_min[axis];
+				below.mBinOf.mScale = LLVolumeBVH::NUM_BINS / extent[axis];
+				below.mSplit = findSplit(begin, end, below.mBinOf);
+				mid = std::partition(mOrder.begin() + begin, mOrder.begin() + end, below) - mOrder.begin();
+			}
+
+			if (mid == begin || mid == end)
+			{ //centroids all in one place, or too deep to keep looking
+				mid = begin + count / 2;
+				CentroidLess less = { mBounds, axis };
+				std::nth_element(mOrder.begin() + begin, mOrder.begin() + mid, mOrder.begin() + end, less);
+			}
+
+			mNodes[index].mCount = 0;
+			build(begin, mid, depth + 1);
+			mNodes[index].mFirst = mNodes.size();
+			build(mid, end, depth + 1);
+		}
+
+		const std::vector<BuildNode>& getNodes() const	{ return mNodes; }
+		const std::vector<U32>& getOrder() const		{ return mOrder; }
+
+	private:
+		// Returns the first bin of the right hand side of the cheapest split
+		// by the surface area heuristic, or 0 if every split leaves one side
+		// empty.
+		S32 findSplit(U32 begin, U32 end, const BinOf& bin_of) const
+		{
+			LLVector4a bin_min[LLVolumeBVH::NUM_BINS];
+			LLVector4a bin_max[LLVolumeBVH::NUM_BINS];
+			U32 bin_count[LLVolumeBVH::NUM_BINS];
+			memset(bin_count, 0, sizeof(bin_count));
+
+			for (U32 i = begin; i < end; ++i)
+			{
+				const LLVector4a* bounds = mBounds + mOrder[i] * 3;
+				S32 bin = bin_of(mOrder[i]);
+				if (bin_count[bin]++)
+				{
+					bin_min[bin].setMin(bin_min[bin], bounds[0]);
+					bin_max[bin].setMax(bin_max[bin], bounds[1]);
+				}
+				else
+				{
+					bin_min[bin] = bounds[0];
+					bin_max[bin] = bounds[1];
+				}
+			}
+
+			// cost of everything from bin i up
+			F32 right_cost[LLVolumeBVH::NUM_BINS];
+			U32 right_count[LLVolumeBVH::NUM_BINS];
+			LLVector4a min, max;
+			U32 count = 0;
+			for (S32 i = LLVolumeBVH::NUM_BINS - 1; i > 0; --i)
+			{
+				if (bin_count[i])
+				{
+					if (count)
+					{
+						min.setMin(min, bin_min[i]);
+						max.setMax(max, bin_max[i]);
+					}
+					else
+					{
+						min = bin_min[i];
+						max = bin_max[i];
+					}
+					count += bin_count[i];
+				}
+				right_count[i] = count;
+				right_cost[i] = count ? count * half_area(min, max) : 0.f;
+			}
+
+			S32 best = 0;
+			F32 best_cost = 0.f;
+			count = 0;
+			for (S32 i = 1; i < LLVolumeBVH::NUM_BINS; ++i)
+			{
+				const S32 left = i - 1;
+				if (bin_count[left])
+				{
+					if (count)
+					{
+						min.setMin(min, bin_min[left]);
+						max.setMax(max, bin_max[left]);
+					}
+					else
+					{
+						min = bin_min[left];
+						max = bin_max[left];
+					}
+					count += bin_count[left];
+				}
+				if (!count || !right_count[i])
+				{
+					continue;
+				}
+				F32 cost = count * half_area(min, max) + right_cost[i];
+				if (!best || cost < best_cost)
+				{
+					best = i;
+					best_cost = cost;
+				}
+			}
+			return best;
+		}
+
+		LLVector4a* mBounds;
+		std::vector<U32> mOrder;
+		std::vector<BuildNode> mNodes;
+	};
+
+	// Slab test of the segment against a node's box, for t in [0, t_max].
+	inline bool intersect_box(const LLVector4a& start, const LLVector4a& inv_dir, const LLVolumeBVH::Node& node,
+							  F32 t_max, F32& t_near)
+	{
+		LLVector4a t0;
+		t0.setSub(node.mMin, start);
+		t0.mul(inv_dir);
+
+		LLVector4a t1;
+		t1.setSub(node.mMax, start);
+		t1.mul(inv_dir);
+
+		LLVector4a near_t;
+		near_t.setMin(t0, t1);
+		LLVector4a far_t;
+		far_t.setMax(t0, t1);
+
+		t_near = llmax(llmax(near_t[0], near_t[1]), llmax(near_t[2], 0.f));
+		F32 t_far = llmin(llmin(far_t[0], far_t[1]), llmin(far_t[2], t_max));
+		return t_near <= t_far;
+	}
+
+	// LLTriangleRayIntersect with the edges worked out ahead of time.  The
+	// arithmetic is the same so hits agree with the octree exactly.
+	inline bool intersect_triangle(const LLVector4a* tri, const LLVector4a& orig, const LLVector4a& dir,
+								   F32& a, F32& b, F32& t)
+	{
+		const LLVector4a& vert0 = tri[0];
+		const LLVector4a& edge1 = tri[1];
+		const LLVector4a& edge2 = tri[2];
+
+		LLVector4a pvec;
+		pvec.setCross3(dir, edge2);
+
+		LLVector4a det;
+		det.setAllDot3(edge1, pvec);
+		if (!(det.greaterEqual(LLVector4a::getEpsilon()).getGatheredBits() & 0x7))
+		{
+			return false;
+		}
+
+		LLVector4a tvec;
+		tvec.setSub(orig, vert0);
+
+		LLVector4a u;
+		u.setAllDot3(tvec, pvec);
+		if (!(u.greaterEqual(LLVector4a::getZero()).getGatheredBits() & 0x7) ||
+			!(u.lessEqual(det).getGatheredBits() & 0x7))
+		{
+			return false;
+		}
+
+		LLVector4a qvec;
+		qvec.setCross3(tvec, edge1);
+
+		LLVector4a v;
+		v.setAllDot3(dir, qvec);
+
+		LLVector4a sum_uv;
+		sum_uv.setAdd(u, v);
+		if (!(v.greaterEqual(LLVector4a::getZero()).getGatheredBits() & 0x7) ||
+			!(sum_uv.lessEqual(det).getGatheredBits() & 0x7))
+		{
+			return false;
+		}
+
+		LLVector4a dist;
+		dist.setAllDot3(edge2, qvec);
+		dist.div(det);
+		u.div(det);
+		v.div(det);
+
+		a = u[0];
+		b = v[0];
+		t = dist[0];
+		return true;
+	}
+}
+
+LLVolumeBVH::LLVolumeBVH(const LLVector4a* positions, const U16* indices, U32 num_indices)
+:	mNodes(NULL),
+	mNodeCount(0),
+	mTriangles(NULL),
+	mIndexOffsets(NULL),
+	mTriangleCount(num_indices / 3)
+{
+	if (!mTriangleCount)
+	{
+		return;
+	}
+
+	BVHBuilder builder(positions, indices, mTriangleCount);
+	builder.build(0, mTriangleCount, 0);
+
+	const std::vector<U32>& order = builder.getOrder();
+	mTriangles = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a) * 3 * mTriangleCount);
+	mIndexOffsets = (U32*) ll_aligned_malloc_16(sizeof(U32) * mTriangleCount);
+	for (U32 i = 0; i < mTriangleCount; ++i)
+	{
+		const U32 offset = order[i] * 3;
+		const LLVector4a& v0 = positions[indices[offset]];
+		mTriangles[i * 3 + 0] = v0;
+		mTriangles[i * 3 + 1].setSub(positions[indices[offset + 1]], v0);
+		mTriangles[i * 3 + 2].setSub(positions[indices[offset + 2]], v0);
+		mIndexOffsets[i] = offset;
+	}
+
+	const std::vector<BuildNode>& nodes = builder.getNodes();
+	mNodeCount = nodes.size();
+	mNodes = (Node*) ll_aligned_malloc_16(sizeof(Node) * mNodeCount);
+
+	// grow every box a little so rounding in the slab test cannot lose a
+	// ray that grazes a flat node
+	LLVector4a pad;
+	pad.setSub(LLVector4a(nodes[0].mMax[0], nodes[0].mMax[1], nodes[0].mMax[2]),
+			   LLVector4a(nodes[0].mMin[0], nodes[0].mMin[1], nodes[0].mMin[2]));
+	pad.splat(llmax(pad.getLength3().getF32() * 0.0001f, F_APPROXIMATELY_ZERO));
+
+	for (U32 i = 0; i < mNodeCount; ++i)
+	{
+		const BuildNode& src = nodes[i];
+		Node& dst = mNodes[i];
+		dst.mMin.set(src.mMin[0], src.mMin[1], src.mMin[2]);
+		dst.mMin.sub(pad);
+		dst.mMax.set(src.mMax[0], src.mMax[1], src.mMax[2]);
+		dst.mMax.add(pad);
+		dst.mFirst = src.mFirst;
+		dst.mCount = src.mCount;
+		dst.mPad[0] = dst.mPad[1] = 0;
+	}
+}
+
+LLVolumeBVH::~LLVolumeBVH()
+{
+	ll_aligned_free_16(mNodes);
+	mNodes = NULL;
+	ll_aligned_free_16(mTriangles);
+	mTriangles = NULL;
+	ll_aligned_free_16(mIndexOffsets);
+	mIndexOffsets = NULL;
+}
+
+S32 LLVolumeBVH::intersect(const LLVector4a& start, const LLVector4a& dir, F32& closest_t, F32& a, F32& b) const
+{
+	if (!mNodeCount)
+	{
+		return -1;
+	}
+
+	// a huge but finite inverse stands in for infinity where the segment
+	// runs parallel to an axis, so the slab test never sees 0 * inf
+	F32 inv[3];
+	for (U32 i = 0; i < 3; ++i)
+	{
+		F32 d = dir[i];
+		if (fabsf(d) < 1e-20f)
+		{
+			d = d < 0.f ? -1e-20f : 1e-20f;
+		}
+		inv[i] = 1.f / d;
+	}
+	LLVector4a inv_dir(inv[0], inv[1], inv[2]);
+
+	F32 t_near;
+	if (!intersect_box(start, inv_dir, mNodes[0], llmin(closest_t, 1.f), t_near))
+	{
+		return -1;
+	}
+
+	S32 hit = -1;
+	U32 stack[MAX_STACK_DEPTH];
+	F32 stack_t[MAX_STACK_DEPTH];
+	U32 depth = 0;
+	U32 index = 0;
+
+	while (true)
+	{
+		const Node& node = mNodes[index];
+		if (node.mCount)
+		{
+			const U32 last = node.mFirst + node.mCount;
+			for (U32 i = node.mFirst; i < last; ++i)
+			{
+				F32 tri_a, tri_b, t;
+				if (intersect_triangle(mTriangles + i * 3, start, dir, tri_a, tri_b, t) &&
+					t >= 0.f &&			// if hit is after start
+					t <= 1.f &&			// and before end
+					t < closest_t)		// and this hit is closer
+				{
+					closest_t = t;
+					a = tri_a;
+					b = tri_b;
+					hit = mIndexOffsets[i];
+				}
+			}
+		}
+		else
+		{
+			const F32 t_max = llmin(closest_t, 1.f);
+			U32 near_child = index + 1;
+			U32 far_child = node.mFirst;
+			F32 near_t, far_t;
+			bool hit_near = intersect_box(start, inv_dir, mNodes[near_child], t_max, near_t);
+			bool hit_far = intersect_box(start, inv_dir, mNodes[far_child], t_max, far_t);
+
+			if (hit_near && hit_far)
+			{ //visit the closer child first, the other may be skipped later
+				if (far_t < near_t)
+				{
+					std::swap(near_child, far_child);
+					std::swap(near_t, far_t);
+				}
+				llassert(depth < MAX_STACK_DEPTH);
+				stack[depth] = far_child;
+				stack_t[depth] = far_t;
+				++depth;
+				index = near_child;
+				continue;
+			}
+			else if (hit_near || hit_far)
+			{
+				index = hit_near ? near_child : far_child;
+				continue;
+			}
+		}
+
+		// back up to the nearest child left waiting that still might hold
+		// something closer than what was found
+		while (depth && stack_t[depth - 1] > closest_t)
+		{
+			--depth;
+		}
+		if (!depth)
+		{
+			break;
+		}
+		index = stack[--depth];
+	}
+
+	return hit;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file llvolumebvh.h
+ * @brief Flattened bounding volume hierarchy over the triangles of a volume face.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOLUMEBVH_H
+#define LL_LLVOLUMEBVH_H
+
+#include "llmath.h"
+#include "llrefcount.h"
+#include "llvector4a.h"
+
+//
+// LLVolumeBVH
+//
+// A ray picking structure for one LLVolumeFace.  Nodes live depth first in
+// a single array, an inner node's first child right after it, and the
+// triangles of each leaf sit next to each other with their edges already
+// worked out, so a pick walks memory forwards instead of chasing the
+// pointers of an LLOctreeNode<LLVolumeTriangle>.  Splits are chosen by the
+// surface area heuristic over a fixed number of bins along the longest
+// axis.
+//
+// Building touches nothing but the positions and indices handed in, so it
+// can happen on whichever thread produced them.  The tree copies what it
+// needs and does not follow later changes to the face.
+//
+class LLVolumeBVH : public LLRefCount
+{
+public:
+	enum
+	{
+		MAX_LEAF_TRIANGLES = 4,
+		NUM_BINS = 12
+	};
+
+	LLVolumeBVH(const LLVector4a* positions, const U16* indices, U32 num_indices);
+
+	// Finds the closest triangle hit by the segment start + t*dir for
+	// 0 <= t <= 1 that is nearer than closest_t, with the same one sided
+	// test as LLTriangleRayIntersect.  On a hit, closest_t, a and b are
+	// updated and the offset of the triangle in the face's index list is
+	// returned, otherwise -1.
+	S32 intersect(const LLVector4a& start, const LLVector4a& dir, F32& closest_t, F32& a, F32& b) const;
+
+	U32 getTriangleCount() const	{ return mTriangleCount; }
+	U32 getNodeCount() const		{ return mNodeCount; }
+
+	LL_ALIGN_PREFIX(16)
+	struct Node
+	{
+		LLVector4a mMin;
+		LLVector4a mMax;
+		// leaves: index of the first triangle, inner nodes: index of the
+		// second child
+		U32 mFirst;
+		// number of triangles, 0 for inner nodes
+		U32 mCount;
+		U32 mPad[2];
+	} LL_ALIGN_POSTFIX(16);
+
+protected:
+	~LLVolumeBVH();
+
+private:
+	LLVolumeBVH(const LLVolumeBVH& rhs);
+	const LLVolumeBVH& operator=(const LLVolumeBVH& rhs);
+
+	Node* mNodes;
+	U32 mNodeCount;
+
+	// three per triangle: first vertex, edge to the second, edge to the third
+	LLVector4a* mTriangles;
+	// offset of each triangle's first index in the face's index list
+	U32* mIndexOffsets;
+	U32 mTriangleCount;
+};
+
+#endif // LL_LLVOLUMEBVH_H
@@ -0,0 +1,513 @@
+/**
+ * @file   lloctree_test.cpp
+ * @brief  Test and frustum culling benchmark for lloctree.h.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+
+#include "../llcamera.h"
+#include "../lloctree.h"
+#include "llrand.h"
+#include "lltimer.h"
+#include "llworkpool.h"
+
+#include "../test/lltut.h"
+
+// normally set from the viewer's OctreeMaxNodeCapacity and
+// OctreeMinimumNodeSize settings
+U32 gOctreeMaxCapacity = 128;
+F32 gOctreeMinSize = 0.01f;
+
+namespace
+{
+	// stands in for a drawable: a bounding sphere the octree can bin
+	class TestEntry : public LLRefCount
+	{
+	public:
+		TestEntry(const LLVector3& position, F32 radius)
+		:	mRadius(radius),
+			mBinIndex(-1)
+		{
+			mPosition.load3(position.mV);
+			mExtent.splat(radius);
+		}
+
+		const LLVector4a& getPositionGroup() const	{ return mPosition; }
+		const LLVector4a& getExtent() const			{ return mExtent; }
+		F32 getBinRadius() const					{ return mRadius; }
+		S32 getBinIndex() const						{ return mBinIndex; }
+		void setBinIndex(S32 index) const			{ mBinIndex = index; }
+
+	private:
+		LLVector4a mPosition;
+		LLVector4a mExtent;
+		F32 mRadius;
+		mutable S32 mBinIndex;
+	};
+
+	typedef LLOctreeNode<TestEntry> test_node_t;
+	typedef LLOctreeRoot<TestEntry> test_root_t;
+	typedef LLOctreeTraveler<TestEntry> test_traveler_t;
+
+	// stands in for a spatial group: numbered in the order nodes are made,
+	// with the flags the viewer's cull looks at
+	class TestGroup : public LLOctreeListener<TestEntry>
+	{
+	public:
+		TestGroup(test_node_t* node, U32* next_id)
+		:	mNode(node),
+			mNextID(next_id),
+			mID((*next_id)++),
+			mSkipFrustumCheck(false),
+			mFail(false)
+		{
+			node->addListener(this);
+		}
+
+		virtual void handleInsertion(const LLTreeNode<TestEntry>* node, TestEntry* data) {}
+		virtual void handleRemoval(const LLTreeNode<TestEntry>* node, TestEntry* data) {}
+		virtual void handleDestruction(const LLTreeNode<TestEntry>* node) {}
+		virtual void handleStateChange(const LLTreeNode<TestEntry>* node) {}
+		virtual void handleChildAddition(const test_node_t* parent, test_node_t* child) { new TestGroup(child, mNextID); }
+		virtual void handleChildRemoval(const test_node_t* parent, const test_node_t* child) {}
+
+		const test_node_t* mNode;
+		U32* mNextID;
+		const U32 mID;
+		bool mSkipFrustumCheck;
+		bool mFail;
+	};
+
+	typedef LLOctreeCullRecord<TestEntry, TestGroup> test_record_t;
+
+	// The culler LLViewerOctreeCull is, minus the viewer: traverse() is its
+	// walk, record() and replay() the split one it runs on worker threads.
+	// Both log every preprocess() and processGroup() call in order.
+	class TestCull : public test_traveler_t
+	{
+	public:
+		TestCull(LLCamera* camera, std::vector<U32>* log)
+		:	mCamera(camera),
+			mRes(0),
+			mLog(log)
+		{
+		}
+
+		virtual void traverse(const test_node_t* n)
+		{
+			TestGroup* group = (TestGroup*) n->getListener(0);
+			if (earlyFail(group))
+			{
+				return;
+			}
+
+			if (mRes == 2 || (mRes && skipFrustumCheck(group)))
+			{
+				test_traveler_t::traverse(n);
+			}
+			else
+			{
+				mRes = frustumCheck(group);
+				if (mRes)
+				{
+					test_traveler_t::traverse(n);
+				}
+				mRes = 0;
+			}
+		}
+
+		virtual void visit(const test_node_t* branch)
+		{
+			TestGroup* group = (TestGroup*) branch->getListener(0);
+			preprocess(group);
+			if (checkObjects(branch, group))
+			{
+				processGroup(group);
+			}
+		}
+
+		void record(const test_node_t* n, test_record_t::steps_t& steps)
+		{
+			test_record_t::record(*this, mRes, n, steps);
+		}
+
+		void replay(const test_record_t::steps_t& steps)
+		{
+			test_record_t::replay(*this, mRes, steps);
+		}
+
+		// tests nodes by their loose bounds, as groups are
+		S32 frustumCheck(const TestGroup* group)
+		{
+			LLVector4a loose;
+			loose.setMul(group->mNode->getSize(), 2.f);
+			return mCamera->AABBInFrustum(group->mNode->getCenter(), loose);
+		}
+
+		bool skipFrustumCheck(const TestGroup* group) const
+		{
+			return group->mSkipFrustumCheck;
+		}
+
+		bool checkObjects(const test_node_t* branch, const TestGroup* group)
+		{
+			if (branch->getElementCount() == 0)
+			{
+				return false;
+			}
+			if (branch->getChildCount() == 0 || mRes != 1)
+			{
+				return true;
+			}
+			for (test_node_t::const_element_iter it = branch->getDataBegin(); it != branch->getDataEnd(); ++it)
+			{
+				if (mCamera->AABBInFrustum((*it)->getPositionGroup(), (*it)->getExtent()))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool earlyFail(TestGroup* group)
+		{
+			return group->mFail;
+		}
+
+		void preprocess(TestGroup* group)
+		{
+			mLog->push_back(group->mID * 2);
+		}
+
+		void processGroup(TestGroup* group)
+		{
+			mLog->push_back(group->mID * 2 + 1);
+		}
+
+	private:
+		LLCamera* mCamera;
+		S32 mRes;
+		std::vector<U32>* mLog;
+	};
+
+	// a spatial partition: one octree and the steps recorded for it
+	struct TestPartition
+	{
+		TestPartition() : mRoot(NULL), mNextID(0) {}
+		~TestPartition() { delete mRoot; }
+
+		test_root_t* mRoot;
+		U32 mNextID;
+		test_record_t::steps_t mSteps;
+	};
+
+	// marks some groups to be skipped and some as not needing their own
+	// frustum test, the way occlusion and SKIP_FRUSTUM_CHECK do
+	void mark_groups(const test_node_t* node)
+	{
+		TestGroup* group = (TestGroup*) node->getListener(0);
+		group->mFail = group->mID % 11 == 5;
+		group->mSkipFrustumCheck = group->mID % 3 == 1;
+		for (U32 i = 0; i < node->getChildCount(); ++i)
+		{
+			mark_groups(node->getChild(i));
+		}
+	}
+
+	void clear_marks(const test_node_t* node)
+	{
+		TestGroup* group = (TestGroup*) node->getListener(0);
+		group->mFail = false;
+		group->mSkipFrustumCheck = false;
+		for (U32 i = 0; i < node->getChildCount(); ++i)
+		{
+			clear_marks(node->getChild(i));
+		}
+	}
+
+	// Finds a partly visible node with a child followed by one the frustum
+	// check puts at want, 0 outside or 2 fully inside, then marks the first
+	// to fail early and the second to skip its frustum check.  The single
+	// walk hands the second one its parent's state untested.
+	TestGroup* mark_inherited(TestCull& culler, const test_node_t* node, S32 want)
+	{
+		S32 res = culler.frustumCheck((TestGroup*) node->getListener(0));
+		if (res == 0)
+		{
+			return NULL;
+		}
+		for (U32 i = 1; res == 1 && i < node->getChildCount(); ++i)
+		{
+			TestGroup* first = (TestGroup*) node->getChild(i - 1)->getListener(0);
+			TestGroup* second = (TestGroup*) node->getChild(i)->getListener(0);
+			if (culler.frustumCheck(second) == want)
+			{
+				first->mFail = true;
+				second->mSkipFrustumCheck = true;
+				return second;
+			}
+		}
+		for (U32 i = 0; i < node->getChildCount(); ++i)
+		{
+			TestGroup* marked = mark_inherited(culler, node->getChild(i), want);
+			if (marked)
+			{
+				return marked;
+			}
+		}
+		return NULL;
+	}
+
+	U32 count_entries(const test_node_t* node)
+	{
+		U32 count = node->getElementCount();
+		for (U32 i = 0; i < node->getChildCount(); ++i)
+		{
+			count += count_entries(node->getChild(i));
+		}
+		return count;
+	}
+
+	void record_partition(LLCamera* camera, std::vector<TestPartition>* partitions, U32 index)
+	{
+		TestPartition& partition = (*partitions)[index];
+		partition.mSteps.clear();
+		TestCull culler(camera, NULL);
+		culler.record(partition.mRoot, partition.mSteps);
+	}
+
+	// what LLPipeline::updateCull() does: the frustum tests of every
+	// partition on the pool, then the rest in partition order
+	void cull_recorded(LLCamera* camera, std::vector<TestPartition>& partitions, LLWorkPool& pool, std::vector<U32>& log)
+	{
+		pool.run(partitions.size(), boost::bind(record_partition, camera, &partitions, _1));
+		for (std::vector<TestPartition>::iterator it = partitions.begin(); it != partitions.end(); ++it)
+		{
+			TestCull culler(camera, &log);
+			culler.replay(it->mSteps);
+		}
+	}
+
+	void cull_serial(LLCamera* camera, std::vector<TestPartition>& partitions, std::vector<U32>& log)
+	{
+		for (std::vector<TestPartition>::iterator it = partitions.begin(); it != partitions.end(); ++it)
+		{
+			TestCull culler(camera, &log);
+			culler.traverse(it->mRoot);
+		}
+	}
+}
+
+namespace tut
+{
+	struct lloctree_data
+	{
+		// A camera at the west edge of a region looking east, with its
+		// frustum planes set up from the corners the way LLViewerCamera does.
+		void setupCamera(LLCamera& camera, F32 far_clip)
+		{
+			const LLVector3 origin(0.f, 128.f, 40.f);
+			const LLVector3 at(1.f, 0.f, 0.f);
+			const LLVector3 left(0.f, 1.f, 0.f);
+			const LLVector3 up(0.f, 0.f, 1.f);
+			const F32 tan_half_fov = tanf(F_PI / 6.f);
+			const F32 aspect = 16.f / 9.f;
+
+			LLVector3 frust[8];
+			for (U32 i = 0; i < 8; ++i)
+			{
+				F32 dist = i < 4 ? 0.5f : far_clip;
+				F32 height = dist * tan_half_fov;
+				F32 width = height * aspect;
+				// bottom left, bottom right, top right, top left
+				F32 x = (i % 4 == 0 || i % 4 == 3) ? width : -width;
+				F32 y = (i % 4 < 2) ? -height : height;
+				frust[i] = origin + at * dist + left * x + up * y;
+			}
+			camera.setOrigin(origin);
+			camera.calcAgentFrustumPlanes(frust);
+		}
+
+		// partitions stacked along the camera's view, count entries each
+		void buildPartitions(std::vector<TestPartition>& partitions, U32 count)
+		{
+			for (U32 p = 0; p < partitions.size(); ++p)
+			{
+				TestPartition& partition = partitions[p];
+				const F32 offset = p * 256.f;
+				LLVector4a center(offset + 128.f, 128.f, 128.f);
+				LLVector4a size(128.f, 128.f, 128.f);
+				partition.mRoot = new test_root_t(center, size, NULL);
+				new TestGroup(partition.mRoot, &partition.mNextID);
+				for (U32 i = 0; i < count; ++i)
+				{
+					LLVector3 position(offset + ll_frand(256.f), ll_frand(256.f), ll_frand(100.f));
+					partition.mRoot->insert(new TestEntry(position, 0.25f + ll_frand(4.f)));
+				}
+				mark_groups(partition.mRoot);
+			}
+		}
+	};
+	typedef test_group<lloctree_data> lloctree_test;
+	typedef lloctree_test::object lloctree_object;
+	tut::lloctree_test tlloctree("LLOctree");
+
+	template<> template<>
+	void lloctree_object::test<1>()
+	{
+		// recording and replaying a cull visits what the single walk does
+		std::vector<TestPartition> partitions(1);
+		buildPartitions(partitions, 5000);
+		ensure_equals("all inserted", count_entries(partitions[0].mRoot), 5000U);
+		ensure("tree has levels", partitions[0].mNextID > 9);
+
+		const F32 far_clips[] = { 32.f, 128.f, 512.f };
+		for (U32 i = 0; i < LL_ARRAY_SIZE(far_clips); ++i)
+		{
+			LLCamera camera;
+			setupCamera(camera, far_clips[i]);
+
+			std::vector<U32> walked;
+			TestCull walker(&camera, &walked);
+			walker.traverse(partitions[0].mRoot);
+			ensure("some groups visited", !walked.empty());
+			ensure("some groups culled", walked.size() < partitions[0].mNextID * 2);
+
+			std::vector<U32> replayed;
+			test_record_t::steps_t steps;
+			TestCull recorder(&camera, NULL);
+			recorder.record(partitions[0].mRoot, steps);
+			ensure("steps recorded", !steps.empty());
+			TestCull culler(&camera, &replayed);
+			culler.replay(steps);
+			ensure("same groups in the same order", replayed == walked);
+		}
+	}
+
+	template<> template<>
+	void lloctree_object::test<2>()
+	{
+		// partitions recorded on a pool replay as a serial cull of them all
+		std::vector<TestPartition> partitions(4);
+		buildPartitions(partitions, 2000);
+		LLCamera camera;
+		setupCamera(camera, 600.f);
+
+		std::vector<U32> walked;
+		cull_serial(&camera, partitions, walked);
+		ensure("some groups visited", !walked.empty());
+
+		for (U32 threads = 0; threads < 3; ++threads)
+		{
+			LLWorkPool pool("Cull test", threads);
+			std::vector<U32> replayed;
+			cull_recorded(&camera, partitions, pool, replayed);
+			ensure("same groups in the same order", replayed == walked);
+		}
+	}
+
+	template<> template<>
+	void lloctree_object::test<3>()
+	{
+		// Cull time for a synthetic scene against the number of threads
+		const U32 runs = 10;
+		std::vector<TestPartition> partitions(8);
+		buildPartitions(partitions, 25000);
+		LLCamera camera;
+		setupCamera(camera, 1024.f);
+
+		std::vector<U32> walked;
+		LLTimer timer;
+		for (U32 i = 0; i < runs; ++i)
+		{
+			walked.clear();
+			cull_serial(&camera, partitions, walked);
+		}
+		F64 serial_time = timer.getElapsedTimeF64() / runs;
+		LL_INFOS() << partitions.size() << " partitions of 25000 entries, " << walked.size()
+				   << " group calls, single walk " << serial_time * 1000.0 << "ms" << LL_ENDL;
+
+		for (U32 threads = 0; threads <= 4; ++threads)
+		{
+			LLWorkPool pool("Cull test", threads);
+			std::vector<U32> replayed;
+			timer.reset();
+			for (U32 i = 0; i < runs; ++i)
+			{
+				replayed.clear();
+				cull_recorded(&camera, partitions, pool, replayed);
+			}
+			F64 time = timer.getElapsedTimeF64() / runs;
+			ensure("same groups in the same order", replayed == walked);
+			LL_INFOS() << threads << " worker threads, record and replay: " << time * 1000.0 << "ms" << LL_ENDL;
+		}
+	}
+
+	template<> template<>
+	void lloctree_object::test<4>()
+	{
+		// a group that fails early before one that skips its frustum check
+		// leaves it the parent's state, not what record() tested it for
+		std::vector<TestPartition> partitions(1);
+		buildPartitions(partitions, 5000);
+		const test_node_t* root = partitions[0].mRoot;
+
+		const F32 far_clips[] = { 32.f, 128.f, 512.f };
+		bool found[3] = { false, false, false };
+		for (U32 i = 0; i < LL_ARRAY_SIZE(far_clips); ++i)
+		{
+			LLCamera camera;
+			setupCamera(camera, far_clips[i]);
+			for (S32 want = 0; want <= 2; want += 2)
+			{
+				clear_marks(root);
+				TestCull finder(&camera, NULL);
+				TestGroup* skipped = mark_inherited(finder, root, want);
+				if (!skipped)
+				{
+					continue;
+				}
+				found[want] = true;
+
+				std::vector<U32> walked;
+				TestCull walker(&camera, &walked);
+				walker.traverse(root);
+				ensure("skipped group walked", std::find(walked.begin(), walked.end(), skipped->mID * 2) != walked.end());
+
+				std::vector<U32> replayed;
+				test_record_t::steps_t steps;
+				TestCull recorder(&camera, NULL);
+				recorder.record(root, steps);
+				TestCull culler(&camera, &replayed);
+				culler.replay(steps);
+				ensure("same groups in the same order", replayed == walked);
+			}
+		}
+		ensure("outside sibling found", found[0]);
+		ensure("fully inside sibling found", found[2]);
+	}
+}
@@ -0,0 +1,310 @@
+/**
+ * @file   llvolume_test.cpp
+ * @brief  Test and decode benchmark for mesh LOD unpacking in llvolume.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <sstream>
+#include <boost/bind.hpp>
+
+#include "../llvolume.h"
+#include "llsdserialize.h"
+#include "lltimer.h"
+#include "llworkpool.h"
+
+#include "../test/lltut.h"
+
+// normally owned by llrender
+BOOL gDebugGL = FALSE;
+// normally set from the viewer's OctreeMaxNodeCapacity and
+// OctreeMinimumNodeSize settings
+U32 gOctreeMaxCapacity = 128;
+F32 gOctreeMinSize = 0.01f;
+
+namespace
+{
+	void put_u16(LLSD::Binary& binary, F32 value, F32 min, F32 max)
+	{
+		U16 quantized = (U16) llclamp((value - min) / (max - min) * 65535.f + 0.5f, 0.f, 65535.f);
+		binary.push_back(quantized & 0xFF);
+		binary.push_back(quantized >> 8);
+	}
+
+	LLSD domain(F32 min, F32 max, U32 components)
+	{
+		LLSD domain;
+		for (U32 i = 0; i < components; ++i)
+		{
+			domain["Min"][i] = min;
+			domain["Max"][i] = max;
+		}
+		return domain;
+	}
+
+	// One submesh the way LLModel::writeModel() lays it out, a lumpy
+	// sphere of rings x rings vertices.
+	LLSD make_submesh(U32 rings, bool weights)
+	{
+		LLSD::Binary pos, norm, tc, idx, wght;
+		for (U32 i = 0; i < rings; ++i)
+		{
+			F32 theta = F_PI * i / (rings - 1);
+			for (U32 j = 0; j < rings; ++j)
+			{
+				F32 phi = F_TWO_PI * j / (rings - 1);
+				F32 radius = 0.4f + 0.05f * sinf(theta * 5.f) * cosf(phi * 7.f);
+				LLVector3 p(radius * sinf(theta) * cosf(phi), radius * sinf(theta) * sinf(phi), radius * cosf(theta));
+				LLVector3 n(p);
+				n.normVec();
+				for (U32 k = 0; k < 3; ++k)
+				{
+					put_u16(pos, p.mV[k], -0.5f, 0.5f);
+					put_u16(norm, n.mV[k], -1.f, 1.f);
+				}
+				put_u16(tc, (F32) j / (rings - 1), 0.f, 2.f);
+				put_u16(tc, (F32) i / (rings - 1), 0.f, 2.f);
+
+				if (weights)
+				{
+					// one to four influences per vertex
+					U32 influences = 1 + (i + j) % 4;
+					for (U32 k = 0; k < influences; ++k)
+					{
+						wght.push_back((U8) ((i + k) % 32));
+						put_u16(wght, 1.f / influences, 0.f, 1.f);
+					}
+					if (influences < 4)
+					{
+						wght.push_back(0xFF);
+					}
+				}
+			}
+		}
+
+		for (U32 i = 0; i < rings - 1; ++i)
+		{
+			for (U32 j = 0; j < rings - 1; ++j)
+			{
+				U16 v0 = i * rings + j;
+				U16 quad[] = { v0, (U16) (v0 + rings), (U16) (v0 + 1), (U16) (v0 + 1), (U16) (v0 + rings), (U16) (v0 + rings + 1) };
+				for (U32 k = 0; k < 6; ++k)
+				{
+					idx.push_back(quad[k] & 0xFF);
+					idx.push_back(quad[k] >> 8);
+				}
+			}
+		}
+
+		LLSD submesh;
+		submesh["Position"] = pos;
+		submesh["Normal"] = norm;
+		submesh["TexCoord0"] = tc;
+		submesh["TriangleList"] = idx;
+		submesh["PositionDomain"] = domain(-0.5f, 0.5f, 3);
+		submesh["TexCoord0Domain"] = domain(0.f, 2.f, 2);
+		if (weights)
+		{
+			submesh["Weights"] = wght;
+		}
+		return submesh;
+	}
+
+	LLVolume* new_mesh_volume()
+	{
+		LLVolumeParams params;
+		params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+		params.setSculptID(LLUUID::generateNewID(), LL_SCULPT_TYPE_MESH);
+		return new LLVolume(params, 3.f);
+	}
+
+	bool unpack(LLVolume* volume, const std::string& blob)
+	{
+		std::istringstream stream(blob);
+		return volume->unpackVolumeFaces(stream, blob.size());
+	}
+
+	// the old way, the whole block through LLSD first
+	bool unpack_llsd(LLVolume* volume, const std::string& blob)
+	{
+		std::istringstream stream(blob);
+		LLSD mdl;
+		return unzip_llsd(mdl, stream, blob.size()) && volume->unpackVolumeFaces(mdl);
+	}
+
+	bool same_faces(const LLVolume* a, const LLVolume* b)
+	{
+		if (a->getNumVolumeFaces() != b->getNumVolumeFaces())
+		{
+			return false;
+		}
+		for (S32 i = 0; i < a->getNumVolumeFaces(); ++i)
+		{
+			const LLVolumeFace& fa = a->getVolumeFace(i);
+			const LLVolumeFace& fb = b->getVolumeFace(i);
+			if (fa.mNumVertices != fb.mNumVertices || fa.mNumIndices != fb.mNumIndices
+				|| memcmp(fa.mPositions, fb.mPositions, fa.mNumVertices * sizeof(LLVector4a))
+				|| memcmp(fa.mNormals, fb.mNormals, fa.mNumVertices * sizeof(LLVector4a))
+				|| memcmp(fa.mTexCoords, fb.mTexCoords, fa.mNumVertices * sizeof(LLVector2))
+				|| memcmp(fa.mIndices, fb.mIndices, fa.mNumIndices * sizeof(U16))
+				|| (fa.mWeights == NULL) != (fb.mWeights == NULL)
+				|| (fa.mWeights && memcmp(fa.mWeights, fb.mWeights, fa.mNumVertices * sizeof(LLVector4a))))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+namespace tut
+{
+	struct llvolume_data
+	{
+		void decodeBlob(U32 index)
+		{
+			LLPointer<LLVolume> volume = new_mesh_volume();
+			mDecoded[index] = unpack(volume, mBlobs[index]);
+		}
+
+		std::vector<std::string> mBlobs;
+		// not vector<bool>, the workers write neighbouring entries
+		std::vector<U8> mDecoded;
+	};
+	typedef test_group<llvolume_data> llvolume_test;
+	typedef llvolume_test::object llvolume_object;
+	tut::llvolume_test tllvolume("LLVolume");
+
+	template<> template<>
+	void llvolume_object::test<1>()
+	{
+		// reading the block in place gives what going through LLSD does
+		LLSD mdl;
+		mdl[0] = make_submesh(30, false);
+		mdl[1] = make_submesh(17, true);
+		mdl[2]["NoGeometry"] = true;
+		mdl[3] = make_submesh(9, false);
+		// keys a decoder does not know about are skipped
+		mdl[3]["Comment"] = "made by hand";
+		mdl[3]["Extra"][0] = LLUUID::generateNewID();
+		mdl[3]["Extra"][1]["Date"] = LLDate(1.0);
+		mdl[3]["Extra"][2]["Creator"]["Name"] = "somebody";
+		mdl[3]["Extra"][2]["Creator"]["Tool"] = "exporter";
+		mdl[3]["Extra"][2]["Revision"] = 4;
+		std::string blob = zip_llsd(mdl);
+
+		LLPointer<LLVolume> direct = new_mesh_volume();
+		LLPointer<LLVolume> parsed = new_mesh_volume();
+		S32 from_llsd = LLVolume::getNumMeshLODsFromLLSD();
+		ensure("unpacked in place", unpack(direct, blob));
+		ensure_equals("nested maps skipped in place", LLVolume::getNumMeshLODsFromLLSD(), from_llsd);
+		ensure("unpacked from LLSD", unpack_llsd(parsed, blob));
+		ensure_equals("faces", direct->getNumVolumeFaces(), 4);
+		ensure("same faces", same_faces(direct, parsed));
+
+		// within a quantization step of where the vertices were
+		const LLVolumeFace& face = direct->getVolumeFace(0);
+		ensure_equals("vertices", face.mNumVertices, 30 * 30);
+		ensure_equals("indices", face.mNumIndices, 29 * 29 * 6);
+		for (S32 i = 0; i < face.mNumVertices; ++i)
+		{
+			F32 radius = face.mPositions[i].getLength3().getF32();
+			ensure("on the sphere", radius > 0.34f && radius < 0.46f);
+			ensure("unit normal", fabsf(face.mNormals[i].getLength3().getF32() - 1.f) < 0.001f);
+			ensure("texture coordinates", face.mTexCoords[i].mV[0] >= 0.f && face.mTexCoords[i].mV[0] <= 1.0001f);
+		}
+		ensure("weights", direct->getVolumeFace(1).mWeights != NULL);
+		ensure_equals("no geometry", direct->getVolumeFace(2).mNumVertices, 1);
+
+		// a block laid out some other way still decodes, through LLSD
+		LLSD odd;
+		odd[0] = make_submesh(5, false);
+		odd[0]["PositionDomain"]["Min"][0] = "-0.5";
+		std::string odd_blob = zip_llsd(odd);
+		direct = new_mesh_volume();
+		parsed = new_mesh_volume();
+		ensure("unpacked odd block", unpack(direct, odd_blob));
+		ensure_equals("odd block through LLSD", LLVolume::getNumMeshLODsFromLLSD(), from_llsd + 1);
+		ensure("unpacked odd block from LLSD", unpack_llsd(parsed, odd_blob));
+		ensure("same odd faces", same_faces(direct, parsed));
+
+		// and garbage does not
+		direct = new_mesh_volume();
+		ensure("garbage", !unpack(direct, std::string("not a mesh")));
+		ensure("truncated", !unpack(direct, blob.substr(0, blob.size() / 2)));
+	}
+
+	template<> template<>
+	void llvolume_object::test<2>()
+	{
+		// Time to decode a corpus of LOD blocks in place, through LLSD, and
+		// spread over a pool by worker count
+		U32 bytes = 0;
+		for (U32 i = 0; i < 200; ++i)
+		{
+			LLSD mdl;
+			for (U32 j = 0; j <= i % 4; ++j)
+			{
+				mdl[j] = make_submesh(8 + (i * 7 + j * 13) % 56, i % 3 == 0);
+			}
+			mBlobs.push_back(zip_llsd(mdl));
+			bytes += mBlobs.back().size();
+		}
+		mDecoded.resize(mBlobs.size());
+		LL_INFOS() << mBlobs.size() << " LOD blocks, " << bytes / 1024 << "KB" << LL_ENDL;
+
+		LLTimer timer;
+		for (U32 i = 0; i < mBlobs.size(); ++i)
+		{
+			LLPointer<LLVolume> volume = new_mesh_volume();
+			ensure("through LLSD", unpack_llsd(volume, mBlobs[i]));
+		}
+		LL_INFOS() << "through LLSD: " << timer.getElapsedTimeF64() * 1000.0 << "ms" << LL_ENDL;
+
+		for (U32 threads = 0; threads <= 4; ++threads)
+		{
+			LLWorkPool* pool = threads ? new LLWorkPool("Test mesh decode", threads) : NULL;
+			timer.reset();
+			if (pool)
+			{
+				pool->run(mBlobs.size(), boost::bind(&llvolume_data::decodeBlob, this, _1));
+			}
+			else
+			{
+				for (U32 i = 0; i < mBlobs.size(); ++i)
+				{
+					decodeBlob(i);
+				}
+			}
+			F64 decode_time = timer.getElapsedTimeF64();
+			delete pool;
+
+			for (U32 i = 0; i < mDecoded.size(); ++i)
+			{
+				ensure("in place", mDecoded[i]);
+			}
+			LL_INFOS() << "in place, " << threads << " workers: " << decode_time * 1000.0 << "ms" << LL_ENDL;
+		}
+	}
+}
@@ -0,0 +1,238 @@
+/**
+ * @file   llvolumebvh_test.cpp
+ * @brief  Test and ray throughput benchmark for llvolumebvh.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llvolume.h"
+#include "../llvolumebvh.h"
+#include "../llvolumeoctree.h"
+#include "llrand.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+// normally owned by llrender
+BOOL gDebugGL = FALSE;
+// normally set from the viewer's OctreeMaxNodeCapacity and
+// OctreeMinimumNodeSize settings
+U32 gOctreeMaxCapacity = 128;
+F32 gOctreeMinSize = 0.01f;
+
+namespace
+{
+	struct Ray
+	{
+		LLVector4a mStart;
+		LLVector4a mDir;
+	};
+
+	LLVector4a random_point(F32 radius)
+	{
+		return LLVector4a(ll_frand(radius * 2.f) - radius,
+						  ll_frand(radius * 2.f) - radius,
+						  ll_frand(radius * 2.f) - radius);
+	}
+
+	// Segments from all around the face through or towards its middle,
+	// some starting inside it, some too short to reach it.
+	void make_rays(std::vector<Ray>& rays, U32 count)
+	{
+		rays.resize(count);
+		for (U32 i = 0; i < count; ++i)
+		{
+			rays[i].mStart = random_point(i % 4 ? 1.f : 0.3f);
+			LLVector4a end = random_point(0.5f);
+			rays[i].mDir.setSub(end, rays[i].mStart);
+			if (i % 8 == 0)
+			{
+				rays[i].mDir.mul(0.2f);
+			}
+		}
+	}
+
+	// returns the t of the closest hit, or 2 for none
+	F32 octree_pick(const LLVolumeFace& face, const Ray& ray, LLVector2& tex_coord)
+	{
+		F32 closest_t = 2.f;
+		LLOctreeTriangleRayIntersect intersect(ray.mStart, ray.mDir, &face, &closest_t, NULL, &tex_coord, NULL, NULL);
+		intersect.traverse(face.mOctree);
+		return closest_t;
+	}
+
+	F32 bvh_pick(const LLVolumeFace& face, const Ray& ray, LLVector2& tex_coord)
+	{
+		F32 closest_t = 2.f;
+		F32 a, b;
+		S32 offset = face.mBVH->intersect(ray.mStart, ray.mDir, closest_t, a, b);
+		if (offset >= 0)
+		{
+			const LLVector2* tc = face.mTexCoords;
+			tex_coord = (1.f - a - b) * tc[face.mIndices[offset]] +
+						a * tc[face.mIndices[offset + 1]] +
+						b * tc[face.mIndices[offset + 2]];
+		}
+		return closest_t;
+	}
+}
+
+namespace tut
+{
+	struct llvolumebvh_data
+	{
+		// A lumpy sphere made of rings x rings quads, in the volume's unit
+		// space like a mesh LOD.
+		void makeFace(LLVolumeFace& face, U32 rings)
+		{
+			face.resizeVertices(rings * rings);
+			face.resizeIndices((rings - 1) * (rings - 1) * 6);
+
+			for (U32 i = 0; i < rings; ++i)
+			{
+				F32 theta = F_PI * i / (rings - 1);
+				for (U32 j = 0; j < rings; ++j)
+				{
+					F32 phi = F_TWO_PI * j / (rings - 1);
+					F32 radius = 0.4f + 0.05f * sinf(theta * 5.f) * cosf(phi * 7.f);
+					U32 vert = i * rings + j;
+					face.mPositions[vert].set(radius * sinf(theta) * cosf(phi),
+											  radius * sinf(theta) * sinf(phi),
+											  radius * cosf(theta));
+					face.mNormals[vert] = face.mPositions[vert];
+					face.mNormals[vert].normalize3fast();
+					face.mTexCoords[vert].set((F32) j / (rings - 1), (F32) i / (rings - 1));
+				}
+			}
+
+			U32 index = 0;
+			for (U32 i = 0; i < rings - 1; ++i)
+			{
+				for (U32 j = 0; j < rings - 1; ++j)
+				{
+					U16 v0 = i * rings + j;
+					U16 v1 = v0 + 1;
+					U16 v2 = v0 + rings;
+					U16 v3 = v2 + 1;
+					face.mIndices[index++] = v0;
+					face.mIndices[index++] = v2;
+					face.mIndices[index++] = v1;
+					face.mIndices[index++] = v1;
+					face.mIndices[index++] = v2;
+					face.mIndices[index++] = v3;
+				}
+			}
+
+			face.mExtents[0].splat(-0.45f);
+			face.mExtents[1].splat(0.45f);
+		}
+	};
+	typedef test_group<llvolumebvh_data> llvolumebvh_test;
+	typedef llvolumebvh_test::object llvolumebvh_object;
+	tut::llvolumebvh_test tllvolumebvh("LLVolumeBVH");
+
+	template<> template<>
+	void llvolumebvh_object::test<1>()
+	{
+		// picks match the octree's, hit for hit
+		LLVolumeFace face;
+		makeFace(face, 60);
+		face.createOctree();
+		face.createBVH();
+		ensure_equals("triangles", face.mBVH->getTriangleCount(), U32(face.mNumIndices / 3));
+
+		std::vector<Ray> rays;
+		make_rays(rays, 5000);
+		U32 hits = 0;
+		for (U32 i = 0; i < rays.size(); ++i)
+		{
+			LLVector2 octree_tc, bvh_tc;
+			F32 octree_t = octree_pick(face, rays[i], octree_tc);
+			F32 bvh_t = bvh_pick(face, rays[i], bvh_tc);
+			ensure_equals("same hit", bvh_t <= 1.f, octree_t <= 1.f);
+			if (octree_t <= 1.f)
+			{
+				++hits;
+				ensure_approximately_equals("same t", bvh_t, octree_t, 16);
+				ensure_approximately_equals("same s", bvh_tc.mV[0], octree_tc.mV[0], 12);
+				ensure_approximately_equals("same t coord", bvh_tc.mV[1], octree_tc.mV[1], 12);
+			}
+		}
+		ensure("some hit", hits > 0);
+		ensure("some missed", hits < rays.size());
+
+		// a copy shares the tree, rebuilding the face drops it
+		LLVolumeFace copy(face);
+		ensure("copy shares tree", copy.mBVH == face.mBVH);
+		copy.resizeIndices(0);
+		copy.mBVH = NULL;
+		copy.createBVH();
+		ensure_equals("empty face", copy.mBVH->getNodeCount(), 0U);
+		F32 closest_t = 2.f, a, b;
+		ensure_equals("empty face misses", copy.mBVH->intersect(rays[0].mStart, rays[0].mDir, closest_t, a, b), -1);
+	}
+
+	template<> template<>
+	void llvolumebvh_object::test<2>()
+	{
+		// Build time and picks per second for a large face, against the octree
+		LLVolumeFace face;
+		makeFace(face, 250);
+		const U32 triangles = face.mNumIndices / 3;
+
+		LLTimer timer;
+		face.createOctree();
+		F64 octree_build = timer.getElapsedTimeF64();
+		timer.reset();
+		face.createBVH();
+		F64 bvh_build = timer.getElapsedTimeF64();
+
+		std::vector<Ray> rays;
+		make_rays(rays, 20000);
+		LLVector2 tc;
+
+		timer.reset();
+		U32 octree_hits = 0;
+		for (U32 i = 0; i < rays.size(); ++i)
+		{
+			octree_hits += octree_pick(face, rays[i], tc) <= 1.f;
+		}
+		F64 octree_time = timer.getElapsedTimeF64();
+
+		timer.reset();
+		U32 bvh_hits = 0;
+		for (U32 i = 0; i < rays.size(); ++i)
+		{
+			bvh_hits += bvh_pick(face, rays[i], tc) <= 1.f;
+		}
+		F64 bvh_time = timer.getElapsedTimeF64();
+
+		ensure_equals("same hits", bvh_hits, octree_hits);
+		LL_INFOS() << triangles << " triangles, " << face.mBVH->getNodeCount() << " BVH nodes" << LL_ENDL;
+		LL_INFOS() << "octree: build " << octree_build * 1000.0 << "ms, "
+				   << rays.size() / llmax(octree_time, 0.000001) << " rays/s" << LL_ENDL;
+		LL_INFOS() << "BVH: build " << bvh_build * 1000.0 << "ms, "
+				   << rays.size() / llmax(bvh_time, 0.000001) << " rays/s" << LL_ENDL;
+	}
+}
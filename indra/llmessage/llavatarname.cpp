@@ -124,6 +124,61 @@ void LLAvatarName::fromLLSD(const LLSD& sd)
 	}
 }
 
+static void append_binary_string(std::string& out, const std::string& str)
+{
+	U16 length = (U16) llmin(str.size(), (size_t) U16_MAX);
+	out.append((const char*) &length, sizeof(length));
+	out.append(str, 0, length);
+}
+
+static bool read_binary_string(const char*& data, const char* end, std::string& str)
+{
+	U16 length;
+	if (end - data < (S32) sizeof(length))
+	{
+		return false;
+	}
+	memcpy(&length, data, sizeof(length));
+	data += sizeof(length);
+	if (end - data < length)
+	{
+		return false;
+	}
+	str.assign(data, length);
+	data += length;
+	return true;
+}
+
+// mExpires comes first so the cache can check it without decoding the rest
+void LLAvatarName::appendBinary(std::string& out) const
+{
+	out.append((const char*) &mExpires, sizeof(mExpires));
+	out.append((const char*) &mNextUpdate, sizeof(mNextUpdate));
+	out.push_back(mIsDisplayNameDefault ? 1 : 0);
+	append_binary_string(out, mUsername);
+	append_binary_string(out, mDisplayName);
+	append_binary_string(out, mLegacyFirstName);
+	append_binary_string(out, mLegacyLastName);
+}
+
+bool LLAvatarName::fromBinary(const char*& data, const char* end)
+{
+	if (end - data < (S32) (sizeof(mExpires) + sizeof(mNextUpdate) + 1))
+	{
+		return false;
+	}
+	memcpy(&mExpires, data, sizeof(mExpires));
+	data += sizeof(mExpires);
+	memcpy(&mNextUpdate, data, sizeof(mNextUpdate));
+	data += sizeof(mNextUpdate);
+	mIsDisplayNameDefault = (*data++ != 0);
+	mIsTemporaryName = false;
+	return read_binary_string(data, end, mUsername)
+		&& read_binary_string(data, end, mDisplayName)
+		&& read_binary_string(data, end, mLegacyFirstName)
+		&& read_binary_string(data, end, mLegacyLastName);
+}
+
 // Transform a string (typically provided by the legacy service) into a decent
 // avatar name instance.
 void LLAvatarName::fromString(const std::string& full_name)
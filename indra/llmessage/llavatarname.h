@@ -43,6 +43,12 @@ public:
 	LLSD asLLSD() const;
 	void fromLLSD(const LLSD& sd);
 
+	// Compact binary form for the name cache file, in host byte order.
+	// fromBinary() advances data past the record, returning false if the
+	// record runs past end.
+	void appendBinary(std::string& out) const;
+	bool fromBinary(const char*& data, const char* end);
+
 	// Used only in legacy mode when the display name capability is not provided server side
 	// or to otherwise create a temporary valid item.
 	void fromString(const std::string& full_name);
@@ -32,6 +32,7 @@
 #include "llframetimer.h"
 #include "llsd.h"
 #include "llsdserialize.h"
+#include "lluuidhashmap.h"
 #include "httpresponse.h"
 #include "llhttpsdhandler.h"
 #include <boost/tokenizer.hpp>
@@ -82,9 +83,28 @@ namespace LLAvatarNameCache
 	signal_map_t sSignalMap;
 
 	// The cache at last, i.e. avatar names we know about.
-	typedef std::map<LLUUID, LLAvatarName> cache_t;
+	typedef LLUUIDHashMap<LLAvatarName> cache_t;
 	cache_t sCache;
 
+	// Names read from the cache file but not decoded yet, as offsets of
+	// their records in sImportData.  A session only looks up a fraction
+	// of them, so each is decoded on first lookup.
+	typedef LLUUIDHashMap<U32> import_index_t;
+	import_index_t sImportIndex;
+	std::string sImportData;
+
+	// Cache file layout: magic, version and name count, then for each name
+	// the agent id, the record length and the record written by
+	// LLAvatarName::appendBinary().
+	const char CACHE_FILE_MAGIC[4] = { 'S', 'L', 'A', 'N' };
+	const U32 CACHE_FILE_VERSION = 1;
+
+	// Most agent ids per request to the name lookup capability, and most
+	// requests waiting on a reply at once.
+	U32 sMaxBatchSize = 100;
+	U32 sMaxRequestsInFlight = 8;
+	U32 sRequestsInFlight = 0;
+
 	// Send bulk lookup requests a few times a second at most.
 	// Only need per-frame timing resolution.
 	LLFrameTimer sRequestTimer;
@@ -135,6 +155,14 @@ namespace LLAvatarNameCache
 	// Erase expired names from cache
 	void eraseUnrefreshed();
 
+	// Cached name for agent_id, decoding it from the imported cache file
+	// if need be, or NULL.  Invalidated by the next insertion.
+	LLAvatarName* findName(const LLUUID& agent_id);
+
+	bool importBinary(std::istream& istr);
+	bool importXML(std::istream& istr);
+	void clearImport();
+
     bool expirationFromCacheControl(const LLSD& headers, F64 *expires);
 
     // This is a coroutine.
@@ -190,6 +218,12 @@ void LLAvatarNameCache::requestAvatarNameCache_(std::string url, std::vector<LLU
     LL_DEBUGS("AvNameCache") << "Entering coroutine " << LLCoros::instance().getName()
         << " with url '" << url << "', requesting " << agentIds.size() << " Agent Ids" << LL_ENDL;
 
+    // however this coroutine ends, its request no longer counts
+    struct InFlight
+    {
+        ~InFlight() { --sRequestsInFlight; }
+    } in_flight;
+
     try
     {
         bool success = true;
@@ -297,8 +331,8 @@ void LLAvatarNameCache::handleAvNameCacheSuccess(const LLSD &data, const LLSD &h
 // Provide some fallback for agents that return errors
 void LLAvatarNameCache::handleAgentError(const LLUUID& agent_id)
 {
-	std::map<LLUUID,LLAvatarName>::iterator existing = sCache.find(agent_id);
-	if (existing == sCache.end())
+	LLAvatarName* existing = findName(agent_id);
+	if (!existing)
     {
         // there is no existing cache entry, so make a temporary name from legacy
         LL_WARNS("AvNameCache") << "LLAvatarNameCache get legacy for agent "
@@ -314,7 +348,7 @@ void LLAvatarNameCache::handleAgentError(const LLUUID& agent_id)
         // Clear this agent from the pending list
         LLAvatarNameCache::sPendingQueue.erase(agent_id);
 
-        LLAvatarName& av_name = existing->second;
+        LLAvatarName& av_name = *existing;
         LL_DEBUGS("AvNameCache") << "LLAvatarNameCache use cache for agent " << agent_id << LL_ENDL;
 		av_name.dump();
 
@@ -327,6 +361,7 @@ void LLAvatarNameCache::processName(const LLUUID& agent_id, const LLAvatarName&
 {
 	// Add to the cache
 	sCache[agent_id] = av_name;
+	sImportIndex.erase(agent_id);
 
 	// Suppress request from the queue
 	sPendingQueue.erase(agent_id);
@@ -364,7 +399,7 @@ void LLAvatarNameCache::requestNamesViaCapability()
 	
 	U32 ids = 0;
 	ask_queue_t::const_iterator it;
-	while(!sAskQueue.empty())
+	while(!sAskQueue.empty() && sRequestsInFlight < sMaxRequestsInFlight)
 	{
 		it = sAskQueue.begin();
 		LLUUID agent_id = *it;
@@ -389,21 +424,20 @@ void LLAvatarNameCache::requestNamesViaCapability()
 		// mark request as pending
 		sPendingQueue[agent_id] = now;
 
-		if (url.size() > NAME_URL_SEND_THRESHOLD)
+		if (url.size() > NAME_URL_SEND_THRESHOLD || ids >= sMaxBatchSize || sAskQueue.empty())
 		{
-			break;
-		}
-	}
-
-    if (!url.empty())
-    {
-        LL_DEBUGS("AvNameCache") << "requested " << ids << " ids" << LL_ENDL;
+			// send this batch, then start another if allowed
+			LL_DEBUGS("AvNameCache") << "requested " << ids << " ids" << LL_ENDL;
 
-        std::string coroname = 
-            LLCoros::instance().launch("LLAvatarNameCache::requestAvatarNameCache_",
-            boost::bind(&LLAvatarNameCache::requestAvatarNameCache_, url, agent_ids));
-        LL_DEBUGS("AvNameCache") << coroname << " with  url '" << url << "', agent_ids.size()=" << agent_ids.size() << LL_ENDL;
+			++sRequestsInFlight;
+			std::string coroname = 
+				LLCoros::instance().launch("LLAvatarNameCache::requestAvatarNameCache_",
+				boost::bind(&LLAvatarNameCache::requestAvatarNameCache_, url, agent_ids));
+			LL_DEBUGS("AvNameCache") << coroname << " with  url '" << url << "', agent_ids.size()=" << agent_ids.size() << LL_ENDL;
 
+			url.clear();
+			agent_ids.clear();
+		}
 	}
 }
 
@@ -417,9 +451,11 @@ void LLAvatarNameCache::legacyNameCallback(const LLUUID& agent_id,
 	// Retrieve the name and set it to never (or almost never...) expire: when we are using the legacy
 	// protocol, we do not get an expiration date for each name and there's no reason to ask the 
 	// data again and again so we set the expiration time to the largest value admissible.
-	std::map<LLUUID,LLAvatarName>::iterator av_record = sCache.find(agent_id);
-	LLAvatarName& av_name = av_record->second;
-	av_name.setExpires(MAX_UNREFRESHED_TIME);
+	LLAvatarName* av_name = findName(agent_id);
+	if (av_name)
+	{
+		av_name->setExpires(MAX_UNREFRESHED_TIME);
+	}
 }
 
 void LLAvatarNameCache::legacyNameFetch(const LLUUID& agent_id,
@@ -480,9 +516,138 @@ void LLAvatarNameCache::cleanupClass()
     sHttpHeaders.reset();
     sHttpOptions.reset();
     sCache.clear();
+    sAskQueue.clear();
+    sPendingQueue.clear();
+    clearImport();
+}
+
+void LLAvatarNameCache::setRequestLimits(U32 max_batch_size, U32 max_in_flight)
+{
+	sMaxBatchSize = llmax(max_batch_size, (U32) 1);
+	sMaxRequestsInFlight = llmax(max_in_flight, (U32) 1);
 }
 
 bool LLAvatarNameCache::importFile(std::istream& istr)
+{
+	char magic[sizeof(CACHE_FILE_MAGIC)];
+	if (istr.read(magic, sizeof(magic)) && !memcmp(magic, CACHE_FILE_MAGIC, sizeof(magic)))
+	{
+		return importBinary(istr);
+	}
+
+	// cache files from before the binary format
+	istr.clear();
+	istr.seekg(0);
+	return importXML(istr);
+}
+
+bool LLAvatarNameCache::importBinary(std::istream& istr)
+{
+	// Only index the records here, findName() decodes them on demand
+	clearImport();
+	std::ostringstream buffer;
+	buffer << istr.rdbuf();
+	sImportData = buffer.str();
+
+	const char* begin = sImportData.data();
+	const char* end = begin + sImportData.size();
+	const char* data = begin;
+	U32 version = 0;
+	U32 count = 0;
+	if (end - data < (S32) (sizeof(version) + sizeof(count)))
+	{
+		clearImport();
+		return false;
+	}
+	memcpy(&version, data, sizeof(version));
+	data += sizeof(version);
+	memcpy(&count, data, sizeof(count));
+	data += sizeof(count);
+	if (version != CACHE_FILE_VERSION)
+	{
+		LL_WARNS("AvNameCache") << "avatar name cache version " << version << " not supported" << LL_ENDL;
+		clearImport();
+		return false;
+	}
+
+	sImportIndex.reserve(count);
+	LLUUID agent_id;
+	U32 length;
+	for (U32 i = 0; i < count; ++i)
+	{
+		if (end - data < (S32) (UUID_BYTES + sizeof(length)))
+		{
+			break;
+		}
+		memcpy(agent_id.mData, data, UUID_BYTES);
+		data += UUID_BYTES;
+		memcpy(&length, data, sizeof(length));
+		data += sizeof(length);
+		if ((U32) (end - data) < length)
+		{
+			break;
+		}
+		if (sCache.find(agent_id) == sCache.end())
+		{
+			sImportIndex[agent_id] = (U32) (data - begin);
+		}
+		data += length;
+	}
+	if (data != end)
+	{
+		LL_WARNS("AvNameCache") << "avatar name cache data truncated" << LL_ENDL;
+		clearImport();
+		return false;
+	}
+
+	LL_INFOS("AvNameCache") << "LLAvatarNameCache indexed " << sImportIndex.size() << LL_ENDL;
+	// Expired entries are dropped when first looked up, or when the cache
+	// is saved again
+	return true;
+}
+
+void LLAvatarNameCache::clearImport()
+{
+	sImportIndex.clear();
+	std::string().swap(sImportData);
+}
+
+LLAvatarName* LLAvatarNameCache::findName(const LLUUID& agent_id)
+{
+	cache_t::iterator it = sCache.find(agent_id);
+	if (it != sCache.end())
+	{
+		return &it->second;
+	}
+	if (sImportIndex.empty())
+	{
+		return NULL;
+	}
+	import_index_t::iterator record = sImportIndex.find(agent_id);
+	if (record == sImportIndex.end())
+	{
+		return NULL;
+	}
+
+	const char* data = sImportData.data() + record->second;
+	LLAvatarName av_name;
+	bool valid = av_name.fromBinary(data, sImportData.data() + sImportData.size())
+		&& av_name.mExpires >= LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME;
+	sImportIndex.erase(record);
+	if (sImportIndex.empty())
+	{
+		clearImport();
+	}
+	if (!valid)
+	{
+		return NULL;
+	}
+	LLAvatarName& cached = sCache[agent_id];
+	cached = av_name;
+	return &cached;
+}
+
+bool LLAvatarNameCache::importXML(std::istream& istr)
 {
 	LLSD data;
 	if (LLSDParser::PARSE_FAILURE == LLSDSerialize::fromXMLDocument(data, istr))
@@ -514,25 +679,46 @@ bool LLAvatarNameCache::importFile(std::istream& istr)
 
 void LLAvatarNameCache::exportFile(std::ostream& ostr)
 {
-	LLSD agents;
 	F64 max_unrefreshed = LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME;
-    LL_INFOS("AvNameCache") << "LLAvatarNameCache at exit cache has " << sCache.size() << LL_ENDL;
-	cache_t::const_iterator it = sCache.begin();
-	for ( ; it != sCache.end(); ++it)
+    LL_INFOS("AvNameCache") << "LLAvatarNameCache at exit cache has " << sCache.size() + sImportIndex.size() << LL_ENDL;
+	std::string records;
+	U32 count = 0;
+	U32 length;
+	for (cache_t::const_iterator it = sCache.begin(); it != sCache.end(); ++it)
 	{
-		const LLUUID& agent_id = it->first;
 		const LLAvatarName& av_name = it->second;
 		// Do not write temporary or expired entries to the stored cache
 		if (av_name.isValidName(max_unrefreshed))
 		{
-			// key must be a string
-			agents[agent_id.asString()] = av_name.asLLSD();
+			records.append((const char*) it->first.mData, UUID_BYTES);
+			size_t length_pos = records.size();
+			records.append(sizeof(length), '\0');
+			av_name.appendBinary(records);
+			length = (U32) (records.size() - length_pos - sizeof(length));
+			memcpy(&records[length_pos], &length, sizeof(length));
+			++count;
 		}
 	}
-    LL_INFOS("AvNameCache") << "LLAvatarNameCache returning " << agents.size() << LL_ENDL;
-	LLSD data;
-	data["agents"] = agents;
-	LLSDSerialize::toPrettyXML(data, ostr);
+	// names never looked up are copied over as they were read
+	for (import_index_t::const_iterator it = sImportIndex.begin(); it != sImportIndex.end(); ++it)
+	{
+		const char* record = sImportData.data() + it->second;
+		F64 expires;
+		memcpy(&length, record - sizeof(length), sizeof(length));
+		memcpy(&expires, record, sizeof(expires));
+		if (length >= sizeof(expires) && expires >= max_unrefreshed)
+		{
+			records.append((const char*) it->first.mData, UUID_BYTES);
+			records.append(record - sizeof(length), sizeof(length) + length);
+			++count;
+		}
+	}
+    LL_INFOS("AvNameCache") << "LLAvatarNameCache returning " << count << LL_ENDL;
+
+	ostr.write(CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+	ostr.write((const char*) &CACHE_FILE_VERSION, sizeof(CACHE_FILE_VERSION));
+	ostr.write((const char*) &count, sizeof(count));
+	ostr.write(records.data(), records.size());
 }
 
 void LLAvatarNameCache::setNameLookupURL(const std::string& name_lookup_url)
@@ -610,8 +796,9 @@ void LLAvatarNameCache::eraseUnrefreshed()
     if (!sLastExpireCheck || sLastExpireCheck < max_unrefreshed)
     {
         sLastExpireCheck = now;
-        S32 expired = 0;
-        for (cache_t::iterator it = sCache.begin(); it != sCache.end();)
+        // erasing moves entries around the hash map, so collect first
+        std::vector<LLUUID> expired_ids;
+        for (cache_t::const_iterator it = sCache.begin(); it != sCache.end(); ++it)
         {
             const LLAvatarName& av_name = it->second;
             if (av_name.mExpires < max_unrefreshed)
@@ -620,13 +807,13 @@ void LLAvatarNameCache::eraseUnrefreshed()
                                          << " user '" << av_name.getAccountName() << "' "
                                          << "expired " << now - av_name.mExpires << " secs ago"
                                          << LL_ENDL;
-                sCache.erase(it++);
-                expired++;
+                expired_ids.push_back(it->first);
             }
-			else
-			{
-				++it;
-			}
+        }
+        S32 expired = expired_ids.size();
+        for (std::vector<LLUUID>::const_iterator it = expired_ids.begin(); it != expired_ids.end(); ++it)
+        {
+            sCache.erase(*it);
         }
         LL_INFOS("AvNameCache") << "LLAvatarNameCache expired " << expired << " cached avatar names, "
                                 << sCache.size() << " remaining" << LL_ENDL;
@@ -640,10 +827,10 @@ bool LLAvatarNameCache::get(const LLUUID& agent_id, LLAvatarName *av_name)
 	if (sRunning)
 	{
 		// ...only do immediate lookups when cache is running
-		std::map<LLUUID,LLAvatarName>::iterator it = sCache.find(agent_id);
-		if (it != sCache.end())
+		const LLAvatarName* cached = findName(agent_id);
+		if (cached)
 		{
-			*av_name = it->second;
+			*av_name = *cached;
 
 			// re-request name if entry is expired
 			if (av_name->mExpires < LLFrameTimer::getTotalSeconds())
@@ -685,10 +872,11 @@ LLAvatarNameCache::callback_connection_t LLAvatarNameCache::get(const LLUUID& ag
 	if (sRunning)
 	{
 		// ...only do immediate lookups when cache is running
-		std::map<LLUUID,LLAvatarName>::iterator it = sCache.find(agent_id);
-		if (it != sCache.end())
+		const LLAvatarName* cached = findName(agent_id);
+		if (cached)
 		{
-			const LLAvatarName& av_name = it->second;
+			// a copy, as the callback may add to the cache
+			const LLAvatarName av_name(*cached);
 			
 			if (av_name.mExpires > LLFrameTimer::getTotalSeconds())
 			{
@@ -746,12 +934,14 @@ void LLAvatarNameCache::setUseUsernames(bool use)
 void LLAvatarNameCache::erase(const LLUUID& agent_id)
 {
 	sCache.erase(agent_id);
+	sImportIndex.erase(agent_id);
 }
 
 void LLAvatarNameCache::insert(const LLUUID& agent_id, const LLAvatarName& av_name)
 {
 	// *TODO: update timestamp if zero?
 	sCache[agent_id] = av_name;
+	sImportIndex.erase(agent_id);
 }
 
 #if 0
@@ -44,10 +44,17 @@ namespace LLAvatarNameCache
 	void initClass(bool running, bool usePeopleAPI);
 	void cleanupClass();
 
-	// Import/export the name cache to file.
+	// Import/export the name cache to file.  Files are written in a
+	// compact binary form whose records are only decoded when a name is
+	// first asked for; the older LLSD XML files can still be imported.
+	// Streams should be opened in binary mode.
 	bool importFile(std::istream& istr);
 	void exportFile(std::ostream& ostr);
 
+	// Most agent ids to ask the name lookup capability for in one request,
+	// and most such requests waiting on a reply at once.
+	void setRequestLimits(U32 max_batch_size, U32 max_in_flight);
+
 	// On the viewer, usually a simulator capabilities.
 	// If empty, name cache will fall back to using legacy name lookup system.
 	void setNameLookupURL(const std::string& name_lookup_url);
@@ -55,13 +55,18 @@ LLPacketRing::LLPacketRing () :
 	mInBufferLength(0),
 	mOutBufferLength(0),
 	mDropPercentage(0.0f),
-	mPacketsToDrop(0x0)
+	mPacketsToDrop(0x0),
+	mRecordFile(NULL),
+	mPlaybackFile(NULL),
+	mPlaybackNextValid(false)
 {
 }
 
 ///////////////////////////////////////////////////////////
 LLPacketRing::~LLPacketRing ()
 {
+	stopRecording();
+	stopPlayback();
 	cleanup();
 }
 	
@@ -158,6 +163,12 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 {
 	S32 packet_size = 0;
 
+	if (mPlaybackFile)
+	{
+		// Recorded traffic stands in for the network entirely.
+		return receiveFromPlayback(datap);
+	}
+
 	// If using the throttle, simulate a limited size input buffer.
 	if (mUseInThrottle)
 	{
@@ -267,12 +278,153 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 		}
 	}
 
+	if (packet_size && mRecordFile)
+	{
+		recordPacket(datap, packet_size);
+	}
+
+	return packet_size;
+}
+
+///////////////////////////////////////////////////////////
+static const char PACKET_RECORD_MAGIC[] = "LLPKTREC";
+static const U32 PACKET_RECORD_VERSION = 1;
+
+bool LLPacketRing::startRecording(const std::string& filename)
+{
+	stopRecording();
+
+	mRecordFile = LLFile::fopen(filename, "wb");
+	if (!mRecordFile)
+	{
+		LL_WARNS("Messaging") << "Unable to open packet recording " << filename << LL_ENDL;
+		return false;
+	}
+
+	fwrite(PACKET_RECORD_MAGIC, 1, 8, mRecordFile);
+	fwrite(&PACKET_RECORD_VERSION, sizeof(U32), 1, mRecordFile);
+	mRecordTimer.reset();
+
+	LL_INFOS("Messaging") << "Recording incoming packets to " << filename << LL_ENDL;
+	return true;
+}
+
+void LLPacketRing::stopRecording()
+{
+	if (mRecordFile)
+	{
+		LLFile::close(mRecordFile);
+		mRecordFile = NULL;
+	}
+}
+
+void LLPacketRing::recordPacket(const char *datap, S32 packet_size)
+{
+	F64 elapsed = mRecordTimer.getElapsedTimeF64();
+
+	PacketRecord record;
+	record.mTimeMS = (U32)(elapsed * 1000.0);
+	record.mIP = mLastSender.getAddress();
+	record.mPort = mLastSender.getPort();
+	record.mSize = (U32)packet_size;
+
+	if (fwrite(&record, sizeof(PacketRecord), 1, mRecordFile) != 1
+		|| fwrite(datap, 1, packet_size, mRecordFile) != (size_t)packet_size)
+	{
+		LL_WARNS("Messaging") << "Packet recording write failed, recording stopped" << LL_ENDL;
+		stopRecording();
+	}
+}
+
+bool LLPacketRing::startPlayback(const std::string& filename)
+{
+	stopPlayback();
+
+	mPlaybackFile = LLFile::fopen(filename, "rb");
+	if (!mPlaybackFile)
+	{
+		LL_WARNS("Messaging") << "Unable to open packet recording " << filename << LL_ENDL;
+		return false;
+	}
+
+	char magic[8];
+	U32 version = 0;
+	if (fread(magic, 1, 8, mPlaybackFile) != 8
+		|| memcmp(magic, PACKET_RECORD_MAGIC, 8)
+		|| fread(&version, sizeof(U32), 1, mPlaybackFile) != 1
+		|| version != PACKET_RECORD_VERSION)
+	{
+		LL_WARNS("Messaging") << "Invalid packet recording " << filename << LL_ENDL;
+		stopPlayback();
+		return false;
+	}
+
+	mPlaybackNextValid = false;
+	mPlaybackTimer.reset();
+
+	LL_INFOS("Messaging") << "Playing back packets from " << filename << LL_ENDL;
+	return true;
+}
+
+void LLPacketRing::stopPlayback()
+{
+	if (mPlaybackFile)
+	{
+		LLFile::close(mPlaybackFile);
+		mPlaybackFile = NULL;
+	}
+	mPlaybackNextValid = false;
+}
+
+S32 LLPacketRing::receiveFromPlayback(char *datap)
+{
+	if (!mPlaybackNextValid)
+	{
+		if (fread(&mPlaybackNext, sizeof(PacketRecord), 1, mPlaybackFile) != 1)
+		{
+			LL_INFOS("Messaging") << "Packet playback complete" << LL_ENDL;
+			stopPlayback();
+			return 0;
+		}
+		if (mPlaybackNext.mSize > NET_BUFFER_SIZE)
+		{
+			LL_WARNS("Messaging") << "Corrupt packet recording, playback stopped" << LL_ENDL;
+			stopPlayback();
+			return 0;
+		}
+		mPlaybackNextValid = true;
+	}
+
+	F64 elapsed = mPlaybackTimer.getElapsedTimeF64();
+	if (elapsed * 1000.0 < (F64)mPlaybackNext.mTimeMS)
+	{
+		// Not due yet, behave like an empty socket.
+		return 0;
+	}
+
+	mPlaybackNextValid = false;
+	S32 packet_size = (S32)mPlaybackNext.mSize;
+	if (fread(datap, 1, packet_size, mPlaybackFile) != (size_t)packet_size)
+	{
+		LL_WARNS("Messaging") << "Truncated packet recording, playback stopped" << LL_ENDL;
+		stopPlayback();
+		return 0;
+	}
+
+	mLastSender.setAddress(mPlaybackNext.mIP);
+	mLastSender.setPort(mPlaybackNext.mPort);
+	mActualBitsIn += packet_size * 8;
 	return packet_size;
 }
 
 BOOL LLPacketRing::sendPacket(int h_socket, char * send_buffer, S32 buf_size, LLHost host)
 {
 	BOOL status = TRUE;
+	if (mPlaybackFile)
+	{
+		// Nobody is listening during playback; pretend the send worked.
+		return status;
+	}
 	if (!mUseOutThrottle)
 	{
 		return sendPacketImpl(h_socket, send_buffer, buf_size, host );
@@ -30,10 +30,12 @@
 
 #include <queue>
 
+#include "llfile.h"
 #include "llhost.h"
 #include "llpacketbuffer.h"
 #include "llproxy.h"
 #include "llthrottle.h"
+#include "lltimer.h"
 #include "net.h"
 
 class LLPacketRing
@@ -60,6 +62,20 @@ public:
 
 	S32 getAndResetActualInBits()				{ S32 bits = mActualBitsIn; mActualBitsIn = 0; return bits;}
 	S32 getAndResetActualOutBits()				{ S32 bits = mActualBitsOut; mActualBitsOut = 0; return bits;}
+
+	// Packet capture for reproducible scene load benchmarks.  While
+	// recording, every packet handed to the message system is appended to
+	// the file along with its arrival time and sender.  During playback the
+	// network is ignored and the recorded packets are delivered at their
+	// original relative times; outgoing packets are discarded.
+	bool startRecording(const std::string& filename);
+	void stopRecording();
+	bool isRecording() const					{ return mRecordFile != NULL; }
+
+	bool startPlayback(const std::string& filename);
+	void stopPlayback();
+	bool isPlayingBack() const					{ return mPlaybackFile != NULL; }
+
 protected:
 	BOOL mUseInThrottle;
 	BOOL mUseOutThrottle;
@@ -83,8 +99,27 @@ protected:
 	LLHost mLastSender;
 	LLHost mLastReceivingIF;
 
+	// Recorded packet header, written in host byte order ahead of the payload.
+	struct PacketRecord
+	{
+		U32 mTimeMS;
+		U32 mIP;
+		U32 mPort;
+		U32 mSize;
+	};
+
+	LLFILE* mRecordFile;
+	LLTimer mRecordTimer;
+
+	LLFILE* mPlaybackFile;
+	LLTimer mPlaybackTimer;
+	PacketRecord mPlaybackNext;
+	bool mPlaybackNextValid;
+
 private:
 	BOOL sendPacketImpl(int h_socket, const char * send_buffer, S32 buf_size, LLHost host);
+	void recordPacket(const char *datap, S32 packet_size);
+	S32  receiveFromPlayback(char *datap);
 };
 
 
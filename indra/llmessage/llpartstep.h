@@ -0,0 +1,86 @@
+/**
+ * @file llpartstep.h
+ * @brief The per frame step of a particle.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLPARTSTEP_H
+#define LL_LLPARTSTEP_H
+
+#include "llmath.h"
+#include "llpartdata.h"
+
+// Steps a particle by dt in place: moves it along its velocity and
+// acceleration, interpolates color and scale where its flags ask for it and
+// glow always, and ages it.  Returns how far through its life the particle
+// is, which target linear particles are placed by; those are not moved here
+// as placing them needs their source.
+//
+// PART is LLViewerPart, or anything with the same members, so that the
+// step LLViewerPartGroup runs can be tested and timed without the viewer.
+// It only touches the particle it is given, so particles of different
+// groups can be stepped on different threads.
+template <class PART>
+F32 ll_step_particle(PART& part, F32 dt)
+{
+	// Update current time
+	const F32 cur_time = part.mLastUpdateTime + dt;
+	const F32 frac = cur_time / part.mMaxAge;
+
+	if (!(part.mFlags & LLPartData::LL_PART_TARGET_LINEAR_MASK))
+	{
+		// Do velocity interpolation
+		part.mPosAgent += dt*part.mVelocity;
+		part.mPosAgent += 0.5f*dt*dt*part.mAccel;
+		part.mVelocity += part.mAccel*dt;
+	}
+
+	// Do color interpolation
+	if (part.mFlags & LLPartData::LL_PART_INTERP_COLOR_MASK)
+	{
+		part.mColor.setVec(part.mStartColor);
+		// note: LLColor4's v%k means multiply-alpha-only,
+		//       LLColor4's v*k means multiply-rgb-only
+		part.mColor *= 1.f - frac; // rgb*k
+		part.mColor %= 1.f - frac; // alpha*k
+		part.mColor += frac%(frac*part.mEndColor); // rgb,alpha
+	}
+
+	// Do scale interpolation
+	if (part.mFlags & LLPartData::LL_PART_INTERP_SCALE_MASK)
+	{
+		part.mScale.setVec(part.mStartScale);
+		part.mScale *= 1.f - frac;
+		part.mScale += frac*part.mEndScale;
+	}
+
+	// Do glow interpolation
+	part.mGlow.mV[3] = (U8) ll_round(lerp(part.mStartGlow, part.mEndGlow, frac)*255.f);
+
+	// Set the last update time to now.
+	part.mLastUpdateTime = cur_time;
+	return frac;
+}
+
+#endif // LL_LLPARTSTEP_H
@@ -27,7 +27,14 @@
  
 #include "linden_common.h"
 
+#include <sstream>
+
 #include "../llavatarnamecache.h"
+#include "lldate.h"
+#include "llframetimer.h"
+#include "llsd.h"
+#include "lltimer.h"
+#include "lluuid.h"
 
 #include "../test/lltut.h"
 
@@ -35,6 +42,20 @@ namespace tut
 {
 	struct avatarnamecache_data
 	{
+		LLAvatarName makeName(S32 i, F64 expires)
+		{
+			LLSD sd;
+			sd["username"] = llformat("resident%d", i);
+			sd["display_name"] = llformat("Display Name %d", i);
+			sd["legacy_first_name"] = llformat("Resident%d", i);
+			sd["legacy_last_name"] = "Resident";
+			sd["is_display_name_default"] = (i % 2) == 0;
+			sd["display_name_expires"] = LLDate(expires);
+			sd["display_name_next_update"] = LLDate(expires - 60.0);
+			LLAvatarName av_name;
+			av_name.fromLLSD(sd);
+			return av_name;
+		}
 	};
 	typedef test_group<avatarnamecache_data> avatarnamecache_test;
 	typedef avatarnamecache_test::object avatarnamecache_object;
@@ -99,4 +120,91 @@ namespace tut
 		valid = max_age_from_cache_control("max-age=-123", &max_age);
 		ensure("less than zero max-age is invalid", !valid);
 	}
+
+	template<> template<>
+	void avatarnamecache_object::test<3>()
+	{
+		// names survive the binary cache file, expired ones are dropped
+		F64 now = LLFrameTimer::getTotalSeconds();
+		LLUUID fresh_id;
+		LLUUID stale_id;
+		fresh_id.generate();
+		stale_id.generate();
+		LLAvatarNameCache::insert(fresh_id, makeName(1, now + 3600.0));
+		LLAvatarNameCache::insert(stale_id, makeName(2, now - 30.0 * 24.0 * 3600.0));
+
+		std::stringstream file;
+		LLAvatarNameCache::exportFile(file);
+		LLAvatarNameCache::cleanupClass();
+		ensure("imported", LLAvatarNameCache::importFile(file));
+
+		// lookups only answer once the cache is running
+		LLAvatarNameCache::idle();
+		LLAvatarName av_name;
+		ensure("fresh name kept", LLAvatarNameCache::get(fresh_id, &av_name));
+		ensure_equals("display name", av_name.asLLSD()["display_name"].asString(), std::string("Display Name 1"));
+		ensure_equals("legacy last name", av_name.asLLSD()["legacy_last_name"].asString(), std::string("Resident"));
+		ensure_equals("expiry", av_name.mExpires, now + 3600.0);
+		ensure("stale name dropped", !LLAvatarNameCache::get(stale_id, &av_name));
+
+		// files written by older viewers still load
+		std::stringstream xml("<llsd><map><key>agents</key><map><key>" + stale_id.asString()
+							  + "</key><map><key>username</key><string>old.resident</string>"
+							  "<key>display_name</key><string>Old</string>"
+							  "<key>display_name_expires</key><date>2030-01-01T00:00:00Z</date>"
+							  "<key>display_name_next_update</key><date>2030-01-01T00:00:00Z</date>"
+							  "</map></map></map></llsd>");
+		LLAvatarNameCache::cleanupClass();
+		ensure("imported xml", LLAvatarNameCache::importFile(xml));
+		LLAvatarNameCache::idle();
+		ensure("xml name", LLAvatarNameCache::get(stale_id, &av_name));
+		ensure_equals("xml display name", av_name.asLLSD()["display_name"].asString(), std::string("Old"));
+
+		std::stringstream truncated(file.str().substr(0, file.str().size() / 2));
+		ensure("truncated file rejected", !LLAvatarNameCache::importFile(truncated));
+		LLAvatarNameCache::cleanupClass();
+	}
+
+	template<> template<>
+	void avatarnamecache_object::test<4>()
+	{
+		// loading a large cache only indexes it, names decode on lookup
+		const S32 count = 100000;
+		F64 now = LLFrameTimer::getTotalSeconds();
+		std::vector<LLUUID> ids(count);
+		for (S32 i = 0; i < count; ++i)
+		{
+			ids[i].generate();
+			LLAvatarNameCache::insert(ids[i], makeName(i, now + 3600.0));
+		}
+		std::stringstream file;
+		LLAvatarNameCache::exportFile(file);
+		LLAvatarNameCache::cleanupClass();
+
+		LLTimer timer;
+		ensure("imported", LLAvatarNameCache::importFile(file));
+		F64 load_time = timer.getElapsedTimeF64();
+		LLAvatarNameCache::idle();
+
+		LLAvatarName av_name;
+		timer.reset();
+		for (S32 i = 0; i < count; ++i)
+		{
+			LLAvatarNameCache::get(ids[i], &av_name);
+		}
+		F64 first_time = timer.getElapsedTimeF64();
+		timer.reset();
+		S32 found = 0;
+		for (S32 i = 0; i < count; ++i)
+		{
+			found += LLAvatarNameCache::get(ids[i], &av_name) ? 1 : 0;
+		}
+		F64 lookup_time = timer.getElapsedTimeF64();
+		ensure_equals("all found", found, count);
+		ensure_equals("last name", av_name.getAccountName(), llformat("resident%d", count - 1));
+
+		LL_INFOS() << count << " names, " << file.str().size() << " bytes, load " << load_time
+				   << "s, first lookups " << first_time << "s, lookups " << lookup_time << "s" << LL_ENDL;
+		LLAvatarNameCache::cleanupClass();
+	}
 }
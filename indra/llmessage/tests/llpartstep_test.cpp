@@ -0,0 +1,297 @@
+/**
+ * @file   llpartstep_test.cpp
+ * @brief  Test and particle stepping benchmark for llpartstep.h.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <vector>
+#include <boost/bind.hpp>
+
+#include "../llpartdata.h"
+#include "../llpartstep.h"
+
+#include "llrand.h"
+#include "lltimer.h"
+#include "llworkpool.h"
+#include "v4coloru.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// the parts of an LLViewerPart a step touches
+	struct Particle : public LLPartData
+	{
+		U32 mPartID;
+		F32 mLastUpdateTime;
+		LLVector3 mPosAgent;
+		LLVector3 mVelocity;
+		LLVector3 mAccel;
+		LLColor4 mColor;
+		LLVector2 mScale;
+		LLColor4U mGlow;
+	};
+	typedef std::vector<Particle*> part_list_t;
+
+	// The step LLViewerPartGroup::updateParticles() took before it was
+	// split up, minus what needs the viewer.
+	void step_reference(Particle& part, F32 dt)
+	{
+		const F32 cur_time = part.mLastUpdateTime + dt;
+		const F32 frac = cur_time / part.mMaxAge;
+
+		if (!(part.mFlags & LLPartData::LL_PART_TARGET_LINEAR_MASK))
+		{
+			part.mPosAgent += dt*part.mVelocity;
+			part.mPosAgent += 0.5f*dt*dt*part.mAccel;
+			part.mVelocity += part.mAccel*dt;
+		}
+
+		if (part.mFlags & LLPartData::LL_PART_INTERP_COLOR_MASK)
+		{
+			part.mColor.setVec(part.mStartColor);
+			part.mColor *= 1.f - frac;
+			part.mColor %= 1.f - frac;
+			part.mColor += frac%(frac*part.mEndColor);
+		}
+
+		if (part.mFlags & LLPartData::LL_PART_INTERP_SCALE_MASK)
+		{
+			part.mScale.setVec(part.mStartScale);
+			part.mScale *= 1.f - frac;
+			part.mScale += frac*part.mEndScale;
+		}
+
+		part.mGlow.mV[3] = (U8) ll_round(lerp(part.mStartGlow, part.mEndGlow, frac)*255.f);
+		part.mLastUpdateTime = cur_time;
+	}
+
+	// A script's particle system with a mix of the flags a step cares about.
+	void make_source(LLPartSysData& sys, U32 index)
+	{
+		LLPartData& part = sys.mPartData;
+		part.mFlags = 0;
+		if (index % 2)
+		{
+			part.mFlags |= LLPartData::LL_PART_INTERP_COLOR_MASK;
+		}
+		if (index % 3)
+		{
+			part.mFlags |= LLPartData::LL_PART_INTERP_SCALE_MASK;
+		}
+		if (index % 5 == 0)
+		{
+			part.mFlags |= LLPartData::LL_PART_TARGET_LINEAR_MASK;
+		}
+		part.setMaxAge(2.f + (index % 9));
+		part.setStartColor(LLVector3(ll_frand(), ll_frand(), ll_frand()));
+		part.setEndColor(LLVector3(ll_frand(), ll_frand(), ll_frand()));
+		part.setStartAlpha(1.f);
+		part.setEndAlpha(ll_frand());
+		part.setStartScale(0.1f + ll_frand(), 0.1f + ll_frand());
+		part.setEndScale(0.1f + ll_frand(2.f), 0.1f + ll_frand(2.f));
+		part.mStartGlow = ll_frand(0.5f);
+		part.mEndGlow = ll_frand();
+
+		sys.setBurstRadius(ll_frand(2.f));
+		sys.setBurstSpeedMin(ll_frand(1.f));
+		sys.setBurstSpeedMax(sys.mBurstSpeedMin + ll_frand(3.f));
+		sys.mPartAccel.setVec(ll_frand(2.f) - 1.f, ll_frand(2.f) - 1.f, -9.8f * ll_frand());
+	}
+
+	// Bursts count particles out of a source at origin, at all ages, each
+	// allocated on its own the way the viewer's are.
+	void emit(const LLPartSysData& sys, const LLVector3& origin, part_list_t& parts, U32 count)
+	{
+		static U32 next_id = 1;
+		for (U32 i = 0; i < count; ++i)
+		{
+			Particle* part = new Particle;
+			(LLPartData&) *part = sys.mPartData;
+			part->mPartID = next_id++;
+
+			LLVector3 dir(ll_frand(2.f) - 1.f, ll_frand(2.f) - 1.f, ll_frand(2.f) - 1.f);
+			dir.normVec();
+			part->mPosAgent = origin + dir * sys.mBurstRadius;
+			part->mVelocity = dir * (sys.mBurstSpeedMin + ll_frand(sys.mBurstSpeedMax - sys.mBurstSpeedMin));
+			part->mAccel = sys.mPartAccel;
+			part->mColor = part->mStartColor;
+			part->mScale = part->mStartScale;
+			part->mGlow.setToBlack();
+			part->mLastUpdateTime = ll_frand(part->mMaxAge);
+			parts.push_back(part);
+		}
+	}
+
+	// one particle group's worth, as LLViewerPartSim keeps them
+	struct Group
+	{
+		~Group()
+		{
+			for (U32 i = 0; i < mParticles.size(); ++i)
+			{
+				delete mParticles[i];
+			}
+		}
+
+		part_list_t mParticles;
+	};
+
+	// what LLViewerPartGroup::simulateParticles() does to each particle
+	void step_group(std::vector<Group*>* groups, F32 dt, U32 index)
+	{
+		part_list_t& parts = (*groups)[index]->mParticles;
+		for (U32 i = 0; i < parts.size(); ++i)
+		{
+			ll_step_particle(*parts[i], dt);
+		}
+	}
+}
+
+namespace tut
+{
+	struct llpartstep_data
+	{
+		~llpartstep_data()
+		{
+			for (U32 i = 0; i < mGroups.size(); ++i)
+			{
+				delete mGroups[i];
+			}
+		}
+
+		// sources * per_source particles, a group per source
+		void makeGroups(U32 sources, U32 per_source)
+		{
+			for (U32 i = 0; i < sources; ++i)
+			{
+				LLPartSysData sys;
+				make_source(sys, i);
+				Group* group = new Group;
+				emit(sys, LLVector3((F32) (i % 16) * 16.f, (F32) (i / 16) * 16.f, 30.f), group->mParticles, per_source);
+				mGroups.push_back(group);
+			}
+		}
+
+		std::vector<Group*> mGroups;
+	};
+	typedef test_group<llpartstep_data> llpartstep_test;
+	typedef llpartstep_test::object llpartstep_object;
+	tut::llpartstep_test tllpartstep("LLPartStep");
+
+	template<> template<>
+	void llpartstep_object::test<1>()
+	{
+		// groups stepped on a pool match the step taken one particle at a
+		// time before groups ran in parallel
+		makeGroups(20, 101);
+		std::vector<std::vector<Particle> > expected(mGroups.size());
+		for (U32 i = 0; i < mGroups.size(); ++i)
+		{
+			for (U32 j = 0; j < mGroups[i]->mParticles.size(); ++j)
+			{
+				expected[i].push_back(*mGroups[i]->mParticles[j]);
+			}
+		}
+
+		LLWorkPool pool("Test particles", 2);
+		for (U32 frame = 0; frame < 30; ++frame)
+		{
+			const F32 dt = 0.01f + 0.001f * (frame % 7);
+			for (U32 i = 0; i < expected.size(); ++i)
+			{
+				for (U32 j = 0; j < expected[i].size(); ++j)
+				{
+					step_reference(expected[i][j], dt);
+				}
+			}
+			pool.run(mGroups.size(), boost::bind(&step_group, &mGroups, dt, _1));
+		}
+
+		for (U32 i = 0; i < mGroups.size(); ++i)
+		{
+			for (U32 j = 0; j < expected[i].size(); ++j)
+			{
+				const Particle& part = *mGroups[i]->mParticles[j];
+				const Particle& ref = expected[i][j];
+				ensure_approximately_equals("age", part.mLastUpdateTime, ref.mLastUpdateTime, 20);
+				for (U32 c = 0; c < 3; ++c)
+				{
+					ensure_approximately_equals("position", part.mPosAgent.mV[c], ref.mPosAgent.mV[c], 16);
+					ensure_approximately_equals("velocity", part.mVelocity.mV[c], ref.mVelocity.mV[c], 16);
+				}
+				for (U32 c = 0; c < 4; ++c)
+				{
+					ensure_approximately_equals("color", part.mColor.mV[c], ref.mColor.mV[c], 16);
+				}
+				ensure_approximately_equals("scale x", part.mScale.mV[0], ref.mScale.mV[0], 16);
+				ensure_approximately_equals("scale y", part.mScale.mV[1], ref.mScale.mV[1], 16);
+				ensure_equals("glow", part.mGlow.mV[3], ref.mGlow.mV[3]);
+			}
+		}
+
+		// target linear particles are left where they were for the viewer
+		// to place, others without interpolation keep their color and scale
+		const Particle& still = *mGroups[0]->mParticles[0];
+		ensure("linear", still.mFlags & LLPartData::LL_PART_TARGET_LINEAR_MASK);
+		ensure("not color interpolated", !(still.mFlags & LLPartData::LL_PART_INTERP_COLOR_MASK));
+		ensure_equals("linear not moved", still.mPosAgent, expected[0][0].mPosAgent);
+		ensure_equals("color kept", still.mColor, still.mStartColor);
+	}
+
+	template<> template<>
+	void llpartstep_object::test<2>()
+	{
+		// Time to step 50k particles from 100 sources in place, by worker
+		// count
+		makeGroups(100, 500);
+
+		const U32 FRAMES = 60;
+		const F32 dt = 1.f / 45.f;
+		for (U32 threads = 0; threads <= 4; ++threads)
+		{
+			LLWorkPool* pool = threads ? new LLWorkPool("Test particles", threads) : NULL;
+			LLTimer timer;
+			for (U32 frame = 0; frame < FRAMES; ++frame)
+			{
+				if (pool)
+				{
+					pool->run(mGroups.size(), boost::bind(&step_group, &mGroups, dt, _1));
+				}
+				else
+				{
+					for (U32 i = 0; i < mGroups.size(); ++i)
+					{
+						step_group(&mGroups, dt, i);
+					}
+				}
+			}
+			const F64 time = timer.getElapsedTimeF64();
+			delete pool;
+			LL_INFOS() << mGroups.size() * 500 << " particles, " << threads << " workers: "
+					   << time * 1000.0 / FRAMES << "ms per frame" << LL_ENDL;
+		}
+	}
+}
@@ -0,0 +1,230 @@
+/**
+ * @file llflexiblesim.cpp
+ * @brief Batched section simulation for flexible objects.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llflexiblesim.h"
+
+#include <boost/bind.hpp>
+
+#include "llworkpool.h"
+
+// chains to hand a worker at a time, a few microseconds each
+static const U32 BATCH_CHAINS = 32;
+
+LLFlexibleSim::Chain::Chain()
+:	mSections(NULL),
+	mNumSections(0),
+	mSectionLength(1.f),
+	mTension(0.f),
+	mMomentum(0.f),
+	mMaxAngle(0.f),
+	mGravity(0.f),
+	mHasWind(false)
+{
+}
+
+void LLFlexibleSim::add(const Chain& chain)
+{
+	mChains.push_back(chain);
+}
+
+void LLFlexibleSim::run(LLWorkPool* pool)
+{
+	const U32 batches = (mChains.size() + BATCH_CHAINS - 1) / BATCH_CHAINS;
+	if (pool && batches > 1)
+	{
+		pool->run(batches, boost::bind(&LLFlexibleSim::runBatch, this, _1));
+	}
+	else
+	{
+		for (U32 i = 0; i < batches; ++i)
+		{
+			runBatch(i);
+		}
+	}
+}
+
+void LLFlexibleSim::runBatch(U32 index)
+{
+	const U32 end = llmin((U32) mChains.size(), (index + 1) * BATCH_CHAINS);
+	for (U32 i = index * BATCH_CHAINS; i < end; ++i)
+	{
+		simulate(mChains[i]);
+	}
+}
+
+//static
+void LLFlexibleSim::simulate(Chain& chain)
+{
+	LLFlexibleObjectSection* section = chain.mSections;
+	const S32 num_sections = chain.mNumSections;
+	const F32 section_length = chain.mSectionLength;
+	const F32 inv_section_length = 1.f / section_length;
+
+	section[0].mPosition = chain.mAnchorPosition;
+	section[0].mDirection = chain.mAnchorDirection;
+	section[0].mRotation = chain.mAnchorRotation;
+
+	LLQuaternion parentSegmentRotation = chain.mAnchorRotation;
+	LLQuaternion deltaRotation;
+	LLVector3 lastPosition;
+
+	S32 i;
+
+	// Update simulated sections
+	for (i=1; i<=num_sections; ++i)
+	{
+		LLVector3 parentSectionVector;
+		LLVector3 parentSectionPosition;
+		LLVector3 parentDirection;
+
+		//---------------------------------------------------
+		// save value of position as lastPosition
+		//---------------------------------------------------
+		lastPosition = section[i].mPosition;
+
+		//------------------------------------------------------------------------------------------
+		// gravity
+		//------------------------------------------------------------------------------------------
+		section[i].mPosition.mV[2] -= chain.mGravity;
+
+		//------------------------------------------------------------------------------------------
+		// wind force
+		//------------------------------------------------------------------------------------------
+		if (chain.mHasWind)
+		{
+			section[i].mPosition += chain.mWind[i];
+		}
+
+		//------------------------------------------------------------------------------------------
+		// user-defined force
+		//------------------------------------------------------------------------------------------
+		section[i].mPosition += chain.mUserForce;
+
+		//---------------------------------------------------
+		// tension (rigidity, stiffness)
+		//---------------------------------------------------
+		parentSectionPosition = section[i-1].mPosition;
+		parentDirection = section[i-1].mDirection;
+
+		if ( i == 1 )
+		{
+			parentSectionVector = section[0].mDirection;
+		}
+		else
+		{
+			parentSectionVector = section[i-2].mDirection;
+		}
+
+		LLVector3 currentVector = section[i].mPosition - parentSectionPosition;
+
+		LLVector3 difference = (parentSectionVector*section_length) - currentVector;
+		LLVector3 tensionForce = difference * chain.mTension;
+
+		section[i].mPosition += tensionForce;
+
+		//------------------------------------------------------------------------------------------
+		// inertia
+		//------------------------------------------------------------------------------------------
+		section[i].mPosition += section[i].mVelocity * chain.mMomentum;
+
+		//------------------------------------------------------------------------------------------
+		// clamp length & rotation
+		//------------------------------------------------------------------------------------------
+		section[i].mDirection = section[i].mPosition - parentSectionPosition;
+		section[i].mDirection.normVec();
+		deltaRotation.shortestArc( parentDirection, section[i].mDirection );
+
+		F32 angle;
+		LLVector3 axis;
+		deltaRotation.getAngleAxis(&angle, axis);
+		if (angle > F_PI) angle -= 2.f*F_PI;
+		if (angle < -F_PI) angle += 2.f*F_PI;
+		if (angle > chain.mMaxAngle)
+		{
+			//angle = 0.5f*(angle+max_angle);
+			deltaRotation.setQuat(chain.mMaxAngle, axis);
+		} else if (angle < -chain.mMaxAngle)
+		{
+			//angle = 0.5f*(angle-max_angle);
+			deltaRotation.setQuat(-chain.mMaxAngle, axis);
+		}
+		LLQuaternion segment_rotation = parentSegmentRotation * deltaRotation;
+		parentSegmentRotation = segment_rotation;
+
+		section[i].mDirection = (parentDirection * deltaRotation);
+		section[i].mPosition = parentSectionPosition + section[i].mDirection * section_length;
+		section[i].mRotation = segment_rotation;
+
+		if (i > 1)
+		{
+			// Propogate half the rotation up to the parent
+			LLQuaternion halfDeltaRotation(angle/2, axis);
+			section[i-1].mRotation = section[i-1].mRotation * halfDeltaRotation;
+		}
+
+		//------------------------------------------------------------------------------------------
+		// calculate velocity
+		//------------------------------------------------------------------------------------------
+		section[i].mVelocity = section[i].mPosition - lastPosition;
+		if (section[i].mVelocity.magVecSquared() > 1.f)
+		{
+			section[i].mVelocity.normVec();
+		}
+	}
+
+	// Calculate derivatives (not necessary until normals are automagically generated)
+	section[0].mdPosition = (section[1].mPosition - section[0].mPosition) * inv_section_length;
+	// i = 1..NumSections-1
+	for (i=1; i<num_sections; ++i)
+	{
+		// Quadratic numerical derivative of position
+
+		// f(-L1) = aL1^2 - bL1 + c = f1
+		// f(0)   =               c = f2
+		// f(L2)  = aL2^2 + bL2 + c = f3
+		// f = ax^2 + bx + c
+		// d/dx f = 2ax + b
+		// d/dx f(0) = b
+
+		// c = f2
+		// a = [(f1-c)/L1 + (f3-c)/L2] / (L1+L2)
+		// b = (f3-c-aL2^2)/L2
+
+		LLVector3 a = (section[i-1].mPosition-section[i].mPosition +
+					section[i+1].mPosition-section[i].mPosition) * 0.5f * inv_section_length * inv_section_length;
+		LLVector3 b = (section[i+1].mPosition-section[i].mPosition - a*(section_length*section_length));
+		b *= inv_section_length;
+
+		section[i].mdPosition = b;
+	}
+
+	// i = NumSections
+	section[i].mdPosition = (section[i].mPosition - section[i-1].mPosition) * inv_section_length;
+
+	chain.mEndRotation = parentSegmentRotation;
+}
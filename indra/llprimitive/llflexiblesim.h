@@ -0,0 +1,117 @@
+/**
+ * @file llflexiblesim.h
+ * @brief Batched section simulation for flexible objects.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFLEXIBLESIM_H
+#define LL_LLFLEXIBLESIM_H
+
+#include <vector>
+
+#include "llprimitive.h"
+#include "llquaternion.h"
+#include "v2math.h"
+#include "v3math.h"
+
+class LLWorkPool;
+
+//-------------------------------------------------------------------
+
+struct LLFlexibleObjectSection
+{
+	// Input parameters
+	LLVector2		mScale;
+	LLQuaternion	mAxisRotation;
+	// Simulated state
+	LLVector3		mPosition;
+	LLVector3		mVelocity;
+	LLVector3		mDirection;
+	LLQuaternion	mRotation;
+	// Derivatives (Not all currently used, will come back with LLVolume changes to automagically generate normals)
+	LLVector3		mdPosition;
+	//LLMatrix4		mRotScale;
+	//LLMatrix4		mdRotScale;
+};
+
+//-------------------------------------------------------------------
+// LLFlexibleSim
+//
+// One time step of the section chains of many flexible objects.  Each
+// chain is worked down from its anchor, every section following the one
+// above it, so a chain is stepped start to end on one thread and the chains
+// are spread over the pool.  Everything a step reads from the world (the
+// anchor, the wind) is worked out when the chain is queued, so run() only
+// touches the queued chains and their sections.
+//-------------------------------------------------------------------
+class LLFlexibleSim
+{
+public:
+	struct Chain
+	{
+		Chain();
+
+		// mNumSections + 1 sections, the first is the anchor
+		LLFlexibleObjectSection* mSections;
+		S32 mNumSections;
+
+		LLVector3 mAnchorPosition;
+		LLVector3 mAnchorDirection;
+		LLQuaternion mAnchorRotation;
+
+		F32 mSectionLength;
+		F32 mTension;			// fraction of the way back to straight per step
+		F32 mMomentum;			// fraction of the velocity kept per step
+		F32 mMaxAngle;			// largest bend between sections, radians
+		F32 mGravity;			// downwards pull per step
+		LLVector3 mUserForce;	// push per step
+		bool mHasWind;
+		// per section push of the wind at where gravity moved the section to
+		LLVector3 mWind[(1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1];
+
+		// out: rotation of the last section
+		LLQuaternion mEndRotation;
+	};
+
+	// Queues a chain, its sections must stay put until run() returns.
+	void add(const Chain& chain);
+
+	bool empty() const			{ return mChains.empty(); }
+	U32 size() const			{ return mChains.size(); }
+	Chain& get(U32 index)		{ return mChains[index]; }
+
+	// Steps every queued chain, spread over the pool when there is one.
+	// The chains stay queued for their results to be read until clear().
+	void run(LLWorkPool* pool);
+	void clear()				{ mChains.clear(); }
+
+	// steps one chain on the calling thread
+	static void simulate(Chain& chain);
+
+private:
+	void runBatch(U32 index);
+
+	std::vector<Chain> mChains;
+};
+
+#endif // LL_LLFLEXIBLESIM_H
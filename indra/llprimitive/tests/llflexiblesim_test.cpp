@@ -0,0 +1,190 @@
+/**
+ * @file   llflexiblesim_test.cpp
+ * @brief  Test and step benchmark for llflexiblesim.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <vector>
+
+#include "../test/lltut.h"
+#include "../llflexiblesim.h"
+
+#include "llworkpool.h"
+#include "lltimer.h"
+
+namespace
+{
+	// a busy club's worth of hair, skirts and flags
+	const U32 FLEXI_COUNT = 2000;
+	const U32 SECTIONS_PER_FLEXI = (1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1;
+}
+
+namespace tut
+{
+	struct llflexiblesim_data
+	{
+		llflexiblesim_data()
+		{
+			reset(mSerial);
+			reset(mPooled);
+		}
+
+		// every chain hanging straight up from its anchor, at rest
+		void reset(std::vector<LLFlexibleObjectSection>& sections)
+		{
+			sections.resize(FLEXI_COUNT * SECTIONS_PER_FLEXI);
+			memset(&sections[0], 0, sections.size() * sizeof(LLFlexibleObjectSection));
+			for (U32 flexi = 0; flexi < FLEXI_COUNT; ++flexi)
+			{
+				LLFlexibleObjectSection* section = &sections[flexi * SECTIONS_PER_FLEXI];
+				for (U32 i = 0; i < SECTIONS_PER_FLEXI; ++i)
+				{
+					section[i].mPosition = getAnchor(flexi) + LLVector3(0.f, 0.f, i * getSectionLength(flexi));
+					section[i].mDirection = LLVector3::z_axis;
+				}
+			}
+		}
+
+		LLVector3 getAnchor(U32 flexi) const
+		{
+			return LLVector3((F32) (flexi % 50) * 2.f, (F32) (flexi / 50) * 2.f, 20.f);
+		}
+
+		S32 getNumSections(U32 flexi) const
+		{
+			return 1 << (1 + flexi % FLEXIBLE_OBJECT_MAX_SECTIONS);
+		}
+
+		F32 getSectionLength(U32 flexi) const
+		{
+			return 2.f / getNumSections(flexi);
+		}
+
+		// queues what LLVolumeImplFlexible::prepareSimulation() would for
+		// one step of every flexi, each with its own softness and forces
+		void queue(LLFlexibleSim& sim, std::vector<LLFlexibleObjectSection>& sections, U32 step)
+		{
+			const F32 dt = 1.f / 45.f;
+			for (U32 flexi = 0; flexi < FLEXI_COUNT; ++flexi)
+			{
+				LLFlexibleSim::Chain chain;
+				chain.mSections = &sections[flexi * SECTIONS_PER_FLEXI];
+				chain.mNumSections = getNumSections(flexi);
+				chain.mAnchorPosition = getAnchor(flexi);
+				chain.mAnchorDirection = LLVector3::z_axis;
+				chain.mSectionLength = getSectionLength(flexi);
+				chain.mTension = (flexi % 10) * 0.1f * (1.f - powf(0.85f, dt * 30.f));
+				chain.mMomentum = 1.f / powf(10.f, ((flexi % 5) * 2.f + 1.f) * dt);
+				chain.mMaxAngle = atanf(chain.mSectionLength * 2.f);
+
+				const F32 force_factor = chain.mSectionLength * dt;
+				chain.mGravity = (flexi % 7) * 0.5f * force_factor;
+				chain.mUserForce = LLVector3((flexi % 3) * 0.2f, 0.f, 0.f) * force_factor;
+				chain.mHasWind = (flexi % 4) != 0;
+				if (chain.mHasWind)
+				{
+					for (S32 i = 1; i <= chain.mNumSections; ++i)
+					{
+						chain.mWind[i] = LLVector3(sinf(step * 0.1f + i), cosf(flexi * 0.3f), 0.f) * force_factor;
+					}
+				}
+				sim.add(chain);
+			}
+		}
+
+		std::vector<LLFlexibleObjectSection> mSerial;
+		std::vector<LLFlexibleObjectSection> mPooled;
+	};
+	typedef test_group<llflexiblesim_data> llflexiblesim_test;
+	typedef llflexiblesim_test::object llflexiblesim_object;
+	tut::llflexiblesim_test tllflexiblesim("LLFlexibleSim");
+
+	template<> template<>
+	void llflexiblesim_object::test<1>()
+	{
+		// the same sections whether stepped here or spread over a pool
+		LLFlexibleSim sim;
+		LLWorkPool pool("Test flexi", 3);
+		for (U32 step = 0; step < 20; ++step)
+		{
+			queue(sim, mSerial, step);
+			ensure_equals("queued", sim.size(), FLEXI_COUNT);
+			sim.run(NULL);
+			sim.clear();
+			ensure("cleared", sim.empty());
+
+			queue(sim, mPooled, step);
+			sim.run(&pool);
+			sim.clear();
+		}
+		ensure("same sections", memcmp(&mSerial[0], &mPooled[0], mSerial.size() * sizeof(LLFlexibleObjectSection)) == 0);
+
+		// sections stay a section length apart however they bent
+		for (U32 flexi = 0; flexi < FLEXI_COUNT; flexi += 37)
+		{
+			const LLFlexibleObjectSection* section = &mSerial[flexi * SECTIONS_PER_FLEXI];
+			ensure("anchor", section[0].mPosition == getAnchor(flexi));
+			for (S32 i = 1; i <= getNumSections(flexi); ++i)
+			{
+				ensure_approximately_equals("section length", dist_vec(section[i].mPosition, section[i-1].mPosition), getSectionLength(flexi), 12);
+			}
+		}
+
+		// the heaviest chains sag
+		const U32 heavy = 6;
+		ensure("sagged", mSerial[heavy * SECTIONS_PER_FLEXI + getNumSections(heavy)].mPosition.mV[VZ] < getAnchor(heavy).mV[VZ] + 2.f - 0.01f);
+	}
+
+	template<> template<>
+	void llflexiblesim_object::test<2>()
+	{
+		// Time to step every flexi in view once, by worker count
+		LLFlexibleSim sim;
+		U32 sections = 0;
+		for (U32 flexi = 0; flexi < FLEXI_COUNT; ++flexi)
+		{
+			sections += getNumSections(flexi);
+		}
+		LL_INFOS() << FLEXI_COUNT << " flexis, " << sections << " sections" << LL_ENDL;
+
+		const U32 REPEATS = 20;
+		for (U32 threads = 0; threads <= 4; ++threads)
+		{
+			LLWorkPool* pool = threads ? new LLWorkPool("Test flexi", threads) : NULL;
+			LLTimer timer;
+			F64 step_time = 0.0;
+			for (U32 i = 0; i < REPEATS; ++i)
+			{
+				queue(sim, mSerial, i);
+				timer.reset();
+				sim.run(pool);
+				step_time += timer.getElapsedTimeF64();
+				sim.clear();
+			}
+			delete pool;
+			LL_INFOS() << threads << " workers: " << step_time * 1000.0 / REPEATS << "ms per frame" << LL_ENDL;
+		}
+	}
+}
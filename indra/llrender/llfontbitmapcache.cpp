@@ -28,17 +28,19 @@
 
 #include "llgl.h"
 #include "llfontbitmapcache.h"
+#include "llframetimer.h"
+
+static LLTrace::CountStatHandle<> sGlyphEvictions("font_glyph_evictions", "Glyphs evicted from font bitmaps to stay within the memory budget");
+
+U32 LLFontBitmapCache::sMemoryBudget = 4 * 1024 * 1024;
 
 LLFontBitmapCache::LLFontBitmapCache()
 :	LLTrace::MemTrackable<LLFontBitmapCache>("LLFontBitmapCache"),
 	mNumComponents(0),
 	mBitmapWidth(0),
 	mBitmapHeight(0),
-	mBitmapNum(-1),
 	mMaxCharWidth(0),
-	mMaxCharHeight(0),
-	mCurrentOffsetX(1),
-	mCurrentOffsetY(1)
+	mMaxCharHeight(0)
 {
 }
 
@@ -55,6 +57,36 @@ void LLFontBitmapCache::init(S32 num_components,
 	mNumComponents = num_components;
 	mMaxCharWidth = max_char_width;
 	mMaxCharHeight = max_char_height;
+
+	S32 image_width = mMaxCharWidth * 20;
+	S32 pow_iw = 2;
+	while (pow_iw < image_width)
+	{
+		pow_iw *= 2;
+	}
+	image_width = pow_iw;
+	image_width = llmin(512, image_width); // Don't make bigger than 512x512, ever.
+
+	mBitmapWidth = image_width;
+	mBitmapHeight = image_width;
+
+	mAtlas.init(mBitmapWidth, mBitmapHeight, getMaxPages());
+}
+
+//static
+void LLFontBitmapCache::setMemoryBudget(U32 bytes)
+{
+	sMemoryBudget = bytes;
+}
+
+S32 LLFontBitmapCache::getMaxPages() const
+{
+	U32 page_bytes = mBitmapWidth * mBitmapHeight * mNumComponents;
+	if (sMemoryBudget == 0 || page_bytes == 0)
+	{
+		return S32_MAX;
+	}
+	return llmax(1, (S32)(sMemoryBudget / page_bytes));
 }
 
 LLImageRaw *LLFontBitmapCache::getImageRaw(U32 bitmap_num) const
@@ -73,76 +105,111 @@ LLImageGL *LLFontBitmapCache::getImageGL(U32 bitmap_num) const
 	return mImageGLVec[bitmap_num];
 }
 
+BOOL LLFontBitmapCache::nextOpenPos(S32 width, S32 height, U32 key, S32 &pos_x, S32 &pos_y, S32& bitmap_num, S32& slot, std::vector<U32>& evicted_keys)
+{
+	U32 evicted = evicted_keys.size();
+	slot = mAtlas.allocate(key, width, height, LLFrameTimer::getFrameCount(), evicted_keys);
+	if (slot < 0)
+	{
+		return FALSE;
+	}
+	if (evicted_keys.size() > evicted)
+	{
+		add(sGlyphEvictions, evicted_keys.size() - evicted);
+	}
+
+	while ((S32)mImageRawVec.size() < mAtlas.getNumPages())
+	{
+		addBitmap();
+	}
+
+	const LLGlyphAtlas::Slot& info = mAtlas.getSlot(slot);
+	pos_x = info.mX;
+	pos_y = info.mY;
+	bitmap_num = info.mPage;
+
+	clearCell(slot);
+
+	return TRUE;
+}
+
+void LLFontBitmapCache::touchGlyph(S32 slot) const
+{
+	mAtlas.touch(slot, LLFrameTimer::getFrameCount());
+}
 
-BOOL LLFontBitmapCache::nextOpenPos(S32 width, S32 &pos_x, S32 &pos_y, S32& bitmap_num)
+void LLFontBitmapCache::pinGlyph(S32 slot)
 {
-	if ((mBitmapNum<0) || (mCurrentOffsetX + width + 1) > mBitmapWidth)
+	mAtlas.pin(slot);
+}
+
+void LLFontBitmapCache::uploadGlyph(S32 slot)
+{
+	const LLGlyphAtlas::Slot& info = mAtlas.getSlot(slot);
+	LLImageGL *image_gl = getImageGL(info.mPage);
+	LLImageRaw *image_raw = getImageRaw(info.mPage);
+	if (image_gl && image_raw && !gHeadlessClient)
 	{
-		if ((mBitmapNum<0) || (mCurrentOffsetY + 2*mMaxCharHeight + 2) > mBitmapHeight)
-		{
-			// We're out of space in the current image, or no image
-			// has been allocated yet.  Make a new one.
-			
-			mImageRawVec.push_back(new LLImageRaw);
-			mBitmapNum = mImageRawVec.size()-1;
-			LLImageRaw *image_raw = getImageRaw(mBitmapNum);
-
-			// Make corresponding GL image.
-			mImageGLVec.push_back(new LLImageGL(FALSE));
-			LLImageGL *image_gl = getImageGL(mBitmapNum);
-			
-			S32 image_width = mMaxCharWidth * 20;
-			S32 pow_iw = 2;
-			while (pow_iw < image_width)
-			{
-				pow_iw *= 2;
-			}
-			image_width = pow_iw;
-			image_width = llmin(512, image_width); // Don't make bigger than 512x512, ever.
-			S32 image_height = image_width;
-
-			image_raw->resize(image_width, image_height, mNumComponents);
-
-			mBitmapWidth = image_width;
-			mBitmapHeight = image_height;
-
-			switch (mNumComponents)
-			{
-				case 1:
-					image_raw->clear();
-				break;
-				case 2:
-					image_raw->clear(255, 0);
-				break;
-			}
-
-			// Start at beginning of the new image.
-			mCurrentOffsetX = 1;
-			mCurrentOffsetY = 1;
-
-			// Attach corresponding GL texture.
-			image_gl->createGLTexture(0, image_raw);
-			gGL.getTexUnit(0)->bind(image_gl);
-			image_gl->setFilteringOption(LLTexUnit::TFO_POINT); // was setMipFilterNearest(TRUE, TRUE);
-
-			claimMem(image_raw);
-			claimMem(image_gl);
-		}
-		else
+		image_gl->setSubImage(image_raw, info.mCellX, info.mCellY, info.mCellWidth, info.mCellHeight);
+	}
+}
+
+// Cells may be handed out again after eviction, so wipe what was there.
+void LLFontBitmapCache::clearCell(S32 slot)
+{
+	const LLGlyphAtlas::Slot& info = mAtlas.getSlot(slot);
+	LLImageRaw *image_raw = getImageRaw(info.mPage);
+	U8 *data = image_raw->getData();
+	for (S32 y = info.mCellY; y < info.mCellY + info.mCellHeight; ++y)
+	{
+		U8 *row = data + (y * mBitmapWidth + info.mCellX) * mNumComponents;
+		switch (mNumComponents)
 		{
-			// Move to next row in current image.
-			mCurrentOffsetX = 1;
-			mCurrentOffsetY += mMaxCharHeight + 1;
+			case 1:
+				memset(row, 0, info.mCellWidth);
+			break;
+			case 2:
+				for (S32 x = 0; x < info.mCellWidth; ++x)
+				{
+					row[x*2] = 255;
+					row[x*2+1] = 0;
+				}
+			break;
 		}
 	}
+}
 
-	pos_x = mCurrentOffsetX;
-	pos_y = mCurrentOffsetY;
-	bitmap_num = mBitmapNum;
+void LLFontBitmapCache::addBitmap()
+{
+	mImageRawVec.push_back(new LLImageRaw);
+	LLImageRaw *image_raw = mImageRawVec.back();
 
-	mCurrentOffsetX += width + 1;
+	// Make corresponding GL image.
+	mImageGLVec.push_back(new LLImageGL(FALSE));
+	LLImageGL *image_gl = mImageGLVec.back();
 
-	return TRUE;
+	image_raw->resize(mBitmapWidth, mBitmapHeight, mNumComponents);
+
+	switch (mNumComponents)
+	{
+		case 1:
+			image_raw->clear();
+		break;
+		case 2:
+			image_raw->clear(255, 0);
+		break;
+	}
+
+	// Attach corresponding GL texture, headless layout only needs the glyph metrics.
+	if (!gHeadlessClient)
+	{
+		image_gl->createGLTexture(0, image_raw);
+		gGL.getTexUnit(0)->bind(image_gl);
+		image_gl->setFilteringOption(LLTexUnit::TFO_POINT); // was setMipFilterNearest(TRUE, TRUE);
+	}
+
+	claimMem(image_raw);
+	claimMem(image_gl);
 }
 
 void LLFontBitmapCache::destroyGL()
@@ -172,10 +239,5 @@ void LLFontBitmapCache::reset()
 	}
 	mImageGLVec.clear();
 	
-	mBitmapWidth = 0;
-	mBitmapHeight = 0;
-	mBitmapNum = -1;
-	mCurrentOffsetX = 1;
-	mCurrentOffsetY = 1;
+	mAtlas.init(mBitmapWidth, mBitmapHeight, getMaxPages());
 }
-
@@ -29,6 +29,7 @@
 
 #include <vector>
 #include "lltrace.h"
+#include "llglyphatlas.h"
 
 // Maintain a collection of bitmaps containing rendered glyphs.
 // Generalizes the single-bitmap logic from LLFontFreetype and LLFontGL.
@@ -45,7 +46,24 @@ public:
 
 	void reset();
 
-	BOOL nextOpenPos(S32 width, S32 &posX, S32 &posY, S32 &bitmapNum);
+	// Find room for a width x height glyph, evicting least recently used
+	// glyphs once the memory budget is reached.  The keys of evicted glyphs
+	// are appended to evicted_keys and must be dropped by the caller.
+	BOOL nextOpenPos(S32 width, S32 height, U32 key, S32 &posX, S32 &posY, S32 &bitmapNum, S32 &slot, std::vector<U32>& evicted_keys);
+
+	// Mark a glyph as drawn this frame so it is not evicted.
+	void touchGlyph(S32 slot) const;
+	void pinGlyph(S32 slot);
+
+	// Copy a glyph's cell from the raw bitmap to its GL texture.
+	void uploadGlyph(S32 slot);
+
+	// Changes whenever glyphs are evicted and their texture space reused.
+	U32 getGeneration() const { return mAtlas.getGeneration(); }
+
+	// Per font limit on glyph bitmap memory, 0 for no limit.
+	static void setMemoryBudget(U32 bytes);
+	static U32 getMemoryBudget() { return sMemoryBudget; }
 	
 	void destroyGL();
 	
@@ -58,16 +76,20 @@ public:
 	S32 getBitmapHeight() const { return mBitmapHeight; }
 
 private:
+	void addBitmap();
+	void clearCell(S32 slot);
+	S32 getMaxPages() const;
+
 	S32 mNumComponents;
 	S32 mBitmapWidth;
 	S32 mBitmapHeight;
-	S32 mBitmapNum;
 	S32 mMaxCharWidth;
 	S32 mMaxCharHeight;
-	S32 mCurrentOffsetX;
-	S32 mCurrentOffsetY;
+	mutable LLGlyphAtlas mAtlas;
 	std::vector<LLPointer<LLImageRaw> >	mImageRawVec;
 	std::vector<LLPointer<LLImageGL> > mImageGLVec;
+
+	static U32 sMemoryBudget;
 };
 
 #endif //LL_LLFONTBITMAPCACHE_H
@@ -45,6 +45,7 @@
 //#include "imdebug.h"
 #include "llfontbitmapcache.h"
 #include "llgl.h"
+#include "llqueuedthread.h"
 
 FT_Render_Mode gFontRenderMode = FT_RENDER_MODE_NORMAL;
 
@@ -52,6 +53,249 @@ LLFontManager *gFontManagerp = NULL;
 
 FT_Library gFTLibrary = NULL;
 
+static LLTrace::CountStatHandle<> sGlyphsPrefetched("font_glyphs_prefetched", "Glyphs rasterised on the font raster thread");
+
+// Expand a FreeType bitmap to 8 bit coverage if needed.  Returns NULL for
+// pixel modes we don't know how to handle.
+static const U8* get_gray_bitmap(const FT_Bitmap& bitmap, std::vector<U8>& scratch, S32& stride)
+{
+	S32 width = bitmap.width;
+	S32 height = bitmap.rows;
+
+	if (bitmap.pixel_mode == FT_PIXEL_MODE_GRAY)
+	{
+		stride = bitmap.pitch;
+		return bitmap.buffer;
+	}
+
+	if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
+	{
+		// need to expand 1-bit bitmap to 8-bit graymap.
+		scratch.resize(width * height);
+		for (S32 ypos = 0; ypos < height; ++ypos)
+		{
+			S32 bm_row_offset = bitmap.pitch * ypos;
+			for (S32 xpos = 0; xpos < width; ++xpos)
+			{
+				U32 bm_col_offsetbyte = xpos / 8;
+				U32 bm_col_offsetbit = 7 - (xpos % 8);
+				U32 bit = !!(bitmap.buffer[bm_row_offset + bm_col_offsetbyte] & (1 << bm_col_offsetbit));
+				scratch[width*ypos + xpos] = 255 * bit;
+			}
+		}
+		stride = width;
+		return scratch.empty() ? NULL : &scratch[0];
+	}
+
+	return NULL;
+}
+
+// Rasterises glyphs for LLFontFreetype::prefetchGlyphs().  FreeType faces
+// are not thread safe, so the thread loads its own library and faces and
+// only hands bitmaps and metrics back; packing and GL uploads stay on the
+// main thread.
+class LLFontRasterThread : public LLQueuedThread
+{
+public:
+	struct Result
+	{
+		U32 mFontID;
+		llwchar mChar;
+		U32 mGlyphIndex;
+		bool mValid;
+		S32 mWidth;
+		S32 mHeight;
+		S32 mXBearing;
+		S32 mYBearing;
+		F32 mXAdvance;
+		F32 mYAdvance;
+		std::vector<U8> mBitmap; // 8 bit coverage, stride mWidth
+	};
+
+	class GlyphRequest : public LLQueuedThread::QueuedRequest
+	{
+	protected:
+		virtual ~GlyphRequest() {} // use deleteRequest()
+
+	public:
+		GlyphRequest(handle_t handle, LLFontRasterThread* thread, const std::string& filename,
+					 F32 point_size, F32 vert_dpi, F32 horz_dpi)
+		:	LLQueuedThread::QueuedRequest(handle, LLQueuedThread::PRIORITY_NORMAL, FLAG_AUTO_COMPLETE),
+			mThread(thread),
+			mFileName(filename),
+			mPointSize(point_size),
+			mVertDPI(vert_dpi),
+			mHorzDPI(horz_dpi)
+		{
+		}
+
+		/*virtual*/ bool processRequest();
+		/*virtual*/ void finishRequest(bool completed);
+
+		Result mResult;
+
+	private:
+		LLFontRasterThread* mThread;
+		std::string mFileName;
+		F32 mPointSize;
+		F32 mVertDPI;
+		F32 mHorzDPI;
+	};
+
+	LLFontRasterThread();
+	virtual ~LLFontRasterThread();
+
+	// MAIN THREAD
+	void requestGlyph(U32 font_id, const std::string& filename, F32 point_size, F32 vert_dpi, F32 horz_dpi,
+					  llwchar wch, U32 glyph_index);
+	void getResults(U32 font_id, std::vector<Result>& results);
+	void discardResults(U32 font_id);
+
+private:
+	// WORKER THREAD
+	FT_Face getFace(const std::string& filename, F32 point_size, F32 vert_dpi, F32 horz_dpi);
+	void addResult(Result& result);
+
+	FT_Library mLibrary;
+	typedef std::map<std::string, FT_Face> face_map_t;
+	face_map_t mFaces;
+
+	LLMutex mResultMutex;
+	typedef std::map<U32, std::vector<Result> > result_map_t;
+	result_map_t mResults;
+};
+
+static LLFontRasterThread* sFontRasterThread = NULL;
+static bool sAsyncRasterization = false;
+
+LLFontRasterThread::LLFontRasterThread()
+:	LLQueuedThread("fontraster"),
+	mLibrary(NULL),
+	mResultMutex(NULL)
+{
+	if (FT_Init_FreeType(&mLibrary))
+	{
+		LL_WARNS() << "Freetype initialization failed for the font raster thread" << LL_ENDL;
+		mLibrary = NULL;
+	}
+}
+
+LLFontRasterThread::~LLFontRasterThread()
+{
+	shutdown();
+	for (face_map_t::iterator iter = mFaces.begin(); iter != mFaces.end(); ++iter)
+	{
+		FT_Done_Face(iter->second);
+	}
+	mFaces.clear();
+	if (mLibrary)
+	{
+		FT_Done_FreeType(mLibrary);
+	}
+}
+
+void LLFontRasterThread::requestGlyph(U32 font_id, const std::string& filename, F32 point_size, F32 vert_dpi, F32 horz_dpi,
+									  llwchar wch, U32 glyph_index)
+{
+	GlyphRequest* req = new GlyphRequest(generateHandle(), this, filename, point_size, vert_dpi, horz_dpi);
+	req->mResult.mFontID = font_id;
+	req->mResult.mChar = wch;
+	req->mResult.mGlyphIndex = glyph_index;
+	req->mResult.mValid = false;
+	if (!addRequest(req))
+	{
+		LL_WARNS() << "Glyph request added after the font raster thread shut down" << LL_ENDL;
+	}
+}
+
+void LLFontRasterThread::getResults(U32 font_id, std::vector<Result>& results)
+{
+	LLMutexLock lock(&mResultMutex);
+	result_map_t::iterator iter = mResults.find(font_id);
+	if (iter != mResults.end())
+	{
+		results.swap(iter->second);
+		mResults.erase(iter);
+	}
+}
+
+void LLFontRasterThread::discardResults(U32 font_id)
+{
+	LLMutexLock lock(&mResultMutex);
+	mResults.erase(font_id);
+}
+
+void LLFontRasterThread::addResult(Result& result)
+{
+	LLMutexLock lock(&mResultMutex);
+	std::vector<Result>& results = mResults[result.mFontID];
+	results.push_back(Result());
+	std::swap(results.back(), result);
+}
+
+FT_Face LLFontRasterThread::getFace(const std::string& filename, F32 point_size, F32 vert_dpi, F32 horz_dpi)
+{
+	std::string key = llformat("%s|%.2f|%.2f|%.2f", filename.c_str(), point_size, vert_dpi, horz_dpi);
+	face_map_t::iterator iter = mFaces.find(key);
+	if (iter != mFaces.end())
+	{
+		return iter->second;
+	}
+
+	FT_Face face = NULL;
+	if (mLibrary && !FT_New_Face(mLibrary, filename.c_str(), 0, &face))
+	{
+		if (FT_Set_Char_Size(face, 0, (S32)(point_size*64), (U32)horz_dpi, (U32)vert_dpi))
+		{
+			FT_Done_Face(face);
+			face = NULL;
+		}
+	}
+	mFaces[key] = face;
+	return face;
+}
+
+bool LLFontRasterThread::GlyphRequest::processRequest()
+{
+	FT_Face face = mThread->getFace(mFileName, mPointSize, mVertDPI, mHorzDPI);
+	if (!face
+		|| FT_Load_Glyph(face, mResult.mGlyphIndex, FT_LOAD_FORCE_AUTOHINT)
+		|| FT_Render_Glyph(face->glyph, gFontRenderMode))
+	{
+		return true; // done (failed)
+	}
+
+	const FT_Bitmap& bitmap = face->glyph->bitmap;
+	std::vector<U8> scratch;
+	S32 stride = 0;
+	const U8* data = get_gray_bitmap(bitmap, scratch, stride);
+	if (!data && bitmap.width * bitmap.rows > 0)
+	{
+		return true;
+	}
+
+	mResult.mWidth = bitmap.width;
+	mResult.mHeight = bitmap.rows;
+	mResult.mXBearing = face->glyph->bitmap_left;
+	mResult.mYBearing = face->glyph->bitmap_top;
+	mResult.mXAdvance = face->glyph->advance.x / 64.f;
+	mResult.mYAdvance = face->glyph->advance.y / 64.f;
+	mResult.mBitmap.resize(mResult.mWidth * mResult.mHeight);
+	for (S32 row = 0; row < mResult.mHeight; ++row)
+	{
+		memcpy(&mResult.mBitmap[row * mResult.mWidth], data + row * stride, mResult.mWidth);
+	}
+	mResult.mValid = true;
+	return true;
+}
+
+void LLFontRasterThread::GlyphRequest::finishRequest(bool completed)
+{
+	// failures are passed back too so the requester stops waiting
+	mResult.mValid = mResult.mValid && completed;
+	mThread->addResult(mResult);
+}
+
 //static
 void LLFontManager::initClass()
 {
@@ -68,6 +312,21 @@ void LLFontManager::cleanupClass()
 	gFontManagerp = NULL;
 }
 
+//static
+void LLFontManager::setAsyncRasterization(bool enabled)
+{
+	sAsyncRasterization = enabled;
+	if (gFontManagerp && enabled && !sFontRasterThread)
+	{
+		sFontRasterThread = new LLFontRasterThread;
+	}
+	else if (!enabled && sFontRasterThread)
+	{
+		delete sFontRasterThread;
+		sFontRasterThread = NULL;
+	}
+}
+
 LLFontManager::LLFontManager()
 {
 	int error;
@@ -78,10 +337,18 @@ LLFontManager::LLFontManager()
 		LL_ERRS() << "Freetype initialization failure!" << LL_ENDL;
 		FT_Done_FreeType(gFTLibrary);
 	}
+
+	if (sAsyncRasterization)
+	{
+		sFontRasterThread = new LLFontRasterThread;
+	}
 }
 
 LLFontManager::~LLFontManager()
 {
+	delete sFontRasterThread;
+	sFontRasterThread = NULL;
+
 	FT_Done_FreeType(gFTLibrary);
 }
 
@@ -96,7 +363,8 @@ LLFontGlyphInfo::LLFontGlyphInfo(U32 index)
 	mYBitmapOffset(0), 	// Offset to the origin in the bitmap
 	mXBearing(0),		// Distance from baseline to left in pixels
 	mYBearing(0),		// Distance from baseline to top in pixels
-	mBitmapNum(0) // Which bitmap in the bitmap cache contains this glyph
+	mBitmapNum(0), // Which bitmap in the bitmap cache contains this glyph
+	mAtlasSlot(-1)
 {
 }
 
@@ -111,7 +379,10 @@ LLFontFreetype::LLFontFreetype()
 	mRenderGlyphCount(0),
 	mAddGlyphCount(0),
 	mStyle(0),
-	mPointSize(0)
+	mPointSize(0),
+	mVertDPI(0.f),
+	mHorzDPI(0.f),
+	mPrefetchID(0)
 {
 }
 
@@ -123,6 +394,11 @@ LLFontFreetype::~LLFontFreetype()
 		FT_Done_Face(mFTFace);
 	mFTFace = NULL;
 
+	if (sFontRasterThread)
+	{
+		sFontRasterThread->discardResults(mPrefetchID);
+	}
+
 	// Delete glyph info
 	std::for_each(mCharGlyphInfoMap.begin(), mCharGlyphInfoMap.end(), DeletePairedPointer());
 	mCharGlyphInfoMap.clear();
@@ -156,6 +432,15 @@ BOOL LLFontFreetype::loadFace(const std::string& filename, F32 point_size, F32 v
 	mIsFallback = is_fallback;
 	F32 pixels_per_em = (point_size / 72.f)*vert_dpi; // Size in inches * dpi
 
+	// anything still being rasterised is for the old face or size
+	static U32 next_prefetch_id = 0;
+	if (sFontRasterThread)
+	{
+		sFontRasterThread->discardResults(mPrefetchID);
+	}
+	mPrefetchID = ++next_prefetch_id;
+	mPrefetchPending.clear();
+
 	error = FT_Set_Char_Size(mFTFace,    /* handle to face object           */
 							0,       /* char_width in 1/64th of points  */
 							(S32)(point_size*64),   /* char_height in 1/64th of points */
@@ -205,6 +490,8 @@ BOOL LLFontFreetype::loadFace(const std::string& filename, F32 point_size, F32 v
 	mName = filename;
 	claimMem(mName);
 	mPointSize = point_size;
+	mVertDPI = vert_dpi;
+	mHorzDPI = horz_dpi;
 
 	mStyle = LLFontGL::NORMAL;
 	if(mFTFace->style_flags & FT_STYLE_FLAG_BOLD)
@@ -319,31 +606,40 @@ BOOL LLFontFreetype::hasGlyph(llwchar wch) const
 	return(mCharGlyphInfoMap.find(wch) != mCharGlyphInfoMap.end());
 }
 
-LLFontGlyphInfo* LLFontFreetype::addGlyph(llwchar wch) const
+// Find the font that has a glyph for wch, this one or a fallback
+const LLFontFreetype* LLFontFreetype::getGlyphSource(llwchar wch, U32& glyph_index) const
 {
-	if (mFTFace == NULL)
-		return FALSE;
-
-	llassert(!mIsFallback);
-	//LL_DEBUGS() << "Adding new glyph for " << wch << " to font" << LL_ENDL;
-
-	FT_UInt glyph_index;
-
-	// Initialize char to glyph map
 	glyph_index = FT_Get_Char_Index(mFTFace, wch);
 	if (glyph_index == 0)
 	{
-		//LL_INFOS() << "Trying to add glyph from fallback font!" << LL_ENDL;
 		font_vector_t::const_iterator iter;
 		for(iter = mFallbackFonts.begin(); iter != mFallbackFonts.end(); iter++)
 		{
 			glyph_index = FT_Get_Char_Index((*iter)->mFTFace, wch);
 			if (glyph_index)
 			{
-				return addGlyphFromFont(*iter, wch, glyph_index);
+				return *iter;
 			}
 		}
 	}
+	return this;
+}
+
+LLFontGlyphInfo* LLFontFreetype::addGlyph(llwchar wch) const
+{
+	if (mFTFace == NULL)
+		return FALSE;
+
+	llassert(!mIsFallback);
+	//LL_DEBUGS() << "Adding new glyph for " << wch << " to font" << LL_ENDL;
+
+	U32 glyph_index;
+	const LLFontFreetype* fontp = getGlyphSource(wch, glyph_index);
+	if (fontp != this)
+	{
+		//LL_INFOS() << "Trying to add glyph from fallback font!" << LL_ENDL;
+		return addGlyphFromFont(fontp, wch, glyph_index);
+	}
 	
 	char_glyph_info_map_t::iterator iter = mCharGlyphInfoMap.find(wch);
 	if (iter == mCharGlyphInfoMap.end())
@@ -360,64 +656,79 @@ LLFontGlyphInfo* LLFontFreetype::addGlyphFromFont(const LLFontFreetype *fontp, l
 
 	llassert(!mIsFallback);
 	fontp->renderGlyph(glyph_index);
-	S32 width = fontp->mFTFace->glyph->bitmap.width;
-	S32 height = fontp->mFTFace->glyph->bitmap.rows;
 
-	S32 pos_x, pos_y;
-	S32 bitmap_num;
-	mFontBitmapCachep->nextOpenPos(width, pos_x, pos_y, bitmap_num);
+	const FT_Bitmap& bitmap = fontp->mFTFace->glyph->bitmap;
+	llassert(bitmap.pixel_mode == FT_PIXEL_MODE_MONO
+	    || bitmap.pixel_mode == FT_PIXEL_MODE_GRAY);
+
+	// we don't know how to handle other pixel formats from FreeType;
+	// they are omitted from the font-image.
+	std::vector<U8> tmp_graydata;
+	S32 buffer_row_stride = 0;
+	const U8* buffer_data = get_gray_bitmap(bitmap, tmp_graydata, buffer_row_stride);
+
+	LLFontGlyphInfo* gi = addGlyphBitmap(wch, glyph_index, bitmap.width, bitmap.rows, buffer_data, buffer_row_stride);
+	gi->mXBearing = fontp->mFTFace->glyph->bitmap_left;
+	gi->mYBearing = fontp->mFTFace->glyph->bitmap_top;
+	// Convert these from 26.6 units to float pixels.
+	gi->mXAdvance = fontp->mFTFace->glyph->advance.x / 64.f;
+	gi->mYAdvance = fontp->mFTFace->glyph->advance.y / 64.f;
+
+	return gi;
+}
+
+// Place a rendered glyph in the bitmap cache, evicting old glyphs if the
+// cache is at its memory budget.  Metrics other than size are left to the caller.
+LLFontGlyphInfo* LLFontFreetype::addGlyphBitmap(llwchar wch, U32 glyph_index, S32 width, S32 height, const U8* gray_data, S32 stride) const
+{
+	S32 pos_x = 0;
+	S32 pos_y = 0;
+	S32 bitmap_num = 0;
+	S32 slot = -1;
+	std::vector<U32> evicted;
+	if (!mFontBitmapCachep->nextOpenPos(width, height, wch, pos_x, pos_y, bitmap_num, slot, evicted))
+	{
+		LL_WARNS() << "Glyph " << (U32)wch << " (" << width << "x" << height << ") too large for font bitmap" << LL_ENDL;
+		width = 0;
+		height = 0;
+		gray_data = NULL;
+	}
 	mAddGlyphCount++;
 
+	for (std::vector<U32>::iterator iter = evicted.begin(); iter != evicted.end(); ++iter)
+	{
+		char_glyph_info_map_t::iterator found_it = mCharGlyphInfoMap.find((llwchar)*iter);
+		if (found_it != mCharGlyphInfoMap.end())
+		{
+			disclaimMem(found_it->second);
+			delete found_it->second;
+			mCharGlyphInfoMap.erase(found_it);
+		}
+	}
+
 	LLFontGlyphInfo* gi = new LLFontGlyphInfo(glyph_index);
 	gi->mXBitmapOffset = pos_x;
 	gi->mYBitmapOffset = pos_y;
 	gi->mBitmapNum = bitmap_num;
+	gi->mAtlasSlot = slot;
 	gi->mWidth = width;
 	gi->mHeight = height;
-	gi->mXBearing = fontp->mFTFace->glyph->bitmap_left;
-	gi->mYBearing = fontp->mFTFace->glyph->bitmap_top;
-	// Convert these from 26.6 units to float pixels.
-	gi->mXAdvance = fontp->mFTFace->glyph->advance.x / 64.f;
-	gi->mYAdvance = fontp->mFTFace->glyph->advance.y / 64.f;
 
 	insertGlyphInfo(wch, gi);
 
-	llassert(fontp->mFTFace->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO
-	    || fontp->mFTFace->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_GRAY);
-
-	if (fontp->mFTFace->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO
-	    || fontp->mFTFace->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_GRAY)
+	if (slot < 0)
 	{
-		U8 *buffer_data = fontp->mFTFace->glyph->bitmap.buffer;
-		S32 buffer_row_stride = fontp->mFTFace->glyph->bitmap.pitch;
-		U8 *tmp_graydata = NULL;
+		return gi;
+	}
 
-		if (fontp->mFTFace->glyph->bitmap.pixel_mode
-		    == FT_PIXEL_MODE_MONO)
-		{
-			// need to expand 1-bit bitmap to 8-bit graymap.
-			tmp_graydata = new U8[width * height];
-			S32 xpos, ypos;
-			for (ypos = 0; ypos < height; ++ypos)
-			{
-				S32 bm_row_offset = buffer_row_stride * ypos;
-				for (xpos = 0; xpos < width; ++xpos)
-				{
-					U32 bm_col_offsetbyte = xpos / 8;
-					U32 bm_col_offsetbit = 7 - (xpos % 8);
-					U32 bit =
-					!!(buffer_data[bm_row_offset
-						       + bm_col_offsetbyte
-					   ] & (1 << bm_col_offsetbit) );
-					tmp_graydata[width*ypos + xpos] =
-						255 * bit;
-				}
-			}
-			// use newly-built graymap.
-			buffer_data = tmp_graydata;
-			buffer_row_stride = width;
-		}
+	if (wch == 0)
+	{
+		// the default glyph stands in for everything missing
+		mFontBitmapCachep->pinGlyph(slot);
+	}
 
+	if (gray_data)
+	{
 		switch (mFontBitmapCachep->getNumComponents())
 		{
 		case 1:
@@ -425,8 +736,8 @@ LLFontGlyphInfo* LLFontFreetype::addGlyphFromFont(const LLFontFreetype *fontp, l
 																	pos_y,
 																	width,
 																	height,
-																	buffer_data,
-																	buffer_row_stride,
+																	gray_data,
+																	stride,
 																	TRUE);
 			break;
 		case 2:
@@ -435,36 +746,104 @@ LLFontGlyphInfo* LLFontFreetype::addGlyphFromFont(const LLFontFreetype *fontp, l
 									  bitmap_num,
 									  width,
 									  height,
-									  buffer_data,
-									  buffer_row_stride);
+									  gray_data,
+									  stride);
 			break;
 		default:
 			break;
 		}
-
-		if (tmp_graydata)
-			delete[] tmp_graydata;
-	} else {
-		// we don't know how to handle this pixel format from FreeType;
-		// omit it from the font-image.
 	}
-	
-	LLImageGL *image_gl = mFontBitmapCachep->getImageGL(bitmap_num);
-	LLImageRaw *image_raw = mFontBitmapCachep->getImageRaw(bitmap_num);
-	image_gl->setSubImage(image_raw, 0, 0, image_gl->getWidth(), image_gl->getHeight());
+
+	mFontBitmapCachep->uploadGlyph(slot);
 
 	return gi;
 }
 
+void LLFontFreetype::prefetchGlyphs(const LLWString& wstr) const
+{
+	if (mFTFace == NULL || !sFontRasterThread)
+	{
+		return;
+	}
+
+	collectPrefetchedGlyphs();
+
+	for (LLWString::const_iterator iter = wstr.begin(); iter != wstr.end(); ++iter)
+	{
+		llwchar wch = *iter;
+		if (wch < LAST_CHAR_FULL
+			|| mCharGlyphInfoMap.find(wch) != mCharGlyphInfoMap.end()
+			|| !mPrefetchPending.insert(wch).second)
+		{
+			continue;
+		}
+
+		U32 glyph_index;
+		const LLFontFreetype* fontp = getGlyphSource(wch, glyph_index);
+		sFontRasterThread->requestGlyph(mPrefetchID, fontp->mName, fontp->mPointSize, fontp->mVertDPI, fontp->mHorzDPI, wch, glyph_index);
+	}
+}
+
+void LLFontFreetype::collectPrefetchedGlyphs() const
+{
+	if (!sFontRasterThread || mPrefetchPending.empty())
+	{
+		return;
+	}
+
+	std::vector<LLFontRasterThread::Result> results;
+	sFontRasterThread->getResults(mPrefetchID, results);
+
+	for (std::vector<LLFontRasterThread::Result>::iterator iter = results.begin(); iter != results.end(); ++iter)
+	{
+		const LLFontRasterThread::Result& result = *iter;
+		mPrefetchPending.erase(result.mChar);
+
+		if (!result.mValid || mCharGlyphInfoMap.find(result.mChar) != mCharGlyphInfoMap.end())
+		{
+			// failed, or drawn before the worker got to it
+			continue;
+		}
+
+		LLFontGlyphInfo* gi = addGlyphBitmap(result.mChar, result.mGlyphIndex, result.mWidth, result.mHeight,
+											 result.mBitmap.empty() ? NULL : &result.mBitmap[0], result.mWidth);
+		gi->mXBearing = result.mXBearing;
+		gi->mYBearing = result.mYBearing;
+		gi->mXAdvance = result.mXAdvance;
+		gi->mYAdvance = result.mYAdvance;
+		add(sGlyphsPrefetched, 1);
+	}
+}
+
+void LLFontFreetype::touchGlyphs(const std::vector<S32>& atlas_slots) const
+{
+	for (std::vector<S32>::const_iterator iter = atlas_slots.begin(); iter != atlas_slots.end(); ++iter)
+	{
+		mFontBitmapCachep->touchGlyph(*iter);
+	}
+}
+
 LLFontGlyphInfo* LLFontFreetype::getGlyphInfo(llwchar wch) const
 {
 	char_glyph_info_map_t::iterator iter = mCharGlyphInfoMap.find(wch);
 	if (iter != mCharGlyphInfoMap.end())
 	{
+		if (iter->second->mAtlasSlot >= 0)
+		{
+			mFontBitmapCachep->touchGlyph(iter->second->mAtlasSlot);
+		}
 		return iter->second;
 	}
 	else
 	{
+		// the raster thread may already have it
+		collectPrefetchedGlyphs();
+		iter = mCharGlyphInfoMap.find(wch);
+		if (iter != mCharGlyphInfoMap.end())
+		{
+			return iter->second;
+		}
+
 		// this glyph doesn't yet exist, so render it and return the result
 		return addGlyph(wch);
 	}
@@ -28,6 +28,7 @@
 #define LL_LLFONTFREETYPE_H
 
 #include <boost/unordered_map.hpp>
+#include <set>
 #include "llpointer.h"
 #include "llstl.h"
 
@@ -47,6 +48,9 @@ public:
 	static void initClass();
 	static void cleanupClass();
 
+	// Rasterise prefetched glyphs on a worker thread
+	static void setAsyncRasterization(bool enabled);
+
 private:
 	LLFontManager();
 	~LLFontManager();
@@ -70,6 +74,7 @@ struct LLFontGlyphInfo
 	S32 mXBearing;	// Distance from baseline to left in pixels
 	S32 mYBearing;	// Distance from baseline to top in pixels
 	S32 mBitmapNum; // Which bitmap in the bitmap cache contains this glyph
+	S32 mAtlasSlot; // Slot in the bitmap cache, for least recently used eviction
 };
 
 extern LLFontManager *gFontManagerp;
@@ -128,6 +133,13 @@ public:
 
 	LLFontGlyphInfo* getGlyphInfo(llwchar wch) const;
 
+	// Mark glyphs drawn without going through getGlyphInfo() as used this frame.
+	void touchGlyphs(const std::vector<S32>& atlas_slots) const;
+
+	// Start rasterising any glyphs in wstr that are not cached yet, on the
+	// worker thread if one is running.  Results are picked up by later calls.
+	void prefetchGlyphs(const LLWString& wstr) const;
+
 	void reset(F32 vert_dpi, F32 horz_dpi);
 
 	void destroyGL();
@@ -145,6 +157,9 @@ private:
 	BOOL hasGlyph(llwchar wch) const;		// Has a glyph for this character
 	LLFontGlyphInfo* addGlyph(llwchar wch) const;		// Add a new character to the font if necessary
 	LLFontGlyphInfo* addGlyphFromFont(const LLFontFreetype *fontp, llwchar wch, U32 glyph_index) const;	// Add a glyph from this font to the other (returns the glyph_index, 0 if not found)
+	LLFontGlyphInfo* addGlyphBitmap(llwchar wch, U32 glyph_index, S32 width, S32 height, const U8* gray_data, S32 stride) const;
+	const LLFontFreetype* getGlyphSource(llwchar wch, U32& glyph_index) const;
+	void collectPrefetchedGlyphs() const;
 	void renderGlyph(U32 glyph_index) const;
 	void insertGlyphInfo(llwchar wch, LLFontGlyphInfo* gi) const;
 
@@ -153,6 +168,8 @@ private:
 	U8 mStyle;
 
 	F32 mPointSize;
+	F32 mVertDPI;
+	F32 mHorzDPI;
 	F32 mAscender;			
 	F32 mDescender;
 	F32 mLineHeight;
@@ -167,6 +184,10 @@ private:
 
 	mutable LLFontBitmapCache* mFontBitmapCachep;
 
+	// Identifies this face's requests to the raster thread; changes on every load
+	U32 mPrefetchID;
+	mutable std::set<llwchar> mPrefetchPending;
+
 	mutable S32 mRenderGlyphCount;
 	mutable S32 mAddGlyphCount;
 };
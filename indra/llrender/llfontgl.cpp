@@ -60,11 +60,15 @@ LLFontRegistry* LLFontGL::sFontRegistry = NULL;
 LLCoordGL LLFontGL::sCurOrigin;
 F32 LLFontGL::sCurDepth;
 std::vector<std::pair<LLCoordGL, F32> > LLFontGL::sOriginStack;
+U32 LLFontGL::sGlyphRunCacheSize = 1024;
+S32 LLFontGL::sBatchDepth = 0;
 
 const F32 PAD_UVY = 0.5f; // half of vertical padding between glyphs in the glyph texture
 const F32 DROP_SHADOW_SOFT_STRENGTH = 0.3f;
 
 LLFontGL::LLFontGL()
+:	mGlyphRunUseCount(0),
+	mGlyphRunGeneration(0)
 {
 }
 
@@ -74,11 +78,14 @@ LLFontGL::~LLFontGL()
 
 void LLFontGL::reset()
 {
+	clearGlyphRunCache();
 	mFontFreetype->reset(sVertDPI, sHorizDPI);
 }
 
 void LLFontGL::destroyGL()
 {
+	flushBatch();
+	clearGlyphRunCache();
 	mFontFreetype->destroyGL();
 }
 
@@ -93,6 +100,59 @@ BOOL LLFontGL::loadFace(const std::string& filename, F32 point_size, F32 vert_dp
 }
 
 static LLTrace::BlockTimerStatHandle FTM_RENDER_FONTS("Fonts");
+static LLTrace::BlockTimerStatHandle FTM_RENDER_FONT_BATCH("Font Batch");
+static LLTrace::BlockTimerStatHandle FTM_LAYOUT_GLYPH_RUN("Layout Glyph Run");
+
+static LLTrace::CountStatHandle<> sGlyphRunHits("font_glyph_run_hits", "Text render calls drawn from the glyph run cache");
+static LLTrace::CountStatHandle<> sGlyphRunMisses("font_glyph_run_misses", "Text render calls that had to lay out glyphs");
+static LLTrace::CountStatHandle<> sFontBatchDraws("font_batch_draws", "Texture binds for batched text");
+
+// glyph quads queued between LLFontGL::beginBatch() and endBatch() that use the same glyph texture
+struct LLFontBatchBucket
+{
+	LLPointer<LLImageGL>	mImage;
+	std::vector<LLVector3>	mVertices;
+	std::vector<LLVector2>	mUVs;
+	std::vector<LLColor4U>	mColors;
+};
+
+static std::vector<LLFontBatchBucket> sBatchBuckets;
+static glh::matrix4f sBatchProjection;
+static glh::matrix4f sBatchModelview;
+
+static LLFontBatchBucket& get_batch_bucket(LLImageGL* image)
+{
+	for (std::vector<LLFontBatchBucket>::iterator iter = sBatchBuckets.begin(); iter != sBatchBuckets.end(); ++iter)
+	{
+		if (iter->mImage == image)
+		{
+			return *iter;
+		}
+	}
+
+	sBatchBuckets.push_back(LLFontBatchBucket());
+	sBatchBuckets.back().mImage = image;
+	return sBatchBuckets.back();
+}
+
+// queued vertices are only valid under the matrices they were queued with
+static void check_batch_matrices()
+{
+	const glh::matrix4f& proj = gGL.getProjectionMatrix();
+	const glh::matrix4f& modelview = gGL.getModelviewMatrix();
+
+	if (!sBatchBuckets.empty() &&
+		(memcmp(proj.m, sBatchProjection.m, sizeof(proj.m)) || memcmp(modelview.m, sBatchModelview.m, sizeof(modelview.m))))
+	{
+		LLFontGL::flushBatch();
+	}
+
+	if (sBatchBuckets.empty())
+	{
+		sBatchProjection = proj;
+		sBatchModelview = modelview;
+	}
+}
 
 S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, const LLRect& rect, const LLColor4 &color, HAlign halign, VAlign valign, U8 style,
     ShadowType shadow, S32 max_chars, F32* right_x, BOOL use_ellipses) const
@@ -142,8 +202,6 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 		return 0;
 	} 
 
-	gGL.getTexUnit(0)->enable(LLTexUnit::TT_TEXTURE);
-
 	S32 scaled_max_pixels = max_pixels == S32_MAX ? S32_MAX : llceil((F32)max_pixels * sScaleX);
 
 	// determine which style flags need to be added programmatically by stripping off the
@@ -162,18 +220,27 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 		}
 	}
 
-	gGL.pushUIMatrix();
+	// underlines are drawn untextured in the current matrix, keep those out of the batch
+	const bool batched = sBatchDepth > 0 && !(style_to_add & UNDERLINE);
+
+	if (!batched)
+	{
+		gGL.getTexUnit(0)->enable(LLTexUnit::TT_TEXTURE);
 
-	gGL.loadUIIdentity();
+		gGL.pushUIMatrix();
+
+		gGL.loadUIIdentity();
+
+		// Depth translation, so that floating text appears 'in-world'
+		// and is correctly occluded.
+		gGL.translatef(0.f,0.f,sCurDepth);
+
+		// Not guaranteed to be set correctly
+		gGL.setSceneBlendType(LLRender::BT_ALPHA);
+	}
 	
 	LLVector2 origin(floorf(sCurOrigin.mX*sScaleX), floorf(sCurOrigin.mY*sScaleY));
 
-	// Depth translation, so that floating text appears 'in-world'
-	// and is correctly occluded.
-	gGL.translatef(0.f,0.f,sCurDepth);
-
-	S32 chars_drawn = 0;
-	S32 i;
 	S32 length;
 
 	if (-1 == max_chars)
@@ -185,11 +252,8 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 		length = llmin((S32)wstr.length() - begin_offset, max_chars );
 	}
 
-	F32 cur_x, cur_y, cur_render_x, cur_render_y;
+	F32 cur_x, cur_y;
 
- 	// Not guaranteed to be set correctly
-	gGL.setSceneBlendType(LLRender::BT_ALPHA);
-	
 	cur_x = ((F32)x * sScaleX) + origin.mV[VX];
 	cur_y = ((F32)y * sScaleY) + origin.mV[VY];
 
@@ -213,22 +277,209 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 		break;
 	}
 
+	// glyphs are laid out relative to the whole pixel part of the pen position,
+	// alignment only ever moves the pen by whole pixels
+	F32 base_x = floorf(cur_x);
+	F32 base_y = floorf(cur_y);
+
+	const GlyphRun& run = getGlyphRun(wstr, begin_offset, length, style_to_add, shadow, scaled_max_pixels, use_ellipses, cur_x - base_x, cur_y - base_y);
+
 	switch (halign)
 	{
 	case LEFT:
 		break;
 	case RIGHT:
-	  	cur_x -= llmin(scaled_max_pixels, ll_round(getWidthF32(wstr.c_str(), begin_offset, length) * sScaleX));
+	  	base_x -= llmin(scaled_max_pixels, ll_round(run.mWidth * sScaleX));
 		break;
 	case HCENTER:
-	    cur_x -= llmin(scaled_max_pixels, ll_round(getWidthF32(wstr.c_str(), begin_offset, length) * sScaleX)) / 2;
+	    base_x -= llmin(scaled_max_pixels, ll_round(run.mWidth * sScaleX)) / 2;
 		break;
 	default:
 		break;
 	}
 
-	cur_render_y = cur_y;
-	cur_render_x = cur_x;
+	submitGlyphRun(run, base_x, base_y, LLColor4U(color), drop_shadow_strength);
+
+	// run may be evicted by the recursive ellipses render below
+	S32 chars_drawn = run.mCharsDrawn;
+	BOOL draw_ellipses = run.mDrawEllipses;
+	F32 start_x = base_x + run.mStartX;
+	cur_x = base_x + run.mEndX;
+	cur_y = base_y + run.mEndY;
+
+	if (right_x)
+	{
+        F32 cr_x = (cur_x - origin.mV[VX]) / sScaleX;
+        if (*right_x < cr_x)
+        {
+            // rightmost edge of previously drawn text, don't draw over previous text
+            *right_x = cr_x;
+        }
+	}
+
+	//FIXME: add underline as glyph?
+	if (style_to_add & UNDERLINE)
+	{
+		F32 descender = (F32)llfloor(mFontFreetype->getDescenderHeight());
+
+		gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+		gGL.begin(LLRender::LINES);
+		gGL.vertex2f(start_x, cur_y - descender);
+		gGL.vertex2f(cur_x, cur_y - descender);
+		gGL.end();
+	}
+
+	if (draw_ellipses)
+	{
+		
+		// recursively render ellipses at end of string
+		// we've already reserved enough room
+		gGL.pushUIMatrix();
+		renderUTF8(std::string("..."), 
+				0,
+				(cur_x - origin.mV[VX]) / sScaleX, (F32)y,
+				color,
+				LEFT, valign,
+				style_to_add,
+				shadow,
+				S32_MAX, max_pixels,
+				right_x,
+				FALSE); 
+		gGL.popUIMatrix();
+	}
+
+	if (!batched)
+	{
+		gGL.popUIMatrix();
+	}
+
+	return chars_drawn;
+}
+
+bool LLFontGL::GlyphRunKey::operator<(const GlyphRunKey& rhs) const
+{
+	if (mStyle != rhs.mStyle) return mStyle < rhs.mStyle;
+	if (mShadow != rhs.mShadow) return mShadow < rhs.mShadow;
+	if (mUseEllipses != rhs.mUseEllipses) return mUseEllipses < rhs.mUseEllipses;
+	if (mMaxPixels != rhs.mMaxPixels) return mMaxPixels < rhs.mMaxPixels;
+	if (mFracX != rhs.mFracX) return mFracX < rhs.mFracX;
+	if (mFracY != rhs.mFracY) return mFracY < rhs.mFracY;
+	if (mNextChar != rhs.mNextChar) return mNextChar < rhs.mNextChar;
+	return mText < rhs.mText;
+}
+
+const LLFontGL::GlyphRun& LLFontGL::getGlyphRun(const LLWString& wstr, S32 begin_offset, S32 length, U8 style_to_add, ShadowType shadow, 
+												S32 scaled_max_pixels, BOOL use_ellipses, F32 frac_x, F32 frac_y) const
+{
+	if (sGlyphRunCacheSize == 0)
+	{
+		static GlyphRun scratch;
+		layoutGlyphRun(scratch, wstr, begin_offset, length, style_to_add, shadow, scaled_max_pixels, use_ellipses, frac_x, frac_y);
+		return scratch;
+	}
+
+	// evicted glyphs leave stale texture coordinates behind
+	U32 generation = mFontFreetype->getFontBitmapCache()->getGeneration();
+	if (generation != mGlyphRunGeneration)
+	{
+		clearGlyphRunCache();
+		mGlyphRunGeneration = generation;
+	}
+
+	GlyphRunKey key;
+	key.mText.assign(wstr, begin_offset, llmax(length, 0));
+	key.mNextChar = begin_offset + length < (S32) wstr.length() ? wstr[begin_offset + length] : 0;
+	key.mStyle = style_to_add;
+	key.mShadow = (U8) shadow;
+	key.mUseEllipses = use_ellipses;
+	key.mMaxPixels = scaled_max_pixels;
+	key.mFracX = frac_x;
+	key.mFracY = frac_y;
+
+	glyph_run_map_t::iterator iter = mGlyphRuns.find(key);
+	if (iter != mGlyphRuns.end())
+	{
+		add(sGlyphRunHits, 1);
+		iter->second.mLastUsed = ++mGlyphRunUseCount;
+		mFontFreetype->touchGlyphs(iter->second.mAtlasSlots);
+		return iter->second;
+	}
+
+	add(sGlyphRunMisses, 1);
+
+	if (mGlyphRuns.size() >= sGlyphRunCacheSize)
+	{
+		pruneGlyphRuns();
+	}
+
+	GlyphRun& run = mGlyphRuns[key];
+	layoutGlyphRun(run, wstr, begin_offset, length, style_to_add, shadow, scaled_max_pixels, use_ellipses, frac_x, frac_y);
+	run.mLastUsed = ++mGlyphRunUseCount;
+	return run;
+}
+
+void LLFontGL::pruneGlyphRuns() const
+{
+	//drop the least recently used half
+	std::vector<U32> last_used;
+	last_used.reserve(mGlyphRuns.size());
+	for (glyph_run_map_t::iterator iter = mGlyphRuns.begin(); iter != mGlyphRuns.end(); ++iter)
+	{
+		last_used.push_back(iter->second.mLastUsed);
+	}
+
+	std::vector<U32>::iterator median = last_used.begin() + last_used.size()/2;
+	std::nth_element(last_used.begin(), median, last_used.end());
+	U32 cutoff = *median;
+
+	for (glyph_run_map_t::iterator iter = mGlyphRuns.begin(); iter != mGlyphRuns.end(); )
+	{
+		if (iter->second.mLastUsed <= cutoff)
+		{
+			mGlyphRuns.erase(iter++);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+}
+
+void LLFontGL::clearGlyphRunCache() const
+{
+	mGlyphRuns.clear();
+}
+
+void LLFontGL::prefetchGlyphs(const LLWString& wstr) const
+{
+	mFontFreetype->prefetchGlyphs(wstr);
+}
+
+//static
+void LLFontGL::setGlyphRunCacheSize(U32 size)
+{
+	sGlyphRunCacheSize = size;
+}
+
+// Lay out glyph quads the way render() always has, with the pen starting at (frac_x, frac_y)
+void LLFontGL::layoutGlyphRun(GlyphRun& run, const LLWString& wstr, S32 begin_offset, S32 length, U8 style_to_add, ShadowType shadow, 
+							  S32 scaled_max_pixels, BOOL use_ellipses, F32 frac_x, F32 frac_y) const
+{
+	LL_RECORD_BLOCK_TIME(FTM_LAYOUT_GLYPH_RUN);
+
+	run.mVertices.clear();
+	run.mUVs.clear();
+	run.mQuadColors.clear();
+	run.mBatches.clear();
+	run.mAtlasSlots.clear();
+	run.mCharsDrawn = 0;
+	run.mDrawEllipses = FALSE;
+	run.mWidth = getWidthF32(wstr.c_str(), begin_offset, length);
+
+	F32 cur_x = frac_x;
+	F32 cur_y = frac_y;
+	F32 cur_render_x = cur_x;
+	F32 cur_render_y = cur_y;
 
 	F32 start_x = (F32)ll_round(cur_x);
 
@@ -239,33 +490,32 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 
 	const S32 LAST_CHARACTER = LLFontFreetype::LAST_CHAR_FULL;
 
-
-	BOOL draw_ellipses = FALSE;
 	if (use_ellipses)
 	{
 		// check for too long of a string
-		S32 string_width = ll_round(getWidthF32(wstr.c_str(), begin_offset, max_chars) * sScaleX);
+		S32 string_width = ll_round(run.mWidth * sScaleX);
 		if (string_width > scaled_max_pixels)
 		{
 			// use four dots for ellipsis width to generate padding
 			const LLWString dots(utf8str_to_wstring(std::string("....")));
 			scaled_max_pixels = llmax(0, scaled_max_pixels - ll_round(getWidthF32(dots.c_str())));
-			draw_ellipses = TRUE;
+			run.mDrawEllipses = TRUE;
 		}
 	}
 
 	const LLFontGlyphInfo* next_glyph = NULL;
 
-	const S32 GLYPH_BATCH_SIZE = 30;
-	LLVector3 vertices[GLYPH_BATCH_SIZE * 4];
-	LLVector2 uvs[GLYPH_BATCH_SIZE * 4];
-	LLColor4U colors[GLYPH_BATCH_SIZE * 4];
+	// bold and soft shadows emit several quads per glyph
+	const S32 MAX_QUADS_PER_GLYPH = 6;
+	LLVector3 vertices[MAX_QUADS_PER_GLYPH * 4];
+	LLVector2 uvs[MAX_QUADS_PER_GLYPH * 4];
+	LLColor4U colors[MAX_QUADS_PER_GLYPH * 4];
+	U8 quad_colors[MAX_QUADS_PER_GLYPH];
 
-	LLColor4U text_color(color);
+	LLColor4U text_color(255, 255, 255, 255);
 
 	S32 bitmap_num = -1;
-	S32 glyph_count = 0;
-	for (i = begin_offset; i < begin_offset + length; i++)
+	for (S32 i = begin_offset; i < begin_offset + length; i++)
 	{
 		llwchar wch = wstr[i];
 
@@ -280,26 +530,6 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 			LL_ERRS() << "Missing Glyph Info" << LL_ENDL;
 			break;
 		}
-		// Per-glyph bitmap texture.
-		S32 next_bitmap_num = fgi->mBitmapNum;
-		if (next_bitmap_num != bitmap_num)
-		{
-			// Actually draw the queued glyphs before switching their texture;
-			// otherwise the queued glyphs will be taken from wrong textures.
-			if (glyph_count > 0)
-			{
-				gGL.begin(LLRender::QUADS);
-				{
-					gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 4);
-				}
-				gGL.end();
-				glyph_count = 0;
-			}
-
-			bitmap_num = next_bitmap_num;
-			LLImageGL *font_image = font_bitmap_cache->getImageGL(bitmap_num);
-			gGL.getTexUnit(0)->bind(font_image);
-		}
 	
 		if ((start_x + scaled_max_pixels) < (cur_x + fgi->mXBearing + fgi->mWidth))
 		{
@@ -307,6 +537,17 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 			break;
 		}
 
+		// Per-glyph bitmap texture.
+		if (fgi->mBitmapNum != bitmap_num)
+		{
+			bitmap_num = fgi->mBitmapNum;
+			GlyphRun::Batch batch;
+			batch.mBitmapNum = bitmap_num;
+			batch.mFirstQuad = run.mQuadColors.size();
+			batch.mNumQuads = 0;
+			run.mBatches.push_back(batch);
+		}
+
 		// Draw the text at the appropriate location
 		//Specify vertices and texture coordinates
 		LLRectf uv_rect((fgi->mXBitmapOffset) * inv_width,
@@ -319,20 +560,19 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 				    (F32)ll_round(cur_render_x + (F32)fgi->mXBearing) + (F32)fgi->mWidth,
 				    (F32)ll_round(cur_render_y + (F32)fgi->mYBearing) - (F32)fgi->mHeight);
 		
-		if (glyph_count >= GLYPH_BATCH_SIZE)
+		S32 glyph_count = 0;
+		drawGlyph(glyph_count, vertices, uvs, colors, screen_rect, uv_rect, text_color, style_to_add, shadow, 1.f, quad_colors);
+
+		run.mVertices.insert(run.mVertices.end(), vertices, vertices + glyph_count * 4);
+		run.mUVs.insert(run.mUVs.end(), uvs, uvs + glyph_count * 4);
+		run.mQuadColors.insert(run.mQuadColors.end(), quad_colors, quad_colors + glyph_count);
+		run.mBatches.back().mNumQuads += glyph_count;
+		if (fgi->mAtlasSlot >= 0)
 		{
-			gGL.begin(LLRender::QUADS);
-			{
-				gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 4);
-			}
-			gGL.end();
-
-			glyph_count = 0;
+			run.mAtlasSlots.push_back(fgi->mAtlasSlot);
 		}
 
-		drawGlyph(glyph_count, vertices, uvs, colors, screen_rect, uv_rect, text_color, style_to_add, shadow, drop_shadow_strength);
-
-		chars_drawn++;
+		run.mCharsDrawn++;
 		cur_x += fgi->mXAdvance;
 		cur_y += fgi->mYAdvance;
 
@@ -355,57 +595,200 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 		cur_render_y = cur_y;
 	}
 
-	gGL.begin(LLRender::QUADS);
+	run.mStartX = start_x;
+	run.mEndX = cur_x;
+	run.mEndY = cur_y;
+}
+
+void LLFontGL::submitGlyphRun(const GlyphRun& run, F32 offset_x, F32 offset_y, const LLColor4U& color, F32 drop_shadow_strength) const
+{
+	if (run.mBatches.empty())
 	{
-		gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 4);
+		return;
 	}
-	gGL.end();
 
+	const LLFontBitmapCache* font_bitmap_cache = mFontFreetype->getFontBitmapCache();
 
-	if (right_x)
+	LLColor4U quad_color[3];
+	quad_color[QUAD_TEXT] = color;
+	quad_color[QUAD_SHADOW] = LLFontGL::sShadowColor;
+	quad_color[QUAD_SHADOW].mV[VALPHA] = U8(color.mV[VALPHA] * drop_shadow_strength);
+	quad_color[QUAD_SHADOW_SOFT] = LLFontGL::sShadowColor;
+	quad_color[QUAD_SHADOW_SOFT].mV[VALPHA] = U8(color.mV[VALPHA] * drop_shadow_strength * DROP_SHADOW_SOFT_STRENGTH);
+
+	const bool batched = sBatchDepth > 0;
+	const LLVector3 offset(offset_x, offset_y, batched ? sCurDepth : 0.f);
+
+	if (batched)
 	{
-        F32 cr_x = (cur_x - origin.mV[VX]) / sScaleX;
-        if (*right_x < cr_x)
-        {
-            // rightmost edge of previously drawn text, don't draw over previous text
-            *right_x = cr_x;
-        }
+		check_batch_matrices();
 	}
 
-	//FIXME: add underline as glyph?
-	if (style_to_add & UNDERLINE)
+	const S32 GLYPH_BATCH_SIZE = 30;
+	LLVector3 vertices[GLYPH_BATCH_SIZE * 4];
+	LLVector2 uvs[GLYPH_BATCH_SIZE * 4];
+	LLColor4U colors[GLYPH_BATCH_SIZE * 4];
+
+	for (std::vector<GlyphRun::Batch>::const_iterator iter = run.mBatches.begin(); iter != run.mBatches.end(); ++iter)
 	{
-		F32 descender = (F32)llfloor(mFontFreetype->getDescenderHeight());
+		const GlyphRun::Batch& batch = *iter;
+		LLImageGL* font_image = font_bitmap_cache->getImageGL(batch.mBitmapNum);
 
-		gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
-		gGL.begin(LLRender::LINES);
-		gGL.vertex2f(start_x, cur_y - descender);
-		gGL.vertex2f(cur_x, cur_y - descender);
-		gGL.end();
+		if (batched)
+		{
+			LLFontBatchBucket& bucket = get_batch_bucket(font_image);
+			for (S32 q = batch.mFirstQuad; q < batch.mFirstQuad + batch.mNumQuads; ++q)
+			{
+				const LLColor4U& c = quad_color[run.mQuadColors[q]];
+				for (S32 v = q*4; v < q*4+4; ++v)
+				{
+					bucket.mVertices.push_back(run.mVertices[v] + offset);
+					bucket.mUVs.push_back(run.mUVs[v]);
+					bucket.mColors.push_back(c);
+				}
+			}
+			continue;
+		}
+
+		gGL.getTexUnit(0)->bind(font_image);
+
+		S32 q = batch.mFirstQuad;
+		S32 end = batch.mFirstQuad + batch.mNumQuads;
+		while (q < end)
+		{
+			S32 count = llmin(end - q, GLYPH_BATCH_SIZE);
+			for (S32 i = 0; i < count; ++i)
+			{
+				const LLColor4U& c = quad_color[run.mQuadColors[q+i]];
+				for (S32 v = 0; v < 4; ++v)
+				{
+					vertices[i*4+v] = run.mVertices[(q+i)*4+v] + offset;
+					uvs[i*4+v] = run.mUVs[(q+i)*4+v];
+					colors[i*4+v] = c;
+				}
+			}
+
+			gGL.begin(LLRender::QUADS);
+			{
+				gGL.vertexBatchPreTransformed(vertices, uvs, colors, count * 4);
+			}
+			gGL.end();
+
+			q += count;
+		}
 	}
+}
 
-	if (draw_ellipses)
+//static
+void LLFontGL::beginBatch()
+{
+	sBatchDepth++;
+}
+
+//static
+void LLFontGL::endBatch()
+{
+	llassert(sBatchDepth > 0);
+	if (--sBatchDepth <= 0)
 	{
-		
-		// recursively render ellipses at end of string
-		// we've already reserved enough room
-		gGL.pushUIMatrix();
-		renderUTF8(std::string("..."), 
-				0,
-				(cur_x - origin.mV[VX]) / sScaleX, (F32)y,
-				color,
-				LEFT, valign,
-				style_to_add,
-				shadow,
-				S32_MAX, max_pixels,
-				right_x,
-				FALSE); 
-		gGL.popUIMatrix();
+		sBatchDepth = 0;
+		flushBatch();
+	}
+}
+
+//static
+void LLFontGL::flushBatch()
+{
+	if (sBatchBuckets.empty())
+	{
+		return;
 	}
 
-	gGL.popUIMatrix();
+	LL_RECORD_BLOCK_TIME(FTM_RENDER_FONT_BATCH);
 
-	return chars_drawn;
+	U32 matrix_mode = gGL.getMatrixMode();
+	gGL.matrixMode(LLRender::MM_PROJECTION);
+	gGL.pushMatrix();
+	gGL.loadMatrix(sBatchProjection.m);
+	gGL.matrixMode(LLRender::MM_MODELVIEW);
+	gGL.pushMatrix();
+	gGL.loadMatrix(sBatchModelview.m);
+
+	gGL.getTexUnit(0)->enable(LLTexUnit::TT_TEXTURE);
+	gGL.setSceneBlendType(LLRender::BT_ALPHA);
+
+	const S32 BATCH_VERTS = 120;
+
+	for (std::vector<LLFontBatchBucket>::iterator iter = sBatchBuckets.begin(); iter != sBatchBuckets.end(); ++iter)
+	{
+		LLFontBatchBucket& bucket = *iter;
+		gGL.getTexUnit(0)->bind(bucket.mImage);
+
+		S32 total = bucket.mVertices.size();
+		for (S32 i = 0; i < total; i += BATCH_VERTS)
+		{
+			gGL.begin(LLRender::QUADS);
+			{
+				gGL.vertexBatchPreTransformed(&bucket.mVertices[i], &bucket.mUVs[i], &bucket.mColors[i], llmin(BATCH_VERTS, total - i));
+			}
+			gGL.end();
+		}
+		add(sFontBatchDraws, 1);
+	}
+
+	gGL.flush();
+
+	gGL.matrixMode(LLRender::MM_PROJECTION);
+	gGL.popMatrix();
+	gGL.matrixMode(LLRender::MM_MODELVIEW);
+	gGL.popMatrix();
+	gGL.matrixMode(matrix_mode);
+
+	sBatchBuckets.clear();
+}
+
+void LLFontGL::benchmarkLayout(const std::vector<LLWString>& strings, S32 iterations) const
+{
+	if (strings.empty() || iterations <= 0)
+	{
+		return;
+	}
+
+	S32 count = strings.size() * iterations;
+
+	LLTimer timer;
+	{
+		GlyphRun run;
+		for (S32 i = 0; i < iterations; ++i)
+		{
+			for (std::vector<LLWString>::const_iterator iter = strings.begin(); iter != strings.end(); ++iter)
+			{
+				layoutGlyphRun(run, *iter, 0, iter->length(), NORMAL, DROP_SHADOW, S32_MAX, FALSE, 0.f, 0.f);
+			}
+		}
+	}
+	F64 uncached = timer.getElapsedTimeF64();
+
+	U32 cache_size = sGlyphRunCacheSize;
+	sGlyphRunCacheSize = llmax(cache_size, (U32) strings.size());
+	clearGlyphRunCache();
+
+	timer.reset();
+	for (S32 i = 0; i < iterations; ++i)
+	{
+		for (std::vector<LLWString>::const_iterator iter = strings.begin(); iter != strings.end(); ++iter)
+		{
+			getGlyphRun(*iter, 0, iter->length(), NORMAL, DROP_SHADOW, S32_MAX, FALSE, 0.f, 0.f);
+		}
+	}
+	F64 cached = timer.getElapsedTimeF64();
+
+	clearGlyphRunCache();
+	sGlyphRunCacheSize = cache_size;
+
+	LL_INFOS("FontBenchmark") << "Laid out " << strings.size() << " strings x " << iterations << " iterations: "
+		<< (uncached * 1000000.0 / count) << " us/string uncached, "
+		<< (cached * 1000000.0 / count) << " us/string with glyph run cache" << LL_ENDL;
 }
 
 S32 LLFontGL::render(const LLWString &text, S32 begin_offset, F32 x, F32 y, const LLColor4 &color) const
@@ -1154,7 +1537,7 @@ void LLFontGL::renderQuad(LLVector3* vertex_out, LLVector2* uv_out, LLColor4U* c
 	colors_out[index] = color;
 }
 
-void LLFontGL::drawGlyph(S32& glyph_count, LLVector3* vertex_out, LLVector2* uv_out, LLColor4U* colors_out, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4U& color, U8 style, ShadowType shadow, F32 drop_shadow_strength) const
+void LLFontGL::drawGlyph(S32& glyph_count, LLVector3* vertex_out, LLVector2* uv_out, LLColor4U* colors_out, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4U& color, U8 style, ShadowType shadow, F32 drop_shadow_strength, U8* quad_colors_out) const
 {
 	F32 slant_offset;
 	slant_offset = ((style & ITALIC) ? ( -mFontFreetype->getAscenderHeight() * 0.2f) : 0.f);
@@ -1168,6 +1551,7 @@ void LLFontGL::drawGlyph(S32& glyph_count, LLVector3* vertex_out, LLVector2* uv_
 			LLRectf screen_rect_offset = screen_rect;
 
 			screen_rect_offset.translate((F32)(pass * BOLD_OFFSET), 0.f);
+			quad_colors_out[glyph_count] = QUAD_TEXT;
 			renderQuad(&vertex_out[glyph_count * 4], &uv_out[glyph_count * 4], &colors_out[glyph_count * 4], screen_rect_offset, uv_rect, color, slant_offset);
 			glyph_count++;
 		}
@@ -1199,9 +1583,11 @@ void LLFontGL::drawGlyph(S32& glyph_count, LLVector3* vertex_out, LLVector2* uv_
 				break;
 			}
 		
+			quad_colors_out[glyph_count] = QUAD_SHADOW_SOFT;
 			renderQuad(&vertex_out[glyph_count * 4], &uv_out[glyph_count * 4], &colors_out[glyph_count * 4], screen_rect_offset, uv_rect, shadow_color, slant_offset);
 			glyph_count++;
 		}
+		quad_colors_out[glyph_count] = QUAD_TEXT;
 		renderQuad(&vertex_out[glyph_count * 4], &uv_out[glyph_count * 4], &colors_out[glyph_count * 4], screen_rect, uv_rect, color, slant_offset);
 		glyph_count++;
 	}
@@ -1211,13 +1597,16 @@ void LLFontGL::drawGlyph(S32& glyph_count, LLVector3* vertex_out, LLVector2* uv_
 		shadow_color.mV[VALPHA] = U8(color.mV[VALPHA] * drop_shadow_strength);
 		LLRectf screen_rect_shadow = screen_rect;
 		screen_rect_shadow.translate(1.f, -1.f);
+		quad_colors_out[glyph_count] = QUAD_SHADOW;
 		renderQuad(&vertex_out[glyph_count * 4], &uv_out[glyph_count * 4], &colors_out[glyph_count * 4], screen_rect_shadow, uv_rect, shadow_color, slant_offset);
 		glyph_count++;
+		quad_colors_out[glyph_count] = QUAD_TEXT;
 		renderQuad(&vertex_out[glyph_count * 4], &uv_out[glyph_count * 4], &colors_out[glyph_count * 4], screen_rect, uv_rect, color, slant_offset);
 		glyph_count++;
 	}
 	else // normal rendering
 	{
+		quad_colors_out[glyph_count] = QUAD_TEXT;
 		renderQuad(&vertex_out[glyph_count * 4], &uv_out[glyph_count * 4], &colors_out[glyph_count * 4], screen_rect, uv_rect, color, slant_offset);
 		glyph_count++;
 	}
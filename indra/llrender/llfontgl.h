@@ -34,6 +34,8 @@
 #include "llpointer.h"
 #include "llrect.h"
 #include "v2math.h"
+#include "v3math.h"
+#include "v4coloru.h"
 
 class LLColor4;
 // Key used to request a font.
@@ -181,6 +183,27 @@ public:
 	static LLFontGL::VAlign vAlignFromName(const std::string& name);
 
 	static void setFontDisplay(BOOL flag) { sDisplayFont = flag; }
+
+	// Batched submission.  Between beginBatch() and endBatch(), glyph quads from
+	// render() calls are queued per glyph texture and drawn with one bind per
+	// texture at endBatch(), or earlier if the projection or modelview matrix
+	// changes.  Calls may be nested; only the outermost endBatch() draws.
+	// Anything that changes GL state under queued text (shader binds, clip
+	// rects, images drawn in between) must call flushBatch() first.
+	static void beginBatch();
+	static void endBatch();
+	static void flushBatch();
+
+	// Maximum number of laid out strings kept per font, 0 disables the cache
+	static void setGlyphRunCacheSize(U32 size);
+	void clearGlyphRunCache() const;
+
+	// Get glyphs for text that is about to be shown rasterised ahead of time
+	void prefetchGlyphs(const LLWString& wstr) const;
+
+	// Lay out every string iterations times without drawing and log the time
+	// taken with and without the glyph run cache
+	void benchmarkLayout(const std::vector<LLWString>& strings, S32 iterations) const;
 		
 	static LLFontGL* getFontMonospace();
 	static LLFontGL* getFontSansSerifSmall();
@@ -221,8 +244,70 @@ private:
 	LLFontDescriptor mFontDescriptor;
 	LLPointer<LLFontFreetype> mFontFreetype;
 
+	// quad color roles, resolved against the text color when a run is drawn
+	enum EQuadColor
+	{
+		QUAD_TEXT,
+		QUAD_SHADOW,
+		QUAD_SHADOW_SOFT
+	};
+
+	// Everything that affects the layout of one render() call.  Glyph positions
+	// only depend on the fractional part of the pen start position, whole pixel
+	// offsets are applied when the run is drawn.
+	struct GlyphRunKey
+	{
+		LLWString	mText;
+		llwchar		mNextChar;		// kerned against the last glyph
+		U8			mStyle;
+		U8			mShadow;
+		BOOL		mUseEllipses;
+		S32			mMaxPixels;
+		F32			mFracX;
+		F32			mFracY;
+
+		bool operator<(const GlyphRunKey& rhs) const;
+	};
+
+	// Laid out glyph quads, ready to submit
+	struct GlyphRun
+	{
+		struct Batch
+		{
+			S32 mBitmapNum;
+			S32 mFirstQuad;
+			S32 mNumQuads;
+		};
+
+		std::vector<LLVector3>	mVertices;
+		std::vector<LLVector2>	mUVs;
+		std::vector<U8>			mQuadColors;
+		std::vector<Batch>		mBatches;
+		std::vector<S32>		mAtlasSlots;	// glyphs to keep alive while the run is drawn
+		S32		mCharsDrawn;
+		F32		mWidth;			// unscaled width of the whole string
+		F32		mStartX;
+		F32		mEndX;
+		F32		mEndY;
+		BOOL	mDrawEllipses;
+		U32		mLastUsed;
+	};
+
+	typedef std::map<GlyphRunKey, GlyphRun> glyph_run_map_t;
+	mutable glyph_run_map_t mGlyphRuns;
+	mutable U32 mGlyphRunUseCount;
+	mutable U32 mGlyphRunGeneration;	// bitmap cache generation the runs were laid out against
+
+	const GlyphRun& getGlyphRun(const LLWString& wstr, S32 begin_offset, S32 length, U8 style_to_add, ShadowType shadow, S32 scaled_max_pixels, BOOL use_ellipses, F32 frac_x, F32 frac_y) const;
+	void layoutGlyphRun(GlyphRun& run, const LLWString& wstr, S32 begin_offset, S32 length, U8 style_to_add, ShadowType shadow, S32 scaled_max_pixels, BOOL use_ellipses, F32 frac_x, F32 frac_y) const;
+	void submitGlyphRun(const GlyphRun& run, F32 offset_x, F32 offset_y, const LLColor4U& color, F32 drop_shadow_strength) const;
+	void pruneGlyphRuns() const;
+
 	void renderQuad(LLVector3* vertex_out, LLVector2* uv_out, LLColor4U* colors_out, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4U& color, F32 slant_amt) const;
-	void drawGlyph(S32& glyph_count, LLVector3* vertex_out, LLVector2* uv_out, LLColor4U* colors_out, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4U& color, U8 style, ShadowType shadow, F32 drop_shadow_fade) const;
+	void drawGlyph(S32& glyph_count, LLVector3* vertex_out, LLVector2* uv_out, LLColor4U* colors_out, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4U& color, U8 style, ShadowType shadow, F32 drop_shadow_fade, U8* quad_colors_out) const;
+
+	static U32 sGlyphRunCacheSize;
+	static S32 sBatchDepth;
 
 	// Registry holds all instantiated fonts.
 	static LLFontRegistry* sFontRegistry;
@@ -0,0 +1,354 @@
+/**
+ * @file llgeometryfill.cpp
+ * @brief Queue of volume face vertex data writes that can run on worker threads.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llgeometryfill.h"
+
+#include <boost/bind.hpp>
+
+#include "llvolume.h"
+#include "llworkpool.h"
+
+// vertices worth of writes to hand a worker at a time
+static const U32 BATCH_VERTICES = 16384;
+
+// Transform the texture coordinates for this face.
+static void xform4a(LLVector4a &tex_coord, const LLVector4a& trans, const LLVector4Logical& mask, const LLVector4a& rot0, const LLVector4a& rot1, const LLVector4a& offset, const LLVector4a& scale)
+{
+	//tex coord is two coords, <s0, t0, s1, t1>
+	LLVector4a st;
+
+	// Texture transforms are done about the center of the face.
+	st.setAdd(tex_coord, trans);
+
+	// Handle rotation
+	LLVector4a rot_st;
+
+	// <s0 * cosAng, s0*-sinAng, s1*cosAng, s1*-sinAng>
+	LLVector4a s0;
+	s0.splat(st, 0);
+	LLVector4a s1;
+	s1.splat(st, 2);
+	LLVector4a ss;
+	ss.setSelectWithMask(mask, s1, s0);
+
+	LLVector4a a;
+	a.setMul(rot0, ss);
+
+	// <t0*sinAng, t0*cosAng, t1*sinAng, t1*cosAng>
+	LLVector4a t0;
+	t0.splat(st, 1);
+	LLVector4a t1;
+	t1.splat(st, 3);
+	LLVector4a tt;
+	tt.setSelectWithMask(mask, t1, t0);
+
+	LLVector4a b;
+	b.setMul(rot1, tt);
+
+	st.setAdd(a,b);
+
+	// Then scale
+	st.mul(scale);
+
+	// Then offset
+	tex_coord.setAdd(st, offset);
+}
+
+LLGeometryFill::Job::Job(EType type, const LLVolumeFace* face, void* dst)
+:	mFace(face),
+	mDst(dst),
+	mType(type),
+	mValue(0),
+	mDstCount(face->mNumVertices)
+{
+	mMatrix.mMatrix[0].set(1.f, 0.f, 0.f, 0.f);
+	mMatrix.mMatrix[1].set(0.f, 1.f, 0.f, 0.f);
+	mMatrix.mMatrix[2].set(0.f, 0.f, 1.f, 0.f);
+	mMatrix.mMatrix[3].set(0.f, 0.f, 0.f, 1.f);
+	mTexXform[0] = 1.f;
+	mTexXform[1] = 0.f;
+	mTexXform[2] = mTexXform[3] = 0.f;
+	mTexXform[4] = mTexXform[5] = 1.f;
+}
+
+LLGeometryFill::LLGeometryFill()
+{
+}
+
+void LLGeometryFill::add(const Job& job)
+{
+	mJobs.push_back(job);
+}
+
+void LLGeometryFill::run(LLWorkPool* pool)
+{
+	const U32 count = mJobs.size();
+	if (!count)
+	{
+		return;
+	}
+
+	// cut batches between faces once they are big enough, jobs for one
+	// face are queued together and stay together
+	mBatches.clear();
+	mBatches.push_back(0);
+	U32 vertices = 0;
+	for (U32 i = 0; i < count; ++i)
+	{
+		if (vertices >= BATCH_VERTICES && mJobs[i].mFace != mJobs[i - 1].mFace)
+		{
+			mBatches.push_back(i);
+			vertices = 0;
+		}
+		vertices += mJobs[i].mFace->mNumVertices;
+	}
+	mBatches.push_back(count);
+
+	const U32 batches = mBatches.size() - 1;
+	if (pool)
+	{
+		pool->run(batches, boost::bind(&LLGeometryFill::runBatch, this, _1));
+	}
+	else
+	{
+		for (U32 i = 0; i < batches; ++i)
+		{
+			runBatch(i);
+		}
+	}
+
+	mJobs.resize(0);
+}
+
+void LLGeometryFill::runBatch(U32 index)
+{
+	for (U32 i = mBatches[index]; i < mBatches[index + 1]; ++i)
+	{
+		fill(mJobs[i]);
+	}
+}
+
+//static
+void LLGeometryFill::fill(const Job& job)
+{
+	const LLVolumeFace& vf = *job.mFace;
+	const S32 num_vertices = vf.mNumVertices;
+	LLMatrix4a mat = job.mMatrix;
+
+	switch (job.mType)
+	{
+	case INDICES:
+		{
+			const S32 num_indices = vf.mNumIndices;
+			volatile __m128i* dst = (__m128i*) job.mDst;
+			__m128i* src = (__m128i*) vf.mIndices;
+			__m128i offset = _mm_set1_epi16(job.mValue);
+
+			S32 end = num_indices/8;
+
+			for (S32 i = 0; i < end; i++)
+			{
+				__m128i res = _mm_add_epi16(src[i], offset);
+				_mm_storeu_si128((__m128i*) dst++, res);
+			}
+
+			U16* idx = (U16*) dst;
+
+			for (S32 i = end*8; i < num_indices; ++i)
+			{
+				*idx++ = vf.mIndices[i]+job.mValue;
+			}
+		}
+		break;
+
+	case POSITIONS:
+		{
+			llassert(num_vertices > 0);
+
+			LLVector4a* src = vf.mPositions;
+			LLVector4a* end = src+num_vertices;
+
+			F32* dst = (F32*) job.mDst;
+			F32* end_f32 = dst+job.mDstCount*4;
+
+			LLVector4a res0;
+
+			F32 val = 0.f;
+			S32* vp = (S32*) &val;
+			*vp = job.mValue;
+
+			LLVector4Logical mask;
+			mask.clear();
+			mask.setElement<3>();
+
+			LLVector4a texIdx;
+			texIdx.set(0,0,0,val);
+
+			LLVector4a tmp;
+
+			while (src < end)
+			{
+				mat.affineTransform(*src++, res0);
+				tmp.setSelectWithMask(mask, texIdx, res0);
+				tmp.store4a((F32*) dst);
+				dst += 4;
+			}
+
+			while (dst < end_f32)
+			{
+				res0.store4a((F32*) dst);
+				dst += 4;
+			}
+		}
+		break;
+
+	case NORMALS:
+		{
+			F32* normals = (F32*) job.mDst;
+			LLVector4a* src = vf.mNormals;
+			LLVector4a* end = src+num_vertices;
+
+			while (src < end)
+			{
+				LLVector4a normal;
+				mat.rotate(*src++, normal);
+				normal.store4a(normals);
+				normals += 4;
+			}
+		}
+		break;
+
+	case TANGENTS:
+		{
+			F32* tangents = (F32*) job.mDst;
+
+			LLVector4Logical mask;
+			mask.clear();
+			mask.setElement<3>();
+
+			LLVector4a* src = vf.mTangents;
+			LLVector4a* end = vf.mTangents+num_vertices;
+
+			while (src < end)
+			{
+				LLVector4a tangent_out;
+				mat.rotate(*src, tangent_out);
+				tangent_out.normalize3fast();
+				tangent_out.setSelectWithMask(mask, *src, tangent_out);
+				tangent_out.store4a(tangents);
+
+				src++;
+				tangents += 4;
+			}
+		}
+		break;
+
+	case WEIGHTS:
+		LLVector4a::memcpyNonAliased16((F32*) job.mDst, (F32*) vf.mWeights, num_vertices*4*sizeof(F32));
+		break;
+
+	case COLORS:
+		{
+			LLVector4a src;
+
+			U32 vec[4];
+			vec[0] = vec[1] = vec[2] = vec[3] = job.mValue;
+
+			src.loadua((F32*) vec);
+
+			F32* dst = (F32*) job.mDst;
+			S32 num_vecs = num_vertices/4;
+			if (num_vertices%4 > 0)
+			{
+				++num_vecs;
+			}
+
+			for (S32 i = 0; i < num_vecs; i++)
+			{
+				src.store4a(dst);
+				dst += 4;
+			}
+		}
+		break;
+
+	case TEX_COORDS:
+		{
+			S32 tc_size = (num_vertices*2*sizeof(F32)+0xF) & ~0xF;
+			LLVector4a::memcpyNonAliased16((F32*) job.mDst, (F32*) vf.mTexCoords, tc_size);
+		}
+		break;
+
+	case TEX_COORDS_XFORM:
+		{
+			const F32 cos_ang = job.mTexXform[0];
+			const F32 sin_ang = job.mTexXform[1];
+			const F32 os = job.mTexXform[2];
+			const F32 ot = job.mTexXform[3];
+			const F32 ms = job.mTexXform[4];
+			const F32 mt = job.mTexXform[5];
+
+			F32* dst = (F32*) job.mDst;
+			LLVector4a* src = (LLVector4a*) vf.mTexCoords;
+
+			LLVector4a trans;
+			trans.splat(-0.5f);
+
+			LLVector4a rot0;
+			rot0.set(cos_ang, -sin_ang, cos_ang, -sin_ang);
+
+			LLVector4a rot1;
+			rot1.set(sin_ang, cos_ang, sin_ang, cos_ang);
+
+			LLVector4a scale;
+			scale.set(ms, mt, ms, mt);
+
+			LLVector4a offset;
+			offset.set(os+0.5f, ot+0.5f, os+0.5f, ot+0.5f);
+
+			LLVector4Logical mask;
+			mask.clear();
+			mask.setElement<2>();
+			mask.setElement<3>();
+
+			U32 count = num_vertices/2 + num_vertices%2;
+
+			for (S32 i = 0; i < count; i++)
+			{
+				LLVector4a res = *src++;
+				xform4a(res, trans, mask, rot0, rot1, offset, scale);
+				res.store4a(dst);
+				dst += 4;
+			}
+		}
+		break;
+
+	default:
+		llassert(false);
+		break;
+	}
+}
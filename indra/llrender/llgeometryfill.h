@@ -0,0 +1,98 @@
+/**
+ * @file llgeometryfill.h
+ * @brief Queue of volume face vertex data writes that can run on worker threads.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLGEOMETRYFILL_H
+#define LL_LLGEOMETRYFILL_H
+
+#include <vector>
+
+#include "llalignedarray.h"
+#include "llmath.h"
+#include "llmatrix4a.h"
+
+class LLVolumeFace;
+class LLWorkPool;
+
+// The per vertex loops of LLFace::getGeometryVolume(), split from the work
+// of deciding what to write.  Everything a job needs is copied into it and it
+// only reads the volume face and writes the memory it was given, so once the
+// vertex buffers are mapped on the GL thread the jobs of many faces can run
+// side by side, and the buffers are flushed after run() returns.  Has no GL
+// dependencies.
+class LLGeometryFill
+{
+public:
+	enum EType
+	{
+		INDICES = 0,		// U16, offset by mValue
+		POSITIONS,			// transformed by mMatrix, texture index mValue in w, padded to mDstCount
+		NORMALS,			// rotated by mMatrix
+		TANGENTS,			// rotated by mMatrix and normalized, w kept
+		WEIGHTS,			// copied
+		COLORS,				// mValue packed as LLColor4U, for colors and emissive alike
+		TEX_COORDS,			// copied
+		TEX_COORDS_XFORM	// rotated, scaled and offset by mTexXform
+	};
+
+	LL_ALIGN_PREFIX(16)
+	struct Job
+	{
+		Job(EType type, const LLVolumeFace* face, void* dst);
+
+		LLMatrix4a mMatrix;
+		const LLVolumeFace* mFace;
+		void* mDst;
+		U32 mType;
+		U32 mValue;
+		S32 mDstCount;
+		// cos and sin of the rotation, offset s and t, scale s and t
+		F32 mTexXform[6];
+	} LL_ALIGN_POSTFIX(16);
+
+	LLGeometryFill();
+
+	// dst must stay writable until run() returns
+	void add(const Job& job);
+
+	bool empty() const		{ return mJobs.size() == 0; }
+	U32 size() const		{ return mJobs.size(); }
+
+	// Writes everything queued and empties the queue.  With a pool the jobs
+	// are handed out in batches of whole faces, otherwise they run here.
+	void run(LLWorkPool* pool);
+
+	// writes one job's data on the calling thread
+	static void fill(const Job& job);
+
+private:
+	void runBatch(U32 index);
+
+	LLAlignedArray<Job, 64> mJobs;
+	// first job of each batch, then the end of the last
+	std::vector<U32> mBatches;
+};
+
+#endif // LL_LLGEOMETRYFILL_H
@@ -30,6 +30,7 @@
 
 #include "llshadermgr.h"
 #include "llfile.h"
+#include "llfontgl.h"
 #include "llrender.h"
 #include "llvertexbuffer.h"
 
@@ -852,6 +853,7 @@ BOOL LLGLSLShader::link(BOOL suppress_errors)
 
 void LLGLSLShader::bind()
 {
+    LLFontGL::flushBatch();
     gGL.flush();
     if (gGLManager.mHasShaderObjects)
     {
@@ -869,6 +871,7 @@ void LLGLSLShader::bind()
 
 void LLGLSLShader::unbind()
 {
+    LLFontGL::flushBatch();
     gGL.flush();
     if (gGLManager.mHasShaderObjects)
     {
@@ -891,6 +894,7 @@ void LLGLSLShader::unbind()
 
 void LLGLSLShader::bindNoShader(void)
 {
+    LLFontGL::flushBatch();
     LLVertexBuffer::unbind();
     if (gGLManager.mHasShaderObjects)
     {
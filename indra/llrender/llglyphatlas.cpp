@@ -0,0 +1,446 @@
+/** 
+ * @file llglyphatlas.cpp
+ * @brief Skyline packed glyph atlas with LRU eviction.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llglyphatlas.h"
+
+LLGlyphAtlas::LLGlyphAtlas()
+:	mPageWidth(0),
+	mPageHeight(0),
+	mMaxPages(1),
+	mPadding(1),
+	mNumGlyphs(0),
+	mGeneration(0),
+	mEvictionCount(0)
+{
+}
+
+void LLGlyphAtlas::init(S32 page_width, S32 page_height, S32 max_pages, S32 padding)
+{
+	reset();
+	mPageWidth = page_width;
+	mPageHeight = page_height;
+	mPadding = padding;
+	setMaxPages(max_pages);
+}
+
+void LLGlyphAtlas::reset()
+{
+	mPages.clear();
+	mSlots.clear();
+	mFreeSlots.clear();
+	mNumGlyphs = 0;
+	mGeneration++;
+}
+
+void LLGlyphAtlas::setMaxPages(S32 max_pages)
+{
+	mMaxPages = llmax(max_pages, 1);
+}
+
+S32 LLGlyphAtlas::allocate(U32 key, S32 width, S32 height, U32 now, std::vector<U32>& evicted_keys)
+{
+	S32 cell_width = width + mPadding;
+	S32 cell_height = height + mPadding;
+	if (cell_width > mPageWidth - mPadding || cell_height > mPageHeight - mPadding)
+	{
+		return -1;
+	}
+
+	S32 page = -1;
+	S32 x = 0;
+	S32 y = 0;
+	bool found = findFreeRect(cell_width, cell_height, page, x, y);
+
+	for (S32 i = 0; !found && i < (S32)mPages.size(); ++i)
+	{
+		if (findSkyline(i, cell_width, cell_height, x, y))
+		{
+			page = i;
+			found = true;
+		}
+	}
+
+	while (!found)
+	{
+		if ((S32)mPages.size() < mMaxPages || !evictOne(now, evicted_keys))
+		{
+			// under budget, or everything left is in use this frame
+			page = addPage();
+			found = findSkyline(page, cell_width, cell_height, x, y);
+			llassert(found);
+			break;
+		}
+
+		found = findFreeRect(cell_width, cell_height, page, x, y);
+		for (S32 i = 0; !found && i < (S32)mPages.size(); ++i)
+		{
+			if (mPages[i].mNumGlyphs == 0 && findSkyline(i, cell_width, cell_height, x, y))
+			{
+				page = i;
+				found = true;
+			}
+		}
+	}
+
+	S32 index = newSlot();
+	Slot& slot = mSlots[index];
+	slot.mKey = key;
+	slot.mLastUsed = now;
+	slot.mPage = page;
+	slot.mX = x;
+	slot.mY = y;
+	slot.mCellX = x;
+	slot.mCellY = y;
+	slot.mCellWidth = cell_width;
+	slot.mCellHeight = cell_height;
+	slot.mInUse = true;
+	slot.mPinned = false;
+
+	mPages[page].mNumGlyphs++;
+	mNumGlyphs++;
+	return index;
+}
+
+void LLGlyphAtlas::release(S32 index)
+{
+	Slot& slot = mSlots[index];
+	if (!slot.mInUse)
+	{
+		return;
+	}
+
+	Page& page = mPages[slot.mPage];
+	slot.mInUse = false;
+	mFreeSlots.push_back(index);
+	mNumGlyphs--;
+
+	if (--page.mNumGlyphs == 0)
+	{
+		resetPage(page);
+		return;
+	}
+
+	FreeRect rect;
+	rect.mX = slot.mCellX;
+	rect.mY = slot.mCellY;
+	rect.mWidth = slot.mCellWidth;
+	rect.mHeight = slot.mCellHeight;
+
+	// merge with neighbours that share a whole edge, so a row of evicted
+	// glyphs can take a wider one
+	bool merged = true;
+	while (merged)
+	{
+		merged = false;
+		for (U32 i = 0; i < page.mFreeRects.size(); ++i)
+		{
+			FreeRect& other = page.mFreeRects[i];
+			if (other.mY == rect.mY && other.mHeight == rect.mHeight
+				&& (other.mX + other.mWidth == rect.mX || rect.mX + rect.mWidth == other.mX))
+			{
+				rect.mX = llmin(rect.mX, other.mX);
+				rect.mWidth += other.mWidth;
+			}
+			else if (other.mX == rect.mX && other.mWidth == rect.mWidth
+				&& (other.mY + other.mHeight == rect.mY || rect.mY + rect.mHeight == other.mY))
+			{
+				rect.mY = llmin(rect.mY, other.mY);
+				rect.mHeight += other.mHeight;
+			}
+			else
+			{
+				continue;
+			}
+			page.mFreeRects[i] = page.mFreeRects.back();
+			page.mFreeRects.pop_back();
+			merged = true;
+			break;
+		}
+	}
+	page.mFreeRects.push_back(rect);
+}
+
+F32 LLGlyphAtlas::getOccupancy() const
+{
+	if (mPages.empty())
+	{
+		return 0.f;
+	}
+
+	F64 used = 0.0;
+	for (std::vector<Slot>::const_iterator iter = mSlots.begin(); iter != mSlots.end(); ++iter)
+	{
+		if (iter->mInUse)
+		{
+			used += iter->mCellWidth * iter->mCellHeight;
+		}
+	}
+	return (F32)(used / ((F64)mPageWidth * mPageHeight * mPages.size()));
+}
+
+bool LLGlyphAtlas::validate() const
+{
+	for (U32 i = 0; i < mSlots.size(); ++i)
+	{
+		const Slot& a = mSlots[i];
+		if (!a.mInUse)
+		{
+			continue;
+		}
+		if (a.mPage < 0 || a.mPage >= (S32)mPages.size()
+			|| a.mCellX < 0 || a.mCellY < 0
+			|| a.mCellX + a.mCellWidth > mPageWidth
+			|| a.mCellY + a.mCellHeight > mPageHeight)
+		{
+			return false;
+		}
+		for (U32 j = i + 1; j < mSlots.size(); ++j)
+		{
+			const Slot& b = mSlots[j];
+			if (b.mInUse && b.mPage == a.mPage
+				&& a.mCellX < b.mCellX + b.mCellWidth && b.mCellX < a.mCellX + a.mCellWidth
+				&& a.mCellY < b.mCellY + b.mCellHeight && b.mCellY < a.mCellY + a.mCellHeight)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Best fitting free rect over all pages, split guillotine style.
+bool LLGlyphAtlas::findFreeRect(S32 width, S32 height, S32& page, S32& x, S32& y)
+{
+	S32 best_page = -1;
+	U32 best_index = 0;
+	S32 best_waste = S32_MAX;
+
+	for (S32 p = 0; p < (S32)mPages.size(); ++p)
+	{
+		const std::vector<FreeRect>& rects = mPages[p].mFreeRects;
+		for (U32 i = 0; i < rects.size(); ++i)
+		{
+			const FreeRect& rect = rects[i];
+			if (rect.mWidth >= width && rect.mHeight >= height)
+			{
+				S32 waste = rect.mWidth * rect.mHeight - width * height;
+				if (waste < best_waste)
+				{
+					best_waste = waste;
+					best_page = p;
+					best_index = i;
+				}
+			}
+		}
+	}
+
+	if (best_page < 0)
+	{
+		return false;
+	}
+
+	std::vector<FreeRect>& rects = mPages[best_page].mFreeRects;
+	FreeRect rect = rects[best_index];
+	rects[best_index] = rects.back();
+	rects.pop_back();
+
+	page = best_page;
+	x = rect.mX;
+	y = rect.mY;
+
+	// keep the leftover to the right at the glyph's height, and the full
+	// width above it
+	if (rect.mWidth > width)
+	{
+		FreeRect right = { rect.mX + width, rect.mY, rect.mWidth - width, height };
+		rects.push_back(right);
+	}
+	if (rect.mHeight > height)
+	{
+		FreeRect top = { rect.mX, rect.mY + height, rect.mWidth, rect.mHeight - height };
+		rects.push_back(top);
+	}
+	return true;
+}
+
+// Bottom-left skyline placement: lowest resulting top edge, then narrowest node.
+bool LLGlyphAtlas::findSkyline(S32 page_index, S32 width, S32 height, S32& x, S32& y)
+{
+	Page& page = mPages[page_index];
+	S32 best_index = -1;
+	S32 best_top = S32_MAX;
+	S32 best_width = S32_MAX;
+
+	for (U32 i = 0; i < page.mSkyline.size(); ++i)
+	{
+		S32 node_y = fitSkyline(page, i, width, height);
+		if (node_y >= 0)
+		{
+			S32 top = node_y + height;
+			if (top < best_top || (top == best_top && page.mSkyline[i].mWidth < best_width))
+			{
+				best_index = i;
+				best_top = top;
+				best_width = page.mSkyline[i].mWidth;
+				x = page.mSkyline[i].mX;
+				y = node_y;
+			}
+		}
+	}
+
+	if (best_index < 0)
+	{
+		return false;
+	}
+
+	addSkylineLevel(page, best_index, x, y, width, height);
+	return true;
+}
+
+// Height a width x height rect would sit at if placed at skyline node index,
+// or -1 if it runs off the page.
+S32 LLGlyphAtlas::fitSkyline(const Page& page, U32 index, S32 width, S32 height) const
+{
+	S32 x = page.mSkyline[index].mX;
+	if (x + width > mPageWidth)
+	{
+		return -1;
+	}
+
+	S32 width_left = width;
+	S32 y = page.mSkyline[index].mY;
+	while (width_left > 0)
+	{
+		if (index >= page.mSkyline.size())
+		{
+			return -1;
+		}
+		y = llmax(y, page.mSkyline[index].mY);
+		if (y + height > mPageHeight)
+		{
+			return -1;
+		}
+		width_left -= page.mSkyline[index].mWidth;
+		++index;
+	}
+	return y;
+}
+
+void LLGlyphAtlas::addSkylineLevel(Page& page, U32 index, S32 x, S32 y, S32 width, S32 height)
+{
+	SkylineNode node = { x, y + height, width };
+	page.mSkyline.insert(page.mSkyline.begin() + index, node);
+
+	// trim or drop the nodes now covered by the new one
+	for (U32 i = index + 1; i < page.mSkyline.size(); )
+	{
+		SkylineNode& prev = page.mSkyline[i - 1];
+		SkylineNode& cur = page.mSkyline[i];
+		if (cur.mX >= prev.mX + prev.mWidth)
+		{
+			break;
+		}
+
+		S32 shrink = prev.mX + prev.mWidth - cur.mX;
+		cur.mX += shrink;
+		cur.mWidth -= shrink;
+		if (cur.mWidth > 0)
+		{
+			break;
+		}
+		page.mSkyline.erase(page.mSkyline.begin() + i);
+	}
+
+	// merge neighbours at the same height
+	for (U32 i = 0; i + 1 < page.mSkyline.size(); )
+	{
+		if (page.mSkyline[i].mY == page.mSkyline[i + 1].mY)
+		{
+			page.mSkyline[i].mWidth += page.mSkyline[i + 1].mWidth;
+			page.mSkyline.erase(page.mSkyline.begin() + i + 1);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+void LLGlyphAtlas::resetPage(Page& page)
+{
+	page.mSkyline.clear();
+	page.mFreeRects.clear();
+	SkylineNode node = { mPadding, mPadding, mPageWidth - mPadding };
+	page.mSkyline.push_back(node);
+	page.mNumGlyphs = 0;
+}
+
+S32 LLGlyphAtlas::addPage()
+{
+	mPages.push_back(Page());
+	resetPage(mPages.back());
+	return (S32)mPages.size() - 1;
+}
+
+// Evict the least recently used glyph that was not touched this frame.
+bool LLGlyphAtlas::evictOne(U32 now, std::vector<U32>& evicted_keys)
+{
+	S32 oldest = -1;
+	for (U32 i = 0; i < mSlots.size(); ++i)
+	{
+		const Slot& slot = mSlots[i];
+		if (slot.mInUse && !slot.mPinned && slot.mLastUsed != now
+			&& (oldest < 0 || slot.mLastUsed < mSlots[oldest].mLastUsed))
+		{
+			oldest = i;
+		}
+	}
+
+	if (oldest < 0)
+	{
+		return false;
+	}
+
+	evicted_keys.push_back(mSlots[oldest].mKey);
+	release(oldest);
+	mGeneration++;
+	mEvictionCount++;
+	return true;
+}
+
+S32 LLGlyphAtlas::newSlot()
+{
+	if (!mFreeSlots.empty())
+	{
+		S32 index = mFreeSlots.back();
+		mFreeSlots.pop_back();
+		return index;
+	}
+	mSlots.push_back(Slot());
+	return (S32)mSlots.size() - 1;
+}
@@ -0,0 +1,142 @@
+/** 
+ * @file llglyphatlas.h
+ * @brief Skyline packed glyph atlas with LRU eviction.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLGLYPHATLAS_H
+#define LL_LLGLYPHATLAS_H
+
+#include <vector>
+
+// Rectangle allocator behind LLFontBitmapCache.  Knows nothing about GL or
+// FreeType so it can be exercised by unit tests.
+//
+// Each page is packed with a skyline (bottom-left) allocator.  Space given
+// back by evicted glyphs goes onto a per-page free list that is searched
+// before the skyline, and a page whose last glyph is evicted is reset.
+// Once mMaxPages pages exist, the least recently used glyphs are evicted one
+// at a time until the new glyph fits.  Glyphs used during the current frame
+// and pinned glyphs are never evicted; if nothing else can go, the atlas
+// grows past its budget rather than pulling a glyph out from under a draw.
+class LLGlyphAtlas
+{
+public:
+	struct Slot
+	{
+		U32 mKey;
+		U32 mLastUsed;
+		S32 mPage;
+		// Glyph origin inside the page
+		S32 mX;
+		S32 mY;
+		// Cell reserved for the glyph, padding included
+		S32 mCellX;
+		S32 mCellY;
+		S32 mCellWidth;
+		S32 mCellHeight;
+		bool mInUse;
+		bool mPinned;
+	};
+
+	LLGlyphAtlas();
+
+	void init(S32 page_width, S32 page_height, S32 max_pages, S32 padding = 1);
+	void reset();
+
+	// Takes effect for the next allocation; existing pages past the new budget
+	// drain as their glyphs are evicted.
+	void setMaxPages(S32 max_pages);
+
+	// Reserve room for a width x height glyph, returning its slot index or -1
+	// if it can never fit in a page.  Keys of glyphs evicted to make room are
+	// appended to evicted_keys.  now is the caller's frame number.
+	S32 allocate(U32 key, S32 width, S32 height, U32 now, std::vector<U32>& evicted_keys);
+	void release(S32 slot);
+
+	void touch(S32 slot, U32 now)				{ mSlots[slot].mLastUsed = now; }
+	void pin(S32 slot)							{ mSlots[slot].mPinned = true; }
+
+	const Slot& getSlot(S32 slot) const			{ return mSlots[slot]; }
+	S32 getNumPages() const						{ return (S32)mPages.size(); }
+	S32 getMaxPages() const						{ return mMaxPages; }
+	S32 getPageWidth() const					{ return mPageWidth; }
+	S32 getPageHeight() const					{ return mPageHeight; }
+	S32 getNumGlyphs() const					{ return mNumGlyphs; }
+
+	// Incremented whenever a glyph is evicted, so cached texture coordinates
+	// can be thrown away.
+	U32 getGeneration() const					{ return mGeneration; }
+	U32 getEvictionCount() const				{ return mEvictionCount; }
+
+	// Fraction of the allocated pages covered by live glyph cells
+	F32 getOccupancy() const;
+
+	// Debug check that no two live cells overlap and all are inside their page
+	bool validate() const;
+
+private:
+	struct SkylineNode
+	{
+		S32 mX;
+		S32 mY;
+		S32 mWidth;
+	};
+
+	struct FreeRect
+	{
+		S32 mX;
+		S32 mY;
+		S32 mWidth;
+		S32 mHeight;
+	};
+
+	struct Page
+	{
+		std::vector<SkylineNode> mSkyline;
+		std::vector<FreeRect> mFreeRects;
+		S32 mNumGlyphs;
+	};
+
+	bool findFreeRect(S32 width, S32 height, S32& page, S32& x, S32& y);
+	bool findSkyline(S32 page, S32 width, S32 height, S32& x, S32& y);
+	S32 fitSkyline(const Page& page, U32 index, S32 width, S32 height) const;
+	void addSkylineLevel(Page& page, U32 index, S32 x, S32 y, S32 width, S32 height);
+	void resetPage(Page& page);
+	S32 addPage();
+	bool evictOne(U32 now, std::vector<U32>& evicted_keys);
+	S32 newSlot();
+
+	S32 mPageWidth;
+	S32 mPageHeight;
+	S32 mMaxPages;
+	S32 mPadding;
+	S32 mNumGlyphs;
+	U32 mGeneration;
+	U32 mEvictionCount;
+	std::vector<Page> mPages;
+	std::vector<Slot> mSlots;
+	std::vector<S32> mFreeSlots;
+};
+
+#endif // LL_LLGLYPHATLAS_H
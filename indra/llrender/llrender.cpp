@@ -47,9 +47,16 @@ S32	gGLViewport[4];
 
 U32 LLRender::sUICalls = 0;
 U32 LLRender::sUIVerts = 0;
+U32 LLRender::sUIBatchedDraws = 0;
 U32 LLTexUnit::sWhiteTexture = 0;
 bool LLRender::sGLCoreProfile = false;
 
+static LLTrace::CountStatHandle<> sUIDrawCalls("ui_draw_calls", "Immediate mode draw calls made in UI coordinates");
+static LLTrace::CountStatHandle<> sUIDrawsBatched("ui_draws_batched", "UI draws queued for merging by the UI batch");
+
+// vertices per draw when replaying the UI batch, a multiple of 2, 3 and 4
+static const U32 UI_BATCH_CHUNK = 2040;
+
 static const U32 LL_NUM_TEXTURE_LAYERS = 32; 
 static const U32 LL_NUM_LIGHT_UNITS = 8;
 
@@ -227,7 +234,7 @@ bool LLTexUnit::bind(LLTexture* texture, bool for_rendering, bool forceBind)
 	stop_glerror();
 	if (mIndex >= 0)
 	{
-		gGL.flush();
+		gGL.deferFlush();
 
 		LLImageGL* gl_tex = NULL ;
 
@@ -302,7 +309,7 @@ bool LLTexUnit::bind(LLImageGL* texture, bool for_rendering, bool forceBind)
 
 	if ((mCurrTexture != texture->getTexName()) || forceBind)
 	{
-		gGL.flush();
+		gGL.deferFlush();
 		stop_glerror();
 		activate();
 		stop_glerror();
@@ -400,7 +407,7 @@ bool LLTexUnit::bindManual(eTextureType type, U32 texture, bool hasMips)
 	
 	if(mCurrTexture != texture)
 	{
-		gGL.flush();
+		gGL.deferFlush();
 		
 		activate();
 		enable(type);
@@ -419,7 +426,7 @@ void LLTexUnit::unbind(eTextureType type)
 
 	//always flush and activate for consistency 
 	//   some code paths assume unbind always flushes and sets the active texture
-	gGL.flush();
+	gGL.deferFlush();
 	activate();
 
 	// Disabled caching of binding state.
@@ -1024,7 +1031,9 @@ LLRender::LLRender()
 	mQuadCycle(0),
     mMode(LLRender::TRIANGLES),
     mCurrTextureUnitIndex(0),
-    mMaxAnisotropy(0.f) 
+    mMaxAnisotropy(0.f),
+	mUIBatchDepth(0),
+	mUIBatchReplaying(false)
 {	
 	mTexUnits.reserve(LL_NUM_TEXTURE_LAYERS);
 	for (U32 i = 0; i < LL_NUM_TEXTURE_LAYERS; i++)
@@ -1082,6 +1091,7 @@ void LLRender::init()
 	llassert_always(mBuffer.isNull()) ;
 	stop_glerror();
 	mBuffer = new LLVertexBuffer(immediate_mask, 0);
+	mBuffer->setUseStreamRing(true);
 	mBuffer->allocateBuffer(4096, 0, TRUE);
 	mBuffer->getVertexStrider(mVerticesp);
 	mBuffer->getTexCoord0Strider(mTexcoordsp);
@@ -1684,11 +1694,12 @@ void LLRender::blendFunc(eBlendFactor sfactor, eBlendFactor dfactor)
 	if (mCurrBlendColorSFactor != sfactor || mCurrBlendColorDFactor != dfactor ||
 	    mCurrBlendAlphaSFactor != sfactor || mCurrBlendAlphaDFactor != dfactor)
 	{
+		// queued draws are recorded with the current blend func, so flush first
+		deferFlush();
 		mCurrBlendColorSFactor = sfactor;
 		mCurrBlendAlphaSFactor = sfactor;
 		mCurrBlendColorDFactor = dfactor;
 		mCurrBlendAlphaDFactor = dfactor;
-		flush();
 		glBlendFunc(sGLBlendFactor[sfactor], sGLBlendFactor[dfactor]);
 	}
 }
@@ -1709,11 +1720,12 @@ void LLRender::blendFunc(eBlendFactor color_sfactor, eBlendFactor color_dfactor,
 	if (mCurrBlendColorSFactor != color_sfactor || mCurrBlendColorDFactor != color_dfactor ||
 	    mCurrBlendAlphaSFactor != alpha_sfactor || mCurrBlendAlphaDFactor != alpha_dfactor)
 	{
+		// queued draws are recorded with the current blend func, so flush first
+		deferFlush();
 		mCurrBlendColorSFactor = color_sfactor;
 		mCurrBlendAlphaSFactor = alpha_sfactor;
 		mCurrBlendColorDFactor = color_dfactor;
 		mCurrBlendAlphaDFactor = alpha_dfactor;
-		flush();
 		glBlendFuncSeparateEXT(sGLBlendFactor[color_sfactor], sGLBlendFactor[color_dfactor],
 				       sGLBlendFactor[alpha_sfactor], sGLBlendFactor[alpha_dfactor]);
 	}
@@ -1790,7 +1802,7 @@ void LLRender::begin(const GLuint& mode)
 			mMode == LLRender::TRIANGLES ||
 			mMode == LLRender::POINTS)
 		{
-			flush();
+			deferFlush();
 		}
 		else if (mCount != 0)
 		{
@@ -1814,12 +1826,217 @@ void LLRender::end()
 		mMode != LLRender::TRIANGLES &&
 		mMode != LLRender::POINTS) ||
 		mCount > 2048)
+	{
+		deferFlush();
+	}
+}
+
+void LLRender::beginUIBatch()
+{
+	if (mUIBatchDepth++ == 0)
 	{
 		flush();
 	}
 }
+
+void LLRender::endUIBatch()
+{
+	llassert(mUIBatchDepth > 0);
+	if (mUIBatchDepth > 0 && --mUIBatchDepth == 0)
+	{
+		flush();
+	}
+}
+
+bool LLRender::canDefer() const
+{
+	if (mUIBatchDepth == 0 || mUIBatchReplaying || mUIOffset.empty())
+	{
+		return false;
+	}
+
+	if (mMode != LLRender::QUADS &&
+		mMode != LLRender::TRIANGLES &&
+		mMode != LLRender::LINES &&
+		mMode != LLRender::POINTS)
+	{
+		return false;
+	}
+
+	// only unit 0 is restored between groups, anything using other units has to
+	// go through flush()
+	return mCurrTextureUnitIndex == 0 && mTexUnits[0]->mCurrTexType == LLTexUnit::TT_TEXTURE;
+}
+
+void LLRender::deferFlush()
+{
+	if (!canDefer())
+	{
+		flush();
+		return;
+	}
+
+	if (mCount == 0)
+	{
+		return;
+	}
+
+	U32 count = mCount;
+	U32 mode = mMode;
+	if (mMode == LLRender::QUADS && sGLCoreProfile)
+	{ //already converted to triangles by vertex3f
+		mode = LLRender::TRIANGLES;
+		mQuadCycle = 1;
+	}
+
+	switch (mode)
+	{
+		case LLRender::QUADS: count -= count % 4; break;
+		case LLRender::TRIANGLES: count -= count % 3; break;
+		case LLRender::LINES: count -= count % 2; break;
+	}
+
+	if (count > 0)
+	{
+		LLRenderBatch::State state;
+		state.mMode = mode;
+		state.mTextureType = mTexUnits[0]->mCurrTexType;
+		state.mTexture = mTexUnits[0]->mCurrTexture;
+		state.mBlendColorSFactor = mCurrBlendColorSFactor;
+		state.mBlendColorDFactor = mCurrBlendColorDFactor;
+		state.mBlendAlphaSFactor = mCurrBlendAlphaSFactor;
+		state.mBlendAlphaDFactor = mCurrBlendAlphaDFactor;
+
+		// lines and points are rasterized past their vertices
+		F32 pad = (mode == LLRender::LINES || mode == LLRender::POINTS) ? 2.f : 0.f;
+		mUIBatch.addDraw(state, mVerticesp, mTexcoordsp, mColorsp, count, pad);
+
+		sUIBatchedDraws++;
+		add(sUIDrawsBatched, 1);
+	}
+
+	mVerticesp[0] = mVerticesp[count];
+	mTexcoordsp[0] = mTexcoordsp[count];
+	mColorsp[0] = mColorsp[count];
+
+	mCount = 0;
+}
+
+void LLRender::flushUIBatch()
+{
+	if (mUIBatch.empty() || mUIBatchReplaying)
+	{
+		return;
+	}
+
+	mUIBatchReplaying = true;
+
+	LLRenderBatch::group_list_t groups;
+	mUIBatch.swapGroups(groups);
+	mUIBatch.clear();
+
+	// set aside vertices that are still being specified, including the
+	// trailing copy that carries the current color and texture coordinate
+	U32 pending = mCount;
+	std::vector<LLVector3> pending_verts(pending + 1);
+	std::vector<LLVector2> pending_uvs(pending + 1);
+	std::vector<LLColor4U> pending_colors(pending + 1);
+	for (U32 i = 0; i <= pending; ++i)
+	{
+		pending_verts[i] = mVerticesp[i];
+		pending_uvs[i] = mTexcoordsp[i];
+		pending_colors[i] = mColorsp[i];
+	}
+	mCount = 0;
+
+	U32 saved_mode = mMode;
+	U32 saved_quad_cycle = mQuadCycle;
+	U32 saved_unit = mCurrTextureUnitIndex;
+	LLTexUnit* unit = mTexUnits[0];
+	LLTexUnit::eTextureType saved_type = unit->mCurrTexType;
+	U32 saved_texture = unit->mCurrTexture;
+	eBlendFactor saved_blend[] = { mCurrBlendColorSFactor, mCurrBlendColorDFactor,
+								   mCurrBlendAlphaSFactor, mCurrBlendAlphaDFactor };
+
+	for (LLRenderBatch::group_list_t::iterator iter = groups.begin(); iter != groups.end(); ++iter)
+	{
+		const LLRenderBatch::State& state = iter->mState;
+		LLTexUnit::eTextureType type = (LLTexUnit::eTextureType) state.mTextureType;
+		if (state.mTexture)
+		{
+			unit->bindManual(type, state.mTexture);
+		}
+		else
+		{
+			unit->unbind(type);
+		}
+
+		if (state.mBlendColorSFactor < BF_UNDEF)
+		{
+			blendFunc((eBlendFactor) state.mBlendColorSFactor, (eBlendFactor) state.mBlendColorDFactor,
+					  (eBlendFactor) state.mBlendAlphaSFactor, (eBlendFactor) state.mBlendAlphaDFactor);
+		}
+
+		mMode = state.mMode;
+
+		U32 total = iter->mVertices.size();
+		for (U32 start = 0; start < total; start += UI_BATCH_CHUNK)
+		{
+			U32 count = llmin(total - start, UI_BATCH_CHUNK);
+			for (U32 i = 0; i < count; ++i)
+			{
+				mVerticesp[i] = iter->mVertices[start + i];
+				mTexcoordsp[i] = iter->mTexCoords[start + i];
+				mColorsp[i] = iter->mColors[start + i];
+			}
+			mVerticesp[count] = mVerticesp[count - 1];
+			mTexcoordsp[count] = mTexcoordsp[count - 1];
+			mColorsp[count] = mColorsp[count - 1];
+			mCount = count;
+			flush();
+		}
+	}
+
+	// put back the state the caller last set
+	if (saved_type == LLTexUnit::TT_NONE)
+	{
+		unit->disable();
+	}
+	else if (saved_texture)
+	{
+		unit->bindManual(saved_type, saved_texture);
+	}
+	else
+	{
+		unit->unbind(saved_type);
+	}
+
+	if (saved_blend[0] < BF_UNDEF)
+	{
+		blendFunc(saved_blend[0], saved_blend[1], saved_blend[2], saved_blend[3]);
+	}
+
+	mTexUnits[saved_unit]->activate();
+
+	mMode = saved_mode;
+	mQuadCycle = saved_quad_cycle;
+	for (U32 i = 0; i <= pending; ++i)
+	{
+		mVerticesp[i] = pending_verts[i];
+		mTexcoordsp[i] = pending_uvs[i];
+		mColorsp[i] = pending_colors[i];
+	}
+	mCount = pending;
+
+	mUIBatchReplaying = false;
+}
+
 void LLRender::flush()
 {
+	// whatever called flush() changes state the UI batch cannot restore, so
+	// everything queued has to be drawn first
+	flushUIBatch();
+
 	if (mCount > 0)
 	{
 #if 0
@@ -1868,6 +2085,7 @@ void LLRender::flush()
 		{
 			sUICalls++;
 			sUIVerts += mCount;
+			add(sUIDrawCalls, 1);
 		}
 		
 		//store mCount in a local variable to avoid re-entrance (drawArrays may call flush)
@@ -1937,10 +2155,10 @@ void LLRender::vertex3f(const GLfloat& x, const GLfloat& y, const GLfloat& z)
 	{ //break when buffer gets reasonably full to keep GL command buffers happy and avoid overflow below
 		switch (mMode)
 		{
-			case LLRender::POINTS: flush(); break;
-			case LLRender::TRIANGLES: if (mCount%3==0) flush(); break;
-			case LLRender::QUADS: if(mCount%4 == 0) flush(); break; 
-			case LLRender::LINES: if (mCount%2 == 0) flush(); break;
+			case LLRender::POINTS: deferFlush(); break;
+			case LLRender::TRIANGLES: if (mCount%3==0) deferFlush(); break;
+			case LLRender::QUADS: if(mCount%4 == 0) deferFlush(); break; 
+			case LLRender::LINES: if (mCount%2 == 0) deferFlush(); break;
 		}
 	}
 			
@@ -42,6 +42,7 @@
 #include "llpointer.h"
 #include "llglheaders.h"
 #include "llmatrix4a.h"
+#include "llrenderbatch.h"
 #include "glh/glh_linear.h"
 
 class LLVertexBuffer;
@@ -372,6 +373,18 @@ public:
 
 	void flush();
 
+	// Deferred 2D batching.  While a UI batch is open, draws in UI coordinates
+	// are queued rather than flushed when only the unit 0 texture, blend
+	// function or primitive type changes.  Any other state change, and the
+	// outermost endUIBatch(), replays the queue merged by state in painter's
+	// order.  Calls may be nested.
+	void beginUIBatch();
+	void endUIBatch();
+	// Draw anything queued by the UI batch now
+	void flushUIBatch();
+	// Use in place of flush() before changing state the UI batch can restore
+	void deferFlush();
+
 	void begin(const GLuint& mode);
 	void end();
 	void vertex2i(const GLint& x, const GLint& y);
@@ -437,11 +450,14 @@ public:
 public:
 	static U32 sUICalls;
 	static U32 sUIVerts;
+	static U32 sUIBatchedDraws;
 	static bool sGLCoreProfile;
 	
 private:
 	friend class LLLightState;
 
+	bool canDefer() const;
+
 	U32 mMatrixMode;
 	U32 mMatIdx[NUM_MATRIX_MODES];
 	U32 mMatHash[NUM_MATRIX_MODES];
@@ -477,6 +493,9 @@ private:
 	std::vector<LLVector3> mUIOffset;
 	std::vector<LLVector3> mUIScale;
 
+	LLRenderBatch	mUIBatch;
+	S32				mUIBatchDepth;
+	bool			mUIBatchReplaying;
 };
 
 extern F32 gGLModelView[16];
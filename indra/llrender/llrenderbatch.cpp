@@ -0,0 +1,136 @@
+/** 
+ * @file llrenderbatch.cpp
+ * @brief Deferred, state sorted batching of immediate mode 2D draws.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llrenderbatch.h"
+
+// How many groups back a draw may be moved to find one with its state
+const U32 MAX_MERGE_DISTANCE = 32;
+
+bool LLRenderBatch::State::operator==(const State& rhs) const
+{
+	return mMode == rhs.mMode
+		&& mTexture == rhs.mTexture
+		&& mTextureType == rhs.mTextureType
+		&& mBlendColorSFactor == rhs.mBlendColorSFactor
+		&& mBlendColorDFactor == rhs.mBlendColorDFactor
+		&& mBlendAlphaSFactor == rhs.mBlendAlphaSFactor
+		&& mBlendAlphaDFactor == rhs.mBlendAlphaDFactor;
+}
+
+LLRenderBatch::LLRenderBatch()
+:	mNumDraws(0)
+{
+}
+
+void LLRenderBatch::clear()
+{
+	mGroups.clear();
+	mNumDraws = 0;
+}
+
+//static
+bool LLRenderBatch::overlaps(const Group& group, F32 min_x, F32 min_y, F32 max_x, F32 max_y)
+{
+	// touching edges do not count, quads that share an edge never share a pixel
+	return min_x < group.mMaxX && group.mMinX < max_x
+		&& min_y < group.mMaxY && group.mMinY < max_y;
+}
+
+void LLRenderBatch::addDraw(const State& state, LLStrider<LLVector3> vertices, LLStrider<LLVector2> tex_coords, LLStrider<LLColor4U> colors, U32 count, F32 pad)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	mNumDraws++;
+
+	F32 min_x = vertices[0].mV[VX];
+	F32 min_y = vertices[0].mV[VY];
+	F32 max_x = min_x;
+	F32 max_y = min_y;
+	for (U32 i = 1; i < count; ++i)
+	{
+		min_x = llmin(min_x, vertices[i].mV[VX]);
+		min_y = llmin(min_y, vertices[i].mV[VY]);
+		max_x = llmax(max_x, vertices[i].mV[VX]);
+		max_y = llmax(max_y, vertices[i].mV[VY]);
+	}
+	min_x -= pad;
+	min_y -= pad;
+	max_x += pad;
+	max_y += pad;
+
+	// walk back to the latest group with the same state, giving up at the
+	// first group in between that this draw would have to be moved under
+	Group* target = NULL;
+	U32 distance = 0;
+	for (group_list_t::reverse_iterator iter = mGroups.rbegin();
+		 iter != mGroups.rend() && distance < MAX_MERGE_DISTANCE;
+		 ++iter, ++distance)
+	{
+		if (iter->mState == state)
+		{
+			target = &(*iter);
+			break;
+		}
+		if (overlaps(*iter, min_x, min_y, max_x, max_y))
+		{
+			break;
+		}
+	}
+
+	if (!target)
+	{
+		mGroups.push_back(Group());
+		target = &mGroups.back();
+		target->mState = state;
+		target->mMinX = min_x;
+		target->mMinY = min_y;
+		target->mMaxX = max_x;
+		target->mMaxY = max_y;
+	}
+	else
+	{
+		target->mMinX = llmin(target->mMinX, min_x);
+		target->mMinY = llmin(target->mMinY, min_y);
+		target->mMaxX = llmax(target->mMaxX, max_x);
+		target->mMaxY = llmax(target->mMaxY, max_y);
+	}
+
+	// the striders may be interleaved, copy element by element
+	target->mVertices.reserve(target->mVertices.size() + count);
+	target->mTexCoords.reserve(target->mTexCoords.size() + count);
+	target->mColors.reserve(target->mColors.size() + count);
+	for (U32 i = 0; i < count; ++i)
+	{
+		target->mVertices.push_back(vertices[i]);
+		target->mTexCoords.push_back(tex_coords[i]);
+		target->mColors.push_back(colors[i]);
+	}
+}
@@ -0,0 +1,93 @@
+/** 
+ * @file llrenderbatch.h
+ * @brief Deferred, state sorted batching of immediate mode 2D draws.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLRENDERBATCH_H
+#define LL_LLRENDERBATCH_H
+
+#include <vector>
+
+#include "llstrider.h"
+#include "v2math.h"
+#include "v3math.h"
+#include "v4coloru.h"
+
+// Queue of immediate mode draws that LLRender replays in as few draw calls as
+// it can.  Each draw is merged into the most recent earlier group with the same
+// state, as long as nothing drawn in between overlaps it, so the result is the
+// same as drawing everything in submission order.  Has no GL dependencies.
+class LLRenderBatch
+{
+public:
+	// Everything LLRender restores before replaying a group
+	struct State
+	{
+		U32 mMode;
+		U32 mTextureType;
+		U32 mTexture;			// texture name on unit 0, 0 for untextured
+		U8 mBlendColorSFactor;
+		U8 mBlendColorDFactor;
+		U8 mBlendAlphaSFactor;
+		U8 mBlendAlphaDFactor;
+
+		bool operator==(const State& rhs) const;
+		bool operator!=(const State& rhs) const { return !(*this == rhs); }
+	};
+
+	struct Group
+	{
+		State mState;
+		F32 mMinX;
+		F32 mMinY;
+		F32 mMaxX;
+		F32 mMaxY;
+		std::vector<LLVector3> mVertices;
+		std::vector<LLVector2> mTexCoords;
+		std::vector<LLColor4U> mColors;
+	};
+
+	typedef std::vector<Group> group_list_t;
+
+	LLRenderBatch();
+
+	// pad is added around the bounds of the draw, for lines and points
+	void addDraw(const State& state, LLStrider<LLVector3> vertices, LLStrider<LLVector2> tex_coords, LLStrider<LLColor4U> colors, U32 count, F32 pad = 0.f);
+
+	bool empty() const							{ return mGroups.empty(); }
+	const group_list_t& getGroups() const		{ return mGroups; }
+	void swapGroups(group_list_t& groups)		{ mGroups.swap(groups); }
+	void clear();
+
+	// Draws queued since the last clear(), before merging
+	U32 getNumDraws() const						{ return mNumDraws; }
+
+private:
+	static bool overlaps(const Group& group, F32 min_x, F32 min_y, F32 max_x, F32 max_y);
+
+	group_list_t mGroups;
+	U32 mNumDraws;
+};
+
+#endif // LL_LLRENDERBATCH_H
@@ -422,6 +422,8 @@ void LLRenderTarget::release()
 
 void LLRenderTarget::bindTarget()
 {
+	gGL.flushUIBatch();
+
 	if (mFBO)
 	{
 		stop_glerror();
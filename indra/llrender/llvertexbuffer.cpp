@@ -118,6 +118,15 @@ bool LLVertexBuffer::sMapped = false;
 bool LLVertexBuffer::sUseStreamDraw = true;
 bool LLVertexBuffer::sUseVAO = false;
 bool LLVertexBuffer::sPreferStreamDraw = false;
+LLVBORing LLVertexBuffer::sStreamVBORing;
+bool LLVertexBuffer::sUseStreamRing = false;
+U32 LLVertexBuffer::sStreamRingSize = 4*1024*1024;
+
+static LLTrace::CountStatHandle<> sVBORingAllocs("vbo_ring_allocs", "Vertex data allocations from the streaming VBO ring");
+static LLTrace::CountStatHandle<S32Bytes> sVBORingBytes("vbo_ring_bytes", "Vertex data written to the streaming VBO ring");
+static LLTrace::CountStatHandle<> sVBORingStalls("vbo_ring_stalls", "Times the streaming VBO ring waited on the GPU to release a segment");
+static LLTrace::EventStatHandle<F64Milliseconds> sVBORingStallTime("vbo_ring_stall_time", "Time spent waiting on the GPU to release a streaming VBO ring segment");
+static LLTrace::CountStatHandle<> sVBOSubDataUploads("vbo_subdata_uploads", "Vertex buffer uploads via glBufferSubData");
 
 
 U32 LLVBOPool::genBuffer()
@@ -322,6 +331,207 @@ void LLVBOPool::cleanup()
 	std::fill(mMissCount.begin(), mMissCount.end(), 0);
 }
 
+//============================================================================
+
+static LLTrace::BlockTimerStatHandle FTM_VBO_RING_WAIT("VBO Ring Wait");
+
+LLVBORing::LLVBORing()
+:	mGLName(0),
+	mSize(0),
+	mSegmentSize(0),
+	mHead(0),
+	mSegment(0),
+	mSerial(0),
+	mPersistent(false),
+	mPersistentData(NULL),
+	mMappedData(NULL)
+{
+	for (U32 i = 0; i < NUM_SEGMENTS; ++i)
+	{
+		mFences[i] = NULL;
+	}
+}
+
+LLVBORing::~LLVBORing()
+{ //GL resources are released by cleanup() while the context is still alive
+}
+
+bool LLVBORing::init(U32 size)
+{
+	cleanup();
+
+	if (!gGLManager.mHasSync || !gGLManager.mHasMapBufferRange)
+	{ //need fences to know when a segment can be reused, and need
+	  //unsynchronized maps to avoid stalling on the whole buffer
+		return false;
+	}
+
+	mSegmentSize = vbo_block_size(llmax(size/NUM_SEGMENTS, LL_VBO_BLOCK_SIZE));
+	mSize = mSegmentSize*NUM_SEGMENTS;
+
+	glGenBuffersARB(1, &mGLName);
+	bind();
+
+#ifdef GL_ARB_buffer_storage
+	if (gGLManager.mHasBufferStorage)
+	{
+		const U32 flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER_ARB, mSize, NULL, flags);
+		mPersistentData = (volatile U8*) glMapBufferRange(GL_ARRAY_BUFFER_ARB, 0, mSize, flags);
+		mPersistent = mPersistentData != NULL;
+		if (!mPersistent)
+		{ //immutable storage can't be respecified, start over with a plain buffer
+			LL_WARNS() << "Failed to persistently map streaming VBO ring, falling back to unsynchronized mapping." << LL_ENDL;
+			LLVertexBuffer::unbind();
+			glDeleteBuffersARB(1, &mGLName);
+			glGenBuffersARB(1, &mGLName);
+			bind();
+		}
+	}
+#endif
+
+	if (!mPersistent)
+	{
+		glBufferDataARB(GL_ARRAY_BUFFER_ARB, mSize, NULL, GL_STREAM_DRAW_ARB);
+	}
+	stop_glerror();
+
+	for (U32 i = 0; i < NUM_SEGMENTS; ++i)
+	{
+		mFences[i] = new LLGLSyncFence();
+	}
+
+	mHead = 0;
+	mSegment = 0;
+	mSerial = 0;
+
+	LLVertexBuffer::sAllocatedBytes += mSize;
+
+	LL_INFOS() << "Streaming VBO ring: " << mSize << " bytes in " << (S32) NUM_SEGMENTS << " segments, " 
+		<< (mPersistent ? "persistently mapped" : "unsynchronized mapping") << LL_ENDL;
+
+	return true;
+}
+
+void LLVBORing::cleanup()
+{
+	if (mGLName)
+	{
+		if (gGLManager.mInited)
+		{
+			LLVertexBuffer::unbind();
+			if (mPersistent || mMappedData)
+			{
+				glBindBufferARB(GL_ARRAY_BUFFER_ARB, mGLName);
+				glUnmapBufferARB(GL_ARRAY_BUFFER_ARB);
+				glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+			}
+			glDeleteBuffersARB(1, &mGLName);
+		}
+		LLVertexBuffer::sAllocatedBytes -= mSize;
+	}
+
+	for (U32 i = 0; i < NUM_SEGMENTS; ++i)
+	{
+		delete mFences[i];
+		mFences[i] = NULL;
+	}
+
+	mGLName = 0;
+	mSize = 0;
+	mSegmentSize = 0;
+	mHead = 0;
+	mSegment = 0;
+	mPersistent = false;
+	mPersistentData = NULL;
+	mMappedData = NULL;
+}
+
+void LLVBORing::bind()
+{
+	if (LLVertexBuffer::sGLRenderArray)
+	{ //never attach the ring to a VAO
+#if GL_ARB_vertex_array_object
+		glBindVertexArray(0);
+#endif
+		LLVertexBuffer::sGLRenderArray = 0;
+		LLVertexBuffer::sGLRenderIndices = 0;
+		LLVertexBuffer::sIBOActive = false;
+	}
+
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, mGLName);
+	LLVertexBuffer::sGLRenderBuffer = mGLName;
+	LLVertexBuffer::sVBOActive = true;
+	LLVertexBuffer::sBindCount++;
+}
+
+void LLVBORing::advanceSegment()
+{
+	//every draw that sources the segment being left has been issued by now
+	mFences[mSegment]->placeFence();
+
+	mSegment = (mSegment+1) % NUM_SEGMENTS;
+	mHead = mSegment*mSegmentSize;
+	mSerial++;
+
+	LLGLSyncFence* fence = mFences[mSegment];
+	if (!fence->isCompleted())
+	{
+		LL_RECORD_BLOCK_TIME(FTM_VBO_RING_WAIT);
+		LLTimer timer;
+		fence->wait();
+		add(sVBORingStalls, 1);
+		record(sVBORingStallTime, F64Milliseconds(timer.getElapsedTimeF64()));
+	}
+}
+
+volatile U8* LLVBORing::allocate(U32 size, U32& offset)
+{
+	llassert(!mMappedData);
+
+	size = (size + 0xF) & ~0xF;
+
+	if (!mGLName || size > mSegmentSize)
+	{
+		return NULL;
+	}
+
+	if (mHead + size > (mSegment+1)*mSegmentSize)
+	{ //allocations never straddle segments
+		advanceSegment();
+	}
+
+	offset = mHead;
+	mHead += size;
+
+	add(sVBORingAllocs, 1);
+	add(sVBORingBytes, S32Bytes(size));
+
+	if (mPersistent)
+	{
+		return mPersistentData + offset;
+	}
+
+	bind();
+	mMappedData = (volatile U8*) glMapBufferRange(GL_ARRAY_BUFFER_ARB, offset, size, 
+		GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+	stop_glerror();
+
+	return mMappedData;
+}
+
+void LLVBORing::commit()
+{
+	if (mMappedData)
+	{
+		bind();
+		glUnmapBufferARB(GL_ARRAY_BUFFER_ARB);
+		stop_glerror();
+		mMappedData = NULL;
+	}
+}
+
+
 
 //NOTE: each component must be AT LEAST 4 bytes in size to avoid a performance penalty on AMD hardware
 S32 LLVertexBuffer::sTypeSize[LLVertexBuffer::TYPE_MAX] =
@@ -562,6 +772,7 @@ void LLVertexBuffer::drawArrays(U32 mode, const std::vector<LLVector3>& pos, con
 {
 	LL_RECORD_BLOCK_TIME(FTM_VB_DRAW_ARRAYS);
 	llassert(!LLGLSLShader::sNoFixedFunction || LLGLSLShader::sCurBoundShaderPtr != NULL);
+	gGL.flushUIBatch();
 	gGL.syncMatrices();
 
 	U32 count = pos.size();
@@ -615,6 +826,7 @@ void LLVertexBuffer::drawElements(U32 mode, const LLVector4a* pos, const LLVecto
 {
 	llassert(!LLGLSLShader::sNoFixedFunction || LLGLSLShader::sCurBoundShaderPtr != NULL);
 
+	gGL.flushUIBatch();
 	gGL.syncMatrices();
 
 	U32 mask = LLVertexBuffer::MAP_VERTEX;
@@ -720,7 +932,7 @@ void LLVertexBuffer::drawRange(U32 mode, U32 start, U32 end, U32 count, U32 indi
 			LL_ERRS() << "Wrong index buffer bound." << LL_ENDL;
 		}
 
-		if (mGLBuffer != sGLRenderBuffer)
+		if (getGLBufferName() != sGLRenderBuffer)
 		{
 			LL_ERRS() << "Wrong vertex buffer bound." << LL_ENDL;
 		}
@@ -784,7 +996,7 @@ void LLVertexBuffer::draw(U32 mode, U32 count, U32 indices_offset) const
 			LL_ERRS() << "Wrong index buffer bound." << LL_ENDL;
 		}
 
-		if (mGLBuffer != sGLRenderBuffer)
+		if (getGLBufferName() != sGLRenderBuffer)
 		{
 			LL_ERRS() << "Wrong vertex buffer bound." << LL_ENDL;
 		}
@@ -828,7 +1040,7 @@ void LLVertexBuffer::drawArrays(U32 mode, U32 first, U32 count) const
 	}
 	else
 	{
-		if (mGLBuffer != sGLRenderBuffer || useVBOs() != sVBOActive)
+		if (getGLBufferName() != sGLRenderBuffer || useVBOs() != sVBOActive)
 		{
 			LL_ERRS() << "Wrong vertex buffer bound." << LL_ENDL;
 		}
@@ -906,6 +1118,7 @@ void LLVertexBuffer::cleanupClass()
 	sStreamVBOPool.cleanup();
 	sDynamicVBOPool.cleanup();
 	sDynamicCopyVBOPool.cleanup();
+	sStreamVBORing.cleanup();
 
 	if(sPrivatePoolp)
 	{
@@ -982,6 +1195,10 @@ LLVertexBuffer::LLVertexBuffer(U32 typemask, S32 usage)
 	mFinal(false),
 	mEmpty(true),
 	mMappable(false),
+	mUseRing(false),
+	mRingActive(false),
+	mRingCount(0),
+	mRingSerial(0),
 	mFence(NULL)
 {
 	mMappable = (mUsage == GL_DYNAMIC_DRAW_ARB && !sDisableVBOMapping);
@@ -990,6 +1207,7 @@ LLVertexBuffer::LLVertexBuffer(U32 typemask, S32 usage)
 	for (U32 i = 0; i < TYPE_MAX; i++)
 	{
 		mOffsets[i] = 0;
+		mRingOffsets[i] = 0;
 	}
 
 	sCount++;
@@ -1249,6 +1467,7 @@ void LLVertexBuffer::destroyGLBuffer()
 	}
 	
 	mGLBuffer = 0;
+	mRingActive = false;
 	//unbind();
 }
 
@@ -1857,6 +2076,81 @@ static LLTrace::BlockTimerStatHandle FTM_VBO_FLUSH_RANGE("Flush VBO Range");
 static LLTrace::BlockTimerStatHandle FTM_IBO_UNMAP("IBO Unmap");
 static LLTrace::BlockTimerStatHandle FTM_IBO_FLUSH_RANGE("Flush IBO Range");
 
+void LLVertexBuffer::setUseStreamRing(bool use_ring)
+{
+	mUseRing = use_ring && mUsage == GL_STREAM_DRAW_ARB;
+	if (!mUseRing && mRingActive)
+	{ //own buffer was not kept up to date while streaming through the ring
+		mRingActive = false;
+		if (mMappedData && !mVertexLocked)
+		{
+			bindGLBuffer(true);
+			glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, 0, getSize(), (U8*) mMappedData);
+			add(sVBOSubDataUploads, 1);
+		}
+	}
+}
+
+//copy the first count vertices of every component to the streaming ring, packed
+//the same way calcOffsets would pack a buffer of count vertices
+bool LLVertexBuffer::uploadToRing(S32 count)
+{
+	if (!sUseStreamRing)
+	{
+		return false;
+	}
+
+	if (!sStreamVBORing.isValid())
+	{
+		if (!sStreamVBORing.init(sStreamRingSize))
+		{ //don't keep trying every frame
+			LL_INFOS() << "Streaming VBO ring unavailable, using glBufferSubData." << LL_ENDL;
+			sUseStreamRing = false;
+			return false;
+		}
+	}
+
+	if (count <= 0 || !mMappedData)
+	{
+		return false;
+	}
+
+	S32 offsets[TYPE_MAX];
+	for (U32 i = 0; i < TYPE_MAX; ++i)
+	{
+		offsets[i] = 0;
+	}
+	U32 size = calcOffsets(mTypeMask, offsets, count);
+
+	U32 ring_offset = 0;
+	volatile U8* dst = sStreamVBORing.allocate(size, ring_offset);
+	if (!dst)
+	{
+		return false;
+	}
+
+	for (S32 i = 0; i < TYPE_TEXTURE_INDEX; ++i)
+	{
+		if ((mTypeMask & (1 << i)) && sTypeSize[i])
+		{
+			memcpy((U8*) dst + offsets[i], (U8*) mMappedData + mOffsets[i], sTypeSize[i]*count);
+		}
+	}
+
+	sStreamVBORing.commit();
+
+	for (U32 i = 0; i < TYPE_MAX; ++i)
+	{
+		mRingOffsets[i] = ring_offset + offsets[i];
+	}
+
+	mRingCount = count;
+	mRingSerial = sStreamVBORing.getSerial();
+	mRingActive = true;
+
+	return true;
+}
+
 void LLVertexBuffer::unmapBuffer()
 {
 	if (!useVBOs())
@@ -1869,11 +2163,35 @@ void LLVertexBuffer::unmapBuffer()
 	if (mMappedData && mVertexLocked)
 	{
 		LL_RECORD_BLOCK_TIME(FTM_VBO_UNMAP);
-		bindGLBuffer(true);
 		updated_all = mIndexLocked; //both vertex and index buffers done updating
 
-		if(!mMappable)
+		bool in_ring = false;
+
+		if(!mMappable && mUseRing && !mGLArray && sUseStreamRing)
+		{ //copy everything up to the last vertex written to the streaming ring
+			S32 count = mMappedVertexRegions.empty() ? mNumVerts : 0;
+			for (U32 i = 0; i < mMappedVertexRegions.size(); ++i)
+			{
+				const MappedRegion& region = mMappedVertexRegions[i];
+				count = region.mIndex >= 0 ? llmax(count, region.mEnd) : mNumVerts;
+			}
+
+			in_ring = uploadToRing(count);
+		}
+
+		if (in_ring)
+		{
+			mMappedVertexRegions.clear();
+		}
+		else if(!mMappable)
 		{
+			if (mRingActive)
+			{ //previous contents went to the ring, so all of our own buffer is stale
+				mRingActive = false;
+				mMappedVertexRegions.clear();
+			}
+
+			bindGLBuffer(true);
 			if (!mMappedVertexRegions.empty())
 			{
 				stop_glerror();
@@ -1883,6 +2201,7 @@ void LLVertexBuffer::unmapBuffer()
 					S32 offset = region.mIndex >= 0 ? mOffsets[region.mType]+sTypeSize[region.mType]*region.mIndex : 0;
 					S32 length = sTypeSize[region.mType]*region.mCount;
 					glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, offset, length, (U8*) mMappedData+offset);
+					add(sVBOSubDataUploads, 1);
 					stop_glerror();
 				}
 
@@ -1892,11 +2211,13 @@ void LLVertexBuffer::unmapBuffer()
 			{
 				stop_glerror();
 				glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, 0, getSize(), (U8*) mMappedData);
+				add(sVBOSubDataUploads, 1);
 				stop_glerror();
 			}
 		}
 		else
 		{
+			bindGLBuffer(true);
 			if (gGLManager.mHasMapBufferRange || gGLManager.mHasFlushBufferRange)
 			{
 				if (!mMappedVertexRegions.empty())
@@ -2151,12 +2472,14 @@ bool LLVertexBuffer::bindGLBuffer(bool force_bind)
 
 	bool ret = false;
 
-	if (useVBOs() && (force_bind || (mGLBuffer && (mGLBuffer != sGLRenderBuffer || !sVBOActive))))
+	U32 name = getGLBufferName();
+
+	if (useVBOs() && (force_bind || (name && (name != sGLRenderBuffer || !sVBOActive))))
 	{
 		//LL_RECORD_BLOCK_TIME(FTM_BIND_GL_BUFFER);
 		
-		glBindBufferARB(GL_ARRAY_BUFFER_ARB, mGLBuffer);
-		sGLRenderBuffer = mGLBuffer;
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, name);
+		sGLRenderBuffer = name;
 		sBindCount++;
 		sVBOActive = true;
 
@@ -2214,10 +2537,24 @@ void LLVertexBuffer::bindForFeedback(U32 channel, U32 type, U32 index, U32 count
 // Set for rendering
 void LLVertexBuffer::setBuffer(U32 data_mask)
 {
+	//queued UI draws rebind the immediate mode buffer, get them out of the way
+	//before this buffer is bound
+	gGL.flushUIBatch();
+
 	flush();
 
+	if (mRingActive && !sStreamVBORing.isCurrent(mRingSerial) && !uploadToRing(mRingCount))
+	{ //ring moved on since the last upload and there's no room to copy the data forward,
+	  //draw from our own buffer instead
+		mRingActive = false;
+		bindGLBuffer(true);
+		glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, 0, getSize(), (U8*) mMappedData);
+		add(sVBOSubDataUploads, 1);
+	}
+
 	//set up pointers if the data mask is different ...
-	bool setup = (sLastMask != data_mask);
+	//ring backed buffers share a GL name, so the bind check below can't be trusted
+	bool setup = (sLastMask != data_mask) || mRingActive;
 
 	if (gDebugGL && data_mask != 0)
 	{ //make sure data requirements are fulfilled
@@ -2296,7 +2633,7 @@ void LLVertexBuffer::setBuffer(U32 data_mask)
 		{
 			GLint buff;
 			glGetIntegerv(GL_ARRAY_BUFFER_BINDING_ARB, &buff);
-			if ((GLuint)buff != mGLBuffer)
+			if ((GLuint)buff != getGLBufferName())
 			{
 				if (gDebugSession)
 				{
@@ -2387,6 +2724,13 @@ void LLVertexBuffer::setupVertexBuffer(U32 data_mask)
 {
 	stop_glerror();
 	volatile U8* base = useVBOs() ? (U8*) mAlignedOffset : mMappedData;
+	const S32* offsets = mOffsets;
+
+	if (mRingActive)
+	{
+		base = NULL;
+		offsets = mRingOffsets;
+	}
 
 	if (gDebugGL && ((data_mask & mTypeMask) != data_mask))
 	{
@@ -2406,50 +2750,50 @@ void LLVertexBuffer::setupVertexBuffer(U32 data_mask)
 		if (data_mask & MAP_NORMAL)
 		{
 			S32 loc = TYPE_NORMAL;
-			void* ptr = (void*)(base + mOffsets[TYPE_NORMAL]);
+			void* ptr = (void*)(base + offsets[TYPE_NORMAL]);
 			glVertexAttribPointerARB(loc, 3, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_NORMAL], ptr);
 		}
 		if (data_mask & MAP_TEXCOORD3)
 		{
 			S32 loc = TYPE_TEXCOORD3;
-			void* ptr = (void*)(base + mOffsets[TYPE_TEXCOORD3]);
+			void* ptr = (void*)(base + offsets[TYPE_TEXCOORD3]);
 			glVertexAttribPointerARB(loc,2,GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD3], ptr);
 		}
 		if (data_mask & MAP_TEXCOORD2)
 		{
 			S32 loc = TYPE_TEXCOORD2;
-			void* ptr = (void*)(base + mOffsets[TYPE_TEXCOORD2]);
+			void* ptr = (void*)(base + offsets[TYPE_TEXCOORD2]);
 			glVertexAttribPointerARB(loc,2,GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD2], ptr);
 		}
 		if (data_mask & MAP_TEXCOORD1)
 		{
 			S32 loc = TYPE_TEXCOORD1;
-			void* ptr = (void*)(base + mOffsets[TYPE_TEXCOORD1]);
+			void* ptr = (void*)(base + offsets[TYPE_TEXCOORD1]);
 			glVertexAttribPointerARB(loc,2,GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD1], ptr);
 		}
 		if (data_mask & MAP_TANGENT)
 		{
 			S32 loc = TYPE_TANGENT;
-			void* ptr = (void*)(base + mOffsets[TYPE_TANGENT]);
+			void* ptr = (void*)(base + offsets[TYPE_TANGENT]);
 			glVertexAttribPointerARB(loc, 4,GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_TANGENT], ptr);
 		}
 		if (data_mask & MAP_TEXCOORD0)
 		{
 			S32 loc = TYPE_TEXCOORD0;
-			void* ptr = (void*)(base + mOffsets[TYPE_TEXCOORD0]);
+			void* ptr = (void*)(base + offsets[TYPE_TEXCOORD0]);
 			glVertexAttribPointerARB(loc,2,GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD0], ptr);
 		}
 		if (data_mask & MAP_COLOR)
 		{
 			S32 loc = TYPE_COLOR;
 			//bind emissive instead of color pointer if emissive is present
-			void* ptr = (data_mask & MAP_EMISSIVE) ? (void*)(base + mOffsets[TYPE_EMISSIVE]) : (void*)(base + mOffsets[TYPE_COLOR]);
+			void* ptr = (data_mask & MAP_EMISSIVE) ? (void*)(base + offsets[TYPE_EMISSIVE]) : (void*)(base + offsets[TYPE_COLOR]);
 			glVertexAttribPointerARB(loc, 4, GL_UNSIGNED_BYTE, GL_TRUE, LLVertexBuffer::sTypeSize[TYPE_COLOR], ptr);
 		}
 		if (data_mask & MAP_EMISSIVE)
 		{
 			S32 loc = TYPE_EMISSIVE;
-			void* ptr = (void*)(base + mOffsets[TYPE_EMISSIVE]);
+			void* ptr = (void*)(base + offsets[TYPE_EMISSIVE]);
 			glVertexAttribPointerARB(loc, 4, GL_UNSIGNED_BYTE, GL_TRUE, LLVertexBuffer::sTypeSize[TYPE_EMISSIVE], ptr);
 
 			if (!(data_mask & MAP_COLOR))
@@ -2461,19 +2805,19 @@ void LLVertexBuffer::setupVertexBuffer(U32 data_mask)
 		if (data_mask & MAP_WEIGHT)
 		{
 			S32 loc = TYPE_WEIGHT;
-			void* ptr = (void*)(base + mOffsets[TYPE_WEIGHT]);
+			void* ptr = (void*)(base + offsets[TYPE_WEIGHT]);
 			glVertexAttribPointerARB(loc, 1, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_WEIGHT], ptr);
 		}
 		if (data_mask & MAP_WEIGHT4)
 		{
 			S32 loc = TYPE_WEIGHT4;
-			void* ptr = (void*)(base+mOffsets[TYPE_WEIGHT4]);
+			void* ptr = (void*)(base+offsets[TYPE_WEIGHT4]);
 			glVertexAttribPointerARB(loc, 4, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_WEIGHT4], ptr);
 		}
 		if (data_mask & MAP_CLOTHWEIGHT)
 		{
 			S32 loc = TYPE_CLOTHWEIGHT;
-			void* ptr = (void*)(base + mOffsets[TYPE_CLOTHWEIGHT]);
+			void* ptr = (void*)(base + offsets[TYPE_CLOTHWEIGHT]);
 			glVertexAttribPointerARB(loc, 4, GL_FLOAT, GL_TRUE,  LLVertexBuffer::sTypeSize[TYPE_CLOTHWEIGHT], ptr);
 		}
 		if (data_mask & MAP_TEXTURE_INDEX && 
@@ -2481,14 +2825,14 @@ void LLVertexBuffer::setupVertexBuffer(U32 data_mask)
 		{
 #if !LL_DARWIN
 			S32 loc = TYPE_TEXTURE_INDEX;
-			void *ptr = (void*) (base + mOffsets[TYPE_VERTEX] + 12);
+			void *ptr = (void*) (base + offsets[TYPE_VERTEX] + 12);
 			glVertexAttribIPointer(loc, 1, GL_UNSIGNED_INT, LLVertexBuffer::sTypeSize[TYPE_VERTEX], ptr);
 #endif
 		}
 		if (data_mask & MAP_VERTEX)
 		{
 			S32 loc = TYPE_VERTEX;
-			void* ptr = (void*)(base + mOffsets[TYPE_VERTEX]);
+			void* ptr = (void*)(base + offsets[TYPE_VERTEX]);
 			glVertexAttribPointerARB(loc, 3,GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_VERTEX], ptr);
 		}	
 	}	
@@ -2496,43 +2840,43 @@ void LLVertexBuffer::setupVertexBuffer(U32 data_mask)
 	{
 		if (data_mask & MAP_NORMAL)
 		{
-			glNormalPointer(GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_NORMAL], (void*)(base + mOffsets[TYPE_NORMAL]));
+			glNormalPointer(GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_NORMAL], (void*)(base + offsets[TYPE_NORMAL]));
 		}
 		if (data_mask & MAP_TEXCOORD3)
 		{
 			glClientActiveTextureARB(GL_TEXTURE3_ARB);
-			glTexCoordPointer(2,GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD3], (void*)(base + mOffsets[TYPE_TEXCOORD3]));
+			glTexCoordPointer(2,GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD3], (void*)(base + offsets[TYPE_TEXCOORD3]));
 			glClientActiveTextureARB(GL_TEXTURE0_ARB);
 		}
 		if (data_mask & MAP_TEXCOORD2)
 		{
 			glClientActiveTextureARB(GL_TEXTURE2_ARB);
-			glTexCoordPointer(2,GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD2], (void*)(base + mOffsets[TYPE_TEXCOORD2]));
+			glTexCoordPointer(2,GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD2], (void*)(base + offsets[TYPE_TEXCOORD2]));
 			glClientActiveTextureARB(GL_TEXTURE0_ARB);
 		}
 		if (data_mask & MAP_TEXCOORD1)
 		{
 			glClientActiveTextureARB(GL_TEXTURE1_ARB);
-			glTexCoordPointer(2,GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD1], (void*)(base + mOffsets[TYPE_TEXCOORD1]));
+			glTexCoordPointer(2,GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD1], (void*)(base + offsets[TYPE_TEXCOORD1]));
 			glClientActiveTextureARB(GL_TEXTURE0_ARB);
 		}
 		if (data_mask & MAP_TANGENT)
 		{
 			glClientActiveTextureARB(GL_TEXTURE2_ARB);
-			glTexCoordPointer(4,GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_TANGENT], (void*)(base + mOffsets[TYPE_TANGENT]));
+			glTexCoordPointer(4,GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_TANGENT], (void*)(base + offsets[TYPE_TANGENT]));
 			glClientActiveTextureARB(GL_TEXTURE0_ARB);
 		}
 		if (data_mask & MAP_TEXCOORD0)
 		{
-			glTexCoordPointer(2,GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD0], (void*)(base + mOffsets[TYPE_TEXCOORD0]));
+			glTexCoordPointer(2,GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD0], (void*)(base + offsets[TYPE_TEXCOORD0]));
 		}
 		if (data_mask & MAP_COLOR)
 		{
-			glColorPointer(4, GL_UNSIGNED_BYTE, LLVertexBuffer::sTypeSize[TYPE_COLOR], (void*)(base + mOffsets[TYPE_COLOR]));
+			glColorPointer(4, GL_UNSIGNED_BYTE, LLVertexBuffer::sTypeSize[TYPE_COLOR], (void*)(base + offsets[TYPE_COLOR]));
 		}
 		if (data_mask & MAP_VERTEX)
 		{
-			glVertexPointer(3,GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_VERTEX], (void*)(base + 0));
+			glVertexPointer(3,GL_FLOAT, LLVertexBuffer::sTypeSize[TYPE_VERTEX], (void*)(base + offsets[TYPE_VERTEX]));
 		}	
 	}
 
@@ -91,6 +91,60 @@ public:
 
 };
 
+//============================================================================
+// streaming ring buffer for vertex data that is rewritten every frame
+// (UI, HUD text, particles).  One large GL buffer is split into segments,
+// each guarded by a fence that is placed when the write head leaves the
+// segment and waited on before the segment is written again.  Uses a
+// persistent mapping when GL_ARB_buffer_storage is available, otherwise
+// an unsynchronized glMapBufferRange per allocation.
+class LLVBORing
+{
+public:
+	enum { NUM_SEGMENTS = 4 };
+
+	LLVBORing();
+	~LLVBORing();
+
+	//create the GL buffer, returns false if the required extensions are missing
+	bool init(U32 size);
+	void cleanup();
+
+	bool isValid() const					{ return mGLName != 0; }
+	U32 getGLName() const					{ return mGLName; }
+	U32 getSize() const						{ return mSize; }
+
+	//reserve size bytes of the current segment, returns a writeable pointer
+	//and the byte offset into the ring buffer, or NULL if size is larger than
+	//a segment.  Must be followed by commit() before the data is used.
+	volatile U8* allocate(U32 size, U32& offset);
+	void commit();
+
+	//serial of the segment the write head is in, increments every time the 
+	//head moves on to the next segment
+	U32 getSerial() const					{ return mSerial; }
+
+	//data written with the given serial is safe to draw from without
+	//being copied again
+	bool isCurrent(U32 serial) const		{ return isValid() && serial == mSerial; }
+
+	void bind();
+
+private:
+	void advanceSegment();
+
+	U32 mGLName;
+	U32 mSize;
+	U32 mSegmentSize;
+	U32 mHead;
+	U32 mSegment;
+	U32 mSerial;
+	bool mPersistent;
+	volatile U8* mPersistentData;
+	volatile U8* mMappedData;
+	LLGLSyncFence* mFences[NUM_SEGMENTS];
+};
+
 
 //============================================================================
 // base class 
@@ -135,6 +189,10 @@ public:
 	static bool sUseVAO;
 	static bool	sPreferStreamDraw;
 
+	static LLVBORing sStreamVBORing;
+	static bool sUseStreamRing;
+	static U32 sStreamRingSize;
+
 	static void seedPools();
 
 	static U32 getVAOName();
@@ -221,6 +279,8 @@ protected:
 	void	updateNumVerts(S32 nverts);
 	void	updateNumIndices(S32 nindices); 
 	void	unmapBuffer();
+	bool	uploadToRing(S32 count);
+	U32		getGLBufferName() const		{ return mRingActive ? sStreamVBORing.getGLName() : mGLBuffer; }
 		
 public:
 	LLVertexBuffer(U32 typemask, S32 usage);
@@ -231,6 +291,10 @@ public:
 
 	void bindForFeedback(U32 channel, U32 type, U32 index, U32 count);
 
+	//upload vertex data for stream buffers to sStreamVBORing instead of this
+	//buffer's own VBO, for buffers that are refilled every frame
+	void setUseStreamRing(bool use_ring);
+
 	// set for rendering
 	virtual void	setBuffer(U32 data_mask); 	// calls  setupVertexBuffer() if data_mask is not 0
 	void flush(); //flush pending data to GL memory
@@ -319,6 +383,12 @@ protected:
 
 	S32		mOffsets[TYPE_MAX];
 
+	bool	mUseRing;			// if true, stream vertex data through sStreamVBORing
+	bool	mRingActive;		// if true, vertex pointers reference sStreamVBORing
+	S32		mRingCount;			// number of vertices copied to sStreamVBORing
+	U32		mRingSerial;		// ring segment serial the vertices were copied to
+	S32		mRingOffsets[TYPE_MAX];
+
 	std::vector<MappedRegion> mMappedVertexRegions;
 	std::vector<MappedRegion> mMappedIndexRegions;
 
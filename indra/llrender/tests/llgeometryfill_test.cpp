@@ -0,0 +1,264 @@
+/**
+ * @file   llgeometryfill_test.cpp
+ * @brief  Test and rebuild benchmark for llgeometryfill.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <vector>
+
+#include "../test/lltut.h"
+#include "../llgeometryfill.h"
+
+#include "llvolume.h"
+#include "llworkpool.h"
+#include "lltimer.h"
+#include "m3math.h"
+#include "m4math.h"
+#include "v4coloru.h"
+
+// normally owned by llgl.cpp
+BOOL gDebugGL = FALSE;
+// normally set from the viewer's OctreeMaxNodeCapacity and
+// OctreeMinimumNodeSize settings
+U32 gOctreeMaxCapacity = 128;
+F32 gOctreeMinSize = 0.01f;
+
+namespace
+{
+	// about what a busy region has in view
+	const U32 PRIM_COUNT = 2000;
+
+	// Mapped vertex buffer stand in, each face gets a run of vertices
+	// rounded up to 4 the way the attribute strides keep 16 byte alignment.
+	struct Staging
+	{
+		Staging(U32 vertices, U32 indices)
+		:	mVertices(vertices),
+			mIndices(indices)
+		{
+			mData = (U8*) ll_aligned_malloc_16(getSize());
+			memset(mData, 0, getSize());
+		}
+
+		~Staging()
+		{
+			ll_aligned_free_16(mData);
+		}
+
+		U32 getSize() const			{ return mVertices * 64 + mIndices * 2; }
+
+		F32* getPositions(U32 vert)		{ return (F32*) mData + vert * 4; }
+		F32* getNormals(U32 vert)		{ return (F32*) (mData + mVertices * 16) + vert * 4; }
+		F32* getTangents(U32 vert)		{ return (F32*) (mData + mVertices * 32) + vert * 4; }
+		F32* getTexCoords(U32 vert)		{ return (F32*) (mData + mVertices * 48) + vert * 2; }
+		U32* getColors(U32 vert)		{ return (U32*) (mData + mVertices * 56) + vert; }
+		U32* getEmissive(U32 vert)		{ return (U32*) (mData + mVertices * 60) + vert; }
+		U16* getIndices(U32 index)		{ return (U16*) (mData + mVertices * 64) + index; }
+
+		U32 mVertices;
+		U32 mIndices;
+		U8* mData;
+	};
+
+	U32 padded(U32 vertices)
+	{
+		return (vertices + 3) & ~3;
+	}
+}
+
+namespace tut
+{
+	struct llgeometryfill_data
+	{
+		llgeometryfill_data()
+		:	mVertices(0),
+			mIndices(0)
+		{
+			// box, cylinder and sphere at the highest LOD's detail
+			const U8 types[][2] =
+			{
+				{ LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE },
+				{ LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PATH_LINE },
+				{ LL_PCODE_PROFILE_CIRCLE_HALF, LL_PCODE_PATH_CIRCLE }
+			};
+			for (U32 i = 0; i < LL_ARRAY_SIZE(types); ++i)
+			{
+				LLVolumeParams params;
+				params.setType(types[i][0], types[i][1]);
+				LLPointer<LLVolume> volume = new LLVolume(params, 4.f);
+				for (S32 face = 0; face < volume->getNumVolumeFaces(); ++face)
+				{
+					volume->genTangents(face);
+				}
+				mVolumes.push_back(volume);
+			}
+
+			for (U32 prim = 0; prim < PRIM_COUNT; ++prim)
+			{
+				const LLVolume* volume = mVolumes[prim % mVolumes.size()];
+				for (S32 face = 0; face < volume->getNumVolumeFaces(); ++face)
+				{
+					const LLVolumeFace& vf = volume->getVolumeFace(face);
+					mVertices += padded(vf.mNumVertices);
+					mIndices += vf.mNumIndices;
+				}
+			}
+		}
+
+		// queues what LLFace::getGeometryVolume() would for a full rebuild of
+		// every prim, each with its own transform, texture index and colors
+		void queue(LLGeometryFill& fill, Staging& staging)
+		{
+			U32 vert = 0;
+			U32 index = 0;
+			for (U32 prim = 0; prim < PRIM_COUNT; ++prim)
+			{
+				LLMatrix4 mat;
+				mat.initRotTrans(prim * 0.01f, prim * 0.02f, prim * 0.03f,
+								 LLVector4((F32) (prim % 50) * 5.f, (F32) (prim / 50) * 5.f, 20.f, 1.f));
+				LLMatrix4a mat_vert;
+				mat_vert.loadu(mat);
+				LLMatrix4a mat_normal;
+				mat_normal.loadu(mat.getMat3());
+
+				const LLVolume* volume = mVolumes[prim % mVolumes.size()];
+				for (S32 face = 0; face < volume->getNumVolumeFaces(); ++face)
+				{
+					const LLVolumeFace& vf = volume->getVolumeFace(face);
+
+					LLGeometryFill::Job indices(LLGeometryFill::INDICES, &vf, staging.getIndices(index));
+					indices.mValue = vert & 0xFFFF;
+					fill.add(indices);
+
+					LLGeometryFill::Job positions(LLGeometryFill::POSITIONS, &vf, staging.getPositions(vert));
+					positions.mMatrix = mat_vert;
+					positions.mValue = prim % 8;
+					positions.mDstCount = padded(vf.mNumVertices);
+					fill.add(positions);
+
+					LLGeometryFill::Job normals(LLGeometryFill::NORMALS, &vf, staging.getNormals(vert));
+					normals.mMatrix = mat_normal;
+					fill.add(normals);
+
+					LLGeometryFill::Job tangents(LLGeometryFill::TANGENTS, &vf, staging.getTangents(vert));
+					tangents.mMatrix = mat_normal;
+					fill.add(tangents);
+
+					if (prim % 2)
+					{
+						LLGeometryFill::Job tex_coords(LLGeometryFill::TEX_COORDS_XFORM, &vf, staging.getTexCoords(vert));
+						tex_coords.mTexXform[0] = cosf(prim * 0.1f);
+						tex_coords.mTexXform[1] = sinf(prim * 0.1f);
+						tex_coords.mTexXform[2] = 0.25f;
+						tex_coords.mTexXform[4] = 2.f;
+						fill.add(tex_coords);
+					}
+					else
+					{
+						fill.add(LLGeometryFill::Job(LLGeometryFill::TEX_COORDS, &vf, staging.getTexCoords(vert)));
+					}
+
+					LLGeometryFill::Job colors(LLGeometryFill::COLORS, &vf, staging.getColors(vert));
+					colors.mValue = LLColor4U(prim % 256, 128, 64, 255).mAll;
+					fill.add(colors);
+
+					LLGeometryFill::Job emissive(LLGeometryFill::COLORS, &vf, staging.getEmissive(vert));
+					emissive.mValue = LLColor4U(0, 0, 0, prim % 256).mAll;
+					fill.add(emissive);
+
+					vert += padded(vf.mNumVertices);
+					index += vf.mNumIndices;
+				}
+			}
+		}
+
+		std::vector<LLPointer<LLVolume> > mVolumes;
+		U32 mVertices;
+		U32 mIndices;
+	};
+	typedef test_group<llgeometryfill_data> llgeometryfill_test;
+	typedef llgeometryfill_test::object llgeometryfill_object;
+	tut::llgeometryfill_test tllgeometryfill("LLGeometryFill");
+
+	template<> template<>
+	void llgeometryfill_object::test<1>()
+	{
+		// the same bytes whether written here or spread over a pool
+		LLGeometryFill fill;
+		Staging serial(mVertices, mIndices);
+		queue(fill, serial);
+		ensure("queued", !fill.empty());
+		fill.run(NULL);
+		ensure("emptied", fill.empty());
+
+		for (U32 threads = 1; threads <= 4; threads += 3)
+		{
+			LLWorkPool pool("Test fill", threads);
+			Staging pooled(mVertices, mIndices);
+			queue(fill, pooled);
+			fill.run(&pool);
+			ensure("emptied by pool", fill.empty());
+			ensure("same bytes", memcmp(serial.mData, pooled.mData, serial.getSize()) == 0);
+		}
+
+		// spot check the first face against the volume
+		const LLVolumeFace& vf = mVolumes[0]->getVolumeFace(0);
+		const F32* pos = serial.getPositions(1);
+		ensure_approximately_equals("position x", pos[0], vf.mPositions[1][0], 16);
+		ensure_approximately_equals("position z", pos[2], vf.mPositions[1][2] + 20.f, 16);
+		ensure_equals("index offset", *serial.getIndices(0), vf.mIndices[0]);
+		ensure_equals("color", *serial.getColors(vf.mNumVertices - 1), LLColor4U(0, 128, 64, 255).mAll);
+		const F32* tc = serial.getTexCoords(vf.mNumVertices - 1);
+		ensure_equals("tex coord s", tc[0], vf.mTexCoords[vf.mNumVertices - 1].mV[0]);
+		ensure_equals("tex coord t", tc[1], vf.mTexCoords[vf.mNumVertices - 1].mV[1]);
+	}
+
+	template<> template<>
+	void llgeometryfill_object::test<2>()
+	{
+		// Time to fill a region's worth of prim faces, by worker count
+		LLGeometryFill fill;
+		Staging staging(mVertices, mIndices);
+		LL_INFOS() << PRIM_COUNT << " prims, " << mVertices << " vertices, "
+				   << mIndices << " indices" << LL_ENDL;
+
+		const U32 REPEATS = 5;
+		for (U32 threads = 0; threads <= 4; ++threads)
+		{
+			LLWorkPool* pool = threads ? new LLWorkPool("Test fill", threads) : NULL;
+			LLTimer timer;
+			F64 fill_time = 0.0;
+			for (U32 i = 0; i < REPEATS; ++i)
+			{
+				queue(fill, staging);
+				timer.reset();
+				fill.run(pool);
+				fill_time += timer.getElapsedTimeF64();
+			}
+			delete pool;
+			LL_INFOS() << threads << " workers: " << fill_time * 1000.0 / REPEATS << "ms per rebuild" << LL_ENDL;
+		}
+	}
+}
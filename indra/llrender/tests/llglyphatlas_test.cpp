@@ -0,0 +1,190 @@
+/**
+ * @file   llglyphatlas_test.cpp
+ * @brief  Test for llglyphatlas.cpp.
+ * 
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <map>
+
+#include "../test/lltut.h"
+#include "../llglyphatlas.h"
+
+namespace tut
+{
+	struct LLGlyphAtlasData
+	{
+		LLGlyphAtlasData() : mSeed(1) {}
+
+		// deterministic so failures reproduce
+		U32 random()
+		{
+			mSeed = mSeed * 1664525 + 1013904223;
+			return mSeed >> 8;
+		}
+
+		U32 mSeed;
+	};
+
+	typedef test_group<LLGlyphAtlasData> factory;
+	typedef factory::object object;
+}
+
+namespace
+{
+	tut::factory llglyphatlas_test_factory("LLGlyphAtlas");
+}
+
+namespace tut
+{
+	template<> template<>
+	void object::test<1>()
+	{
+		// packing efficiency: fill one page with CJK sized glyphs
+		LLGlyphAtlas atlas;
+		atlas.init(512, 512, 1);
+		std::vector<U32> evicted;
+
+		U32 count = 0;
+		while (true)
+		{
+			S32 slot = atlas.allocate(count++, 11 + random() % 6, 13 + random() % 4, 1, evicted);
+			ensure("allocation failed", slot >= 0);
+			if (atlas.getSlot(slot).mPage > 0)
+			{
+				atlas.release(slot);
+				break;
+			}
+		}
+
+		ensure("nothing evicted while in use", evicted.empty());
+		ensure("cells overlap", atlas.validate());
+		// getOccupancy() averages over both pages
+		ensure("first page packed tightly", atlas.getOccupancy() * 2.f > 0.85f);
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		// synthetic CJK chat: a hot set drawn every frame plus a long skewed tail
+		LLGlyphAtlas atlas;
+		atlas.init(256, 256, 2);
+		std::map<U32, S32> resident;
+		std::map<U32, U32> last_drawn;
+		std::vector<U32> evicted;
+
+		const U32 HOT_GLYPHS = 40;
+		for (U32 frame = 1; frame <= 2000; ++frame)
+		{
+			for (U32 i = 0; i < 60; ++i)
+			{
+				U32 key = i < HOT_GLYPHS ? i : HOT_GLYPHS + (random() % 1000) * (random() % 1000) / 200;
+				last_drawn[key] = frame;
+				std::map<U32, S32>::iterator iter = resident.find(key);
+				if (iter != resident.end())
+				{
+					ensure("stale slot", atlas.getSlot(iter->second).mKey == key);
+					atlas.touch(iter->second, frame);
+					continue;
+				}
+
+				evicted.clear();
+				S32 slot = atlas.allocate(key, 12 + key % 4, 15, frame, evicted);
+				ensure("allocation failed", slot >= 0);
+				for (U32 e = 0; e < evicted.size(); ++e)
+				{
+					ensure("evicted a glyph drawn this frame", last_drawn[evicted[e]] != frame);
+					resident.erase(evicted[e]);
+				}
+				resident[key] = slot;
+			}
+		}
+
+		ensure_equals("stayed within budget", atlas.getNumPages(), 2);
+		ensure("evicted glyphs", atlas.getEvictionCount() > 0);
+		ensure_equals("resident count", (S32)resident.size(), atlas.getNumGlyphs());
+		ensure("cells overlap", atlas.validate());
+		ensure("freed space reused", atlas.getOccupancy() > 0.75f);
+		for (U32 key = 0; key < HOT_GLYPHS; ++key)
+		{
+			ensure("hot glyph evicted", resident.find(key) != resident.end());
+		}
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		// glyphs in use this frame and pinned glyphs are never evicted
+		LLGlyphAtlas atlas;
+		atlas.init(64, 64, 1);
+		std::vector<U32> evicted;
+
+		// 16 cells of 15x15 fill a 64x64 page
+		S32 pinned = atlas.allocate(0, 14, 14, 1, evicted);
+		atlas.pin(pinned);
+		for (U32 key = 1; key < 16; ++key)
+		{
+			atlas.allocate(key, 14, 14, 2, evicted);
+		}
+		ensure_equals("one full page", atlas.getNumPages(), 1);
+
+		LLGlyphAtlas busy_atlas = atlas;
+		busy_atlas.allocate(16, 14, 14, 2, evicted);
+		ensure("grew past budget rather than evict", evicted.empty());
+		ensure_equals("over budget", busy_atlas.getNumPages(), 2);
+
+		U32 generation = atlas.getGeneration();
+		atlas.allocate(16, 14, 14, 3, evicted);
+		ensure_equals("evicted one glyph on the next frame", (S32)evicted.size(), 1);
+		ensure("pinned glyph evicted", evicted[0] != 0);
+		ensure_equals("within budget", atlas.getNumPages(), 1);
+		ensure("generation bumped", atlas.getGeneration() != generation);
+		ensure("cells overlap", atlas.validate());
+	}
+
+	template<> template<>
+	void object::test<4>()
+	{
+		// an emptied page takes glyphs of a different size
+		LLGlyphAtlas atlas;
+		atlas.init(64, 64, 1);
+		std::vector<U32> evicted;
+
+		std::vector<S32> slots;
+		for (U32 key = 0; key < 9; ++key)
+		{
+			slots.push_back(atlas.allocate(key, 14, 14, 1, evicted));
+		}
+		for (U32 i = 0; i < slots.size(); ++i)
+		{
+			atlas.release(slots[i]);
+		}
+		ensure_equals("all released", atlas.getNumGlyphs(), 0);
+
+		S32 slot = atlas.allocate(100, 60, 40, 2, evicted);
+		ensure("large glyph fits", slot >= 0);
+		ensure_equals("reused first page", atlas.getSlot(slot).mPage, 0);
+		ensure("too large for any page", atlas.allocate(101, 64, 64, 2, evicted) < 0);
+	}
+}
@@ -0,0 +1,290 @@
+/**
+ * @file   llrenderbatch_test.cpp
+ * @brief  Test for llrenderbatch.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <vector>
+
+#include "../test/lltut.h"
+#include "../llrenderbatch.h"
+
+namespace
+{
+	// stand ins for the textures a floater draws with
+	enum
+	{
+		TEX_NONE = 0,
+		TEX_BACKGROUND,
+		TEX_BUTTON,
+		TEX_ICON,
+		TEX_FONT
+	};
+
+	const S32 SCREEN_WIDTH = 320;
+	const S32 SCREEN_HEIGHT = 240;
+
+	// one quad as LLView::draw() would have submitted it
+	struct RecordedDraw
+	{
+		U32 mTexture;
+		S32 mLeft;
+		S32 mBottom;
+		S32 mRight;
+		S32 mTop;
+	};
+}
+
+namespace tut
+{
+	struct LLRenderBatchData
+	{
+		LLRenderBatch::State makeState(U32 texture)
+		{
+			LLRenderBatch::State state;
+			state.mMode = 0;
+			state.mTextureType = 0;
+			state.mTexture = texture;
+			state.mBlendColorSFactor = 4;
+			state.mBlendColorDFactor = 7;
+			state.mBlendAlphaSFactor = 4;
+			state.mBlendAlphaDFactor = 7;
+			return state;
+		}
+
+		void record(U32 texture, S32 left, S32 bottom, S32 right, S32 top)
+		{
+			RecordedDraw draw = { texture, left, bottom, right, top };
+			mDraws.push_back(draw);
+		}
+
+		void recordText(S32 left, S32 bottom, S32 glyphs)
+		{
+			for (S32 i = 0; i < glyphs; ++i)
+			{
+				record(TEX_FONT, left + i * 7, bottom, left + i * 7 + 6, bottom + 10);
+			}
+		}
+
+		// what a floater with a title, a row of buttons and an icon list submits
+		void recordFloater(S32 left, S32 bottom, S32 width, S32 height)
+		{
+			S32 top = bottom + height;
+			S32 right = left + width;
+			record(TEX_BACKGROUND, left, bottom, right, top);
+			recordText(left + 4, top - 14, 12);
+			record(TEX_NONE, left, top - 18, right, top - 17);
+
+			for (S32 button = 0; button < 3; ++button)
+			{
+				S32 button_left = left + 4 + button * 40;
+				record(TEX_BUTTON, button_left, bottom + 4, button_left + 36, bottom + 20);
+				recordText(button_left + 4, bottom + 7, 4);
+			}
+
+			for (S32 row = 0; row < 4; ++row)
+			{
+				S32 row_bottom = top - 34 - row * 14;
+				record(TEX_ICON, left + 4, row_bottom, left + 16, row_bottom + 12);
+				recordText(left + 20, row_bottom + 1, 8);
+			}
+		}
+
+		// draw id + 1 of whatever is on top at each pixel
+		void rasterize(std::vector<U32>& pixels, U32 id, S32 left, S32 bottom, S32 right, S32 top)
+		{
+			for (S32 y = llmax(bottom, 0); y < llmin(top, SCREEN_HEIGHT); ++y)
+			{
+				for (S32 x = llmax(left, 0); x < llmin(right, SCREEN_WIDTH); ++x)
+				{
+					pixels[y * SCREEN_WIDTH + x] = id + 1;
+				}
+			}
+		}
+
+		void renderInOrder(std::vector<U32>& pixels, U32& draw_calls)
+		{
+			pixels.assign(SCREEN_WIDTH * SCREEN_HEIGHT, 0);
+			draw_calls = 0;
+			for (U32 i = 0; i < mDraws.size(); ++i)
+			{
+				const RecordedDraw& draw = mDraws[i];
+				// unbatched LLRender flushes on every texture change
+				if (i == 0 || mDraws[i - 1].mTexture != draw.mTexture)
+				{
+					draw_calls++;
+				}
+				rasterize(pixels, i, draw.mLeft, draw.mBottom, draw.mRight, draw.mTop);
+			}
+		}
+
+		void renderBatched(std::vector<U32>& pixels, U32& draw_calls)
+		{
+			LLRenderBatch batch;
+			for (U32 i = 0; i < mDraws.size(); ++i)
+			{
+				const RecordedDraw& draw = mDraws[i];
+				LLVector3 verts[4];
+				LLVector2 uvs[4];
+				LLColor4U colors[4];
+				verts[0].set(draw.mLeft, draw.mTop, 0.f);
+				verts[1].set(draw.mLeft, draw.mBottom, 0.f);
+				verts[2].set(draw.mRight, draw.mBottom, 0.f);
+				verts[3].set(draw.mRight, draw.mTop, 0.f);
+				for (S32 v = 0; v < 4; ++v)
+				{
+					// carry the draw id through the batch in the vertex color
+					colors[v].set(i & 0xff, (i >> 8) & 0xff, (i >> 16) & 0xff, 255);
+				}
+
+				LLStrider<LLVector3> vert_strider;
+				LLStrider<LLVector2> uv_strider;
+				LLStrider<LLColor4U> color_strider;
+				vert_strider = verts;
+				uv_strider = uvs;
+				color_strider = colors;
+				batch.addDraw(makeState(draw.mTexture), vert_strider, uv_strider, color_strider, 4);
+			}
+			ensure_equals("draws counted", batch.getNumDraws(), (U32) mDraws.size());
+
+			pixels.assign(SCREEN_WIDTH * SCREEN_HEIGHT, 0);
+			const LLRenderBatch::group_list_t& groups = batch.getGroups();
+			draw_calls = groups.size();
+			for (U32 g = 0; g < groups.size(); ++g)
+			{
+				const LLRenderBatch::Group& group = groups[g];
+				ensure_equals("whole quads", group.mVertices.size() % 4, (size_t) 0);
+				for (U32 v = 0; v < group.mVertices.size(); v += 4)
+				{
+					const LLColor4U& color = group.mColors[v];
+					U32 id = color.mV[0] | (color.mV[1] << 8) | (color.mV[2] << 16);
+					ensure_equals("draw kept its state", makeState(mDraws[id].mTexture) == group.mState, true);
+					rasterize(pixels, id,
+						(S32) group.mVertices[v].mV[VX], (S32) group.mVertices[v + 1].mV[VY],
+						(S32) group.mVertices[v + 2].mV[VX], (S32) group.mVertices[v].mV[VY]);
+				}
+			}
+		}
+
+		std::vector<RecordedDraw> mDraws;
+	};
+
+	typedef test_group<LLRenderBatchData> factory;
+	typedef factory::object object;
+}
+
+namespace
+{
+	tut::factory llrenderbatch_test_factory("LLRenderBatch");
+}
+
+namespace tut
+{
+	template<> template<>
+	void object::test<1>()
+	{
+		// a recorded view tree of overlapping floaters draws the same pixels
+		// in far fewer calls
+		recordFloater(10, 10, 140, 100);
+		recordFloater(80, 60, 140, 100);
+		recordFloater(170, 20, 140, 100);
+		recordFloater(40, 130, 140, 100);
+		recordFloater(200, 120, 110, 100);
+
+		std::vector<U32> in_order;
+		std::vector<U32> batched;
+		U32 in_order_calls = 0;
+		U32 batched_calls = 0;
+		renderInOrder(in_order, in_order_calls);
+		renderBatched(batched, batched_calls);
+
+		U32 mismatched = 0;
+		for (U32 i = 0; i < in_order.size(); ++i)
+		{
+			if (in_order[i] != batched[i])
+			{
+				mismatched++;
+			}
+		}
+		ensure_equals("painter's order preserved", mismatched, (U32) 0);
+		ensure("fewer draw calls", batched_calls * 2 < in_order_calls);
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		// a draw only moves back past groups it does not overlap
+		record(TEX_ICON, 0, 0, 10, 10);
+		record(TEX_FONT, 20, 0, 30, 10);
+		record(TEX_ICON, 40, 0, 50, 10);
+		// overlaps the font group, cannot join the first icon group
+		record(TEX_ICON, 25, 5, 35, 15);
+		// touches the icon group's edge without sharing pixels
+		record(TEX_FONT, 50, 0, 60, 10);
+
+		std::vector<U32> in_order;
+		std::vector<U32> batched;
+		U32 in_order_calls = 0;
+		U32 batched_calls = 0;
+		renderInOrder(in_order, in_order_calls);
+		renderBatched(batched, batched_calls);
+
+		ensure_equals("in order calls", in_order_calls, (U32) 4);
+		ensure_equals("batched calls", batched_calls, (U32) 3);
+		ensure("same pixels", in_order == batched);
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		// padding keeps lines from slipping under a neighbouring quad
+		LLRenderBatch batch;
+		LLRenderBatch::State line_state = makeState(TEX_NONE);
+		line_state.mMode = 1;
+		LLRenderBatch::State quad_state = makeState(TEX_ICON);
+
+		LLVector3 line[2] = { LLVector3(0.f, 10.f, 0.f), LLVector3(100.f, 10.f, 0.f) };
+		LLVector3 quad[4] = { LLVector3(0.f, 11.f, 0.f), LLVector3(0.f, 20.f, 0.f), LLVector3(10.f, 20.f, 0.f), LLVector3(10.f, 11.f, 0.f) };
+		LLVector2 uvs[4];
+		LLColor4U colors[4];
+		LLStrider<LLVector3> line_strider;
+		LLStrider<LLVector3> quad_strider;
+		LLStrider<LLVector2> uv_strider;
+		LLStrider<LLColor4U> color_strider;
+		line_strider = line;
+		quad_strider = quad;
+		uv_strider = uvs;
+		color_strider = colors;
+
+		batch.addDraw(line_state, line_strider, uv_strider, color_strider, 2, 2.f);
+		batch.addDraw(quad_state, quad_strider, uv_strider, color_strider, 4);
+		batch.addDraw(line_state, line_strider, uv_strider, color_strider, 2, 2.f);
+		ensure_equals("line not merged under quad", batch.getGroups().size(), (size_t) 3);
+
+		batch.clear();
+		ensure("cleared", batch.empty());
+		ensure_equals("draws reset", batch.getNumDraws(), (U32) 0);
+	}
+}
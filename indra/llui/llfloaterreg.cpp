@@ -32,6 +32,9 @@
 #include "llfloater.h"
 #include "llmultifloater.h"
 #include "llfloaterreglistener.h"
+#include "llcallbacklist.h"
+#include "llfasttimer.h"
+#include "lltrace.h"
 
 //*******************************************************
 
@@ -42,9 +45,17 @@ LLFloaterReg::build_map_t LLFloaterReg::sBuildMap;
 std::map<std::string,std::string> LLFloaterReg::sGroupMap;
 bool LLFloaterReg::sBlockShowFloaters = false;
 std::set<std::string> LLFloaterReg::sAlwaysShowableList;
+std::list<std::string> LLFloaterReg::sPreloadQueue;
+LLSD LLFloaterReg::sUsageHistory;
 
 static LLFloaterRegListener sFloaterRegListener;
 
+static LLTrace::BlockTimerStatHandle FTM_BUILD_FLOATER("Build Floater");
+// One stat for all floaters: stat slots are reserved before any thread
+// starts, while floaters register later by name.  The build time of each
+// floater is kept in FloaterUsageHistory instead.
+static LLTrace::EventStatHandle<F64Seconds> FLOATER_BUILD_TIME("floaterbuildtime", "Seconds to build a floater from XUI");
+
 //*******************************************************
 
 //static
@@ -146,6 +157,8 @@ LLFloater* LLFloaterReg::getInstance(const std::string& name, const LLSD& key)
 			const std::string& groupname = sGroupMap[name];
 			if (!groupname.empty())
 			{
+				LL_RECORD_BLOCK_TIME(FTM_BUILD_FLOATER);
+				LLTimer build_timer;
 				instance_list_t& list = sInstanceMap[groupname];
 
 				res = build_func(key);
@@ -175,6 +188,14 @@ LLFloater* LLFloaterReg::getInstance(const std::string& name, const LLSD& key)
 				gFloaterView->adjustToFitScreen(res, false);
 
 				list.push_back(res);
+
+				const F64 build_seconds(build_timer.getElapsedTimeF64());
+				LLTrace::record(FLOATER_BUILD_TIME, F64Seconds(build_seconds));
+				LL_DEBUGS("FloaterReg") << "Built floater '" << name << "' in " << build_seconds << "s" << LL_ENDL;
+				if (key.isUndefined())
+				{
+					recordFloaterUse(name, build_seconds);
+				}
 			}
 		}
 		if (!res)
@@ -250,6 +271,10 @@ LLFloater* LLFloaterReg::showInstance(const std::string& name, const LLSD& key,
 	LLFloater* instance = getInstance(name, key); 
 	if (instance) 
 	{
+		if (key.isUndefined())
+		{
+			recordFloaterUse(name, -1.0);
+		}
 		instance->openFloater(key);
 		if (focus)
 			instance->setFocus(TRUE);
@@ -293,6 +318,108 @@ bool LLFloaterReg::instanceVisible(const std::string& name, const LLSD& key)
 	return LLFloater::isVisible(instance);
 }
 
+//static
+LLSD& LLFloaterReg::getUsageHistory()
+{
+	if (sUsageHistory.isUndefined())
+	{
+		sUsageHistory = LLUI::sSettingGroups["config"]->getLLSD("FloaterUsageHistory");
+		if (!sUsageHistory.isMap())
+		{
+			sUsageHistory = LLSD::emptyMap();
+		}
+	}
+	return sUsageHistory;
+}
+
+// Keeps per floater open counts and the last build time, which
+// startPreloading() ranks floaters by.  A negative build_seconds counts
+// an open.  Updated in place, the setting is only written on save.
+//static
+void LLFloaterReg::recordFloaterUse(const std::string& name, F64 build_seconds)
+{
+	LLSD& entry = getUsageHistory()[name];
+	if (build_seconds < 0.0)
+	{
+		entry["opens"] = entry["opens"].asInteger() + 1;
+	}
+	else
+	{
+		entry["build_time"] = build_seconds;
+	}
+}
+
+//static
+void LLFloaterReg::saveUsageHistory()
+{
+	if (sUsageHistory.isDefined())
+	{
+		LLUI::sSettingGroups["config"]->setLLSD("FloaterUsageHistory", sUsageHistory);
+	}
+}
+
+//static
+void LLFloaterReg::startPreloading()
+{
+	static LLCachedControl<bool> preload(*LLUI::sSettingGroups["config"], "PreloadFloaters", false);
+	static LLCachedControl<U32> max_count(*LLUI::sSettingGroups["config"], "PreloadFloatersMaxCount", 5);
+	if (!preload || !sPreloadQueue.empty())
+	{
+		return;
+	}
+
+	// rank by how often each floater was opened, ignoring one-offs
+	std::multimap<S32, std::string> ranked;
+	const LLSD& history = getUsageHistory();
+	for (LLSD::map_const_iterator it = history.beginMap(); it != history.endMap(); ++it)
+	{
+		const S32 opens = it->second["opens"].asInteger();
+		if (opens > 1 && sBuildMap.find(it->first) != sBuildMap.end())
+		{
+			ranked.insert(std::make_pair(opens, it->first));
+		}
+	}
+	for (std::multimap<S32, std::string>::reverse_iterator it = ranked.rbegin();
+		 it != ranked.rend() && sPreloadQueue.size() < max_count; ++it)
+	{
+		sPreloadQueue.push_back(it->second);
+	}
+
+	if (!sPreloadQueue.empty())
+	{
+		gIdleCallbacks.addFunction(preloadIdle);
+	}
+}
+
+// Builds at most one queued floater per frame, and only once the mouse
+// has rested and frames are fast, as a floater build can't be split up.
+//static
+void LLFloaterReg::preloadIdle(void*)
+{
+	static LLCachedControl<F32> idle_time(*LLUI::sSettingGroups["config"], "PreloadFloatersIdleTime", 2.f);
+	static LLCachedControl<F32> quiet_frame_time(*LLUI::sSettingGroups["config"], "PreloadFloatersQuietFrameTime", 0.025f);
+
+	if (sPreloadQueue.empty())
+	{
+		gIdleCallbacks.deleteFunction(preloadIdle);
+		return;
+	}
+	if (sBlockShowFloaters
+		|| LLUI::getMouseIdleTime() < idle_time
+		|| LLFrameTimer::getFrameDeltaTimeF32() > quiet_frame_time)
+	{
+		return;
+	}
+
+	const std::string name = sPreloadQueue.front();
+	sPreloadQueue.pop_front();
+	if (!findInstance(name))
+	{
+		LL_DEBUGS("FloaterReg") << "Preloading floater '" << name << "'" << LL_ENDL;
+		getInstance(name);
+	}
+}
+
 //static
 void LLFloaterReg::showInitialVisibleInstances() 
 {
@@ -71,6 +71,18 @@ private:
 	 * Defines list of floater names that can be shown despite state of sBlockShowFloaters.
 	 */
 	static std::set<std::string> sAlwaysShowableList;
+	/**
+	 * Floaters still to be built ahead of use, most used first.
+	 */
+	static std::list<std::string> sPreloadQueue;
+	/**
+	 * Working copy of FloaterUsageHistory, written back by saveUsageHistory().
+	 */
+	static LLSD sUsageHistory;
+
+	static LLSD& getUsageHistory();
+	static void recordFloaterUse(const std::string& name, F64 build_seconds);
+	static void preloadIdle(void*);
 	
 public:
 	// Registration
@@ -149,6 +161,13 @@ public:
 	}
 
 	static void blockShowFloaters(bool value) { sBlockShowFloaters = value;}
+
+	// Builds the floaters opened most often in earlier sessions while the
+	// user is idle, so their first open does not stall.  Does nothing
+	// unless PreloadFloaters is set.
+	static void startPreloading();
+	// Stores the floater usage gathered this session in FloaterUsageHistory.
+	static void saveUsageHistory();
 	
 	static U32 getVisibleFloaterInstanceCount();
 };
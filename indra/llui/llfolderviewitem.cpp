@@ -933,7 +933,8 @@ LLFolderViewFolder::LLFolderViewFolder( const LLFolderViewItem::Params& p ):
 	mTargetHeight(0.f),
 	mAutoOpenCountdown(0.f),
 	mLastArrangeGeneration( -1 ),
-	mLastCalculatedWidth(0)
+	mLastCalculatedWidth(0),
+	mArrangedItemsValid(false)
 {
 	// folder might have children that are not loaded yet. Mark it as incomplete until chance to check it.
 	mIsFolderComplete = false;
@@ -1042,15 +1043,19 @@ S32 LLFolderViewFolder::arrange( S32* width, S32* height )
 		// set last arrange generation first, in case children are animating
 		// and need to be arranged again
 		mLastArrangeGeneration = getRoot()->getArrangeGeneration();
+		mArrangedItems.clear();
+		mArrangedItemsValid = false;
 		if (isOpen())
 		{
 			// Add sizes of children
 			S32 parent_item_height = getRect().getHeight();
+			S32 child_count = 0;
 
 			for(folders_t::iterator fit = mFolders.begin(); fit != mFolders.end(); ++fit)
 			{
 				LLFolderViewFolder* folderp = (*fit);
 				folderp->setVisible(folderp->isPotentiallyVisible());
+				child_count++;
 
 				if (folderp->getVisible())
 				{
@@ -1063,6 +1068,7 @@ S32 LLFolderViewFolder::arrange( S32* width, S32* height )
 					running_height += (F32)child_height;
 					*width = llmax(*width, child_width);
 					folderp->setOrigin( 0, child_top - folderp->getRect().getHeight() );
+					mArrangedItems.add(folderp, folderp->getRect().mTop, folderp->getRect().mBottom);
 				}
 			}
 			for(items_t::iterator iit = mItems.begin();
@@ -1070,6 +1076,7 @@ S32 LLFolderViewFolder::arrange( S32* width, S32* height )
 			{
 				LLFolderViewItem* itemp = (*iit);
 				itemp->setVisible(itemp->isPotentiallyVisible());
+				child_count++;
 
 				if (itemp->getVisible())
 				{
@@ -1084,8 +1091,12 @@ S32 LLFolderViewFolder::arrange( S32* width, S32* height )
 					running_height += (F32)child_height;
 					*width = llmax(*width, child_width);
 					itemp->setOrigin( 0, child_top - itemp->getRect().getHeight() );
+					mArrangedItems.add(itemp, itemp->getRect().mTop, itemp->getRect().mBottom);
 				}
 			}
+
+			// views other than our items would be missed by drawArrangedItems()
+			mArrangedItemsValid = (child_count == getChildCount());
 		}
 
 		mTargetHeight = target_height;
@@ -1553,6 +1564,8 @@ void LLFolderViewFolder::extractItem( LLFolderViewItem* item )
 	getViewModelItem()->removeChild(item->getViewModelItem());
 	//because an item is going away regardless of filter status, force rearrange
 	requestArrange();
+	mArrangedItems.clear();
+	mArrangedItemsValid = false;
 	removeChild(item);
 }
 
@@ -1935,12 +1948,45 @@ void LLFolderViewFolder::draw()
 	// draw children if root folder, or any other folder that is open or animating to closed state
 	if( getRoot() == this || (isOpen() || mCurHeight != mTargetHeight ))
 	{
-		LLView::draw();
+		if (mArrangedItemsValid && getRoot() != this)
+		{
+			drawArrangedItems();
+		}
+		else
+		{
+			LLView::draw();
+		}
 	}
 
 	mExpanderHighlighted = FALSE;
 }
 
+// Same as LLView::drawChildren() but only visits the children that can be on
+// screen, found by binary search since arrange() stacks them top to bottom.
+// Keeps drawing cost proportional to the rows shown rather than the size of
+// the folder.
+void LLFolderViewFolder::drawArrangedItems()
+{
+	LLRect screen_rect = LLUI::getRootView()->getLocalRect();
+	screen_rect.intersectWith(LLUI::sDirtyRect);
+	const S32 visible_top = screen_rect.mTop - LLFontGL::sCurOrigin.mY;
+	const S32 visible_bottom = screen_rect.mBottom - LLFontGL::sCurOrigin.mY;
+
+	LLFolderViewRows::const_iterator it, end;
+	mArrangedItems.getRows(visible_top, visible_bottom, it, end);
+	++sDepth;
+	for (; it != end; ++it)
+	{
+		// children falling out of a closing folder are hidden but arranged
+		LLFolderViewItem* itemp = *it;
+		if (itemp->getVisible() && itemp->getRect().isValid())
+		{
+			drawOnScreenChild(itemp);
+		}
+	}
+	--sDepth;
+}
+
 // this does prefix traversal, as folders are listed above their contents
 LLFolderViewItem* LLFolderViewFolder::getNextFromChild( LLFolderViewItem* item, BOOL include_children )
 {
@@ -27,6 +27,7 @@
 #define LLFOLDERVIEWITEM_H
 
 #include "llflashtimer.h"
+#include "llfolderviewrows.h"
 #include "llview.h"
 #include "lluiimage.h"
 
@@ -306,6 +307,7 @@ protected:
 	friend class LLUICtrlFactory;
 
 	void updateLabelRotation();
+	void drawArrangedItems();
 	virtual bool isCollapsed() { return FALSE; }
 
 public:
@@ -324,6 +326,10 @@ protected:
 	S32			mLastArrangeGeneration;
 	S32			mLastCalculatedWidth;
 	bool		mNeedsSort;
+	// visible children top to bottom as of the last arrange(), so that
+	// draw() can skip straight to the ones on screen in long folders
+	LLFolderViewRows mArrangedItems;
+	bool		mArrangedItemsValid;
 
 public:
 	typedef enum e_recurse_type
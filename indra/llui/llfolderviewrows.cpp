@@ -0,0 +1,57 @@
+/**
+ * @file llfolderviewrows.cpp
+ * @brief Index of the rows of an arranged folder by their height.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llfolderviewrows.h"
+
+#include <algorithm>
+#include <functional>
+
+void LLFolderViewRows::clear()
+{
+	mItems.clear();
+	mTops.clear();
+	mBottoms.clear();
+}
+
+void LLFolderViewRows::add(LLFolderViewItem* item, S32 top, S32 bottom)
+{
+	llassert(mBottoms.empty() || top <= mTops.back());
+	mItems.push_back(item);
+	mTops.push_back(top);
+	mBottoms.push_back(bottom);
+}
+
+void LLFolderViewRows::getRows(S32 top, S32 bottom, const_iterator& first, const_iterator& last) const
+{
+	// the first row that ends at or below top, and the first after it that
+	// starts below bottom
+	const S32 first_index = std::lower_bound(mBottoms.begin(), mBottoms.end(), top, std::greater<S32>()) - mBottoms.begin();
+	const S32 last_index = std::lower_bound(mTops.begin() + first_index, mTops.end(), bottom - 1, std::greater<S32>()) - mTops.begin();
+	first = mItems.begin() + first_index;
+	last = mItems.begin() + last_index;
+}
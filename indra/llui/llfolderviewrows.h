@@ -0,0 +1,66 @@
+/**
+ * @file llfolderviewrows.h
+ * @brief Index of the rows of an arranged folder by their height.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFOLDERVIEWROWS_H
+#define LL_LLFOLDERVIEWROWS_H
+
+#include <vector>
+
+class LLFolderViewItem;
+
+//-------------------------------------------------------------------
+// LLFolderViewRows
+//
+// The visible children of an open folder as LLFolderViewFolder::arrange()
+// stacks them, top to bottom, with the running heights arrange() placed
+// them at.  Finding the rows that overlap a span of the folder is then a
+// binary search, however many rows there are.
+//-------------------------------------------------------------------
+class LLFolderViewRows
+{
+public:
+	typedef std::vector<LLFolderViewItem*>::const_iterator const_iterator;
+
+	void clear();
+
+	// rows must be added top to bottom, each no higher than the last
+	void add(LLFolderViewItem* item, S32 top, S32 bottom);
+
+	bool empty() const					{ return mItems.empty(); }
+	U32 size() const					{ return mItems.size(); }
+
+	// [first, last) are the rows overlapping bottom to top, in the
+	// folder's coordinates
+	void getRows(S32 top, S32 bottom, const_iterator& first, const_iterator& last) const;
+
+private:
+	std::vector<LLFolderViewItem*> mItems;
+	// both descending, as the rows go down the folder
+	std::vector<S32> mTops;
+	std::vector<S32> mBottoms;
+};
+
+#endif // LL_LLFOLDERVIEWROWS_H
@@ -38,6 +38,8 @@ LLScreenClipRect::LLScreenClipRect(const LLRect& rect, BOOL enabled)
 {
 	if (mEnabled)
 	{
+		// queued text belongs to the old clipping region
+		LLFontGL::flushBatch();
 		pushClipRect(rect);
 		mScissorState.setEnabled(!sClipRectStack.empty());
 		updateScissorRegion();
@@ -80,9 +82,11 @@ void LLScreenClipRect::popClipRect()
 //static
 void LLScreenClipRect::updateScissorRegion()
 {
+	// finish any deferred calls in the old clipping region, batched text
+	// included, even when leaving the last one turns scissoring off
+	LLFontGL::flushBatch();
 	if (sClipRectStack.empty()) return;
 
-	// finish any deferred calls in the old clipping region
 	gGL.flush();
 
 	LLRect rect = sClipRectStack.top();
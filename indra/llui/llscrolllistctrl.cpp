@@ -1968,32 +1968,25 @@ LLScrollListItem* LLScrollListCtrl::hitItem( S32 x, S32 y )
 
 	updateSort();
 
-	LLRect item_rect;
-	item_rect.setLeftTopAndSize( 
-		mItemListRect.mLeft,
-		mItemListRect.mTop,
-		mItemListRect.getWidth(),
-		mLineHeight );
-
 	// allow for partial line at bottom
 	S32 num_page_lines = getLinesPerPage();
 
-	S32 line = 0;
-	item_list::iterator iter;
-	for(iter = mItemList.begin(); iter != mItemList.end(); iter++)
+	// every row is mLineHeight tall, so the row under the cursor can be
+	// worked out directly instead of walking the whole list
+	if (mLineHeight > 0
+		&& mItemListRect.mLeft <= x && x < mItemListRect.mRight
+		&& y < mItemListRect.mTop)
 	{
-		LLScrollListItem* item  = *iter;
-		if( mScrollLines <= line && line < mScrollLines + num_page_lines )
+		S32 page_line = (mItemListRect.mTop - 1 - y) / mLineHeight;
+		S32 line = mScrollLines + page_line;
+		if (page_line < num_page_lines && line < (S32)mItemList.size())
 		{
-			if( item->getEnabled() && item_rect.pointInRect( x, y ) )
+			LLScrollListItem* item = mItemList[line];
+			if (item->getEnabled())
 			{
 				hit_item = item;
-				break;
 			}
-
-			item_rect.translate(0, -mLineHeight);
 		}
-		line++;
 	}
 
 	return hit_item;
@@ -1233,7 +1233,12 @@ void LLTextBase::draw()
 		}
  
 		drawSelectionBackground();
+
+		// segments share one UI transform, submit their glyphs together
+		LLFontGL::beginBatch();
 		drawText();
+		LLFontGL::endBatch();
+
 		drawCursor();
 	}
  
@@ -2030,6 +2035,12 @@ void LLTextBase::appendTextImpl(const std::string &new_text, const LLStyle::Para
 	LLStyle::Params style_params(input_params);
 	style_params.fillFrom(getStyleParams());
 
+	if (style_params.font())
+	{
+		// chat text is usually drawn right after it arrives
+		style_params.font()->prefetchGlyphs(utf8str_to_wstring(new_text));
+	}
+
 	S32 part = (S32)LLTextParser::WHOLE;
 	if (mParseHTML && !style_params.is_link) // Don't search for URLs inside a link segment (STORM-358).
 	{
@@ -3616,6 +3627,8 @@ F32	LLImageTextSegment::draw(S32 start, S32 end, S32 selection_start, S32 select
 			S32 text_center = draw_rect.mTop - (draw_rect.getHeight() / 2);
 			// Align image to center of draw rect
 			S32 image_bottom = text_center - (style_image_height / 2);
+			// text before the image goes under it, text after over it
+			LLFontGL::flushBatch();
 			image->draw(draw_rect.mLeft, image_bottom, 
 				style_image_width, style_image_height, color);
 			
@@ -164,7 +164,39 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
 		paths.push_back(xui_filename);
 	}
 
-	return LLXMLNode::getLayeredXMLNode(root, paths);
+	// Floaters and panels read their files again every time they are built,
+	// so keep the merged tree around until one of the layers changes on disk.
+	std::string key;
+	std::vector<time_t> mod_times;
+	for (std::vector<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++it)
+	{
+		llstat stat_data;
+		mod_times.push_back(LLFile::stat(*it, &stat_data) == 0 ? stat_data.st_mtime : 0);
+		key += *it;
+		key += '\n';
+	}
+
+	layered_xml_cache_t& cache = instance().mLayeredXMLCache;
+	layered_xml_cache_t::iterator found = cache.find(key);
+	if (found != cache.end() && found->second.mModTimes == mod_times)
+	{
+		root = found->second.mRoot->deepCopy();
+		return true;
+	}
+
+	if (!LLXMLNode::getLayeredXMLNode(root, paths))
+	{
+		if (found != cache.end())
+		{
+			cache.erase(found);
+		}
+		return false;
+	}
+
+	LayeredXMLEntry& entry = cache[key];
+	entry.mRoot = root->deepCopy();
+	entry.mModTimes = mod_times;
+	return true;
 }
 
 
@@ -295,6 +295,16 @@ private:
 
 	class LLPanel*		mDummyPanel;
 	std::vector<std::string>	mFileNames;
+
+	// Layered XUI files as last parsed, keyed by their layer paths.  Callers
+	// get copies, since reading params out of a tree consumes it.
+	struct LayeredXMLEntry
+	{
+		LLXMLNodePtr		mRoot;
+		std::vector<time_t>	mModTimes;
+	};
+	typedef std::map<std::string, LayeredXMLEntry> layered_xml_cache_t;
+	layered_xml_cache_t	mLayeredXMLCache;
 };
 
 // this is here to make gcc happy with reference to LLUICtrlFactory
@@ -1135,26 +1135,7 @@ void LLView::drawChildren()
 				LLRect screen_rect = viewp->calcScreenRect();
 				if ( rootp->getLocalRect().overlaps(screen_rect)  && LLUI::sDirtyRect.overlaps(screen_rect))
 				{
-					LLUI::pushMatrix();
-					{
-						LLUI::translate((F32)viewp->getRect().mLeft, (F32)viewp->getRect().mBottom);
-						// flag the fact we are in draw here, in case overridden draw() method attempts to remove this widget
-						viewp->mInDraw = true;
-						viewp->draw();
-						viewp->mInDraw = false;
-
-						if (sDebugRects)
-						{
-							viewp->drawDebugRect();
-
-							// Check for bogus rectangle
-							if (!getRect().isValid())
-							{
-								LL_WARNS() << "Bogus rectangle for " << getName() << " with " << mRect << LL_ENDL;
-							}
-						}
-					}
-					LLUI::popMatrix();
+					drawOnScreenChild(viewp);
 				}
 			}
 
@@ -1163,6 +1144,32 @@ void LLView::drawChildren()
 	}
 }
 
+// Draws a child drawChildren() found visible and on screen, for views that
+// find those their own way.  Callers keep sDepth.
+void LLView::drawOnScreenChild(LLView* viewp)
+{
+	LLUI::pushMatrix();
+	{
+		LLUI::translate((F32)viewp->getRect().mLeft, (F32)viewp->getRect().mBottom);
+		// flag the fact we are in draw here, in case overridden draw() method attempts to remove this widget
+		viewp->mInDraw = true;
+		viewp->draw();
+		viewp->mInDraw = false;
+
+		if (sDebugRects)
+		{
+			viewp->drawDebugRect();
+
+			// Check for bogus rectangle
+			if (!getRect().isValid())
+			{
+				LL_WARNS() << "Bogus rectangle for " << getName() << " with " << mRect << LL_ENDL;
+			}
+		}
+	}
+	LLUI::popMatrix();
+}
+
 void LLView::dirtyRect()
 {
 	LLView* child = getParent();
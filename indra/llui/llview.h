@@ -535,6 +535,7 @@ protected:
 	void			drawDebugRect();
 	void			drawChild(LLView* childp, S32 x_offset = 0, S32 y_offset = 0, BOOL force_draw = FALSE);
 	void			drawChildren();
+	void			drawOnScreenChild(LLView* viewp);
 	bool			visibleAndContains(S32 local_x, S32 local_Y);
 	bool			visibleEnabledAndContains(S32 local_x, S32 local_y);
 	void			logMouseEvent();
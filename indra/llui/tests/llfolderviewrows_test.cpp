@@ -0,0 +1,183 @@
+/**
+ * @file   llfolderviewrows_test.cpp
+ * @brief  Test and long folder benchmark for llfolderviewrows.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <vector>
+
+#include "../llfolderviewrows.h"
+#include "lltut.h"
+
+#include "llrand.h"
+#include "lltimer.h"
+
+namespace
+{
+	// the index only passes items along, these stand in for them
+	const U32 MAX_ROWS = 100000;
+	char sItems[MAX_ROWS];
+
+	LLFolderViewItem* item(U32 index)
+	{
+		return reinterpret_cast<LLFolderViewItem*>(&sItems[index]);
+	}
+
+	U32 item_index(LLFolderViewItem* itemp)
+	{
+		return reinterpret_cast<char*>(itemp) - sItems;
+	}
+
+	// where a row was put, as LLFolderViewFolder keeps it in its rect
+	struct Row
+	{
+		S32 mTop;
+		S32 mBottom;
+	};
+}
+
+namespace tut
+{
+	struct llfolderviewrows_data
+	{
+		// Stacks count rows down from the top of the folder the way
+		// LLFolderViewFolder::arrange() does: subfolders first, some of
+		// them open with their contents below their own row, then items.
+		S32 arrange(U32 count, LLFolderViewRows& rows)
+		{
+			const S32 ITEM_HEIGHT = 20;
+			rows.clear();
+			mRows.clear();
+			S32 running_height = 0;
+			for (U32 i = 0; i < count; ++i)
+			{
+				S32 height = ITEM_HEIGHT;
+				if (i < count / 10 && i % 7 == 0)
+				{	// an open subfolder
+					height += ITEM_HEIGHT * (1 + ll_rand(5));
+				}
+				Row row;
+				row.mTop = -running_height;
+				row.mBottom = row.mTop - height;
+				running_height += height;
+				rows.add(item(i), row.mTop, row.mBottom);
+				mRows.push_back(row);
+			}
+			return running_height;
+		}
+
+		// what LLView::drawChildren() did, every row tested against the span
+		void checkRows(const LLFolderViewRows& rows, S32 top, S32 bottom)
+		{
+			LLFolderViewRows::const_iterator it, end;
+			rows.getRows(top, bottom, it, end);
+			for (U32 i = 0; i < mRows.size(); ++i)
+			{
+				const bool overlaps = mRows[i].mBottom <= top && mRows[i].mTop >= bottom;
+				if (overlaps)
+				{
+					ensure("row found", it != end);
+					ensure_equals("row in order", item_index(*it), i);
+					++it;
+				}
+			}
+			ensure("no more rows", it == end);
+		}
+
+		std::vector<Row> mRows;
+	};
+	typedef test_group<llfolderviewrows_data> llfolderviewrows_test;
+	typedef llfolderviewrows_test::object llfolderviewrows_object;
+	tut::llfolderviewrows_test tllfolderviewrows("LLFolderViewRows");
+
+	template<> template<>
+	void llfolderviewrows_object::test<1>()
+	{
+		// the rows found are those overlapping the span, in order
+		LLFolderViewRows rows;
+		LLFolderViewRows::const_iterator it, end;
+		rows.getRows(100, -100, it, end);
+		ensure("none in an empty folder", it == end);
+
+		const S32 height = arrange(500, rows);
+		ensure_equals("rows", rows.size(), 500U);
+
+		checkRows(rows, 0, -300);					// the top of the folder
+		checkRows(rows, -height + 300, -height);	// its bottom
+		checkRows(rows, 200, -40);					// the folder scrolled down
+		checkRows(rows, -20, -20);					// one edge only
+		checkRows(rows, -21, -39);					// inside one row
+		checkRows(rows, 500, 100);					// above it all
+		checkRows(rows, -height - 1, -height - 300);	// below it all
+		for (U32 i = 0; i < 200; ++i)
+		{
+			const S32 top = -ll_rand(height);
+			checkRows(rows, top, top - ll_rand(600));
+		}
+	}
+
+	template<> template<>
+	void llfolderviewrows_object::test<2>()
+	{
+		// Time to open a folder of 100k rows and scroll it a page at a time,
+		// finding the rows on screen by search and by testing every row
+		const S32 PAGE = 600;
+		LLFolderViewRows rows;
+		LLTimer timer;
+		const S32 height = arrange(MAX_ROWS, rows);
+		const F64 arrange_time = timer.getElapsedTimeF64();
+
+		U32 searched = 0;
+		timer.reset();
+		for (S32 top = 0; top > -height; top -= PAGE)
+		{
+			LLFolderViewRows::const_iterator it, end;
+			rows.getRows(top, top - PAGE, it, end);
+			searched += end - it;
+		}
+		const F64 search_time = timer.getElapsedTimeF64();
+
+		U32 tested = 0;
+		timer.reset();
+		for (S32 top = 0; top > -height; top -= PAGE)
+		{
+			for (U32 i = 0; i < mRows.size(); ++i)
+			{
+				if (mRows[i].mBottom <= top && mRows[i].mTop >= top - PAGE)
+				{
+					++tested;
+				}
+			}
+		}
+		const F64 test_time = timer.getElapsedTimeF64();
+
+		ensure_equals("same rows", searched, tested);
+		const U32 pages = (height + PAGE - 1) / PAGE;
+		LL_INFOS() << MAX_ROWS << " rows, " << pages << " pages: arranged in "
+				   << arrange_time * 1000.0 << "ms, a page found in "
+				   << search_time * 1000000.0 / pages << "us by search, "
+				   << test_time * 1000000.0 / pages << "us testing every row" << LL_ENDL;
+	}
+}
@@ -43,6 +43,7 @@
 #include "llrect.h"
 #include "llxmltree.h"
 #include "llsdserialize.h"
+#include "llthread.h"
 
 #if LL_RELEASE_WITH_DEBUG_INFO || LL_DEBUG
 #define CONTROL_ERRS LL_ERRS("ControlErrors")
@@ -327,8 +328,65 @@ LLSD LLControlVariable::getSaveValue() const
 
 LLPointer<LLControlVariable> LLControlGroup::getControl(const std::string& name)
 {
-	ctrl_name_table_t::iterator iter = mNameTable.find(name);
-	return iter == mNameTable.end() ? LLPointer<LLControlVariable>() : iter->second;
+	return findControl(name);
+}
+
+LLControlVariable* LLControlGroup::findControl(const std::string& name)
+{
+	if (sCountLookups)
+	{
+		countLookup(getKey(), name);
+	}
+	ctrl_hash_table_t::const_iterator iter = mHashTable.find(name);
+	return iter == mHashTable.end() ? NULL : iter->second;
+}
+
+bool LLControlGroup::sCountLookups = false;
+U32 LLControlGroup::sCountingThread = 0;
+std::map<std::string, U32> LLControlGroup::sLookupCounts;
+
+//static
+void LLControlGroup::setLookupCounting(bool enable)
+{
+	if (enable != sCountLookups)
+	{
+		sLookupCounts.clear();
+		sCountingThread = LLThread::currentID();
+		sCountLookups = enable;
+	}
+}
+
+//static
+void LLControlGroup::countLookup(const std::string& group, const std::string& name)
+{
+	// the counts are not locked, other threads' lookups are left out
+	if (LLThread::currentID() == sCountingThread)
+	{
+		++sLookupCounts[group + ":" + name];
+	}
+}
+
+//static
+void LLControlGroup::logLookupCounts(U32 frames, F32 min_per_frame)
+{
+	if (!sCountLookups || !frames)
+	{
+		return;
+	}
+
+	std::multimap<U32, std::string> sorted;
+	for (std::map<std::string, U32>::const_iterator it = sLookupCounts.begin(); it != sLookupCounts.end(); ++it)
+	{
+		if ((F32) it->second >= min_per_frame * frames)
+		{
+			sorted.insert(std::make_pair(it->second, it->first));
+		}
+	}
+	for (std::multimap<U32, std::string>::reverse_iterator it = sorted.rbegin(); it != sorted.rend(); ++it)
+	{
+		LL_INFOS("SettingsLookups") << llformat("%8.1f", (F32) it->first / frames) << " per frame  " << it->second << LL_ENDL;
+	}
+	sLookupCounts.clear();
 }
 
 
@@ -360,6 +418,7 @@ LLControlGroup::~LLControlGroup()
 
 void LLControlGroup::cleanup()
 {
+	mHashTable.clear();
 	mNameTable.clear();
 }
 
@@ -379,7 +438,7 @@ std::string LLControlGroup::typeEnumToString(eControlType typeenum)
 
 LLControlVariable* LLControlGroup::declareControl(const std::string& name, eControlType type, const LLSD initial_val, const std::string& comment, LLControlVariable::ePersist persist, BOOL hidefromsettingseditor)
 {
-	LLControlVariable* existing_control = getControl(name);
+	LLControlVariable* existing_control = findControl(name);
 	if (existing_control)
  	{
 		if ((persist != LLControlVariable::PERSIST_NO) && existing_control->isType(type))
@@ -402,6 +461,7 @@ LLControlVariable* LLControlGroup::declareControl(const std::string& name, eCont
 	// if not, create the control and add it to the name table
 	LLControlVariable* control = new LLControlVariable(name, type, initial_val, comment, persist, hidefromsettingseditor);
 	mNameTable[name] = control;	
+	mHashTable[name] = control;
 	return control;
 }
 
@@ -536,8 +596,7 @@ LLSD LLControlGroup::getLLSD(const std::string& name)
 
 BOOL LLControlGroup::controlExists(const std::string& name)
 {
-	ctrl_name_table_t::iterator iter = mNameTable.find(name);
-	return iter != mNameTable.end();
+	return findControl(name) != NULL;
 }
 
 
@@ -607,7 +666,7 @@ void LLControlGroup::setUntypedValue(const std::string& name, const LLSD& val)
 		return;
 	}
 
-	LLControlVariable* control = getControl(name);
+	LLControlVariable* control = findControl(name);
 	
 	if (control)
 	{
@@ -898,7 +957,7 @@ U32 LLControlGroup::loadFromFile(const std::string& filename, bool set_default_v
 		}
 		
 		// If the control exists just set the value from the input file.
-		LLControlVariable* existing_control = getControl(name);
+		LLControlVariable* existing_control = findControl(name);
 		if(existing_control)
 		{
 			// set_default_values is true when we're loading the initial,
@@ -48,6 +48,7 @@
 #endif
 
 #include <boost/bind.hpp>
+#include <boost/unordered_map.hpp>
 
 #if LL_WINDOWS
 	#pragma warning (push)
@@ -191,8 +192,18 @@ class LLControlGroup : public LLInstanceTracker<LLControlGroup, std::string>
 protected:
 	typedef std::map<std::string, LLControlVariablePtr > ctrl_name_table_t;
 	ctrl_name_table_t mNameTable;
+	// the same controls hashed by name, for the lookups behind every getter
+	typedef boost::unordered_map<std::string, LLControlVariable*> ctrl_hash_table_t;
+	ctrl_hash_table_t mHashTable;
 	static const std::string mTypeString[TYPE_COUNT];
 
+	LLControlVariable* findControl(const std::string& name);
+	static void countLookup(const std::string& group, const std::string& name);
+
+	static bool sCountLookups;
+	static U32 sCountingThread;
+	static std::map<std::string, U32> sLookupCounts;
+
 public:
 	static eControlType typeStringToEnum(const std::string& typestr);
 	static std::string typeEnumToString(eControlType typeenum);	
@@ -205,6 +216,15 @@ public:
 
 	LLControlVariablePtr getControl(const std::string& name);
 
+	// Counts lookups by name made from the calling thread, to find the
+	// settings per frame code reads often enough to deserve an
+	// LLCachedControl.
+	static void setLookupCounting(bool enable);
+	static bool isLookupCounting() { return sCountLookups; }
+	// Logs the names looked up at least min_per_frame times a frame on
+	// average over the last frames frames, then starts counting afresh.
+	static void logLookupCounts(U32 frames, F32 min_per_frame);
+
 	struct ApplyFunctor
 	{
 		virtual ~ApplyFunctor() {};
@@ -246,7 +266,7 @@ public:
 	// generic getter
 	template<typename T> T get(const std::string& name)
 	{
-		LLControlVariable* control = getControl(name);
+		LLControlVariable* control = findControl(name);
 		LLSD value;
 		eControlType type = TYPE_COUNT;
 
@@ -280,7 +300,7 @@ public:
 	// generic setter
 	template<typename T> void set(const std::string& name, const T& val)
 	{
-		LLControlVariable* control = getControl(name);
+		LLControlVariable* control = findControl(name);
 	
 		if (control && control->isType(get_control_type<T>()))
 		{
@@ -390,6 +410,8 @@ private:
     boost::signals2::scoped_connection	mConnection;
 };
 
+// The cheap way to read a setting from per frame code: declared static,
+// the name is looked up once and each read is a plain member access.
 template <typename T>
 class LLCachedControl
 {
@@ -123,7 +123,7 @@ LLXMLNode::LLXMLNode(const LLXMLNode& rhs) :
 	mPrecision(rhs.mPrecision),
 	mType(rhs.mType),
 	mEncoding(rhs.mEncoding),
-	mLineNumber(0),
+	mLineNumber(rhs.mLineNumber),
 	mParser(NULL),
 	mParent(NULL),
 	mChildren(NULL),
@@ -140,14 +140,11 @@ LLXMLNode::LLXMLNode(const LLXMLNode& rhs) :
 LLXMLNodePtr LLXMLNode::deepCopy()
 {
 	LLXMLNodePtr newnode = LLXMLNodePtr(new LLXMLNode(*this));
-	if (mChildren.notNull())
+	// walk the sibling list rather than the name map, to keep document order
+	for (LLXMLNodePtr child = getFirstChild(); child.notNull(); child = child->getNextSibling())
 	{
-		for (LLXMLChildList::iterator iter = mChildren->map.begin();
-			 iter != mChildren->map.end(); ++iter)	
-		{
-			LLXMLNodePtr temp_ptr_for_gcc(iter->second->deepCopy());
-			newnode->addChild(temp_ptr_for_gcc);
-		}
+		LLXMLNodePtr temp_ptr_for_gcc(child->deepCopy());
+		newnode->addChild(temp_ptr_for_gcc);
 	}
 	for (LLXMLAttribList::iterator iter = mAttributes.begin();
 		 iter != mAttributes.end(); ++iter)
@@ -29,6 +29,7 @@
 #include "llsdserialize.h"
 
 #include "../llcontrol.h"
+#include "lltimer.h"
 
 #include "../test/lltut.h"
 
@@ -156,4 +157,66 @@ namespace tut
 		ensure("listener fired on changed setting", mListenerFired);	   
 	}
 
+	//lookups by name, with and without counting them
+	template<> template<>
+	void control_group_t::test<5>()
+	{
+		mCG->declareBOOL("RenderDeferred", FALSE, "Test");
+		mCG->declareF32("RenderFarClip", 64.f, "Test");
+		ensure("declared control exists", mCG->controlExists("RenderDeferred"));
+		ensure("missing control", !mCG->controlExists("RenderDeferredSSAO"));
+		ensure("missing control pointer", mCG->getControl("RenderDeferredSSAO").isNull());
+
+		LLControlGroup::setLookupCounting(true);
+		mCG->setBOOL("RenderDeferred", TRUE);
+		ensure("set while counting", mCG->getBOOL("RenderDeferred"));
+		ensure_equals("other control untouched", mCG->getF32("RenderFarClip"), 64.f);
+		LLControlGroup::logLookupCounts(1, 1.f);
+		LLControlGroup::setLookupCounting(false);
+		ensure("counting off", !LLControlGroup::isLookupCounting());
+
+		mCG->cleanup();
+		ensure("cleaned up", !mCG->controlExists("RenderDeferred"));
+	}
+
+	//compare the ways of reading a setting from per frame code
+	template<> template<>
+	void control_group_t::test<6>()
+	{
+		mCG->loadFromFile(mTestConfigFile.c_str());
+		// enough settings that a lookup has a real table to search
+		for (S32 i = 0; i < 1500; ++i)
+		{
+			mCG->declareU32(llformat("RenderSetting%d", i), i, "Test");
+		}
+		const S32 count = 200000;
+		U32 sum = 0;
+
+		LLTimer timer;
+		for (S32 i = 0; i < count; ++i)
+		{
+			sum += mCG->getU32("TestSetting");
+		}
+		F64 by_name = timer.getElapsedTimeF64();
+
+		timer.reset();
+		LLControlVariable* control = mCG->getControl("TestSetting");
+		for (S32 i = 0; i < count; ++i)
+		{
+			sum += control->getValue().asInteger();
+		}
+		F64 by_pointer = timer.getElapsedTimeF64();
+
+		timer.reset();
+		LLCachedControl<U32> cached(*mCG, "TestSetting");
+		for (S32 i = 0; i < count; ++i)
+		{
+			sum += cached;
+		}
+		F64 by_cached = timer.getElapsedTimeF64();
+
+		ensure_equals("same values", sum, (U32) (3 * count * 12));
+		LL_INFOS() << count << " reads: by name " << by_name << "s, by control " << by_pointer
+				   << "s, LLCachedControl " << by_cached << "s" << LL_ENDL;
+	}
 }
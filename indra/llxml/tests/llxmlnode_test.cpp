@@ -0,0 +1,132 @@
+/**
+ * @file   llxmlnode_test.cpp
+ * @brief  Test for llxmlnode.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <sstream>
+
+#include "../llxmlnode.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+	struct llxmlnode_data
+	{
+		bool parse(const std::string& xml, LLXMLNodePtr& root)
+		{
+			std::vector<U8> buffer(xml.begin(), xml.end());
+			buffer.push_back(0);
+			return LLXMLNode::parseBuffer(&buffer[0], xml.size(), root, NULL);
+		}
+
+		std::string childNames(LLXMLNodePtr node)
+		{
+			std::string names;
+			for (LLXMLNodePtr child = node->getFirstChild(); child.notNull(); child = child->getNextSibling())
+			{
+				names += child->getName()->mString;
+				names += " ";
+			}
+			return names;
+		}
+
+		// a floater about the size of the bigger ones in the skin
+		std::string makeFloater(S32 panels, S32 widgets)
+		{
+			std::ostringstream xml;
+			xml << "<floater name=\"test\" title=\"Test\" width=\"600\" height=\"500\">\n";
+			for (S32 p = 0; p < panels; ++p)
+			{
+				xml << " <panel name=\"panel" << p << "\" label=\"Panel " << p << "\" follows=\"all\">\n";
+				for (S32 w = 0; w < widgets; ++w)
+				{
+					xml << "  <check_box name=\"check" << w << "\" label=\"Option " << w << "\" control_name=\"Setting" << w
+						<< "\" left=\"10\" top_pad=\"4\" height=\"16\" width=\"256\" tool_tip=\"Turns option " << w << " on\"/>\n";
+				}
+				xml << " </panel>\n";
+			}
+			xml << "</floater>\n";
+			return xml.str();
+		}
+	};
+	typedef test_group<llxmlnode_data> llxmlnode_test;
+	typedef llxmlnode_test::object llxmlnode_object;
+	tut::llxmlnode_test tllxmlnode("LLXMLNode");
+
+	template<> template<>
+	void llxmlnode_object::test<1>()
+	{
+		// deepCopy keeps children in document order and stays independent
+		LLXMLNodePtr root;
+		ensure("parsed", parse("<root a=\"1\">\n<panel/>\n<button/>\n<panel name=\"second\"/>\n<line_editor/>\n</root>", root));
+		ensure_equals("original order", childNames(root), std::string("panel button panel line_editor "));
+
+		LLXMLNodePtr copy = root->deepCopy();
+		ensure_equals("copied order", childNames(copy), std::string("panel button panel line_editor "));
+
+		std::string value;
+		ensure("attribute copied", copy->getAttributeString("a", value) && value == "1");
+		ensure_equals("line number copied", copy->getFirstChild()->getLineNumber(), root->getFirstChild()->getLineNumber());
+
+		copy->deleteChild(copy->getFirstChild());
+		ensure_equals("copy changed", childNames(copy), std::string("button panel line_editor "));
+		ensure_equals("original untouched", childNames(root), std::string("panel button panel line_editor "));
+	}
+
+	template<> template<>
+	void llxmlnode_object::test<2>()
+	{
+		// Compare parsing a floater against copying an already parsed tree,
+		// which is what LLUICtrlFactory::getLayeredXMLNode() now does for
+		// files it has seen before.
+		const std::string xml(makeFloater(10, 40));
+		const S32 count = 50;
+
+		LLTimer timer;
+		LLXMLNodePtr parsed;
+		for (S32 i = 0; i < count; ++i)
+		{
+			ensure("parsed", parse(xml, parsed));
+		}
+		F64 parse_time = timer.getElapsedTimeF64();
+
+		timer.reset();
+		LLXMLNodePtr copy;
+		for (S32 i = 0; i < count; ++i)
+		{
+			copy = parsed->deepCopy();
+		}
+		F64 copy_time = timer.getElapsedTimeF64();
+
+		ensure_equals("same panels", copy->getChildCount(), parsed->getChildCount());
+		ensure_equals("same widgets", copy->getFirstChild()->getChildCount(), parsed->getFirstChild()->getChildCount());
+
+		LL_INFOS() << count << " floaters of " << xml.size() << " bytes, parse " << parse_time
+				   << "s, copy " << copy_time << "s" << LL_ENDL;
+	}
+}
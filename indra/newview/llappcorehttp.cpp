@@ -85,6 +85,11 @@ static const struct
 		"",
 		"large mesh fetch"
 	},
+	{ // AP_MESH_PREFETCH
+		2,		1,		8,		0,		false,
+		"MeshPrefetchConcurrency",
+		"mesh prefetch"
+	},
 	{ // AP_UPLOADS 
 		2,		1,		8,		0,		false,
 		"",
@@ -182,6 +187,23 @@ void LLAppCoreHttp::init()
 		LL_WARNS("Init") << "Failed to set SSL Verification.  Reason:  " << status.toString() << LL_ENDL;
 	}
 
+	// Record or play back HTTP traffic for reproducible benchmarks
+	const std::string http_playback_file(gSavedSettings.getString("HttpPlaybackFile"));
+	const std::string http_record_file(gSavedSettings.getString("HttpRecordFile"));
+	if (! http_playback_file.empty() || ! http_record_file.empty())
+	{
+		status = LLCore::HttpRequest::setStaticPolicyOption(http_playback_file.empty()
+															? LLCore::HttpRequest::PO_RECORD_FILE
+															: LLCore::HttpRequest::PO_PLAYBACK_FILE,
+															LLCore::HttpRequest::GLOBAL_POLICY_ID,
+															http_playback_file.empty() ? http_record_file : http_playback_file,
+															NULL);
+		if (! status)
+		{
+			LL_WARNS("Init") << "Failed to set HTTP recording.  Reason:  " << status.toString() << LL_ENDL;
+		}
+	}
+
 	// Tracing levels for library & libcurl (note that 2 & 3 are beyond spammy):
 	// 0 - None
 	// 1 - Basic start, stop simple transitions
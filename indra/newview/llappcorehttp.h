@@ -122,6 +122,23 @@ public:
 		/// Pipelined:       no
 		AP_LARGE_MESH,
 
+		/// Mesh prefetching policy class.  Used to fetch
+		/// headers and LODs of meshes the camera is heading
+		/// towards via 'GetMesh' or 'GetMesh2' capability.
+		/// Kept apart from the demand classes as the ready
+		/// queue ignores request priority, prefetches queued
+		/// with them would hold up meshes in view.  Do not
+		/// share.
+		///
+		/// Destination:     simhost:12046 & cdn:80
+		/// Protocol:        http:
+		/// Transfer size:   KB-MB
+		/// Long poll:       no
+		/// Concurrency:     low
+		/// Request rate:    low
+		/// Pipelined:       no
+		AP_MESH_PREFETCH,
+
 		/// Asset upload policy class.  Used to store
 		/// assets (mesh only at the moment) via
 		/// changeable URL.  Responses may take some
@@ -96,6 +96,7 @@
 #include "llupdaterservice.h"
 #include "llfloatertexturefetchdebugger.h"
 #include "llspellcheck.h"
+#include "llsceneloadbenchmark.h"
 #include "llscenemonitor.h"
 #include "llavatarrenderinfoaccountant.h"
 #include "lllocalbitmaps.h"
@@ -127,6 +128,7 @@
 #endif
 
 // Third party library includes
+#include <boost/assign/list_of.hpp>
 #include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 #include <boost/algorithm/string.hpp>
@@ -594,6 +596,7 @@ static void settings_to_globals()
 	LLVOAvatar::sPhysicsLODFactor		= gSavedSettings.getF32("RenderAvatarPhysicsLODFactor");
 	LLVOAvatar::updateImpostorRendering(gSavedSettings.getU32("RenderAvatarMaxNonImpostors"));
 	LLVOAvatar::sVisibleInFirstPerson	= gSavedSettings.getBOOL("FirstPersonAvatarVisible");
+	LLPolyMesh::sShareMorphs			= gSavedSettings.getBOOL("AvatarShareMorphs");
 	// clamp auto-open time to some minimum usable value
 	LLFolderView::sAutoOpenTime			= llmax(0.25f, gSavedSettings.getF32("FolderAutoOpenDelay"));
 	LLSelectMgr::sRectSelectInclusive	= gSavedSettings.getBOOL("RectangleSelectInclusive");
@@ -646,6 +649,28 @@ public:
 	}
 };
 
+void LLAppViewer::initSerialNumber()
+{
+	// Find partition serial number (Windows) or hardware serial (Mac)
+	mSerialNumber = generateSerialNumber();
+}
+
+bool LLAppViewer::runDeferredStartupTasks(F32 budget_seconds)
+{
+	static bool reported = false;
+	if (reported)
+	{
+		return true;
+	}
+	if (!mStartupTasks.runDeferred(budget_seconds))
+	{
+		return false;
+	}
+	LL_INFOS("InitInfo") << "Deferred startup tasks done:\n" << mStartupTasks.getReport() << LL_ENDL;
+	reported = true;
+	return true;
+}
+
 //virtual
 bool LLAppViewer::initSLURLHandler()
 {
@@ -758,6 +783,74 @@ void fast_exit(int rc)
 	_exit(rc);
 }
 
+// Adapts initialization calls that can not fail to LLStartupTaskGraph::task_t.
+bool startup_step(const boost::function<void()>& step)
+{
+	step();
+	return true;
+}
+
+void init_metrics()
+{
+	// Viewer metrics initialization
+	//static LLCachedControl<bool> metrics_submode(gSavedSettings,
+	//											 "QAModeMetrics",
+	//											 false,
+	//											 "Enables QA features (logging, faster cycling) for metrics collector");
+
+	if (gSavedSettings.getBOOL("QAModeMetrics"))
+	{
+		app_metrics_qa_mode = true;
+		app_metrics_interval = METRICS_INTERVAL_QA;
+	}
+	LLViewerAssetStatsFF::init();
+}
+
+void init_ui()
+{
+	// Initialize settings early so that the defaults for ignorable dialogs are
+	// picked up and then correctly re-saved after launching the updater (STORM-1268).
+	LLUI::settings_map_t settings_map;
+	settings_map["config"] = &gSavedSettings;
+	settings_map["ignores"] = &gWarningSettings;
+	settings_map["floater"] = &gSavedSettings; // *TODO: New settings file
+	settings_map["account"] = &gSavedPerAccountSettings;
+
+	LLUI::initClass(settings_map,
+		LLUIImageList::getInstance(),
+		ui_audio_callback,
+		deferred_ui_audio_callback,
+		&LLUI::getScaleFactor());
+	LL_INFOS("InitInfo") << "UI initialized." << LL_ENDL ;
+
+	// NOW LLUI::getLanguage() should work. gDirUtilp must know the language
+	// for this session ASAP so all the file-loading commands that follow,
+	// that use findSkinnedFilenames(), will include the localized files.
+	gDirUtilp->setSkinFolder(gDirUtilp->getSkinFolder(), LLUI::getLanguage());
+}
+
+void init_notifications()
+{
+	// Setup notifications after LLUI::initClass() has been called.
+	LLNotifications::instance();
+	LL_INFOS("InitInfo") << "Notifications initialized." << LL_ENDL ;
+}
+
+void init_spell_check()
+{
+	if (gSavedSettings.getBOOL("SpellCheck"))
+	{
+		std::list<std::string> dict_list;
+		std::string dict_setting = gSavedSettings.getString("SpellCheckDictionary");
+		boost::split(dict_list, dict_setting, boost::is_any_of(std::string(",")));
+		if (!dict_list.empty())
+		{
+			LLSpellChecker::setUseSpellCheck(dict_list.front());
+			dict_list.pop_front();
+			LLSpellChecker::instance().setSecondaryDictionaries(dict_list);
+		}
+	}
+}
 
 }
 
@@ -832,55 +925,37 @@ bool LLAppViewer::init()
 	
 	LL_INFOS("InitInfo") << "LLCore::Http initialized." << LL_ENDL ;
 
-    LLMachineID::init();
-	
+	// Initialization up to the updater check, in dependency order.  Steps
+	// not needed before the login screen wait for runDeferredStartupTasks().
+	mStartupTasks.add("machine_id", boost::bind(startup_step, boost::function<void()>(&LLMachineID::init)));
+	mStartupTasks.add("serial_number", boost::bind(startup_step, boost::function<void()>(boost::bind(&LLAppViewer::initSerialNumber, this))));
+	mStartupTasks.add("metrics", boost::bind(startup_step, boost::function<void()>(init_metrics)));
+	mStartupTasks.add("threads", boost::bind(&LLAppViewer::initThreads, this),
+					  LLStartupTaskGraph::AT_STARTUP, boost::assign::list_of("metrics"));
+	mStartupTasks.add("ui", boost::bind(startup_step, boost::function<void()>(init_ui)),
+					  LLStartupTaskGraph::AT_STARTUP, boost::assign::list_of("threads"));
+	// Setup LLTrans after LLUI::initClass has been called.
+	mStartupTasks.add("strings", boost::bind(startup_step, boost::function<void()>(boost::bind(&LLAppViewer::initStrings, this))),
+					  LLStartupTaskGraph::AT_STARTUP, boost::assign::list_of("ui"));
+	mStartupTasks.add("notifications", boost::bind(startup_step, boost::function<void()>(init_notifications)),
+					  LLStartupTaskGraph::AT_STARTUP, boost::assign::list_of("strings"));
+	mStartupTasks.add("system_info", boost::bind(startup_step, boost::function<void()>(boost::bind(&LLAppViewer::writeSystemInfo, this))),
+					  LLStartupTaskGraph::AT_STARTUP, boost::assign::list_of("strings"));
+
+	mStartupTasks.add("role_actions", boost::bind(startup_step, boost::function<void()>(boost::bind(&LLGroupMgr::parseRoleActions, "role_actions.xml"))),
+					  LLStartupTaskGraph::DEFERRED, boost::assign::list_of("ui"));
+	mStartupTasks.add("teleport_strings", boost::bind(startup_step, boost::function<void()>(boost::bind(&LLAgent::parseTeleportMessages, "teleport_strings.xml"))),
+					  LLStartupTaskGraph::DEFERRED, boost::assign::list_of("ui"));
+	mStartupTasks.add("spell_check", boost::bind(startup_step, boost::function<void()>(init_spell_check)),
+					  LLStartupTaskGraph::DEFERRED, boost::assign::list_of("ui"));
+
+	bool initialized = mStartupTasks.run();
+	LL_INFOS("InitInfo") << "Startup tasks:\n" << mStartupTasks.getReport() << LL_ENDL;
+	if (!initialized)
 	{
-		// Viewer metrics initialization
-		//static LLCachedControl<bool> metrics_submode(gSavedSettings,
-		//											 "QAModeMetrics",
-		//											 false,
-		//											 "Enables QA features (logging, faster cycling) for metrics collector");
-
-		if (gSavedSettings.getBOOL("QAModeMetrics"))
-		{
-			app_metrics_qa_mode = true;
-			app_metrics_interval = METRICS_INTERVAL_QA;
-		}
-		LLViewerAssetStatsFF::init();
+		return false;
 	}
 
-	initThreads();
-	LL_INFOS("InitInfo") << "Threads initialized." << LL_ENDL ;
-
-	// Initialize settings early so that the defaults for ignorable dialogs are
-	// picked up and then correctly re-saved after launching the updater (STORM-1268).
-	LLUI::settings_map_t settings_map;
-	settings_map["config"] = &gSavedSettings;
-	settings_map["ignores"] = &gWarningSettings;
-	settings_map["floater"] = &gSavedSettings; // *TODO: New settings file
-	settings_map["account"] = &gSavedPerAccountSettings;
-
-	LLUI::initClass(settings_map,
-		LLUIImageList::getInstance(),
-		ui_audio_callback,
-		deferred_ui_audio_callback,
-		&LLUI::getScaleFactor());
-	LL_INFOS("InitInfo") << "UI initialized." << LL_ENDL ;
-
-	// NOW LLUI::getLanguage() should work. gDirUtilp must know the language
-	// for this session ASAP so all the file-loading commands that follow,
-	// that use findSkinnedFilenames(), will include the localized files.
-	gDirUtilp->setSkinFolder(gDirUtilp->getSkinFolder(), LLUI::getLanguage());
-
-	// Setup LLTrans after LLUI::initClass has been called.
-	initStrings();
-
-	// Setup notifications after LLUI::initClass() has been called.
-	LLNotifications::instance();
-	LL_INFOS("InitInfo") << "Notifications initialized." << LL_ENDL ;
-
-    writeSystemInfo();
-
 	// Initialize updater service (now that we have an io pump)
 	initUpdater();
 	if(isQuitting())
@@ -948,10 +1023,6 @@ bool LLAppViewer::init()
 	// Load settings files
 	//
 	//
-	LLGroupMgr::parseRoleActions("role_actions.xml");
-
-	LLAgent::parseTeleportMessages("teleport_strings.xml");
-
 	// load MIME type -> media impl mappings
 	std::string mime_types_name;
 #if LL_DARWIN
@@ -970,9 +1041,6 @@ bool LLAppViewer::init()
 	// Modify settings based on system configuration and compile options
 	settings_modify();
 
-	// Find partition serial number (Windows) or hardware serial (Mac)
-	mSerialNumber = generateSerialNumber();
-
 	// do any necessary set-up for accepting incoming SLURLs from apps
 	initSLURLHandler();
 
@@ -1666,6 +1734,7 @@ bool LLAppViewer::cleanup()
 
 	//dump scene loading monitor results
 	LLSceneMonitor::instance().dumpToFile(gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "scene_monitor_results.csv"));
+	LLSceneLoadBenchmark::instance().writeResults();
 
 	// There used to be an 'if (LLFastTimerView::sAnalyzePerformance)' block
 	// here, completely redundant with the one that occurs later in this same
@@ -1904,6 +1973,8 @@ bool LLAppViewer::cleanup()
 	// Store the time of our current logoff
 	gSavedPerAccountSettings.setU32("LastLogoff", time_corrected());
 
+	LLFloaterReg::saveUsageHistory();
+
 	// Must do this after all panels have been deleted because panels that have persistent rects
 	// save their rects on delete.
 	gSavedSettings.saveToFile(gSavedSettings.getString("ClientSettingsFile"), TRUE);
@@ -2716,19 +2787,6 @@ bool LLAppViewer::initConfiguration()
 								 gSavedSettings.getString("Language"));
 	}
 
-	if (gSavedSettings.getBOOL("SpellCheck"))
-	{
-		std::list<std::string> dict_list;
-		std::string dict_setting = gSavedSettings.getString("SpellCheckDictionary");
-		boost::split(dict_list, dict_setting, boost::is_any_of(std::string(",")));
-		if (!dict_list.empty())
-		{
-			LLSpellChecker::setUseSpellCheck(dict_list.front());
-			dict_list.pop_front();
-			LLSpellChecker::instance().setSecondaryDictionaries(dict_list);
-		}
-	}
-
     mYieldTime = gSavedSettings.getS32("YieldTime");
 
 
@@ -4636,11 +4694,15 @@ void LLAppViewer::saveFinalSnapshot()
 
 void LLAppViewer::loadNameCache()
 {
-	// display names cache
+	// display names cache, or the LLSD one older viewers wrote
 	std::string filename =
-		gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
+		gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.bin");
+	if (!LLFile::isfile(filename))
+	{
+		filename = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
+	}
 	LL_INFOS("AvNameCache") << filename << LL_ENDL;
-	llifstream name_cache_stream(filename.c_str());
+	llifstream name_cache_stream(filename.c_str(), std::ios_base::binary);
 	if(name_cache_stream.is_open())
 	{
 		if ( ! LLAvatarNameCache::importFile(name_cache_stream))
@@ -4666,11 +4728,18 @@ void LLAppViewer::saveNameCache()
 {
 	// display names cache
 	std::string filename =
-		gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
-	llofstream name_cache_stream(filename.c_str());
+		gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.bin");
+	llofstream name_cache_stream(filename.c_str(), std::ios_base::binary);
 	if(name_cache_stream.is_open())
 	{
 		LLAvatarNameCache::exportFile(name_cache_stream);
+		// superseded by the binary file
+		std::string old_filename =
+			gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
+		if (LLFile::isfile(old_filename))
+		{
+			LLFile::remove(old_filename);
+		}
     }
     
     // real names cache
@@ -4765,6 +4834,8 @@ void LLAppViewer::idle()
 		}
 	}
 
+	LLSceneLoadBenchmark::getInstance()->idle();
+
 	// Must wait until both have avatar object and mute list, so poll
 	// here.
 	request_initial_instant_messages();
@@ -46,6 +46,7 @@
 #include "llcontrol.h"
 #include "llsys.h"			// for LLOSInfo
 #include "lltimer.h"
+#include "llstartuptaskgraph.h"
 #include "llappcorehttp.h"
 
 class LLCommandLineParser;
@@ -122,6 +123,11 @@ public:
 	static U32 getObjectCacheVersion() ;
 
 	const std::string& getSerialNumber() { return mSerialNumber; }
+
+	// Runs the startup steps left until the login screen is up, stopping
+	// after budget_seconds (0 runs all of them).  Returns true once none
+	// are left.
+	bool runDeferredStartupTasks(F32 budget_seconds = 0.f);
 	
 	bool getPurgeCache() const { return mPurgeCache; }
 	
@@ -228,6 +234,7 @@ private:
 	bool initThreads(); // Initialize viewer threads, return false on failure.
 	bool initConfiguration(); // Initialize settings from the command line/config file.
 	void initStrings();       // Initialize LLTrans machinery
+	void initSerialNumber();  // Find the platform specific serial number
 	void initUpdater(); // Initialize the updater service.
 	bool initCache(); // Initialize local client cache.
 	void checkMemory() ;
@@ -316,6 +323,9 @@ private:
 	// llcorehttp library init/shutdown helper
 	LLAppCoreHttp mAppCoreHttp;
 
+	// initialization steps and the order they need
+	LLStartupTaskGraph mStartupTasks;
+
 	//---------------------------------------------
 	//*NOTE: Mani - legacy updater stuff
 	// Still useable?
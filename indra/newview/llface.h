@@ -49,6 +49,7 @@ class LLViewerTexture;
 class LLGeometryManager;
 class LLTextureAtlasSlot;
 class LLDrawInfo;
+class LLGeometryFill;
 
 const F32 MIN_ALPHA_SIZE = 1024.f;
 const F32 MIN_TEX_ANIM_SIZE = 512.f;
@@ -162,11 +163,14 @@ public:
 	//for volumes
 	void updateRebuildFlags();
 	bool canRenderAsMask(); // logic helper
+	// With fill, the plain per vertex copies are queued on it instead of run
+	// here, and the buffer must stay mapped until it has been run.
 	BOOL getGeometryVolume(const LLVolume& volume,
 						const S32 &f,
 						const LLMatrix4& mat_vert, const LLMatrix3& mat_normal,
 						const U16 &index_offset,
-						bool force_rebuild = false);
+						bool force_rebuild = false,
+						LLGeometryFill* fill = NULL);
 
 	// For avatar
 	U16			 getGeometryAvatar(
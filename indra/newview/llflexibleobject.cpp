@@ -47,8 +47,13 @@
 std::vector<LLVolumeImplFlexible*> LLVolumeImplFlexible::sInstanceList;
 std::vector<S32> LLVolumeImplFlexible::sUpdateDelay;
 
+// this frame's steps and the objects they belong to, kept to reuse the storage
+static LLFlexibleSim sSimulation;
+static std::vector<LLVolumeImplFlexible*> sSimulated;
+
 static LLTrace::BlockTimerStatHandle FTM_FLEXIBLE_REBUILD("Rebuild");
 static LLTrace::BlockTimerStatHandle FTM_DO_FLEXIBLE_UPDATE("Flexible Update");
+static LLTrace::BlockTimerStatHandle FTM_FLEXIBLE_SIMULATE("Simulate Flexies");
 
 // LLFlexibleObjectData::pack/unpack now in llprimitive.cpp
 
@@ -62,6 +67,8 @@ LLVolumeImplFlexible::LLVolumeImplFlexible(LLViewerObject* vo, LLFlexibleObjectD
 	mID = seed++;
 	mInitialized = FALSE;
 	mUpdated = FALSE;
+	mSimulatePending = FALSE;
+	mSimulated = FALSE;
 	mInitializedRes = -1;
 	mSimulateRes = 0;
 	mFrameNum = 0;
@@ -111,6 +118,44 @@ void LLVolumeImplFlexible::updateClass()
 	}
 }
 
+//static
+void LLVolumeImplFlexible::simulateClass()
+{
+	LL_RECORD_BLOCK_TIME(FTM_FLEXIBLE_SIMULATE);
+
+	for (std::vector<LLVolumeImplFlexible*>::iterator iter = sInstanceList.begin();
+			iter != sInstanceList.end();
+			++iter)
+	{
+		LLVolumeImplFlexible* flexi = *iter;
+		if (flexi->mSimulatePending)
+		{
+			flexi->mSimulatePending = FALSE;
+			// dead objects stay listed until deleted, with no drawable
+			if (flexi->mVO->isDead() || flexi->mVO->mDrawable.isNull())
+			{
+				continue;
+			}
+			LLFlexibleSim::Chain chain;
+			if (flexi->prepareSimulation(chain))
+			{
+				sSimulation.add(chain);
+				sSimulated.push_back(flexi);
+			}
+		}
+	}
+
+	sSimulation.run(gPipeline.getGeometryPool());
+
+	for (U32 i = 0; i < sSimulated.size(); ++i)
+	{
+		sSimulated[i]->mLastSegmentRotation = sSimulation.get(i).mEndRotation;
+		sSimulated[i]->mSimulated = TRUE;
+	}
+	sSimulation.clear();
+	sSimulated.clear();
+}
+
 LLVector3 LLVolumeImplFlexible::getFramePosition() const
 {
 	return mVO->getRenderPosition();
@@ -354,6 +399,7 @@ void LLVolumeImplFlexible::doIdleUpdate()
 			{
 				updateRenderRes();
 				gPipeline.markRebuild(drawablep, LLDrawable::REBUILD_POSITION, FALSE);
+				mSimulatePending = TRUE;
 				sUpdateDelay[mInstanceIndex] = 0;
 			}
 			else
@@ -398,6 +444,7 @@ void LLVolumeImplFlexible::doIdleUpdate()
 					updateRenderRes();
 
 					gPipeline.markRebuild(drawablep, LLDrawable::REBUILD_POSITION, FALSE);
+					mSimulatePending = TRUE;
 				}
 			}
 		}
@@ -425,8 +472,27 @@ inline S32 log2(S32 x)
 void LLVolumeImplFlexible::doFlexibleUpdate()
 {
 	LL_RECORD_BLOCK_TIME(FTM_DO_FLEXIBLE_UPDATE);
-	LLVolume* volume = mVO->getVolume();
-	LLPath *path = &volume->getPath();
+	if (mSimulated)
+	{
+		// already stepped by simulateClass() this frame
+		mSimulated = FALSE;
+	}
+	else
+	{
+		LLFlexibleSim::Chain chain;
+		if (!prepareSimulation(chain))
+		{
+			return;
+		}
+		LLFlexibleSim::simulate(chain);
+		mLastSegmentRotation = chain.mEndRotation;
+	}
+
+	updatePath();
+}
+
+bool LLVolumeImplFlexible::prepareSimulation(LLFlexibleSim::Chain& chain)
+{
 	if ((mSimulateRes == 0 || !mInitialized) && mVO->mDrawable->isVisible()) 
 	{
 		BOOL force_update = mSimulateRes == 0 ? TRUE : FALSE;
@@ -434,14 +500,14 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 
 		if (!force_update || !gPipeline.hasRenderDebugFeatureMask(LLPipeline::RENDER_DEBUG_FEATURE_FLEXIBLE))
 		{
-			return;	// we did not get updated or initialized, proceeding without can be dangerous
+			return false;	// we did not get updated or initialized, proceeding without can be dangerous
 		}
 	}
 
 	if(!mInitialized || !mAttributes)
 	{
 		//the object is not visible
-		return ;
+		return false;
 	}
 
 	// Fix for MAINT-1894
@@ -450,7 +516,7 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 	// render sections which will then create a length exception in the std::vector::resize() method.
 	if (mRenderRes < 0)
 	{
-		return;
+		return false;
 	}
 	
 	S32 num_sections = 1 << mSimulateRes;
@@ -463,25 +529,19 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 
 	LLVector3 BasePosition = getFramePosition();
 	LLQuaternion BaseRotation = getFrameRotation();
-	LLQuaternion parentSegmentRotation = BaseRotation;
-	LLVector3 anchorDirectionRotated = LLVector3::z_axis * parentSegmentRotation;
+	LLVector3 anchorDirectionRotated = LLVector3::z_axis * BaseRotation;
 	LLVector3 anchorScale = mVO->mDrawable->getScale();
 	
 	F32 section_length = anchorScale.mV[VZ] / (F32)num_sections;
-	F32 inv_section_length = 1.f / section_length;
 
-	S32 i;
+	chain.mSections = mSection;
+	chain.mNumSections = num_sections;
 
 	// ANCHOR position is offset from BASE position (centroid) by half the length
-	LLVector3 AnchorPosition = BasePosition - (anchorScale.mV[VZ]/2 * anchorDirectionRotated);
-	
-	mSection[0].mPosition = AnchorPosition;
-	mSection[0].mDirection = anchorDirectionRotated;
-	mSection[0].mRotation = BaseRotation;
-
-	LLQuaternion deltaRotation;
-
-	LLVector3 lastPosition;
+	chain.mAnchorPosition = BasePosition - (anchorScale.mV[VZ]/2 * anchorDirectionRotated);
+	chain.mAnchorDirection = anchorDirectionRotated;
+	chain.mAnchorRotation = BaseRotation;
+	chain.mSectionLength = section_length;
 
 	// Coefficients which are constant across sections
 	F32 t_factor = mAttributes->getTension() * 0.1f;
@@ -490,174 +550,46 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 	{
 		t_factor = FLEXIBLE_OBJECT_MAX_INTERNAL_TENSION_FORCE;
 	}
+	chain.mTension = t_factor;
 
 	F32 friction_coeff = (mAttributes->getAirFriction()*2+1);
 	friction_coeff = pow(10.f, friction_coeff*secondsThisFrame);
 	friction_coeff = (friction_coeff > 1) ? friction_coeff : 1;
-	F32 momentum = 1.0f / friction_coeff;
+	chain.mMomentum = 1.0f / friction_coeff;
 
-	F32 wind_factor = (mAttributes->getWindSensitivity()*0.1f) * section_length * secondsThisFrame;
-	F32 max_angle = atan(section_length*2.f);
+	chain.mMaxAngle = atan(section_length*2.f);
 
 	F32 force_factor = section_length * secondsThisFrame;
+	chain.mGravity = mAttributes->getGravity() * force_factor;
+	chain.mUserForce = mAttributes->getUserForce() * force_factor;
 
-	// Update simulated sections
-	for (i=1; i<=num_sections; ++i)
+	// The wind is sampled where gravity alone moves each section to, which
+	// does not depend on the rest of the step.
+	chain.mHasWind = mAttributes->getWindSensitivity() > 0.001f;
+	if (chain.mHasWind)
 	{
-		LLVector3 parentSectionVector;
-		LLVector3 parentSectionPosition;
-		LLVector3 parentDirection;
-
-		//---------------------------------------------------
-		// save value of position as lastPosition
-		//---------------------------------------------------
-		lastPosition = mSection[i].mPosition;
-
-		//------------------------------------------------------------------------------------------
-		// gravity
-		//------------------------------------------------------------------------------------------
-		mSection[i].mPosition.mV[2] -= mAttributes->getGravity() * force_factor;
-
-		//------------------------------------------------------------------------------------------
-		// wind force
-		//------------------------------------------------------------------------------------------
-		if (mAttributes->getWindSensitivity() > 0.001f)
+		F32 wind_factor = (mAttributes->getWindSensitivity()*0.1f) * section_length * secondsThisFrame;
+		LLWind& wind = gAgent.getRegion()->mWind;
+		for (S32 i = 1; i <= num_sections; ++i)
 		{
-			mSection[i].mPosition += gAgent.getRegion()->mWind.getVelocity( mSection[i].mPosition ) * wind_factor;
-		}
-
-		//------------------------------------------------------------------------------------------
-		// user-defined force
-		//------------------------------------------------------------------------------------------
-		mSection[i].mPosition += mAttributes->getUserForce() * force_factor;
-
-		//---------------------------------------------------
-		// tension (rigidity, stiffness)
-		//---------------------------------------------------
-		parentSectionPosition = mSection[i-1].mPosition;
-		parentDirection = mSection[i-1].mDirection;
-
-		if ( i == 1 )
-		{
-			parentSectionVector = mSection[0].mDirection;
-		}
-		else
-		{
-			parentSectionVector = mSection[i-2].mDirection;
-		}
-
-		LLVector3 currentVector = mSection[i].mPosition - parentSectionPosition;
-
-		LLVector3 difference = (parentSectionVector*section_length) - currentVector;
-		LLVector3 tensionForce = difference * t_factor;
-
-		mSection[i].mPosition += tensionForce;
-
-		//------------------------------------------------------------------------------------------
-		// sphere collision, currently not used
-		//------------------------------------------------------------------------------------------
-		/*if ( mAttributes->mUsingCollisionSphere )
-		{
-			LLVector3 vectorToCenterOfCollisionSphere = mCollisionSpherePosition - mSection[i].mPosition;
-			if ( vectorToCenterOfCollisionSphere.magVecSquared() < mCollisionSphereRadius * mCollisionSphereRadius )
-			{
-				F32 distanceToCenterOfCollisionSphere = vectorToCenterOfCollisionSphere.magVec();
-				F32 penetration = mCollisionSphereRadius - distanceToCenterOfCollisionSphere;
-
-				LLVector3 normalToCenterOfCollisionSphere;
-				
-				if ( distanceToCenterOfCollisionSphere > 0.0f )
-				{
-					normalToCenterOfCollisionSphere = vectorToCenterOfCollisionSphere / distanceToCenterOfCollisionSphere;
-				}
-				else // rare
-				{
-					normalToCenterOfCollisionSphere = LLVector3::x_axis; // arbitrary
-				}
-
-				// push the position out to the surface of the collision sphere
-				mSection[i].mPosition -= normalToCenterOfCollisionSphere * penetration;
-			}
-		}*/
-
-		//------------------------------------------------------------------------------------------
-		// inertia
-		//------------------------------------------------------------------------------------------
-		mSection[i].mPosition += mSection[i].mVelocity * momentum;
-
-		//------------------------------------------------------------------------------------------
-		// clamp length & rotation
-		//------------------------------------------------------------------------------------------
-		mSection[i].mDirection = mSection[i].mPosition - parentSectionPosition;
-		mSection[i].mDirection.normVec();
-		deltaRotation.shortestArc( parentDirection, mSection[i].mDirection );
-
-		F32 angle;
-		LLVector3 axis;
-		deltaRotation.getAngleAxis(&angle, axis);
-		if (angle > F_PI) angle -= 2.f*F_PI;
-		if (angle < -F_PI) angle += 2.f*F_PI;
-		if (angle > max_angle)
-		{
-			//angle = 0.5f*(angle+max_angle);
-			deltaRotation.setQuat(max_angle, axis);
-		} else if (angle < -max_angle)
-		{
-			//angle = 0.5f*(angle-max_angle);
-			deltaRotation.setQuat(-max_angle, axis);
-		}
-		LLQuaternion segment_rotation = parentSegmentRotation * deltaRotation;
-		parentSegmentRotation = segment_rotation;
-
-		mSection[i].mDirection = (parentDirection * deltaRotation);
-		mSection[i].mPosition = parentSectionPosition + mSection[i].mDirection * section_length;
-		mSection[i].mRotation = segment_rotation;
-
-		if (i > 1)
-		{
-			// Propogate half the rotation up to the parent
-			LLQuaternion halfDeltaRotation(angle/2, axis);
-			mSection[i-1].mRotation = mSection[i-1].mRotation * halfDeltaRotation;
-		}
-
-		//------------------------------------------------------------------------------------------
-		// calculate velocity
-		//------------------------------------------------------------------------------------------
-		mSection[i].mVelocity = mSection[i].mPosition - lastPosition;
-		if (mSection[i].mVelocity.magVecSquared() > 1.f)
-		{
-			mSection[i].mVelocity.normVec();
+			LLVector3 position = mSection[i].mPosition;
+			position.mV[2] -= chain.mGravity;
+			chain.mWind[i] = wind.getVelocity(position) * wind_factor;
 		}
 	}
 
-	// Calculate derivatives (not necessary until normals are automagically generated)
-	mSection[0].mdPosition = (mSection[1].mPosition - mSection[0].mPosition) * inv_section_length;
-	// i = 1..NumSections-1
-	for (i=1; i<num_sections; ++i)
-	{
-		// Quadratic numerical derivative of position
-
-		// f(-L1) = aL1^2 - bL1 + c = f1
-		// f(0)   =               c = f2
-		// f(L2)  = aL2^2 + bL2 + c = f3
-		// f = ax^2 + bx + c
-		// d/dx f = 2ax + b
-		// d/dx f(0) = b
-
-		// c = f2
-		// a = [(f1-c)/L1 + (f3-c)/L2] / (L1+L2)
-		// b = (f3-c-aL2^2)/L2
-
-		LLVector3 a = (mSection[i-1].mPosition-mSection[i].mPosition +
-					mSection[i+1].mPosition-mSection[i].mPosition) * 0.5f * inv_section_length * inv_section_length;
-		LLVector3 b = (mSection[i+1].mPosition-mSection[i].mPosition - a*(section_length*section_length));
-		b *= inv_section_length;
+	return true;
+}
 
-		mSection[i].mdPosition = b;
+void LLVolumeImplFlexible::updatePath()
+{
+	if (!mInitialized || !mAttributes || mRenderRes < 0)
+	{
+		return;
 	}
 
-	// i = NumSections
-	mSection[i].mdPosition = (mSection[i].mPosition - mSection[i-1].mPosition) * inv_section_length;
+	LLVolume* volume = mVO->getVolume();
+	LLPath *path = &volume->getPath();
 
 	// Create points
 	llassert(mRenderRes > -1);
@@ -693,7 +625,7 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 								LLVector4(delta_pos, 1.f));
 			
 	LL_CHECK_MEMORY
-	for (i=0; i<=num_render_sections; ++i)
+	for (S32 i=0; i<=num_render_sections; ++i)
 	{
 		new_point = &path->mPath[i];
 		LLVector3 pos = newSection[i].mPosition * rel_xform;
@@ -712,7 +644,6 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 		new_point->mTexT = ((F32)i)/(num_render_sections);
 	}
 	LL_CHECK_MEMORY
-	mLastSegmentRotation = parentSegmentRotation;
 }
 
 static LLTrace::BlockTimerStatHandle FTM_FLEXI_PREBUILD("Flexi Prebuild");
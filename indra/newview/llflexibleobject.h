@@ -37,6 +37,7 @@
 #ifndef LL_LLFLEXIBLEOBJECT_H
 #define LL_LLFLEXIBLEOBJECT_H
 
+#include "llflexiblesim.h"
 #include "llprimitive.h"
 #include "llvovolume.h"
 #include "llwind.h"
@@ -47,24 +48,6 @@ const U32	FLEXIBLE_OBJECT_MAX_LOD			= 10;
 
 // See llprimitive.h for LLFlexibleObjectData and DEFAULT/MIN/MAX values 
 
-//-------------------------------------------------------------------
-
-struct LLFlexibleObjectSection
-{
-	// Input parameters
-	LLVector2		mScale;
-	LLQuaternion	mAxisRotation;
-	// Simulated state
-	LLVector3		mPosition;
-	LLVector3		mVelocity;
-	LLVector3		mDirection;
-	LLQuaternion	mRotation;
-	// Derivatives (Not all currently used, will come back with LLVolume changes to automagically generate normals)
-	LLVector3		mdPosition;
-	//LLMatrix4		mRotScale;
-	//LLMatrix4		mdRotScale;
-};
-
 //---------------------------------------------------------
 // The LLVolumeImplFlexible class 
 //---------------------------------------------------------
@@ -77,6 +60,8 @@ private:
 
 	public:
 		static void updateClass();
+		// steps every flexible object updateClass() picked this frame
+		static void simulateClass();
 
 		LLVolumeImplFlexible(LLViewerObject* volume, LLFlexibleObjectData* attributes);
 		~LLVolumeImplFlexible();
@@ -128,6 +113,10 @@ private:
 		LLQuaternion				mLastSegmentRotation;
 		BOOL						mInitialized;
 		BOOL						mUpdated;
+		// picked by doIdleUpdate() for this frame's simulateClass()
+		BOOL						mSimulatePending;
+		// stepped by simulateClass(), doFlexibleUpdate() only has to place the path
+		BOOL						mSimulated;
 		LLFlexibleObjectData*		mAttributes;
 		LLFlexibleObjectSection		mSection	[ (1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1 ];
 		S32							mInitializedRes;
@@ -145,6 +134,11 @@ private:
 
 		void remapSections(LLFlexibleObjectSection *source, S32 source_sections,
 										 LLFlexibleObjectSection *dest, S32 dest_sections);
+
+		// fills in everything a step reads, false if there is nothing to step
+		bool prepareSimulation(LLFlexibleSim::Chain& chain);
+		// places the volume's path along the simulated sections
+		void updatePath();
 		
 public:
 		// Global setting for update rate
@@ -52,6 +52,8 @@ public:
 	virtual LLWearableType::EType getWearableType() const = 0;
 	virtual EInventorySortGroup getSortGroup() const = 0;
 	virtual LLInventoryObject* getInventoryObject() const = 0;
+	// slot of the searchable name in the filter's name index, if it has one
+	virtual S32 getSearchSlot() const { return LLSubstringIndex::NO_SLOT; }
 	virtual void requestSort();
 	virtual void setPassedFilter(bool filtered, S32 filter_generation, std::string::size_type string_offset = std::string::npos, std::string::size_type string_size = 0);
 	virtual bool filter( LLFolderViewFilter& filter);
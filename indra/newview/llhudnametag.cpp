@@ -319,6 +319,9 @@ void LLHUDNameTag::renderText(BOOL for_select)
 	}
 
 	F32 y_offset = (F32)mOffsetY;
+
+	// every line is drawn with the same 2D projection, let the glyphs share draw calls
+	LLFontGL::beginBatch();
 		
 	// Render label
 	{
@@ -391,6 +394,8 @@ void LLHUDNameTag::renderText(BOOL for_select)
 			hud_render_text(segment_iter->getText(), render_position, *fontp, style, shadow, x_offset, y_offset, text_color, FALSE);
 		}
 	}
+	LLFontGL::endBatch();
+
 	/// Reset the default color to white.  The renderer expects this to be the default. 
 	gGL.color4f(1.0f, 1.0f, 1.0f, 1.0f);
 	if (for_select)
@@ -0,0 +1,115 @@
+/**
+ * @file llidleupdatephase.cpp
+ * @brief One phase of the per-frame idle update of viewer objects.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llidleupdatephase.h"
+
+#include <boost/bind.hpp>
+
+#include "lltimer.h"
+#include "llworkpool.h"
+
+// batches per thread handed to the pool between looks at the budget
+static const U32 ROUND_BATCHES_PER_THREAD = 4;
+
+LLIdleUpdatePhase::LLIdleUpdatePhase(LLTrace::BlockTimerStatHandle& timer, U32 batch_size)
+:	mTimer(timer),
+	mBatchSize(llmax(batch_size, (U32) 1)),
+	mCursor(0),
+	mWork(NULL),
+	mRoundStart(0),
+	mRoundCount(0)
+{
+}
+
+U32 LLIdleUpdatePhase::run(const work_t& work, F32 budget_ms, LLWorkPool* pool)
+{
+	LL_RECORD_BLOCK_TIME(mTimer);
+
+	const U32 count = mObjects.size();
+	if (!count)
+	{
+		return 0;
+	}
+	if (mCursor >= count)
+	{	// fewer objects than last frame
+		mCursor = 0;
+	}
+
+	const F32 budget = llmax(budget_ms, 0.f) * 0.001f;
+	LLTimer timer;
+	U32 done = 0;
+
+	if (pool && count > mBatchSize)
+	{
+		const U32 round_size = budget > 0.f
+			? mBatchSize * ROUND_BATCHES_PER_THREAD * (pool->getThreadCount() + 1)
+			: count;
+
+		mWork = &work;
+		while (done < count)
+		{
+			mRoundStart = (mCursor + done) % count;
+			mRoundCount = llmin(round_size, count - done);
+			pool->run((mRoundCount + mBatchSize - 1) / mBatchSize, boost::bind(&LLIdleUpdatePhase::runBatch, this, _1));
+			done += mRoundCount;
+
+			if (budget > 0.f && timer.getElapsedTimeF32() > budget)
+			{
+				break;
+			}
+		}
+		mWork = NULL;
+	}
+	else
+	{
+		while (done < count)
+		{
+			work(mObjects[(mCursor + done) % count]);
+			++done;
+
+			if (budget > 0.f && timer.getElapsedTimeF32() > budget)
+			{
+				break;
+			}
+		}
+	}
+
+	// a full run leaves the cursor where it was
+	mCursor = (mCursor + done) % count;
+	return done;
+}
+
+void LLIdleUpdatePhase::runBatch(U32 index)
+{
+	const U32 count = mObjects.size();
+	const U32 end = llmin(mRoundCount, (index + 1) * mBatchSize);
+	for (U32 i = index * mBatchSize; i < end; ++i)
+	{
+		(*mWork)(mObjects[(mRoundStart + i) % count]);
+	}
+}
@@ -0,0 +1,86 @@
+/**
+ * @file llidleupdatephase.h
+ * @brief One phase of the per-frame idle update of viewer objects.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLIDLEUPDATEPHASE_H
+#define LL_LLIDLEUPDATEPHASE_H
+
+#include <vector>
+#include <boost/function.hpp>
+
+#include "llfasttimer.h"
+
+class LLViewerObject;
+class LLWorkPool;
+
+//-------------------------------------------------------------------
+// LLIdleUpdatePhase
+//
+// One kind of idle work done to a list of objects each frame, timed under
+// its own name.  Given a budget the phase stops once it has spent it, and
+// the next frame starts with the objects it did not get to, so every
+// object gets its turn however busy the scene.  Given a pool the objects
+// are handed out to it in batches, then the work must only touch the
+// object it is given.
+//
+// The objects are queued again every frame, they are only held until the
+// frame's run() returns.
+//-------------------------------------------------------------------
+class LLIdleUpdatePhase
+{
+public:
+	typedef boost::function<void (LLViewerObject*)> work_t;
+
+	// batch_size is how many objects a worker takes at a time, enough
+	// that each batch is worth handing over
+	LLIdleUpdatePhase(LLTrace::BlockTimerStatHandle& timer, U32 batch_size);
+
+	void clear()							{ mObjects.clear(); }
+	void add(LLViewerObject* objectp)		{ mObjects.push_back(objectp); }
+	bool empty() const						{ return mObjects.empty(); }
+	U32 size() const						{ return mObjects.size(); }
+	LLViewerObject* get(U32 index) const	{ return mObjects[index]; }
+
+	// Does the work for the queued objects until all have had it or
+	// budget_ms is spent (0 for no budget), spread over the pool when there
+	// is one.  Returns how many objects were done.
+	U32 run(const work_t& work, F32 budget_ms, LLWorkPool* pool = NULL);
+
+private:
+	void runBatch(U32 index);
+
+	LLTrace::BlockTimerStatHandle& mTimer;
+	const U32 mBatchSize;
+	std::vector<LLViewerObject*> mObjects;
+	// where the next run starts, carried over from frame to frame
+	U32 mCursor;
+
+	// the round of batches being spread over the pool
+	const work_t* mWork;
+	U32 mRoundStart;
+	U32 mRoundCount;
+};
+
+#endif // LL_LLIDLEUPDATEPHASE_H
@@ -177,6 +177,7 @@ LLInvFVBridge::LLInvFVBridge(LLInventoryPanel* inventory,
 	mRoot(root),
 	mInvType(LLInventoryType::IT_NONE),
 	mIsLink(FALSE),
+	mSearchSlot(LLSubstringIndex::NO_SLOT),
 	LLFolderViewModelItemInventory(inventory->getRootViewModel())
 {
 	mInventoryPanel = inventory->getInventoryPanelHandle();
@@ -184,6 +185,45 @@ LLInvFVBridge::LLInvFVBridge(LLInventoryPanel* inventory,
 	mIsLink = obj && obj->getIsLinkType();
 }
 
+LLInvFVBridge::~LLInvFVBridge()
+{
+	boost::shared_ptr<LLSubstringIndex> index = mSearchIndex.lock();
+	if (index && mSearchSlot != LLSubstringIndex::NO_SLOT)
+	{
+		index->remove(mSearchSlot);
+	}
+}
+
+void LLInvFVBridge::buildSearchableName() const
+{
+	mSearchableName.assign(mDisplayName);
+	mSearchableName.append(getLabelSuffix());
+	LLStringUtil::toUpper(mSearchableName);
+
+	boost::shared_ptr<LLSubstringIndex> index = mSearchIndex.lock();
+	if (!index)
+	{
+		LLInventoryFilter* filter = getInventoryFilter();
+		if (!filter)
+		{
+			return;
+		}
+		// first name, or the filter that held the last one is gone
+		index = filter->getNameIndex();
+		mSearchIndex = index;
+		mSearchSlot = LLSubstringIndex::NO_SLOT;
+	}
+
+	if (mSearchSlot == LLSubstringIndex::NO_SLOT)
+	{
+		mSearchSlot = index->add(mSearchableName);
+	}
+	else
+	{
+		index->update(mSearchSlot, mSearchableName);
+	}
+}
+
 const std::string& LLInvFVBridge::getName() const
 {
 	const LLInventoryObject* obj = getInventoryObject();
@@ -1785,9 +1825,7 @@ void LLItemBridge::buildDisplayName() const
 		mDisplayName.assign(LLStringUtil::null);
 	}
 	
-	mSearchableName.assign(mDisplayName);
-	mSearchableName.append(getLabelSuffix());
-	LLStringUtil::toUpper(mSearchableName);
+	buildSearchableName();
 	
     //Name set, so trigger a sort
     if(mParent)
@@ -2086,9 +2124,7 @@ void LLFolderBridge::buildDisplayName() const
 		LLTrans::findString(mDisplayName, std::string("InvFolder ") + getName(), LLSD());
 	}
 
-	mSearchableName.assign(mDisplayName);
-	mSearchableName.append(getLabelSuffix());
-	LLStringUtil::toUpper(mSearchableName);
+	buildSearchableName();
 
     //Name set, so trigger a sort
     if(mParent)
@@ -5297,9 +5333,7 @@ void LLCallingCardBridge::checkSearchBySuffixChanges()
 		{
 			return;
 		}
-		mSearchableName.assign(mDisplayName);
-		mSearchableName.append(getLabelSuffix());
-		LLStringUtil::toUpper(mSearchableName);
+		buildSearchableName();
 		if (new_length<old_length)
 		{
 			LLInventoryFilter* filter = getInventoryFilter();
@@ -39,6 +39,8 @@
 #include "lllandmarklist.h"
 #include "llfolderviewitem.h"
 
+#include <boost/weak_ptr.hpp>
+
 class LLInventoryFilter;
 class LLInventoryPanel;
 class LLInventoryModel;
@@ -73,7 +75,7 @@ public:
 									   LLFolderView* root,
 									   const LLUUID& uuid,
 									   U32 flags = 0x00);
-	virtual ~LLInvFVBridge() {}
+	virtual ~LLInvFVBridge();
 
 	bool canShare() const;
 	bool canListOnMarketplace() const;
@@ -93,6 +95,7 @@ public:
 	virtual const std::string& getName() const;
 	virtual const std::string& getDisplayName() const;
 	const std::string& getSearchableName() const { return mSearchableName; }
+	virtual S32 getSearchSlot() const { return mSearchSlot; }
 
 	virtual PermissionMask getPermissionMask() const;
 	virtual LLFolderType::EType getPreferredType() const;
@@ -184,10 +187,15 @@ protected:
 	LLTimer						mTimeSinceRequestStart;
 	mutable std::string			mDisplayName;
 	mutable std::string			mSearchableName;
+	// where mSearchableName is kept in the filter's name index
+	mutable boost::weak_ptr<LLSubstringIndex>	mSearchIndex;
+	mutable S32					mSearchSlot;
 
 	void purgeItem(LLInventoryModel *model, const LLUUID &uuid);
 	void removeObject(LLInventoryModel *model, const LLUUID &uuid);
 	virtual void buildDisplayName() const {}
+	// upper cased display name and label suffix, passed on to the name index
+	void buildSearchableName() const;
 };
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
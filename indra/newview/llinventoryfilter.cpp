@@ -40,12 +40,14 @@
 #include "llinventorybridge.h"
 #include "llviewerfoldertype.h"
 #include "llradiogroup.h"
+#include "pipeline.h"
 
 // linden library includes
 #include "llclipboard.h"
 #include "lltrans.h"
 
 LLTrace::BlockTimerStatHandle FT_FILTER_CLIPBOARD("Filter Clipboard");
+static LLTrace::BlockTimerStatHandle FTM_FILTER_NAME_INDEX("Filter Name Index");
 
 LLInventoryFilter::FilterOps::FilterOps(const Params& p)
 :	mFilterObjectTypes(p.object_types),
@@ -75,7 +77,8 @@ LLInventoryFilter::LLInventoryFilter(const Params& p)
 	mFilterSubString(p.substring),
 	mCurrentGeneration(0),
 	mFirstRequiredGeneration(0),
-	mFirstSuccessGeneration(0)
+	mFirstSuccessGeneration(0),
+	mNameIndex(new LLSubstringIndex())
 {
 	// copy mFilterOps into mDefaultFilterOps
 	markDefault();
@@ -84,21 +87,27 @@ LLInventoryFilter::LLInventoryFilter(const Params& p)
 bool LLInventoryFilter::check(const LLFolderViewModelItem* item) 
 {
 	const LLFolderViewModelItemInventory* listener = dynamic_cast<const LLFolderViewModelItemInventory*>(item);
-	// Clipboard cut items are *always* filtered so we need this value upfront
-	const BOOL passed_clipboard = (listener ? checkAgainstClipboard(listener->getUUID()) : TRUE);
 
 	// If it's a folder and we're showing all folders, return automatically.
+	// Clipboard cut items are *always* filtered though.
 	const BOOL is_folder = listener->getInventoryType() == LLInventoryType::IT_CATEGORY;
 	if (is_folder && (mFilterOps.mShowFolderState == LLInventoryFilter::SHOW_ALL_FOLDERS))
 	{
-		return passed_clipboard;
+		return checkAgainstClipboard(listener->getUUID());
+	}
+
+	// Cheapest tests first: while typing most items fail on the string alone,
+	// and the clipboard check walks up the parents of every item in cut mode.
+	if (mFilterSubString.size() && mNameMatches.getText() != mFilterSubString)
+	{
+		updateNameMatches();
 	}
 
-	bool passed = (mFilterSubString.size() ? listener->getSearchableName().find(mFilterSubString) != std::string::npos : true);
+	bool passed = !mFilterSubString.size() || findSubString(listener) != std::string::npos;
 	passed = passed && checkAgainstFilterType(listener);
-	passed = passed && checkAgainstPermissions(listener);
 	passed = passed && checkAgainstFilterLinks(listener);
-	passed = passed && passed_clipboard;
+	passed = passed && checkAgainstPermissions(listener);
+	passed = passed && checkAgainstClipboard(listener->getUUID());
 
 	return passed;
 }
@@ -460,9 +469,42 @@ const std::string& LLInventoryFilter::getFilterSubString(BOOL trim) const
 
 std::string::size_type LLInventoryFilter::getStringMatchOffset(LLFolderViewModelItem* item) const
 {
+	const LLFolderViewModelItemInventory* listener = dynamic_cast<const LLFolderViewModelItemInventory*>(item);
+	if (listener)
+	{
+		return findSubString(listener);
+	}
 	return mFilterSubString.size() ? item->getSearchableName().find(mFilterSubString) : std::string::npos;
 }
 
+std::string::size_type LLInventoryFilter::findSubString(const LLFolderViewModelItemInventory* listener) const
+{
+	if (!mFilterSubString.size())
+	{
+		return std::string::npos;
+	}
+
+	// Names not indexed, or renamed since the index was searched, are
+	// searched directly.
+	const S32 slot = listener->getSearchSlot();
+	if (slot != LLSubstringIndex::NO_SLOT
+		&& mNameMatches.getText() == mFilterSubString
+		&& mNameMatches.isCurrent(*mNameIndex, slot))
+	{
+		return mNameMatches.getOffset(slot);
+	}
+	return listener->getSearchableName().find(mFilterSubString);
+}
+
+void LLInventoryFilter::updateNameMatches()
+{
+	LL_RECORD_BLOCK_TIME(FTM_FILTER_NAME_INDEX);
+
+	// Typing more of the name only rechecks what matched before, checks
+	// are spread over the pool
+	mNameIndex->find(mFilterSubString, mNameMatches, gPipeline.getGeometryPool());
+}
+
 bool LLInventoryFilter::isDefault() const
 {
 	return !isNotDefault();
@@ -30,6 +30,9 @@
 #include "llinventorytype.h"
 #include "llpermissionsflags.h"
 #include "llfolderviewmodel.h"
+#include "llsubstringindex.h"
+
+#include <boost/shared_ptr.hpp>
 
 class LLFolderViewItem;
 class LLFolderViewFolder;
@@ -219,6 +222,10 @@ public:
 
 	std::string::size_type getStringMatchOffset(LLFolderViewModelItem* item) const;
 	std::string::size_type getFilterStringSize() const;
+
+	// Searchable names of the panel's items, kept up to date by the bridges.
+	// Bridges hold it weakly as they may outlive the filter.
+	const boost::shared_ptr<LLSubstringIndex>& getNameIndex() const { return mNameIndex; }
 	// +-------------------------------------------------------------------+
 	// + Presentation
 	// +-------------------------------------------------------------------+
@@ -278,6 +285,8 @@ private:
 	bool 				checkAgainstPermissions(const LLInventoryItem* item) const;
 	bool 				checkAgainstFilterLinks(const class LLFolderViewModelItemInventory* listener) const;
 	bool				checkAgainstClipboard(const LLUUID& object_id) const;
+	std::string::size_type findSubString(const class LLFolderViewModelItemInventory* listener) const;
+	void				updateNameMatches();
 
 	FilterOps				mFilterOps;
 	FilterOps				mDefaultFilterOps;
@@ -294,6 +303,11 @@ private:
 	S32						mFirstRequiredGeneration;
 	S32						mFirstSuccessGeneration;
 
+	// names holding the filter substring, searched once per change of the
+	// substring rather than once per item
+	boost::shared_ptr<LLSubstringIndex> mNameIndex;
+	LLSubstringIndex::Matches	mNameMatches;
+
 	EFilterModified 		mFilterModified;
 	LLTimer                 mFilterTime;
     
@@ -38,6 +38,7 @@
 #include "llinventorypanel.h"
 #include "llinventorybridge.h"
 #include "llinventoryfunctions.h"
+#include "llinventorycache.h"
 #include "llinventoryobserver.h"
 #include "llinventorypanel.h"
 #include "llnotificationsutil.h"
@@ -148,6 +149,7 @@ LLInventoryModel::LLInventoryModel()
 	mIsNotifyObservers(FALSE),
 	mModifyMask(LLInventoryObserver::ALL),
 	mChangedItemIDs(),
+	mCacheDirtyIDs(),
 	mObservers(),
 	mHttpRequestFG(NULL),
 	mHttpRequestBG(NULL),
@@ -1011,7 +1013,7 @@ LLInventoryModel::cat_array_t* LLInventoryModel::getUnlockedCatArray(const LLUUI
 	cat_array_t* cat_array = get_ptr_in_map(mParentChildCategoryTree, id);
 	if (cat_array)
 	{
-		llassert_always(mCategoryLock[id] == false);
+		llassert_always(!get_if_there(mCategoryLock, id, false));
 	}
 	return cat_array;
 }
@@ -1021,7 +1023,7 @@ LLInventoryModel::item_array_t* LLInventoryModel::getUnlockedItemArray(const LLU
 	item_array_t* item_array = get_ptr_in_map(mParentChildItemTree, id);
 	if (item_array)
 	{
-		llassert_always(mItemLock[id] == false);
+		llassert_always(!get_if_there(mItemLock, id, false));
 	}
 	return item_array;
 }
@@ -1094,8 +1096,8 @@ void LLInventoryModel::updateCategory(const LLViewerInventoryCategory* cat, U32
 		}
 
 		// make space in the tree for this category's children.
-		llassert_always(mCategoryLock[new_cat->getUUID()] == false);
-		llassert_always(mItemLock[new_cat->getUUID()] == false);
+		llassert_always(!get_if_there(mCategoryLock, new_cat->getUUID(), false));
+		llassert_always(!get_if_there(mItemLock, new_cat->getUUID(), false));
 		cat_array_t* catsp = new cat_array_t;
 		item_array_t* itemsp = new item_array_t;
 		mParentChildCategoryTree[new_cat->getUUID()] = catsp;
@@ -1578,6 +1580,10 @@ void LLInventoryModel::addChangedMask(U32 mask, const LLUUID& referent)
 	}
 	
 	mModifyMask |= mask;
+	if (referent.notNull())
+	{
+		mCacheDirtyIDs.insert(referent);
+	}
 	if (referent.notNull() && (mChangedItemIDs.find(referent) == mChangedItemIDs.end()))
 	{
 		mChangedItemIDs.insert(referent);
@@ -1669,9 +1675,20 @@ void LLInventoryModel::cache(
 		INCLUDE_TRASH,
 		can_cache);
 	std::string inventory_filename = getInvCacheAddres(agent_id);
-	saveToFile(inventory_filename, categories, items);
 	std::string gzip_filename(inventory_filename);
 	gzip_filename.append(".gz");
+	std::string binary_filename(inventory_filename);
+	binary_filename.append(".bin");
+	if(saveToBinaryCache(binary_filename, agent_id, categories, items))
+	{
+		// The text cache is only read when there is no binary one.
+		if(LLFile::isfile(gzip_filename))
+		{
+			LLFile::remove(gzip_filename);
+		}
+		return;
+	}
+	saveToFile(inventory_filename, categories, items);
 	if(gzip_file(inventory_filename, gzip_filename))
 	{
 		LL_DEBUGS(LOG_INV) << "Successfully compressed " << inventory_filename << LL_ENDL;
@@ -1976,26 +1993,54 @@ bool LLInventoryModel::loadSkeleton(
 		const S32 NO_VERSION = LLViewerInventoryCategory::VERSION_UNKNOWN;
 		std::string gzip_filename(inventory_filename);
 		gzip_filename.append(".gz");
-		LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+		std::string binary_filename(inventory_filename);
+		binary_filename.append(".bin");
 		bool remove_inventory_file = false;
-		if(fp)
+		bool is_cache_obsolete = false;
+		bool is_cache_loaded = false;
+
+		// Prefer the binary cache.  Its categories are read up front, items
+		// are only decoded below for the categories that are still current.
+		LLInventoryCacheReader cache_reader;
+		CacheFileState& cache_state = mCacheFileStates[owner_id];
+		cache_state = CacheFileState();
+		if(cache_reader.open(binary_filename))
 		{
-			fclose(fp);
-			fp = NULL;
-			if(gunzip_file(gzip_filename, inventory_filename))
+			U32 cat_count = cache_reader.getNumCategories();
+			for(U32 i = 0; i < cat_count; ++i)
 			{
-				// we only want to remove the inventory file if it was
-				// gzipped before we loaded, and we successfully
-				// gunziped it.
-				remove_inventory_file = true;
+				const LLInventoryCache::CategoryRecord& record = cache_reader.getCategory(i);
+				LLPointer<LLViewerInventoryCategory> cat = new LLViewerInventoryCategory(record.mOwnerID);
+				cache_reader.readCategory(record, *cat);
+				cat->setVersion(record.mVersion);
+				categories.push_back(cat);
+				cache_state.mVersions[record.mID] = record.mVersion;
 			}
-			else
+			cache_state.mValid = true;
+			is_cache_loaded = true;
+		}
+		else
+		{
+			LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+			if(fp)
 			{
-				LL_INFOS(LOG_INV) << "Unable to gunzip " << gzip_filename << LL_ENDL;
+				fclose(fp);
+				fp = NULL;
+				if(gunzip_file(gzip_filename, inventory_filename))
+				{
+					// we only want to remove the inventory file if it was
+					// gzipped before we loaded, and we successfully
+					// gunziped it.
+					remove_inventory_file = true;
+				}
+				else
+				{
+					LL_INFOS(LOG_INV) << "Unable to gunzip " << gzip_filename << LL_ENDL;
+				}
 			}
+			is_cache_loaded = loadFromFile(inventory_filename, categories, items, is_cache_obsolete);
 		}
-		bool is_cache_obsolete = false;
-		if(loadFromFile(inventory_filename, categories, items, is_cache_obsolete))
+		if(is_cache_loaded)
 		{
 			// We were able to find a cache of files. So, use what we
 			// found to generate a set of categories we should add. We
@@ -2055,6 +2100,31 @@ bool LLInventoryModel::loadSkeleton(
 				++child_counts[(*it)->getParentUUID()];
 			}
 
+			if(cache_reader.getNumItems() > 0)
+			{
+				// Only build the items whose folder was cached at the
+				// version it still has.
+				U32 item_count = cache_reader.getNumItems();
+				for(U32 i = 0; i < item_count; ++i)
+				{
+					const LLInventoryCache::ItemRecord& record = cache_reader.getItem(i);
+					if(record.mID.isNull() || cached_ids.find(record.mParentID) == not_cached_id)
+					{
+						continue;
+					}
+					const LLViewerInventoryCategory* cat = getCategory(record.mParentID);
+					if(!cat || cat->getVersion() != record.mParentVersion)
+					{
+						continue;
+					}
+					LLPointer<LLViewerInventoryItem> item = new LLViewerInventoryItem;
+					cache_reader.readItem(record, *item);
+					item->setComplete(FALSE);
+					items.push_back(item);
+				}
+				cache_reader.close();
+			}
+
 			// Add all the items loaded which are parented to a
 			// category with a correctly cached parent
 			S32 bad_link_count = 0;
@@ -2212,6 +2282,9 @@ void LLInventoryModel::buildParentChildMap()
 	cat_array_t cats;
 	cat_array_t* catsp;
 	item_array_t* itemsp;
+	cats.reserve(mCategoryMap.size());
+	mParentChildCategoryTree.reserve(mCategoryMap.size() + 1);
+	mParentChildItemTree.reserve(mCategoryMap.size());
 	
 	for(cat_map_t::iterator cit = mCategoryMap.begin(); cit != mCategoryMap.end(); ++cit)
 	{
@@ -2219,13 +2292,13 @@ void LLInventoryModel::buildParentChildMap()
 		cats.push_back(cat);
 		if (mParentChildCategoryTree.count(cat->getUUID()) == 0)
 		{
-			llassert_always(mCategoryLock[cat->getUUID()] == false);
+			llassert_always(!get_if_there(mCategoryLock, cat->getUUID(), false));
 			catsp = new cat_array_t;
 			mParentChildCategoryTree[cat->getUUID()] = catsp;
 		}
 		if (mParentChildItemTree.count(cat->getUUID()) == 0)
 		{
-			llassert_always(mItemLock[cat->getUUID()] == false);
+			llassert_always(!get_if_there(mItemLock, cat->getUUID(), false));
 			itemsp = new item_array_t;
 			mParentChildItemTree[cat->getUUID()] = itemsp;
 		}
@@ -2325,6 +2398,7 @@ void LLInventoryModel::buildParentChildMap()
 	item_array_t items;
 	if(!mItemMap.empty())
 	{
+		items.reserve(mItemMap.size());
 		LLPointer<LLViewerInventoryItem> item;
 		for(item_map_t::iterator iit = mItemMap.begin(); iit != mItemMap.end(); ++iit)
 		{
@@ -2701,6 +2775,116 @@ bool LLInventoryModel::saveToFile(const std::string& filename,
 	return true;
 }
 
+bool LLInventoryModel::saveToBinaryCache(const std::string& filename,
+										 const LLUUID& owner_id,
+										 const cat_array_t& categories,
+										 const item_array_t& items)
+{
+	CacheFileState& state = mCacheFileStates[owner_id];
+
+	// Work out what changed since the file was loaded or last written.
+	std::map<LLUUID, S32> versions;
+	std::set<LLUUID> changed_cat_ids;
+	cat_array_t changed_cats;
+	S32 count = categories.size();
+	for(S32 i = 0; i < count; ++i)
+	{
+		LLViewerInventoryCategory* cat = categories[i];
+		S32 version = cat->getVersion();
+		if(version == LLViewerInventoryCategory::VERSION_UNKNOWN)
+		{
+			continue;
+		}
+		versions[cat->getUUID()] = version;
+		std::map<LLUUID, S32>::const_iterator it = state.mVersions.find(cat->getUUID());
+		if(it == state.mVersions.end() || it->second != version)
+		{
+			// every item needs the new version to be loaded again
+			changed_cat_ids.insert(cat->getUUID());
+			changed_cats.push_back(cat);
+		}
+		else if(mCacheDirtyIDs.find(cat->getUUID()) != mCacheDirtyIDs.end())
+		{
+			changed_cats.push_back(cat);
+		}
+	}
+	item_array_t changed_items;
+	count = items.size();
+	for(S32 i = 0; i < count; ++i)
+	{
+		LLViewerInventoryItem* item = items[i];
+		if(changed_cat_ids.find(item->getParentUUID()) != changed_cat_ids.end()
+		   || mCacheDirtyIDs.find(item->getUUID()) != mCacheDirtyIDs.end())
+		{
+			changed_items.push_back(item);
+		}
+	}
+
+	// Append unless the journal would outgrow the records it amends.
+	LLInventoryCacheWriter writer;
+	bool append = state.mValid && writer.append(filename)
+		&& writer.getJournalEntries() + changed_cats.size() + changed_items.size() <= writer.getBaseRecords() / 2;
+	if(append)
+	{
+		LL_INFOS(LOG_INV) << "Appending " << changed_cats.size() << " categories and "
+						  << changed_items.size() << " items to " << filename << LL_ENDL;
+		for(std::map<LLUUID, S32>::const_iterator it = state.mVersions.begin(); it != state.mVersions.end(); ++it)
+		{
+			if(versions.find(it->first) == versions.end())
+			{
+				writer.removeObject(it->first);
+			}
+		}
+		for(changed_items_t::const_iterator it = mCacheDirtyIDs.begin(); it != mCacheDirtyIDs.end(); ++it)
+		{
+			if(!getObject(*it))
+			{
+				writer.removeObject(*it);
+			}
+		}
+	}
+	else
+	{
+		LL_INFOS(LOG_INV) << "Writing " << versions.size() << " categories and "
+						  << items.size() << " items to " << filename << LL_ENDL;
+		writer.create(filename);
+		changed_cats.clear();
+		changed_items.clear();
+		for(S32 i = 0; i < (S32)categories.size(); ++i)
+		{
+			if(versions.find(categories[i]->getUUID()) != versions.end())
+			{
+				changed_cats.push_back(categories[i]);
+			}
+		}
+		changed_items = items;
+	}
+
+	for(cat_array_t::const_iterator it = changed_cats.begin(); it != changed_cats.end(); ++it)
+	{
+		LLViewerInventoryCategory* cat = *it;
+		writer.addCategory(*cat, cat->getOwnerID(), cat->getVersion());
+	}
+	for(item_array_t::const_iterator it = changed_items.begin(); it != changed_items.end(); ++it)
+	{
+		LLViewerInventoryItem* item = *it;
+		std::map<LLUUID, S32>::const_iterator parent = versions.find(item->getParentUUID());
+		if(parent != versions.end())
+		{
+			writer.addItem(*item, parent->second);
+		}
+	}
+
+	if(!writer.commit())
+	{
+		state = CacheFileState();
+		return false;
+	}
+	state.mValid = true;
+	state.mVersions.swap(versions);
+	return true;
+}
+
 // message handling functionality
 // static
 void LLInventoryModel::registerCallbacks(LLMessageSystem* msg)
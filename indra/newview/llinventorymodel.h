@@ -36,6 +36,7 @@
 #include "llfoldertype.h"
 #include "llframetimer.h"
 #include "lluuid.h"
+#include "lluuidhashmap.h"
 #include "llpermissionsflags.h"
 #include "llviewerinventory.h"
 #include "llstring.h"
@@ -170,18 +171,32 @@ public:
 	// Call on logout to save a terse representation.
 	void cache(const LLUUID& parent_folder_id, const LLUUID& agent_id);
 private:
+	// What each owner's binary cache file holds, so that cache() can append
+	// the changes since login instead of rewriting the whole file.
+	struct CacheFileState
+	{
+		CacheFileState() : mValid(false) {}
+		bool mValid;
+		std::map<LLUUID, S32> mVersions; // category id -> version in the file
+	};
+	typedef std::map<LLUUID, CacheFileState> cache_file_state_map_t;
+	cache_file_state_map_t mCacheFileStates;
+
 	// Information for tracking the actual inventory. We index this
 	// information in a lot of different ways so we can access
 	// the inventory using several different identifiers.
 	// mInventory member data is the 'master' list of inventory, and
 	// mCategoryMap and mItemMap store uuid->object mappings. 
-	typedef std::map<LLUUID, LLPointer<LLViewerInventoryCategory> > cat_map_t;
-	typedef std::map<LLUUID, LLPointer<LLViewerInventoryItem> > item_map_t;
+	// These are hashed rather than ordered, iteration order is arbitrary.
+	typedef LLUUIDHashMap<LLPointer<LLViewerInventoryCategory> > cat_map_t;
+	typedef LLUUIDHashMap<LLPointer<LLViewerInventoryItem> > item_map_t;
 	cat_map_t mCategoryMap;
 	item_map_t mItemMap;
 	// This last set of indices is used to map parents to children.
-	typedef std::map<LLUUID, cat_array_t*> parent_cat_map_t;
-	typedef std::map<LLUUID, item_array_t*> parent_item_map_t;
+	// The arrays are allocated separately so the pointers handed out by
+	// getDirectDescendentsOf() survive the index growing.
+	typedef LLUUIDHashMap<cat_array_t*> parent_cat_map_t;
+	typedef LLUUIDHashMap<item_array_t*> parent_item_map_t;
 	parent_cat_map_t mParentChildCategoryTree;
 	parent_item_map_t mParentChildItemTree;
 
@@ -537,6 +552,8 @@ private:
 	U32 mModifyMask;
 	changed_items_t mChangedItemIDs;
 	changed_items_t mAddedItemIDs;
+	// Everything changed since login, for writing the inventory cache.
+	changed_items_t mCacheDirtyIDs;
 	
 	
 	//--------------------------------------------------------------------
@@ -616,6 +633,10 @@ protected:
 	static bool saveToFile(const std::string& filename,
 						   const cat_array_t& categories,
 						   const item_array_t& items); 
+	bool saveToBinaryCache(const std::string& filename,
+						   const LLUUID& owner_id,
+						   const cat_array_t& categories,
+						   const item_array_t& items);
 
 	//--------------------------------------------------------------------
 	// Message handling functionality
@@ -648,8 +669,8 @@ protected:
 	cat_array_t* getUnlockedCatArray(const LLUUID& id);
 	item_array_t* getUnlockedItemArray(const LLUUID& id);
 private:
-	std::map<LLUUID, bool> mCategoryLock;
-	std::map<LLUUID, bool> mItemLock;
+	LLUUIDHashMap<bool> mCategoryLock;
+	LLUUIDHashMap<bool> mItemLock;
 	
 	//--------------------------------------------------------------------
 	// Debugging
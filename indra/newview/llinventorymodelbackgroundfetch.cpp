@@ -76,12 +76,10 @@
 // * Review the download rate throttling.  Slow then fast?
 //   Detect bandwidth usage and speed up when it drops?
 //
-// * A lot of calls to notifyObservers().  It looks like
-//   these could be collapsed by maintaining a 'dirty'
-//   bit and there appears to be an attempt to do this.
-//   But it isn't used or is used in a limited fashion.
-//   Are there semanic issues requiring a call after certain
-//   updateItem() calls?
+// * A lot of calls to notifyObservers().  Folder responses
+//   now set a flag and bulkFetch() notifies once for all
+//   the responses handled in a pass, item responses still
+//   notify individually.
 //
 // * An error on a fetch could be due to one item in the batch.
 //   If the batch were broken up, perhaps more of the inventory
@@ -178,6 +176,7 @@ private:
 private:
 	LLSD mRequestSD;
 	const uuid_vec_t mRecursiveCatUUIDs; // hack for storing away which cat fetches are recursive
+	LLTimer mRequestTimer;
 };
 
 
@@ -197,7 +196,9 @@ LLInventoryModelBackgroundFetch::LLInventoryModelBackgroundFetch():
 	mAllFoldersFetched(FALSE),
 	mRecursiveInventoryFetchStarted(FALSE),
 	mRecursiveLibraryFetchStarted(FALSE),
-	mMinTimeBetweenFetches(0.3f)
+	mMinTimeBetweenFetches(0.3f),
+	mBatchSize(10),
+	mObserversNeedNotify(false)
 {}
 
 LLInventoryModelBackgroundFetch::~LLInventoryModelBackgroundFetch()
@@ -372,12 +373,8 @@ void LLInventoryModelBackgroundFetch::bulkFetch()
 		return;
 	}
 
-	// *TODO:  These values could be tweaked at runtime to effect
-	// a fast/slow fetch throttle.  Once login is complete and the scene
-	// is mostly loaded, we could turn up the throttle and fill missing
-	// inventory more quickly.
-	static const U32 max_batch_size(10);
-	static const S32 max_concurrent_fetches(12);		// Outstanding requests, not connections
+	// Batch size adapts to folder response times, see recordFolderFetch().
+	static LLCachedControl<S32> max_concurrent_fetches(gSavedSettings, "InventoryFetchMaxConcurrent", 12);		// Outstanding requests, not connections
 	static const F32 new_min_time(0.05f);		// *HACK:  Clean this up when old code goes away entirely.
 	
 	mMinTimeBetweenFetches = new_min_time;
@@ -390,14 +387,42 @@ void LLInventoryModelBackgroundFetch::bulkFetch()
 	{
 		// Process completed background HTTP requests
 		gInventory.handleResponses(false);
+
+		// Handlers only flag their changes, tell observers about all of them at once
+		if (mObserversNeedNotify)
+		{
+			mObserversNeedNotify = false;
+			gInventory.notifyObservers();
+		}
 	}
 	
-	if ((mFetchCount > max_concurrent_fetches) ||
+	if ((mFetchCount >= max_concurrent_fetches) ||
 		(mFetchTimer.getElapsedTimeF32() < mMinTimeBetweenFetches))
 	{
 		return;
 	}
 
+	// Keep the pipe full rather than sending one batch per interval
+	U32 sent_count(0);
+	while (! mFetchQueue.empty() && mFetchCount < max_concurrent_fetches)
+	{
+		sent_count += sendFetchBatch(region);
+	}
+
+	if (sent_count)
+	{
+		mFetchTimer.reset();
+	}
+	else if (isBulkFetchProcessingComplete())
+	{
+		setAllFoldersFetched();
+	}
+}
+
+// Takes up to mBatchSize entries off the fetch queue and posts them.
+// Returns the number of folders and items requested.
+U32 LLInventoryModelBackgroundFetch::sendFetchBatch(LLViewerRegion* region)
+{
 	U32 item_count(0);
 	U32 folder_count(0);
 
@@ -413,7 +438,7 @@ void LLInventoryModelBackgroundFetch::bulkFetch()
 	LLSD item_request_body_lib;
 
 	while (! mFetchQueue.empty() 
-			&& (item_count + folder_count) < max_batch_size)
+			&& (item_count + folder_count) < mBatchSize)
 	{
 		const FetchQueueInfo & fetch_info(mFetchQueue.front());
 		if (fetch_info.mIsCategory)
@@ -558,13 +583,28 @@ void LLInventoryModelBackgroundFetch::bulkFetch()
 				}
 			}
 		} // if (item_count)
-		
-		mFetchTimer.reset();
 	}
-	else if (isBulkFetchProcessingComplete())
+
+	return item_count + folder_count;
+}
+
+// Additive increase, multiplicative decrease of the folder batch size, so
+// that fast responses grow batches and slow or failing ones split them up.
+void LLInventoryModelBackgroundFetch::recordFolderFetch(bool success, F32 latency)
+{
+	static LLCachedControl<U32> max_batch_size(gSavedSettings, "InventoryFetchMaxBatchSize", 40);
+	static LLCachedControl<F32> target_latency(gSavedSettings, "InventoryFetchTargetLatency", 1.f);
+
+	if (success && latency < target_latency)
 	{
-		setAllFoldersFetched();
+		mBatchSize = llmin(mBatchSize + 1, llmax((U32)max_batch_size, 1U));
+	}
+	else
+	{
+		mBatchSize = llmax(mBatchSize / 2, 1U);
 	}
+	LL_DEBUGS(LOG_INV) << "Folder fetch " << (success ? "took " : "failed after ") << latency
+					   << "s, batch size now " << mBatchSize << LL_ENDL;
 }
 
 bool LLInventoryModelBackgroundFetch::fetchQueueContainsNoDescendentsOf(const LLUUID & cat_id) const
@@ -653,6 +693,7 @@ void BGFolderHttpHandler::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRes
 void BGFolderHttpHandler::processData(LLSD & content, LLCore::HttpResponse * response)
 {
 	LLInventoryModelBackgroundFetch * fetcher(LLInventoryModelBackgroundFetch::getInstance());
+	fetcher->recordFolderFetch(true, mRequestTimer.getElapsedTimeF32());
 
 	// API V2 and earlier should probably be testing for "error" map
 	// in response as an application-level error.
@@ -708,7 +749,6 @@ void BGFolderHttpHandler::processData(LLSD & content, LLCore::HttpResponse * res
                         titem->setParent(lost_uuid);
                         titem->updateParentOnServer(FALSE);
                         gInventory.updateItem(titem);
-                        gInventory.notifyObservers();
                     }
                 }
             }
@@ -782,7 +822,7 @@ void BGFolderHttpHandler::processData(LLSD & content, LLCore::HttpResponse * res
 		fetcher->setAllFoldersFetched();
 	}
 	
-	gInventory.notifyObservers();
+	fetcher->setObserversNeedNotify();
 }
 
 
@@ -805,6 +845,7 @@ void BGFolderHttpHandler::processFailure(LLCore::HttpStatus status, LLCore::Http
 	// adquately on retries but I want to keep the structure of a
 	// retry for reference.
 	LLInventoryModelBackgroundFetch *fetcher = LLInventoryModelBackgroundFetch::getInstance();
+	fetcher->recordFolderFetch(false, mRequestTimer.getElapsedTimeF32());
 	if (false)
 	{
 		// timed out or curl failure
@@ -825,7 +866,7 @@ void BGFolderHttpHandler::processFailure(LLCore::HttpStatus status, LLCore::Http
 			fetcher->setAllFoldersFetched();
 		}
 	}
-	gInventory.notifyObservers();
+	fetcher->setObserversNeedNotify();
 }
 
 
@@ -844,6 +885,7 @@ void BGFolderHttpHandler::processFailure(const char * const reason, LLCore::Http
 	// Philosophy is that inventory folders are so essential to
 	// operation that this is a reasonable action.
 	LLInventoryModelBackgroundFetch *fetcher = LLInventoryModelBackgroundFetch::getInstance();
+	fetcher->recordFolderFetch(false, mRequestTimer.getElapsedTimeF32());
 	if (true)
 	{
 		for (LLSD::array_const_iterator folder_it = mRequestSD["folders"].beginArray();
@@ -863,7 +905,7 @@ void BGFolderHttpHandler::processFailure(const char * const reason, LLCore::Http
 			fetcher->setAllFoldersFetched();
 		}
 	}
-	gInventory.notifyObservers();
+	fetcher->setObserversNeedNotify();
 }
 
 
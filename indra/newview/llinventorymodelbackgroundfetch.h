@@ -35,6 +35,8 @@
 #include "httpheaders.h"
 #include "httphandler.h"
 
+class LLViewerRegion;
+
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // Class LLInventoryModelBackgroundFetch
 //
@@ -68,11 +70,17 @@ public:
 	bool isBulkFetchProcessingComplete() const;
 	void setAllFoldersFetched();
 
+	// Called by folder fetch handlers as responses arrive.  Observers are
+	// notified once per batch of responses rather than once per response.
+	void recordFolderFetch(bool success, F32 latency);
+	void setObserversNeedNotify() { mObserversNeedNotify = true; }
+
 	void addRequestAtFront(const LLUUID & id, BOOL recursive, bool is_category);
 	void addRequestAtBack(const LLUUID & id, BOOL recursive, bool is_category);
 
 protected:
 	void bulkFetch();
+	U32 sendFetchBatch(LLViewerRegion* region);
 
 	void backgroundFetch();
 	static void backgroundFetchCB(void*); // background fetch idle function
@@ -90,6 +98,8 @@ private:
 
 	LLFrameTimer mFetchTimer;
 	F32 mMinTimeBetweenFetches;
+	U32 mBatchSize;
+	bool mObserversNeedNotify;
 
 	struct FetchQueueInfo
 	{
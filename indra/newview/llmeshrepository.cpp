@@ -50,16 +50,20 @@
 #include "llsdserialize.h"
 #include "llthread.h"
 #include "llvfile.h"
+#include "llviewercamera.h"
 #include "llviewercontrol.h"
 #include "llviewerinventory.h"
 #include "llviewermenufile.h"
 #include "llviewermessage.h"
 #include "llviewerobjectlist.h"
 #include "llviewerregion.h"
+#include "llviewerstats.h"
 #include "llviewertexturelist.h"
+#include "llvocache.h"
 #include "llvolume.h"
 #include "llvolumemgr.h"
 #include "llvovolume.h"
+#include "llworkpool.h"
 #include "llworld.h"
 #include "material_codes.h"
 #include "pipeline.h"
@@ -77,6 +81,7 @@
 #include "lluploaddialog.h"
 #include "llfloaterreg.h"
 
+#include "boost/bind.hpp"
 #include "boost/lexical_cast.hpp"
 
 #ifndef LL_WINDOWS
@@ -149,8 +154,12 @@
 //                             onCompleted() invoked for GET
 //                               data copied
 //                               lodReceived() invoked
-//                                 unpack data into LLVolume
-//                                 append LoadedMesh to mLoadedQ
+//                                 append DecodeRequest to mDecodeQ
+//                             ...
+//                             decodeBlocks() invoked
+//                               unpack data into LLVolume on decode pool
+//                               append LoadedMesh to mLoadedQ
+//                               write data to VFS
 //                             ...
 //         notifyLoadedMeshes() invoked again
 //           scan mLoadedQ
@@ -245,6 +254,8 @@
 //     sActiveHeaderRequests    mMutex        rw.any.mMutex, ro.repo.none [1]
 //     sActiveLODRequests       mMutex        rw.any.mMutex, ro.repo.none [1]
 //     sMaxConcurrentRequests   mMutex        wo.main.none, ro.repo.none, ro.main.mMutex
+//     sBVHPrebuildTriangles    none          wo.main.none, ro.repo.none
+//     sDecodeThreads           none          wo.main.none, ro.repo.none
 //     mMeshHeader              mHeaderMutex  rw.repo.mHeaderMutex, ro.main.mHeaderMutex, ro.main.none [0]
 //     mMeshHeaderSize          mHeaderMutex  rw.repo.mHeaderMutex
 //     mSkinRequests            mMutex        rw.repo.mMutex, ro.repo.none [5]
@@ -256,6 +267,8 @@
 //     mLODReqQ                 mMutex        ro.repo.none [5], rw.repo.mMutex, rw.any.mMutex
 //     mUnavailableQ            mMutex        rw.repo.none [0], ro.main.none [5], rw.main.mMutex
 //     mLoadedQ                 mMutex        rw.repo.mMutex, ro.main.none [5], rw.main.mMutex
+//     mDecodeQ                 none          rw.repo.none
+//     mDecodePool              none          rw.repo.none
 //     mPendingLOD              mMutex        rw.repo.mMutex, rw.any.mMutex
 //     mGetMeshCapability       mMutex        rw.main.mMutex, ro.repo.mMutex (was:  [0])
 //     mGetMesh2Capability      mMutex        rw.main.mMutex, ro.repo.mMutex (was:  [0])
@@ -316,6 +329,8 @@
 // or under 'Render' time.
 
 static LLFastTimer::DeclareTimer FTM_MESH_FETCH("Mesh Fetch");
+static LLFastTimer::DeclareTimer FTM_MESH_PREFETCH("Mesh Prefetch");
+static LLFastTimer::DeclareTimer FTM_MESH_DECODE("Mesh Decode");
 
 // Random failure testing for development/QA.
 //
@@ -356,6 +371,8 @@ const S32 REQUEST2_LOW_WATER_MAX = 50;
 const U32 LARGE_MESH_FETCH_THRESHOLD = 1U << 21;		// Size at which requests goes to narrow/slow queue
 const long SMALL_MESH_XFER_TIMEOUT = 120L;				// Seconds to complete xfer, small mesh downloads
 const long LARGE_MESH_XFER_TIMEOUT = 600L;				// Seconds to complete xfer, large downloads
+const F32 MESH_PREFETCH_INTERVAL = 0.5f;				// Seconds between looks for meshes to prefetch
+const U32 MESH_DECODE_BATCH_MAX = 64;					// Cached LODs read per pass of the repo thread
 
 // Would normally like to retry on uploads as some
 // retryable failures would be recoverable.  Unfortunately,
@@ -389,6 +406,9 @@ U32 LLMeshRepository::sCacheBytesWritten = 0;
 U32 LLMeshRepository::sCacheReads = 0;
 U32 LLMeshRepository::sCacheWrites = 0;
 U32 LLMeshRepository::sMaxLockHoldoffs = 0;
+U32 LLMeshRepository::sPrefetchCount = 0;
+U32 LLMeshRepository::sPrefetchHits = 0;
+U32 LLMeshRepository::sPrefetchWasted = 0;
 	
 LLDeadmanTimer LLMeshRepository::sQuiescentTimer(15.0, false);	// true -> gather cpu metrics
 
@@ -529,6 +549,8 @@ LLViewerFetchedTexture* LLMeshUploadThread::FindViewerTexture(const LLImportMate
 volatile S32 LLMeshRepoThread::sActiveHeaderRequests = 0;
 volatile S32 LLMeshRepoThread::sActiveLODRequests = 0;
 U32	LLMeshRepoThread::sMaxConcurrentRequests = 1;
+U32 LLMeshRepoThread::sBVHPrebuildTriangles = 0;
+U32 LLMeshRepoThread::sDecodeThreads = 0;
 S32 LLMeshRepoThread::sRequestLowWater = REQUEST2_LOW_WATER_MIN;
 S32 LLMeshRepoThread::sRequestHighWater = REQUEST2_HIGH_WATER_MIN;
 S32 LLMeshRepoThread::sRequestWaterLevel = 0;
@@ -562,6 +584,7 @@ public:
 		: LLCore::HttpHandler(),
 		  mMeshParams(),
 		  mProcessed(false),
+		  mPrefetch(false),
 		  mHttpHandle(LLCORE_HTTP_HANDLE_INVALID),
 		  mOffset(offset),
 		  mRequestedBytes(requested_bytes)
@@ -582,6 +605,7 @@ public:
 public:
 	LLVolumeParams mMeshParams;
 	bool mProcessed;
+	bool mPrefetch;			// Nothing waits on the data, so it is neither decoded nor retried
 	LLCore::HttpHandle mHttpHandle;
 	U32 mOffset;
 	U32 mRequestedBytes;
@@ -810,8 +834,10 @@ LLMeshRepoThread::LLMeshRepoThread()
   mHttpPolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID),
   mHttpLegacyPolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID),
   mHttpLargePolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID),
+  mHttpPrefetchPolicyClass(LLCore::HttpRequest::DEFAULT_POLICY_ID),
   mHttpPriority(0),
-  mGetMeshVersion(2)
+  mGetMeshVersion(2),
+  mDecodePool(NULL)
 {
 	LLAppCoreHttp & app_core_http(LLAppViewer::instance()->getAppCoreHttp());
 
@@ -830,6 +856,7 @@ LLMeshRepoThread::LLMeshRepoThread()
 	mHttpPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_MESH2);
 	mHttpLegacyPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_MESH1);
 	mHttpLargePolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_LARGE_MESH);
+	mHttpPrefetchPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_MESH_PREFETCH);
 }
 
 
@@ -843,6 +870,10 @@ LLMeshRepoThread::~LLMeshRepoThread()
 	mHttpRequestSet.clear();
     mHttpHeaders.reset();
 
+	mDecodeQ.clear();
+	delete mDecodePool;
+	mDecodePool = NULL;
+
     delete mHttpRequest;
 	mHttpRequest = NULL;
 	delete mMutex;
@@ -892,7 +923,10 @@ void LLMeshRepoThread::run()
 			
 		// NOTE: order of queue processing intentionally favors LOD requests over header requests
 
-		while (!mLODReqQ.empty() && mHttpRequestSet.size() < sRequestHighWater)
+		// Cached LODs are only read here and decoded with the rest of the
+		// pass's blocks, so stop once the batch is big enough
+		while (!mLODReqQ.empty() && mHttpRequestSet.size() < sRequestHighWater
+			   && mDecodeQ.size() < MESH_DECODE_BATCH_MAX)
 		{
 			if (! mMutex)
 			{
@@ -931,6 +965,31 @@ void LLMeshRepoThread::run()
 			}
 		}
 
+		// Prefetches only go out once the queues above are drained and
+		// while under the low water mark so they never hold up a mesh
+		// something is waiting on.  A failed prefetch is dropped.
+		while (!mPrefetchReqQ.empty() && mLODReqQ.empty() && mHeaderReqQ.empty()
+			   && mHttpRequestSet.size() < sRequestLowWater)
+		{
+			if (! mMutex)
+			{
+				break;
+			}
+			mMutex->lock();
+			LODRequest req = mPrefetchReqQ.front();
+			mPrefetchReqQ.pop();
+			mMutex->unlock();
+
+			if (req.mLOD < 0)
+			{
+				fetchMeshHeader(req.mMeshParams, true);
+			}
+			else
+			{
+				fetchMeshLOD(req.mMeshParams, req.mLOD, true);
+			}
+		}
+
 		// For the final three request lists, similar goal to above but
 		// slightly different queue structures.  Stay off the mutex when
 		// performing long-duration actions.
@@ -1027,6 +1086,8 @@ void LLMeshRepoThread::run()
 			mMutex->unlock();
 		}
 
+		decodeBlocks();
+
 		// For dev purposes only.  A dynamic change could make this false
 		// and that shouldn't assert.
 		// llassert_always(mHttpRequestSet.size() <= sRequestHighWater);
@@ -1102,6 +1163,12 @@ void LLMeshRepoThread::loadMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
 	}
 }
 
+void LLMeshRepoThread::prefetchMesh(const LLVolumeParams& mesh_params, S32 lod)
+{
+	LLMutexLock lock(mMutex);
+	mPrefetchReqQ.push(LODRequest(mesh_params, lod));
+}
+
 // Mutex:  must be holding mMutex when called
 void LLMeshRepoThread::setGetMeshCaps(const std::string & get_mesh1,
 									  const std::string & get_mesh2,
@@ -1158,7 +1225,10 @@ void LLMeshRepoThread::constructUrl(LLUUID mesh_id, std::string * url, int * ver
 }
 
 // Issue an HTTP GET request with byte range using the right
-// policy class.  Large requests go to the large request class.
+// policy class.  Prefetches, of any size, go to the prefetch
+// class:  the ready queue ignores priority, so in the demand
+// classes they would be served ahead of meshes requested after
+// them.  Large requests go to the large request class.
 // If the current region supports GetMesh2, we prefer that for
 // smaller requests otherwise we try to use the traditional
 // GetMesh capability and connection concurrency.
@@ -1171,19 +1241,34 @@ void LLMeshRepoThread::constructUrl(LLUUID mesh_id, std::string * url, int * ver
 // Thread:  repo
 LLCore::HttpHandle LLMeshRepoThread::getByteRange(const std::string & url, int cap_version,
 												  size_t offset, size_t len,
-												  const LLCore::HttpHandler::ptr_t &handler)
+												  LLCore::HttpRequest::priority_t priority,
+												  const LLCore::HttpHandler::ptr_t &handler,
+												  bool prefetch)
 {
 	// Also used in lltexturefetch.cpp
 	static LLCachedControl<bool> disable_range_req(gSavedSettings, "HttpRangeRequestsDisable", false);
 	
 	LLCore::HttpHandle handle(LLCORE_HTTP_HANDLE_INVALID);
 	
-	if (len < LARGE_MESH_FETCH_THRESHOLD)
+	if (prefetch)
+	{
+		handle = mHttpRequest->requestGetByteRange(mHttpPrefetchPolicyClass,
+												   priority,
+												   url,
+												   (disable_range_req ? size_t(0) : offset),
+												   (disable_range_req ? size_t(0) : len),
+												   (len < LARGE_MESH_FETCH_THRESHOLD
+													? mHttpOptions
+													: mHttpLargeOptions),
+												   mHttpHeaders,
+												   handler);
+	}
+	else if (len < LARGE_MESH_FETCH_THRESHOLD)
 	{
 		handle = mHttpRequest->requestGetByteRange((2 == cap_version
 													? mHttpPolicyClass
 													: mHttpLegacyPolicyClass),
-												   mHttpPriority,
+												   priority,
 												   url,
 												   (disable_range_req ? size_t(0) : offset),
 												   (disable_range_req ? size_t(0) : len),
@@ -1198,7 +1283,7 @@ LLCore::HttpHandle LLMeshRepoThread::getByteRange(const std::string & url, int c
 	else
 	{
 		handle = mHttpRequest->requestGetByteRange(mHttpLargePolicyClass,
-												   mHttpPriority,
+												   priority,
 												   url,
 												   (disable_range_req ? size_t(0) : offset),
 												   (disable_range_req ? size_t(0) : len),
@@ -1219,7 +1304,7 @@ LLCore::HttpHandle LLMeshRepoThread::getByteRange(const std::string & url, int c
 }
 
 
-bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
+bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id, bool use_cache)
 {
 	
 	if (!mHeaderMutex)
@@ -1251,7 +1336,7 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
 		{
 			//check VFS for mesh skin info
 			LLVFile file(gVFS, mesh_id, LLAssetType::AT_MESH);
-			if (file.getSize() >= offset+size)
+			if (use_cache && file.getSize() >= offset+size)
 			{				
 				LLMeshRepository::sCacheBytesRead += size;
 				++LLMeshRepository::sCacheReads;
@@ -1267,12 +1352,10 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
 				}
 
 				if (!zero)
-				{ //attempt to parse
-					if (skinInfoReceived(mesh_id, buffer, size))
-					{						
-						delete[] buffer;
-						return true;
-					}
+				{ //queue to parse, a block that does not is fetched again
+					skinInfoReceived(mesh_id, buffer, size);
+					delete[] buffer;
+					return true;
 				}
 
 				delete[] buffer;
@@ -1286,7 +1369,7 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
 			if (!http_url.empty())
 			{
                 LLMeshHandlerBase::ptr_t handler(new LLMeshSkinInfoHandler(mesh_id, offset, size));
-				LLCore::HttpHandle handle = getByteRange(http_url, cap_version, offset, size, handler);
+				LLCore::HttpHandle handle = getByteRange(http_url, cap_version, offset, size, mHttpPriority, handler);
 				if (LLCORE_HTTP_HANDLE_INVALID == handle)
 				{
 					LL_WARNS(LOG_MESH) << "HTTP GET request failed for skin info on mesh " << mID
@@ -1312,7 +1395,7 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
 	return ret;
 }
 
-bool LLMeshRepoThread::fetchMeshDecomposition(const LLUUID& mesh_id)
+bool LLMeshRepoThread::fetchMeshDecomposition(const LLUUID& mesh_id, bool use_cache)
 {
 	if (!mHeaderMutex)
 	{
@@ -1343,7 +1426,7 @@ bool LLMeshRepoThread::fetchMeshDecomposition(const LLUUID& mesh_id)
 		{
 			//check VFS for mesh skin info
 			LLVFile file(gVFS, mesh_id, LLAssetType::AT_MESH);
-			if (file.getSize() >= offset+size)
+			if (use_cache && file.getSize() >= offset+size)
 			{
 				LLMeshRepository::sCacheBytesRead += size;
 				++LLMeshRepository::sCacheReads;
@@ -1360,12 +1443,10 @@ bool LLMeshRepoThread::fetchMeshDecomposition(const LLUUID& mesh_id)
 				}
 
 				if (!zero)
-				{ //attempt to parse
-					if (decompositionReceived(mesh_id, buffer, size))
-					{
-						delete[] buffer;
-						return true;
-					}
+				{ //queue to parse, a block that does not is fetched again
+					decompositionReceived(mesh_id, buffer, size);
+					delete[] buffer;
+					return true;
 				}
 
 				delete[] buffer;
@@ -1379,7 +1460,7 @@ bool LLMeshRepoThread::fetchMeshDecomposition(const LLUUID& mesh_id)
 			if (!http_url.empty())
 			{
                 LLMeshHandlerBase::ptr_t handler(new LLMeshDecompositionHandler(mesh_id, offset, size));
-				LLCore::HttpHandle handle = getByteRange(http_url, cap_version, offset, size, handler);
+				LLCore::HttpHandle handle = getByteRange(http_url, cap_version, offset, size, mHttpPriority, handler);
 				if (LLCORE_HTTP_HANDLE_INVALID == handle)
 				{
 					LL_WARNS(LOG_MESH) << "HTTP GET request failed for decomposition mesh " << mID
@@ -1471,7 +1552,7 @@ bool LLMeshRepoThread::fetchMeshPhysicsShape(const LLUUID& mesh_id)
 			if (!http_url.empty())
 			{
                 LLMeshHandlerBase::ptr_t handler(new LLMeshPhysicsShapeHandler(mesh_id, offset, size));
-				LLCore::HttpHandle handle = getByteRange(http_url, cap_version, offset, size, handler);
+				LLCore::HttpHandle handle = getByteRange(http_url, cap_version, offset, size, mHttpPriority, handler);
 				if (LLCORE_HTTP_HANDLE_INVALID == handle)
 				{
 					LL_WARNS(LOG_MESH) << "HTTP GET request failed for physics shape on mesh " << mID
@@ -1530,7 +1611,7 @@ void LLMeshRepoThread::decActiveHeaderRequests()
 }
 
 //return false if failed to get header
-bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params)
+bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params, bool prefetch)
 {
 	++LLMeshRepository::sMeshRequestCount;
 
@@ -1569,7 +1650,9 @@ bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params)
 		//NOTE -- this will break of headers ever exceed 4KB		
 
         LLMeshHandlerBase::ptr_t handler(new LLMeshHeaderHandler(mesh_params, 0, MESH_HEADER_SIZE));
-		LLCore::HttpHandle handle = getByteRange(http_url, cap_version, 0, MESH_HEADER_SIZE, handler);
+		handler->mPrefetch = prefetch;
+		LLCore::HttpHandle handle = getByteRange(http_url, cap_version, 0, MESH_HEADER_SIZE,
+												 mHttpPriority, handler, prefetch);
 		if (LLCORE_HTTP_HANDLE_INVALID == handle)
 		{
 			LL_WARNS(LOG_MESH) << "HTTP GET request failed for mesh header " << mID
@@ -1589,7 +1672,7 @@ bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params)
 }
 
 //return false if failed to get mesh lod.
-bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
+bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod, bool prefetch, bool use_cache)
 {
 	if (!mHeaderMutex)
 	{
@@ -1617,7 +1700,7 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
 
 			//check VFS for mesh asset
 			LLVFile file(gVFS, mesh_id, LLAssetType::AT_MESH);
-			if (file.getSize() >= offset+size)
+			if (use_cache && file.getSize() >= offset+size)
 			{
 				LLMeshRepository::sCacheBytesRead += size;
 				++LLMeshRepository::sCacheReads;
@@ -1632,13 +1715,17 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
 					zero = buffer[i] > 0 ? false : true;
 				}
 
+				if (!zero && prefetch)
+				{ //already cached, nothing to do
+					delete[] buffer;
+					return true;
+				}
+
 				if (!zero)
-				{ //attempt to parse
-					if (lodReceived(mesh_params, lod, buffer, size))
-					{
-						delete[] buffer;
-						return true;
-					}
+				{ //queue to parse, a block that does not is fetched again
+					lodReceived(mesh_params, lod, buffer, size);
+					delete[] buffer;
+					return true;
 				}
 
 				delete[] buffer;
@@ -1652,7 +1739,9 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
 			if (!http_url.empty())
 			{
                 LLMeshHandlerBase::ptr_t handler(new LLMeshLODHandler(mesh_params, lod, offset, size));
-				LLCore::HttpHandle handle = getByteRange(http_url, cap_version, offset, size, handler);
+				handler->mPrefetch = prefetch;
+				LLCore::HttpHandle handle = getByteRange(http_url, cap_version, offset, size,
+														 mHttpPriority, handler, prefetch);
 				if (LLCORE_HTTP_HANDLE_INVALID == handle)
 				{
 					LL_WARNS(LOG_MESH) << "HTTP GET request failed for LOD on mesh " << mID
@@ -1668,12 +1757,12 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
 					// *NOTE:  Allowing a re-request, not marking as unavailable.  Is that correct?
 				}
 			}
-			else
+			else if (!prefetch)
 			{
 				mUnavailableQ.push(LODRequest(mesh_params, lod));
 			}
 		}
-		else
+		else if (!prefetch)
 		{
 			mUnavailableQ.push(LODRequest(mesh_params, lod));
 		}
@@ -1751,88 +1840,201 @@ bool LLMeshRepoThread::headerReceived(const LLVolumeParams& mesh_params, U8* dat
 	return true;
 }
 
-bool LLMeshRepoThread::lodReceived(const LLVolumeParams& mesh_params, S32 lod, U8* data, S32 data_size)
+void LLMeshRepoThread::lodReceived(const LLVolumeParams& mesh_params, S32 lod, U8* data, S32 data_size,
+									S32 cache_offset, S32 cache_size)
 {
-	LLPointer<LLVolume> volume = new LLVolume(mesh_params, LLVolumeLODGroup::getVolumeScaleFromDetail(lod));
-	std::string mesh_string((char*) data, data_size);
-	std::istringstream stream(mesh_string);
-
-	if (volume->unpackVolumeFaces(stream, data_size))
-	{
-		if (volume->getNumFaces() > 0)
-		{
-			LoadedMesh mesh(volume, mesh_params, lod);
-			{
-				LLMutexLock lock(mMutex);
-				mLoadedQ.push(mesh);
-			}
-			return true;
-		}
-	}
+	DecodeRequest req(DecodeRequest::LOD, mesh_params, lod, data, data_size, cache_offset, cache_size);
+	req.mVolume = new LLVolume(mesh_params, LLVolumeLODGroup::getVolumeScaleFromDetail(lod));
+	mDecodeQ.push_back(req);
+}
 
-	return false;
+void LLMeshRepoThread::skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size,
+										 S32 cache_offset, S32 cache_size)
+{
+	LLVolumeParams mesh_params;
+	mesh_params.setSculptID(mesh_id, LL_SCULPT_TYPE_MESH);
+	mDecodeQ.push_back(DecodeRequest(DecodeRequest::SKIN_INFO, mesh_params, 0, data, data_size, cache_offset, cache_size));
 }
 
-bool LLMeshRepoThread::skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size)
+void LLMeshRepoThread::decompositionReceived(const LLUUID& mesh_id, U8* data, S32 data_size,
+											  S32 cache_offset, S32 cache_size)
 {
-	LLSD skin;
+	LLVolumeParams mesh_params;
+	mesh_params.setSculptID(mesh_id, LL_SCULPT_TYPE_MESH);
+	mDecodeQ.push_back(DecodeRequest(DecodeRequest::DECOMPOSITION, mesh_params, 0, data, data_size, cache_offset, cache_size));
+}
 
-	if (data_size > 0)
+void LLMeshRepoThread::decodeBlocks()
+{
+	if (mDecodeQ.empty())
 	{
-		std::string res_str((char*) data, data_size);
+		return;
+	}
 
-		std::istringstream stream(res_str);
+	LL_RECORD_BLOCK_TIME(FTM_MESH_DECODE);
 
-		if (!unzip_llsd(skin, stream, data_size))
-		{
-			LL_WARNS(LOG_MESH) << "Mesh skin info parse error.  Not a valid mesh asset!  ID:  " << mesh_id
-							   << LL_ENDL;
-			return false;
-		}
+	const U32 threads = llmin(sDecodeThreads, (U32) 8);
+	if (mDecodePool && mDecodePool->getThreadCount() != threads)
+	{
+		delete mDecodePool;
+		mDecodePool = NULL;
 	}
-	
+	if (!mDecodePool && threads > 0)
 	{
-		LLMeshSkinInfo info(skin);
-		info.mMeshID = mesh_id;
+		mDecodePool = new LLWorkPool("Mesh decode", threads);
+	}
 
-		// LL_DEBUGS(LOG_MESH) << "info pelvis offset" << info.mPelvisOffset << LL_ENDL;
+	if (mDecodePool && mDecodeQ.size() > 1)
+	{
+		mDecodePool->run(mDecodeQ.size(), boost::bind(&LLMeshRepoThread::decodeBlock, this, _1));
+	}
+	else
+	{
+		for (U32 i = 0; i < mDecodeQ.size(); ++i)
 		{
-			LLMutexLock lock(mMutex);
-			mSkinInfoQ.push_back(info);
+			decodeBlock(i);
 		}
 	}
 
-	return true;
-}
-
-bool LLMeshRepoThread::decompositionReceived(const LLUUID& mesh_id, U8* data, S32 data_size)
-{
-	LLSD decomp;
+	for (U32 i = 0; i < mDecodeQ.size(); ++i)
+	{
+		DecodeRequest& req = mDecodeQ[i];
+		const LLUUID mesh_id = req.mMeshParams.getSculptID();
 
-	if (data_size > 0)
-	{ 
-		std::string res_str((char*) data, data_size);
+		if (req.mDecoded)
+		{
+			if (req.mCacheOffset >= 0)
+			{
+				// good fetch from sim, write to VFS for caching
+				LLVFile file(gVFS, mesh_id, LLAssetType::AT_MESH, LLVFile::WRITE);
 
-		std::istringstream stream(res_str);
+				S32 size = llmin(req.mCacheSize, (S32) req.mData.size());
 
-		if (!unzip_llsd(decomp, stream, data_size))
+				if (file.getSize() >= req.mCacheOffset+size)
+				{
+					file.seek(req.mCacheOffset);
+					file.write((const U8*) req.mData.data(), size);
+					LLMeshRepository::sCacheBytesWritten += size;
+					++LLMeshRepository::sCacheWrites;
+				}
+			}
+		}
+		else if (req.mCacheOffset < 0)
 		{
-			LL_WARNS(LOG_MESH) << "Mesh decomposition parse error.  Not a valid mesh asset!  ID:  " << mesh_id
+			//reading from VFS failed for whatever reason, fetch from sim
+			if (req.mType == DecodeRequest::LOD)
+			{
+				if (!fetchMeshLOD(req.mMeshParams, req.mLOD, false, false))
+				{
+					LLMutexLock lock(mMutex);
+					mLODReqQ.push(LODRequest(req.mMeshParams, req.mLOD));
+					++LLMeshRepository::sLODProcessing;
+				}
+			}
+			else if (req.mType == DecodeRequest::SKIN_INFO)
+			{
+				if (!fetchMeshSkinInfo(mesh_id, false))
+				{
+					LLMutexLock lock(mMutex);
+					mSkinRequests.insert(mesh_id);
+				}
+			}
+			else if (!fetchMeshDecomposition(mesh_id, false))
+			{
+				LLMutexLock lock(mMutex);
+				mDecompositionRequests.insert(mesh_id);
+			}
+		}
+		else if (req.mType == DecodeRequest::LOD)
+		{
+			LL_WARNS(LOG_MESH) << "Error during mesh LOD processing.  ID:  " << mesh_id
+							   << ", Unknown reason.  Not retrying."
 							   << LL_ENDL;
-			return false;
+			LLMutexLock lock(mMutex);
+			mUnavailableQ.push(LODRequest(req.mMeshParams, req.mLOD));
+		}
+		else if (req.mType == DecodeRequest::SKIN_INFO)
+		{
+			LL_WARNS(LOG_MESH) << "Error during mesh skin info processing.  ID:  " << mesh_id
+							   << ", Unknown reason.  Not retrying."
+							   << LL_ENDL;
+			// *TODO:  Mark mesh unavailable on error
+		}
+		else
+		{
+			LL_WARNS(LOG_MESH) << "Error during mesh decomposition processing.  ID:  " << mesh_id
+							   << ", Unknown reason.  Not retrying."
+							   << LL_ENDL;
+			// *TODO:  Mark mesh unavailable on error
 		}
 	}
-	
+
+	mDecodeQ.clear();
+}
+
+void LLMeshRepoThread::decodeBlock(U32 index)
+{
+	DecodeRequest& req = mDecodeQ[index];
+	const LLUUID mesh_id = req.mMeshParams.getSculptID();
+	const S32 data_size = req.mData.size();
+	std::istringstream stream(req.mData);
+
+	if (req.mType == DecodeRequest::LOD)
 	{
-		LLModel::Decomposition* d = new LLModel::Decomposition(decomp);
-		d->mMeshID = mesh_id;
+		LLVolume* volume = req.mVolume;
+		if (volume->unpackVolumeFaces(stream, data_size) && volume->getNumFaces() > 0)
 		{
+			// Build picking trees for big faces here rather than on the
+			// main thread the first time one is picked
+			const U32 prebuild_triangles(sBVHPrebuildTriangles);
+			if (prebuild_triangles)
+			{
+				for (S32 i = 0; i < volume->getNumVolumeFaces(); ++i)
+				{
+					LLVolumeFace& face = volume->getVolumeFace(i);
+					if (U32(face.mNumIndices / 3) >= prebuild_triangles)
+					{
+						face.createBVH();
+					}
+				}
+			}
+
+			// the main thread may have the volume as soon as it is queued,
+			// so let go of it before unlocking
 			LLMutexLock lock(mMutex);
-			mDecompositionQ.push_back(d);
+			mLoadedQ.push(LoadedMesh(volume, req.mMeshParams, req.mLOD));
+			req.mVolume = NULL;
+			req.mDecoded = true;
 		}
+		return;
 	}
 
-	return true;
+	LLSD sd;
+	if (data_size > 0 && !unzip_llsd(sd, stream, data_size))
+	{
+		LL_WARNS(LOG_MESH) << "Mesh " << (req.mType == DecodeRequest::SKIN_INFO ? "skin info" : "decomposition")
+						   << " parse error.  Not a valid mesh asset!  ID:  " << mesh_id
+						   << LL_ENDL;
+		return;
+	}
+
+	if (req.mType == DecodeRequest::SKIN_INFO)
+	{
+		LLMeshSkinInfo info(sd);
+		info.mMeshID = mesh_id;
+
+		LLMutexLock lock(mMutex);
+		mSkinInfoQ.push_back(info);
+	}
+	else
+	{
+		LLModel::Decomposition* d = new LLModel::Decomposition(sd);
+		d->mMeshID = mesh_id;
+
+		LLMutexLock lock(mMutex);
+		mDecompositionQ.push_back(d);
+	}
+	req.mDecoded = true;
 }
 
 bool LLMeshRepoThread::physicsShapeReceived(const LLUUID& mesh_id, U8* data, S32 data_size)
@@ -2961,7 +3163,7 @@ LLMeshHeaderHandler::~LLMeshHeaderHandler()
 {
 	if (!LLApp::isQuitting())
 	{
-		if (! mProcessed)
+		if (! mProcessed && ! mPrefetch)
 		{
 			// something went wrong, retry
 			LL_WARNS(LOG_MESH) << "Mesh header fetch canceled unexpectedly, retrying." << LL_ENDL;
@@ -2980,6 +3182,11 @@ void LLMeshHeaderHandler::processFailure(LLCore::HttpStatus status)
 					   << " (" << status.toTerseString() << ").  Not retrying."
 					   << LL_ENDL;
 
+	if (mPrefetch)
+	{
+		return;
+	}
+
 	// Can't get the header so none of the LODs will be available
 	LLMutexLock lock(gMeshRepo.mThread->mMutex);
 	for (int i(0); i < 4; ++i)
@@ -3001,11 +3208,14 @@ void LLMeshHeaderHandler::processData(LLCore::BufferArray * /* body */, S32 /* b
 						   << ", Unknown reason.  Not retrying."
 						   << LL_ENDL;
 
-		// Can't get the header so none of the LODs will be available
-		LLMutexLock lock(gMeshRepo.mThread->mMutex);
-		for (int i(0); i < 4; ++i)
+		if (! mPrefetch)
 		{
-			gMeshRepo.mThread->mUnavailableQ.push(LLMeshRepoThread::LODRequest(mMeshParams, i));
+			// Can't get the header so none of the LODs will be available
+			LLMutexLock lock(gMeshRepo.mThread->mMutex);
+			for (int i(0); i < 4; ++i)
+			{
+				gMeshRepo.mThread->mUnavailableQ.push(LLMeshRepoThread::LODRequest(mMeshParams, i));
+			}
 		}
 	}
 	else if (data && data_size > 0)
@@ -3071,7 +3281,7 @@ LLMeshLODHandler::~LLMeshLODHandler()
 {
 	if (! LLApp::isQuitting())
 	{
-		if (! mProcessed)
+		if (! mProcessed && ! mPrefetch)
 		{
 			LL_WARNS(LOG_MESH) << "Mesh LOD fetch canceled unexpectedly, retrying." << LL_ENDL;
 			gMeshRepo.mThread->lockAndLoadMeshLOD(mMeshParams, mLOD);
@@ -3087,16 +3297,32 @@ void LLMeshLODHandler::processFailure(LLCore::HttpStatus status)
 					   << " (" << status.toTerseString() << ").  Not retrying."
 					   << LL_ENDL;
 
-	LLMutexLock lock(gMeshRepo.mThread->mMutex);
-	gMeshRepo.mThread->mUnavailableQ.push(LLMeshRepoThread::LODRequest(mMeshParams, mLOD));
+	if (! mPrefetch)
+	{
+		LLMutexLock lock(gMeshRepo.mThread->mMutex);
+		gMeshRepo.mThread->mUnavailableQ.push(LLMeshRepoThread::LODRequest(mMeshParams, mLOD));
+	}
 }
 
 void LLMeshLODHandler::processData(LLCore::BufferArray * /* body */, S32 /* body_offset */,
 								   U8 * data, S32 data_size)
 {
-	if ((! MESH_LOD_PROCESS_FAILED) && gMeshRepo.mThread->lodReceived(mMeshParams, mLOD, data, data_size))
+	if (MESH_LOD_PROCESS_FAILED)
 	{
-		// good fetch from sim, write to VFS for caching
+		LL_WARNS(LOG_MESH) << "Error during mesh LOD processing.  ID:  " << mMeshParams.getSculptID()
+						   << ", Unknown reason.  Not retrying."
+						   << LL_ENDL;
+		LLMutexLock lock(gMeshRepo.mThread->mMutex);
+		gMeshRepo.mThread->mUnavailableQ.push(LLMeshRepoThread::LODRequest(mMeshParams, mLOD));
+	}
+	else if (! mPrefetch)
+	{
+		// decoded with the rest of the repo thread's pass, and cached if it decodes
+		gMeshRepo.mThread->lodReceived(mMeshParams, mLOD, data, data_size, mOffset, mRequestedBytes);
+	}
+	else
+	{
+		// Prefetched data is only cached, it is decoded once an object asks for it
 		LLVFile file(gVFS, mMeshParams.getSculptID(), LLAssetType::AT_MESH, LLVFile::WRITE);
 
 		S32 offset = mOffset;
@@ -3110,14 +3336,6 @@ void LLMeshLODHandler::processData(LLCore::BufferArray * /* body */, S32 /* body
 			++LLMeshRepository::sCacheWrites;
 		}
 	}
-	else
-	{
-		LL_WARNS(LOG_MESH) << "Error during mesh LOD processing.  ID:  " << mMeshParams.getSculptID()
-						   << ", Unknown reason.  Not retrying."
-						   << LL_ENDL;
-		LLMutexLock lock(gMeshRepo.mThread->mMutex);
-		gMeshRepo.mThread->mUnavailableQ.push(LLMeshRepoThread::LODRequest(mMeshParams, mLOD));
-	}
 }
 
 LLMeshSkinInfoHandler::~LLMeshSkinInfoHandler()
@@ -3142,21 +3360,10 @@ void LLMeshSkinInfoHandler::processFailure(LLCore::HttpStatus status)
 void LLMeshSkinInfoHandler::processData(LLCore::BufferArray * /* body */, S32 /* body_offset */,
 										U8 * data, S32 data_size)
 {
-	if ((! MESH_SKIN_INFO_PROCESS_FAILED) && gMeshRepo.mThread->skinInfoReceived(mMeshID, data, data_size))
+	if (! MESH_SKIN_INFO_PROCESS_FAILED)
 	{
-		// good fetch from sim, write to VFS for caching
-		LLVFile file(gVFS, mMeshID, LLAssetType::AT_MESH, LLVFile::WRITE);
-
-		S32 offset = mOffset;
-		S32 size = mRequestedBytes;
-
-		if (file.getSize() >= offset+size)
-		{
-			LLMeshRepository::sCacheBytesWritten += size;
-			++LLMeshRepository::sCacheWrites;
-			file.seek(offset);
-			file.write(data, size);
-		}
+		// decoded with the rest of the repo thread's pass, and cached if it decodes
+		gMeshRepo.mThread->skinInfoReceived(mMeshID, data, data_size, mOffset, mRequestedBytes);
 	}
 	else
 	{
@@ -3188,21 +3395,10 @@ void LLMeshDecompositionHandler::processFailure(LLCore::HttpStatus status)
 void LLMeshDecompositionHandler::processData(LLCore::BufferArray * /* body */, S32 /* body_offset */,
 											 U8 * data, S32 data_size)
 {
-	if ((! MESH_DECOMP_PROCESS_FAILED) && gMeshRepo.mThread->decompositionReceived(mMeshID, data, data_size))
+	if (! MESH_DECOMP_PROCESS_FAILED)
 	{
-		// good fetch from sim, write to VFS for caching
-		LLVFile file(gVFS, mMeshID, LLAssetType::AT_MESH, LLVFile::WRITE);
-
-		S32 offset = mOffset;
-		S32 size = mRequestedBytes;
-
-		if (file.getSize() >= offset+size)
-		{
-			LLMeshRepository::sCacheBytesWritten += size;
-			++LLMeshRepository::sCacheWrites;
-			file.seek(offset);
-			file.write(data, size);
-		}
+		// decoded with the rest of the repo thread's pass, and cached if it decodes
+		gMeshRepo.mThread->decompositionReceived(mMeshID, data, data_size, mOffset, mRequestedBytes);
 	}
 	else
 	{
@@ -3260,6 +3456,7 @@ void LLMeshPhysicsShapeHandler::processData(LLCore::BufferArray * /* body */, S3
 
 LLMeshRepository::LLMeshRepository()
 : mMeshMutex(NULL),
+  mPrefetchBudget(0.f),
   mMeshThreadCount(0),
   mThread(NULL),
   mGetMeshVersion(2)
@@ -3290,6 +3487,10 @@ void LLMeshRepository::init()
 void LLMeshRepository::shutdown()
 {
 	LL_INFOS(LOG_MESH) << "Shutting down mesh repository." << LL_ENDL;
+	LL_INFOS(LOG_MESH) << "Prefetches issued:  " << sPrefetchCount
+					   << ", used:  " << sPrefetchHits
+					   << ", wasted:  " << sPrefetchWasted
+					   << LL_ENDL;
 
 	metrics_teleport_started_signal.disconnect();
 
@@ -3370,6 +3571,14 @@ S32 LLMeshRepository::loadMesh(LLVOVolume* vobj, const LLVolumeParams& mesh_para
 		return detail;
 	}
 
+	prefetch_map::iterator prefetched = mPrefetched.find(mesh_params.getSculptID());
+	if (prefetched != mPrefetched.end() && !prefetched->second.mUsed)
+	{
+		prefetched->second.mUsed = true;
+		++sPrefetchHits;
+		add(LLStatViewer::MESH_PREFETCH_HITS, 1);
+	}
+
 	{
 		LLMutexLock lock(mMeshMutex);
 		//add volume to list of loading meshes
@@ -3445,6 +3654,9 @@ void LLMeshRepository::notifyLoadedMeshes()
 { //called from main thread
 	LL_RECORD_BLOCK_TIME(FTM_MESH_FETCH);
 
+	LLMeshRepoThread::sBVHPrebuildTriangles = gSavedSettings.getU32("MeshBVHPrebuildTriangles");
+	LLMeshRepoThread::sDecodeThreads = gSavedSettings.getU32("MeshDecodeThreads");
+
 	if (1 == mGetMeshVersion)
 	{
 		// Legacy GetMesh operation with high connection concurrency
@@ -3659,6 +3871,8 @@ void LLMeshRepository::notifyLoadedMeshes()
 			}
 		}
 
+		updatePrefetch();
+
 		//send skin info requests
 		while (!mPendingSkinRequests.empty())
 		{
@@ -3686,6 +3900,171 @@ void LLMeshRepository::notifyLoadedMeshes()
 	mThread->mSignal->signal();
 }
 
+namespace
+{
+	struct PrefetchCandidate
+	{
+		F32 mScore;
+		LLUUID mMeshID;
+		S32 mLOD;
+	};
+
+	struct ComparePrefetchScore
+	{
+		bool operator()(const PrefetchCandidate& lhs, const PrefetchCandidate& rhs) const
+		{
+			return lhs.mScore > rhs.mScore; // greatest = first
+		}
+	};
+}
+
+void LLMeshRepository::updatePrefetch()
+{
+	if (mPrefetchTimer.getElapsedTimeF32() < MESH_PREFETCH_INTERVAL)
+	{
+		return;
+	}
+	LL_RECORD_BLOCK_TIME(FTM_MESH_PREFETCH);
+
+	const F32 elapsed = mPrefetchTimer.getElapsedTimeAndResetF32();
+	const F64 now = LLFrameTimer::getElapsedSeconds();
+
+	// Retire what has been around long enough, counting what no object
+	// ever asked for.
+	for (prefetch_map::iterator iter = mPrefetched.begin(); iter != mPrefetched.end(); )
+	{
+		if (iter->second.mExpires < now)
+		{
+			if (!iter->second.mUsed)
+			{
+				++sPrefetchWasted;
+				add(LLStatViewer::MESH_PREFETCH_WASTED, 1);
+			}
+			mPrefetched.erase(iter++);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+
+	static LLCachedControl<bool> prefetch_enabled(gSavedSettings, "MeshPrefetch", true);
+	static LLCachedControl<F32> lookahead(gSavedSettings, "MeshPrefetchLookahead", 2.f);
+	static LLCachedControl<F32> prefetch_radius(gSavedSettings, "MeshPrefetchRadius", 64.f);
+	static LLCachedControl<U32> budget_kb(gSavedSettings, "MeshPrefetchBudgetKB", 256);
+	static LLCachedControl<F32> expiry(gSavedSettings, "MeshPrefetchExpiry", 60.f);
+
+	// Unspent budget carries over, up to one second's worth
+	const F32 budget_per_second = budget_kb * 1024.f;
+	mPrefetchBudget = llmin(mPrefetchBudget + budget_per_second * elapsed, budget_per_second);
+
+	if (!prefetch_enabled || mPrefetchBudget <= 0.f || !gAgent.getRegion())
+	{
+		return;
+	}
+
+	// Look from where the camera will be after lookahead seconds at its
+	// current speed, favouring what lies ahead of it.  A camera that is
+	// barely moving favours what it faces, to be ready for it turning.
+	LLViewerCamera* camera = LLViewerCamera::getInstance();
+	const F32 travel = camera->getAverageSpeed() * lookahead;
+	const LLVector3 predicted = camera->getOrigin() + camera->getVelocityDir() * travel;
+	const LLVector3 heading = travel > 0.1f ? camera->getVelocityDir() : camera->getAtAxis();
+	const F32 radius = llmin((F32) prefetch_radius, camera->getFar());
+
+	std::vector<PrefetchCandidate> candidates;
+	std::vector<LLVOCacheEntry*> entries;
+	for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin();
+		 iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
+	{
+		LLViewerRegion* region = *iter;
+		const LLVector3 origin = region->getOriginAgent();
+
+		entries.clear();
+		region->getInactiveCacheEntries(predicted - origin, radius, entries);
+		for (std::vector<LLVOCacheEntry*>::iterator entry_iter = entries.begin(); entry_iter != entries.end(); ++entry_iter)
+		{
+			LLVOCacheEntry* root = *entry_iter;
+
+			// The whole linkset is scored from its center
+			LLVector3 to_center(root->getPositionGroup().getF32ptr());
+			to_center += origin - predicted;
+			const F32 distance = llmax(to_center.normVec(), 1.f);
+			const F32 facing = 1.f + llmax(to_center * heading, 0.f);
+
+			LLVOCacheEntry* entry = root;
+			LLVOCacheEntry::vocache_entry_set_t::const_iterator child = root->getChildren().begin();
+			while (entry)
+			{
+				const LLUUID& mesh_id = entry->getMeshID();
+				if (mesh_id.notNull())
+				{
+					const F32 mesh_radius = entry->getMeshRadius();
+					PrefetchCandidate candidate;
+					candidate.mScore = mesh_radius / distance * facing;
+					candidate.mMeshID = mesh_id;
+					candidate.mLOD = LLVOVolume::computeLODDetailAt(distance, mesh_radius);
+
+					prefetch_map::iterator prefetched = mPrefetched.find(mesh_id);
+					if (prefetched == mPrefetched.end() || prefetched->second.mLOD < candidate.mLOD)
+					{
+						candidates.push_back(candidate);
+					}
+				}
+
+				entry = child != root->getChildren().end() ? *(child++) : NULL;
+			}
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), ComparePrefetchScore());
+
+	for (std::vector<PrefetchCandidate>::iterator iter = candidates.begin();
+		 iter != candidates.end() && mPrefetchBudget > 0.f; ++iter)
+	{
+		prefetch_map::iterator prefetched = mPrefetched.find(iter->mMeshID);
+		const LLSD& header = getMeshHeader(iter->mMeshID);
+
+		// The header comes first, the LOD on a later pass once its size is known
+		S32 lod = -1;
+		S32 bytes = MESH_HEADER_SIZE;
+		if (header.isUndefined())
+		{
+			if (prefetched != mPrefetched.end())
+			{
+				continue; // header on its way
+			}
+		}
+		else
+		{
+			if (header.has("404")
+				|| (prefetched != mPrefetched.end() && prefetched->second.mLOD >= iter->mLOD))
+			{
+				continue;
+			}
+
+			lod = iter->mLOD;
+			bytes = header[header_lod[lod]]["size"].asInteger();
+			if (bytes <= 0)
+			{
+				continue;
+			}
+		}
+
+		LLVolumeParams mesh_params;
+		mesh_params.setSculptID(iter->mMeshID, LL_SCULPT_TYPE_MESH);
+		mThread->prefetchMesh(mesh_params, lod);
+
+		PrefetchEntry& entry = mPrefetched[iter->mMeshID];
+		entry.mLOD = lod;
+		entry.mExpires = now + expiry;
+
+		mPrefetchBudget -= bytes;
+		++sPrefetchCount;
+		add(LLStatViewer::MESH_PREFETCHES, 1);
+	}
+}
+
 void LLMeshRepository::notifySkinInfoReceived(LLMeshSkinInfo& info)
 {
 	mSkinMap[info.mMeshID] = info;
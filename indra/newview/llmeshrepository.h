@@ -33,6 +33,7 @@
 #include "llviewertexture.h"
 #include "llvolume.h"
 #include "lldeadmantimer.h"
+#include "llframetimer.h"
 #include "httpcommon.h"
 #include "httprequest.h"
 #include "httpoptions.h"
@@ -50,6 +51,7 @@ class LLMutex;
 class LLCondition;
 class LLVFS;
 class LLMeshRepository;
+class LLWorkPool;
 
 class LLMeshUploadData
 {
@@ -175,6 +177,8 @@ public:
 	volatile static S32 sActiveHeaderRequests;
 	volatile static S32 sActiveLODRequests;
 	static U32 sMaxConcurrentRequests;
+	static U32 sBVHPrebuildTriangles;		// Faces with at least this many triangles get their picking BVH built on the repo thread, 0 for none
+	static U32 sDecodeThreads;				// Workers to spread decoding of fetched blocks over, 0 to decode on the repo thread
 	static S32 sRequestLowWater;
 	static S32 sRequestHighWater;
 	static S32 sRequestWaterLevel;			// Stats-use only, may read outside of thread
@@ -241,6 +245,41 @@ public:
 
 	};
 
+	// A fetched LOD, skin info or decomposition block waiting for the
+	// next decode batch
+	class DecodeRequest
+	{
+	public:
+		enum EType
+		{
+			LOD,
+			SKIN_INFO,
+			DECOMPOSITION
+		};
+
+		EType mType;
+		// only the sculpt ID, naming the mesh, is set for skin info and
+		// decompositions
+		LLVolumeParams mMeshParams;
+		S32 mLOD;
+		// LODs only, made when queued as generating the volume's path and
+		// profile is not thread safe
+		LLPointer<LLVolume> mVolume;
+		std::string mData;
+		// where the block goes in the VFS once it decodes, -1 if it was
+		// read from there
+		S32 mCacheOffset;
+		S32 mCacheSize;
+		bool mDecoded;
+
+		DecodeRequest(EType type, const LLVolumeParams& mesh_params, S32 lod, const U8* data, S32 data_size,
+					  S32 cache_offset, S32 cache_size)
+			: mType(type), mMeshParams(mesh_params), mLOD(lod), mData((const char*) data, data_size),
+			  mCacheOffset(cache_offset), mCacheSize(cache_size), mDecoded(false)
+		{
+		}
+	};
+
 	//set of requested skin info
 	std::set<LLUUID> mSkinRequests;
 	
@@ -262,6 +301,9 @@ public:
 	//queue of requested LODs
 	std::queue<LODRequest> mLODReqQ;
 
+	//queue of headers (negative LOD) and LODs to fetch into the VFS ahead of need
+	std::queue<LODRequest> mPrefetchReqQ;
+
 	//queue of unavailable LODs (either asset doesn't exist or asset doesn't have desired LOD)
 	std::queue<LODRequest> mUnavailableQ;
 
@@ -281,6 +323,7 @@ public:
 	LLCore::HttpRequest::policy_t		mHttpPolicyClass;
 	LLCore::HttpRequest::policy_t		mHttpLegacyPolicyClass;
 	LLCore::HttpRequest::policy_t		mHttpLargePolicyClass;
+	LLCore::HttpRequest::policy_t		mHttpPrefetchPolicyClass;
 	LLCore::HttpRequest::priority_t		mHttpPriority;
 
 	typedef std::set<LLCore::HttpHandler::ptr_t> http_request_set;
@@ -290,6 +333,10 @@ public:
 	std::string mGetMesh2Capability;
 	int mGetMeshVersion;
 
+	//blocks to decode at the end of this pass of run()
+	std::vector<DecodeRequest> mDecodeQ;
+	LLWorkPool* mDecodePool;
+
 	LLMeshRepoThread();
 	~LLMeshRepoThread();
 
@@ -298,12 +345,26 @@ public:
 	void lockAndLoadMeshLOD(const LLVolumeParams& mesh_params, S32 lod);
 	void loadMeshLOD(const LLVolumeParams& mesh_params, S32 lod);
 
-	bool fetchMeshHeader(const LLVolumeParams& mesh_params);
-	bool fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod);
+	// Queue a header (lod < 0) or LOD to be fetched into the VFS cache
+	// without decoding, once nothing else is waiting on the network.
+	//
+	// Mutex:  acquires mMutex
+	void prefetchMesh(const LLVolumeParams& mesh_params, S32 lod);
+
+	bool fetchMeshHeader(const LLVolumeParams& mesh_params, bool prefetch = false);
+	bool fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod, bool prefetch = false, bool use_cache = true);
 	bool headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size);
-	bool lodReceived(const LLVolumeParams& mesh_params, S32 lod, U8* data, S32 data_size);
-	bool skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
-	bool decompositionReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
+
+	// Queue a fetched block for decodeBlocks().  Blocks from the sim pass
+	// where they go in the VFS, and are written there once they decode.
+	//
+	// Threads:  Repo thread only
+	void lodReceived(const LLVolumeParams& mesh_params, S32 lod, U8* data, S32 data_size,
+					 S32 cache_offset = -1, S32 cache_size = 0);
+	void skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size,
+						  S32 cache_offset = -1, S32 cache_size = 0);
+	void decompositionReceived(const LLUUID& mesh_id, U8* data, S32 data_size,
+							   S32 cache_offset = -1, S32 cache_size = 0);
 	bool physicsShapeReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
 	LLSD& getMeshHeader(const LLUUID& mesh_id);
 
@@ -316,11 +377,11 @@ public:
 
 	//send request for skin info, returns true if header info exists 
 	//  (should hold onto mesh_id and try again later if header info does not exist)
-	bool fetchMeshSkinInfo(const LLUUID& mesh_id);
+	bool fetchMeshSkinInfo(const LLUUID& mesh_id, bool use_cache = true);
 
 	//send request for decomposition, returns true if header info exists 
 	//  (should hold onto mesh_id and try again later if header info does not exist)
-	bool fetchMeshDecomposition(const LLUUID& mesh_id);
+	bool fetchMeshDecomposition(const LLUUID& mesh_id, bool use_cache = true);
 
 	//send request for PhysicsShape, returns true if header info exists 
 	//  (should hold onto mesh_id and try again later if header info does not exist)
@@ -344,14 +405,25 @@ public:
 
 private:
 	// Issue a GET request to a URL with 'Range' header using
-	// the correct policy class and other attributes.  If an invalid
-	// handle is returned, the request failed and caller must retry
-	// or dispose of handler.
+	// the correct policy class and other attributes.  Prefetches
+	// go to their own class.  If an invalid handle is returned,
+	// the request failed and caller must retry or dispose of
+	// handler.
 	//
 	// Threads:  Repo thread only
 	LLCore::HttpHandle getByteRange(const std::string & url, int cap_version,
 									size_t offset, size_t len, 
-									const LLCore::HttpHandler::ptr_t &handler);
+									LLCore::HttpRequest::priority_t priority,
+									const LLCore::HttpHandler::ptr_t &handler,
+									bool prefetch = false);
+
+	// Decode everything in mDecodeQ over the decode pool, then cache what
+	// decoded and refetch or give up on what did not.
+	//
+	// Threads:  Repo thread only
+	void decodeBlocks();
+	// Threads:  Any, one call per request
+	void decodeBlock(U32 index);
 };
 
 
@@ -472,6 +544,9 @@ public:
 	static U32 sCacheReads;						
 	static U32 sCacheWrites;
 	static U32 sMaxLockHoldoffs;				// Maximum sequential locking failures
+	static U32 sPrefetchCount;					// Headers and LODs prefetched
+	static U32 sPrefetchHits;					// Prefetched meshes an object then asked for
+	static U32 sPrefetchWasted;					// Prefetched meshes that expired unasked for
 	
 	static LLDeadmanTimer sQuiescentTimer;		// Time-to-complete-mesh-downloads after significant events
 
@@ -514,6 +589,10 @@ public:
 
 	S32 getMeshSize(const LLUUID& mesh_id, S32 lod);
 
+	// Fetch headers and LODs of meshes the camera is heading towards
+	// but that are not objects yet, main thread only.
+	void updatePrefetch();
+
 	// Quiescent timer management, main thread only.
 	static void metricsStart();
 	static void metricsStop();
@@ -532,6 +611,21 @@ public:
 	LLMutex*					mMeshMutex;
 	
 	std::vector<LLMeshRepoThread::LODRequest> mPendingRequests;
+
+	//meshes prefetched recently, kept until they expire so they are
+	//neither fetched again nor counted twice
+	struct PrefetchEntry
+	{
+		PrefetchEntry() : mLOD(-1), mExpires(0.0), mUsed(false) {}
+
+		S32 mLOD;			// highest LOD fetched, -1 for the header only
+		F64 mExpires;
+		bool mUsed;			// an object has asked for the mesh since
+	};
+	typedef std::map<LLUUID, PrefetchEntry> prefetch_map;
+	prefetch_map mPrefetched;
+	LLFrameTimer mPrefetchTimer;
+	F32 mPrefetchBudget;	// bytes prefetches may still request
 	
 	//list of mesh ids awaiting skin info
 	typedef std::map<LLUUID, std::set<LLUUID> > skin_load_map;
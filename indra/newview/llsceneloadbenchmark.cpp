@@ -0,0 +1,244 @@
+/** 
+ * @file llsceneloadbenchmark.cpp
+ * @brief Measures time to interactive after login and teleport
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llsceneloadbenchmark.h"
+
+#include "llagent.h"
+#include "llappviewer.h"
+#include "llimagegl.h"
+#include "llmemory.h"
+#include "llmeshrepository.h"
+#include "llsdserialize.h"
+#include "llstartup.h"
+#include "lltexturefetch.h"
+#include "llversioninfo.h"
+#include "llvertexbuffer.h"
+#include "llviewercontrol.h"
+#include "llviewerobjectlist.h"
+#include "llvoavatar.h"
+
+LLSceneLoadBenchmark::LLSceneLoadBenchmark()
+:	mRunning(false),
+	mLoginSeen(false),
+	mWasTeleporting(false),
+	mStartFrame(0),
+	mFirstObjectTime(-1.0),
+	mTexturesDoneTime(-1.0),
+	mMeshesDoneTime(-1.0),
+	mInteractiveTime(-1.0),
+	mPeakRSS(0),
+	mPeakTextureMemory(0),
+	mPeakVertexBufferMemory(0)
+{
+	mResults["version"] = LLVersionInfo::getChannelAndVersion();
+	mResults["headless"] = gSavedSettings.getBOOL("HeadlessClient");
+	mResults["http_playback"] = gSavedSettings.getString("HttpPlaybackFile");
+	mResults["packet_playback"] = gSavedSettings.getString("PacketPlaybackFile");
+	mResults["runs"] = LLSD::emptyArray();
+}
+
+void LLSceneLoadBenchmark::idle()
+{
+	static LLCachedControl<std::string> output_file(gSavedSettings, "SceneLoadBenchmarkFile");
+	if (output_file().empty())
+	{
+		return;
+	}
+
+	if (!mLoginSeen && LLStartUp::getStartupState() >= STATE_LOGIN_AUTH_INIT)
+	{
+		mLoginSeen = true;
+		startRun("login");
+	}
+
+	bool teleporting = gAgent.getTeleportState() != LLAgent::TELEPORT_NONE;
+	if (teleporting && !mWasTeleporting)
+	{
+		if (mRunning)
+		{
+			// A new teleport supersedes whatever was still loading.
+			finishRun(SUPERSEDED);
+		}
+		startRun("teleport");
+	}
+	mWasTeleporting = teleporting;
+
+	if (mRunning)
+	{
+		sample(mRunTimer.getElapsedTimeF64());
+	}
+}
+
+void LLSceneLoadBenchmark::startRun(const std::string& trigger)
+{
+	LL_INFOS() << "Starting scene load benchmark run after " << trigger << LL_ENDL;
+
+	mRunning = true;
+	mTrigger = trigger;
+	mRunTimer.reset();
+	mSettleTimer.reset();
+	mStartFrame = gFrameCount;
+
+	mFirstObjectTime = -1.0;
+	mTexturesDoneTime = -1.0;
+	mMeshesDoneTime = -1.0;
+	mInteractiveTime = -1.0;
+
+	mPeakRSS = 0;
+	mPeakTextureMemory = 0;
+	mPeakVertexBufferMemory = 0;
+}
+
+void LLSceneLoadBenchmark::sample(F64 elapsed)
+{
+	mPeakRSS = llmax(mPeakRSS, LLMemory::getCurrentRSS());
+	mPeakTextureMemory = llmax(mPeakTextureMemory, (S64)LLImageGL::sGlobalTextureMemory.value());
+	mPeakVertexBufferMemory = llmax(mPeakVertexBufferMemory, LLVertexBuffer::sAllocatedBytes);
+
+	// A login or teleport that never gets there still ends the run.
+	static LLCachedControl<F32> timeout(gSavedSettings, "SceneLoadBenchmarkTimeout");
+	if (elapsed > (F64)timeout())
+	{
+		finishRun(TIMED_OUT);
+		return;
+	}
+
+	if (LLStartUp::getStartupState() < STATE_STARTED
+		|| gAgent.getTeleportState() != LLAgent::TELEPORT_NONE)
+	{
+		// Nothing counts until the agent is actually in the region.
+		mSettleTimer.reset();
+		return;
+	}
+
+	// Avatars are created as soon as we arrive; only count other objects.
+	bool have_objects = gObjectList.getNumObjects() > (S32)LLCharacter::sInstances.size();
+	if (have_objects && mFirstObjectTime < 0.0)
+	{
+		mFirstObjectTime = elapsed;
+	}
+
+	bool textures_idle = LLAppViewer::getTextureFetch()->getNumRequests() == 0;
+	
+	S32 pending_meshes = (S32)gMeshRepo.mPendingRequests.size();
+	for (S32 i = 0; i < 4; ++i)
+	{
+		pending_meshes += (S32)gMeshRepo.mLoadingMeshes[i].size();
+	}
+	bool meshes_idle = pending_meshes == 0;
+
+	// Milestones are the last time the subsystem went idle; any new work
+	// invalidates them.
+	if (!textures_idle)
+	{
+		mTexturesDoneTime = -1.0;
+	}
+	else if (mTexturesDoneTime < 0.0)
+	{
+		mTexturesDoneTime = elapsed;
+	}
+
+	if (!meshes_idle)
+	{
+		mMeshesDoneTime = -1.0;
+	}
+	else if (mMeshesDoneTime < 0.0)
+	{
+		mMeshesDoneTime = elapsed;
+	}
+
+	if (!have_objects || !textures_idle || !meshes_idle)
+	{
+		mSettleTimer.reset();
+	}
+
+	static LLCachedControl<F32> settle_time(gSavedSettings, "SceneLoadBenchmarkSettleTime");
+	if (mSettleTimer.getElapsedTimeF32() > settle_time())
+	{
+		mInteractiveTime = llmax(mFirstObjectTime, llmax(mTexturesDoneTime, mMeshesDoneTime));
+		finishRun(COMPLETE);
+	}
+}
+
+void LLSceneLoadBenchmark::finishRun(EOutcome outcome)
+{
+	static const char* const outcome_names[] = { "complete", "timed_out", "superseded" };
+
+	mRunning = false;
+
+	F64 duration = mRunTimer.getElapsedTimeF64();
+	U32 frames = gFrameCount - mStartFrame;
+
+	LLSD run;
+	run["trigger"] = mTrigger;
+	run["outcome"] = outcome_names[outcome];
+	run["timed_out"] = outcome == TIMED_OUT;
+	run["duration"] = duration;
+	run["frames"] = (S32)frames;
+	run["mean_fps"] = duration > 0.0 ? (F64)frames / duration : 0.0;
+	run["time_to_first_object"] = mFirstObjectTime;
+	run["time_to_textures_complete"] = mTexturesDoneTime;
+	run["time_to_meshes_complete"] = mMeshesDoneTime;
+	run["time_to_interactive"] = mInteractiveTime;
+	run["object_count"] = gObjectList.getNumObjects();
+	run["peak_rss_kb"] = (S32)(mPeakRSS / 1024);
+	run["peak_texture_memory_kb"] = (S32)(mPeakTextureMemory / 1024);
+	run["peak_vertex_buffer_kb"] = (S32)(mPeakVertexBufferMemory / 1024);
+	mResults["runs"].append(run);
+
+	LL_INFOS() << "Scene load benchmark run after " << mTrigger
+		<< " " << outcome_names[outcome]
+		<< ", time to interactive " << mInteractiveTime << "s" << LL_ENDL;
+
+	writeResults();
+
+	// The teleport that superseded this run gets measured in its place.
+	static LLCachedControl<bool> quit_when_done(gSavedSettings, "SceneLoadBenchmarkQuit");
+	if (quit_when_done && outcome != SUPERSEDED)
+	{
+		LLAppViewer::instance()->forceQuit();
+	}
+}
+
+void LLSceneLoadBenchmark::writeResults()
+{
+	std::string output_file = gSavedSettings.getString("SceneLoadBenchmarkFile");
+	if (output_file.empty() || mResults["runs"].size() == 0)
+	{
+		return;
+	}
+
+	llofstream out(output_file.c_str());
+	if (!out.is_open())
+	{
+		LL_WARNS() << "Unable to write scene load benchmark results to " << output_file << LL_ENDL;
+		return;
+	}
+	LLSDSerialize::toPrettyXML(mResults, out);
+	out.close();
+}
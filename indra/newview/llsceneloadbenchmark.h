@@ -0,0 +1,92 @@
+/** 
+ * @file llsceneloadbenchmark.h
+ * @brief Measures time to interactive after login and teleport
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSCENELOADBENCHMARK_H
+#define LL_LLSCENELOADBENCHMARK_H
+
+#include "llsingleton.h"
+#include "llsd.h"
+#include "lltimer.h"
+
+// Reproducible scene load timing.  When "SceneLoadBenchmarkFile" is set,
+// each login and teleport starts a run that records how long it takes
+// until the first object arrives, until the texture fetcher has no
+// outstanding requests (every texture at its requested discard) and until
+// no mesh LODs are pending, along with peak memory.  A run ends once all
+// of those have stayed idle for "SceneLoadBenchmarkSettleTime" seconds, or
+// "SceneLoadBenchmarkTimeout" seconds after it started, whichever is first.
+// A teleport while a run is loading ends it as superseded.
+// Combine --recordhttp / --replayhttp with --recordpackets / --replaypackets
+// to replay login, capabilities, assets and UDP without the grid, and with
+// --headless to run without a window.
+class LLSceneLoadBenchmark : public LLSingleton<LLSceneLoadBenchmark>
+{
+	LOG_CLASS(LLSceneLoadBenchmark);
+public:
+	LLSceneLoadBenchmark();
+
+	// Called once per frame from LLAppViewer::idle().
+	void idle();
+
+	bool isRunning() const { return mRunning; }
+
+	// Flush collected runs to the output file.
+	void writeResults();
+
+private:
+	void startRun(const std::string& trigger);
+	enum EOutcome
+	{
+		COMPLETE,
+		TIMED_OUT,
+		SUPERSEDED
+	};
+
+	void finishRun(EOutcome outcome);
+	void sample(F64 elapsed);
+
+	bool		mRunning;
+	bool		mLoginSeen;
+	bool		mWasTeleporting;
+	std::string	mTrigger;
+	LLTimer		mRunTimer;
+	LLTimer		mSettleTimer;
+	U32			mStartFrame;
+
+	// Milestones in seconds since the run started, negative if not reached.
+	F64			mFirstObjectTime;
+	F64			mTexturesDoneTime;
+	F64			mMeshesDoneTime;
+	F64			mInteractiveTime;
+
+	U64			mPeakRSS;
+	S64			mPeakTextureMemory;
+	U32			mPeakVertexBufferMemory;
+
+	LLSD		mResults;
+};
+
+#endif // LL_LLSCENELOADBENCHMARK_H
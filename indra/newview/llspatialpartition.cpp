@@ -1523,6 +1523,53 @@ S32 LLSpatialPartition::cull(LLCamera &camera, bool do_occlusion)
 	return 0;
 }
 
+void LLSpatialPartition::cullRebound()
+{
+	LL_RECORD_BLOCK_TIME(FTM_CULL_REBOUND);
+	LLSpatialGroup* group = (LLSpatialGroup*) mOctree->getListener(0);
+	group->rebound();
+}
+
+void LLSpatialPartition::cullFrustum(LLCamera& camera, LLViewerOctreeCull::cull_steps_t& steps)
+{
+	// same culler as cull(), no block timers as this runs on worker threads
+	if (LLPipeline::sShadowRender)
+	{
+		LLOctreeCullShadow culler(&camera);
+		culler.record(mOctree, steps);
+	}
+	else if (mInfiniteFarClip || !LLPipeline::sUseFarClip)
+	{
+		LLOctreeCullNoFarClip culler(&camera);
+		culler.record(mOctree, steps);
+	}
+	else
+	{
+		LLOctreeCull culler(&camera);
+		culler.record(mOctree, steps);
+	}
+}
+
+void LLSpatialPartition::cullReplay(LLCamera& camera, const LLViewerOctreeCull::cull_steps_t& steps)
+{
+	LL_RECORD_BLOCK_TIME(FTM_FRUSTUM_CULL);
+	if (LLPipeline::sShadowRender)
+	{
+		LLOctreeCullShadow culler(&camera);
+		culler.replay(steps);
+	}
+	else if (mInfiniteFarClip || !LLPipeline::sUseFarClip)
+	{
+		LLOctreeCullNoFarClip culler(&camera);
+		culler.replay(steps);
+	}
+	else
+	{
+		LLOctreeCull culler(&camera);
+		culler.replay(steps);
+	}
+}
+
 void pushVerts(LLDrawInfo* params, U32 mask)
 {
 	LLRenderPass::applyModelMatrix(*params);
@@ -52,6 +52,7 @@ class LLSpatialGroup;
 class LLTextureAtlas;
 class LLTextureAtlasSlot;
 class LLViewerRegion;
+class LLGeometryFill;
 
 void pushVerts(LLFace* face, U32 mask);
 
@@ -408,6 +409,14 @@ public:
 	BOOL visibleObjectsInFrustum(LLCamera& camera);
 	/*virtual*/ S32 cull(LLCamera &camera, bool do_occlusion=false); // Cull on arbitrary frustum
 	S32 cull(LLCamera &camera, std::vector<LLDrawable *>* results, BOOL for_select); // Cull on arbitrary frustum
+
+	// cull(camera) in three steps, so that LLPipeline::updateCull() can do
+	// the frustum tests of all partitions at once on worker threads.  Only
+	// cullFrustum() may run off the main thread, and only between the
+	// other two.
+	void cullRebound();
+	void cullFrustum(LLCamera& camera, LLViewerOctreeCull::cull_steps_t& steps);
+	void cullReplay(LLCamera& camera, const LLViewerOctreeCull::cull_steps_t& steps);
 	
 	BOOL isVisible(const LLVector3& v);
 	bool isHUDPartition() ;
@@ -653,6 +662,9 @@ private:
 	void allocateFaces(U32 pMaxFaceCount);
 	void freeFaces();
 
+	// runs the vertex data writes queued by getGeometryVolume()
+	void fillGeometry();
+
 	static int32_t sInstanceCount;
 	static LLFace** sFullbrightFaces;
 	static LLFace** sBumpFaces;
@@ -661,6 +673,11 @@ private:
 	static LLFace** sSpecFaces;
 	static LLFace** sNormSpecFaces;
 	static LLFace** sAlphaFaces;
+
+	// vertex data writes of the faces being rebuilt, and the buffers
+	// genDrawInfo() left mapped for them
+	static LLGeometryFill* sGeometryFill;
+	static std::vector<LLPointer<LLVertexBuffer> > sFillBuffers;
 };
 
 //spatial partition that uses volume geometry manager (implemented in LLVOVolume.cpp)
@@ -360,6 +360,17 @@ bool idle_startup()
 			// need to capture the initial state as well.
 			LLStartUp::getPhases().startPhase(LLStartUp::getStartupStateString());
 			first_call = false;
+
+			if (gSavedSettings.getU32("FontLayoutBenchmarkStrings") > 0)
+			{
+				LLStartUp::fontLayoutBenchmark();
+				if (gHeadlessClient)
+				{
+					// Benchmark only run, there is nothing else to measure without a window
+					LLAppViewer::instance()->forceQuit();
+					return FALSE;
+				}
+			}
 		}
 
 		gViewerWindow->showCursor(); 
@@ -807,6 +818,8 @@ bool idle_startup()
 
 		// Don't do anything.  Wait for the login view to call the login_callback,
 		// which will push us to the next state.
+		// Meanwhile finish the initialization the login screen did not need.
+		LLAppViewer::instance()->runDeferredStartupTasks(0.01f);
 		display_startup();
 		// Sleep so we don't spin the CPU
 		ms_sleep(1);
@@ -815,6 +828,9 @@ bool idle_startup()
 
 	if (STATE_LOGIN_CLEANUP == LLStartUp::getStartupState())
 	{
+		// whatever initialization the login screen left undone
+		LLAppViewer::instance()->runDeferredStartupTasks();
+
 		// Post login screen, we should see if any settings have changed that may
 		// require us to either start/stop or change the socks proxy. As various communications
 		// past this point may require the proxy to be up.
@@ -1472,6 +1488,19 @@ bool idle_startup()
 
 		gUseCircuitCallbackCalled = false;
 
+		// Packet timing is taken from the start of the circuit, login and
+		// capabilities are replayed over HTTP beforehand at their own pace.
+		std::string packet_playback_file = gSavedSettings.getString("PacketPlaybackFile");
+		std::string packet_record_file = gSavedSettings.getString("PacketRecordFile");
+		if (!packet_playback_file.empty())
+		{
+			msg->mPacketRing.startPlayback(packet_playback_file);
+		}
+		else if (!packet_record_file.empty())
+		{
+			msg->mPacketRing.startRecording(packet_record_file);
+		}
+
 		msg->enableCircuit(gFirstSim, TRUE);
 		// now, use the circuit info to tell simulator about us!
 		LL_INFOS("AppInit") << "viewer: UserLoginLocationReply() Enabling " << gFirstSim << " with code " << msg->mOurCircuitCode << LL_ENDL;
@@ -1855,6 +1884,7 @@ bool idle_startup()
 		gSavedSettings.setBOOL("FirstLoginThisInstall", FALSE);
 
 		LLFloaterReg::showInitialVisibleInstances();
+		LLFloaterReg::startPreloading();
 
 		display_startup();
 
@@ -2767,9 +2797,26 @@ void LLStartUp::fontInit()
 	set_startup_status(0.45f, msg.c_str(), gAgent.mMOTD.c_str());
 	display_startup();
 
+	LLFontGL::setGlyphRunCacheSize(gSavedSettings.getU32("FontGlyphRunCacheSize"));
 	LLFontGL::loadDefaultFonts();
 }
 
+void LLStartUp::fontLayoutBenchmark()
+{
+	U32 benchmark_strings = gSavedSettings.getU32("FontLayoutBenchmarkStrings");
+	if (benchmark_strings > 0)
+	{ //chat and name tag like strings, laid out without drawing
+		LLFontGL::setGlyphRunCacheSize(gSavedSettings.getU32("FontGlyphRunCacheSize"));
+
+		std::vector<LLWString> strings;
+		for (U32 i = 0; i < benchmark_strings; ++i)
+		{
+			strings.push_back(utf8str_to_wstring(llformat("Resident %d (resident.%d): the quick brown fox %d", i, i * 7, i % 97)));
+		}
+		LLFontGL::getFontSansSerifSmall()->benchmarkLayout(strings, 10);
+	}
+}
+
 void LLStartUp::initNameCache()
 {
 	// Can be called multiple times
@@ -2788,6 +2835,8 @@ void LLStartUp::initNameCache()
 	LLAvatarNameCache::initClass(false,gSavedSettings.getBOOL("UsePeopleAPI"));
 	LLAvatarNameCache::setUseDisplayNames(gSavedSettings.getBOOL("UseDisplayNames"));
 	LLAvatarNameCache::setUseUsernames(gSavedSettings.getBOOL("NameTagShowUsernames"));
+	LLAvatarNameCache::setRequestLimits(gSavedSettings.getU32("NameCacheMaxBatchSize"),
+										gSavedSettings.getU32("NameCacheMaxRequests"));
 }
 
 
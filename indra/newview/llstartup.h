@@ -102,6 +102,10 @@ public:
 	// Load default fonts not already loaded at start screen
 	static void fontInit();
 
+	// Lay out "FontLayoutBenchmarkStrings" strings without drawing and log
+	// the timings, run ahead of login so it works with --headless too
+	static void fontLayoutBenchmark();
+
 	static void initNameCache();
 	static void initExperiences();
 	
@@ -228,7 +228,7 @@ void LLViewerDisplay::update_camera(int whichEye)
 // Write some stats to LL_INFOS()
 void LLViewerDisplay::display_stats()
 {
-	F32 fps_log_freq = gSavedSettings.getF32("FPSLogFrequency");
+	static LLCachedControl<F32> fps_log_freq(gSavedSettings, "FPSLogFrequency");
 	if (fps_log_freq > 0.f && gRecentFPSTime.getElapsedTimeF32() >= fps_log_freq)
 	{
 		F32 fps = gRecentFrameCount / fps_log_freq;
@@ -236,7 +236,7 @@ void LLViewerDisplay::display_stats()
 		gRecentFrameCount = 0;
 		gRecentFPSTime.reset();
 	}
-	F32 mem_log_freq = gSavedSettings.getF32("MemoryLogFrequency");
+	static LLCachedControl<F32> mem_log_freq(gSavedSettings, "MemoryLogFrequency");
 	if (mem_log_freq > 0.f && gRecentMemoryTime.getElapsedTimeF32() >= mem_log_freq)
 	{
 		gMemoryAllocated = (U64Bytes)LLMemory::getCurrentRSS();
@@ -245,6 +245,30 @@ void LLViewerDisplay::display_stats()
 		LLMemory::logMemoryInfo(TRUE) ;
 		gRecentMemoryTime.reset();
 	}
+	static LLCachedControl<F32> lookup_log_freq(gSavedSettings, "SettingsLookupLogFrequency");
+	static LLFrameTimer lookup_time;
+	static U32 lookup_frames = 0;
+	if (lookup_log_freq > 0.f)
+	{
+		if (!LLControlGroup::isLookupCounting())
+		{
+			LLControlGroup::setLookupCounting(true);
+			lookup_time.reset();
+			lookup_frames = 0;
+		}
+		++lookup_frames;
+		if (lookup_time.getElapsedTimeF32() >= lookup_log_freq)
+		{
+			LL_INFOS() << "Settings looked up by name at least once a frame:" << LL_ENDL;
+			LLControlGroup::logLookupCounts(lookup_frames, 1.f);
+			lookup_time.reset();
+			lookup_frames = 0;
+		}
+	}
+	else if (LLControlGroup::isLookupCounting())
+	{
+		LLControlGroup::setLookupCounting(false);
+	}
 }
 
 // Paint the display!
@@ -385,8 +409,10 @@ void LLViewerDisplay::display(BOOL rebuild, F32 zoom_factor, int subfield, BOOL
 
 	LLImageGL::updateStats(gFrameTimeSeconds);
 	
-	LLVOAvatar::sRenderName = gSavedSettings.getS32("AvatarNameTagMode");
-	LLVOAvatar::sRenderGroupTitles = (gSavedSettings.getBOOL("NameTagShowGroupTitles") && gSavedSettings.getS32("AvatarNameTagMode"));
+	static LLCachedControl<S32> name_tag_mode(gSavedSettings, "AvatarNameTagMode");
+	static LLCachedControl<bool> show_group_titles(gSavedSettings, "NameTagShowGroupTitles");
+	LLVOAvatar::sRenderName = name_tag_mode;
+	LLVOAvatar::sRenderGroupTitles = show_group_titles && name_tag_mode;
 	
 	gPipeline.mBackfaceCull = TRUE;
 	gFrameCount++;
@@ -1021,7 +1047,8 @@ void LLViewerDisplay::render_geom(render_options& options)
 	{
 		LLViewerCamera::sCurCameraID = LLViewerCamera::CAMERA_WORLD;
 
-		if (gSavedSettings.getBOOL("RenderDepthPrePass") && LLGLSLShader::sNoFixedFunction)
+		static LLCachedControl<bool> depth_pre_pass(gSavedSettings, "RenderDepthPrePass");
+		if (depth_pre_pass && LLGLSLShader::sNoFixedFunction)
 		{
 			gGL.setColorMask(false, false);
 				
@@ -1152,7 +1179,8 @@ void LLViewerDisplay::render_hud_attachments()
 		hud_cam.setAxes(LLVector3(1,0,0), LLVector3(0,1,0), LLVector3(0,0,1));
 		LLViewerCamera::updateFrustumPlanes(hud_cam, TRUE);
 
-		bool render_particles = gPipeline.hasRenderType(LLPipeline::RENDER_TYPE_PARTICLES) && gSavedSettings.getBOOL("RenderHUDParticles");
+		static LLCachedControl<bool> hud_particles(gSavedSettings, "RenderHUDParticles");
+		bool render_particles = gPipeline.hasRenderType(LLPipeline::RENDER_TYPE_PARTICLES) && hud_particles;
 		
 		//only render hud objects
 		gPipeline.pushRenderTypeMask();
@@ -1426,7 +1454,8 @@ void LLViewerDisplay::render_ui_3d(BOOL showAxes)
     if (showAxes)
     {
 	    // Coordinate axes
-	    if (gSavedSettings.getBOOL("ShowAxes"))
+	    static LLCachedControl<bool> show_axes(gSavedSettings, "ShowAxes");
+	    if (show_axes)
 	    {
 		    draw_axes();
 	    }
@@ -1499,7 +1528,8 @@ void LLViewerDisplay::render_ui_2d(render_options& options)
 		stop_glerror();
 	}
 
-	if (gSavedSettings.getBOOL("RenderUIBuffer"))
+	static LLCachedControl<bool> render_ui_buffer(gSavedSettings, "RenderUIBuffer");
+	if (render_ui_buffer)
 	{
 		if (LLUI::sDirty)
 		{
@@ -1055,6 +1055,103 @@ U32 LLViewerObject::extractSpatialExtents(LLDataPackerBinaryBuffer *dp, LLVector
 	return parent_id;
 }
 
+//static
+LLUUID LLViewerObject::extractMeshID(LLDataPackerBinaryBuffer *dp)
+{
+	LLUUID mesh_id;
+
+	U8 pcode = 0;
+	LLViewerObject::unpackU8(dp, pcode, "PCode");
+	if (pcode != LL_PCODE_VOLUME)
+	{
+		return mesh_id;
+	}
+
+	// Walk the update the way processUpdateMessage() does for
+	// OUT_FULL_CACHED as far as the sculpt parameters, skipping the rest.
+	dp->shift(sObjectDataMap["SpecialCode"]);
+	U32 value;
+	dp->unpackU32(value, "SpecialCode");
+	LLUUID owner_id;
+	dp->unpackUUID(owner_id, "Owner");
+
+	if (value & 0x80)
+	{
+		LLVector3 omega;
+		dp->unpackVector3(omega, "Omega");
+	}
+
+	if (value & 0x20)
+	{
+		U32 parent_id;
+		dp->unpackU32(parent_id, "ParentID");
+	}
+
+	if (value & 0x2)
+	{
+		U8 tree_data;
+		dp->unpackU8(tree_data, "TreeData");
+	}
+	else if (value & 0x1)
+	{
+		U32 size;
+		dp->unpackU32(size, "ScratchPadSize");
+		S32 sp_size = 0;
+		dp->unpackS32(sp_size, "PartData");
+		if (sp_size < 0 || sp_size > dp->getBufferSize() - dp->getCurrentSize())
+		{
+			dp->reset();
+			return mesh_id;
+		}
+		dp->shift(dp->getCurrentSize() + sp_size);
+	}
+
+	if (value & 0x4)
+	{
+		std::string text;
+		dp->unpackString(text, "Text");
+		U8 color[4];
+		dp->unpackBinaryDataFixed(color, 4, "Color");
+	}
+
+	if (value & 0x200)
+	{
+		std::string media_url;
+		dp->unpackString(media_url, "MediaURL");
+	}
+
+	if (value & 0x8)
+	{
+		LLPartSysData part_sys_data;
+		part_sys_data.unpackLegacy(*dp);
+	}
+
+	U8 num_parameters = 0;
+	dp->unpackU8(num_parameters, "num_params");
+	U8 param_block[MAX_OBJECT_PARAMS_SIZE];
+	for (U8 param=0; param<num_parameters; ++param)
+	{
+		U16 param_type;
+		S32 param_size;
+		dp->unpackU16(param_type, "param_type");
+		dp->unpackBinaryData(param_block, param_size, "param_data");
+		if (param_type == LLNetworkData::PARAMS_SCULPT)
+		{
+			LLSculptParams sculpt_params;
+			LLDataPackerBinaryBuffer dp2(param_block, param_size);
+			sculpt_params.unpack(dp2);
+			if ((sculpt_params.getSculptType() & LL_SCULPT_TYPE_MASK) == LL_SCULPT_TYPE_MESH)
+			{
+				mesh_id = sculpt_params.getSculptTexture();
+			}
+			break;
+		}
+	}
+	dp->reset();
+
+	return mesh_id;
+}
+
 U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 					 void **user_data,
 					 U32 block_num,
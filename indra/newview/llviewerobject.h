@@ -160,6 +160,7 @@ public:
     };
 
 	static  U32     extractSpatialExtents(LLDataPackerBinaryBuffer *dp, LLVector3& pos, LLVector3& scale, LLQuaternion& rot);
+	static  LLUUID  extractMeshID(LLDataPackerBinaryBuffer *dp); // null unless the cached update is for a mesh
 	virtual U32		processUpdateMessage(LLMessageSystem *mesgsys,
 										void **user_data,
 										U32 block_num,
@@ -90,6 +90,13 @@ extern BOOL gAnimateTextures;
 
 void dialog_refresh_all();
 
+static LLTrace::BlockTimerStatHandle FTM_IDLE_AVATARS("Idle Avatars");
+static LLTrace::BlockTimerStatHandle FTM_IDLE_OBJECTS("Idle Objects");
+static LLTrace::BlockTimerStatHandle FTM_PIXEL_AREA("Pixel Area");
+
+// pixel area is a handful of multiplies an object
+static const U32 PIXEL_AREA_BATCH = 256;
+
 // Global lists of objects - should go away soon.
 LLViewerObjectList gObjectList;
 
@@ -101,6 +108,9 @@ std::map<U64, U32>		LLViewerObjectList::sIPAndPortToIndex;
 std::map<U64, LLUUID>	LLViewerObjectList::sIndexAndLocalIDToUUID;
 
 LLViewerObjectList::LLViewerObjectList()
+:	mAvatarPhase(FTM_IDLE_AVATARS, 1),
+	mObjectPhase(FTM_IDLE_OBJECTS, 1),
+	mPixelAreaPhase(FTM_PIXEL_AREA, PIXEL_AREA_BATCH)
 {
 	mCurLazyUpdateIndex = 0;
 	mCurBin = 0;
@@ -775,18 +785,25 @@ void LLViewerObjectList::updateApparentAngles(LLAgent &agent)
 	LLSelectMgr::getInstance()->getSelection()->applyToRootObjects(&func);
 
 	// Iterate through some of the objects and lazy update their texture priorities
+	mPixelAreaPhase.clear();
 	for (i = mCurLazyUpdateIndex; i < max_value; i++)
 	{
 		objectp = mObjects[i];
 		if (!objectp->isDead())
 		{
-			num_objects++;
-
-			//  Update distance & gpw 
-			objectp->setPixelAreaAndAngle(agent); // Also sets the approx. pixel area
-			objectp->updateTextures();	// Update the image levels of textures for this object.
+			mPixelAreaPhase.add(objectp);
 		}
 	}
+	num_objects = (S32) mPixelAreaPhase.size();
+
+	//  Update distance & gpw, only reads the camera and writes the object's own area
+	mPixelAreaPhase.run(boost::bind(&LLViewerObject::setPixelAreaAndAngle, _1, boost::ref(agent)), 0.f, gPipeline.getGeometryPool());
+
+	for (i = 0; i < num_objects; i++)
+	{
+		mPixelAreaPhase.get(i)->updateTextures();	// Update the image levels of textures for this object.
+	}
+	mPixelAreaPhase.clear();
 
 	mCurLazyUpdateIndex = max_value;
 	if (mCurLazyUpdateIndex == mObjects.size())
@@ -844,10 +861,16 @@ void LLViewerObjectList::update(LLAgent &agent)
 
 	const F64 frame_time = LLFrameTimer::getElapsedSeconds();
 	
+	static LLCachedControl<F32> avatar_budget(gSavedSettings, "IdleUpdateAvatarBudget", 0.f);
+	static LLCachedControl<F32> object_budget(gSavedSettings, "IdleUpdateObjectBudget", 0.f);
+	static LLCachedControl<F32> texture_anim_budget(gSavedSettings, "IdleUpdateTextureAnimBudget", 2.f);
+
 	LLViewerObject *objectp = NULL;	
 	
-	// Make a copy of the list in case something in idleUpdate() messes with it
-	static std::vector<LLViewerObject*> idle_list;
+	// Sort the list into phases by kind of update, which also makes a copy
+	// of it in case something in idleUpdate() messes with it
+	mAvatarPhase.clear();
+	mObjectPhase.clear();
 
 	U32 idle_count = 0;
 	
@@ -860,13 +883,14 @@ void LLViewerObjectList::update(LLAgent &agent)
 			objectp = *active_iter;
 			if (objectp)
 			{
-				if (idle_count >= idle_list.size())
+				llassert(objectp->isActive());
+				if (objectp->isAvatar())
 				{
-				idle_list.push_back( objectp );
-			}
-			else
+					mAvatarPhase.add(objectp);
+				}
+				else
 				{
-					idle_list[idle_count] = objectp;
+					mObjectPhase.add(objectp);
 				}
 				++idle_count;
 			}
@@ -878,30 +902,20 @@ void LLViewerObjectList::update(LLAgent &agent)
 		}
 	}
 
-	std::vector<LLViewerObject*>::iterator idle_end = idle_list.begin()+idle_count;
+	// idleUpdate() moves objects around the scene graph, so these phases
+	// stay on the main thread.  Objects a budget does not get to miss their
+	// interpolation and their volume's idle work for the frame, so there's
+	// no budget unless one is set.
+	LLIdleUpdatePhase::work_t idle_update = boost::bind(&LLViewerObject::idleUpdate, _1, boost::ref(agent), frame_time);
 
 	if (gSavedSettings.getBOOL("FreezeTime"))
 	{
-		
-		for (std::vector<LLViewerObject*>::iterator iter = idle_list.begin();
-			iter != idle_end; iter++)
-		{
-			objectp = *iter;
-			if (objectp->isAvatar())
-			{
-				objectp->idleUpdate(agent, frame_time);
-			}
-		}
+		mAvatarPhase.run(idle_update, 0.f);
 	}
 	else
 	{
-		for (std::vector<LLViewerObject*>::iterator idle_iter = idle_list.begin();
-			idle_iter != idle_end; idle_iter++)
-		{
-			objectp = *idle_iter;
-			llassert(objectp->isActive());
-			objectp->idleUpdate(agent, frame_time);
-		}
+		mAvatarPhase.run(idle_update, avatar_budget);
+		mObjectPhase.run(idle_update, object_budget);
 
 		//update flexible objects
 		LLVolumeImplFlexible::updateClass();
@@ -909,11 +923,12 @@ void LLViewerObjectList::update(LLAgent &agent)
 		//update animated textures
 		if (gAnimateTextures)
 		{
-			LLViewerTextureAnim::updateClass();
+			LLViewerTextureAnim::updateClass(texture_anim_budget, gPipeline.getGeometryPool());
 		}
 	}
 
-
+	mAvatarPhase.clear();
+	mObjectPhase.clear();
 
 	fetchObjectCosts();
 	fetchPhysicsFlags();
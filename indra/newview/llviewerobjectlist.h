@@ -35,6 +35,7 @@
 #include "lltrace.h"
 
 // project includes
+#include "llidleupdatephase.h"
 #include "llviewerobject.h"
 #include "lleventcoro.h"
 #include "llcoros.h"
@@ -221,6 +222,11 @@ protected:
 
 	S32 mCurLazyUpdateIndex;
 
+	// phases of the idle update, see update() and updateApparentAngles()
+	LLIdleUpdatePhase mAvatarPhase;
+	LLIdleUpdatePhase mObjectPhase;
+	LLIdleUpdatePhase mPixelAreaPhase;
+
 	static U32 sSimulatorMachineIndex;
 	static std::map<U64, U32> sIPAndPortToIndex;
 
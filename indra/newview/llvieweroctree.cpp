@@ -1383,6 +1383,21 @@ void LLViewerOctreeCull::traverse(const OctreeNode* n)
 		mRes = 0;
 	}
 }
+
+void LLViewerOctreeCull::record(const OctreeNode* n, cull_steps_t& steps)
+{
+	cull_record_t::record(*this, mRes, n, steps);
+}
+
+void LLViewerOctreeCull::replay(const cull_steps_t& steps)
+{
+	cull_record_t::replay(*this, mRes, steps);
+}
+
+bool LLViewerOctreeCull::skipFrustumCheck(const LLViewerOctreeGroup* group) const
+{
+	return group->hasState(LLViewerOctreeGroup::SKIP_FRUSTUM_CHECK);
+}
 	
 //------------------------------------------
 //agent space group culling
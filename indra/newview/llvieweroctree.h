@@ -369,8 +369,22 @@ public:
 	
 	virtual void traverse(const OctreeNode* n);
 
+	// traverse() split in two so that the frustum tests can run off the
+	// main thread, see LLOctreeCullRecord.  record() does only the frustum
+	// tests, which read bounds nothing changes while culling; replay() then
+	// runs earlyFail(), preprocess() and processGroup() in the same order,
+	// walking again past any group whose earlier sibling failed early.
+	typedef LLOctreeCullRecord<LLViewerOctreeEntry, LLViewerOctreeGroup> cull_record_t;
+	typedef cull_record_t::steps_t cull_steps_t;
+
+	void record(const OctreeNode* n, cull_steps_t& steps);
+	void replay(const cull_steps_t& steps);
+
 protected:
+	friend class LLOctreeCullRecord<LLViewerOctreeEntry, LLViewerOctreeGroup>;
+
 	virtual bool earlyFail(LLViewerOctreeGroup* group);	
+	bool skipFrustumCheck(const LLViewerOctreeGroup* group) const;
 	
 	//agent space group cull
 	S32 AABBInFrustumNoFarClipGroupBounds(const LLViewerOctreeGroup* group);	
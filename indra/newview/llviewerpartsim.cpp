@@ -41,6 +41,10 @@
 #include "llspatialpartition.h"
 #include "llvoavatarself.h"
 #include "llvovolume.h"
+#include "llpartstep.h"
+#include "llworkpool.h"
+
+#include <boost/bind.hpp>
 
 const F32 PART_SIM_BOX_SIDE = 16.f;
 
@@ -64,7 +68,7 @@ const F32 LLViewerPartSim::PART_ADAPT_RATE_MULT_RECIP = 1.0f/PART_ADAPT_RATE_MUL
 
 U32 LLViewerPart::sNextPartID = 1;
 
-F32 calc_desired_size(LLViewerCamera* camera, LLVector3 pos, LLVector2 scale)
+F32 calc_desired_size(const LLViewerCamera* camera, LLVector3 pos, LLVector2 scale)
 {
 	F32 desired_size = (pos - camera->getOrigin()).magVec();
 	desired_size /= 4;
@@ -272,28 +276,20 @@ BOOL LLViewerPartGroup::addPart(LLViewerPart* part, F32 desired_size)
 }
 
 
-void LLViewerPartGroup::updateParticles(const F32 lastdt)
+void LLViewerPartGroup::prepareParticles(const F32 lastdt)
 {
-	F32 dt;
-	
-	LLVector3 gravity(0.f, 0.f, GRAVITY);
-
 	LLViewerPartSim::checkParticleCount(mParticles.size());
 
-	LLViewerCamera* camera = LLViewerCamera::getInstance();
 	LLViewerRegion *regionp = getRegion();
-	S32 end = (S32) mParticles.size();
-	for (S32 i = 0 ; i < (S32)mParticles.size();)
+	const S32 count = (S32) mParticles.size();
+	mStepTimes.resize(count);
+	for (S32 i = 0 ; i < count; i++)
 	{
-		LLVector3 a(0.f, 0.f, 0.f);
 		LLViewerPart* part = mParticles[i] ;
 
-		dt = lastdt + mSkippedTime - part->mSkipOffset;
+		const F32 dt = lastdt + mSkippedTime - part->mSkipOffset;
 		part->mSkipOffset = 0.f;
-
-		// Update current time
-		const F32 cur_time = part->mLastUpdateTime + dt;
-		const F32 frac = cur_time / part->mMaxAge;
+		mStepTimes[i] = dt;
 
 		// "Drift" the object based on the source object
 		if (part->mFlags & LLPartData::LL_PART_FOLLOW_SRC_MASK)
@@ -331,7 +327,19 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
 			part->mVelocity *= (1.f - step);
 			part->mVelocity += step*delta_pos;
 		}
+	}
+}
 
+void LLViewerPartGroup::simulateParticles(const LLViewerCamera* camera)
+{
+	const S32 count = (S32) mParticles.size();
+	llassert(count == (S32) mStepTimes.size());
+
+	mStatus.resize(count);
+	for (S32 i = 0; i < count; i++)
+	{
+		LLViewerPart* part = mParticles[i];
+		const F32 frac = ll_step_particle(*part, mStepTimes[i]);
 
 		if (part->mFlags & LLPartData::LL_PART_TARGET_LINEAR_MASK)
 		{
@@ -340,13 +348,6 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
 			part->mPosAgent += frac*delta_pos;
 			part->mVelocity = delta_pos;
 		}
-		else
-		{
-			// Do velocity interpolation
-			part->mPosAgent += dt*part->mVelocity;
-			part->mPosAgent += 0.5f*dt*dt*part->mAccel;
-			part->mVelocity += part->mAccel*dt;
-		}
 
 		// Do a bounce test
 		if (part->mFlags & LLPartData::LL_PART_BOUNCE_MASK)
@@ -361,7 +362,6 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
 			}
 		}
 
-
 		// Reset the offset from the source position
 		if (part->mFlags & LLPartData::LL_PART_FOLLOW_SRC_MASK)
 		{
@@ -369,53 +369,45 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
 			part->mPosOffset -= part->mPartSourcep->mPosAgent;
 		}
 
-		// Do color interpolation
-		if (part->mFlags & LLPartData::LL_PART_INTERP_COLOR_MASK)
+		// Kill dead particles (either flagged dead, or too old)
+		if ((part->mLastUpdateTime > part->mMaxAge) || (LLViewerPart::LL_PART_DEAD_MASK == part->mFlags))
 		{
-			part->mColor.setVec(part->mStartColor);
-			// note: LLColor4's v%k means multiply-alpha-only,
-			//       LLColor4's v*k means multiply-rgb-only
-			part->mColor *= 1.f - frac; // rgb*k
-			part->mColor %= 1.f - frac; // alpha*k
-			part->mColor += frac%(frac*part->mEndColor); // rgb,alpha
+			mStatus[i] = PART_DEAD;
 		}
-
-		// Do scale interpolation
-		if (part->mFlags & LLPartData::LL_PART_INTERP_SCALE_MASK)
+		else 
 		{
-			part->mScale.setVec(part->mStartScale);
-			part->mScale *= 1.f - frac;
-			part->mScale += frac*part->mEndScale;
+			F32 desired_size = calc_desired_size(camera, part->mPosAgent, part->mScale);
+			mStatus[i] = posInGroup(part->mPosAgent, desired_size) ? PART_KEEP : PART_MOVED;
 		}
+	}
+}
 
-		// Do glow interpolation
-		part->mGlow.mV[3] = (U8) ll_round(lerp(part->mStartGlow, part->mEndGlow, frac)*255.f);
-
-		// Set the last update time to now.
-		part->mLastUpdateTime = cur_time;
+void LLViewerPartGroup::finishParticles(part_list_t& moved)
+{
+	S32 end = (S32) mParticles.size();
+	for (S32 i = 0 ; i < (S32)mParticles.size();)
+	{
+		const U8 status = mStatus[i];
+		if (status == PART_KEEP)
+		{
+			i++ ;
+			continue;
+		}
 
+		LLViewerPart* part = mParticles[i] ;
+		mParticles[i] = mParticles.back() ;
+		mParticles.pop_back() ;
+		mStatus[i] = mStatus.back();
+		mStatus.pop_back();
 
-		// Kill dead particles (either flagged dead, or too old)
-		if ((part->mLastUpdateTime > part->mMaxAge) || (LLViewerPart::LL_PART_DEAD_MASK == part->mFlags))
+		if (status == PART_DEAD)
 		{
-			mParticles[i] = mParticles.back() ;
-			mParticles.pop_back() ;
 			delete part ;
 		}
-		else 
+		else
 		{
-			F32 desired_size = calc_desired_size(camera, part->mPosAgent, part->mScale);
-			if (!posInGroup(part->mPosAgent, desired_size))
-			{
-				// Transfer particles between groups
-				LLViewerPartSim::getInstance()->put(part) ;
-				mParticles[i] = mParticles.back() ;
-				mParticles.pop_back() ;
-			}
-			else
-			{
-				i++ ;
-			}
+			// Transfer particles between groups
+			moved.push_back(part);
 		}
 	}
 
@@ -744,6 +736,7 @@ void LLViewerPartSim::updateSimulation()
 		num_updates++;
 	}
 
+	mUpdateGroups.clear();
 	count = (S32) mViewerPartGroups.size();
 	for (i = 0; i < count; i++)
 	{
@@ -765,15 +758,9 @@ void LLViewerPartSim::updateSimulation()
 			{
 				gPipeline.markRebuild(vobj->mDrawable, LLDrawable::REBUILD_ALL, TRUE);
 			}
-			mViewerPartGroups[i]->updateParticles(dt * visirate);
+			mViewerPartGroups[i]->prepareParticles(dt * visirate);
 			mViewerPartGroups[i]->mSkippedTime=0.0f;
-			if (!mViewerPartGroups[i]->getCount())
-			{
-				delete mViewerPartGroups[i];
-				mViewerPartGroups.erase(mViewerPartGroups.begin() + i);
-				i--;
-				count--;
-			}
+			mUpdateGroups.push_back(mViewerPartGroups[i]);
 		}
 		else
 		{	
@@ -781,6 +768,48 @@ void LLViewerPartSim::updateSimulation()
 		}
 
 	}
+
+	// the groups only touch their own particles while simulating
+	const LLViewerCamera* camera = LLViewerCamera::getInstance();
+	LLWorkPool* pool = mUpdateGroups.size() > 1 ? gPipeline.getGeometryPool() : NULL;
+	if (pool)
+	{
+		pool->run(mUpdateGroups.size(), boost::bind(&LLViewerPartSim::simulateGroup, this, camera, _1));
+	}
+	else
+	{
+		for (U32 j = 0; j < mUpdateGroups.size(); ++j)
+		{
+			simulateGroup(camera, j);
+		}
+	}
+
+	mMovedParticles.clear();
+	for (U32 j = 0; j < mUpdateGroups.size(); ++j)
+	{
+		mUpdateGroups[j]->finishParticles(mMovedParticles);
+	}
+
+	// drop emptied groups before any particles are moved into them
+	count = (S32) mViewerPartGroups.size();
+	for (i = 0; i < count; i++)
+	{
+		if (!mViewerPartGroups[i]->getCount())
+		{
+			delete mViewerPartGroups[i];
+			mViewerPartGroups.erase(mViewerPartGroups.begin() + i);
+			i--;
+			count--;
+		}
+	}
+
+	for (U32 j = 0; j < mMovedParticles.size(); ++j)
+	{
+		put(mMovedParticles[j]);
+	}
+	mMovedParticles.clear();
+	mUpdateGroups.clear();
+
 	if (LLDrawable::getCurrentFrame()%16==0)
 	{
 		if (sParticleCount > sMaxParticleCount * 0.875f
@@ -803,6 +832,11 @@ void LLViewerPartSim::updateSimulation()
 	//LL_INFOS() << "Particles: " << sParticleCount << " Adaptive Rate: " << sParticleAdaptiveRate << LL_ENDL;
 }
 
+void LLViewerPartSim::simulateGroup(const LLViewerCamera* camera, U32 index)
+{
+	mUpdateGroups[index]->simulateParticles(camera);
+}
+
 void LLViewerPartSim::updatePartBurstRate()
 {
 	if (!(LLDrawable::getCurrentFrame() & 0xf))
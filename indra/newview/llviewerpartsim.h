@@ -32,6 +32,7 @@
 #include "llpartdata.h"
 #include "llviewerpartsource.h"
 
+class LLViewerCamera;
 class LLViewerTexture;
 class LLViewerPart;
 class LLViewerRegion;
@@ -96,8 +97,6 @@ public:
 	void cleanup();
 
 	BOOL addPart(LLViewerPart* part, const F32 desired_size = -1.f);
-	
-	void updateParticles(const F32 lastdt);
 
 	BOOL posInGroup(const LLVector3 &pos, const F32 desired_size = -1.f);
 
@@ -109,6 +108,16 @@ public:
 	typedef std::vector<LLViewerPart*>  part_list_t;
 	part_list_t mParticles;
 
+	// Steps the particles in three parts so the middle one can run for many
+	// groups at once.  prepareParticles() does what reads the world or calls
+	// back into the viewer, simulateParticles() moves and interpolates them
+	// and decides which stay, touching nothing but this group's particles,
+	// and finishParticles() deletes the dead and hands back those that left
+	// the group for LLViewerPartSim::put().
+	void prepareParticles(const F32 lastdt);
+	void simulateParticles(const LLViewerCamera* camera);
+	void finishParticles(part_list_t& moved);
+
 	const LLVector3 &getCenterAgent() const		{ return mCenterAgent; }
 	S32 getCount() const					{ return (S32) mParticles.size(); }
 	LLViewerRegion *getRegion() const		{ return mRegionp; }
@@ -131,6 +140,19 @@ protected:
 	LLVector3 mMaxObjPos;
 
 	LLViewerRegion *mRegionp;
+
+private:
+	enum
+	{
+		PART_KEEP = 0,
+		PART_DEAD,
+		PART_MOVED
+	};
+
+	// what prepareParticles() works out for simulateParticles() to use,
+	// and what simulateParticles() decides for finishParticles()
+	std::vector<F32> mStepTimes;
+	std::vector<U8> mStatus;
 };
 
 class LLViewerPartSim : public LLSingleton<LLViewerPartSim>
@@ -190,9 +212,13 @@ public:
 protected:
 	LLViewerPartGroup *createViewerPartGroup(const LLVector3 &pos_agent, const F32 desired_size, bool hud);
 	LLViewerPartGroup *put(LLViewerPart* part);
+	void simulateGroup(const LLViewerCamera* camera, U32 index);
 
 	group_list_t mViewerPartGroups;
 	source_list_t mViewerPartSources;
+	// groups stepped this frame and the particles that left them
+	group_list_t mUpdateGroups;
+	LLViewerPartGroup::part_list_t mMovedParticles;
 	LLFrameTimer mSimulationTimer;
 
 	static S32 sMaxParticleCount;
@@ -2189,6 +2189,37 @@ void LLViewerRegion::findOrphans(U32 parent_id)
 	}
 }
 
+void LLViewerRegion::getInactiveCacheEntries(const LLVector3& pos, F32 radius, std::vector<LLVOCacheEntry*>& entries)
+{
+	if(!sVOCacheCullingEnabled)
+	{
+		return; //every cached object is created right away
+	}
+
+	LLVector4a center;
+	center.load3(pos.mV);
+	for(LLVOCacheEntry::vocache_entry_map_t::iterator iter = mImpl->mCacheMap.begin(); iter != mImpl->mCacheMap.end(); ++iter)
+	{
+		LLVOCacheEntry* entry = iter->second;
+		if(entry->isChild() || !entry->isState(LLVOCacheEntry::INACTIVE) || !entry->hasState(LLVOCacheEntry::IN_VO_TREE))
+		{
+			continue;
+		}
+
+		const LLVector4a* exts = entry->getSpatialExtents();
+		LLVector4a size;
+		size.setSub(exts[1], exts[0]);
+		LLVector4a lookAt;
+		lookAt.setSub(entry->getPositionGroup(), center);
+
+		F32 reach = radius + size.getLength3().getF32() * 0.5f;
+		if(lookAt.dot3(lookAt).getF32() < reach * reach)
+		{
+			entries.push_back(entry);
+		}
+	}
+}
+
 void LLViewerRegion::decodeBoundingInfo(LLVOCacheEntry* entry)
 {
 	if(!sVOCacheCullingEnabled)
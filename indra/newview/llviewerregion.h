@@ -343,6 +343,9 @@ public:
 	//update object cache if the object receives a full-update or terse update
 	LLViewerObject* updateCacheEntry(U32 local_id, LLViewerObject* objectp, U32 update_type);
 	void findOrphans(U32 parent_id);
+	//append the root entries of cached linksets that are not objects yet
+	//and whose bounds reach within radius of the region local point pos
+	void getInactiveCacheEntries(const LLVector3& pos, F32 radius, std::vector<LLVOCacheEntry*>& entries);
 	void clearCachedVisibleObjects();
 	void dumpCache();
 
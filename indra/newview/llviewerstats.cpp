@@ -89,7 +89,10 @@ LLTrace::CountStatHandle<>	FPS("FPS", "Frames rendered"),
 							FRAMETIME_DOUBLED("frametimedoubled", "Ratio of frames 2x longer than previous"),
 							TEX_BAKES("texbakes", "Number of times avatar textures have been baked"),
 							TEX_REBAKES("texrebakes", "Number of times avatar textures have been forced to rebake"),
-							NUM_NEW_OBJECTS("numnewobjectsstat", "Number of objects in scene that were not previously in cache");
+							NUM_NEW_OBJECTS("numnewobjectsstat", "Number of objects in scene that were not previously in cache"),
+							MESH_PREFETCHES("meshprefetches", "Mesh headers and LODs fetched ahead of the camera"),
+							MESH_PREFETCH_HITS("meshprefetchhits", "Prefetched meshes later requested by an object"),
+							MESH_PREFETCH_WASTED("meshprefetchwasted", "Prefetched meshes never requested by an object");
 
 LLTrace::CountStatHandle<LLUnit<F64, LLUnits::Kilotriangles> > 
 							TRIANGLES_DRAWN("trianglesdrawnstat");
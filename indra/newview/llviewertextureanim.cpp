@@ -27,13 +27,26 @@
 #include "llviewerprecompiledheaders.h"
 
 #include "llviewertextureanim.h"
+#include "llidleupdatephase.h"
 #include "llvovolume.h"
 
 #include "llmath.h"
 #include "llerror.h"
 
+static LLTrace::BlockTimerStatHandle FTM_TEXTURE_ANIM("Texture Animation");
+
+// a few microseconds of matrix math each
+static const U32 TEXTURE_ANIM_BATCH = 32;
+
 std::vector<LLViewerTextureAnim*> LLViewerTextureAnim::sInstanceList;
 
+static LLIdleUpdatePhase sTextureAnimPhase(FTM_TEXTURE_ANIM, TEXTURE_ANIM_BATCH);
+
+static void step_texture_anim(LLViewerObject* objectp)
+{
+	((LLVOVolume*) objectp)->stepTextureAnim();
+}
+
 LLViewerTextureAnim::LLViewerTextureAnim(LLVOVolume* vobj) : LLTextureAnim()
 {
 	mVObj = vobj;
@@ -67,12 +80,24 @@ void LLViewerTextureAnim::reset()
 }
 
 //static 
-void LLViewerTextureAnim::updateClass()
+void LLViewerTextureAnim::updateClass(F32 budget_ms, LLWorkPool* pool)
 {
+	sTextureAnimPhase.clear();
+	for (std::vector<LLViewerTextureAnim*>::iterator iter = sInstanceList.begin(); iter != sInstanceList.end(); ++iter)
+	{
+		sTextureAnimPhase.add((*iter)->mVObj);
+	}
+
+	sTextureAnimPhase.run(&step_texture_anim, budget_ms, pool);
+
+	// starting and stopping is for the main thread, volumes the budget did
+	// not get to have nothing to apply
+	LL_RECORD_BLOCK_TIME(FTM_TEXTURE_ANIM);
 	for (std::vector<LLViewerTextureAnim*>::iterator iter = sInstanceList.begin(); iter != sInstanceList.end(); ++iter)
 	{
-		(*iter)->mVObj->animateTextures();
+		(*iter)->mVObj->applyTextureAnim();
 	}
+	sTextureAnimPhase.clear();
 }
 
 S32 LLViewerTextureAnim::animateTextures(F32 &off_s, F32 &off_t,
@@ -31,6 +31,7 @@
 #include "llframetimer.h"
 
 class LLVOVolume;
+class LLWorkPool;
 
 class LLViewerTextureAnim : public LLTextureAnim
 {
@@ -39,7 +40,9 @@ private:
 	S32 mInstanceIndex;
 
 public:
-	static void updateClass();
+	// Steps the animations spread over the pool and within budget_ms (0 for
+	// no budget), those left over go first next frame.
+	static void updateClass(F32 budget_ms = 0.f, LLWorkPool* pool = NULL);
 
 	LLViewerTextureAnim(LLVOVolume* vobj);
 	virtual ~LLViewerTextureAnim();
@@ -611,8 +611,8 @@ public:
 			}
             ypos += y_inc;
 
-			addText(xpos, ypos, llformat("UI Verts/Calls: %d/%d", LLRender::sUIVerts, LLRender::sUICalls));
-			LLRender::sUICalls = LLRender::sUIVerts = 0;
+			addText(xpos, ypos, llformat("UI Verts/Calls/Batched: %d/%d/%d", LLRender::sUIVerts, LLRender::sUICalls, LLRender::sUIBatchedDraws));
+			LLRender::sUICalls = LLRender::sUIVerts = LLRender::sUIBatchedDraws = 0;
 			ypos += y_inc;
 
 			addText(xpos,ypos, llformat("%d/%d Nodes visible", gPipeline.mNumVisibleNodes, LLSpatialGroup::sNodeCount));
@@ -1761,6 +1761,8 @@ LLViewerWindow::LLViewerWindow(const Params& p)
 		mWindowRectScaled.set(0, ll_round((F32)size.mY / mDisplayScale.mV[VY]), ll_round((F32)size.mX / mDisplayScale.mV[VX]), 0);
 	}
 	
+	LLFontBitmapCache::setMemoryBudget(gSavedSettings.getU32("FontGlyphAtlasBudget") * 1024);
+	LLFontManager::setAsyncRasterization(gSavedSettings.getBOOL("FontAsyncRasterization"));
 	LLFontManager::initClass();
 
 	//
@@ -2564,6 +2566,13 @@ void LLViewerWindow::draw()
 			stop_glerror();
 		}
 
+		static LLCachedControl<bool> ui_batching(gSavedSettings, "RenderUIBatching", true);
+		bool batch_ui = ui_batching;
+		if (batch_ui)
+		{
+			gGL.beginUIBatch();
+		}
+
 		// Draw all nested UI views.
 		// No translation needed, this view is glued to 0,0
 		mRootView->draw();
@@ -2587,6 +2596,11 @@ void LLViewerWindow::draw()
 			LLUI::popMatrix();
 		}
 
+		if (batch_ui)
+		{
+			gGL.endUIBatch();
+		}
+
 
 		if( gShowOverlayTitle && !mOverlayTitle.empty() )
 		{
@@ -2402,7 +2402,7 @@ void LLVOAvatar::idleUpdateAppearanceAnimation()
 					param->stopAnimating();
 				}
 			}
-			updateVisualParams();
+			updateSharedVisualParams();
 		}
 		else
 		{
@@ -5470,6 +5470,20 @@ void LLVOAvatar::updateVisualParams()
 	dirtyMesh();
 	updateHeadOffset();
 }
+
+//-----------------------------------------------------------------------------
+// updateSharedVisualParams()
+//-----------------------------------------------------------------------------
+void LLVOAvatar::updateSharedVisualParams()
+{
+	// the sex picks the weights of sex specific morphs
+	setSex( (getVisualParamWeight( "male" ) > 0.5f) ? SEX_MALE : SEX_FEMALE );
+
+	adoptSharedMorphs();
+	updateVisualParams();
+	shareMorphs();
+}
+
 //-----------------------------------------------------------------------------
 // isActive()
 //-----------------------------------------------------------------------------
@@ -7491,7 +7505,7 @@ void LLVOAvatar::processAvatarAppearance( LLMessageSystem* mesgsys )
 			{
 				startAppearanceAnimation();
 			}
-			updateVisualParams();
+			updateSharedVisualParams();
 
 			ESex new_sex = getSex();
 			if( old_sex != new_sex )
@@ -215,6 +215,9 @@ public:
 	/*virtual*/ LLVector3d		getPosGlobalFromAgent(const LLVector3 &position);
 	/*virtual*/ LLVector3		getPosAgentFromGlobal(const LLVector3d &position);
 	virtual void				updateVisualParams();
+	// updateVisualParams() for a whole new appearance, taking the morphed
+	// meshes of avatars with the same shape where there are some
+	void						updateSharedVisualParams();
 
 /**                    Inherited
  **                                                                            **
@@ -72,7 +72,9 @@ LLVOCacheEntry::LLVOCacheEntry(U32 local_id, U32 crc, LLDataPackerBinaryBuffer &
 	mSceneContrib(0.f),
 	mValid(TRUE),
 	mParentID(0),
-	mBSphereRadius(-1.0f)
+	mBSphereRadius(-1.0f),
+	mMeshDecoded(false),
+	mMeshRadius(0.f)
 {
 	mBuffer = new U8[dp.getBufferSize()];
 	mDP.assignBuffer(mBuffer, dp.getBufferSize());
@@ -93,7 +95,9 @@ LLVOCacheEntry::LLVOCacheEntry()
 	mSceneContrib(0.f),
 	mValid(TRUE),
 	mParentID(0),
-	mBSphereRadius(-1.0f)
+	mBSphereRadius(-1.0f),
+	mMeshDecoded(false),
+	mMeshRadius(0.f)
 {
 	mDP.assignBuffer(mBuffer, 0);
 }
@@ -107,7 +111,9 @@ LLVOCacheEntry::LLVOCacheEntry(LLAPRFile* apr_file)
 	mSceneContrib(0.f),
 	mValid(FALSE),
 	mParentID(0),
-	mBSphereRadius(-1.0f)
+	mBSphereRadius(-1.0f),
+	mMeshDecoded(false),
+	mMeshRadius(0.f)
 {
 	S32 size = -1;
 	BOOL success;
@@ -193,6 +199,8 @@ void LLVOCacheEntry::updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp)
 	mBuffer = new U8[dp.getBufferSize()];
 	mDP.assignBuffer(mBuffer, dp.getBufferSize());
 	mDP = dp;
+
+	mMeshDecoded = false;
 }
 
 void LLVOCacheEntry::setParentID(U32 id) 
@@ -329,6 +337,49 @@ LLDataPackerBinaryBuffer *LLVOCacheEntry::getDP()
 	return &mDP;
 }
 
+const LLUUID& LLVOCacheEntry::getMeshID()
+{
+	if(!mMeshDecoded)
+	{
+		decodeMesh();
+	}
+	return mMeshID;
+}
+
+F32 LLVOCacheEntry::getMeshRadius()
+{
+	if(!mMeshDecoded)
+	{
+		decodeMesh();
+	}
+	return mMeshRadius;
+}
+
+void LLVOCacheEntry::decodeMesh()
+{
+	mMeshDecoded = true;
+	mMeshID.setNull();
+	mMeshRadius = 0.f;
+
+	LLDataPackerBinaryBuffer* dp = getDP();
+	if(!dp)
+	{
+		return;
+	}
+
+	mMeshID = LLViewerObject::extractMeshID(dp);
+	if(mMeshID.notNull())
+	{
+		LLVector3 pos;
+		LLVector3 scale;
+		LLQuaternion rot;
+		LLViewerObject::extractSpatialExtents(dp, pos, scale, rot);
+
+		//meshes keep the default LOD scale bias of one, see LLVOVolume::calcLOD()
+		mMeshRadius = scale.length();
+	}
+}
+
 void LLVOCacheEntry::recordHit()
 {
 	mHitCount++;
@@ -133,17 +133,25 @@ public:
 	void setUpdateFlags(U32 flags) {mUpdateFlags = flags;}
 	U32  getUpdateFlags() const    {return mUpdateFlags;}
 
+	//mesh the cached object renders (null for anything else) and its radius for LOD,
+	//decoded from the cached update the first time either is asked for.
+	const LLUUID& getMeshID();
+	F32  getMeshRadius();
+
 	static void updateDebugSettings();
 	static F32  getSquaredPixelThreshold(bool is_front);
 
 private:
 	void updateParentBoundingInfo(const LLVOCacheEntry* child);	
+	void decodeMesh();
 
 public:
 	typedef std::map<U32, LLPointer<LLVOCacheEntry> >	   vocache_entry_map_t;
 	typedef std::set<LLVOCacheEntry*>                      vocache_entry_set_t;
 	typedef std::set<LLVOCacheEntry*, CompareVOCacheEntry> vocache_entry_priority_list_t;	
 
+	const vocache_entry_set_t& getChildren() const {return mChildrenList;}
+
 	S32                         mLastCameraUpdated;
 protected:
 	U32							mLocalID;
@@ -165,6 +173,10 @@ protected:
 	LLVector4a                  mBSphereCenter; //bounding sphere center
 	F32                         mBSphereRadius; //bounding sphere radius
 
+	bool                        mMeshDecoded; //mMeshID and mMeshRadius are up to date with mDP.
+	LLUUID                      mMeshID;
+	F32                         mMeshRadius;
+
 public:
 	static U32					sMinFrameRange;
 	static F32					sNearRadius;
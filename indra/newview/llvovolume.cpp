@@ -51,6 +51,7 @@
 #include "lldrawpoolavatar.h"
 #include "lldrawpoolbump.h"
 #include "llface.h"
+#include "llgeometryfill.h"
 #include "llspatialpartition.h"
 #include "llhudmanager.h"
 #include "llflexibleobject.h"
@@ -77,6 +78,9 @@
 #include "llvoavatar.h"
 #include "llvocache.h"
 #include "llmaterialmgr.h"
+#include "llworkpool.h"
+
+#include <boost/bind.hpp>
 
 const F32 FORCE_SIMPLE_RENDER_AREA = 512.f;
 const F32 FORCE_CULL_AREA = 8.f;
@@ -206,6 +210,7 @@ LLVOVolume::LLVOVolume(const LLUUID &id, const LLPCode pcode, LLViewerRegion *re
 	  mVolumeImpl(NULL)
 {
 	mTexAnimMode = 0;
+	mTexAnimApply = TEX_ANIM_APPLY_NONE;
 	mRelativeXform.setIdentity();
 	mRelativeXformInvTrans.setIdentity();
 
@@ -503,8 +508,10 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 }
 
 
-void LLVOVolume::animateTextures()
+BOOL LLVOVolume::stepTextureAnim()
 {
+	mTexAnimApply = TEX_ANIM_APPLY_NONE;
+
 	if (!mDead)
 	{
 		F32 off_s = 0.f, off_t = 0.f, scale_s = 1.f, scale_t = 1.f, rot = 0.f;
@@ -514,8 +521,7 @@ void LLVOVolume::animateTextures()
 		{
 			if (!mTexAnimMode)
 			{
-				mFaceMappingChanged = TRUE;
-				gPipeline.markTextured(mDrawable);
+				mTexAnimApply = TEX_ANIM_APPLY_START;
 			}
 			mTexAnimMode = result | mTextureAnimp->mMode;
 				
@@ -576,45 +582,58 @@ void LLVOVolume::animateTextures()
 				tex_mat.translate(trans);
 			}
 		}
-		else
+		else if (mTexAnimMode && mTextureAnimp->mRate == 0)
 		{
-			if (mTexAnimMode && mTextureAnimp->mRate == 0)
-			{
-				U8 start, count;
+			mTexAnimApply = TEX_ANIM_APPLY_STOP;
+		}
+	}
 
-				if (mTextureAnimp->mFace == -1)
-				{
-					start = 0;
-					count = getNumTEs();
-				}
-				else
-				{
-					start = (U8) mTextureAnimp->mFace;
-					count = 1;
-				}
+	return mTexAnimApply != TEX_ANIM_APPLY_NONE;
+}
 
-				for (S32 i = start; i < start + count; i++)
-				{
-					if (mTexAnimMode & LLViewerTextureAnim::TRANSLATE)
-					{
-						setTEOffset(i, mTextureAnimp->mOffS, mTextureAnimp->mOffT);				
-					}
-					if (mTexAnimMode & LLViewerTextureAnim::SCALE)
-					{
-						setTEScale(i, mTextureAnimp->mScaleS, mTextureAnimp->mScaleT);	
-					}
-					if (mTexAnimMode & LLViewerTextureAnim::ROTATE)
-					{
-						setTERotation(i, mTextureAnimp->mRot);
-					}
-				}
+void LLVOVolume::applyTextureAnim()
+{
+	if (mTexAnimApply == TEX_ANIM_APPLY_START)
+	{
+		mFaceMappingChanged = TRUE;
+		gPipeline.markTextured(mDrawable);
+	}
+	else if (mTexAnimApply == TEX_ANIM_APPLY_STOP)
+	{
+		U8 start, count;
 
-				gPipeline.markTextured(mDrawable);
-				mFaceMappingChanged = TRUE;
-				mTexAnimMode = 0;
+		if (mTextureAnimp->mFace == -1)
+		{
+			start = 0;
+			count = getNumTEs();
+		}
+		else
+		{
+			start = (U8) mTextureAnimp->mFace;
+			count = 1;
+		}
+
+		for (S32 i = start; i < start + count; i++)
+		{
+			if (mTexAnimMode & LLViewerTextureAnim::TRANSLATE)
+			{
+				setTEOffset(i, mTextureAnimp->mOffS, mTextureAnimp->mOffT);				
+			}
+			if (mTexAnimMode & LLViewerTextureAnim::SCALE)
+			{
+				setTEScale(i, mTextureAnimp->mScaleS, mTextureAnimp->mScaleT);	
+			}
+			if (mTexAnimMode & LLViewerTextureAnim::ROTATE)
+			{
+				setTERotation(i, mTextureAnimp->mRot);
 			}
 		}
+
+		gPipeline.markTextured(mDrawable);
+		mFaceMappingChanged = TRUE;
+		mTexAnimMode = 0;
 	}
+	mTexAnimApply = TEX_ANIM_APPLY_NONE;
 }
 
 void LLVOVolume::updateTextures()
@@ -1213,6 +1232,7 @@ void LLVOVolume::sculpt()
 	}
 }
 
+//static
 S32	LLVOVolume::computeLODDetail(F32 distance, F32 radius)
 {
 	S32	cur_detail;
@@ -1229,6 +1249,28 @@ S32	LLVOVolume::computeLODDetail(F32 distance, F32 radius)
 	return cur_detail;
 }
 
+//static
+S32 LLVOVolume::computeLODDetailAt(F32 distance, F32 radius)
+{
+	distance *= sDistanceFactor;
+
+	F32 rampDist = LLVOVolume::sLODFactor * 2;
+	
+	if (distance < rampDist)
+	{
+		// Boost LOD when you're REALLY close
+		distance *= 1.0f/rampDist;
+		distance *= distance;
+		distance *= rampDist;
+	}
+	
+	// DON'T Compensate for field of view changing on FOV zoom.
+	distance *= F_PI/3.f;
+
+	return computeLODDetail(ll_round(distance, 0.01f), 
+							ll_round(radius, 0.01f));
+}
+
 BOOL LLVOVolume::calcLOD()
 {
 	if (mDrawable.isNull())
@@ -1263,23 +1305,7 @@ BOOL LLVOVolume::calcLOD()
 	//hold onto unmodified distance for debugging
 	//F32 debug_distance = distance;
 	
-	distance *= sDistanceFactor;
-
-	F32 rampDist = LLVOVolume::sLODFactor * 2;
-	
-	if (distance < rampDist)
-	{
-		// Boost LOD when you're REALLY close
-		distance *= 1.0f/rampDist;
-		distance *= distance;
-		distance *= rampDist;
-	}
-	
-	// DON'T Compensate for field of view changing on FOV zoom.
-	distance *= F_PI/3.f;
-
-	cur_detail = computeLODDetail(ll_round(distance, 0.01f), 
-									ll_round(radius, 0.01f));
+	cur_detail = computeLODDetailAt(distance, radius);
 
 
 	if (gPipeline.hasRenderDebugMask(LLPipeline::RENDER_DEBUG_LOD_INFO) &&
@@ -4154,7 +4180,124 @@ void LLVOVolume::updateRiggedVolume(bool force_update)
 }
 
 static LLTrace::BlockTimerStatHandle FTM_SKIN_RIGGED("Skin");
-static LLTrace::BlockTimerStatHandle FTM_RIGGED_OCTREE("Octree");
+static LLTrace::BlockTimerStatHandle FTM_RIGGED_BVH("Picking BVH");
+
+void LLRiggedVolume::updateInfluences(const LLMeshSkinInfo* skin, const LLVolume* volume)
+{
+	mSkin = skin;
+	mSrcVolume = volume;
+
+	LLMatrix4a bind_shape_matrix;
+	bind_shape_matrix.loadu(skin->mBindShapeMatrix);
+
+	S32 num_faces = volume->getNumVolumeFaces();
+	mInfluences.resize(num_faces);
+	mJointBounds.resize(num_faces * MAX_JOINTS * 2);
+
+	for (S32 i = 0; i < num_faces; ++i)
+	{
+		const LLVolumeFace& vol_face = volume->getVolumeFace(i);
+		FaceInfluence& influence = mInfluences[i];
+		influence.mJoints = 0;
+		influence.mBlockJoints.assign((vol_face.mNumVertices + BLOCK_VERTICES - 1) / BLOCK_VERTICES, 0);
+
+		LLVector4a* weight = vol_face.mWeights;
+		if (!weight)
+		{
+			continue;
+		}
+
+		LLVector4a* bounds = &mJointBounds[i * MAX_JOINTS * 2];
+
+		for (U32 j = 0; j < vol_face.mNumVertices; ++j)
+		{
+			LLVector4a t;
+			bind_shape_matrix.affineTransform(vol_face.mPositions[j], t);
+
+			U64 joints = 0;
+			for (U32 k = 0; k < 4; k++)
+			{
+				F32 w = weight[j][k];
+				if (w - floorf(w) <= 0.f)
+				{ //no influence
+					continue;
+				}
+
+				S32 index = llclamp((S32) floorf(w), (S32) 0, (S32) MAX_JOINTS - 1);
+				U64 bit = (U64) 1 << index;
+				if (!((joints | influence.mJoints) & bit))
+				{ //first vertex of this joint in the face
+					bounds[index * 2] = t;
+					bounds[index * 2 + 1] = t;
+				}
+				else
+				{
+					bounds[index * 2].setMin(bounds[index * 2], t);
+					bounds[index * 2 + 1].setMax(bounds[index * 2 + 1], t);
+				}
+				joints |= bit;
+				influence.mJoints |= bit;
+			}
+
+			influence.mBlockJoints[j / BLOCK_VERTICES] |= joints;
+		}
+	}
+}
+
+void LLRiggedVolume::skinJob(U32 index)
+{
+	const SkinJob& job = mSkinJobs[index];
+	const LLVolumeFace& vol_face = mSrcVolume->getVolumeFace(job.mFace);
+	LLVolumeFace& dst_face = mVolumeFaces[job.mFace];
+
+	LLVector4a* weight = vol_face.mWeights;
+	LLVector4a* pos = dst_face.mPositions;
+
+	LLMatrix4a bind_shape_matrix;
+	bind_shape_matrix.loadu(mSkin->mBindShapeMatrix);
+
+	for (U32 j = job.mStart; j < job.mEnd; ++j)
+	{
+		LLMatrix4a final_mat;
+		final_mat.clear();
+
+		S32 idx[4];
+
+		LLVector4 wght;
+
+		F32 scale = 0.f;
+		for (U32 k = 0; k < 4; k++)
+		{
+			F32 w = weight[j][k];
+
+			idx[k] = (S32) floorf(w);
+			wght[k] = w - floorf(w);
+			scale += wght[k];
+		}
+		// This is enforced  in unpackVolumeFaces()
+		llassert(scale>0.f);
+		wght *= 1.f / scale;
+
+		for (U32 k = 0; k < 4; k++)
+		{
+			F32 w = wght[k];
+
+			LLMatrix4a src;
+			// Insure ref'd bone is in our clamped array of mats
+			// clamp idx to MAX_JOINTS to avoid reading past the palette
+			S32 index = llclamp((S32)idx[k],(S32)0,(S32)MAX_JOINTS-1);
+			src.setMul(mPalette[index], w);
+			final_mat.add(src);
+		}
+
+		LLVector4a& v = vol_face.mPositions[j];
+		LLVector4a t;
+		LLVector4a dst;
+		bind_shape_matrix.affineTransform(v, t);
+		final_mat.affineTransform(t, dst);
+		pos[j] = dst;
+	}
+}
 
 void LLRiggedVolume::update(const LLMeshSkinInfo* skin, LLVOAvatar* avatar, const LLVolume* volume)
 {
@@ -4181,13 +4324,26 @@ void LLRiggedVolume::update(const LLMeshSkinInfo* skin, LLVOAvatar* avatar, cons
 		copyVolumeFaces(volume);	
 	}
 
+	//everything moved if the vertices were just copied or skinned for
+	//another mesh
+	U64 changed = 0;
+	if (copy || skin != mSkin || volume != mSrcVolume)
+	{
+		updateInfluences(skin, volume);
+		changed = ~(U64) 0;
+	}
+
 	//build matrix palette
-	static const size_t kMaxJoints = 52;
+	if (mPalette.size() != MAX_JOINTS)
+	{
+		mPalette.resize(MAX_JOINTS);
+		for (U32 j = 0; j < MAX_JOINTS; ++j)
+		{
+			mPalette[j].loadu(LLMatrix4());
+		}
+	}
 
-	LLMatrix4a mp[kMaxJoints];
-	LLMatrix4* mat = (LLMatrix4*) mp;
-	
-	U32 maxJoints = llmin(skin->mJointNames.size(), kMaxJoints);
+	U32 maxJoints = llmin(skin->mJointNames.size(), (size_t) MAX_JOINTS);
 	for (U32 j = 0; j < maxJoints; ++j)
 	{
 		LLJoint* joint = avatar->getJoint(skin->mJointNames[j]);
@@ -4199,102 +4355,128 @@ void LLRiggedVolume::update(const LLMeshSkinInfo* skin, LLVOAvatar* avatar, cons
         }
 		if (joint)
 		{
-			mat[j] = skin->mInvBindMatrix[j];
-			mat[j] *= joint->getWorldMatrix();
+			LLMatrix4 mat = skin->mInvBindMatrix[j];
+			mat *= joint->getWorldMatrix();
+
+			LLMatrix4a mp;
+			mp.loadu(mat);
+			if (memcmp(&mp, &mPalette[j], sizeof(LLMatrix4a)))
+			{
+				mPalette[j] = mp;
+				changed |= (U64) 1 << j;
+			}
 		}
 	}
 
+	if (!changed)
+	{ //nothing moved since the last update
+		return;
+	}
+
+	//queue the blocks of vertices weighted to a joint that moved
+	mSkinJobs.clear();
 	for (S32 i = 0; i < volume->getNumVolumeFaces(); ++i)
 	{
 		const LLVolumeFace& vol_face = volume->getVolumeFace(i);
-		
-		LLVolumeFace& dst_face = mVolumeFaces[i];
-		
-		LLVector4a* weight = vol_face.mWeights;
+		const LLVolumeFace& dst_face = mVolumeFaces[i];
+		const FaceInfluence& influence = mInfluences[i];
 
-		if ( weight )
+		if (!vol_face.mWeights || !dst_face.mPositions || !dst_face.mExtents || !(influence.mJoints & changed))
 		{
-			LLMatrix4a bind_shape_matrix;
-			bind_shape_matrix.loadu(skin->mBindShapeMatrix);
+			continue;
+		}
 
-			LLVector4a* pos = dst_face.mPositions;
+		for (U32 b = 0; b < influence.mBlockJoints.size(); ++b)
+		{
+			if (influence.mBlockJoints[b] & changed)
+			{
+				SkinJob job;
+				job.mFace = i;
+				job.mStart = b * BLOCK_VERTICES;
+				job.mEnd = llmin((U32) (b + 1) * BLOCK_VERTICES, (U32) vol_face.mNumVertices);
+				mSkinJobs.push_back(job);
+			}
+		}
+	}
 
-			if( pos && weight && dst_face.mExtents )
+	{
+		LL_RECORD_BLOCK_TIME(FTM_SKIN_RIGGED);
+		LLWorkPool* pool = mSkinJobs.size() > 1 ? gPipeline.getGeometryPool() : NULL;
+		if (pool)
+		{
+			pool->run(mSkinJobs.size(), boost::bind(&LLRiggedVolume::skinJob, this, _1));
+		}
+		else
+		{
+			for (U32 i = 0; i < mSkinJobs.size(); ++i)
 			{
-				LL_RECORD_BLOCK_TIME(FTM_SKIN_RIGGED);
+				skinJob(i);
+			}
+		}
+	}
 
-				for (U32 j = 0; j < dst_face.mNumVertices; ++j)
-				{
-					LLMatrix4a final_mat;
-					final_mat.clear();
+	for (S32 i = 0; i < volume->getNumVolumeFaces(); ++i)
+	{
+		const LLVolumeFace& vol_face = volume->getVolumeFace(i);
+		LLVolumeFace& dst_face = mVolumeFaces[i];
+		const FaceInfluence& influence = mInfluences[i];
+
+		if (!vol_face.mWeights || !(influence.mJoints & changed))
+		{
+			continue;
+		}
 
-					S32 idx[4];
+		if (dst_face.mPositions && dst_face.mExtents)
+		{
+			//update bounding box from the boxes of the joints' vertices,
+			//every skinned vertex is a blend of its joints' transforms
+			LLVector4a& min = dst_face.mExtents[0];
+			LLVector4a& max = dst_face.mExtents[1];
+			const LLVector4a* bounds = &mJointBounds[i * MAX_JOINTS * 2];
+			bool first = true;
 
-					LLVector4 wght;
+			for (U32 j = 0; j < MAX_JOINTS; ++j)
+			{
+				if (!(influence.mJoints & ((U64) 1 << j)))
+				{
+					continue;
+				}
 
-					F32 scale = 0.f;
-					for (U32 k = 0; k < 4; k++)
+				const F32* lo = bounds[j * 2].getF32ptr();
+				const F32* hi = bounds[j * 2 + 1].getF32ptr();
+				for (U32 c = 0; c < 8; ++c)
+				{
+					LLVector4a corner(c & 1 ? hi[0] : lo[0],
+									  c & 2 ? hi[1] : lo[1],
+									  c & 4 ? hi[2] : lo[2]);
+					LLVector4a dst;
+					mPalette[j].affineTransform(corner, dst);
+					if (first)
 					{
-						F32 w = weight[j][k];
-
-						idx[k] = (S32) floorf(w);
-						wght[k] = w - floorf(w);
-						scale += wght[k];
+						min = dst;
+						max = dst;
+						first = false;
 					}
-                    // This is enforced  in unpackVolumeFaces()
-                    llassert(scale>0.f);
-                    wght *= 1.f / scale;
-
-					for (U32 k = 0; k < 4; k++)
+					else
 					{
-						F32 w = wght[k];
-
-						LLMatrix4a src;
-						// Insure ref'd bone is in our clamped array of mats
-						// clamp idx to maxJoints to avoid reading garbage off stack in release
-                        S32 index = llclamp((S32)idx[k],(S32)0,(S32)kMaxJoints-1);
-						src.setMul(mp[index], w);
-						final_mat.add(src);
+						min.setMin(min, dst);
+						max.setMax(max, dst);
 					}
-
-				
-					LLVector4a& v = vol_face.mPositions[j];
-					LLVector4a t;
-					LLVector4a dst;
-					bind_shape_matrix.affineTransform(v, t);
-					final_mat.affineTransform(t, dst);
-					pos[j] = dst;
 				}
-
-				//update bounding box
-				LLVector4a& min = dst_face.mExtents[0];
-				LLVector4a& max = dst_face.mExtents[1];
-
-				min = pos[0];
-				max = pos[1];
-
-				for (U32 j = 1; j < dst_face.mNumVertices; ++j)
-				{
-					min.setMin(min, pos[j]);
-					max.setMax(max, pos[j]);
-				}
-
-				dst_face.mCenter->setAdd(dst_face.mExtents[0], dst_face.mExtents[1]);
-				dst_face.mCenter->mul(0.5f);
-
 			}
 
-			{
-				LL_RECORD_BLOCK_TIME(FTM_RIGGED_OCTREE);
-				delete dst_face.mOctree;
-				dst_face.mOctree = NULL;
+			dst_face.mCenter->setAdd(dst_face.mExtents[0], dst_face.mExtents[1]);
+			dst_face.mCenter->mul(0.5f);
+		}
 
-				LLVector4a size;
-				size.setSub(dst_face.mExtents[1], dst_face.mExtents[0]);
-				size.splat(size.getLength3().getF32()*0.5f);
-			
-				dst_face.createOctree(1.f);
-			}
+		{
+			LL_RECORD_BLOCK_TIME(FTM_RIGGED_BVH);
+			//the debug raycast display builds its octree again on demand
+			delete dst_face.mOctree;
+			dst_face.mOctree = NULL;
+
+			dst_face.mBVH = NULL;
+			dst_face.createBVH();
 		}
 	}
 }
@@ -4369,6 +4551,8 @@ LLFace** LLVolumeGeometryManager::sNormFaces = NULL;
 LLFace** LLVolumeGeometryManager::sSpecFaces = NULL;
 LLFace** LLVolumeGeometryManager::sNormSpecFaces = NULL;
 LLFace** LLVolumeGeometryManager::sAlphaFaces = NULL;
+LLGeometryFill* LLVolumeGeometryManager::sGeometryFill = NULL;
+std::vector<LLPointer<LLVertexBuffer> > LLVolumeGeometryManager::sFillBuffers;
 
 LLVolumeGeometryManager::LLVolumeGeometryManager()
 	: LLGeometryManager()
@@ -4403,6 +4587,7 @@ void LLVolumeGeometryManager::allocateFaces(U32 pMaxFaceCount)
 	sSpecFaces = static_cast<LLFace**>(ll_aligned_malloc<64>(pMaxFaceCount*sizeof(LLFace*)));
 	sNormSpecFaces = static_cast<LLFace**>(ll_aligned_malloc<64>(pMaxFaceCount*sizeof(LLFace*)));
 	sAlphaFaces = static_cast<LLFace**>(ll_aligned_malloc<64>(pMaxFaceCount*sizeof(LLFace*)));
+	sGeometryFill = new LLGeometryFill();
 }
 
 void LLVolumeGeometryManager::freeFaces()
@@ -4422,6 +4607,18 @@ void LLVolumeGeometryManager::freeFaces()
 	sSpecFaces = NULL;
 	sNormSpecFaces = NULL;
 	sAlphaFaces = NULL;
+
+	delete sGeometryFill;
+	sGeometryFill = NULL;
+	sFillBuffers.clear();
+}
+
+static LLTrace::BlockTimerStatHandle FTM_REBUILD_VOLUME_FILL("Fill Geometry");
+
+void LLVolumeGeometryManager::fillGeometry()
+{
+	LL_RECORD_BLOCK_TIME(FTM_REBUILD_VOLUME_FILL);
+	sGeometryFill->run(gPipeline.getGeometryPool());
 }
 
 static LLTrace::BlockTimerStatHandle FTM_REGISTER_FACE("Register Face");
@@ -5257,6 +5454,14 @@ void LLVolumeGeometryManager::rebuildGeom(LLSpatialGroup* group)
 	genDrawInfo(group, spec_mask | LLVertexBuffer::MAP_TEXTURE_INDEX, sSpecFaces, spec_count, FALSE, FALSE);
 	genDrawInfo(group, normspec_mask | LLVertexBuffer::MAP_TEXTURE_INDEX, sNormSpecFaces, normspec_count, FALSE, FALSE);
 
+	// every buffer of the group is mapped now, write them all at once
+	fillGeometry();
+	for (U32 i = 0; i < sFillBuffers.size(); ++i)
+	{
+		sFillBuffers[i]->flush();
+	}
+	sFillBuffers.clear();
+
 	if (!LLPipeline::sDelayVBUpdate)
 	{
 		//drawables have been rebuilt, clear rebuild status
@@ -5332,7 +5537,7 @@ void LLVolumeGeometryManager::rebuildMesh(LLSpatialGroup* group)
 							llassert(!face->isState(LLFace::RIGGED));
 
 							if (!face->getGeometryVolume(*volume, face->getTEOffset(), 
-								vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), face->getGeomIndex()))
+								vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), face->getGeomIndex(), false, sGeometryFill))
 							{ //something's gone wrong with the vertex buffer accounting, rebuild this group 
 								group->dirtyGeom();
 								gPipeline.markRebuild(group, TRUE);
@@ -5357,6 +5562,8 @@ void LLVolumeGeometryManager::rebuildMesh(LLSpatialGroup* group)
 			}
 		}
 		
+		fillGeometry();
+
 		{
 			LL_RECORD_BLOCK_TIME(FTM_REBUILD_MESH_FLUSH);
 			for (LLVertexBuffer** iter = locked_buffer, ** end_iter = locked_buffer+buffer_count; iter != end_iter; ++iter)
@@ -5732,7 +5939,7 @@ void LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFac
 					llassert(!facep->isState(LLFace::RIGGED));
 
 					if (!facep->getGeometryVolume(*volume, te_idx, 
-						vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), index_offset,true))
+						vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), index_offset,true, sGeometryFill))
 					{
 						LL_WARNS() << "Failed to get geometry for face!" << LL_ENDL;
 					}
@@ -6027,7 +6234,8 @@ void LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFac
 			++face_iter;
 		}
 
-		buffer->flush();
+		// flushed by rebuildGeom() once the fill has run
+		sFillBuffers.push_back(buffer);
 	}
 
 	group->mBufferMap[mask].clear();
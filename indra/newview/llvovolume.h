@@ -34,6 +34,8 @@
 #include "lllocalbitmaps.h"
 #include "m3math.h"		// LLMatrix3
 #include "m4math.h"		// LLMatrix4
+#include "llalignedarray.h"
+#include "llmatrix4a.h"
 #include <map>
 
 class LLViewerTextureAnim;
@@ -57,11 +59,51 @@ class LLRiggedVolume : public LLVolume
 {
 public:
 	LLRiggedVolume(const LLVolumeParams& params)
-		: LLVolume(params, 0.f)
+		: LLVolume(params, 0.f),
+		mSkin(NULL),
+		mSrcVolume(NULL)
 	{
 	}
 
+	// Only vertices weighted to joints that moved since the last update are
+	// skinned again, spread over the pipeline's geometry pool.
 	void update(const LLMeshSkinInfo* skin, LLVOAvatar* avatar, const LLVolume* src_volume);
+
+private:
+	enum
+	{
+		MAX_JOINTS = 52,
+		BLOCK_VERTICES = 256
+	};
+
+	// joints each face and each run of BLOCK_VERTICES of its vertices are
+	// weighted to, one bit per joint
+	struct FaceInfluence
+	{
+		U64 mJoints;
+		std::vector<U64> mBlockJoints;
+	};
+
+	// vertices [mStart, mEnd) of face mFace
+	struct SkinJob
+	{
+		S32 mFace;
+		U32 mStart;
+		U32 mEnd;
+	};
+
+	void updateInfluences(const LLMeshSkinInfo* skin, const LLVolume* src_volume);
+	void skinJob(U32 index);
+
+	std::vector<FaceInfluence> mInfluences;
+	// bind shape space bounds of the vertices weighted to each joint,
+	// min and max for every joint of every face
+	LLAlignedArray<LLVector4a, 16> mJointBounds;
+	// the matrix palette of the last update
+	LLAlignedArray<LLMatrix4a, 16> mPalette;
+	std::vector<SkinJob> mSkinJobs;
+	const LLMeshSkinInfo* mSkin;
+	const LLVolume* mSrcVolume;
 };
 
 // Base class for implementations of the volume - Primitive, Flexible Object, etc.
@@ -115,7 +157,12 @@ public:
 
 				void	deleteFaces();
 
-				void	animateTextures();
+				// Steps the texture animation and the face texture matrices,
+				// which touches nothing outside this volume so many volumes can
+				// be stepped at once.  Returns TRUE when applyTextureAnim() has
+				// to tell the pipeline about it on the main thread.
+				BOOL	stepTextureAnim();
+				void	applyTextureAnim();
 	
 	            BOOL    isVisible() const ;
 	/*virtual*/ BOOL	isActive() const;
@@ -327,7 +374,7 @@ public:
 	void clearRiggedVolume();
 
 protected:
-	S32	computeLODDetail(F32	distance, F32 radius);
+	static S32 computeLODDetail(F32	distance, F32 radius);
 	BOOL calcLOD();
 	LLFace* addFace(S32 face_index);
 	void updateTEData();
@@ -355,6 +402,15 @@ private:
 	friend class LLDrawable;
 	friend class LLFace;
 
+	// what stepTextureAnim() left for applyTextureAnim()
+	enum
+	{
+		TEX_ANIM_APPLY_NONE = 0,
+		TEX_ANIM_APPLY_START,
+		TEX_ANIM_APPLY_STOP
+	};
+	U8			mTexAnimApply;
+
 	BOOL		mFaceMappingChanged;
 	LLFrameTimer mTextureUpdateTimer;
 	S32			mLOD;
@@ -384,6 +440,9 @@ public:
 	static LLPointer<LLObjectMediaDataClient> sObjectMediaClient;
 	static LLPointer<LLObjectMediaNavigateClient> sObjectMediaNavigateClient;
 
+	// LOD calcLOD() picks for a volume of LOD radius radius that far from the camera
+	static S32 computeLODDetailAt(F32 distance, F32 radius);
+
 protected:
 	static S32 sNumLODChanges;
 
@@ -61,6 +61,7 @@
 #include "lldrawpoolwater.h"
 #include "llface.h"
 #include "llfeaturemanager.h"
+#include "llflexibleobject.h"
 #include "llfloatertelehub.h"
 #include "llfloaterreg.h"
 #include "llgldbg.h"
@@ -95,6 +96,7 @@
 #include "llvotree.h"
 #include "llvopartgroup.h"
 #include "llworld.h"
+#include "llworkpool.h"
 #include "llcubemap.h"
 #include "llviewershadermgr.h"
 #include "llviewerstats.h"
@@ -455,6 +457,8 @@ LLPipeline::LLPipeline() :
 	mLightMask(0),
 	mLightMovingMask(0),
 	mLightingDetail(0),
+	mCullPool(NULL),
+	mGeometryPool(NULL),
 	mScreenWidth(0),
 	mScreenHeight(0)
 {
@@ -488,6 +492,8 @@ void LLPipeline::init()
 	LLVertexBuffer::sUseStreamDraw = gSavedSettings.getBOOL("RenderUseStreamVBO");
 	LLVertexBuffer::sUseVAO = gSavedSettings.getBOOL("RenderUseVAO");
 	LLVertexBuffer::sPreferStreamDraw = gSavedSettings.getBOOL("RenderPreferStreamDraw");
+	LLVertexBuffer::sUseStreamRing = gSavedSettings.getBOOL("RenderStreamVBORing");
+	LLVertexBuffer::sStreamRingSize = gSavedSettings.getU32("RenderStreamVBORingSize")*1024;
 	sRenderAttachedLights = gSavedSettings.getBOOL("RenderAttachedLights");
 	sRenderAttachedParticles = gSavedSettings.getBOOL("RenderAttachedParticles");
 
@@ -667,6 +673,12 @@ void LLPipeline::cleanup()
 	mGroupQ1.clear() ;
 	mGroupQ2.clear() ;
 
+	delete mCullPool;
+	mCullPool = NULL;
+	mCullJobs.clear();
+	delete mGeometryPool;
+	mGeometryPool = NULL;
+
 	for(pool_set_t::iterator iter = mPools.begin();
 		iter != mPools.end(); )
 	{
@@ -2400,6 +2412,53 @@ BOOL LLPipeline::getVisibleExtents(LLCamera& camera, LLVector3& min, LLVector3&
 }
 
 static LLTrace::BlockTimerStatHandle FTM_CULL("Object Culling");
+static LLTrace::BlockTimerStatHandle FTM_CULL_THREADS("Frustum Culling Threads");
+
+// (re)creates pool when the thread count setting has changed, at most 8
+static LLWorkPool* update_work_pool(LLWorkPool*& pool, const std::string& name, U32 threads)
+{
+	threads = llmin(threads, (U32) 8);
+	if (pool && pool->getThreadCount() != threads)
+	{
+		delete pool;
+		pool = NULL;
+	}
+	if (!pool && threads > 0)
+	{
+		pool = new LLWorkPool(name, threads);
+	}
+	return pool;
+}
+
+LLWorkPool* LLPipeline::getCullPool()
+{
+	static LLCachedControl<U32> cull_threads(gSavedSettings, "RenderCullThreads", 0);
+	return update_work_pool(mCullPool, "Cull", cull_threads);
+}
+
+LLWorkPool* LLPipeline::getGeometryPool()
+{
+	static LLCachedControl<U32> geometry_threads(gSavedSettings, "RenderGeometryThreads", 0);
+	return update_work_pool(mGeometryPool, "Geometry", geometry_threads);
+}
+
+void LLPipeline::cullFrustumJob(const LLCamera* camera, S32 water_clip, U32 index)
+{
+	CullJob& job = mCullJobs[index];
+	// each job gets the camera the serial loop would have set up for its region
+	LLCamera region_camera(*camera);
+	if (water_clip != 0)
+	{
+		LLPlane plane(LLVector3(0,0, (F32) -water_clip), (F32) water_clip*job.mWaterHeight);
+		region_camera.setUserClipPlane(plane);
+	}
+	else
+	{
+		region_camera.disableUserClipPlane();
+	}
+	job.mSteps.clear();
+	job.mPartition->cullFrustum(region_camera, job.mSteps);
+}
 
 void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_clip, LLPlane* planep)
 {
@@ -2501,6 +2560,39 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_cl
 		mCubeVB->setBuffer(LLVertexBuffer::MAP_VERTEX);
 	}
 	
+	// With RenderCullThreads set, the frustum tests of every partition run
+	// at once on the cull pool first.  Occlusion queries and the cull
+	// result are still handled here, partition by partition in the same
+	// order as before, so the result does not depend on thread timing.
+	LLWorkPool* cull_pool = getCullPool();
+	if (cull_pool)
+	{
+		LL_RECORD_BLOCK_TIME(FTM_CULL_THREADS);
+		U32 count = 0;
+		for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin(); 
+				iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
+		{
+			LLViewerRegion* region = *iter;
+			for (U32 i = 0; i < LLViewerRegion::NUM_PARTITIONS; i++)
+			{
+				LLSpatialPartition* part = region->getSpatialPartition(i);
+				if (part && hasRenderType(part->mDrawableType))
+				{
+					part->cullRebound();
+					if (count == mCullJobs.size())
+					{
+						mCullJobs.push_back(CullJob());
+					}
+					mCullJobs[count].mPartition = part;
+					mCullJobs[count].mWaterHeight = region->getWaterHeight();
+					++count;
+				}
+			}
+		}
+		cull_pool->run(count, boost::bind(&LLPipeline::cullFrustumJob, this, &camera, water_clip, _1));
+	}
+
+	U32 job = 0;
 	for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin(); 
 			iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
 	{
@@ -2522,7 +2614,14 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_cl
 			{
 				if (hasRenderType(part->mDrawableType))
 				{
-					part->cull(camera);
+					if (cull_pool)
+					{
+						part->cullReplay(camera, mCullJobs[job++].mSteps);
+					}
+					else
+					{
+						part->cull(camera);
+					}
 				}
 			}
 		}
@@ -3018,6 +3117,7 @@ void LLPipeline::updateGeom(F32 max_dtime)
 	// notify various object types to reset internal cost metrics, etc.
 	// for now, only LLVOVolume does this to throttle LOD changes
 	LLVOVolume::preUpdateGeom();
+	LLVolumeImplFlexible::simulateClass();
 
 	// Iterate through all drawables on the priority build queue,
 	for (LLDrawable::drawable_list_t::iterator iter = mBuildQ1.begin();
@@ -7403,6 +7503,7 @@ void LLPipeline::doResetVertexBuffers(bool forced)
 	LLVertexBuffer::sUseStreamDraw = gSavedSettings.getBOOL("RenderUseStreamVBO");
 	LLVertexBuffer::sUseVAO = gSavedSettings.getBOOL("RenderUseVAO");
 	LLVertexBuffer::sPreferStreamDraw = gSavedSettings.getBOOL("RenderPreferStreamDraw");
+	LLVertexBuffer::sUseStreamRing = gSavedSettings.getBOOL("RenderStreamVBORing");
 	LLVertexBuffer::sEnableVBOs = gSavedSettings.getBOOL("RenderVBOEnable");
 	LLVertexBuffer::sDisableVBOMapping = LLVertexBuffer::sEnableVBOs && gSavedSettings.getBOOL("RenderVBOMappingDisable") ;
 	sBakeSunlight = gSavedSettings.getBOOL("RenderBakeSunlight");
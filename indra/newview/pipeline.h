@@ -46,6 +46,7 @@ class LLFace;
 class LLViewerObject;
 class LLTextureEntry;
 class LLCullResult;
+class LLWorkPool;
 class LLVOAvatar;
 class LLVOPartGroup;
 class LLGLSLShader;
@@ -247,6 +248,9 @@ public:
 	void rebuildGroups();
 	void clearRebuildGroups();
 	void clearRebuildDrawables();
+	// Workers for the vertex data fill of geometry rebuilds, NULL while
+	// RenderGeometryThreads is 0
+	LLWorkPool* getGeometryPool();
 
 	//calculate pixel area of given box from vantage point of given camera
 	static F32 calcPixelArea(LLVector3 center, LLVector3 size, LLCamera& camera);
@@ -681,6 +685,22 @@ protected:
 	LLDrawable::drawable_vector_t mMovedBridge;
 	LLDrawable::drawable_vector_t	mShiftList;
 
+	/////////////////////////////////////////////
+	//
+	// Frustum tests of updateCull() done on mCullPool, one job per partition
+	struct CullJob
+	{
+		LLSpatialPartition*				mPartition;
+		F32								mWaterHeight;
+		LLViewerOctreeCull::cull_steps_t mSteps;
+	};
+	std::vector<CullJob>	mCullJobs;
+	LLWorkPool*				mCullPool;	// NULL while RenderCullThreads is 0
+	LLWorkPool*				mGeometryPool;
+
+	LLWorkPool* getCullPool();
+	void cullFrustumJob(const LLCamera* camera, S32 water_clip, U32 index);
+
 	/////////////////////////////////////////////
 	//
 	//
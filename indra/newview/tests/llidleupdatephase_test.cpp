@@ -0,0 +1,218 @@
+/**
+ * @file   llidleupdatephase_test.cpp
+ * @brief  Test for llidleupdatephase.cpp.
+ *
+ * $LicenseInfo:firstyear=2015&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2015, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <vector>
+#include <boost/bind.hpp>
+
+#include "../test/lltut.h"
+#include "../llidleupdatephase.h"
+
+#include "lltimer.h"
+#include "llworkpool.h"
+
+namespace
+{
+	// the phase only passes objects along, these stand in for them
+	const U32 MAX_OBJECTS = 1000;
+	char sObjects[MAX_OBJECTS];
+
+	LLViewerObject* object(U32 index)
+	{
+		return reinterpret_cast<LLViewerObject*>(&sObjects[index]);
+	}
+
+	U32 object_index(LLViewerObject* objectp)
+	{
+		return reinterpret_cast<char*>(objectp) - sObjects;
+	}
+
+	// counts the work each object gets and, without a pool, the order
+	struct Visits
+	{
+		Visits(U32 count, F32 spin_ms = 0.f)
+		:	mCounts(count, 0),
+			mSpin(spin_ms * 0.001f)
+		{
+		}
+
+		void visit(LLViewerObject* objectp)
+		{
+			// each object is only handed to one thread, so its count is too
+			++mCounts[object_index(objectp)];
+			if (mSpin > 0.f)
+			{
+				LLTimer timer;
+				while (timer.getElapsedTimeF32() < mSpin)
+				{
+				}
+			}
+		}
+
+		void visitInOrder(LLViewerObject* objectp)
+		{
+			mOrder.push_back(object_index(objectp));
+			visit(objectp);
+		}
+
+		std::vector<U32> mCounts;
+		std::vector<U32> mOrder;
+		const F32 mSpin;
+	};
+
+	LLTrace::BlockTimerStatHandle FTM_TEST_PHASE("Test Phase");
+}
+
+namespace tut
+{
+	struct llidleupdatephase_data
+	{
+		void fill(LLIdleUpdatePhase& phase, U32 count)
+		{
+			phase.clear();
+			for (U32 i = 0; i < count; ++i)
+			{
+				phase.add(object(i));
+			}
+		}
+	};
+	typedef test_group<llidleupdatephase_data> llidleupdatephase_test;
+	typedef llidleupdatephase_test::object llidleupdatephase_object;
+	tut::llidleupdatephase_test tllidleupdatephase("LLIdleUpdatePhase");
+
+	template<> template<>
+	void llidleupdatephase_object::test<1>()
+	{
+		// without a budget every object is done, in order, every run
+		LLIdleUpdatePhase phase(FTM_TEST_PHASE, 4);
+		ensure_equals("nothing to do", phase.run(LLIdleUpdatePhase::work_t(), 0.f), 0U);
+
+		fill(phase, 10);
+		for (U32 run = 0; run < 2; ++run)
+		{
+			Visits visits(10);
+			ensure_equals("all done", phase.run(boost::bind(&Visits::visitInOrder, &visits, _1), 0.f), 10U);
+			for (U32 i = 0; i < 10; ++i)
+			{
+				ensure_equals("in order from the start", visits.mOrder[i], i);
+			}
+		}
+	}
+
+	template<> template<>
+	void llidleupdatephase_object::test<2>()
+	{
+		// a budget stops the run, the next starts where it stopped and a
+		// full one leaves the cursor where it was
+		const U32 COUNT = 10;
+		LLIdleUpdatePhase phase(FTM_TEST_PHASE, 4);
+		fill(phase, COUNT);
+
+		Visits slow(COUNT, 1.f);
+		const U32 done = phase.run(boost::bind(&Visits::visitInOrder, &slow, _1), 2.5f);
+		ensure("stopped past the budget", done > 0 && done < COUNT);
+		ensure_equals("done counted", (U32) slow.mOrder.size(), done);
+		for (U32 i = 0; i < done; ++i)
+		{
+			ensure_equals("in order from the start", slow.mOrder[i], i);
+		}
+
+		for (U32 run = 0; run < 2; ++run)
+		{
+			Visits visits(COUNT);
+			ensure_equals("rest done", phase.run(boost::bind(&Visits::visitInOrder, &visits, _1), 0.f), COUNT);
+			for (U32 i = 0; i < COUNT; ++i)
+			{
+				ensure_equals("from where the budget stopped", visits.mOrder[i], (done + i) % COUNT);
+			}
+		}
+
+		// every object gets its turn however tight the budget
+		Visits tight(COUNT, 1.f);
+		U32 total = 0;
+		for (U32 run = 0; run < COUNT; ++run)
+		{
+			total += phase.run(boost::bind(&Visits::visit, &tight, _1), 0.001f);
+		}
+		ensure_equals("one a run", total, COUNT);
+		for (U32 i = 0; i < COUNT; ++i)
+		{
+			ensure_equals("each done once", tight.mCounts[i], 1U);
+		}
+
+		// fewer objects than the cursor has moved past start over
+		fill(phase, 2);
+		Visits fewer(2);
+		phase.run(boost::bind(&Visits::visitInOrder, &fewer, _1), 0.f);
+		ensure_equals("from the start", fewer.mOrder[0], 0U);
+	}
+
+	template<> template<>
+	void llidleupdatephase_object::test<3>()
+	{
+		// spread over a pool every object is done once, a budget stops it
+		// between rounds and the cursor carries over as without one
+		LLWorkPool pool("Test idle update", 3);
+		LLIdleUpdatePhase phase(FTM_TEST_PHASE, 16);
+		fill(phase, MAX_OBJECTS);
+
+		Visits visits(MAX_OBJECTS);
+		ensure_equals("all done", phase.run(boost::bind(&Visits::visit, &visits, _1), 0.f, &pool), MAX_OBJECTS);
+		for (U32 i = 0; i < MAX_OBJECTS; ++i)
+		{
+			ensure_equals("each done once", visits.mCounts[i], 1U);
+		}
+
+		Visits slow(MAX_OBJECTS, 0.1f);
+		const U32 done = phase.run(boost::bind(&Visits::visit, &slow, _1), 1.f, &pool);
+		ensure("stopped past the budget", done > 0 && done < MAX_OBJECTS);
+		for (U32 i = 0; i < MAX_OBJECTS; ++i)
+		{
+			ensure_equals("the first done", slow.mCounts[i], i < done ? 1U : 0U);
+		}
+
+		// the next round goes first
+		Visits next(MAX_OBJECTS, 0.01f);
+		ensure_equals("a round", phase.run(boost::bind(&Visits::visit, &next, _1), 0.001f, &pool), done);
+		for (U32 i = 0; i < MAX_OBJECTS; ++i)
+		{
+			ensure_equals("the next done", next.mCounts[i], i >= done && i < done * 2 ? 1U : 0U);
+		}
+
+		// a full run on the pool leaves the cursor where it was, then
+		// off the pool the objects the budget did not get to go first
+		Visits all(MAX_OBJECTS);
+		ensure_equals("all done", phase.run(boost::bind(&Visits::visit, &all, _1), 0.f, &pool), MAX_OBJECTS);
+		for (U32 i = 0; i < MAX_OBJECTS; ++i)
+		{
+			ensure_equals("each done once", all.mCounts[i], 1U);
+		}
+		Visits serial(MAX_OBJECTS);
+		phase.run(boost::bind(&Visits::visitInOrder, &serial, _1), 0.f);
+		ensure_equals("from where the budget stopped", serial.mOrder[0], (done * 2) % MAX_OBJECTS);
+	}
+}